@@ -33,7 +33,9 @@ DT_BACKGROUND_TILE *dt_create_background_tile()
   /****************************************************************************/
   temp_tile->elevation = 0;
   temp_tile->water_depth = 0;
+  temp_tile->movement_modifier = 0;
   temp_tile->label = NULL;
+  temp_tile->graphic_name = NULL;
   temp_tile->terrain_type = DT_GROUND_TYPE_PLAIN;
 
   return(temp_tile);
@@ -51,7 +53,7 @@ DT_BACKGROUND_TILE *dt_create_background_tile()
 /* Operation: If there is an entity graphic object referred to by this tile   */
 /*            check whether this is the last item that refers to it. If so    */
 /*            then destroy the graphic and if not then reduce its ref count.  */
-/*            Finally free the tile object itself.                            */
+/*            Finally free the graphic name and the tile object itself.       */
 /******************************************************************************/
 void dt_destroy_background_tile(DT_BACKGROUND_TILE *tile)
 {
@@ -75,8 +77,12 @@ void dt_destroy_background_tile(DT_BACKGROUND_TILE *tile)
   }
 
   /****************************************************************************/
-  /* Free the tile object itself.                                             */
+  /* Free the graphic name and the tile object itself.                        */
   /****************************************************************************/
+  if (NULL != tile->graphic_name)
+  {
+    dt_free(tile->graphic_name);
+  }
   dt_free(tile);
 
   return;
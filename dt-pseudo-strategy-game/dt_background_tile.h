@@ -2,13 +2,19 @@
 /* Group: DT_GROUND_TYPES                                                     */
 /*                                                                            */
 /* A list of all possible ground types for background tiles. These are used   */
-/* in the path finding algorithm. DAT - Where will the solution to expense(Ground_type, unit_type) be? */
+/* in the path finding algorithm, where dt_cost_unit_class_tile_type looks up */
+/* the cost for each unit class to move onto each of them.                    */
 /******************************************************************************/
 #define DT_GROUND_TYPE_PLAIN    0x0000
 #define DT_GROUND_TYPE_SWAMP    0x0001
 #define DT_GROUND_TYPE_MOUNTAIN 0x0002
 #define DT_GROUND_TYPE_RIVER    0x0003
 
+/******************************************************************************/
+/* The number of DT_GROUND_TYPES, for tables with an entry for each of them.  */
+/******************************************************************************/
+#define DT_NUM_GROUND_TYPES 4
+
 /******************************************************************************/
 /* DT_BACKGROUND_TILE:                                                        */
 /*                                                                            */
@@ -23,6 +29,9 @@
 /* elevation - The height above sea level (this is a signed integer).         */
 /* water_depth - The depth of water across the tile. Set to 0 for non-watery  */
 /*               tiles.                                                       */
+/* movement_modifier - The extra cost of moving across the tile.              */
+/* graphic_name - The name of the file holding the graphic, if the tile came  */
+/*                from a map file. Owned by the tile.                         */
 /******************************************************************************/
 typedef struct dt_background_tile
 {
@@ -32,4 +41,5 @@ typedef struct dt_background_tile
   int elevation;
   int water_depth;
   int movement_modifier;
+  char *graphic_name;
 } DT_BACKGROUND_TILE;
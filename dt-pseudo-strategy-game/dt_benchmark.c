@@ -0,0 +1,2929 @@
+/******************************************************************************/
+/* File: dt_benchmark.c                                                       */
+/*                                                                            */
+/* Purpose: Performance benchmarks for the map and pathing code. These are    */
+/*          run instead of the game when the program is started with          */
+/*          "-benchmark <name>" and print their results to stdout.            */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_run_benchmark                                                 */
+/*                                                                            */
+/* Purpose: Run a benchmark by name.                                          */
+/*                                                                            */
+/* Returns: DT_BENCHMARK_OK if the benchmark was run.                         */
+/*          DT_BENCHMARK_UNKNOWN if there is no benchmark with that name.     */
+/*                                                                            */
+/* Parameters: IN     name - The name of the benchmark to run.                */
+/*                                                                            */
+/* Operation: Compare the name against each benchmark in turn and run the     */
+/*            one that matches.                                               */
+/******************************************************************************/
+int dt_run_benchmark(char *name)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code = DT_BENCHMARK_OK;
+
+  if (0 == strcmp(name, "layout"))
+  {
+    dt_benchmark_grid_layouts();
+  }
+  else if (0 == strcmp(name, "mapload"))
+  {
+    dt_benchmark_map_loading();
+  }
+  else if (0 == strcmp(name, "compress"))
+  {
+    dt_benchmark_chunk_compression();
+  }
+  else if (0 == strcmp(name, "mapgen"))
+  {
+    dt_benchmark_map_generator();
+  }
+  else if (0 == strcmp(name, "pathing"))
+  {
+    dt_benchmark_path_search();
+  }
+  else if (0 == strcmp(name, "jump"))
+  {
+    dt_benchmark_jump_point_search();
+  }
+  else if (0 == strcmp(name, "hierarchy"))
+  {
+    dt_benchmark_path_hierarchy();
+  }
+  else if (0 == strcmp(name, "flow"))
+  {
+    dt_benchmark_flow_field();
+  }
+  else if (0 == strcmp(name, "range"))
+  {
+    dt_benchmark_movement_range();
+  }
+  else if (0 == strcmp(name, "cache"))
+  {
+    dt_benchmark_path_cache();
+  }
+  else if (0 == strcmp(name, "replan"))
+  {
+    dt_benchmark_replanner();
+  }
+  else if (0 == strcmp(name, "batch"))
+  {
+    dt_benchmark_path_service();
+  }
+  else if (0 == strcmp(name, "slice"))
+  {
+    dt_benchmark_path_scheduler();
+  }
+  else if (0 == strcmp(name, "coop"))
+  {
+    dt_benchmark_cooperative_paths();
+  }
+  else if (0 == strcmp(name, "regions"))
+  {
+    dt_benchmark_region_map();
+  }
+  else if (0 == strcmp(name, "landmarks"))
+  {
+    dt_benchmark_landmarks();
+  }
+  else
+  {
+    fprintf(stderr, "Unknown benchmark %s. Available benchmarks are:\n", name);
+    fprintf(stderr, "  layout - Row-major against Morton grid storage.\n");
+    fprintf(stderr, "  mapload - Text map parsing and binary map opening.\n");
+    fprintf(stderr, "  compress - Chunk compression in memory.\n");
+    fprintf(stderr, "  mapgen - Procedural map generation.\n");
+    fprintf(stderr, "  pathing - A* path search.\n");
+    fprintf(stderr, "  jump - Jump point search against A*.\n");
+    fprintf(stderr, "  hierarchy - Hierarchical path search against A*.\n");
+    fprintf(stderr, "  flow - Flow fields against A* for a group.\n");
+    fprintf(stderr, "  range - Movement ranges of selected units.\n");
+    fprintf(stderr, "  cache - Path cache over turns of AI requests.\n");
+    fprintf(stderr, "  replan - D* Lite against A* as the map changes.\n");
+    fprintf(stderr, "  batch - Batched path requests on worker pools.\n");
+    fprintf(stderr, "  slice - Time-sliced searches against blocking ones.\n");
+    fprintf(stderr, "  coop - Cooperative plans against lone replanners.\n");
+    fprintf(stderr, "  regions - Searches to goals which cannot be reached.\n");
+    fprintf(stderr, "  landmarks - A* with landmark estimates.\n");
+    ret_code = DT_BENCHMARK_UNKNOWN;
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_random                                              */
+/*                                                                            */
+/* Purpose: Generate a pseudo random number for a benchmark.                  */
+/*                                                                            */
+/* Returns: The next number in the sequence.                                  */
+/*                                                                            */
+/* Parameters: IN/OUT state - The state of the generator. Must not be zero.   */
+/*                                                                            */
+/* Operation: A 32 bit xorshift generator. It is used in place of rand() so   */
+/*            that every platform does the same work for the same seed.       */
+/******************************************************************************/
+Uint32 dt_benchmark_random(Uint32 *state)
+{
+  (*state) ^= (*state) << 13;
+  (*state) ^= (*state) >> 17;
+  (*state) ^= (*state) << 5;
+
+  return(*state);
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_fill_grid                                           */
+/*                                                                            */
+/* Purpose: Fill a grid with random terrain for a benchmark.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to fill.                                */
+/*             IN     blocked_percent - The percentage of points which are    */
+/*                                      to be made untraversable.             */
+/*             IN     seed - The seed for the random numbers.                 */
+/*                                                                            */
+/* Operation: Add a tile type for each of the DT_GROUND_TYPES to the grid,    */
+/*            then assign a random one of them to each point and block the    */
+/*            requested proportion of points.                                 */
+/******************************************************************************/
+void dt_benchmark_fill_grid(DT_GRID *grid, int blocked_percent, Uint32 seed)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  int tile_types[4];
+  Uint32 state = seed;
+  Uint32 random;
+  int row;
+  int col;
+  int ii;
+
+  for (ii = 0; ii < 4; ii++)
+  {
+    tile = dt_create_background_tile();
+    tile->terrain_type = ii;
+    tile->movement_modifier = ii * 2;
+    dt_add_tile_type_to_grid(grid, tile, &(tile_types[ii]));
+  }
+
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      random = dt_benchmark_random(&state);
+      dt_assign_tile_type_to_grid(grid, col, row, tile_types[random & 0x3]);
+      if ((int) ((random >> 8) % 100) < blocked_percent)
+      {
+        dt_set_grid_traversable(grid, col, row, false);
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_astar_pattern                                       */
+/*                                                                            */
+/* Purpose: Touch a grid in the way that an A* search does.                   */
+/*                                                                            */
+/* Returns: A checksum of the values read so that the work cannot be          */
+/*          optimised away.                                                   */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to search.                              */
+/*             IN     g_cost - A scratch array with an entry per grid point.  */
+/*             IN     seed - The seed for the random numbers.                 */
+/*                                                                            */
+/* Operation: For each query pick a start and a nearby goal. Then repeatedly  */
+/*            expand the current point: read the traversability, terrain type */
+/*            and movement modifier of each of its 8 neighbours, relax their  */
+/*            entries in the cost array, and move to the neighbour closest to */
+/*            the goal (with some noise so the frontier spreads sideways as a */
+/*            real search does).                                              */
+/******************************************************************************/
+Uint32 dt_benchmark_astar_pattern(DT_GRID *grid, Uint32 *g_cost, Uint32 seed)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID_NEIGHBOUR_ITERATOR neighbours;
+  Uint32 state = seed;
+  Uint32 checksum = 0;
+  Uint32 cost;
+  int query;
+  int expansion;
+  int curr_x;
+  int curr_y;
+  int goal_x;
+  int goal_y;
+  int best_x;
+  int best_y;
+  int best_score;
+  int score;
+  int range = DT_LAYOUT_BENCH_GOAL_RANGE;
+
+  for (query = 0; query < DT_LAYOUT_BENCH_QUERIES; query++)
+  {
+    /**************************************************************************/
+    /* Choose the start and goal of this query.                               */
+    /**************************************************************************/
+    curr_x = dt_benchmark_random(&state) % grid->num_tiles_x;
+    curr_y = dt_benchmark_random(&state) % grid->num_tiles_y;
+    goal_x = CLAMP(curr_x + (int) (dt_benchmark_random(&state) % (2 * range))
+                                    - range, 0, grid->num_tiles_x - 1);
+    goal_y = CLAMP(curr_y + (int) (dt_benchmark_random(&state) % (2 * range))
+                                    - range, 0, grid->num_tiles_y - 1);
+
+    for (expansion = 0; expansion < DT_LAYOUT_BENCH_EXPANSIONS; expansion++)
+    {
+      /************************************************************************/
+      /* Expand the current point.                                            */
+      /************************************************************************/
+      best_x = curr_x;
+      best_y = curr_y;
+      best_score = 0x7FFFFFFF;
+      dt_init_grid_neighbour_iterator(&neighbours, grid, curr_x, curr_y, 1);
+      while (dt_next_grid_neighbour(&neighbours))
+      {
+        if (!dt_is_grid_traversable(grid, neighbours.x, neighbours.y))
+        {
+          continue;
+        }
+        cost = grid->terrain_type[neighbours.index] +
+                                grid->movement_modifier[neighbours.index] + 1;
+        if (g_cost[neighbours.index] > cost)
+        {
+          g_cost[neighbours.index] = cost;
+        }
+        checksum += cost;
+
+        score = (abs(goal_x - neighbours.x) + abs(goal_y - neighbours.y)) * 4 +
+                                    (int) (dt_benchmark_random(&state) & 0x7);
+        if (score < best_score)
+        {
+          best_score = score;
+          best_x = neighbours.x;
+          best_y = neighbours.y;
+        }
+      }
+
+      /************************************************************************/
+      /* Move on to the chosen neighbour, finishing if the goal is reached or */
+      /* the search is boxed in.                                              */
+      /************************************************************************/
+      if (((best_x == goal_x) && (best_y == goal_y)) ||
+          ((best_x == curr_x) && (best_y == curr_y)))
+      {
+        break;
+      }
+      curr_x = best_x;
+      curr_y = best_y;
+    }
+  }
+
+  return(checksum);
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_flood_fill                                          */
+/*                                                                            */
+/* Purpose: Flood fill the traversable region around the centre of a grid.    */
+/*                                                                            */
+/* Returns: The number of points reached.                                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to fill.                                */
+/*             IN     visited - A scratch array with a byte per grid point.   */
+/*             IN     queue - A scratch array with room for every point.      */
+/*                                                                            */
+/* Operation: Breadth first search over the 8 neighbours of each point,       */
+/*            reading each neighbour's traversability and terrain type.       */
+/*            Queue entries hold x in the low and y in the high 16 bits.      */
+/******************************************************************************/
+long dt_benchmark_flood_fill(DT_GRID *grid,
+                             unsigned char *visited,
+                             Uint32 *queue)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID_NEIGHBOUR_ITERATOR neighbours;
+  long head = 0;
+  long tail = 0;
+  int curr_x;
+  int curr_y;
+
+  memset(visited, 0, grid->num_points);
+
+  curr_x = grid->num_tiles_x / 2;
+  curr_y = grid->num_tiles_y / 2;
+  dt_set_grid_traversable(grid, curr_x, curr_y, true);
+  visited[dt_get_grid_index(grid, curr_x, curr_y)] = 1;
+  queue[tail++] = ((Uint32) curr_y << 16) | (Uint32) curr_x;
+
+  while (head < tail)
+  {
+    curr_x = queue[head] & 0xFFFF;
+    curr_y = queue[head] >> 16;
+    head++;
+
+    dt_init_grid_neighbour_iterator(&neighbours, grid, curr_x, curr_y, 1);
+    while (dt_next_grid_neighbour(&neighbours))
+    {
+      if ((0 == visited[neighbours.index]) &&
+          (DT_GROUND_TYPE_MOUNTAIN != grid->terrain_type[neighbours.index]) &&
+          dt_is_grid_traversable(grid, neighbours.x, neighbours.y))
+      {
+        visited[neighbours.index] = 1;
+        queue[tail++] = ((Uint32) neighbours.y << 16) | (Uint32) neighbours.x;
+      }
+    }
+  }
+
+  return(tail);
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_grid_layouts                                        */
+/*                                                                            */
+/* Purpose: Compare row-major and Morton grid storage on A* style and flood   */
+/*          fill access patterns.                                             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: For 2048 and 8192 square maps, build the same random map in     */
+/*            each storage type and time each access pattern over it. The     */
+/*            checksums are printed so that the runs can be seen to have done */
+/*            identical work.                                                 */
+/******************************************************************************/
+void dt_benchmark_grid_layouts()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const int sizes[] = {2048, 8192};
+  static const int storages[] = {DT_GRID_STORAGE_ROW_MAJOR,
+                                 DT_GRID_STORAGE_MORTON};
+  static char *storage_names[] = {"row-major", "chunked", "morton"};
+  DT_GRID *grid;
+  Uint32 *g_cost;
+  unsigned char *visited;
+  Uint32 *queue;
+  Uint32 checksum;
+  long reached;
+  Uint64 start_time;
+  Uint64 astar_time;
+  Uint64 fill_time;
+  int size_index;
+  int storage_index;
+
+  printf("Grid layout benchmark: %d A* style queries of %d expansions, "
+         "full flood fill, %d%% blocked.\n",
+         DT_LAYOUT_BENCH_QUERIES,
+         DT_LAYOUT_BENCH_EXPANSIONS,
+         DT_LAYOUT_BENCH_BLOCKED_PERCENT);
+
+  for (size_index = 0; size_index < 2; size_index++)
+  {
+    for (storage_index = 0; storage_index < 2; storage_index++)
+    {
+      /************************************************************************/
+      /* Build the map and the scratch arrays for the searches.               */
+      /************************************************************************/
+      grid = dt_create_grid_with_storage(1,
+                                         1,
+                                         sizes[size_index],
+                                         sizes[size_index],
+                                         storages[storage_index]);
+      dt_benchmark_fill_grid(grid,
+                             DT_LAYOUT_BENCH_BLOCKED_PERCENT,
+                             DT_BENCHMARK_SEED);
+      g_cost = (Uint32 *) dt_malloc(sizeof(Uint32) * grid->num_points);
+      memset(g_cost, 0xFF, sizeof(Uint32) * grid->num_points);
+
+      /************************************************************************/
+      /* Time the A* style searches.                                          */
+      /************************************************************************/
+      start_time = dt_get_time_us();
+      checksum = dt_benchmark_astar_pattern(grid, g_cost, DT_BENCHMARK_SEED);
+      astar_time = dt_get_time_us() - start_time;
+      dt_free(g_cost);
+
+      /************************************************************************/
+      /* Time the flood fill.                                                 */
+      /************************************************************************/
+      visited = (unsigned char *) dt_malloc(grid->num_points);
+      queue = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                       (size_t) grid->num_tiles_x * (size_t) grid->num_tiles_y);
+      start_time = dt_get_time_us();
+      reached = dt_benchmark_flood_fill(grid, visited, queue);
+      fill_time = dt_get_time_us() - start_time;
+      dt_free(queue);
+      dt_free(visited);
+
+      printf("%5d x %-5d %-9s  a*-style %9.1f ms (checksum %08x)  "
+             "flood-fill %9.1f ms (%ld points)\n",
+             grid->num_tiles_x,
+             grid->num_tiles_y,
+             storage_names[storages[storage_index]],
+             astar_time / 1000.0,
+             (unsigned int) checksum,
+             fill_time / 1000.0,
+             reached);
+
+      dt_destroy_grid(grid);
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_map_loading                                         */
+/*                                                                            */
+/* Purpose: Measure how fast text maps are parsed and binary maps opened.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Build a random map with some elevation overrides, write it as a */
+/*            text map and time loading it back on one thread and then on all */
+/*            of them, reporting megabytes and tiles a second. Check each     */
+/*            loaded map matches the original, then write it as a binary map  */
+/*            and time opening that. The files are written to the current     */
+/*            directory and removed afterwards.                               */
+/******************************************************************************/
+void dt_benchmark_map_loading()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  DT_GRID *loaded_grid;
+  Uint32 state = DT_BENCHMARK_SEED;
+  Uint64 start_time;
+  Uint64 write_time;
+  Uint64 load_time[2];
+  Uint64 open_time;
+  double megabytes;
+  double num_tiles;
+  bool matches;
+  int num_threads;
+  int ret_code;
+  int pass;
+  int row;
+  int col;
+
+  /****************************************************************************/
+  /* Build the map and write it out as text.                                  */
+  /****************************************************************************/
+  grid = dt_create_grid(1, 1, DT_MAPLOAD_BENCH_SIZE, DT_MAPLOAD_BENCH_SIZE);
+  dt_benchmark_fill_grid(grid, DT_LAYOUT_BENCH_BLOCKED_PERCENT, state);
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      if (0 == (dt_benchmark_random(&state) & 0x7))
+      {
+        dt_set_grid_terrain_overrides(grid,
+                                      col,
+                                      row,
+                                      (int) (state >> 20) - 2048,
+                                      dt_get_grid_water_depth(grid, col, row),
+                                      dt_get_grid_movement_modifier(grid,
+                                                                    col,
+                                                                    row));
+      }
+    }
+  }
+  start_time = dt_get_time_us();
+  ret_code = dt_write_text_map_file(grid, DT_MAPLOAD_BENCH_TEXT_FILE);
+  write_time = dt_get_time_us() - start_time;
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to write %s.\n", DT_MAPLOAD_BENCH_TEXT_FILE);
+    goto EXIT_LABEL;
+  }
+
+  megabytes = (double) dt_get_file_size(DT_MAPLOAD_BENCH_TEXT_FILE) /
+                                                             (1024.0 * 1024.0);
+  num_tiles = (double) grid->num_tiles_x * (double) grid->num_tiles_y;
+  printf("Text map %d x %d, %.1f MB: written in %.1f ms\n",
+         grid->num_tiles_x,
+         grid->num_tiles_y,
+         megabytes,
+         write_time / 1000.0);
+
+  /****************************************************************************/
+  /* Time loading it back as a single job and then shared out over the master */
+  /* worker pool, and check both match.                                       */
+  /****************************************************************************/
+  for (pass = 0; pass < 2; pass++)
+  {
+    num_threads = (0 == pass) ? 1 :
+                                  dt_get_master_worker_pool()->num_threads + 1;
+    start_time = dt_get_time_us();
+    ret_code = dt_load_text_map_file(DT_MAPLOAD_BENCH_TEXT_FILE,
+                                     (0 == pass) ? 1 : DT_MAP_TEXT_AUTO_JOBS,
+                                     &loaded_grid);
+    load_time[pass] = MAX(dt_get_time_us() - start_time, 1);
+    if (DT_MAP_FILE_LOADED != ret_code)
+    {
+      fprintf(stderr, "Failed to load %s (error %d).\n",
+              DT_MAPLOAD_BENCH_TEXT_FILE,
+              ret_code);
+      goto EXIT_LABEL;
+    }
+    matches = dt_benchmark_grids_match(grid, loaded_grid);
+    dt_destroy_grid(loaded_grid);
+    printf("  %d thread(s): loaded in %.1f ms (%.1f MB/s, "
+           "%.2f million tiles/s)%s\n",
+           num_threads,
+           load_time[pass] / 1000.0,
+           megabytes * 1000000.0 / load_time[pass],
+           num_tiles / load_time[pass],
+           matches ? "" : " MISMATCH");
+  }
+  printf("  Speed up %.2f\n", (double) load_time[0] / load_time[1]);
+
+  /****************************************************************************/
+  /* Write it as a binary map and time opening that.                          */
+  /****************************************************************************/
+  ret_code = dt_write_binary_map_file(grid, DT_MAPLOAD_BENCH_BINARY_FILE);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to write %s.\n", DT_MAPLOAD_BENCH_BINARY_FILE);
+    goto EXIT_LABEL;
+  }
+  start_time = dt_get_time_us();
+  ret_code = dt_load_grid_from_file(DT_MAPLOAD_BENCH_BINARY_FILE,
+                                    &loaded_grid);
+  open_time = dt_get_time_us() - start_time;
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to load %s (error %d).\n",
+            DT_MAPLOAD_BENCH_BINARY_FILE,
+            ret_code);
+    goto EXIT_LABEL;
+  }
+  matches = dt_benchmark_grids_match(grid, loaded_grid);
+  dt_destroy_grid(loaded_grid);
+  printf("Binary map %.1f MB: opened in %.3f ms%s\n",
+         (double) dt_get_file_size(DT_MAPLOAD_BENCH_BINARY_FILE) /
+                                                             (1024.0 * 1024.0),
+         open_time / 1000.0,
+         matches ? "" : " MISMATCH");
+
+EXIT_LABEL:
+
+  remove(DT_MAPLOAD_BENCH_TEXT_FILE);
+  remove(DT_MAPLOAD_BENCH_BINARY_FILE);
+  dt_destroy_grid(grid);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_chunk_compression                                   */
+/*                                                                            */
+/* Purpose: Measure how well the chunks of a grid compress with each encoding */
+/*          and how long they take to compress and inflate.                   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Build a map of regions, as real maps have, in a row-major grid  */
+/*            to compare against. For each encoding build the same map in a   */
+/*            chunked grid and time compressing its chunks. Then read every   */
+/*            point, inflating every chunk, and check it matches. Report the  */
+/*            memory used before and after compressing, after reading, and    */
+/*            after compacting back down to DT_COMPRESS_BENCH_MAX_INFLATED    */
+/*            chunks.                                                         */
+/******************************************************************************/
+void dt_benchmark_chunk_compression()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const int encodings[] = {DT_CHUNK_ENCODING_RLE,
+                                  DT_CHUNK_ENCODING_ZLIB};
+  static const char *encoding_names[] = {"RLE", "zlib"};
+  DT_GRID *grid;
+  DT_GRID *chunked_grid;
+  DT_CHUNK_STORE *store;
+  Uint64 start_time;
+  Uint64 compress_time;
+  double raw_bytes;
+  size_t memory[4];
+  long num_chunks;
+  bool matches;
+  int ii;
+
+  grid = dt_create_grid(1, 1, DT_COMPRESS_BENCH_SIZE, DT_COMPRESS_BENCH_SIZE);
+  dt_benchmark_fill_regions(grid, DT_BENCHMARK_SEED);
+  printf("Map %d x %d in %d x %d regions\n",
+         grid->num_tiles_x,
+         grid->num_tiles_y,
+         DT_COMPRESS_BENCH_REGION,
+         DT_COMPRESS_BENCH_REGION);
+
+  for (ii = 0; ii < 2; ii++)
+  {
+    chunked_grid = dt_create_grid_with_storage(1,
+                                               1,
+                                               DT_COMPRESS_BENCH_SIZE,
+                                               DT_COMPRESS_BENCH_SIZE,
+                                               DT_GRID_STORAGE_CHUNKED);
+    dt_benchmark_fill_regions(chunked_grid, DT_BENCHMARK_SEED);
+    num_chunks = chunked_grid->num_allocated_chunks;
+    raw_bytes = (double) num_chunks * sizeof(DT_MAP_FILE_CHUNK);
+    memory[0] = dt_get_grid_memory_usage(chunked_grid);
+
+    start_time = dt_get_time_us();
+    dt_compress_grid_chunks(chunked_grid,
+                            encodings[ii],
+                            DT_COMPRESS_BENCH_MAX_INFLATED);
+    compress_time = dt_get_time_us() - start_time;
+    store = chunked_grid->chunk_store;
+    memory[1] = dt_get_grid_memory_usage(chunked_grid);
+
+    matches = dt_benchmark_grids_match(grid, chunked_grid);
+    memory[2] = dt_get_grid_memory_usage(chunked_grid);
+    dt_compact_grid_chunks(chunked_grid);
+    memory[3] = dt_get_grid_memory_usage(chunked_grid);
+
+    printf("  %s: %ld chunks, ratio %.2f, compressed in %.1f us and "
+           "inflated in %.1f us per chunk%s\n",
+           encoding_names[ii],
+           num_chunks,
+           raw_bytes / (double) MAX(store->compressed_bytes, 1),
+           (double) compress_time / (double) MAX(num_chunks, 1),
+           (double) store->inflate_time_us /
+                                       (double) MAX(store->num_inflations, 1),
+           matches ? "" : " MISMATCH");
+    printf("    Memory %.1f MB inflated, %.1f MB compressed, "
+           "%.1f MB all read, %.1f MB compacted\n",
+           memory[0] / (1024.0 * 1024.0),
+           memory[1] / (1024.0 * 1024.0),
+           memory[2] / (1024.0 * 1024.0),
+           memory[3] / (1024.0 * 1024.0));
+    dt_destroy_grid(chunked_grid);
+  }
+
+  dt_destroy_grid(grid);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_fill_regions                                        */
+/*                                                                            */
+/* Purpose: Fill a grid with square regions of random terrain for a           */
+/*          benchmark.                                                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to fill.                                */
+/*             IN     seed - The seed for the random numbers.                 */
+/*                                                                            */
+/* Operation: Add a tile type for each of the DT_GROUND_TYPES to the grid.    */
+/*            Give each region of DT_COMPRESS_BENCH_REGION points square a    */
+/*            random one of them and a random elevation, and block one region */
+/*            in eight.                                                       */
+/******************************************************************************/
+void dt_benchmark_fill_regions(DT_GRID *grid, Uint32 seed)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  int tile_types[4];
+  Uint32 state = seed;
+  Uint32 random;
+  int region_x;
+  int region_y;
+  int row;
+  int col;
+  int ii;
+
+  for (ii = 0; ii < 4; ii++)
+  {
+    tile = dt_create_background_tile();
+    tile->terrain_type = ii;
+    tile->movement_modifier = ii * 2;
+    dt_add_tile_type_to_grid(grid, tile, &(tile_types[ii]));
+  }
+
+  for (region_y = 0;
+       region_y < grid->num_tiles_y;
+       region_y += DT_COMPRESS_BENCH_REGION)
+  {
+    for (region_x = 0;
+         region_x < grid->num_tiles_x;
+         region_x += DT_COMPRESS_BENCH_REGION)
+    {
+      random = dt_benchmark_random(&state);
+      for (row = region_y;
+           row < MIN(region_y + DT_COMPRESS_BENCH_REGION, grid->num_tiles_y);
+           row++)
+      {
+        for (col = region_x;
+             col < MIN(region_x + DT_COMPRESS_BENCH_REGION, grid->num_tiles_x);
+             col++)
+        {
+          dt_assign_tile_type_to_grid(grid, col, row, tile_types[random & 0x3]);
+          dt_set_grid_terrain_overrides(grid,
+                                        col,
+                                        row,
+                                        (int) ((random >> 4) & 0x3FF),
+                                        0,
+                                        (random & 0x3) * 2);
+          if (0 == ((random >> 16) & 0x7))
+          {
+            dt_set_grid_traversable(grid, col, row, false);
+          }
+        }
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_grids_match                                         */
+/*                                                                            */
+/* Purpose: Check two grids hold the same map.                                */
+/*                                                                            */
+/* Returns: true if every point has the same tile type, layer values and      */
+/*          traversability in both grids.                                     */
+/*                                                                            */
+/* Parameters: IN     grid - One grid.                                        */
+/*             IN     other_grid - The other grid.                            */
+/*                                                                            */
+/* Operation: Compare the sizes and then every point through the accessors,   */
+/*            so that grids with different storage can be compared.           */
+/******************************************************************************/
+bool dt_benchmark_grids_match(DT_GRID *grid, DT_GRID *other_grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  bool matches = true;
+  int row;
+  int col;
+
+  if ((grid->num_tiles_x != other_grid->num_tiles_x) ||
+      (grid->num_tiles_y != other_grid->num_tiles_y) ||
+      (grid->num_tile_types != other_grid->num_tile_types))
+  {
+    matches = false;
+    goto EXIT_LABEL;
+  }
+
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      if ((dt_get_grid_tile_type(grid, col, row) !=
+                               dt_get_grid_tile_type(other_grid, col, row)) ||
+          (dt_get_grid_terrain_type(grid, col, row) !=
+                            dt_get_grid_terrain_type(other_grid, col, row)) ||
+          (dt_get_grid_elevation(grid, col, row) !=
+                               dt_get_grid_elevation(other_grid, col, row)) ||
+          (dt_get_grid_water_depth(grid, col, row) !=
+                             dt_get_grid_water_depth(other_grid, col, row)) ||
+          (dt_get_grid_movement_modifier(grid, col, row) !=
+                       dt_get_grid_movement_modifier(other_grid, col, row)) ||
+          (dt_is_grid_traversable(grid, col, row) !=
+                              dt_is_grid_traversable(other_grid, col, row)))
+      {
+        matches = false;
+        goto EXIT_LABEL;
+      }
+    }
+  }
+
+EXIT_LABEL:
+
+  return(matches);
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_map_generator                                       */
+/*                                                                            */
+/* Purpose: Measure how fast maps are generated and check they do not depend  */
+/*          on how they are stored.                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate maps from DT_MAPGEN_BENCH_MIN_SIZE to                  */
+/*            DT_MAPGEN_BENCH_MAX_SIZE square into chunked grids and report   */
+/*            the time taken and the mix of terrain. Maps up to               */
+/*            DT_MAPGEN_BENCH_MATCH_SIZE are generated again into row-major   */
+/*            grids to check they match. The largest map is also written      */
+/*            straight out to a chunked binary map, which is loaded back and  */
+/*            checked.                                                        */
+/******************************************************************************/
+void dt_benchmark_map_generator()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_GRID *other_grid;
+  Uint64 start_time;
+  Uint64 generate_time;
+  double num_tiles;
+  long terrain_counts[DT_MAPGEN_NUM_TILE_TYPES];
+  long num_blocked;
+  bool matches;
+  int ret_code;
+  int size;
+
+  for (size = DT_MAPGEN_BENCH_MIN_SIZE;
+       size <= DT_MAPGEN_BENCH_MAX_SIZE;
+       size *= 4)
+  {
+    generator = dt_create_map_generator(size,
+                                        size,
+                                        DT_BENCHMARK_SEED,
+                                        DT_MAPGEN_BENCH_UNITS);
+    start_time = dt_get_time_us();
+    grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+    generate_time = MAX(dt_get_time_us() - start_time, 1);
+    num_tiles = (double) size * (double) size;
+    dt_benchmark_count_terrain(grid, terrain_counts, &num_blocked);
+    printf("%5d x %-5d generated in %9.1f ms (%.1f M tiles/s), %d units\n",
+           size,
+           size,
+           generate_time / 1000.0,
+           num_tiles / (double) generate_time,
+           generator->num_units);
+    printf("              plain %.1f%%, swamp %.1f%%, mountain %.1f%%, "
+           "river %.1f%%, blocked %.1f%%\n",
+           100.0 * terrain_counts[DT_GROUND_TYPE_PLAIN] / num_tiles,
+           100.0 * terrain_counts[DT_GROUND_TYPE_SWAMP] / num_tiles,
+           100.0 * terrain_counts[DT_GROUND_TYPE_MOUNTAIN] / num_tiles,
+           100.0 * terrain_counts[DT_GROUND_TYPE_RIVER] / num_tiles,
+           100.0 * num_blocked / num_tiles);
+
+    if (size <= DT_MAPGEN_BENCH_MATCH_SIZE)
+    {
+      other_grid = dt_generate_map(generator, DT_GRID_STORAGE_ROW_MAJOR);
+      matches = dt_benchmark_grids_match(grid, other_grid);
+      printf("              row-major grid %s\n",
+             matches ? "matches" : "MISMATCH");
+      dt_destroy_grid(other_grid);
+    }
+
+    if (DT_MAPGEN_BENCH_MAX_SIZE == size)
+    {
+      start_time = dt_get_time_us();
+      ret_code = dt_write_generated_map_file(generator,
+                                             DT_MAPGEN_BENCH_FILE,
+                                             DT_CHUNK_ENCODING_ZLIB);
+      generate_time = dt_get_time_us() - start_time;
+      if (DT_MAP_FILE_LOADED != ret_code)
+      {
+        fprintf(stderr, "Failed to write %s.\n", DT_MAPGEN_BENCH_FILE);
+      }
+      else
+      {
+        ret_code = dt_load_compressed_map_file(DT_MAPGEN_BENCH_FILE,
+                                               0,
+                                               &other_grid);
+        matches = (DT_MAP_FILE_LOADED == ret_code) &&
+                                     dt_benchmark_grids_match(grid, other_grid);
+        printf("              written to %.1f MB file in %.1f ms, "
+               "loaded file %s\n",
+               (double) dt_get_file_size(DT_MAPGEN_BENCH_FILE) /
+                                                             (1024.0 * 1024.0),
+               generate_time / 1000.0,
+               matches ? "matches" : "MISMATCH");
+        if (DT_MAP_FILE_LOADED == ret_code)
+        {
+          dt_destroy_grid(other_grid);
+        }
+      }
+      remove(DT_MAPGEN_BENCH_FILE);
+    }
+
+    dt_destroy_grid(grid);
+    dt_destroy_map_generator(generator);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_count_terrain                                       */
+/*                                                                            */
+/* Purpose: Count the points of each terrain type on a grid.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to count.                               */
+/*             OUT    terrain_counts - The number of points of each of the    */
+/*                                     DT_GROUND_TYPES.                       */
+/*             OUT    num_blocked - The number of points which cannot be      */
+/*                                  crossed.                                  */
+/*                                                                            */
+/* Operation: Read every point through the accessors.                         */
+/******************************************************************************/
+void dt_benchmark_count_terrain(DT_GRID *grid,
+                                long *terrain_counts,
+                                long *num_blocked)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int terrain_type;
+  int row;
+  int col;
+
+  memset(terrain_counts, 0, sizeof(long) * DT_MAPGEN_NUM_TILE_TYPES);
+  (*num_blocked) = 0;
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      terrain_type = dt_get_grid_terrain_type(grid, col, row);
+      if ((terrain_type >= 0) && (terrain_type < DT_MAPGEN_NUM_TILE_TYPES))
+      {
+        terrain_counts[terrain_type]++;
+      }
+      if (!dt_is_grid_traversable(grid, col, row))
+      {
+        (*num_blocked)++;
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_search                                         */
+/*                                                                            */
+/* Purpose: Measure the throughput of A* path search.                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map with a unit start point for every query and      */
+/*            build it with each grid storage. On each grid search from every */
+/*            start point to the next and report the nodes expanded per       */
+/*            second, which is the figure to compare between versions, along  */
+/*            with the time per search. Then run the same searches on the     */
+/*            row-major grid with orientation, and report how many more nodes */
+/*            they expand than the plain searches.                            */
+/******************************************************************************/
+void dt_benchmark_path_search()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const int storages[] = {DT_GRID_STORAGE_ROW_MAJOR,
+                                 DT_GRID_STORAGE_CHUNKED,
+                                 DT_GRID_STORAGE_MORTON};
+  static const char *storage_names[] = {"row-major", "chunked", "Morton"};
+  static const int turn_costs[] = {0, DT_PATH_DEFAULT_TURN_COST, 8};
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  Uint64 plain_nodes_expanded = 0;
+  char name[32];
+  int storage_index;
+  int ii;
+
+  generator = dt_create_map_generator(DT_PATH_BENCH_SIZE,
+                                      DT_PATH_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_PATH_BENCH_QUERIES + 1);
+  printf("Path search benchmark: %d searches on a generated %d x %d map\n",
+         generator->num_units - 1,
+         DT_PATH_BENCH_SIZE,
+         DT_PATH_BENCH_SIZE);
+
+  for (storage_index = 0; storage_index < 3; storage_index++)
+  {
+    grid = dt_generate_map(generator, storages[storage_index]);
+    search = dt_create_path_search(grid);
+    dt_benchmark_path_queries(generator,
+                              search,
+                              0,
+                              false,
+                              storage_names[storage_index]);
+    if (DT_GRID_STORAGE_ROW_MAJOR == storages[storage_index])
+    {
+      plain_nodes_expanded = search->total_nodes_expanded;
+    }
+    dt_destroy_path_search(search);
+
+    if (DT_GRID_STORAGE_ROW_MAJOR == storages[storage_index])
+    {
+      search = dt_create_path_search_with_orientation(grid, true);
+      for (ii = 0; ii < 3; ii++)
+      {
+        sprintf(name, "turn %d", turn_costs[ii]);
+        dt_benchmark_path_queries(generator,
+                                  search,
+                                  turn_costs[ii],
+                                  false,
+                                  name);
+        printf("             %.2f times the nodes of a plain search\n",
+               (double) search->total_nodes_expanded /
+                                      (double) MAX(plain_nodes_expanded, 1));
+        search->total_nodes_expanded = 0;
+        search->total_search_time_us = 0;
+        search->num_searches = 0;
+      }
+      dt_destroy_path_search(search);
+    }
+    dt_destroy_grid(grid);
+  }
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_queries                                        */
+/*                                                                            */
+/* Purpose: Run the searches of the path search benchmark and report them.    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map searched, whose    */
+/*                                units give the start and goal of each       */
+/*                                search.                                     */
+/*             IN/OUT search - The search state for the grid. Its totals are  */
+/*                             added to.                                      */
+/*             IN     turn_cost - The cost of each eighth of a turn if the    */
+/*                                search is oriented.                         */
+/*             IN     jump_points - Whether to use jump point search rather   */
+/*                                  than A*. The search must not be oriented. */
+/*             IN     name - The name to print for the searches.              */
+/*                                                                            */
+/* Operation: Search from every unit to the next. The unit searching starts   */
+/*            facing the way the generator gave it. The total cost of the     */
+/*            paths is printed as a checksum, which must be the same for      */
+/*            every storage.                                                  */
+/******************************************************************************/
+void dt_benchmark_path_queries(DT_MAP_GENERATOR *generator,
+                               DT_PATH_SEARCH *search,
+                               int turn_cost,
+                               bool jump_points,
+                               const char *name)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH *path;
+  DT_MAP_UNIT_PLACEMENT *start;
+  DT_MAP_UNIT_PLACEMENT *goal;
+  DT_UNIT unit;
+  double total_cost = 0.0;
+  long num_found = 0;
+  long path_points = 0;
+  int ret_code;
+  int ii;
+
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+  for (ii = 0; ii + 1 < generator->num_units; ii++)
+  {
+    start = &(generator->units[ii]);
+    goal = &(generator->units[ii + 1]);
+    unit.orientation = start->orientation;
+    if (jump_points)
+    {
+      ret_code = dt_find_jump_point_path(search,
+                                         &unit,
+                                         start->grid_x,
+                                         start->grid_y,
+                                         goal->grid_x,
+                                         goal->grid_y,
+                                         &path);
+    }
+    else if (1 == search->states_per_node)
+    {
+      ret_code = dt_find_path(search,
+                              &unit,
+                              start->grid_x,
+                              start->grid_y,
+                              goal->grid_x,
+                              goal->grid_y,
+                              &path);
+    }
+    else
+    {
+      ret_code = dt_find_oriented_path(search,
+                                       &unit,
+                                       start->grid_x,
+                                       start->grid_y,
+                                       goal->grid_x,
+                                       goal->grid_y,
+                                       turn_cost,
+                                       &path);
+    }
+    if (DT_PATH_FOUND == ret_code)
+    {
+      num_found++;
+      path_points += path->num_points;
+      total_cost += path->cost;
+      dt_destroy_path(path);
+    }
+  }
+
+  printf("  %-9s  %.2f M nodes/s, %.2f ms per search, %ld found, "
+         "%.0f nodes and %.0f points per search (cost %.0f)\n",
+         name,
+         dt_get_path_search_rate(search) / 1000000.0,
+         (search->total_search_time_us / 1000.0) /
+                                        (double) MAX(search->num_searches, 1),
+         num_found,
+         (double) search->total_nodes_expanded /
+                                        (double) MAX(search->num_searches, 1),
+         (double) path_points / (double) MAX(num_found, 1),
+         total_cost);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_jump_point_search                                   */
+/*                                                                            */
+/* Purpose: Compare jump point search against plain A*.                       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate the map of the path search benchmark and run its       */
+/*            searches with A* and then with jump point search, which must    */
+/*            find paths of the same total cost. Then clear every point to    */
+/*            an empty plain, keeping which points are blocked, and run them  */
+/*            again on this open field. Jump point search only jumps where    */
+/*            the cost is uniform, so the first map shows what it gains on    */
+/*            mixed terrain and the second its best case. Report how many     */
+/*            times faster jump point search is on each.                      */
+/******************************************************************************/
+void dt_benchmark_jump_point_search()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const char *map_names[] = {"generated", "open field"};
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  Uint64 astar_time_us;
+  int map_index;
+  int grid_x;
+  int grid_y;
+
+  generator = dt_create_map_generator(DT_PATH_BENCH_SIZE,
+                                      DT_PATH_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_PATH_BENCH_QUERIES + 1);
+  printf("Jump point search benchmark: %d searches on a %d x %d map\n",
+         generator->num_units - 1,
+         DT_PATH_BENCH_SIZE,
+         DT_PATH_BENCH_SIZE);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_ROW_MAJOR);
+
+  for (map_index = 0; map_index < 2; map_index++)
+  {
+    if (1 == map_index)
+    {
+      for (grid_y = 0; grid_y < grid->num_tiles_y; grid_y++)
+      {
+        for (grid_x = 0; grid_x < grid->num_tiles_x; grid_x++)
+        {
+          dt_assign_tile_type_to_grid(grid, grid_x, grid_y, DT_TILE_TYPE_NONE);
+        }
+      }
+    }
+    printf("  %s map\n", map_names[map_index]);
+
+    search = dt_create_path_search(grid);
+    dt_benchmark_path_queries(generator, search, 0, false, "A*");
+    astar_time_us = search->total_search_time_us;
+    dt_destroy_path_search(search);
+
+    search = dt_create_path_search(grid);
+    dt_benchmark_path_queries(generator, search, 0, true, "jump");
+    printf("             %.2f times as fast as A*\n",
+           (double) astar_time_us /
+                           (double) MAX(search->total_search_time_us, 1));
+    dt_destroy_path_search(search);
+  }
+
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_hierarchy                                      */
+/*                                                                            */
+/* Purpose: Compare hierarchical path search against plain A* on long paths.  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a large map and time building its hierarchy. Run the   */
+/*            same searches with A*, across the abstract graph alone and      */
+/*            with every part of the abstract path refined, and report how    */
+/*            many times faster each hierarchical search is and how much more */
+/*            its paths cost than the cheapest. Then block a few points and   */
+/*            time bringing the hierarchy up to date, reporting how many      */
+/*            clusters were rebuilt.                                          */
+/******************************************************************************/
+void dt_benchmark_path_hierarchy()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const char *method_names[] = {"A*", "abstract", "refined"};
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_COST_FIELD *field;
+  DT_PATH_HIERARCHY *hierarchy;
+  DT_PATH_SEARCH *search;
+  DT_MAP_UNIT_PLACEMENT *start;
+  DT_MAP_UNIT_PLACEMENT *goal;
+  DT_PATH *path;
+  DT_ABSTRACT_PATH *abstract_path;
+  DT_UNIT unit;
+  Uint64 start_time;
+  Uint64 build_time_us;
+  Uint64 astar_time_us = 1;
+  double costs[3];
+  Uint32 seed = DT_BENCHMARK_SEED;
+  long num_nodes = 0;
+  long clusters_built;
+  long num_found;
+  int num_clusters;
+  int method;
+  int ret_code;
+  int ii;
+
+  generator = dt_create_map_generator(DT_HIERARCHY_BENCH_SIZE,
+                                      DT_HIERARCHY_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_HIERARCHY_BENCH_QUERIES + 1);
+  printf("Path hierarchy benchmark: %d searches on a generated %d x %d map\n",
+         generator->num_units - 1,
+         DT_HIERARCHY_BENCH_SIZE,
+         DT_HIERARCHY_BENCH_SIZE);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+
+  /****************************************************************************/
+  /* Build the hierarchy from scratch.                                        */
+  /****************************************************************************/
+  field = dt_get_grid_cost_field(grid, &unit);
+  start_time = dt_get_time_us();
+  hierarchy = dt_get_path_hierarchy(grid, field);
+  build_time_us = dt_get_time_us() - start_time;
+  num_clusters = hierarchy->num_clusters_x * hierarchy->num_clusters_y;
+  for (ii = 0; ii < num_clusters; ii++)
+  {
+    num_nodes += hierarchy->clusters[ii].num_nodes;
+  }
+  printf("  build      %.2f ms for %d clusters, %.1f entrances each, "
+         "%.2f MB\n",
+         build_time_us / 1000.0,
+         num_clusters,
+         (double) num_nodes / (double) num_clusters,
+         dt_get_path_hierarchy_memory_usage(hierarchy) / (1024.0 * 1024.0));
+
+  /****************************************************************************/
+  /* Run the searches each way.                                               */
+  /****************************************************************************/
+  for (method = 0; method < 3; method++)
+  {
+    search = dt_create_path_search(grid);
+    costs[method] = 0.0;
+    num_found = 0;
+    start_time = dt_get_time_us();
+    for (ii = 0; ii + 1 < generator->num_units; ii++)
+    {
+      start = &(generator->units[ii]);
+      goal = &(generator->units[ii + 1]);
+      unit.orientation = start->orientation;
+      if (1 == method)
+      {
+        ret_code = dt_find_abstract_path(search,
+                                         &unit,
+                                         start->grid_x,
+                                         start->grid_y,
+                                         goal->grid_x,
+                                         goal->grid_y,
+                                         &abstract_path);
+        if (DT_PATH_FOUND == ret_code)
+        {
+          costs[method] += abstract_path->cost;
+          dt_destroy_abstract_path(abstract_path);
+        }
+      }
+      else
+      {
+        ret_code = (0 == method) ?
+                   dt_find_path(search,
+                                &unit,
+                                start->grid_x,
+                                start->grid_y,
+                                goal->grid_x,
+                                goal->grid_y,
+                                &path) :
+                   dt_find_hierarchical_path(search,
+                                             &unit,
+                                             start->grid_x,
+                                             start->grid_y,
+                                             goal->grid_x,
+                                             goal->grid_y,
+                                             &path);
+        if (DT_PATH_FOUND == ret_code)
+        {
+          costs[method] += path->cost;
+          dt_destroy_path(path);
+        }
+      }
+      if (DT_PATH_FOUND == ret_code)
+      {
+        num_found++;
+      }
+    }
+    if (0 == method)
+    {
+      astar_time_us = MAX(dt_get_time_us() - start_time, 1);
+    }
+    printf("  %-9s  %.2f ms per search, %ld found, %.2f times as fast as A*, "
+           "%.1f%% dearer (cost %.0f)\n",
+           method_names[method],
+           ((dt_get_time_us() - start_time) / 1000.0) /
+                                    (double) MAX(generator->num_units - 1, 1),
+           num_found,
+           (double) astar_time_us /
+                          (double) MAX(dt_get_time_us() - start_time, 1),
+           ((costs[method] / MAX(costs[0], 1.0)) - 1.0) * 100.0,
+           costs[method]);
+    dt_destroy_path_search(search);
+  }
+
+  /****************************************************************************/
+  /* Block a few points and bring the hierarchy up to date.                   */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_HIERARCHY_BENCH_EDITS; ii++)
+  {
+    dt_set_grid_traversable(grid,
+                            (int) (dt_benchmark_random(&seed) %
+                                            (Uint32) DT_HIERARCHY_BENCH_SIZE),
+                            (int) (dt_benchmark_random(&seed) %
+                                            (Uint32) DT_HIERARCHY_BENCH_SIZE),
+                            false);
+  }
+  clusters_built = hierarchy->clusters_built;
+  start_time = dt_get_time_us();
+  dt_get_path_hierarchy(grid, field);
+  printf("  update     %.2f ms after blocking %d points, %ld of %d clusters "
+         "rebuilt\n",
+         (dt_get_time_us() - start_time) / 1000.0,
+         DT_HIERARCHY_BENCH_EDITS,
+         hierarchy->clusters_built - clusters_built,
+         num_clusters);
+
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_flow_field                                          */
+/*                                                                            */
+/* Purpose: Compare a flow field against one A* search per unit for a group   */
+/*          of units sent to the same rally point.                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and search from every unit to the rally point.   */
+/*            Then build the flow field to it and walk every unit along the   */
+/*            field to the rally point, which must cost the same in total.    */
+/*            Ask for the field again to time the cached case, and report how */
+/*            many times faster the whole group is moved.                     */
+/******************************************************************************/
+void dt_benchmark_flow_field()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_FLOW_FIELD *flow;
+  DT_MAP_UNIT_PLACEMENT *rally;
+  DT_PATH *path;
+  DT_UNIT unit;
+  Uint64 start_time;
+  Uint64 astar_time_us;
+  Uint64 build_time_us;
+  Uint64 walk_time_us;
+  double astar_cost = 0.0;
+  double flow_cost = 0.0;
+  long num_steps = 0;
+  int grid_x;
+  int grid_y;
+  int direction;
+  int ii;
+
+  generator = dt_create_map_generator(DT_FLOW_BENCH_SIZE,
+                                      DT_FLOW_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_FLOW_BENCH_UNITS + 1);
+  printf("Flow field benchmark: %d units to one rally point on a generated "
+         "%d x %d map\n",
+         generator->num_units - 1,
+         DT_FLOW_BENCH_SIZE,
+         DT_FLOW_BENCH_SIZE);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  rally = &(generator->units[generator->num_units - 1]);
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+
+  /****************************************************************************/
+  /* One search per unit.                                                     */
+  /****************************************************************************/
+  search = dt_create_path_search(grid);
+  start_time = dt_get_time_us();
+  for (ii = 0; ii + 1 < generator->num_units; ii++)
+  {
+    if (DT_PATH_FOUND == dt_find_path(search,
+                                      &unit,
+                                      generator->units[ii].grid_x,
+                                      generator->units[ii].grid_y,
+                                      rally->grid_x,
+                                      rally->grid_y,
+                                      &path))
+    {
+      astar_cost += path->cost;
+      dt_destroy_path(path);
+    }
+  }
+  astar_time_us = MAX(dt_get_time_us() - start_time, 1);
+  dt_destroy_path_search(search);
+  printf("  A*         %.2f ms for the group (cost %.0f)\n",
+         astar_time_us / 1000.0,
+         astar_cost);
+
+  /****************************************************************************/
+  /* One flow field, then every unit walks it to the rally point.             */
+  /****************************************************************************/
+  start_time = dt_get_time_us();
+  flow = dt_get_grid_flow_field(grid, &unit, rally->grid_x, rally->grid_y);
+  build_time_us = dt_get_time_us() - start_time;
+  start_time = dt_get_time_us();
+  for (ii = 0; ii + 1 < generator->num_units; ii++)
+  {
+    grid_x = generator->units[ii].grid_x;
+    grid_y = generator->units[ii].grid_y;
+    if (DT_FLOW_NO_COST != dt_get_flow_field_cost(flow, grid_x, grid_y))
+    {
+      flow_cost += dt_get_flow_field_cost(flow, grid_x, grid_y);
+    }
+    direction = dt_get_flow_field_direction(flow, grid_x, grid_y);
+    while (DT_FLOW_NO_DIRECTION != direction)
+    {
+      grid_x += dt_get_orientation_step_x(direction);
+      grid_y += dt_get_orientation_step_y(direction);
+      num_steps++;
+      direction = dt_get_flow_field_direction(flow, grid_x, grid_y);
+    }
+  }
+  walk_time_us = dt_get_time_us() - start_time;
+  printf("  flow       %.2f ms to build in %ld rounds, %.2f chunk searches "
+         "per chunk, %.2f MB\n",
+         build_time_us / 1000.0,
+         flow->rounds,
+         (double) flow->chunks_relaxed /
+             (double) ((long) grid->num_chunks_x * (long) grid->num_chunks_y),
+         dt_get_flow_field_memory_usage(flow, grid) / (1024.0 * 1024.0));
+  printf("             %.2f ms to walk %ld steps (cost %.0f), "
+         "%.2f times as fast as A*\n",
+         walk_time_us / 1000.0,
+         num_steps,
+         flow_cost,
+         (double) astar_time_us /
+                             (double) MAX(build_time_us + walk_time_us, 1));
+
+  start_time = dt_get_time_us();
+  dt_get_grid_flow_field(grid, &unit, rally->grid_x, rally->grid_y);
+  printf("  cached     %.3f ms to find the field again\n",
+         (dt_get_time_us() - start_time) / 1000.0);
+
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_movement_range                                      */
+/*                                                                            */
+/* Purpose: Time finding the movement range of a selected unit, which is done */
+/*          on every click that selects one.                                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and build the cost field of the unit class up    */
+/*            front, as it is shared by every selection. Then for each        */
+/*            distance find the range from the start of every generated unit  */
+/*            with one reused range, and report the mean and slowest times.   */
+/******************************************************************************/
+void dt_benchmark_movement_range()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_MOVEMENT_RANGE *range;
+  DT_UNIT unit;
+  Uint64 start_time;
+  Uint64 query_time_us;
+  Uint64 total_time_us;
+  Uint64 slowest_time_us;
+  long total_points;
+  int ii;
+
+  generator = dt_create_map_generator(DT_RANGE_BENCH_SIZE,
+                                      DT_RANGE_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_RANGE_BENCH_UNITS);
+  printf("Movement range benchmark: %d units on a generated %d x %d map\n",
+         generator->num_units,
+         DT_RANGE_BENCH_SIZE,
+         DT_RANGE_BENCH_SIZE);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+  dt_get_grid_cost_field(grid, &unit);
+  range = dt_create_movement_range();
+
+  for (unit.max_movement_distance = DT_RANGE_BENCH_MIN_DISTANCE;
+       unit.max_movement_distance <= DT_RANGE_BENCH_MAX_DISTANCE;
+       unit.max_movement_distance *= 2)
+  {
+    total_time_us = 0;
+    slowest_time_us = 0;
+    total_points = 0;
+    for (ii = 0; ii < generator->num_units; ii++)
+    {
+      start_time = dt_get_time_us();
+      dt_find_movement_range(grid,
+                             &unit,
+                             generator->units[ii].grid_x,
+                             generator->units[ii].grid_y,
+                             range);
+      query_time_us = dt_get_time_us() - start_time;
+      total_time_us += query_time_us;
+      slowest_time_us = MAX(slowest_time_us, query_time_us);
+      total_points += range->num_points;
+    }
+    printf("  distance %3d  %7.1f us mean, %6.0f us slowest, "
+           "%8.1f points in range\n",
+           unit.max_movement_distance,
+           (double) total_time_us / (double) generator->num_units,
+           (double) slowest_time_us,
+           (double) total_points / (double) generator->num_units);
+  }
+  printf("  range memory %.1f KB\n",
+         dt_get_movement_range_memory_usage(range) / 1024.0);
+
+  dt_destroy_movement_range(range);
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_cache                                          */
+/*                                                                            */
+/* Purpose: Compare the time each turn spends finding the routes of AI units  */
+/*          with and without the path cache.                                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and play the same turns twice. Each turn every   */
+/*            unit asks for its route, and then a few points of the map are   */
+/*            blocked or cleared. The first time every route is searched for, */
+/*            the second time through the cache. The edits come from the same */
+/*            seed both times, so both see the same map.                      */
+/******************************************************************************/
+void dt_benchmark_path_cache()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_PATH_CACHE *cache;
+  DT_MAP_UNIT_PLACEMENT *start;
+  DT_MAP_UNIT_PLACEMENT *goal;
+  DT_PATH *path;
+  DT_UNIT unit;
+  Uint64 start_time;
+  Uint64 turn_time_us[2];
+  Uint32 seed;
+  int edit_x;
+  int edit_y;
+  int cached;
+  int turn;
+  int ii;
+
+  generator = dt_create_map_generator(DT_CACHE_BENCH_SIZE,
+                                      DT_CACHE_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_CACHE_BENCH_UNITS + 1);
+  printf("Path cache benchmark: %d units for %d turns on a generated %d x %d "
+         "map, %d points changed a turn\n",
+         DT_CACHE_BENCH_UNITS,
+         DT_CACHE_BENCH_TURNS,
+         DT_CACHE_BENCH_SIZE,
+         DT_CACHE_BENCH_SIZE,
+         DT_CACHE_BENCH_EDITS);
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+
+  for (cached = 0; cached < 2; cached++)
+  {
+    grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+    search = dt_create_path_search(grid);
+    seed = DT_BENCHMARK_SEED;
+    turn_time_us[cached] = 0;
+    for (turn = 0; turn < DT_CACHE_BENCH_TURNS; turn++)
+    {
+      start_time = dt_get_time_us();
+      for (ii = 0; ii < DT_CACHE_BENCH_UNITS; ii++)
+      {
+        start = &(generator->units[ii]);
+        goal = &(generator->units[ii + 1]);
+        if (DT_PATH_FOUND == (cached ?
+                              dt_find_cached_path(search,
+                                                  &unit,
+                                                  start->grid_x,
+                                                  start->grid_y,
+                                                  goal->grid_x,
+                                                  goal->grid_y,
+                                                  &path) :
+                              dt_find_path(search,
+                                           &unit,
+                                           start->grid_x,
+                                           start->grid_y,
+                                           goal->grid_x,
+                                           goal->grid_y,
+                                           &path)))
+        {
+          dt_destroy_path(path);
+        }
+      }
+      turn_time_us[cached] += dt_get_time_us() - start_time;
+
+      for (ii = 0; ii < DT_CACHE_BENCH_EDITS; ii++)
+      {
+        edit_x = (int) (dt_benchmark_random(&seed) % DT_CACHE_BENCH_SIZE);
+        edit_y = (int) (dt_benchmark_random(&seed) % DT_CACHE_BENCH_SIZE);
+        dt_set_grid_traversable(grid,
+                                edit_x,
+                                edit_y,
+                                0 != (dt_benchmark_random(&seed) & 1));
+      }
+    }
+    printf("  %-10s %8.2f ms a turn\n",
+           cached ? "cached" : "searched",
+           turn_time_us[cached] / (1000.0 * DT_CACHE_BENCH_TURNS));
+
+    if (cached)
+    {
+      cache = dt_get_grid_path_cache(grid);
+      printf("  hit rate   %.1f%% (%ld hits, %ld misses), %ld paths dropped "
+             "by edits, %ld to make room, %.1f KB\n",
+             100.0 * dt_get_path_cache_hit_rate(cache),
+             cache->hits,
+             cache->misses,
+             cache->invalidations,
+             cache->evictions,
+             dt_get_path_cache_memory_usage(cache) / 1024.0);
+      printf("  speedup    %.2f times\n",
+             (double) turn_time_us[0] / (double) MAX(turn_time_us[1], 1));
+    }
+    dt_destroy_path_search(search);
+    dt_destroy_grid(grid);
+  }
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_replanner                                           */
+/*                                                                            */
+/* Purpose: Compare planning again with A* against repairing the last plan    */
+/*          with a replanner, for units moving while points of the map are    */
+/*          blocked and freed.                                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and give each unit a replanner. Each tick block  */
+/*            or free random points, then plan every unit both ways from      */
+/*            where it is and check both find the same cost. The unit then    */
+/*            takes a few steps along the A* path. The first plan of each     */
+/*            replanner searches from nothing and is timed on its own.        */
+/******************************************************************************/
+void dt_benchmark_replanner()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_REPLANNER *replanners[DT_REPLAN_BENCH_UNITS];
+  DT_UNIT units[DT_REPLAN_BENCH_UNITS];
+  int unit_x[DT_REPLAN_BENCH_UNITS];
+  int unit_y[DT_REPLAN_BENCH_UNITS];
+  DT_MAP_UNIT_PLACEMENT *start;
+  DT_MAP_UNIT_PLACEMENT *goal;
+  DT_PATH *path;
+  DT_PATH *replanned_path;
+  Uint64 start_time;
+  Uint64 search_time_us = 0;
+  Uint64 first_plan_time_us = 0;
+  Uint64 replan_time_us = 0;
+  Uint64 first_plan_nodes = 0;
+  Uint64 replan_nodes = 0;
+  size_t memory_usage = 0;
+  Uint32 seed = DT_BENCHMARK_SEED;
+  long num_replans = 0;
+  long num_mismatches = 0;
+  int ret_code;
+  int replan_ret_code;
+  int edit_x;
+  int edit_y;
+  int step;
+  int tick;
+  int ii;
+
+  generator = dt_create_map_generator(DT_REPLAN_BENCH_SIZE,
+                                      DT_REPLAN_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_REPLAN_BENCH_UNITS + 1);
+  printf("Replanning benchmark: %d units for %d ticks on a generated %d x %d "
+         "map, %d points changed a tick\n",
+         DT_REPLAN_BENCH_UNITS,
+         DT_REPLAN_BENCH_TICKS,
+         DT_REPLAN_BENCH_SIZE,
+         DT_REPLAN_BENCH_SIZE,
+         DT_REPLAN_BENCH_CHANGES);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  search = dt_create_path_search(grid);
+  for (ii = 0; ii < DT_REPLAN_BENCH_UNITS; ii++)
+  {
+    start = &(generator->units[ii]);
+    goal = &(generator->units[ii + 1]);
+    memset(&(units[ii]), 0, sizeof(DT_UNIT));
+    units[ii].unit_class = DT_UNIT_CLASS_NORMAL;
+    units[ii].speed = 1;
+    unit_x[ii] = start->grid_x;
+    unit_y[ii] = start->grid_y;
+    replanners[ii] = dt_create_replanner(grid,
+                                         &(units[ii]),
+                                         start->grid_x,
+                                         start->grid_y,
+                                         goal->grid_x,
+                                         goal->grid_y);
+  }
+
+  for (tick = 0; tick < DT_REPLAN_BENCH_TICKS; tick++)
+  {
+    if (tick > 0)
+    {
+      for (ii = 0; ii < DT_REPLAN_BENCH_CHANGES; ii++)
+      {
+        edit_x = (int) (dt_benchmark_random(&seed) % DT_REPLAN_BENCH_SIZE);
+        edit_y = (int) (dt_benchmark_random(&seed) % DT_REPLAN_BENCH_SIZE);
+        dt_set_grid_traversable(grid,
+                                edit_x,
+                                edit_y,
+                                0 != (dt_benchmark_random(&seed) & 1));
+      }
+    }
+
+    for (ii = 0; ii < DT_REPLAN_BENCH_UNITS; ii++)
+    {
+      start_time = dt_get_time_us();
+      ret_code = dt_find_path(search,
+                              &(units[ii]),
+                              unit_x[ii],
+                              unit_y[ii],
+                              replanners[ii]->goal_x,
+                              replanners[ii]->goal_y,
+                              &path);
+      search_time_us += dt_get_time_us() - start_time;
+
+      start_time = dt_get_time_us();
+      replan_ret_code = dt_replan_path(replanners[ii],
+                                       unit_x[ii],
+                                       unit_y[ii],
+                                       &replanned_path);
+      if (0 == tick)
+      {
+        first_plan_time_us += dt_get_time_us() - start_time;
+        first_plan_nodes += (Uint64) replanners[ii]->nodes_expanded;
+      }
+      else
+      {
+        replan_time_us += dt_get_time_us() - start_time;
+        replan_nodes += (Uint64) replanners[ii]->nodes_expanded;
+        num_replans++;
+      }
+
+      if ((ret_code != replan_ret_code) ||
+          ((DT_PATH_FOUND == ret_code) &&
+           (path->cost != replanned_path->cost)))
+      {
+        num_mismatches++;
+      }
+      if (DT_PATH_FOUND == ret_code)
+      {
+        step = MIN(DT_REPLAN_BENCH_STEPS, path->num_points - 1);
+        unit_x[ii] = path->points[step].grid_x;
+        unit_y[ii] = path->points[step].grid_y;
+        dt_destroy_path(path);
+      }
+      if (DT_PATH_FOUND == replan_ret_code)
+      {
+        dt_destroy_path(replanned_path);
+      }
+    }
+  }
+
+  for (ii = 0; ii < DT_REPLAN_BENCH_UNITS; ii++)
+  {
+    memory_usage += dt_get_replanner_memory_usage(replanners[ii]);
+  }
+  printf("  A*         %8.1f us a plan\n",
+         search_time_us /
+               (double) (DT_REPLAN_BENCH_UNITS * DT_REPLAN_BENCH_TICKS));
+  printf("  D* Lite    %8.1f us a first plan, %.0f points expanded\n",
+         first_plan_time_us / (double) DT_REPLAN_BENCH_UNITS,
+         first_plan_nodes / (double) DT_REPLAN_BENCH_UNITS);
+  printf("             %8.1f us a replan, %.0f points expanded\n",
+         replan_time_us / (double) MAX(num_replans, 1),
+         replan_nodes / (double) MAX(num_replans, 1));
+  printf("  speedup    %.2f times over all plans, %ld cost mismatches, "
+         "%.1f KB of replanners\n",
+         (double) search_time_us /
+                (double) MAX(first_plan_time_us + replan_time_us, 1),
+         num_mismatches,
+         memory_usage / 1024.0);
+
+  for (ii = 0; ii < DT_REPLAN_BENCH_UNITS; ii++)
+  {
+    dt_destroy_replanner(replanners[ii]);
+  }
+  dt_destroy_path_search(search);
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_service                                        */
+/*                                                                            */
+/* Purpose: Compare solving a batch of path requests one after another with   */
+/*          solving it with the path service on pools of different sizes.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and a batch of requests from units of several    */
+/*            classes and speeds, each to a goal not far away. Solve it once  */
+/*            with dt_find_path, then on pools of more and more threads, and  */
+/*            check each pool gives back exactly the same paths.              */
+/******************************************************************************/
+void dt_benchmark_path_service()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_WORKER_POOL *pool;
+  DT_PATH_SERVICE *service;
+  DT_PATH_REQUEST *serial_requests;
+  DT_PATH_REQUEST *requests;
+  DT_PATH *path;
+  DT_PATH *serial_path;
+  DT_UNIT units[4];
+  Uint64 start_time;
+  Uint64 serial_time_us;
+  Uint64 batch_time_us;
+  Uint32 seed = DT_BENCHMARK_SEED;
+  long num_mismatches;
+  int num_threads;
+  int ii;
+
+  generator = dt_create_map_generator(DT_BATCH_BENCH_SIZE,
+                                      DT_BATCH_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      0);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  printf("Batched path benchmark: %d requests within %d points on a "
+         "generated %d x %d map\n",
+         DT_BATCH_BENCH_REQUESTS,
+         DT_BATCH_BENCH_RANGE,
+         DT_BATCH_BENCH_SIZE,
+         DT_BATCH_BENCH_SIZE);
+
+  /****************************************************************************/
+  /* Make the requests, each from a normal unit or a vehicle of speed 1 or 2. */
+  /****************************************************************************/
+  for (ii = 0; ii < 4; ii++)
+  {
+    memset(&(units[ii]), 0, sizeof(DT_UNIT));
+    units[ii].unit_class = (ii & 1) ? DT_UNIT_CLASS_VEHICLE :
+                                      DT_UNIT_CLASS_NORMAL;
+    units[ii].speed = 1 + (ii >> 1);
+  }
+  serial_requests = (DT_PATH_REQUEST *) dt_malloc(sizeof(DT_PATH_REQUEST) *
+                                                  DT_BATCH_BENCH_REQUESTS);
+  requests = (DT_PATH_REQUEST *) dt_malloc(sizeof(DT_PATH_REQUEST) *
+                                           DT_BATCH_BENCH_REQUESTS);
+  for (ii = 0; ii < DT_BATCH_BENCH_REQUESTS; ii++)
+  {
+    serial_requests[ii].unit = &(units[dt_benchmark_random(&seed) % 4]);
+    serial_requests[ii].start_x =
+                     (int) (dt_benchmark_random(&seed) % DT_BATCH_BENCH_SIZE);
+    serial_requests[ii].start_y =
+                     (int) (dt_benchmark_random(&seed) % DT_BATCH_BENCH_SIZE);
+    serial_requests[ii].goal_x = CLAMP(serial_requests[ii].start_x +
+                        (int) (dt_benchmark_random(&seed) %
+                               (2 * DT_BATCH_BENCH_RANGE + 1)) -
+                        DT_BATCH_BENCH_RANGE,
+                                       0,
+                                       DT_BATCH_BENCH_SIZE - 1);
+    serial_requests[ii].goal_y = CLAMP(serial_requests[ii].start_y +
+                        (int) (dt_benchmark_random(&seed) %
+                               (2 * DT_BATCH_BENCH_RANGE + 1)) -
+                        DT_BATCH_BENCH_RANGE,
+                                       0,
+                                       DT_BATCH_BENCH_SIZE - 1);
+  }
+
+  /****************************************************************************/
+  /* Solve them one after another, with the fields built beforehand as the    */
+  /* service builds them.                                                     */
+  /****************************************************************************/
+  search = dt_create_path_search(grid);
+  dt_prepare_path_request_fields(grid,
+                                 serial_requests,
+                                 0,
+                                 DT_BATCH_BENCH_REQUESTS);
+  start_time = dt_get_time_us();
+  for (ii = 0; ii < DT_BATCH_BENCH_REQUESTS; ii++)
+  {
+    serial_requests[ii].ret_code = dt_find_path(search,
+                                                serial_requests[ii].unit,
+                                                serial_requests[ii].start_x,
+                                                serial_requests[ii].start_y,
+                                                serial_requests[ii].goal_x,
+                                                serial_requests[ii].goal_y,
+                                                &(serial_requests[ii].path));
+  }
+  serial_time_us = dt_get_time_us() - start_time;
+  dt_destroy_path_search(search);
+  printf("  serial     %8.2f ms\n", serial_time_us / 1000.0);
+
+  /****************************************************************************/
+  /* Solve them on each pool and compare every path with the serial one.      */
+  /****************************************************************************/
+  for (num_threads = 0;
+       num_threads <= DT_BATCH_BENCH_MAX_THREADS;
+       num_threads = (num_threads * 2) + 1)
+  {
+    pool = dt_create_worker_pool(num_threads);
+    service = dt_create_path_service(grid, pool);
+    memcpy(requests,
+           serial_requests,
+           sizeof(DT_PATH_REQUEST) * DT_BATCH_BENCH_REQUESTS);
+    start_time = dt_get_time_us();
+    dt_solve_path_requests(service, requests, DT_BATCH_BENCH_REQUESTS);
+    batch_time_us = dt_get_time_us() - start_time;
+
+    num_mismatches = 0;
+    for (ii = 0; ii < DT_BATCH_BENCH_REQUESTS; ii++)
+    {
+      path = requests[ii].path;
+      serial_path = serial_requests[ii].path;
+      if ((requests[ii].ret_code != serial_requests[ii].ret_code) ||
+          ((NULL != path) &&
+           ((path->cost != serial_path->cost) ||
+            (path->num_points != serial_path->num_points) ||
+            (0 != memcmp(path->points,
+                         serial_path->points,
+                         sizeof(DT_PATH_POINT) * (size_t) path->num_points)))))
+      {
+        num_mismatches++;
+      }
+      if (NULL != path)
+      {
+        dt_destroy_path(path);
+      }
+    }
+    printf("  %2d threads %8.2f ms, %.2f times serial, %ld mismatches, "
+           "%.1f MB of searches\n",
+           pool->num_threads + 1,
+           batch_time_us / 1000.0,
+           (double) serial_time_us / (double) MAX(batch_time_us, 1),
+           num_mismatches,
+           dt_get_path_service_memory_usage(service) / (1024.0 * 1024.0));
+    dt_destroy_path_service(service);
+    dt_destroy_worker_pool(pool);
+  }
+
+  for (ii = 0; ii < DT_BATCH_BENCH_REQUESTS; ii++)
+  {
+    if (NULL != serial_requests[ii].path)
+    {
+      dt_destroy_path(serial_requests[ii].path);
+    }
+  }
+  dt_free(requests);
+  dt_free(serial_requests);
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_path_scheduler                                      */
+/*                                                                            */
+/* Purpose: Compare the longest time the event loop is held up by finding     */
+/*          paths for a set of units all at once with finding them a frame's  */
+/*          budget at a time with the path scheduler.                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate a map and time each search with dt_find_path. Then ask */
+/*            the scheduler for the same paths and run it frame by frame      */
+/*            until every unit has its path, and check each is the same.      */
+/******************************************************************************/
+void dt_benchmark_path_scheduler()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_PATH_SCHEDULER *scheduler;
+  DT_PATH *paths[DT_SLICE_BENCH_UNITS];
+  DT_UNIT units[DT_SLICE_BENCH_UNITS];
+  int start_x[DT_SLICE_BENCH_UNITS];
+  int start_y[DT_SLICE_BENCH_UNITS];
+  int goal_x[DT_SLICE_BENCH_UNITS];
+  int goal_y[DT_SLICE_BENCH_UNITS];
+  Uint64 start_time;
+  Uint64 search_time_us;
+  Uint64 blocking_time_us = 0;
+  Uint64 longest_search_us = 0;
+  long num_mismatches = 0;
+  int ii;
+
+  generator = dt_create_map_generator(DT_SLICE_BENCH_SIZE,
+                                      DT_SLICE_BENCH_SIZE,
+                                      DT_BENCHMARK_SEED,
+                                      DT_SLICE_BENCH_UNITS + 1);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_CHUNKED);
+  printf("Time-sliced path benchmark: %d units on a generated %d x %d map, "
+         "%d us a frame\n",
+         DT_SLICE_BENCH_UNITS,
+         DT_SLICE_BENCH_SIZE,
+         DT_SLICE_BENCH_SIZE,
+         DT_SLICE_BENCH_FRAME_US);
+  for (ii = 0; ii < DT_SLICE_BENCH_UNITS; ii++)
+  {
+    memset(&(units[ii]), 0, sizeof(DT_UNIT));
+    units[ii].unit_class = DT_UNIT_CLASS_NORMAL;
+    units[ii].speed = 1;
+    start_x[ii] = generator->units[ii].grid_x;
+    start_y[ii] = generator->units[ii].grid_y;
+    goal_x[ii] = generator->units[ii + 1].grid_x;
+    goal_y[ii] = generator->units[ii + 1].grid_y;
+  }
+  start_x[0] = generator->units[0].grid_x;
+  start_y[0] = generator->units[0].grid_y;
+  goal_x[0] = DT_SLICE_BENCH_SIZE - 1 - start_x[0];
+  goal_y[0] = DT_SLICE_BENCH_SIZE - 1 - start_y[0];
+  dt_set_grid_traversable(grid, goal_x[0], goal_y[0], true);
+
+  /****************************************************************************/
+  /* Find every path at once, as the event loop would if it blocked.          */
+  /****************************************************************************/
+  search = dt_create_path_search(grid);
+  for (ii = 0; ii < DT_SLICE_BENCH_UNITS; ii++)
+  {
+    start_time = dt_get_time_us();
+    dt_find_path(search,
+                 &(units[ii]),
+                 start_x[ii],
+                 start_y[ii],
+                 goal_x[ii],
+                 goal_y[ii],
+                 &(paths[ii]));
+    search_time_us = dt_get_time_us() - start_time;
+    blocking_time_us += search_time_us;
+    longest_search_us = MAX(longest_search_us, search_time_us);
+  }
+  dt_destroy_path_search(search);
+  printf("  blocking   %8.2f ms in all, longest search %.2f ms\n",
+         blocking_time_us / 1000.0,
+         longest_search_us / 1000.0);
+
+  /****************************************************************************/
+  /* Find them again a frame at a time.                                       */
+  /****************************************************************************/
+  scheduler = dt_get_grid_path_scheduler(grid);
+  for (ii = 0; ii < DT_SLICE_BENCH_UNITS; ii++)
+  {
+    dt_request_unit_path(scheduler,
+                         &(units[ii]),
+                         start_x[ii],
+                         start_y[ii],
+                         goal_x[ii],
+                         goal_y[ii]);
+  }
+  while (dt_has_pending_paths(grid))
+  {
+    dt_run_path_scheduler(scheduler,
+                          DT_SLICE_BENCH_FRAME_US,
+                          DT_PATH_SCHEDULER_NO_LIMIT);
+  }
+  for (ii = 0; ii < DT_SLICE_BENCH_UNITS; ii++)
+  {
+    if ((NULL == paths[ii]) != (NULL == units[ii].path))
+    {
+      num_mismatches++;
+    }
+    else if ((NULL != paths[ii]) &&
+             ((paths[ii]->cost != units[ii].path->cost) ||
+              (paths[ii]->num_points != units[ii].path->num_points)))
+    {
+      num_mismatches++;
+    }
+    if (NULL != paths[ii])
+    {
+      dt_destroy_path(paths[ii]);
+    }
+    dt_cancel_unit_path(&(units[ii]));
+  }
+  printf("  sliced     %8.2f ms in all over %ld frames, longest frame %.2f "
+         "ms, %ld mismatches\n",
+         scheduler->total_frame_time_us / 1000.0,
+         scheduler->num_frames,
+         scheduler->longest_frame_us / 1000.0,
+         num_mismatches);
+
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_cooperative_paths                                   */
+/*                                                                            */
+/* Purpose: Count how often units crowding through a gap collide and must     */
+/*          replan when each plans alone, and when the group is planned       */
+/*          cooperatively, on maps of several sizes.                          */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Run dt_benchmark_cooperative_map on each size. Each unit has a  */
+/*            goal of its own, so the time a plan takes shows how the cost of */
+/*            guiding it to so many goals grows with the map.                 */
+/******************************************************************************/
+void dt_benchmark_cooperative_paths()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const int sizes[] = {64, 256, 1024};
+  int size_index;
+
+  for (size_index = 0; size_index < 3; size_index++)
+  {
+    dt_benchmark_cooperative_map(sizes[size_index]);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_cooperative_map                                     */
+/*                                                                            */
+/* Purpose: Count how often units crowding through a gap collide and must     */
+/*          replan when each plans alone, and when the group is planned       */
+/*          cooperatively, on one map.                                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     size - The width and height of the map.                 */
+/*                                                                            */
+/* Operation: Build an open map with a wall down the middle and a narrow gap  */
+/*            in it, and put a block of units on each side, each sent to the  */
+/*            point across from it. First give each unit a replanner, which   */
+/*            plans round the points other units are on, and replan it        */
+/*            whenever its next step is taken. Then plan the whole group      */
+/*            every DT_COOP_BENCH_REPLAN_TICKS ticks and follow the plans.    */
+/******************************************************************************/
+void dt_benchmark_cooperative_map(int size)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  DT_UNIT units[DT_COOP_BENCH_UNITS];
+  DT_REPLANNER *replanners[DT_COOP_BENCH_UNITS];
+  DT_PATH *paths[DT_COOP_BENCH_UNITS];
+  DT_PATH_REQUEST requests[DT_COOP_BENCH_UNITS];
+  DT_COOP_PLANNER *planner;
+  int start_x[DT_COOP_BENCH_UNITS];
+  int start_y[DT_COOP_BENCH_UNITS];
+  int goal_x[DT_COOP_BENCH_UNITS];
+  int goal_y[DT_COOP_BENCH_UNITS];
+  int unit_x[DT_COOP_BENCH_UNITS];
+  int unit_y[DT_COOP_BENCH_UNITS];
+  int next_x[DT_COOP_BENCH_UNITS];
+  int next_y[DT_COOP_BENCH_UNITS];
+  int steps[DT_COOP_BENCH_UNITS];
+  bool blocked[DT_COOP_BENCH_UNITS];
+  Uint64 start_time;
+  Uint64 plan_time_us;
+  long num_replans;
+  long num_collisions;
+  int num_arrived;
+  int tick;
+  int row;
+  int ii;
+
+  grid = dt_create_grid(1, 1, size, size);
+  for (row = 0; row < size; row++)
+  {
+    if ((row < (size - DT_COOP_BENCH_GAP) / 2) ||
+        (row >= (size + DT_COOP_BENCH_GAP) / 2))
+    {
+      dt_set_grid_traversable(grid, size / 2, row, false);
+    }
+  }
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    memset(&(units[ii]), 0, sizeof(DT_UNIT));
+    units[ii].unit_id = ii;
+    units[ii].unit_class = DT_UNIT_CLASS_NORMAL;
+    units[ii].speed = 1;
+    start_x[ii] = (size / 2) - DT_COOP_BENCH_SPACING -
+                  DT_COOP_BENCH_GROUP + (ii % DT_COOP_BENCH_GROUP);
+    start_y[ii] = ((size - DT_COOP_BENCH_GROUP) / 2) +
+                  ((ii / DT_COOP_BENCH_GROUP) % DT_COOP_BENCH_GROUP);
+    if (ii >= DT_COOP_BENCH_UNITS / 2)
+    {
+      start_x[ii] = size - 1 - start_x[ii];
+    }
+    goal_x[ii] = (ii < DT_COOP_BENCH_UNITS / 2) ?
+                 size - 1 - start_x[ii] + DT_COOP_BENCH_GROUP :
+                 size - 1 - start_x[ii] - DT_COOP_BENCH_GROUP;
+    goal_y[ii] = start_y[ii];
+  }
+  printf("Cooperative path benchmark: %d units swapping sides through a gap "
+         "%d wide on a %d x %d map\n",
+         DT_COOP_BENCH_UNITS,
+         DT_COOP_BENCH_GAP,
+         size,
+         size);
+
+  /****************************************************************************/
+  /* Each unit plans alone, round the units in its way.                       */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    unit_x[ii] = start_x[ii];
+    unit_y[ii] = start_y[ii];
+    dt_set_grid_unit(grid, unit_x[ii], unit_y[ii], &(units[ii]));
+  }
+  start_time = dt_get_time_us();
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    replanners[ii] = dt_create_replanner(grid,
+                                         &(units[ii]),
+                                         start_x[ii],
+                                         start_y[ii],
+                                         goal_x[ii],
+                                         goal_y[ii]);
+    dt_replan_path(replanners[ii], unit_x[ii], unit_y[ii], &(paths[ii]));
+    steps[ii] = 0;
+  }
+  plan_time_us = dt_get_time_us() - start_time;
+  num_replans = 0;
+  for (tick = 0; tick < DT_COOP_BENCH_MAX_TICKS; tick++)
+  {
+    num_arrived = 0;
+    for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+    {
+      next_x[ii] = unit_x[ii];
+      next_y[ii] = unit_y[ii];
+      if ((unit_x[ii] == goal_x[ii]) && (unit_y[ii] == goal_y[ii]))
+      {
+        num_arrived++;
+      }
+      else if (NULL != paths[ii])
+      {
+        next_x[ii] = paths[ii]->points[steps[ii] + 1].grid_x;
+        next_y[ii] = paths[ii]->points[steps[ii] + 1].grid_y;
+      }
+    }
+    if (DT_COOP_BENCH_UNITS == num_arrived)
+    {
+      break;
+    }
+    dt_benchmark_move_units(grid,
+                            units,
+                            unit_x,
+                            unit_y,
+                            next_x,
+                            next_y,
+                            blocked);
+
+    start_time = dt_get_time_us();
+    for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+    {
+      if ((unit_x[ii] == goal_x[ii]) && (unit_y[ii] == goal_y[ii]))
+      {
+        continue;
+      }
+      if (!blocked[ii] && (NULL != paths[ii]))
+      {
+        (steps[ii])++;
+        continue;
+      }
+      if (NULL != paths[ii])
+      {
+        dt_destroy_path(paths[ii]);
+      }
+      dt_replan_path(replanners[ii], unit_x[ii], unit_y[ii], &(paths[ii]));
+      steps[ii] = 0;
+      num_replans++;
+    }
+    plan_time_us += dt_get_time_us() - start_time;
+  }
+  printf("  alone        %3d ticks, %d of %d arrived, %5ld collision "
+         "replans, %8.2f ms planning\n",
+         tick,
+         num_arrived,
+         DT_COOP_BENCH_UNITS,
+         num_replans,
+         plan_time_us / 1000.0);
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    if (NULL != paths[ii])
+    {
+      dt_destroy_path(paths[ii]);
+    }
+    dt_destroy_replanner(replanners[ii]);
+    dt_set_grid_unit(grid, unit_x[ii], unit_y[ii], NULL);
+  }
+
+  /****************************************************************************/
+  /* The group is planned together.                                           */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    unit_x[ii] = start_x[ii];
+    unit_y[ii] = start_y[ii];
+    dt_set_grid_unit(grid, unit_x[ii], unit_y[ii], &(units[ii]));
+    requests[ii].path = NULL;
+  }
+  planner = dt_create_coop_planner(grid);
+  num_collisions = 0;
+  for (tick = 0; tick < DT_COOP_BENCH_MAX_TICKS; tick++)
+  {
+    if (0 == (tick % DT_COOP_BENCH_REPLAN_TICKS))
+    {
+      for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+      {
+        if (NULL != requests[ii].path)
+        {
+          dt_destroy_path(requests[ii].path);
+        }
+        requests[ii].unit = &(units[ii]);
+        requests[ii].start_x = unit_x[ii];
+        requests[ii].start_y = unit_y[ii];
+        requests[ii].goal_x = goal_x[ii];
+        requests[ii].goal_y = goal_y[ii];
+      }
+      dt_plan_coop_paths(planner, requests, DT_COOP_BENCH_UNITS);
+    }
+
+    num_arrived = 0;
+    for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+    {
+      next_x[ii] = unit_x[ii];
+      next_y[ii] = unit_y[ii];
+      if ((unit_x[ii] == goal_x[ii]) && (unit_y[ii] == goal_y[ii]))
+      {
+        num_arrived++;
+      }
+      if (NULL != requests[ii].path)
+      {
+        next_x[ii] = requests[ii].path->points[
+                          (tick % DT_COOP_BENCH_REPLAN_TICKS) + 1].grid_x;
+        next_y[ii] = requests[ii].path->points[
+                          (tick % DT_COOP_BENCH_REPLAN_TICKS) + 1].grid_y;
+      }
+    }
+    if (DT_COOP_BENCH_UNITS == num_arrived)
+    {
+      break;
+    }
+    dt_benchmark_move_units(grid,
+                            units,
+                            unit_x,
+                            unit_y,
+                            next_x,
+                            next_y,
+                            blocked);
+    for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+    {
+      if (blocked[ii])
+      {
+        num_collisions++;
+      }
+    }
+  }
+  printf("  cooperative  %3d ticks, %d of %d arrived, %5ld collision "
+         "replans, %8.2f ms planning\n",
+         tick,
+         num_arrived,
+         DT_COOP_BENCH_UNITS,
+         num_collisions,
+         planner->total_plan_time_us / 1000.0);
+  printf("               %ld group plans, %ld units held, %.0f states "
+         "expanded a unit, %.0f points searched back a plan, %.1f KB of "
+         "planner\n",
+         planner->num_plans,
+         planner->units_held,
+         planner->total_nodes_expanded /
+                                  (double) MAX(planner->units_planned, 1),
+         planner->total_goal_nodes_expanded /
+                                  (double) MAX(planner->num_plans, 1),
+         dt_get_coop_planner_memory_usage(planner) / 1024.0);
+
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    if (NULL != requests[ii].path)
+    {
+      dt_destroy_path(requests[ii].path);
+    }
+  }
+  dt_destroy_coop_planner(planner);
+  dt_destroy_grid(grid);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_move_units                                          */
+/*                                                                            */
+/* Purpose: Move the units of the cooperative path benchmark one tick.        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid the units are on.                       */
+/*             IN     units - The units.                                      */
+/*             IN/OUT unit_x - The x coordinate of each unit.                 */
+/*             IN/OUT unit_y - The y coordinate of each unit.                 */
+/*             IN     next_x - The x coordinate each unit moves to.           */
+/*             IN     next_y - The y coordinate each unit moves to.           */
+/*             OUT    blocked - Set for each unit which could not move as     */
+/*                              another unit was in the way.                  */
+/*                                                                            */
+/* Operation: Move each unit whose next point is empty, and go round again    */
+/*            while any unit moved, so a unit may follow one which moved out  */
+/*            of its way in the same tick. Then a ring of three or more units */
+/*            each moving onto the point of the next all move at once. The    */
+/*            units left have collided, including two trying to swap points.  */
+/******************************************************************************/
+void dt_benchmark_move_units(DT_GRID *grid,
+                             DT_UNIT *units,
+                             int *unit_x,
+                             int *unit_y,
+                             int *next_x,
+                             int *next_y,
+                             bool *blocked)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_UNIT *other_unit;
+  bool moved = true;
+  int ring[DT_COOP_BENCH_UNITS];
+  int ring_size;
+  int ii;
+  int jj;
+
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    blocked[ii] = ((next_x[ii] != unit_x[ii]) || (next_y[ii] != unit_y[ii]));
+  }
+  while (moved)
+  {
+    moved = false;
+    for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+    {
+      if (blocked[ii] &&
+          (NULL == dt_retrieve_unit_from_grid(grid, next_x[ii], next_y[ii])))
+      {
+        dt_set_grid_unit(grid, unit_x[ii], unit_y[ii], NULL);
+        dt_set_grid_unit(grid, next_x[ii], next_y[ii], &(units[ii]));
+        unit_x[ii] = next_x[ii];
+        unit_y[ii] = next_y[ii];
+        blocked[ii] = false;
+        moved = true;
+      }
+    }
+  }
+
+  for (ii = 0; ii < DT_COOP_BENCH_UNITS; ii++)
+  {
+    ring[0] = ii;
+    for (ring_size = 1; ring_size < DT_COOP_BENCH_UNITS; ring_size++)
+    {
+      jj = ring[ring_size - 1];
+      if (!blocked[jj])
+      {
+        break;
+      }
+      other_unit = dt_retrieve_unit_from_grid(grid, next_x[jj], next_y[jj]);
+      ring[ring_size] = (int) (other_unit - units);
+      if (ii == ring[ring_size])
+      {
+        break;
+      }
+    }
+    if ((ring_size < 3) ||
+        (ring_size == DT_COOP_BENCH_UNITS) ||
+        (ii != ring[ring_size]))
+    {
+      continue;
+    }
+    for (jj = 0; jj < ring_size; jj++)
+    {
+      dt_set_grid_unit(grid,
+                       next_x[ring[jj]],
+                       next_y[ring[jj]],
+                       &(units[ring[jj]]));
+      unit_x[ring[jj]] = next_x[ring[jj]];
+      unit_y[ring[jj]] = next_y[ring[jj]];
+      blocked[ring[jj]] = false;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_region_map                                          */
+/*                                                                            */
+/* Purpose: Measure how searches to goals which cannot be reached are turned  */
+/*          down by the region map, and what keeping the map up to date as    */
+/*          the grid changes costs.                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Fill a map with random terrain and wall off squares of it. Time */
+/*            labelling the map, then search from random points to goals      */
+/*            inside the squares and to random goals, and total the searches  */
+/*            of each kind. Last close random points one at a time and open   */
+/*            them again, counting the regions split and the times the map    */
+/*            had to be labelled again in full.                               */
+/******************************************************************************/
+void dt_benchmark_region_map()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_COST_FIELD *field;
+  DT_REGION_MAP *map;
+  DT_PATH *path;
+  DT_UNIT unit;
+  int island_x[DT_REGION_BENCH_ISLANDS];
+  int island_y[DT_REGION_BENCH_ISLANDS];
+  Uint64 start_time;
+  Uint64 build_time_us;
+  Uint64 change_time_us;
+  Uint64 search_time_us[2] = {0, 0};
+  Uint64 nodes_expanded[2] = {0, 0};
+  long num_searches[2] = {0, 0};
+  long num_builds;
+  long num_splits;
+  Uint32 seed = DT_BENCHMARK_SEED;
+  int start_x;
+  int start_y;
+  int goal_x;
+  int goal_y;
+  int edit_x;
+  int edit_y;
+  int found;
+  int ii;
+  int jj;
+
+  printf("Region map benchmark: %d searches on a %d x %d map with %d walled "
+         "squares\n",
+         DT_REGION_BENCH_SEARCHES,
+         DT_REGION_BENCH_SIZE,
+         DT_REGION_BENCH_SIZE,
+         DT_REGION_BENCH_ISLANDS);
+  grid = dt_create_grid(1, 1, DT_REGION_BENCH_SIZE, DT_REGION_BENCH_SIZE);
+  dt_benchmark_fill_grid(grid, DT_REGION_BENCH_BLOCKED_PERCENT, seed);
+  for (ii = 0; ii < DT_REGION_BENCH_ISLANDS; ii++)
+  {
+    island_x[ii] = (int) (dt_benchmark_random(&seed) %
+                     (DT_REGION_BENCH_SIZE - DT_REGION_BENCH_ISLAND_SIZE));
+    island_y[ii] = (int) (dt_benchmark_random(&seed) %
+                     (DT_REGION_BENCH_SIZE - DT_REGION_BENCH_ISLAND_SIZE));
+    for (jj = 0; jj < DT_REGION_BENCH_ISLAND_SIZE; jj++)
+    {
+      dt_set_grid_traversable(grid, island_x[ii] + jj, island_y[ii], false);
+      dt_set_grid_traversable(grid,
+                              island_x[ii] + jj,
+                              island_y[ii] + DT_REGION_BENCH_ISLAND_SIZE - 1,
+                              false);
+      dt_set_grid_traversable(grid, island_x[ii], island_y[ii] + jj, false);
+      dt_set_grid_traversable(grid,
+                              island_x[ii] + DT_REGION_BENCH_ISLAND_SIZE - 1,
+                              island_y[ii] + jj,
+                              false);
+    }
+  }
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+  search = dt_create_path_search(grid);
+
+  field = dt_get_grid_cost_field(grid, &unit);
+  start_time = dt_get_time_us();
+  map = dt_get_region_map(grid, field);
+  build_time_us = dt_get_time_us() - start_time;
+
+  /****************************************************************************/
+  /* Search to a point in the middle of a square and to a random point in     */
+  /* turn. Goals which cannot be entered are opened first.                    */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_REGION_BENCH_SEARCHES; ii++)
+  {
+    start_x = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+    start_y = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+    if (0 == (ii & 1))
+    {
+      jj = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_ISLANDS);
+      goal_x = island_x[jj] + (DT_REGION_BENCH_ISLAND_SIZE / 2);
+      goal_y = island_y[jj] + (DT_REGION_BENCH_ISLAND_SIZE / 2);
+    }
+    else
+    {
+      goal_x = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+      goal_y = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+    }
+    if (!dt_is_grid_traversable(grid, goal_x, goal_y))
+    {
+      dt_set_grid_traversable(grid, goal_x, goal_y, true);
+    }
+
+    start_time = dt_get_time_us();
+    found = (DT_PATH_FOUND == dt_find_path(search,
+                                           &unit,
+                                           start_x,
+                                           start_y,
+                                           goal_x,
+                                           goal_y,
+                                           &path)) ? 1 : 0;
+    search_time_us[found] += dt_get_time_us() - start_time;
+    nodes_expanded[found] += (Uint64) search->nodes_expanded;
+    (num_searches[found])++;
+    if (NULL != path)
+    {
+      dt_destroy_path(path);
+    }
+  }
+
+  /****************************************************************************/
+  /* Close points and open them again.                                        */
+  /****************************************************************************/
+  num_builds = map->num_builds;
+  num_splits = map->num_splits;
+  start_time = dt_get_time_us();
+  for (ii = 0; ii < DT_REGION_BENCH_CHANGES; ii++)
+  {
+    edit_x = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+    edit_y = (int) (dt_benchmark_random(&seed) % DT_REGION_BENCH_SIZE);
+    if (dt_is_grid_traversable(grid, edit_x, edit_y))
+    {
+      dt_set_grid_traversable(grid, edit_x, edit_y, false);
+      dt_get_region_map(grid, field);
+      dt_set_grid_traversable(grid, edit_x, edit_y, true);
+      dt_get_region_map(grid, field);
+    }
+  }
+  change_time_us = dt_get_time_us() - start_time;
+
+  printf("  labelling    %8.2f ms for the whole map, %.1f KB\n",
+         build_time_us / 1000.0,
+         dt_get_region_map_memory_usage(map) / 1024.0);
+  printf("  unreachable  %8.1f us a search, %.0f points expanded, "
+         "%ld searches, %ld turned down at once\n",
+         search_time_us[0] / (double) MAX(num_searches[0], 1),
+         nodes_expanded[0] / (double) MAX(num_searches[0], 1),
+         num_searches[0],
+         map->num_rejected);
+  printf("  reachable    %8.1f us a search, %.0f points expanded, "
+         "%ld searches\n",
+         search_time_us[1] / (double) MAX(num_searches[1], 1),
+         nodes_expanded[1] / (double) MAX(num_searches[1], 1),
+         num_searches[1]);
+  printf("  changes      %8.1f us a point closed and opened, %ld regions "
+         "split, %ld full labellings\n",
+         change_time_us / (double) DT_REGION_BENCH_CHANGES,
+         map->num_splits - num_splits,
+         map->num_builds - num_builds);
+
+  dt_destroy_path_search(search);
+  dt_destroy_grid(grid);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_landmarks                                           */
+/*                                                                            */
+/* Purpose: Compare A* estimating with landmarks against the octile distance. */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Generate the map of the path search benchmark and then the      */
+/*            larger one of the hierarchical path search benchmark, and run   */
+/*            the searches of each on it.                                     */
+/******************************************************************************/
+void dt_benchmark_landmarks()
+{
+  printf("Landmark benchmark: A* estimating with landmarks against the "
+         "octile distance\n");
+  dt_benchmark_landmark_map(DT_PATH_BENCH_SIZE, DT_PATH_BENCH_QUERIES);
+  dt_benchmark_landmark_map(DT_HIERARCHY_BENCH_SIZE,
+                            DT_HIERARCHY_BENCH_QUERIES);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_benchmark_landmark_map                                        */
+/*                                                                            */
+/* Purpose: Run the landmark benchmark on one generated map.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     size - The width and height of the map.                 */
+/*             IN     num_queries - The number of searches, each from the     */
+/*                                  start of one generated unit to that of    */
+/*                                  the next.                                 */
+/*                                                                            */
+/* Operation: Run the searches with the octile distance alone, then with each */
+/*            number of landmarks from DT_LANDMARK_BENCH_MIN_COUNT to         */
+/*            DT_LANDMARK_BENCH_MAX_COUNT. Report the time to build the       */
+/*            landmarks and the memory each takes, and how many times fewer   */
+/*            nodes the searches expand and how many times faster they are.   */
+/*            The total cost of the paths must be the same every time, as the */
+/*            landmark estimate never overestimates.                          */
+/******************************************************************************/
+void dt_benchmark_landmark_map(int size, int num_queries)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  DT_PATH_SEARCH *search;
+  DT_LANDMARKS *landmarks;
+  DT_UNIT unit;
+  Uint64 octile_nodes_expanded;
+  Uint64 octile_time_us;
+  char name[32];
+  int num_landmarks;
+
+  generator = dt_create_map_generator(size,
+                                      size,
+                                      DT_BENCHMARK_SEED,
+                                      num_queries + 1);
+  grid = dt_generate_map(generator, DT_GRID_STORAGE_ROW_MAJOR);
+  printf("  %d searches on a generated %d x %d map\n",
+         num_queries,
+         size,
+         size);
+
+  search = dt_create_path_search(grid);
+  dt_benchmark_path_queries(generator, search, 0, false, "octile");
+  octile_nodes_expanded = search->total_nodes_expanded;
+  octile_time_us = search->total_search_time_us;
+
+  memset(&unit, 0, sizeof(DT_UNIT));
+  unit.unit_class = DT_UNIT_CLASS_NORMAL;
+  unit.speed = 1;
+  for (num_landmarks = DT_LANDMARK_BENCH_MIN_COUNT;
+       num_landmarks <= DT_LANDMARK_BENCH_MAX_COUNT;
+       num_landmarks *= 2)
+  {
+    sprintf(name, "%d marks", num_landmarks);
+    landmarks = dt_get_grid_landmarks(grid, &unit, num_landmarks);
+    printf("  %-9s  built in %.1f ms, %.1f KB per landmark\n",
+           name,
+           landmarks->build_time_us / 1000.0,
+           (dt_get_landmarks_memory_usage(landmarks) / 1024.0) /
+                                                     (double) num_landmarks);
+    search->total_nodes_expanded = 0;
+    search->total_search_time_us = 0;
+    search->num_searches = 0;
+    dt_benchmark_path_queries(generator, search, 0, false, name);
+    printf("             %.2f times fewer nodes, %.2f times as fast\n",
+           (double) octile_nodes_expanded /
+                           (double) MAX(search->total_nodes_expanded, 1),
+           (double) octile_time_us /
+                           (double) MAX(search->total_search_time_us, 1));
+  }
+
+  dt_destroy_path_search(search);
+  dt_destroy_grid(grid);
+  dt_destroy_map_generator(generator);
+
+  return;
+}
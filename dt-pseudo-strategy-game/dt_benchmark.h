@@ -0,0 +1,241 @@
+/******************************************************************************/
+/* File: dt_benchmark.h                                                       */
+/*                                                                            */
+/* Purpose: Definitions for the performance benchmarks which can be run from  */
+/*          the command line with "-benchmark <name>".                        */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Return codes for dt_run_benchmark.                                         */
+/******************************************************************************/
+#define DT_BENCHMARK_OK 0
+#define DT_BENCHMARK_UNKNOWN 1
+
+/******************************************************************************/
+/* The seed used for the pseudo random numbers in the benchmarks so that each */
+/* run does exactly the same work.                                            */
+/******************************************************************************/
+#define DT_BENCHMARK_SEED 0x2545F491u
+
+/******************************************************************************/
+/* Parameters of the grid layout benchmark.                                   */
+/*                                                                            */
+/* DT_LAYOUT_BENCH_QUERIES - The number of A* style searches on each map.     */
+/* DT_LAYOUT_BENCH_EXPANSIONS - The number of points expanded per search.     */
+/* DT_LAYOUT_BENCH_GOAL_RANGE - How far from its start a search's goal may    */
+/*                              be in each direction.                         */
+/* DT_LAYOUT_BENCH_BLOCKED_PERCENT - The percentage of points on the map that */
+/*                                   are not traversable.                     */
+/******************************************************************************/
+#define DT_LAYOUT_BENCH_QUERIES 2000
+#define DT_LAYOUT_BENCH_EXPANSIONS 2000
+#define DT_LAYOUT_BENCH_GOAL_RANGE 512
+#define DT_LAYOUT_BENCH_BLOCKED_PERCENT 25
+
+/******************************************************************************/
+/* Parameters of the map loading benchmark.                                   */
+/*                                                                            */
+/* DT_MAPLOAD_BENCH_SIZE - The width and height of the map.                   */
+/* DT_MAPLOAD_BENCH_TEXT_FILE - The text map written and loaded.              */
+/* DT_MAPLOAD_BENCH_BINARY_FILE - The binary map written and opened.          */
+/******************************************************************************/
+#define DT_MAPLOAD_BENCH_SIZE 8192
+#define DT_MAPLOAD_BENCH_TEXT_FILE "dt_benchmark_map.txt"
+#define DT_MAPLOAD_BENCH_BINARY_FILE "dt_benchmark_map.bin"
+
+/******************************************************************************/
+/* Parameters of the chunk compression benchmark.                             */
+/*                                                                            */
+/* DT_COMPRESS_BENCH_SIZE - The width and height of the map.                  */
+/* DT_COMPRESS_BENCH_REGION - The width and height of the square regions of   */
+/*                            the map which share a tile type and elevation.  */
+/* DT_COMPRESS_BENCH_MAX_INFLATED - The number of chunks left inflated when   */
+/*                                  the grid is compacted.                    */
+/******************************************************************************/
+#define DT_COMPRESS_BENCH_SIZE 2048
+#define DT_COMPRESS_BENCH_REGION 16
+#define DT_COMPRESS_BENCH_MAX_INFLATED 64
+
+/******************************************************************************/
+/* Parameters of the map generator benchmark.                                 */
+/*                                                                            */
+/* DT_MAPGEN_BENCH_MIN_SIZE - The width and height of the smallest map. Each  */
+/*                            map after it is four times as wide and high.    */
+/* DT_MAPGEN_BENCH_MAX_SIZE - The width and height of the largest map.        */
+/* DT_MAPGEN_BENCH_MATCH_SIZE - The largest map also generated into a         */
+/*                              row-major grid to check the two match.        */
+/* DT_MAPGEN_BENCH_UNITS - The number of units placed on each map.            */
+/* DT_MAPGEN_BENCH_FILE - The chunked binary map the largest map is written   */
+/*                        to and loaded back from.                            */
+/******************************************************************************/
+#define DT_MAPGEN_BENCH_MIN_SIZE 64
+#define DT_MAPGEN_BENCH_MAX_SIZE 4096
+#define DT_MAPGEN_BENCH_MATCH_SIZE 1024
+#define DT_MAPGEN_BENCH_UNITS 1000
+#define DT_MAPGEN_BENCH_FILE "dt_benchmark_generated.bin"
+
+/******************************************************************************/
+/* Parameters of the path search benchmark.                                   */
+/*                                                                            */
+/* DT_PATH_BENCH_SIZE - The width and height of the generated map.            */
+/* DT_PATH_BENCH_QUERIES - The number of searches run on each grid. Each goes */
+/*                         from the start of one generated unit to that of    */
+/*                         the next.                                          */
+/******************************************************************************/
+#define DT_PATH_BENCH_SIZE 1024
+#define DT_PATH_BENCH_QUERIES 200
+
+/******************************************************************************/
+/* Parameters of the hierarchical path search benchmark.                      */
+/*                                                                            */
+/* DT_HIERARCHY_BENCH_SIZE - The width and height of the generated map.       */
+/* DT_HIERARCHY_BENCH_QUERIES - The number of searches run. Each goes from    */
+/*                              the start of one generated unit to that of    */
+/*                              the next, so most cross much of the map.      */
+/* DT_HIERARCHY_BENCH_EDITS - The number of points blocked before the         */
+/*                            hierarchy is brought up to date again.          */
+/******************************************************************************/
+#define DT_HIERARCHY_BENCH_SIZE 2048
+#define DT_HIERARCHY_BENCH_QUERIES 50
+#define DT_HIERARCHY_BENCH_EDITS 16
+
+/******************************************************************************/
+/* Parameters of the flow field benchmark.                                    */
+/*                                                                            */
+/* DT_FLOW_BENCH_SIZE - The width and height of the generated map.            */
+/* DT_FLOW_BENCH_UNITS - The number of units sent to the rally point, which   */
+/*                       is the start of one more generated unit.             */
+/******************************************************************************/
+#define DT_FLOW_BENCH_SIZE 1024
+#define DT_FLOW_BENCH_UNITS 200
+
+/******************************************************************************/
+/* Parameters of the movement range benchmark.                                */
+/*                                                                            */
+/* DT_RANGE_BENCH_SIZE - The width and height of the generated map.           */
+/* DT_RANGE_BENCH_UNITS - The number of units whose range is found for each   */
+/*                        distance.                                           */
+/* DT_RANGE_BENCH_MIN_DISTANCE - The first max_movement_distance tried. Each  */
+/*                               one after is double the last.                */
+/* DT_RANGE_BENCH_MAX_DISTANCE - The last max_movement_distance tried.        */
+/******************************************************************************/
+#define DT_RANGE_BENCH_SIZE 1024
+#define DT_RANGE_BENCH_UNITS 1000
+#define DT_RANGE_BENCH_MIN_DISTANCE 8
+#define DT_RANGE_BENCH_MAX_DISTANCE 64
+
+/******************************************************************************/
+/* Parameters of the path cache benchmark.                                    */
+/*                                                                            */
+/* DT_CACHE_BENCH_SIZE - The width and height of the generated map.           */
+/* DT_CACHE_BENCH_UNITS - The number of units which ask for their route each  */
+/*                        turn, each to the start of the next generated unit. */
+/* DT_CACHE_BENCH_TURNS - The number of turns played.                         */
+/* DT_CACHE_BENCH_EDITS - The number of points of the map changed each turn.  */
+/******************************************************************************/
+#define DT_CACHE_BENCH_SIZE 512
+#define DT_CACHE_BENCH_UNITS 100
+#define DT_CACHE_BENCH_TURNS 20
+#define DT_CACHE_BENCH_EDITS 4
+
+/******************************************************************************/
+/* Parameters of the replanning benchmark.                                    */
+/*                                                                            */
+/* DT_REPLAN_BENCH_SIZE - The width and height of the generated map.          */
+/* DT_REPLAN_BENCH_UNITS - The number of units moving, each from one          */
+/*                         generated unit to the next.                        */
+/* DT_REPLAN_BENCH_TICKS - The number of times every unit plans.              */
+/* DT_REPLAN_BENCH_CHANGES - The number of points blocked or freed before     */
+/*                           each tick.                                       */
+/* DT_REPLAN_BENCH_STEPS - The number of steps each unit takes along its path */
+/*                         each tick.                                         */
+/******************************************************************************/
+#define DT_REPLAN_BENCH_SIZE 512
+#define DT_REPLAN_BENCH_UNITS 16
+#define DT_REPLAN_BENCH_TICKS 30
+#define DT_REPLAN_BENCH_CHANGES 20
+#define DT_REPLAN_BENCH_STEPS 4
+
+/******************************************************************************/
+/* Parameters of the batched path benchmark.                                  */
+/*                                                                            */
+/* DT_BATCH_BENCH_SIZE - The width and height of the generated map.           */
+/* DT_BATCH_BENCH_REQUESTS - The number of requests in the batch.             */
+/* DT_BATCH_BENCH_RANGE - The furthest a goal is from its start along each    */
+/*                        axis.                                               */
+/* DT_BATCH_BENCH_MAX_THREADS - The most worker threads tried. The pools      */
+/*                              tried have 0 threads and then twice as many   */
+/*                              searches each time.                           */
+/******************************************************************************/
+#define DT_BATCH_BENCH_SIZE 1024
+#define DT_BATCH_BENCH_REQUESTS 1000
+#define DT_BATCH_BENCH_RANGE 96
+#define DT_BATCH_BENCH_MAX_THREADS 15
+
+/******************************************************************************/
+/* Parameters of the time-sliced path benchmark.                              */
+/*                                                                            */
+/* DT_SLICE_BENCH_SIZE - The width and height of the generated map.           */
+/* DT_SLICE_BENCH_UNITS - The number of units asking for a path, each from    */
+/*                        one generated unit to the next. The first goes      */
+/*                        from corner to corner of the map.                   */
+/* DT_SLICE_BENCH_FRAME_US - The time each frame gives the scheduler, in      */
+/*                           microseconds.                                    */
+/******************************************************************************/
+#define DT_SLICE_BENCH_SIZE 1024
+#define DT_SLICE_BENCH_UNITS 32
+#define DT_SLICE_BENCH_FRAME_US 2000
+
+/******************************************************************************/
+/* Parameters of the cooperative path benchmark.                              */
+/*                                                                            */
+/* DT_COOP_BENCH_GROUP - The width and height of the block of units on each   */
+/*                       side of the wall. Each unit is sent to the point     */
+/*                       opposite it on the other side.                       */
+/* DT_COOP_BENCH_UNITS - The number of units in both blocks.                  */
+/* DT_COOP_BENCH_GAP - The width of the gap in the wall down the middle of    */
+/*                     the map, which every unit must pass through.           */
+/* DT_COOP_BENCH_SPACING - The distance from the wall to each block.          */
+/* DT_COOP_BENCH_MAX_TICKS - The most ticks the units are given to arrive.    */
+/* DT_COOP_BENCH_REPLAN_TICKS - The number of ticks between cooperative plans */
+/*                              of the group.                                 */
+/******************************************************************************/
+#define DT_COOP_BENCH_GROUP 4
+#define DT_COOP_BENCH_UNITS (2 * DT_COOP_BENCH_GROUP * DT_COOP_BENCH_GROUP)
+#define DT_COOP_BENCH_GAP 4
+#define DT_COOP_BENCH_SPACING 8
+#define DT_COOP_BENCH_MAX_TICKS 400
+#define DT_COOP_BENCH_REPLAN_TICKS (DT_COOP_WINDOW / 2)
+
+/******************************************************************************/
+/* Parameters of the region map benchmark.                                    */
+/*                                                                            */
+/* DT_REGION_BENCH_SIZE - The width and height of the map.                    */
+/* DT_REGION_BENCH_BLOCKED_PERCENT - The percentage of points on the map that */
+/*                                   are not traversable.                     */
+/* DT_REGION_BENCH_ISLANDS - The number of squares walled off from the rest   */
+/*                           of the map.                                      */
+/* DT_REGION_BENCH_ISLAND_SIZE - The width and height of each square,         */
+/*                               including its wall.                          */
+/* DT_REGION_BENCH_SEARCHES - The number of searches. Every other one is to a */
+/*                            goal inside a walled square.                    */
+/* DT_REGION_BENCH_CHANGES - The number of points closed and opened again     */
+/*                           after the searches.                              */
+/******************************************************************************/
+#define DT_REGION_BENCH_SIZE 512
+#define DT_REGION_BENCH_BLOCKED_PERCENT 20
+#define DT_REGION_BENCH_ISLANDS 64
+#define DT_REGION_BENCH_ISLAND_SIZE 12
+#define DT_REGION_BENCH_SEARCHES 256
+#define DT_REGION_BENCH_CHANGES 1000
+
+/******************************************************************************/
+/* Parameters of the landmark benchmark. It searches the maps of the path     */
+/* search and hierarchical path search benchmarks.                            */
+/*                                                                            */
+/* DT_LANDMARK_BENCH_MIN_COUNT - The fewest landmarks tried. Each number      */
+/*                               after is double the last.                    */
+/* DT_LANDMARK_BENCH_MAX_COUNT - The most landmarks tried.                    */
+/******************************************************************************/
+#define DT_LANDMARK_BENCH_MIN_COUNT 2
+#define DT_LANDMARK_BENCH_MAX_COUNT 8
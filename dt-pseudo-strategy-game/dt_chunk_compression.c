@@ -0,0 +1,689 @@
+/******************************************************************************/
+/* File: dt_chunk_compression.c                                               */
+/*                                                                            */
+/* Purpose: Encoding and decoding of chunk records, and the chunk store which */
+/*          keeps the chunks of a grid compressed in memory until they are    */
+/*          used.                                                             */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_encode_map_file_chunk                                         */
+/*                                                                            */
+/* Purpose: Encode a chunk record.                                            */
+/*                                                                            */
+/* Returns: The encoding actually used. One of DT_CHUNK_ENCODINGS.            */
+/*                                                                            */
+/* Parameters: IN     record - The record to encode.                          */
+/*             IN     encoding - The encoding to use.                         */
+/*             OUT    buffer - The encoded record. Must have room for         */
+/*                             DT_CHUNK_MAX_ENCODED_SIZE bytes.               */
+/*             OUT    size - The size of the encoded record.                  */
+/*                                                                            */
+/* Operation: Shuffle the record and compress it. If that fails or does not   */
+/*            make the record any smaller then store it raw instead.          */
+/******************************************************************************/
+int dt_encode_map_file_chunk(DT_MAP_FILE_CHUNK *record,
+                             int encoding,
+                             unsigned char *buffer,
+                             Uint32 *size)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  unsigned char shuffled[sizeof(DT_MAP_FILE_CHUNK)];
+  uLongf zlib_size;
+  size_t encoded_size = sizeof(DT_MAP_FILE_CHUNK);
+
+  if (DT_CHUNK_ENCODING_RAW != encoding)
+  {
+    dt_shuffle_map_file_chunk(record, shuffled);
+  }
+
+  if (DT_CHUNK_ENCODING_RLE == encoding)
+  {
+    encoded_size = dt_rle_encode(shuffled, sizeof(shuffled), buffer);
+  }
+  else if (DT_CHUNK_ENCODING_ZLIB == encoding)
+  {
+    zlib_size = (uLongf) DT_CHUNK_MAX_ENCODED_SIZE;
+    if (Z_OK == compress2(buffer,
+                          &zlib_size,
+                          shuffled,
+                          (uLong) sizeof(shuffled),
+                          DT_CHUNK_ZLIB_LEVEL))
+    {
+      encoded_size = (size_t) zlib_size;
+    }
+  }
+
+  if (encoded_size >= sizeof(DT_MAP_FILE_CHUNK))
+  {
+    memcpy(buffer, record, sizeof(DT_MAP_FILE_CHUNK));
+    encoded_size = sizeof(DT_MAP_FILE_CHUNK);
+    encoding = DT_CHUNK_ENCODING_RAW;
+  }
+  (*size) = (Uint32) encoded_size;
+
+  return(encoding);
+}
+
+/******************************************************************************/
+/* Function: dt_decode_map_file_chunk                                         */
+/*                                                                            */
+/* Purpose: Decode a chunk record.                                            */
+/*                                                                            */
+/* Returns: true if the record was decoded, false if the data is not valid.   */
+/*                                                                            */
+/* Parameters: IN     data - The encoded record.                              */
+/*             IN     size - The size of the encoded record.                  */
+/*             IN     encoding - How the record is encoded.                   */
+/*             OUT    record - The decoded record.                            */
+/*                                                                            */
+/* Operation: Decompress the record and undo the shuffle. The data must       */
+/*            decode to exactly one record.                                   */
+/******************************************************************************/
+bool dt_decode_map_file_chunk(unsigned char *data,
+                              Uint32 size,
+                              int encoding,
+                              DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  unsigned char shuffled[sizeof(DT_MAP_FILE_CHUNK)];
+  uLongf zlib_size;
+  bool decoded = false;
+
+  if (!dt_check_chunk_encoding(encoding, size))
+  {
+    goto EXIT_LABEL;
+  }
+
+  if (DT_CHUNK_ENCODING_RAW == encoding)
+  {
+    memcpy(record, data, sizeof(DT_MAP_FILE_CHUNK));
+    decoded = true;
+    goto EXIT_LABEL;
+  }
+  if (DT_CHUNK_ENCODING_RLE == encoding)
+  {
+    decoded = dt_rle_decode(data, size, shuffled, sizeof(shuffled));
+  }
+  else
+  {
+    zlib_size = (uLongf) sizeof(shuffled);
+    decoded = (Z_OK == uncompress(shuffled, &zlib_size, data, (uLong) size)) &&
+              (sizeof(shuffled) == zlib_size);
+  }
+  if (decoded)
+  {
+    dt_unshuffle_map_file_chunk(shuffled, record);
+  }
+
+EXIT_LABEL:
+
+  return(decoded);
+}
+
+/******************************************************************************/
+/* Function: dt_check_chunk_encoding                                          */
+/*                                                                            */
+/* Purpose: Check an encoding and size given for a chunk record.              */
+/*                                                                            */
+/* Returns: true if a record could be stored that way.                        */
+/*                                                                            */
+/* Parameters: IN     encoding - The encoding of the record.                  */
+/*             IN     size - The size of the encoded record.                  */
+/*                                                                            */
+/* Operation: Raw records are exactly one record long. Others are not empty   */
+/*            and no bigger than the worst case of their encoding.            */
+/******************************************************************************/
+bool dt_check_chunk_encoding(int encoding, Uint32 size)
+{
+  return(((DT_CHUNK_ENCODING_RAW == encoding) &&
+          (sizeof(DT_MAP_FILE_CHUNK) == size)) ||
+         (((DT_CHUNK_ENCODING_RLE == encoding) ||
+           (DT_CHUNK_ENCODING_ZLIB == encoding)) &&
+          (0 < size) &&
+          (DT_CHUNK_MAX_ENCODED_SIZE >= size)));
+}
+
+/******************************************************************************/
+/* Function: dt_shuffle_map_file_chunk                                        */
+/*                                                                            */
+/* Purpose: Rearrange a chunk record so that it compresses better.            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     record - The record.                                    */
+/*             OUT    bytes - The shuffled record, the size of a record.      */
+/*                                                                            */
+/* Operation: Copy the record, replacing the elevation layer with the low     */
+/*            byte of every elevation followed by the high byte of every      */
+/*            elevation.                                                      */
+/******************************************************************************/
+void dt_shuffle_map_file_chunk(DT_MAP_FILE_CHUNK *record, unsigned char *bytes)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  unsigned char *low_bytes;
+  Uint16 elevation;
+  int ii;
+
+  memcpy(bytes, record, sizeof(DT_MAP_FILE_CHUNK));
+  low_bytes = bytes + offsetof(DT_MAP_FILE_CHUNK, elevation);
+  for (ii = 0; ii < DT_GRID_CHUNK_POINTS; ii++)
+  {
+    elevation = (Uint16) record->elevation[ii];
+    low_bytes[ii] = (unsigned char) (elevation & 0xFF);
+    low_bytes[DT_GRID_CHUNK_POINTS + ii] = (unsigned char) (elevation >> 8);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_unshuffle_map_file_chunk                                      */
+/*                                                                            */
+/* Purpose: Undo dt_shuffle_map_file_chunk.                                   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     bytes - The shuffled record.                            */
+/*             OUT    record - The record.                                    */
+/*                                                                            */
+/* Operation: Copy the record and join the bytes of each elevation again.     */
+/******************************************************************************/
+void dt_unshuffle_map_file_chunk(unsigned char *bytes,
+                                 DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  unsigned char *low_bytes;
+  int ii;
+
+  memcpy(record, bytes, sizeof(DT_MAP_FILE_CHUNK));
+  low_bytes = bytes + offsetof(DT_MAP_FILE_CHUNK, elevation);
+  for (ii = 0; ii < DT_GRID_CHUNK_POINTS; ii++)
+  {
+    record->elevation[ii] = (Sint16) (Uint16) (low_bytes[ii] |
+                              (low_bytes[DT_GRID_CHUNK_POINTS + ii] << 8));
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_rle_encode                                                    */
+/*                                                                            */
+/* Purpose: Run-length encode a block of bytes.                               */
+/*                                                                            */
+/* Returns: The size of the encoded data.                                     */
+/*                                                                            */
+/* Parameters: IN     in - The bytes to encode.                               */
+/*             IN     length - The number of bytes to encode.                 */
+/*             OUT    out - The encoded data. Must have room for length plus  */
+/*                          one byte for every DT_CHUNK_RLE_MAX_RUN bytes.    */
+/*                                                                            */
+/* Operation: Store each run of at least DT_CHUNK_RLE_MIN_REPEAT equal bytes  */
+/*            as a repeat. Gather the bytes between repeats into copies.      */
+/******************************************************************************/
+size_t dt_rle_encode(unsigned char *in, size_t length, unsigned char *out)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  size_t run;
+  size_t control_pos;
+
+  while (in_pos < length)
+  {
+    run = dt_rle_repeat_length(in, in_pos, length);
+    if (run >= DT_CHUNK_RLE_MIN_REPEAT)
+    {
+      out[out_pos++] = (unsigned char) (257 - run);
+      out[out_pos++] = in[in_pos];
+      in_pos += run;
+    }
+    else
+    {
+      control_pos = out_pos++;
+      run = 0;
+      while ((in_pos < length) &&
+             (run < DT_CHUNK_RLE_MAX_RUN) &&
+             (dt_rle_repeat_length(in, in_pos, length) <
+                                                     DT_CHUNK_RLE_MIN_REPEAT))
+      {
+        out[out_pos++] = in[in_pos++];
+        run++;
+      }
+      out[control_pos] = (unsigned char) (run - 1);
+    }
+  }
+
+  return(out_pos);
+}
+
+/******************************************************************************/
+/* Function: dt_rle_repeat_length                                             */
+/*                                                                            */
+/* Purpose: Measure the run of equal bytes at a position.                     */
+/*                                                                            */
+/* Returns: The number of bytes equal to the first, from 1 to                 */
+/*          DT_CHUNK_RLE_MAX_RUN.                                             */
+/*                                                                            */
+/* Parameters: IN     in - The bytes.                                         */
+/*             IN     pos - The position of the first byte of the run.        */
+/*             IN     length - The number of bytes.                           */
+/*                                                                            */
+/* Operation: Count forwards until a byte differs.                            */
+/******************************************************************************/
+size_t dt_rle_repeat_length(unsigned char *in, size_t pos, size_t length)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t run = 1;
+
+  while ((pos + run < length) &&
+         (run < DT_CHUNK_RLE_MAX_RUN) &&
+         (in[pos + run] == in[pos]))
+  {
+    run++;
+  }
+
+  return(run);
+}
+
+/******************************************************************************/
+/* Function: dt_rle_decode                                                    */
+/*                                                                            */
+/* Purpose: Decode run-length encoded data.                                   */
+/*                                                                            */
+/* Returns: true if the data decoded to exactly out_length bytes.             */
+/*                                                                            */
+/* Parameters: IN     in - The encoded data.                                  */
+/*             IN     in_length - The size of the encoded data.               */
+/*             OUT    out - The decoded bytes.                                */
+/*             IN     out_length - The number of bytes expected.              */
+/*                                                                            */
+/* Operation: Expand each run in turn, checking every run fits in both        */
+/*            buffers.                                                        */
+/******************************************************************************/
+bool dt_rle_decode(unsigned char *in,
+                   size_t in_length,
+                   unsigned char *out,
+                   size_t out_length)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  size_t run;
+  unsigned char control;
+  bool decoded = false;
+
+  while (in_pos < in_length)
+  {
+    control = in[in_pos++];
+    if (control < 128)
+    {
+      run = (size_t) control + 1;
+      if ((run > in_length - in_pos) || (run > out_length - out_pos))
+      {
+        goto EXIT_LABEL;
+      }
+      memcpy(out + out_pos, in + in_pos, run);
+      in_pos += run;
+    }
+    else
+    {
+      run = 257 - (size_t) control;
+      if ((128 == control) ||
+          (in_pos == in_length) ||
+          (run > out_length - out_pos))
+      {
+        goto EXIT_LABEL;
+      }
+      memset(out + out_pos, in[in_pos++], run);
+    }
+    out_pos += run;
+  }
+  decoded = (out_pos == out_length);
+
+EXIT_LABEL:
+
+  return(decoded);
+}
+
+/******************************************************************************/
+/* Function: dt_create_chunk_store                                            */
+/*                                                                            */
+/* Purpose: Create an empty chunk store.                                      */
+/*                                                                            */
+/* Returns: A pointer to the new store.                                       */
+/*                                                                            */
+/* Parameters: IN     num_chunks - The number of chunks in the grid.          */
+/*             IN     encoding - The encoding to compress chunks with.        */
+/*             IN     max_inflated_chunks - The number of chunks to leave     */
+/*                                          inflated when compacting.         */
+/*                                                                            */
+/* Operation: No chunk has a compressed copy to begin with.                   */
+/******************************************************************************/
+DT_CHUNK_STORE *dt_create_chunk_store(size_t num_chunks,
+                                      int encoding,
+                                      int max_inflated_chunks)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STORE *store;
+
+  store = (DT_CHUNK_STORE *) dt_malloc(sizeof(DT_CHUNK_STORE));
+  store->chunks = (DT_COMPRESSED_CHUNK *) dt_calloc(num_chunks,
+                                                  sizeof(DT_COMPRESSED_CHUNK));
+  store->encoding = encoding;
+  store->inflated_chunks_size = 64;
+  store->inflated_chunks = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                                store->inflated_chunks_size);
+  store->num_inflated_chunks = 0;
+  store->max_inflated_chunks = (size_t) MAX(max_inflated_chunks, 0);
+  store->compressed_bytes = 0;
+  store->num_inflations = 0;
+  store->inflate_time_us = 0;
+
+  return(store);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_chunk_store                                           */
+/*                                                                            */
+/* Purpose: Free a chunk store.                                               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     store - The store to free.                              */
+/*             IN     num_chunks - The number of chunks in the grid.          */
+/*                                                                            */
+/* Operation: Free every compressed copy and then the store. The inflated     */
+/*            chunks belong to the grid.                                      */
+/******************************************************************************/
+void dt_destroy_chunk_store(DT_CHUNK_STORE *store, size_t num_chunks)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t ii;
+
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (NULL != store->chunks[ii].data)
+    {
+      dt_free(store->chunks[ii].data);
+    }
+  }
+  dt_free(store->inflated_chunks);
+  dt_free(store->chunks);
+  dt_free(store);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_compress_grid_chunks                                          */
+/*                                                                            */
+/* Purpose: Start keeping the chunks of a chunked grid compressed in memory.  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The chunked grid. It must not be streamed.       */
+/*             IN     encoding - The encoding to compress chunks with.        */
+/*             IN     max_inflated_chunks - The number of chunks to leave     */
+/*                                          inflated when compacting.         */
+/*                                                                            */
+/* Operation: Compress every allocated chunk. Free those with no units on     */
+/*            them, which are inflated again when next accessed. Chunks which */
+/*            hold units stay inflated.                                       */
+/******************************************************************************/
+void dt_compress_grid_chunks(DT_GRID *grid,
+                             int encoding,
+                             int max_inflated_chunks)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STORE *store;
+  size_t num_chunks;
+  size_t ii;
+
+  if ((DT_GRID_STORAGE_CHUNKED != grid->storage) ||
+      (NULL != grid->chunk_store) ||
+      (NULL != grid->streamer))
+  {
+    goto EXIT_LABEL;
+  }
+
+  num_chunks = (size_t) grid->num_chunks_x * (size_t) grid->num_chunks_y;
+  store = dt_create_chunk_store(num_chunks, encoding, max_inflated_chunks);
+  grid->chunk_store = store;
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (grid->default_chunk == grid->chunks[ii])
+    {
+      continue;
+    }
+    dt_store_grid_chunk(grid, ii);
+    if (dt_grid_chunk_has_units(grid->chunks[ii]))
+    {
+      dt_add_inflated_grid_chunk(store, ii);
+    }
+    else
+    {
+      dt_free(grid->chunks[ii]);
+      grid->chunks[ii] = NULL;
+      (grid->num_allocated_chunks)--;
+    }
+  }
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_store_grid_chunk                                              */
+/*                                                                            */
+/* Purpose: Compress an inflated chunk of a grid into its chunk store.        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid, which has a chunk store.               */
+/*             IN     index - The index of the chunk, which is inflated.      */
+/*                                                                            */
+/* Operation: Encode the chunk's terrain with the encoding of the store and   */
+/*            replace any older compressed copy.                              */
+/******************************************************************************/
+void dt_store_grid_chunk(DT_GRID *grid, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STORE *store = grid->chunk_store;
+  DT_COMPRESSED_CHUNK *compressed = &(store->chunks[index]);
+  DT_MAP_FILE_CHUNK record;
+  unsigned char buffer[DT_CHUNK_MAX_ENCODED_SIZE];
+  Uint32 size;
+
+  dt_fill_map_file_chunk(grid->chunks[index], &record);
+  compressed->encoding = (Uint32) dt_encode_map_file_chunk(&record,
+                                                           store->encoding,
+                                                           buffer,
+                                                           &size);
+  if (NULL != compressed->data)
+  {
+    store->compressed_bytes -= compressed->size;
+    dt_free(compressed->data);
+  }
+  compressed->data = (unsigned char *) dt_malloc(size);
+  memcpy(compressed->data, buffer, size);
+  compressed->size = size;
+  compressed->dirty = false;
+  store->compressed_bytes += size;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_inflate_grid_chunk                                            */
+/*                                                                            */
+/* Purpose: Inflate a compressed chunk of a grid the first time it is used.   */
+/*                                                                            */
+/* Returns: A pointer to the inflated chunk.                                  */
+/*                                                                            */
+/* Parameters: IN     grid - The grid, which has a chunk store.               */
+/*             IN     index - The index of the chunk, whose entry in the      */
+/*                            chunk table is NULL.                            */
+/*                                                                            */
+/* Operation: Decode the compressed copy into a new chunk with no units and   */
+/*            put it into the chunk table. A copy which cannot be decoded     */
+/*            gives an empty plain. The time taken is added to the store's    */
+/*            totals.                                                         */
+/******************************************************************************/
+DT_GRID_CHUNK *dt_inflate_grid_chunk(DT_GRID *grid, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STORE *store = grid->chunk_store;
+  DT_COMPRESSED_CHUNK *compressed = &(store->chunks[index]);
+  DT_MAP_FILE_CHUNK record;
+  DT_GRID_CHUNK *chunk;
+  Uint64 start_time;
+
+  start_time = dt_get_time_us();
+  chunk = (DT_GRID_CHUNK *) dt_malloc(sizeof(DT_GRID_CHUNK));
+  if (dt_decode_map_file_chunk(compressed->data,
+                               compressed->size,
+                               (int) compressed->encoding,
+                               &record))
+  {
+    dt_copy_map_file_chunk(&record, chunk);
+  }
+  else
+  {
+    dt_init_grid_chunk(chunk);
+  }
+  grid->chunks[index] = chunk;
+  (grid->num_allocated_chunks)++;
+  dt_add_inflated_grid_chunk(store, index);
+  (store->num_inflations)++;
+  store->inflate_time_us += dt_get_time_us() - start_time;
+
+  return(chunk);
+}
+
+/******************************************************************************/
+/* Function: dt_add_inflated_grid_chunk                                       */
+/*                                                                            */
+/* Purpose: Add a chunk to the end of the inflated list of a chunk store.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     store - The chunk store.                                */
+/*             IN     index - The index of the chunk.                         */
+/*                                                                            */
+/* Operation: Double the size of the list if it is full.                      */
+/******************************************************************************/
+void dt_add_inflated_grid_chunk(DT_CHUNK_STORE *store, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *inflated_chunks;
+
+  if (store->num_inflated_chunks == store->inflated_chunks_size)
+  {
+    inflated_chunks = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                           store->inflated_chunks_size * 2);
+    memcpy(inflated_chunks,
+           store->inflated_chunks,
+           sizeof(Uint32) * store->num_inflated_chunks);
+    dt_free(store->inflated_chunks);
+    store->inflated_chunks = inflated_chunks;
+    store->inflated_chunks_size *= 2;
+  }
+
+  store->inflated_chunks[store->num_inflated_chunks] = (Uint32) index;
+  (store->num_inflated_chunks)++;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_compact_grid_chunks                                           */
+/*                                                                            */
+/* Purpose: Drop the coldest inflated chunks of a grid until no more than the */
+/*          store's max_inflated_chunks remain.                               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid. Nothing is done unless it has a chunk  */
+/*                           store.                                           */
+/*                                                                            */
+/* Operation: The chunks inflated longest ago are dropped first. Chunks which */
+/*            have been written to are compressed again before they are       */
+/*            dropped, and chunks holding units are never dropped. Pointers   */
+/*            into any chunk are not valid after this is called, so it must   */
+/*            only be called where none are held, such as between events, and */
+/*            never while dt_solve_path_requests is running a batch.          */
+/******************************************************************************/
+void dt_compact_grid_chunks(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STORE *store = grid->chunk_store;
+  DT_COMPRESSED_CHUNK *compressed;
+  size_t num_to_drop;
+  size_t num_kept = 0;
+  size_t index;
+  size_t ii;
+
+  if ((NULL == store) ||
+      (store->num_inflated_chunks <= store->max_inflated_chunks))
+  {
+    goto EXIT_LABEL;
+  }
+
+  num_to_drop = store->num_inflated_chunks - store->max_inflated_chunks;
+  for (ii = 0; ii < store->num_inflated_chunks; ii++)
+  {
+    index = store->inflated_chunks[ii];
+    if ((0 == num_to_drop) || dt_grid_chunk_has_units(grid->chunks[index]))
+    {
+      store->inflated_chunks[num_kept] = (Uint32) index;
+      num_kept++;
+      continue;
+    }
+    compressed = &(store->chunks[index]);
+    if ((compressed->dirty) || (NULL == compressed->data))
+    {
+      dt_store_grid_chunk(grid, index);
+    }
+    dt_free(grid->chunks[index]);
+    grid->chunks[index] = NULL;
+    (grid->num_allocated_chunks)--;
+    num_to_drop--;
+  }
+  store->num_inflated_chunks = num_kept;
+
+EXIT_LABEL:
+
+  return;
+}
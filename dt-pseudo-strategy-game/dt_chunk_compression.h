@@ -0,0 +1,97 @@
+/******************************************************************************/
+/* File: dt_chunk_compression.h                                               */
+/*                                                                            */
+/* Purpose: Definitions for compressing the chunks of chunked grids, both in  */
+/*          chunked binary maps and in memory.                                */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Group: DT_CHUNK_ENCODINGS                                                  */
+/*                                                                            */
+/* The ways a chunk record can be stored.                                     */
+/*                                                                            */
+/* DT_CHUNK_ENCODING_RAW - The DT_MAP_FILE_CHUNK record as it is.             */
+/* DT_CHUNK_ENCODING_RLE - The record run-length encoded. Each run starts     */
+/*                         with a control byte. A control byte c below 128 is */
+/*                         followed by c + 1 bytes to copy, and one of 129 or */
+/*                         more by a single byte to repeat 257 - c times.     */
+/* DT_CHUNK_ENCODING_ZLIB - The record compressed with zlib.                  */
+/*    Before either compression the elevation layer is split into its low     */
+/*    bytes followed by its high bytes, as neighbouring elevations usually    */
+/*    share their high byte.                                                  */
+/******************************************************************************/
+#define DT_CHUNK_ENCODING_RAW 0
+#define DT_CHUNK_ENCODING_RLE 1
+#define DT_CHUNK_ENCODING_ZLIB 2
+
+/******************************************************************************/
+/* Parameters of the encodings.                                               */
+/*                                                                            */
+/* DT_CHUNK_RLE_MAX_RUN - The longest run a single control byte can cover.    */
+/* DT_CHUNK_RLE_MIN_REPEAT - The shortest run of a repeated byte that is      */
+/*                           stored as a repeat rather than copied.           */
+/* DT_CHUNK_ZLIB_LEVEL - The zlib compression level, from 1 (fastest) to 9    */
+/*                       (smallest).                                          */
+/* DT_CHUNK_MAX_ENCODED_SIZE - The largest an encoded record can be. This is  */
+/*                             the worst case of run-length encoding, which   */
+/*                             is larger than that of zlib.                   */
+/******************************************************************************/
+#define DT_CHUNK_RLE_MAX_RUN 128
+#define DT_CHUNK_RLE_MIN_REPEAT 3
+#define DT_CHUNK_ZLIB_LEVEL 6
+#define DT_CHUNK_MAX_ENCODED_SIZE                                             \
+  (sizeof(DT_MAP_FILE_CHUNK) +                                                \
+        ((sizeof(DT_MAP_FILE_CHUNK) + DT_CHUNK_RLE_MAX_RUN - 1) /             \
+                                                        DT_CHUNK_RLE_MAX_RUN))
+
+/******************************************************************************/
+/* DT_COMPRESSED_CHUNK:                                                       */
+/*                                                                            */
+/* The compressed copy of one chunk of a grid held in a chunk store.          */
+/*                                                                            */
+/* data - The encoded record of the chunk, or NULL if it has none yet.        */
+/* size - The size of the encoded record in bytes.                            */
+/* encoding - How the record is encoded. One of DT_CHUNK_ENCODINGS.           */
+/* dirty - Set when the chunk has been written to since it was last encoded,  */
+/*         so it must be encoded again before it is dropped.                  */
+/******************************************************************************/
+typedef struct dt_compressed_chunk
+{
+  unsigned char *data;
+  Uint32 size;
+  Uint32 encoding;
+  bool dirty;
+} DT_COMPRESSED_CHUNK;
+
+/******************************************************************************/
+/* DT_CHUNK_STORE:                                                            */
+/*                                                                            */
+/* Holds the chunks of a chunked grid compressed in memory. A chunk which has */
+/* a compressed copy but is not in use has a NULL entry in the chunk table of */
+/* the grid and is inflated the first time it is accessed. Inflated chunks    */
+/* stay in the table until dt_compact_grid_chunks drops the coldest of them.  */
+/*                                                                            */
+/* chunks - The compressed copy of each chunk, one per chunk table entry.     */
+/* encoding - The encoding used when a chunk is compressed again.             */
+/* inflated_chunks - The indices of the inflated chunks which have a          */
+/*                   compressed copy or may need one, oldest first.           */
+/* num_inflated_chunks - The number of entries in inflated_chunks.            */
+/* inflated_chunks_size - The number of entries inflated_chunks has room for. */
+/* max_inflated_chunks - The number of chunks dt_compact_grid_chunks leaves   */
+/*                       inflated.                                            */
+/* compressed_bytes - The total size of the compressed copies.                */
+/* num_inflations - The number of times a chunk has been inflated.            */
+/* inflate_time_us - The total time spent inflating chunks.                   */
+/******************************************************************************/
+typedef struct dt_chunk_store
+{
+  DT_COMPRESSED_CHUNK *chunks;
+  int encoding;
+  Uint32 *inflated_chunks;
+  size_t num_inflated_chunks;
+  size_t inflated_chunks_size;
+  size_t max_inflated_chunks;
+  Uint64 compressed_bytes;
+  long num_inflations;
+  Uint64 inflate_time_us;
+} DT_CHUNK_STORE;
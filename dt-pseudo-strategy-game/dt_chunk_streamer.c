@@ -0,0 +1,800 @@
+/******************************************************************************/
+/* File: dt_chunk_streamer.c                                                  */
+/*                                                                            */
+/* Purpose: Streams the chunks of a chunked binary map into a grid on a       */
+/*          background thread, loading those around the screen and ahead of   */
+/*          the way it is scrolling and evicting those far from it.           */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_open_streamed_map_file                                        */
+/*                                                                            */
+/* Purpose: Open a chunked binary map to be streamed into a grid.             */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was opened.                         */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be opened.            */
+/*          DT_MAP_FILE_BAD_HEADER if the header is not valid or the start of */
+/*                                 the file could not be read.                */
+/*          DT_MAP_FILE_NOT_CHUNKED if the map is not a chunked map.          */
+/*          DT_MAP_FILE_BAD_CHUNK if a chunk table entry is not valid.        */
+/*          DT_MAP_FILE_MAP_FAILED if the streaming thread could not be       */
+/*                                 started.                                   */
+/*                                                                            */
+/* Parameters: IN     filename - The chunked binary map to open.              */
+/*             IN     max_loaded_chunks - The number of chunks to keep        */
+/*                                        loaded. At least                    */
+/*                                        DT_STREAM_MIN_LOADED_CHUNKS are.    */
+/*             OUT    grid - The new grid.                                    */
+/*                                                                            */
+/* Operation: Read the header, the tile type records and the chunk table and  */
+/*            check them. Create a chunked grid in which every chunk is the   */
+/*            default chunk and start the thread which reads chunks into it.  */
+/*            Nothing else is read until dt_update_chunk_streamer asks for    */
+/*            it, so opening takes the same time however large the map is.    */
+/******************************************************************************/
+int dt_open_streamed_map_file(char *filename,
+                              int max_loaded_chunks,
+                              DT_GRID **grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_FILE_HEADER header;
+  DT_MAP_FILE_TILE_TYPE *records = NULL;
+  DT_CHUNK_STREAMER *streamer = NULL;
+  DT_GRID *temp_grid = NULL;
+  HANDLE file;
+  LARGE_INTEGER file_size;
+  size_t num_chunks;
+  size_t ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Open the file and read and check the header.                             */
+  /****************************************************************************/
+  file = CreateFileA(filename,
+                     GENERIC_READ,
+                     FILE_SHARE_READ,
+                     NULL,
+                     OPEN_EXISTING,
+                     FILE_ATTRIBUTE_NORMAL,
+                     NULL);
+  if (INVALID_HANDLE_VALUE == file)
+  {
+    ret_code = DT_MAP_FILE_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  memset(&header, 0, sizeof(header));
+  if ((!GetFileSizeEx(file, &file_size)) ||
+      (!dt_read_map_file_range(file,
+                               0,
+                               &header,
+                               (size_t) MIN((Uint64) file_size.QuadPart,
+                                            sizeof(header)))))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+  ret_code = dt_check_map_file_header((unsigned char *) &header,
+                                      (Uint64) file_size.QuadPart);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+  if (DT_GRID_STORAGE_CHUNKED != header.storage)
+  {
+    ret_code = DT_MAP_FILE_NOT_CHUNKED;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Create the grid and its tile types.                                      */
+  /****************************************************************************/
+  records = (DT_MAP_FILE_TILE_TYPE *) dt_malloc(sizeof(DT_MAP_FILE_TILE_TYPE) *
+                                                header.num_tile_types);
+  if (!dt_read_map_file_range(file,
+                              header.header_size,
+                              records,
+                              sizeof(DT_MAP_FILE_TILE_TYPE) *
+                                                     header.num_tile_types))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+  temp_grid = dt_create_grid_with_storage((int) header.square_width,
+                                          (int) header.square_height,
+                                          (int) header.num_tiles_x,
+                                          (int) header.num_tiles_y,
+                                          DT_GRID_STORAGE_CHUNKED);
+  dt_add_map_file_tile_types(temp_grid, records, header.num_tile_types);
+
+  /****************************************************************************/
+  /* Read and check the chunk table.                                          */
+  /****************************************************************************/
+  num_chunks = (size_t) temp_grid->num_chunks_x *
+                                             (size_t) temp_grid->num_chunks_y;
+  streamer = (DT_CHUNK_STREAMER *) dt_malloc(sizeof(DT_CHUNK_STREAMER));
+  streamer->chunk_table = (DT_MAP_FILE_CHUNK_ENTRY *)
+                     dt_malloc(sizeof(DT_MAP_FILE_CHUNK_ENTRY) * num_chunks);
+  streamer->chunk_state = (unsigned char *) dt_malloc(num_chunks);
+  streamer->loaded_chunks_size = DT_STREAM_DEFAULT_MAX_CHUNKS;
+  streamer->loaded_chunks = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                              streamer->loaded_chunks_size);
+  if (!dt_read_map_file_range(file,
+                              header.chunk_table_offset,
+                              streamer->chunk_table,
+                              sizeof(DT_MAP_FILE_CHUNK_ENTRY) * num_chunks))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (!dt_check_map_file_chunk_entry(&(streamer->chunk_table[ii]),
+                                       header.file_size))
+    {
+      ret_code = DT_MAP_FILE_BAD_CHUNK;
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Set up the rest of the streamer and start the streaming thread.          */
+  /****************************************************************************/
+  memset(streamer->chunk_state, DT_STREAMED_CHUNK_NOT_LOADED, num_chunks);
+  streamer->file = file;
+  streamer->num_loaded_chunks = 0;
+  streamer->max_loaded_chunks = (size_t) MAX(max_loaded_chunks,
+                                             DT_STREAM_MIN_LOADED_CHUNKS);
+  streamer->last_start_x = 0;
+  streamer->last_start_y = 0;
+  streamer->direction_x = 0;
+  streamer->direction_y = 0;
+  streamer->num_requests = 0;
+  streamer->next_request = 0;
+  streamer->arrived = NULL;
+  streamer->shutting_down = false;
+  streamer->lock = SDL_CreateMutex();
+  streamer->work_ready = SDL_CreateCond();
+  streamer->thread = SDL_CreateThread(dt_chunk_streamer_thread, streamer);
+  if (NULL == streamer->thread)
+  {
+    SDL_DestroyCond(streamer->work_ready);
+    SDL_DestroyMutex(streamer->lock);
+    ret_code = DT_MAP_FILE_MAP_FAILED;
+    goto EXIT_LABEL;
+  }
+  temp_grid->streamer = streamer;
+  streamer = NULL;
+  file = INVALID_HANDLE_VALUE;
+
+  (*grid) = temp_grid;
+  temp_grid = NULL;
+
+EXIT_LABEL:
+
+  if (NULL != streamer)
+  {
+    dt_free(streamer->loaded_chunks);
+    dt_free(streamer->chunk_state);
+    dt_free(streamer->chunk_table);
+    dt_free(streamer);
+  }
+  if (NULL != temp_grid)
+  {
+    dt_destroy_grid(temp_grid);
+  }
+  if (NULL != records)
+  {
+    dt_free(records);
+  }
+  if (INVALID_HANDLE_VALUE != file)
+  {
+    CloseHandle(file);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_file_range                                           */
+/*                                                                            */
+/* Purpose: Read part of an open map file.                                    */
+/*                                                                            */
+/* Returns: true if every byte asked for was read.                            */
+/*                                                                            */
+/* Parameters: IN     file - The open file.                                   */
+/*             IN     offset - The offset to read from.                       */
+/*             OUT    buffer - The buffer to read into.                       */
+/*             IN     length - The number of bytes to read.                   */
+/*                                                                            */
+/* Operation: Move to the offset and read the bytes in one go.                */
+/******************************************************************************/
+bool dt_read_map_file_range(HANDLE file,
+                            Uint64 offset,
+                            void *buffer,
+                            size_t length)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  LARGE_INTEGER position;
+  DWORD bytes_read = 0;
+
+  position.QuadPart = (LONGLONG) offset;
+
+  return((length <= 0xFFFFFFFFu) &&
+         SetFilePointerEx(file, position, NULL, FILE_BEGIN) &&
+         ReadFile(file, buffer, (DWORD) length, &bytes_read, NULL) &&
+         (length == bytes_read));
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_chunk_streamer                                        */
+/*                                                                            */
+/* Purpose: Stop streaming chunks into a grid and free the streamer.          */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     streamer - The streamer to destroy.                     */
+/*                                                                            */
+/* Operation: Tell the streaming thread to stop and wait for it to exit. Free */
+/*            any chunks it read which were never put into the grid, then     */
+/*            close the file and free everything else. The chunks in the      */
+/*            grid belong to the grid.                                        */
+/******************************************************************************/
+void dt_destroy_chunk_streamer(DT_CHUNK_STREAMER *streamer)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_STREAMED_CHUNK *arrived;
+
+  SDL_mutexP(streamer->lock);
+  streamer->shutting_down = true;
+  SDL_CondSignal(streamer->work_ready);
+  SDL_mutexV(streamer->lock);
+  SDL_WaitThread(streamer->thread, NULL);
+
+  while (NULL != streamer->arrived)
+  {
+    arrived = streamer->arrived;
+    streamer->arrived = arrived->next;
+    if (NULL != arrived->chunk)
+    {
+      dt_free(arrived->chunk);
+    }
+    dt_free(arrived);
+  }
+
+  CloseHandle(streamer->file);
+  SDL_DestroyCond(streamer->work_ready);
+  SDL_DestroyMutex(streamer->lock);
+  dt_free(streamer->loaded_chunks);
+  dt_free(streamer->chunk_state);
+  dt_free(streamer->chunk_table);
+  dt_free(streamer);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_update_chunk_streamer                                         */
+/*                                                                            */
+/* Purpose: Bring the chunks of a streamed grid up to date with the screen.   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The streamed grid.                               */
+/*             IN     screen - The screen showing the grid.                   */
+/*                                                                            */
+/* Operation: Must only be called by the main thread, whenever the screen     */
+/*            moves or a DT_EVENT_CHUNKS_ARRIVED event is received. Put the   */
+/*            chunks which have been read into the grid. Then work out the    */
+/*            chunks on the screen and the area to keep around them, which    */
+/*            extends DT_STREAM_MARGIN_CHUNKS on every side and a further     */
+/*            DT_STREAM_PREFETCH_CHUNKS in the direction the screen last      */
+/*            moved. Ask for the chunks in that area which are not loaded and */
+/*            evict chunks outside it until the budget is met. Nothing here   */
+/*            waits for the disk.                                             */
+/******************************************************************************/
+void dt_update_chunk_streamer(DT_GRID *grid, DT_SCREEN *screen)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STREAMER *streamer = grid->streamer;
+  int visible[4];
+  int keep[4];
+
+  dt_install_streamed_chunks(grid);
+
+  /****************************************************************************/
+  /* Note which way the screen has moved. If it has not moved then keep the   */
+  /* direction it was last moving in.                                         */
+  /****************************************************************************/
+  if ((screen->start_x != streamer->last_start_x) ||
+      (screen->start_y != streamer->last_start_y))
+  {
+    streamer->direction_x = (screen->start_x > streamer->last_start_x) -
+                                 (screen->start_x < streamer->last_start_x);
+    streamer->direction_y = (screen->start_y > streamer->last_start_y) -
+                                 (screen->start_y < streamer->last_start_y);
+    streamer->last_start_x = screen->start_x;
+    streamer->last_start_y = screen->start_y;
+  }
+
+  /****************************************************************************/
+  /* Work out the chunks on the screen and the chunks to keep, as the first   */
+  /* and last chunk in each direction.                                        */
+  /****************************************************************************/
+  visible[0] = CLAMP(screen->start_x, 0, grid->num_tiles_x - 1) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  visible[1] = CLAMP(screen->start_y, 0, grid->num_tiles_y - 1) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  visible[2] = CLAMP(screen->start_x + screen->x_tiles_per_screen - 1,
+                     0,
+                     grid->num_tiles_x - 1) >> DT_GRID_CHUNK_SHIFT;
+  visible[3] = CLAMP(screen->start_y + screen->y_tiles_per_screen - 1,
+                     0,
+                     grid->num_tiles_y - 1) >> DT_GRID_CHUNK_SHIFT;
+  keep[0] = visible[0] - DT_STREAM_MARGIN_CHUNKS -
+                ((streamer->direction_x < 0) ? DT_STREAM_PREFETCH_CHUNKS : 0);
+  keep[1] = visible[1] - DT_STREAM_MARGIN_CHUNKS -
+                ((streamer->direction_y < 0) ? DT_STREAM_PREFETCH_CHUNKS : 0);
+  keep[2] = visible[2] + DT_STREAM_MARGIN_CHUNKS +
+                ((streamer->direction_x > 0) ? DT_STREAM_PREFETCH_CHUNKS : 0);
+  keep[3] = visible[3] + DT_STREAM_MARGIN_CHUNKS +
+                ((streamer->direction_y > 0) ? DT_STREAM_PREFETCH_CHUNKS : 0);
+  keep[0] = MAX(keep[0], 0);
+  keep[1] = MAX(keep[1], 0);
+  keep[2] = MIN(keep[2], grid->num_chunks_x - 1);
+  keep[3] = MIN(keep[3], grid->num_chunks_y - 1);
+
+  dt_request_streamed_chunks(grid, visible, keep);
+  dt_evict_streamed_chunks(grid, keep);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_install_streamed_chunks                                       */
+/*                                                                            */
+/* Purpose: Put the chunks read by the streaming thread into the grid.        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The streamed grid.                               */
+/*                                                                            */
+/* Operation: Take the whole list of chunks read. A chunk which still shares  */
+/*            the default chunk is simply replaced. One which was allocated   */
+/*            while it was being read, because a unit was placed on it, has   */
+/*            the terrain copied in so that its units are kept. A chunk which */
+/*            could not be read is left as an empty plain but still counts    */
+/*            as loaded, so it is not read again and again. The cost fields   */
+/*            of the grid are updated over each chunk installed.              */
+/******************************************************************************/
+void dt_install_streamed_chunks(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STREAMER *streamer = grid->streamer;
+  DT_STREAMED_CHUNK *arrived;
+  DT_STREAMED_CHUNK *next;
+  DT_GRID_CHUNK *chunk;
+
+  SDL_mutexP(streamer->lock);
+  arrived = streamer->arrived;
+  streamer->arrived = NULL;
+  SDL_mutexV(streamer->lock);
+
+  for (; NULL != arrived; arrived = next)
+  {
+    next = arrived->next;
+    chunk = grid->chunks[arrived->index];
+    if ((NULL != arrived->chunk) && (grid->default_chunk == chunk))
+    {
+      grid->chunks[arrived->index] = arrived->chunk;
+      (grid->num_allocated_chunks)++;
+      dt_update_grid_cost_fields_for_chunk(grid, arrived->index);
+    }
+    else if (NULL != arrived->chunk)
+    {
+      memcpy(chunk->traversable,
+             arrived->chunk->traversable,
+             sizeof(chunk->traversable));
+      memcpy(chunk->elevation,
+             arrived->chunk->elevation,
+             sizeof(chunk->elevation));
+      memcpy(chunk->tile_type,
+             arrived->chunk->tile_type,
+             sizeof(chunk->tile_type));
+      memcpy(chunk->terrain_type,
+             arrived->chunk->terrain_type,
+             sizeof(chunk->terrain_type));
+      memcpy(chunk->water_depth,
+             arrived->chunk->water_depth,
+             sizeof(chunk->water_depth));
+      memcpy(chunk->movement_modifier,
+             arrived->chunk->movement_modifier,
+             sizeof(chunk->movement_modifier));
+      dt_free(arrived->chunk);
+      dt_update_grid_cost_fields_for_chunk(grid, arrived->index);
+    }
+    dt_add_loaded_streamed_chunk(streamer, arrived->index);
+    dt_free(arrived);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_add_loaded_streamed_chunk                                     */
+/*                                                                            */
+/* Purpose: Mark a chunk of a streamed grid as loaded.                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     streamer - The streamer of the grid.                    */
+/*             IN     index - The index of the chunk.                         */
+/*                                                                            */
+/* Operation: Set the state of the chunk and add it to the loaded list,       */
+/*            doubling the size of the list if it is full.                    */
+/******************************************************************************/
+void dt_add_loaded_streamed_chunk(DT_CHUNK_STREAMER *streamer, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *loaded_chunks;
+
+  if (streamer->num_loaded_chunks == streamer->loaded_chunks_size)
+  {
+    loaded_chunks = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                         streamer->loaded_chunks_size * 2);
+    memcpy(loaded_chunks,
+           streamer->loaded_chunks,
+           sizeof(Uint32) * streamer->num_loaded_chunks);
+    dt_free(streamer->loaded_chunks);
+    streamer->loaded_chunks = loaded_chunks;
+    streamer->loaded_chunks_size *= 2;
+  }
+
+  streamer->chunk_state[index] = DT_STREAMED_CHUNK_LOADED;
+  streamer->loaded_chunks[streamer->num_loaded_chunks] = (Uint32) index;
+  (streamer->num_loaded_chunks)++;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_request_streamed_chunks                                       */
+/*                                                                            */
+/* Purpose: Ask the streaming thread for the chunks around the screen.        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The streamed grid.                               */
+/*             IN     visible - The first x, first y, last x and last y of    */
+/*                              the chunks on the screen.                     */
+/*             IN     keep - The same for the chunks to keep loaded.          */
+/*                                                                            */
+/* Operation: Replace the chunks asked for before but not yet being read, as  */
+/*            the screen may have moved away from them. Ask for the chunks on */
+/*            the screen first, then ring by ring out to the edge of the area */
+/*            to keep, taking those ahead of the screen before the others in  */
+/*            each ring. Chunks with no record in the file are loaded at once */
+/*            as they need nothing reading.                                   */
+/******************************************************************************/
+void dt_request_streamed_chunks(DT_GRID *grid, int *visible, int *keep)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STREAMER *streamer = grid->streamer;
+  size_t index;
+  int max_ring;
+  int ring;
+  int pass;
+  int chunk_x;
+  int chunk_y;
+  int ring_x;
+  int ring_y;
+  int ii;
+  bool ahead;
+
+  max_ring = DT_STREAM_MARGIN_CHUNKS + DT_STREAM_PREFETCH_CHUNKS;
+
+  SDL_mutexP(streamer->lock);
+
+  /****************************************************************************/
+  /* Forget the chunks which were asked for but have not been started.        */
+  /****************************************************************************/
+  for (ii = streamer->next_request; ii < streamer->num_requests; ii++)
+  {
+    streamer->chunk_state[streamer->requests[ii]] =
+                                                 DT_STREAMED_CHUNK_NOT_LOADED;
+  }
+  streamer->num_requests = 0;
+  streamer->next_request = 0;
+
+  /****************************************************************************/
+  /* Ask for the chunks in order of how far they are from the screen.         */
+  /****************************************************************************/
+  for (ring = 0; ring <= max_ring; ring++)
+  {
+    for (pass = 0; pass < 2; pass++)
+    {
+      for (chunk_y = keep[1]; chunk_y <= keep[3]; chunk_y++)
+      {
+        for (chunk_x = keep[0]; chunk_x <= keep[2]; chunk_x++)
+        {
+          ring_x = MAX(visible[0] - chunk_x, chunk_x - visible[2]);
+          ring_y = MAX(visible[1] - chunk_y, chunk_y - visible[3]);
+          ahead = ((streamer->direction_x < 0) && (chunk_x < visible[0])) ||
+                  ((streamer->direction_x > 0) && (chunk_x > visible[2])) ||
+                  ((streamer->direction_y < 0) && (chunk_y < visible[1])) ||
+                  ((streamer->direction_y > 0) && (chunk_y > visible[3]));
+          index = ((size_t) chunk_y * (size_t) grid->num_chunks_x) +
+                                                             (size_t) chunk_x;
+          if ((ring != MAX(MAX(ring_x, ring_y), 0)) ||
+              (ahead != (0 == pass)) ||
+              (DT_STREAMED_CHUNK_NOT_LOADED != streamer->chunk_state[index]))
+          {
+            continue;
+          }
+          if (0 == streamer->chunk_table[index].offset)
+          {
+            dt_add_loaded_streamed_chunk(streamer, index);
+          }
+          else if (streamer->num_requests < DT_STREAM_MAX_REQUESTS)
+          {
+            streamer->chunk_state[index] = DT_STREAMED_CHUNK_QUEUED;
+            streamer->requests[streamer->num_requests] = (Uint32) index;
+            (streamer->num_requests)++;
+          }
+        }
+      }
+    }
+  }
+
+  if (0 != streamer->num_requests)
+  {
+    SDL_CondSignal(streamer->work_ready);
+  }
+  SDL_mutexV(streamer->lock);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_evict_streamed_chunks                                         */
+/*                                                                            */
+/* Purpose: Unload chunks of a streamed grid until it is within its budget.   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The streamed grid.                               */
+/*             IN     keep - The first x, first y, last x and last y of the   */
+/*                           chunks to keep loaded.                           */
+/*                                                                            */
+/* Operation: While too many chunks are loaded, evict the one furthest from   */
+/*            the area to keep. Chunks inside that area and chunks holding    */
+/*            units are never evicted, so the budget may be exceeded. The     */
+/*            file is the master copy of the terrain, so the evicted chunk is */
+/*            freed and shares the default chunk until it is read again, and  */
+/*            the cost fields of the grid are updated to match.               */
+/******************************************************************************/
+void dt_evict_streamed_chunks(DT_GRID *grid, int *keep)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STREAMER *streamer = grid->streamer;
+  DT_GRID_CHUNK *chunk;
+  size_t furthest;
+  size_t index;
+  size_t ii;
+  int furthest_distance;
+  int distance;
+  int chunk_x;
+  int chunk_y;
+
+  while (streamer->num_loaded_chunks > streamer->max_loaded_chunks)
+  {
+    /**************************************************************************/
+    /* Find the loaded chunk furthest outside the area to keep.               */
+    /**************************************************************************/
+    furthest = streamer->num_loaded_chunks;
+    furthest_distance = 0;
+    for (ii = 0; ii < streamer->num_loaded_chunks; ii++)
+    {
+      index = streamer->loaded_chunks[ii];
+      chunk_x = (int) (index % (size_t) grid->num_chunks_x);
+      chunk_y = (int) (index / (size_t) grid->num_chunks_x);
+      distance = MAX(MAX(keep[0] - chunk_x, chunk_x - keep[2]),
+                     MAX(keep[1] - chunk_y, chunk_y - keep[3]));
+      if ((distance > furthest_distance) &&
+          (!dt_grid_chunk_has_units(grid->chunks[index])))
+      {
+        furthest = ii;
+        furthest_distance = distance;
+      }
+    }
+    if (furthest == streamer->num_loaded_chunks)
+    {
+      break;
+    }
+
+    /**************************************************************************/
+    /* Evict it, moving the last entry of the loaded list into its place.     */
+    /**************************************************************************/
+    index = streamer->loaded_chunks[furthest];
+    chunk = grid->chunks[index];
+    if (grid->default_chunk != chunk)
+    {
+      dt_free(chunk);
+      grid->chunks[index] = grid->default_chunk;
+      (grid->num_allocated_chunks)--;
+      dt_update_grid_cost_fields_for_chunk(grid, index);
+    }
+    streamer->chunk_state[index] = DT_STREAMED_CHUNK_NOT_LOADED;
+    (streamer->num_loaded_chunks)--;
+    streamer->loaded_chunks[furthest] =
+                       streamer->loaded_chunks[streamer->num_loaded_chunks];
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_grid_chunk_has_units                                          */
+/*                                                                            */
+/* Purpose: Check whether any unit is on a chunk.                             */
+/*                                                                            */
+/* Returns: true if a unit is on one of the points of the chunk.              */
+/*                                                                            */
+/* Parameters: IN     chunk - The chunk to check.                             */
+/*                                                                            */
+/* Operation: Look at the unit of each element in turn.                       */
+/******************************************************************************/
+bool dt_grid_chunk_has_units(DT_GRID_CHUNK *chunk)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < DT_GRID_CHUNK_POINTS; ii++)
+  {
+    if (NULL != chunk->elements[ii].unit)
+    {
+      return(true);
+    }
+  }
+
+  return(false);
+}
+
+/******************************************************************************/
+/* Function: dt_is_grid_chunk_loaded                                          */
+/*                                                                            */
+/* Purpose: Check whether the terrain at a point of a grid is available.      */
+/*                                                                            */
+/* Returns: false if the grid is streamed and the chunk holding the point has */
+/*          not been loaded, otherwise true.                                  */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Only streamed grids have chunks which are not loaded. Points    */
+/*            off the grid are treated as loaded.                             */
+/******************************************************************************/
+bool dt_is_grid_chunk_loaded(DT_GRID *grid, int grid_x, int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t index;
+
+  if ((NULL == grid->streamer) ||
+      (grid_x < 0) || (grid_x >= grid->num_tiles_x) ||
+      (grid_y < 0) || (grid_y >= grid->num_tiles_y))
+  {
+    return(true);
+  }
+  index = ((size_t) (grid_y >> DT_GRID_CHUNK_SHIFT) *
+                                              (size_t) grid->num_chunks_x) +
+                                       (size_t) (grid_x >> DT_GRID_CHUNK_SHIFT);
+
+  return(DT_STREAMED_CHUNK_LOADED == grid->streamer->chunk_state[index]);
+}
+
+/******************************************************************************/
+/* Function: dt_chunk_streamer_thread                                         */
+/*                                                                            */
+/* Purpose: The main function of the streaming thread.                        */
+/*                                                                            */
+/* Returns: 0 when the streamer shuts down.                                   */
+/*                                                                            */
+/* Parameters: IN     data - The DT_CHUNK_STREAMER the thread belongs to.     */
+/*                                                                            */
+/* Operation: Sleep until a chunk is asked for. Drop the lock while reading   */
+/*            and decoding its record and building the chunk, then add it to  */
+/*            the arrived list. When the list was empty push a                */
+/*            DT_EVENT_CHUNKS_ARRIVED event so the main thread wakes up and   */
+/*            puts the chunks into the grid. Exit once the streamer is        */
+/*            shutting down.                                                  */
+/******************************************************************************/
+int dt_chunk_streamer_thread(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_CHUNK_STREAMER *streamer = (DT_CHUNK_STREAMER *) data;
+  DT_MAP_FILE_CHUNK_ENTRY *entry;
+  DT_MAP_FILE_CHUNK *record;
+  DT_STREAMED_CHUNK *arrived;
+  unsigned char *buffer;
+  SDL_Event event;
+  size_t index;
+
+  record = (DT_MAP_FILE_CHUNK *) dt_malloc(sizeof(DT_MAP_FILE_CHUNK));
+  buffer = (unsigned char *) dt_malloc(DT_CHUNK_MAX_ENCODED_SIZE);
+
+  SDL_mutexP(streamer->lock);
+  while (!streamer->shutting_down)
+  {
+    if (streamer->next_request >= streamer->num_requests)
+    {
+      SDL_CondWait(streamer->work_ready, streamer->lock);
+      continue;
+    }
+    index = streamer->requests[streamer->next_request];
+    (streamer->next_request)++;
+    SDL_mutexV(streamer->lock);
+
+    /**************************************************************************/
+    /* Read the chunk.                                                        */
+    /**************************************************************************/
+    arrived = (DT_STREAMED_CHUNK *) dt_malloc(sizeof(DT_STREAMED_CHUNK));
+    arrived->index = index;
+    arrived->chunk = NULL;
+    entry = &(streamer->chunk_table[index]);
+    if (dt_read_map_file_range(streamer->file,
+                               entry->offset,
+                               buffer,
+                               entry->size) &&
+        dt_decode_map_file_chunk(buffer,
+                                 entry->size,
+                                 (int) entry->encoding,
+                                 record))
+    {
+      arrived->chunk = (DT_GRID_CHUNK *) dt_malloc(sizeof(DT_GRID_CHUNK));
+      dt_copy_map_file_chunk(record, arrived->chunk);
+    }
+
+    /**************************************************************************/
+    /* Hand it to the main thread.                                            */
+    /**************************************************************************/
+    SDL_mutexP(streamer->lock);
+    arrived->next = streamer->arrived;
+    streamer->arrived = arrived;
+    if (NULL == arrived->next)
+    {
+      memset(&event, 0, sizeof(event));
+      event.type = SDL_USEREVENT;
+      event.user.code = DT_EVENT_CHUNKS_ARRIVED;
+      SDL_PushEvent(&event);
+    }
+  }
+  SDL_mutexV(streamer->lock);
+
+  dt_free(buffer);
+  dt_free(record);
+
+  return(0);
+}
@@ -0,0 +1,117 @@
+/******************************************************************************/
+/* File: dt_chunk_streamer.h                                                  */
+/*                                                                            */
+/* Purpose: Definitions for streaming the chunks of a chunked binary map into */
+/*          a grid on a background thread as the screen scrolls around it.    */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Limits on how much of a streamed map is held and asked for.                */
+/*                                                                            */
+/* DT_STREAM_DEFAULT_MAX_CHUNKS - The number of chunks a streamed map keeps   */
+/*                                loaded unless told otherwise.               */
+/* DT_STREAM_MIN_LOADED_CHUNKS - The fewest chunks a streamed map may keep.   */
+/* DT_STREAM_MARGIN_CHUNKS - The number of chunks loaded and kept on every    */
+/*                           side of those on the screen.                     */
+/* DT_STREAM_PREFETCH_CHUNKS - The number of extra chunks loaded and kept     */
+/*                             ahead of the screen in the direction it last   */
+/*                             moved.                                         */
+/* DT_STREAM_MAX_REQUESTS - The most chunks which can be waiting to be read.  */
+/******************************************************************************/
+#define DT_STREAM_DEFAULT_MAX_CHUNKS 256
+#define DT_STREAM_MIN_LOADED_CHUNKS 16
+#define DT_STREAM_MARGIN_CHUNKS 1
+#define DT_STREAM_PREFETCH_CHUNKS 2
+#define DT_STREAM_MAX_REQUESTS 256
+
+/******************************************************************************/
+/* Group: DT_STREAMED_CHUNK_STATES                                            */
+/*                                                                            */
+/* The state of each chunk of a streamed map.                                 */
+/*                                                                            */
+/* DT_STREAMED_CHUNK_NOT_LOADED - The chunk has not been read, or has been    */
+/*                                evicted. It shares the default chunk.       */
+/* DT_STREAMED_CHUNK_QUEUED - The chunk has been asked for but has not yet    */
+/*                            been put into the grid.                         */
+/* DT_STREAMED_CHUNK_LOADED - The chunk holds its terrain from the file.      */
+/******************************************************************************/
+#define DT_STREAMED_CHUNK_NOT_LOADED 0
+#define DT_STREAMED_CHUNK_QUEUED 1
+#define DT_STREAMED_CHUNK_LOADED 2
+
+/******************************************************************************/
+/* The code of the SDL_USEREVENT pushed when streamed chunks have been read   */
+/* and are waiting for dt_update_chunk_streamer to put them into the grid.    */
+/******************************************************************************/
+#define DT_EVENT_CHUNKS_ARRIVED 1
+
+/******************************************************************************/
+/* DT_STREAMED_CHUNK:                                                         */
+/*                                                                            */
+/* A chunk read by the streaming thread and not yet put into the grid.        */
+/*                                                                            */
+/* index - The index of the chunk in the chunk table of the grid.             */
+/* chunk - The chunk read, or NULL if it could not be read.                   */
+/* next - The next chunk read.                                                */
+/******************************************************************************/
+typedef struct dt_streamed_chunk
+{
+  size_t index;
+  struct dt_grid_chunk *chunk;
+  struct dt_streamed_chunk *next;
+} DT_STREAMED_CHUNK;
+
+/******************************************************************************/
+/* DT_CHUNK_STREAMER:                                                         */
+/*                                                                            */
+/* Streams the chunks of a chunked binary map into a chunked grid. Only the   */
+/* streaming thread reads the file, so the main thread never waits for the    */
+/* disk. The main thread asks for the chunks around the screen and puts those */
+/* which have been read into the grid, always in dt_update_chunk_streamer.    */
+/*                                                                            */
+/* file - The open map file. Only used by the streaming thread once the map   */
+/*        has been opened.                                                    */
+/* chunk_table - The chunk table of the map, one entry per chunk.             */
+/* chunk_state - One DT_STREAMED_CHUNK_STATES value per chunk. Only used by   */
+/*               the main thread.                                             */
+/* loaded_chunks - The indices of every chunk which is loaded.                */
+/* num_loaded_chunks - The number of entries in loaded_chunks.                */
+/* loaded_chunks_size - The number of entries loaded_chunks has room for.     */
+/* max_loaded_chunks - The number of chunks to keep loaded. More are kept if  */
+/*                     they are all near the screen or hold units.            */
+/* last_start_x - The start_x of the screen at the last update.               */
+/* last_start_y - The start_y of the screen at the last update.               */
+/* direction_x - The x direction the screen last moved in, -1, 0 or 1.        */
+/* direction_y - The y direction the screen last moved in, -1, 0 or 1.        */
+/* thread - The streaming thread.                                             */
+/* lock - Protects the rest of the fields.                                    */
+/* work_ready - Signalled when chunks are asked for or the streamer is        */
+/*              shutting down.                                                */
+/* requests - The indices of the chunks asked for, nearest the screen first.  */
+/* num_requests - The number of entries in requests.                          */
+/* next_request - The index in requests of the next chunk to read.            */
+/* arrived - The chunks read but not yet put into the grid.                   */
+/* shutting_down - Set when the streamer is being destroyed.                  */
+/******************************************************************************/
+typedef struct dt_chunk_streamer
+{
+  HANDLE file;
+  DT_MAP_FILE_CHUNK_ENTRY *chunk_table;
+  unsigned char *chunk_state;
+  Uint32 *loaded_chunks;
+  size_t num_loaded_chunks;
+  size_t loaded_chunks_size;
+  size_t max_loaded_chunks;
+  int last_start_x;
+  int last_start_y;
+  int direction_x;
+  int direction_y;
+  SDL_Thread *thread;
+  SDL_mutex *lock;
+  SDL_cond *work_ready;
+  Uint32 requests[DT_STREAM_MAX_REQUESTS];
+  int num_requests;
+  int next_request;
+  DT_STREAMED_CHUNK *arrived;
+  bool shutting_down;
+} DT_CHUNK_STREAMER;
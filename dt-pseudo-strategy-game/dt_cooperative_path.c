@@ -0,0 +1,1279 @@
+/******************************************************************************/
+/* File: dt_cooperative_path.c                                                */
+/*                                                                            */
+/* Purpose: Cooperative path planning. Units which search for paths on their  */
+/*          own all take the best route and meet on it, and then each must    */
+/*          find its way round the others. Here a group is planned together   */
+/*          through space and time, each unit keeping clear of the points the */
+/*          units planned before it have reserved.                            */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_reservation_table                                      */
+/*                                                                            */
+/* Purpose: Create an empty reservation table.                                */
+/*                                                                            */
+/* Returns: A pointer to the new table.                                       */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Allocate DT_RESERVATION_INITIAL_SIZE empty entries.             */
+/******************************************************************************/
+DT_RESERVATION_TABLE *dt_create_reservation_table()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_RESERVATION_TABLE *table;
+
+  table = (DT_RESERVATION_TABLE *) dt_malloc(sizeof(DT_RESERVATION_TABLE));
+  table->size = DT_RESERVATION_INITIAL_SIZE;
+  table->entries = (DT_RESERVATION *) dt_calloc(table->size,
+                                                sizeof(DT_RESERVATION));
+  table->num_entries = 0;
+
+  return(table);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_reservation_table                                     */
+/*                                                                            */
+/* Purpose: Free a reservation table.                                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     table - The table to free.                              */
+/*                                                                            */
+/* Operation: Free the entries and then the table.                            */
+/******************************************************************************/
+void dt_destroy_reservation_table(DT_RESERVATION_TABLE *table)
+{
+  dt_free(table->entries);
+  dt_free(table);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_clear_reservation_table                                       */
+/*                                                                            */
+/* Purpose: Drop every reservation from a table.                              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT table - The table.                                      */
+/*                                                                            */
+/* Operation: Empty every entry. The table keeps its size, as the next group  */
+/*            planned is likely to reserve as many points as the last.        */
+/******************************************************************************/
+void dt_clear_reservation_table(DT_RESERVATION_TABLE *table)
+{
+  memset(table->entries, 0, sizeof(DT_RESERVATION) * table->size);
+  table->num_entries = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_reserve_point                                                 */
+/*                                                                            */
+/* Purpose: Reserve a point at a tick for a unit.                             */
+/*                                                                            */
+/* Returns: true if the point is now reserved for the unit, false if another  */
+/*          unit already has it.                                              */
+/*                                                                            */
+/* Parameters: IN/OUT table - The reservation table.                          */
+/*             IN     node - The point.                                       */
+/*             IN     tick - The tick.                                        */
+/*             IN     unit - The unit.                                        */
+/*                                                                            */
+/* Operation: Double the table first if it is half full, so there is always   */
+/*            an empty entry near where a lookup starts. Then step through    */
+/*            the entries from where the point and tick hash to until the     */
+/*            point and tick or an empty entry is found.                      */
+/******************************************************************************/
+bool dt_reserve_point(DT_RESERVATION_TABLE *table,
+                      Uint32 node,
+                      Uint32 tick,
+                      DT_UNIT *unit)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_RESERVATION *entry;
+  Uint32 index;
+
+  if ((table->num_entries + 1) * 2 > table->size)
+  {
+    dt_grow_reservation_table(table);
+  }
+
+  for (index = dt_hash_reservation(table, node, tick);
+       ;
+       index = (index + 1) & (table->size - 1))
+  {
+    entry = &(table->entries[index]);
+    if (NULL == entry->unit)
+    {
+      entry->node = node;
+      entry->tick = tick;
+      entry->unit = unit;
+      (table->num_entries)++;
+      break;
+    }
+    if ((entry->node == node) && (entry->tick == tick))
+    {
+      break;
+    }
+  }
+
+  return(entry->unit == unit);
+}
+
+/******************************************************************************/
+/* Function: dt_find_reservation                                              */
+/*                                                                            */
+/* Purpose: Find which unit has reserved a point at a tick.                   */
+/*                                                                            */
+/* Returns: The unit, or NULL if the point is free at the tick.               */
+/*                                                                            */
+/* Parameters: IN     table - The reservation table.                          */
+/*             IN     node - The point.                                       */
+/*             IN     tick - The tick.                                        */
+/*                                                                            */
+/* Operation: Step through the entries from where the point and tick hash to  */
+/*            until they are found or an empty entry is reached.              */
+/******************************************************************************/
+DT_UNIT *dt_find_reservation(DT_RESERVATION_TABLE *table,
+                             Uint32 node,
+                             Uint32 tick)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_RESERVATION *entry;
+  Uint32 index;
+
+  for (index = dt_hash_reservation(table, node, tick);
+       ;
+       index = (index + 1) & (table->size - 1))
+  {
+    entry = &(table->entries[index]);
+    if ((NULL == entry->unit) ||
+        ((entry->node == node) && (entry->tick == tick)))
+    {
+      break;
+    }
+  }
+
+  return(entry->unit);
+}
+
+/******************************************************************************/
+/* Function: dt_grow_reservation_table                                        */
+/*                                                                            */
+/* Purpose: Double the number of entries of a reservation table.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT table - The table.                                      */
+/*                                                                            */
+/* Operation: Allocate the new entries and reserve each reservation again, as */
+/*            where it belongs depends on the size.                           */
+/******************************************************************************/
+void dt_grow_reservation_table(DT_RESERVATION_TABLE *table)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_RESERVATION *old_entries = table->entries;
+  Uint32 old_size = table->size;
+  Uint32 ii;
+
+  table->size *= 2;
+  table->entries = (DT_RESERVATION *) dt_calloc(table->size,
+                                                sizeof(DT_RESERVATION));
+  table->num_entries = 0;
+  for (ii = 0; ii < old_size; ii++)
+  {
+    if (NULL != old_entries[ii].unit)
+    {
+      dt_reserve_point(table,
+                       old_entries[ii].node,
+                       old_entries[ii].tick,
+                       old_entries[ii].unit);
+    }
+  }
+  dt_free(old_entries);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_init_coop_goal                                                */
+/*                                                                            */
+/* Purpose: Allocate the memory of a goal of a cooperative planner.           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: OUT    goal - The goal.                                        */
+/*                                                                            */
+/* Operation: Allocate DT_COOP_GOAL_INITIAL_SIZE empty costs and room for as  */
+/*            many entries of the heap. The goal is set up for its search     */
+/*            each time a plan first needs it.                                */
+/******************************************************************************/
+void dt_init_coop_goal(DT_COOP_GOAL *goal)
+{
+  goal->size = DT_COOP_GOAL_INITIAL_SIZE;
+  goal->costs = (DT_COOP_COST *) dt_calloc(goal->size, sizeof(DT_COOP_COST));
+  goal->num_entries = 0;
+  goal->heap.size = DT_COOP_GOAL_INITIAL_SIZE;
+  goal->heap.nodes = (Uint32 *) dt_malloc(sizeof(Uint32) * goal->heap.size);
+  goal->heap.keys = (Uint64 *) dt_malloc(sizeof(Uint64) * goal->heap.size);
+  goal->heap.num_entries = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_coop_goal                                                 */
+/*                                                                            */
+/* Purpose: Find the search back from a unit's goal for the group being       */
+/*          planned, starting it if the unit is the first sent there.         */
+/*                                                                            */
+/* Returns: A pointer to the goal, which stays valid until the next goal is   */
+/*          started.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT planner - The planner.                                  */
+/*             IN     request - The unit's request.                           */
+/*             IN     field - The cost field of the unit.                     */
+/*                                                                            */
+/* Operation: Units of the same class and speed sent to the same point share  */
+/*            a goal. A new goal takes the next entry of the planner's goals, */
+/*            doubling them if they are all in use, and clears what the entry */
+/*            held in an earlier plan, as the grid may have changed since.    */
+/*            The search is guided towards the unit's start, and the goal is  */
+/*            opened at no cost.                                              */
+/******************************************************************************/
+DT_COOP_GOAL *dt_get_coop_goal(DT_COOP_PLANNER *planner,
+                               DT_PATH_REQUEST *request,
+                               DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COOP_GOAL *goal;
+  DT_COOP_GOAL *goals;
+  DT_COOP_COST *entry;
+  Uint32 estimate;
+  int ii;
+
+  for (ii = 0; ii < planner->num_goals; ii++)
+  {
+    goal = &(planner->goals[ii]);
+    if ((goal->goal_x == request->goal_x) &&
+        (goal->goal_y == request->goal_y) &&
+        (goal->unit_class == field->unit_class) &&
+        (goal->speed == field->speed))
+    {
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Start a new goal.                                                        */
+  /****************************************************************************/
+  if (planner->num_goals == planner->goals_size)
+  {
+    goals = (DT_COOP_GOAL *) dt_malloc(sizeof(DT_COOP_GOAL) *
+                                       (size_t) planner->goals_size * 2);
+    memcpy(goals,
+           planner->goals,
+           sizeof(DT_COOP_GOAL) * (size_t) planner->goals_size);
+    for (ii = planner->goals_size; ii < planner->goals_size * 2; ii++)
+    {
+      dt_init_coop_goal(&(goals[ii]));
+    }
+    dt_free(planner->goals);
+    planner->goals = goals;
+    planner->goals_size *= 2;
+  }
+  goal = &(planner->goals[planner->num_goals]);
+  (planner->num_goals)++;
+  goal->goal_x = request->goal_x;
+  goal->goal_y = request->goal_y;
+  goal->unit_class = field->unit_class;
+  goal->speed = field->speed;
+  goal->target_x = request->start_x;
+  goal->target_y = request->start_y;
+  goal->min_cost = (Uint32) dt_get_min_move_cost(request->unit);
+  memset(goal->costs, 0, sizeof(DT_COOP_COST) * goal->size);
+  goal->num_entries = 0;
+  goal->heap.num_entries = 0;
+
+  entry = dt_add_coop_cost(goal,
+                           ((Uint32) request->goal_y *
+                                      (Uint32) planner->grid->num_tiles_x) +
+                                                   (Uint32) request->goal_x);
+  entry->cost = 0;
+  estimate = goal->min_cost *
+             dt_get_octile_distance(request->goal_x - request->start_x,
+                                    request->goal_y - request->start_y);
+  dt_push_coop_goal_heap(goal,
+                         entry->node,
+                         dt_make_path_heap_key(estimate, 0));
+
+EXIT_LABEL:
+
+  return(goal);
+}
+
+/******************************************************************************/
+/* Function: dt_get_coop_goal_cost                                            */
+/*                                                                            */
+/* Purpose: Find the cost of the cheapest route from a point to a goal,       */
+/*          ignoring other units.                                             */
+/*                                                                            */
+/* Returns: The cost, or DT_COOP_NO_COST if the goal cannot be reached from   */
+/*          the point.                                                        */
+/*                                                                            */
+/* Parameters: IN/OUT planner - The planner, whose count of points expanded   */
+/*                              is added to.                                  */
+/*             IN/OUT goal - The goal.                                        */
+/*             IN     field - The cost field of the units sent to the goal.   */
+/*             IN     grid_x - The x coordinate of the point, on the grid.    */
+/*             IN     grid_y - The y coordinate of the point, on the grid.    */
+/*                                                                            */
+/* Operation: A point already expanded has its exact cost. Otherwise carry on */
+/*            the A* search back from the goal until the point is expanded or */
+/*            nothing is left open. Each point expanded reaches the points a  */
+/*            step onto it could be taken from, at its cost plus that of the  */
+/*            step. The estimate of each is the octile distance on to the     */
+/*            target at the least cost of a step, which never falls by more   */
+/*            than the cost of a step, so every point is expanded at its      */
+/*            exact cost whichever point is being searched for.               */
+/******************************************************************************/
+Uint32 dt_get_coop_goal_cost(DT_COOP_PLANNER *planner,
+                             DT_COOP_GOAL *goal,
+                             DT_COST_FIELD *field,
+                             int grid_x,
+                             int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = planner->grid;
+  DT_COOP_COST *entry;
+  Uint32 node;
+  Uint32 open_node;
+  Uint32 open_cost;
+  Uint32 step_cost;
+  Uint32 estimate;
+  Uint32 cost = DT_COOP_NO_COST;
+  long index;
+  long next_index;
+  int direction;
+  int open_x;
+  int open_y;
+  int next_x;
+  int next_y;
+
+  node = ((Uint32) grid_y * (Uint32) grid->num_tiles_x) + (Uint32) grid_x;
+  entry = dt_find_coop_cost(goal, node);
+  if ((NULL != entry) && (DT_COOP_COST_CLOSED == entry->state))
+  {
+    cost = entry->cost;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Expand the open point with the lowest key until the point is expanded.   */
+  /****************************************************************************/
+  while (goal->heap.num_entries > 0)
+  {
+    open_node = dt_pop_coop_goal_heap(goal);
+    entry = dt_find_coop_cost(goal, open_node);
+    if (DT_COOP_COST_CLOSED == entry->state)
+    {
+      continue;
+    }
+    entry->state = DT_COOP_COST_CLOSED;
+    open_cost = entry->cost;
+    (planner->total_goal_nodes_expanded)++;
+    open_x = (int) (open_node % (Uint32) grid->num_tiles_x);
+    open_y = (int) (open_node / (Uint32) grid->num_tiles_x);
+    index = dt_get_cost_field_index(field, open_x, open_y);
+
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      next_x = open_x - dt_get_orientation_step_x(direction);
+      next_y = open_y - dt_get_orientation_step_y(direction);
+      next_index = index - field->offsets[direction];
+      if ((next_x < 0) || (next_x >= grid->num_tiles_x) ||
+          (next_y < 0) || (next_y >= grid->num_tiles_y) ||
+          (DT_COST_FIELD_BLOCKED == field->costs[next_index]))
+      {
+        continue;
+      }
+      step_cost = dt_get_cost_field_step_cost(field, next_index, direction);
+      if (0 == step_cost)
+      {
+        continue;
+      }
+      entry = dt_add_coop_cost(goal,
+                               ((Uint32) next_y *
+                                          (Uint32) grid->num_tiles_x) +
+                                                         (Uint32) next_x);
+      if (open_cost + step_cost < entry->cost)
+      {
+        entry->cost = open_cost + step_cost;
+        estimate = goal->min_cost *
+                   dt_get_octile_distance(next_x - goal->target_x,
+                                          next_y - goal->target_y);
+        dt_push_coop_goal_heap(goal,
+                               entry->node,
+                               dt_make_path_heap_key(entry->cost + estimate,
+                                                     entry->cost));
+      }
+    }
+    if (open_node == node)
+    {
+      cost = open_cost;
+      break;
+    }
+  }
+
+EXIT_LABEL:
+
+  return(cost);
+}
+
+/******************************************************************************/
+/* Function: dt_find_coop_cost                                                */
+/*                                                                            */
+/* Purpose: Find the entry of the costs to a goal for a point.                */
+/*                                                                            */
+/* Returns: A pointer to the entry, or NULL if the point has not been         */
+/*          reached.                                                          */
+/*                                                                            */
+/* Parameters: IN     goal - The goal.                                        */
+/*             IN     node - The point.                                       */
+/*                                                                            */
+/* Operation: Step through the entries from where the point hashes to until   */
+/*            it is found or an empty entry is reached.                       */
+/******************************************************************************/
+DT_COOP_COST *dt_find_coop_cost(DT_COOP_GOAL *goal, Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COOP_COST *entry;
+  Uint32 index;
+
+  for (index = dt_hash_coop_cost(goal, node);
+       ;
+       index = (index + 1) & (goal->size - 1))
+  {
+    entry = &(goal->costs[index]);
+    if (DT_COOP_COST_EMPTY == entry->state)
+    {
+      entry = NULL;
+      break;
+    }
+    if (entry->node == node)
+    {
+      break;
+    }
+  }
+
+  return(entry);
+}
+
+/******************************************************************************/
+/* Function: dt_add_coop_cost                                                 */
+/*                                                                            */
+/* Purpose: Find the entry of the costs to a goal for a point, adding one if  */
+/*          the point has not been reached.                                   */
+/*                                                                            */
+/* Returns: A pointer to the entry, which stays valid until the next entry is */
+/*          added. A new entry is open with DT_COOP_NO_COST.                  */
+/*                                                                            */
+/* Parameters: IN/OUT goal - The goal.                                        */
+/*             IN     node - The point.                                       */
+/*                                                                            */
+/* Operation: As dt_reserve_point.                                            */
+/******************************************************************************/
+DT_COOP_COST *dt_add_coop_cost(DT_COOP_GOAL *goal, Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COOP_COST *entry;
+  Uint32 index;
+
+  if ((goal->num_entries + 1) * 2 > goal->size)
+  {
+    dt_grow_coop_costs(goal);
+  }
+
+  for (index = dt_hash_coop_cost(goal, node);
+       ;
+       index = (index + 1) & (goal->size - 1))
+  {
+    entry = &(goal->costs[index]);
+    if (DT_COOP_COST_EMPTY == entry->state)
+    {
+      entry->node = node;
+      entry->cost = DT_COOP_NO_COST;
+      entry->state = DT_COOP_COST_OPEN;
+      (goal->num_entries)++;
+      break;
+    }
+    if (entry->node == node)
+    {
+      break;
+    }
+  }
+
+  return(entry);
+}
+
+/******************************************************************************/
+/* Function: dt_grow_coop_costs                                               */
+/*                                                                            */
+/* Purpose: Double the number of entries of the costs to a goal.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT goal - The goal.                                        */
+/*                                                                            */
+/* Operation: Allocate the new entries and add each entry in use again, as    */
+/*            where it belongs depends on the size.                           */
+/******************************************************************************/
+void dt_grow_coop_costs(DT_COOP_GOAL *goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COOP_COST *old_costs = goal->costs;
+  DT_COOP_COST *entry;
+  Uint32 old_size = goal->size;
+  Uint32 ii;
+
+  goal->size *= 2;
+  goal->costs = (DT_COOP_COST *) dt_calloc(goal->size, sizeof(DT_COOP_COST));
+  goal->num_entries = 0;
+  for (ii = 0; ii < old_size; ii++)
+  {
+    if (DT_COOP_COST_EMPTY != old_costs[ii].state)
+    {
+      entry = dt_add_coop_cost(goal, old_costs[ii].node);
+      entry->cost = old_costs[ii].cost;
+      entry->state = old_costs[ii].state;
+    }
+  }
+  dt_free(old_costs);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_push_coop_goal_heap                                           */
+/*                                                                            */
+/* Purpose: Add a point to the heap of a goal.                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT goal - The goal.                                        */
+/*             IN     node - The point.                                       */
+/*             IN     key - The key to order the point by.                    */
+/*                                                                            */
+/* Operation: Double the heap if it is full, put the point at the end and     */
+/*            move it up past each parent with a higher key. The point may    */
+/*            already be in the heap with a higher key.                       */
+/******************************************************************************/
+void dt_push_coop_goal_heap(DT_COOP_GOAL *goal, Uint32 node, Uint64 key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(goal->heap);
+  Uint32 *nodes;
+  Uint64 *keys;
+  size_t position;
+  size_t parent;
+
+  if (heap->num_entries == heap->size)
+  {
+    nodes = (Uint32 *) dt_malloc(sizeof(Uint32) * heap->size * 2);
+    keys = (Uint64 *) dt_malloc(sizeof(Uint64) * heap->size * 2);
+    memcpy(nodes, heap->nodes, sizeof(Uint32) * heap->num_entries);
+    memcpy(keys, heap->keys, sizeof(Uint64) * heap->num_entries);
+    dt_free(heap->nodes);
+    dt_free(heap->keys);
+    heap->nodes = nodes;
+    heap->keys = keys;
+    heap->size *= 2;
+  }
+
+  position = heap->num_entries;
+  (heap->num_entries)++;
+  while (position > 0)
+  {
+    parent = (position - 1) >> 1;
+    if (heap->keys[parent] <= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[parent];
+    heap->keys[position] = heap->keys[parent];
+    position = parent;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_pop_coop_goal_heap                                            */
+/*                                                                            */
+/* Purpose: Take the point with the lowest key off the heap of a goal.        */
+/*                                                                            */
+/* Returns: The point.                                                        */
+/*                                                                            */
+/* Parameters: IN/OUT goal - The goal, whose heap must not be empty.          */
+/*                                                                            */
+/* Operation: Move the last entry to the top and then down past each child    */
+/*            with a lower key.                                               */
+/******************************************************************************/
+Uint32 dt_pop_coop_goal_heap(DT_COOP_GOAL *goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(goal->heap);
+  Uint32 top = heap->nodes[0];
+  Uint32 node;
+  Uint64 key;
+  size_t position = 0;
+  size_t child;
+
+  (heap->num_entries)--;
+  node = heap->nodes[heap->num_entries];
+  key = heap->keys[heap->num_entries];
+  while ((child = (position << 1) + 1) < heap->num_entries)
+  {
+    if ((child + 1 < heap->num_entries) &&
+        (heap->keys[child + 1] < heap->keys[child]))
+    {
+      child++;
+    }
+    if (heap->keys[child] >= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[child];
+    heap->keys[position] = heap->keys[child];
+    position = child;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+
+  return(top);
+}
+
+/******************************************************************************/
+/* Function: dt_create_coop_planner                                           */
+/*                                                                            */
+/* Purpose: Create a cooperative planner for a grid.                          */
+/*                                                                            */
+/* Returns: A pointer to the new planner.                                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to plan over.                           */
+/*                                                                            */
+/* Operation: The search has DT_COOP_NUM_STATES states whatever the size of   */
+/*            the grid, as a unit can only reach the area around its start.   */
+/*            There is room for DT_COOP_INITIAL_GOALS goals at first.         */
+/******************************************************************************/
+DT_COOP_PLANNER *dt_create_coop_planner(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COOP_PLANNER *planner;
+  int ii;
+
+  planner = (DT_COOP_PLANNER *) dt_malloc(sizeof(DT_COOP_PLANNER));
+  planner->grid = grid;
+  planner->search = dt_create_path_search_with_states(grid,
+                                                      1,
+                                                      DT_COOP_NUM_STATES);
+  planner->reservations = dt_create_reservation_table();
+  planner->goals_size = DT_COOP_INITIAL_GOALS;
+  planner->goals = (DT_COOP_GOAL *) dt_malloc(sizeof(DT_COOP_GOAL) *
+                                              (size_t) planner->goals_size);
+  for (ii = 0; ii < planner->goals_size; ii++)
+  {
+    dt_init_coop_goal(&(planner->goals[ii]));
+  }
+  planner->num_goals = 0;
+  planner->num_plans = 0;
+  planner->units_planned = 0;
+  planner->units_held = 0;
+  planner->total_nodes_expanded = 0;
+  planner->total_goal_nodes_expanded = 0;
+  planner->total_plan_time_us = 0;
+
+  return(planner);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_coop_planner                                          */
+/*                                                                            */
+/* Purpose: Free a cooperative planner.                                       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     planner - The planner to free. The grid is not freed.   */
+/*                                                                            */
+/* Operation: Free the search, the reservations, the goals and then the       */
+/*            planner.                                                        */
+/******************************************************************************/
+void dt_destroy_coop_planner(DT_COOP_PLANNER *planner)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  dt_destroy_path_search(planner->search);
+  dt_destroy_reservation_table(planner->reservations);
+  for (ii = 0; ii < planner->goals_size; ii++)
+  {
+    dt_free(planner->goals[ii].costs);
+    dt_free(planner->goals[ii].heap.nodes);
+    dt_free(planner->goals[ii].heap.keys);
+  }
+  dt_free(planner->goals);
+  dt_free(planner);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_plan_coop_paths                                               */
+/*                                                                            */
+/* Purpose: Plan the moves of a group of units for the next DT_COOP_WINDOW    */
+/*          ticks so that they never collide.                                 */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT planner - The planner.                                  */
+/*             IN/OUT requests - A request for each unit of the group, the    */
+/*                               first planned first. The ret_code and path   */
+/*                               of each are filled in. Each path has a point */
+/*                               for each tick from 0 to DT_COOP_WINDOW,      */
+/*                               where the unit is to be at that tick, and    */
+/*                               repeats a point while the unit waits. A unit */
+/*                               whose goal is bad or cannot be reached has   */
+/*                               a path which keeps it where it is unless it  */
+/*                               must step aside. A unit with no path, which  */
+/*                               is rare, is to wait where it is.             */
+/*             IN     num_requests - The number of requests.                  */
+/*                                                                            */
+/* Operation: Every unit is on its start at tick 0, so those are reserved     */
+/*            before any unit is planned. Then each unit with a goal to move  */
+/*            to is planned in turn and reserves its path. A goal outside the */
+/*            region of the start is turned down first, as the search back    */
+/*            from it would expand every point it can be reached from before  */
+/*            giving up. The searches back from the goals of the last group   */
+/*            are dropped, as the grid may have changed. After the units      */
+/*            moving come the units which are to stay where they are, because */
+/*            they have arrived, their goal cannot be reached or no moves     */
+/*            towards it were found. Planning them last lets them step aside  */
+/*            for the units still moving rather than block them. A unit for   */
+/*            which no path at all is found reserves its start for the whole  */
+/*            window.                                                         */
+/******************************************************************************/
+void dt_plan_coop_paths(DT_COOP_PLANNER *planner,
+                        DT_PATH_REQUEST *requests,
+                        int num_requests)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = planner->grid;
+  DT_PATH_REQUEST *request;
+  DT_COST_FIELD *field;
+  DT_COOP_GOAL *goal;
+  Uint64 start_time;
+  Uint32 node;
+  Uint32 tick;
+  int ii;
+
+  start_time = dt_get_time_us();
+  dt_clear_reservation_table(planner->reservations);
+  planner->num_goals = 0;
+  for (ii = 0; ii < num_requests; ii++)
+  {
+    request = &(requests[ii]);
+    request->path = NULL;
+    request->ret_code = DT_PATH_BAD_POINT;
+    field = dt_get_grid_cost_field(grid, request->unit);
+    if (dt_check_path_points(grid,
+                             field,
+                             request->start_x,
+                             request->start_y,
+                             request->start_x,
+                             request->start_y))
+    {
+      request->ret_code = DT_PATH_PENDING;
+      dt_reserve_point(planner->reservations,
+                       ((Uint32) request->start_y *
+                                          (Uint32) grid->num_tiles_x) +
+                                                   (Uint32) request->start_x,
+                       0,
+                       request->unit);
+    }
+  }
+
+  /****************************************************************************/
+  /* Plan the units moving to their goals.                                    */
+  /****************************************************************************/
+  for (ii = 0; ii < num_requests; ii++)
+  {
+    request = &(requests[ii]);
+    if (DT_PATH_PENDING != request->ret_code)
+    {
+      continue;
+    }
+    field = dt_get_grid_cost_field(grid, request->unit);
+    if (!dt_check_path_points(grid,
+                              field,
+                              request->start_x,
+                              request->start_y,
+                              request->goal_x,
+                              request->goal_y))
+    {
+      request->ret_code = DT_PATH_BAD_POINT;
+      continue;
+    }
+    request->ret_code = DT_PATH_NOT_FOUND;
+    if (!dt_is_goal_in_start_region(grid,
+                                    field,
+                                    request->start_x,
+                                    request->start_y,
+                                    request->goal_x,
+                                    request->goal_y))
+    {
+      continue;
+    }
+    goal = dt_get_coop_goal(planner, request, field);
+    if (DT_COOP_NO_COST == dt_get_coop_goal_cost(planner,
+                                                 goal,
+                                                 field,
+                                                 request->start_x,
+                                                 request->start_y))
+    {
+      continue;
+    }
+    request->ret_code = DT_PATH_FOUND;
+    if ((request->start_x == request->goal_x) &&
+        (request->start_y == request->goal_y))
+    {
+      continue;
+    }
+    if (!dt_search_coop_path(planner, request, goal))
+    {
+      request->ret_code = DT_PATH_NOT_FOUND;
+    }
+  }
+
+  /****************************************************************************/
+  /* Plan the units staying where they are.                                   */
+  /****************************************************************************/
+  for (ii = 0; ii < num_requests; ii++)
+  {
+    request = &(requests[ii]);
+    field = dt_get_grid_cost_field(grid, request->unit);
+    if ((NULL != request->path) ||
+        !dt_check_path_points(grid,
+                              field,
+                              request->start_x,
+                              request->start_y,
+                              request->start_x,
+                              request->start_y))
+    {
+      continue;
+    }
+    if (!dt_search_coop_path(planner, request, NULL))
+    {
+      (planner->units_held)++;
+      node = ((Uint32) request->start_y * (Uint32) grid->num_tiles_x) +
+                                                   (Uint32) request->start_x;
+      for (tick = 1; tick <= DT_COOP_WINDOW; tick++)
+      {
+        dt_reserve_point(planner->reservations, node, tick, request->unit);
+      }
+    }
+  }
+
+  (planner->num_plans)++;
+  planner->total_plan_time_us += dt_get_time_us() - start_time;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_search_coop_path                                              */
+/*                                                                            */
+/* Purpose: Find the cheapest moves for one unit of a group over the window   */
+/*          which keep clear of the points already reserved, and reserve      */
+/*          them.                                                             */
+/*                                                                            */
+/* Returns: true if moves were found, false if every way out of the start is  */
+/*          reserved.                                                         */
+/*                                                                            */
+/* Parameters: IN/OUT planner - The planner.                                  */
+/*             IN/OUT request - The unit's request. Its path is set to the    */
+/*                              moves found, or NULL.                         */
+/*             IN/OUT goal - The search back from the unit's goal, or NULL    */
+/*                           for the unit to stay at its start.               */
+/*                                                                            */
+/* Operation: A* over states of a point and a tick. From each state the unit  */
+/*            may step as in dt_find_path or wait, and either way reaches the */
+/*            next tick. Waiting costs as much as a straight step onto the    */
+/*            point, except on the goal where it is free, so a unit waits     */
+/*            only when it must and stays on the goal once there. The         */
+/*            heuristic is the cost to the goal found by the search back from */
+/*            it, which is exact while no other unit is in the way and so     */
+/*            never overestimates, or 0 with no goal. Points from which the   */
+/*            goal cannot be reached are not stepped onto. The search ends    */
+/*            when a state at the last tick of the window is expanded, and    */
+/*            the cheapest moves there followed by the cheapest route on are  */
+/*            the cheapest route the unit has without a longer window. The    */
+/*            search back only reaches as far as the points of the window     */
+/*            asked about, and units sent to the same goal share it.          */
+/******************************************************************************/
+bool dt_search_coop_path(DT_COOP_PLANNER *planner,
+                         DT_PATH_REQUEST *request,
+                         DT_COOP_GOAL *goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = planner->grid;
+  DT_PATH_SEARCH *search = planner->search;
+  DT_COST_FIELD *field;
+  Uint32 state;
+  Uint32 next_state;
+  Uint32 node;
+  Uint32 tick;
+  Uint32 step_cost;
+  Uint32 estimate = 0;
+  long index;
+  int goal_x = request->start_x;
+  int goal_y = request->start_y;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  field = dt_get_grid_cost_field(grid, request->unit);
+  if (NULL != goal)
+  {
+    goal_x = request->goal_x;
+    goal_y = request->goal_y;
+    estimate = dt_get_coop_goal_cost(planner,
+                                     goal,
+                                     field,
+                                     request->start_x,
+                                     request->start_y);
+  }
+  dt_begin_path_search(search);
+  dt_reach_path_state(search,
+                      (DT_COOP_WINDOW * DT_COOP_AREA_SIZE) + DT_COOP_WINDOW,
+                      0,
+                      DT_PATH_NO_PARENT,
+                      estimate);
+
+  /****************************************************************************/
+  /* Expand the open state with the lowest estimate until one at the end of   */
+  /* the window is reached.                                                   */
+  /****************************************************************************/
+  while (search->heap.num_entries > 0)
+  {
+    state = dt_pop_path_heap(search);
+    (search->nodes_expanded)++;
+    tick = state / (DT_COOP_AREA_SIZE * DT_COOP_AREA_SIZE);
+    grid_x = request->start_x - DT_COOP_WINDOW +
+                              (int) (state % DT_COOP_AREA_SIZE);
+    grid_y = request->start_y - DT_COOP_WINDOW +
+              (int) ((state / DT_COOP_AREA_SIZE) % DT_COOP_AREA_SIZE);
+    if (DT_COOP_WINDOW == tick)
+    {
+      request->path = dt_build_coop_path(planner, request, state);
+      break;
+    }
+
+    node = ((Uint32) grid_y * (Uint32) grid->num_tiles_x) + (Uint32) grid_x;
+    index = dt_get_cost_field_index(field, grid_x, grid_y);
+    next_state = state + (DT_COOP_AREA_SIZE * DT_COOP_AREA_SIZE);
+    if (dt_is_coop_step_free(planner,
+                             request->unit,
+                             node,
+                             node,
+                             tick,
+                             grid_x,
+                             grid_y))
+    {
+      step_cost = ((grid_x == goal_x) && (grid_y == goal_y)) ? 0 :
+                                  DT_PATH_STRAIGHT_STEP * field->costs[index];
+      dt_reach_path_state(search,
+                          next_state,
+                          search->cost[state] + step_cost,
+                          DT_COOP_WAIT,
+                          (NULL != goal) ?
+                                dt_get_coop_goal_cost(planner,
+                                                      goal,
+                                                      field,
+                                                      grid_x,
+                                                      grid_y) : 0);
+    }
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      step_cost = dt_get_cost_field_step_cost(field, index, direction);
+      if (0 == step_cost)
+      {
+        continue;
+      }
+      next_x = grid_x + dt_get_orientation_step_x(direction);
+      next_y = grid_y + dt_get_orientation_step_y(direction);
+      if (!dt_is_coop_step_free(planner,
+                                request->unit,
+                                node,
+                                (Uint32) ((long) node +
+                                      search->node_offsets[direction]),
+                                tick,
+                                next_x,
+                                next_y))
+      {
+        continue;
+      }
+      estimate = (NULL != goal) ?
+                 dt_get_coop_goal_cost(planner, goal, field, next_x, next_y) :
+                 0;
+      if (DT_COOP_NO_COST == estimate)
+      {
+        continue;
+      }
+      dt_reach_path_state(search,
+                          (Uint32) ((long) next_state +
+                                    ((long) dt_get_orientation_step_y(
+                                                                direction) *
+                                                     DT_COOP_AREA_SIZE) +
+                                    dt_get_orientation_step_x(direction)),
+                          search->cost[state] + step_cost,
+                          direction,
+                          estimate);
+    }
+  }
+  planner->total_nodes_expanded += (Uint64) search->nodes_expanded;
+  (planner->units_planned)++;
+
+  /****************************************************************************/
+  /* Reserve the point the unit is on at each tick after the first.           */
+  /****************************************************************************/
+  if (NULL != request->path)
+  {
+    for (tick = 1; tick <= DT_COOP_WINDOW; tick++)
+    {
+      dt_reserve_point(planner->reservations,
+                       ((Uint32) request->path->points[tick].grid_y *
+                                          (Uint32) grid->num_tiles_x) +
+                                 (Uint32) request->path->points[tick].grid_x,
+                       tick,
+                       request->unit);
+    }
+  }
+
+  return(NULL != request->path);
+}
+
+/******************************************************************************/
+/* Function: dt_is_coop_step_free                                             */
+/*                                                                            */
+/* Purpose: Check whether a unit may move from one point to another between   */
+/*          a tick and the next without meeting another unit.                 */
+/*                                                                            */
+/* Returns: true if the move is free.                                         */
+/*                                                                            */
+/* Parameters: IN     planner - The planner.                                  */
+/*             IN     unit - The unit moving.                                 */
+/*             IN     from_node - The point moved from.                       */
+/*             IN     to_node - The point moved to, the same as from_node     */
+/*                              for a wait.                                   */
+/*             IN     tick - The tick the move starts at.                     */
+/*             IN     to_x - The x coordinate of the point moved to.          */
+/*             IN     to_y - The y coordinate of the point moved to.          */
+/*                                                                            */
+/* Operation: The point moved to must not be reserved by another unit at the  */
+/*            next tick, and a unit on it now must not be moving to the point */
+/*            moved from, as the two would pass through each other. A unit on */
+/*            the grid which is not one of the group never moves, so its      */
+/*            point is never free. The units of the group are told apart from */
+/*            it by their reservations of their starts at tick 0.             */
+/******************************************************************************/
+bool dt_is_coop_step_free(DT_COOP_PLANNER *planner,
+                          DT_UNIT *unit,
+                          Uint32 from_node,
+                          Uint32 to_node,
+                          Uint32 tick,
+                          int to_x,
+                          int to_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_RESERVATION_TABLE *table = planner->reservations;
+  DT_UNIT *other_unit;
+  bool step_free = false;
+
+  other_unit = dt_find_reservation(table, to_node, tick + 1);
+  if ((NULL != other_unit) && (unit != other_unit))
+  {
+    goto EXIT_LABEL;
+  }
+  if (from_node != to_node)
+  {
+    other_unit = dt_find_reservation(table, to_node, tick);
+    if ((NULL != other_unit) &&
+        (unit != other_unit) &&
+        (other_unit == dt_find_reservation(table, from_node, tick + 1)))
+    {
+      goto EXIT_LABEL;
+    }
+  }
+  other_unit = dt_get_grid_element(planner->grid, to_x, to_y)->unit;
+  if ((NULL != other_unit) &&
+      (unit != other_unit) &&
+      (other_unit != dt_find_reservation(table, to_node, 0)))
+  {
+    goto EXIT_LABEL;
+  }
+  step_free = true;
+
+EXIT_LABEL:
+
+  return(step_free);
+}
+
+/******************************************************************************/
+/* Function: dt_build_coop_path                                               */
+/*                                                                            */
+/* Purpose: Build the moves to a state at the end of the window.              */
+/*                                                                            */
+/* Returns: A pointer to the new path, with a point for each tick.            */
+/*                                                                            */
+/* Parameters: IN     planner - The planner whose search reached the state.   */
+/*             IN     request - The request searched for.                     */
+/*             IN     last_state - The state at the last tick.                */
+/*                                                                            */
+/* Operation: Follow the parents back a tick at a time, filling the points in */
+/*            from the end. Then give each point the direction of the step    */
+/*            onto it, or for a wait the way the unit already faced.          */
+/******************************************************************************/
+DT_PATH *dt_build_coop_path(DT_COOP_PLANNER *planner,
+                            DT_PATH_REQUEST *request,
+                            Uint32 last_state)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SEARCH *search = planner->search;
+  DT_PATH *path;
+  DT_PATH_POINT *point;
+  Uint32 state = last_state;
+  int direction;
+  int tick;
+
+  path = (DT_PATH *) dt_malloc(sizeof(DT_PATH));
+  path->num_points = DT_COOP_WINDOW + 1;
+  path->points = (DT_PATH_POINT *) dt_malloc(sizeof(DT_PATH_POINT) *
+                                             (size_t) path->num_points);
+  path->cost = search->cost[last_state];
+  for (tick = DT_COOP_WINDOW; tick >= 0; tick--)
+  {
+    point = &(path->points[tick]);
+    point->grid_x = request->start_x - DT_COOP_WINDOW +
+                                         (int) (state % DT_COOP_AREA_SIZE);
+    point->grid_y = request->start_y - DT_COOP_WINDOW +
+                  (int) ((state / DT_COOP_AREA_SIZE) % DT_COOP_AREA_SIZE);
+    direction = search->parent[state];
+    point->orientation = direction;
+    if (DT_PATH_NO_PARENT == direction)
+    {
+      break;
+    }
+    state -= DT_COOP_AREA_SIZE * DT_COOP_AREA_SIZE;
+    if (DT_COOP_WAIT != direction)
+    {
+      state = (Uint32) ((long) state -
+                        ((long) dt_get_orientation_step_y(direction) *
+                                                     DT_COOP_AREA_SIZE) -
+                        dt_get_orientation_step_x(direction));
+    }
+  }
+
+  path->points[0].orientation = request->unit->orientation;
+  for (tick = 1; tick <= DT_COOP_WINDOW; tick++)
+  {
+    if (DT_COOP_WAIT == path->points[tick].orientation)
+    {
+      path->points[tick].orientation = path->points[tick - 1].orientation;
+    }
+  }
+
+  return(path);
+}
+
+/******************************************************************************/
+/* Function: dt_get_coop_planner_memory_usage                                 */
+/*                                                                            */
+/* Purpose: Report how much memory a cooperative planner is using.            */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the planner, not counting the   */
+/*          paths it has handed back.                                         */
+/*                                                                            */
+/* Parameters: IN     planner - The planner.                                  */
+/*                                                                            */
+/* Operation: Add the search, the reservation table and the costs and heap of */
+/*            each goal to the planner.                                       */
+/******************************************************************************/
+size_t dt_get_coop_planner_memory_usage(DT_COOP_PLANNER *planner)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t goals_usage;
+  int ii;
+
+  goals_usage = sizeof(DT_COOP_GOAL) * (size_t) planner->goals_size;
+  for (ii = 0; ii < planner->goals_size; ii++)
+  {
+    goals_usage += (sizeof(DT_COOP_COST) * planner->goals[ii].size) +
+                   ((sizeof(Uint32) + sizeof(Uint64)) *
+                                             planner->goals[ii].heap.size);
+  }
+
+  return(sizeof(DT_COOP_PLANNER) +
+         sizeof(DT_PATH_SEARCH) +
+         (((sizeof(Uint32) * 3) + 1) * planner->search->num_states) +
+         ((sizeof(Uint32) + sizeof(Uint64)) * planner->search->heap.size) +
+         sizeof(DT_RESERVATION_TABLE) +
+         (sizeof(DT_RESERVATION) * planner->reservations->size) +
+         goals_usage);
+}
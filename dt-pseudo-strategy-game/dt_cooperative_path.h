@@ -0,0 +1,237 @@
+/******************************************************************************/
+/* File: dt_cooperative_path.h                                                */
+/*                                                                            */
+/* Purpose: Definitions for cooperative path planning, which finds the moves  */
+/*          of a group of units over the next few ticks so that no two units  */
+/*          are ever on the same point or swap points in the same tick.       */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of cooperative planning.                                        */
+/*                                                                            */
+/* DT_COOP_WINDOW - The number of ticks each plan covers. A unit moves at     */
+/*                  most one step a tick, so it can get no further than this  */
+/*                  from its start.                                           */
+/* DT_COOP_AREA_SIZE - The width and height of the area a unit can reach in   */
+/*                     the window, centred on its start.                      */
+/* DT_COOP_NUM_STATES - The number of states of a search, one for each point  */
+/*                      of the area at each tick from 0 to DT_COOP_WINDOW.    */
+/* DT_COOP_WAIT - The parent of a state reached by waiting where the unit     */
+/*                was, after the DT_VIEW_ORIENTATIONS of the steps.           */
+/* DT_RESERVATION_INITIAL_SIZE - The number of entries a reservation table    */
+/*                               has room for at first. A power of two. It    */
+/*                               doubles whenever it is half full.            */
+/* DT_COOP_INITIAL_GOALS - The number of goals a planner has room for at      */
+/*                         first. It doubles whenever a plan needs more.      */
+/* DT_COOP_GOAL_INITIAL_SIZE - The number of entries the costs of a goal have */
+/*                             room for at first, and of its heap. A power of */
+/*                             two. The costs double whenever they are half   */
+/*                             full.                                          */
+/* DT_COOP_NO_COST - The cost to a goal of a point from which it cannot be    */
+/*                   reached.                                                 */
+/******************************************************************************/
+#define DT_COOP_WINDOW 16
+#define DT_COOP_AREA_SIZE ((2 * DT_COOP_WINDOW) + 1)
+#define DT_COOP_NUM_STATES ((DT_COOP_WINDOW + 1) * DT_COOP_AREA_SIZE * \
+                                                            DT_COOP_AREA_SIZE)
+#define DT_COOP_WAIT NORTH_1
+#define DT_RESERVATION_INITIAL_SIZE 1024
+#define DT_COOP_INITIAL_GOALS 8
+#define DT_COOP_GOAL_INITIAL_SIZE 1024
+#define DT_COOP_NO_COST 0xFFFFFFFFu
+
+/******************************************************************************/
+/* States of the cost of a point to a goal.                                   */
+/*                                                                            */
+/* DT_COOP_COST_EMPTY - The entry is not in use.                              */
+/* DT_COOP_COST_OPEN - The point has been reached, and its cost may fall.     */
+/* DT_COOP_COST_CLOSED - The point has been expanded, and its cost is exact.  */
+/******************************************************************************/
+#define DT_COOP_COST_EMPTY 0
+#define DT_COOP_COST_OPEN 1
+#define DT_COOP_COST_CLOSED 2
+
+/******************************************************************************/
+/* DT_RESERVATION:                                                            */
+/*                                                                            */
+/* One entry of a reservation table, saying a unit will be on a point at a    */
+/* tick.                                                                      */
+/*                                                                            */
+/* node - The point, numbered row by row as the nodes of a DT_PATH_SEARCH.    */
+/* tick - The tick, counted from the start of the plan.                       */
+/* unit - The unit, or NULL if the entry is empty.                            */
+/******************************************************************************/
+typedef struct dt_reservation
+{
+  Uint32 node;
+  Uint32 tick;
+  struct dt_unit *unit;
+} DT_RESERVATION;
+
+/******************************************************************************/
+/* DT_RESERVATION_TABLE:                                                      */
+/*                                                                            */
+/* The points units of a group have claimed at each tick, in an open          */
+/* addressed hash table. Only the claimed points are held, so the table stays */
+/* small however large the grid is, and each lookup reads a few entries next  */
+/* to each other.                                                             */
+/*                                                                            */
+/* entries - The entries. A point and tick hash to an entry and are found in  */
+/*           it or in one of those after it before the next empty one.        */
+/* size - The number of entries. A power of two.                              */
+/* num_entries - The number of entries in use.                                */
+/******************************************************************************/
+typedef struct dt_reservation_table
+{
+  DT_RESERVATION *entries;
+  Uint32 size;
+  Uint32 num_entries;
+} DT_RESERVATION_TABLE;
+
+/******************************************************************************/
+/* DT_COOP_COST:                                                              */
+/*                                                                            */
+/* One entry of the costs to a goal, giving the cost of the cheapest route    */
+/* found so far from a point to the goal.                                     */
+/*                                                                            */
+/* node - The point, numbered row by row as the nodes of a DT_PATH_SEARCH.    */
+/* cost - The cost.                                                           */
+/* state - One of the states of the cost above. DT_COOP_COST_EMPTY is 0, so   */
+/*         clearing the entries empties them.                                 */
+/******************************************************************************/
+typedef struct dt_coop_cost
+{
+  Uint32 node;
+  Uint32 cost;
+  Uint32 state;
+} DT_COOP_COST;
+
+/******************************************************************************/
+/* DT_COOP_GOAL:                                                              */
+/*                                                                            */
+/* A search back from a goal over the grid, ignoring other units, which gives */
+/* the cost to the goal of the points a plan needs. It is guided towards the  */
+/* start of the first unit sent to the goal and stops as soon as the point    */
+/* asked for is expanded, so it covers little more than the way there. When a */
+/* point it has not expanded is asked for, it goes on from where it stopped.  */
+/* Only the points reached are held, in an open addressed hash table, so a    */
+/* goal stays small however large the grid is.                                */
+/*                                                                            */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* unit_class - The class of the units sent to the goal.                      */
+/* speed - The speed of the units sent to the goal.                           */
+/* target_x - The x coordinate of the point the search is guided towards.     */
+/* target_y - The y coordinate of the point the search is guided towards.     */
+/* min_cost - The least cost of moving onto any point, for the estimate.      */
+/* costs - The points reached. A point hashes to an entry and is found in it  */
+/*         or in one of those after it before the next empty one.             */
+/* size - The number of entries of costs. A power of two.                     */
+/* num_entries - The number of entries of costs in use.                       */
+/* heap - The open points, keyed by cost plus the estimate of the cost on to  */
+/*        the target. A point whose cost falls is pushed again, and the entry */
+/*        left behind is skipped when popped as the point is closed.          */
+/******************************************************************************/
+typedef struct dt_coop_goal
+{
+  int goal_x;
+  int goal_y;
+  int unit_class;
+  int speed;
+  int target_x;
+  int target_y;
+  Uint32 min_cost;
+  DT_COOP_COST *costs;
+  Uint32 size;
+  Uint32 num_entries;
+  DT_PATH_HEAP heap;
+} DT_COOP_GOAL;
+
+/******************************************************************************/
+/* DT_COOP_PLANNER:                                                           */
+/*                                                                            */
+/* Plans the moves of a group of units over a grid for the next               */
+/* DT_COOP_WINDOW ticks, one unit at a time. Each unit searches space and     */
+/* time, avoiding the points the units before it have reserved, and then      */
+/* reserves its own. Beyond the window the search is guided by the cost to    */
+/* the goal ignoring other units, found by a search back from the goal which  */
+/* the planner keeps for each goal of the group, so a plan heads the right    */
+/* way without searching further ahead. The group is planned again every few  */
+/* ticks, well within the window.                                             */
+/*                                                                            */
+/* grid - The grid planned over.                                              */
+/* search - The search, whose states are the points of the area around the    */
+/*          start of the unit being planned at each tick of the window.       */
+/* reservations - The points reserved by the units planned so far.            */
+/* goals - The searches back from the goals of the group being planned. The   */
+/*         entries past num_goals keep their memory for later plans.          */
+/* num_goals - The number of goals of the group being planned.                */
+/* goals_size - The number of entries of goals.                               */
+/* num_plans - The number of groups planned.                                  */
+/* units_planned - The number of units planned in every group.                */
+/* units_held - The number of units for which no moves at all could be found  */
+/*              that kept clear of the units before them, which were left to  */
+/*              wait.                                                         */
+/* total_nodes_expanded - The number of states expanded by every plan.        */
+/* total_goal_nodes_expanded - The number of points expanded by the searches  */
+/*                             back from the goals of every plan.             */
+/* total_plan_time_us - The time taken by every plan, in microseconds.        */
+/******************************************************************************/
+typedef struct dt_coop_planner
+{
+  struct dt_grid *grid;
+  struct dt_path_search *search;
+  DT_RESERVATION_TABLE *reservations;
+  DT_COOP_GOAL *goals;
+  int num_goals;
+  int goals_size;
+  long num_plans;
+  long units_planned;
+  long units_held;
+  Uint64 total_nodes_expanded;
+  Uint64 total_goal_nodes_expanded;
+  Uint64 total_plan_time_us;
+} DT_COOP_PLANNER;
+
+/******************************************************************************/
+/* Function: dt_hash_reservation                                              */
+/*                                                                            */
+/* Purpose: Find the entry of a reservation table to look for a point and     */
+/*          tick in first.                                                    */
+/*                                                                            */
+/* Returns: The index of the entry.                                           */
+/*                                                                            */
+/* Parameters: IN     table - The reservation table.                          */
+/*             IN     node - The point.                                       */
+/*             IN     tick - The tick.                                        */
+/*                                                                            */
+/* Operation: Mix the two and take the top bits, which depend on all of them. */
+/******************************************************************************/
+static inline Uint32 dt_hash_reservation(DT_RESERVATION_TABLE *table,
+                                         Uint32 node,
+                                         Uint32 tick)
+{
+  Uint32 hash = ((node * 0x9E3779B1u) ^ tick) * 0x9E3779B1u;
+
+  return((hash ^ (hash >> 16)) & (table->size - 1));
+}
+
+/******************************************************************************/
+/* Function: dt_hash_coop_cost                                                */
+/*                                                                            */
+/* Purpose: Find the entry of the costs to a goal to look for a point in      */
+/*          first.                                                            */
+/*                                                                            */
+/* Returns: The index of the entry.                                           */
+/*                                                                            */
+/* Parameters: IN     goal - The goal.                                        */
+/*             IN     node - The point.                                       */
+/*                                                                            */
+/* Operation: As dt_hash_reservation, with no tick.                           */
+/******************************************************************************/
+static inline Uint32 dt_hash_coop_cost(DT_COOP_GOAL *goal, Uint32 node)
+{
+  Uint32 hash = node * 0x9E3779B1u;
+
+  return((hash ^ (hash >> 16)) & (goal->size - 1));
+}
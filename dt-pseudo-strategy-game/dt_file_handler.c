@@ -54,3 +54,42 @@ void dt_close_file(FILE *old_file)
 
   return;
 }
+
+/******************************************************************************/
+/* Function: dt_get_file_size                                                 */
+/*                                                                            */
+/* Purpose: Find the size of a file.                                          */
+/*                                                                            */
+/* Returns: The size of the file in bytes, or 0 if it could not be opened.    */
+/*                                                                            */
+/* Parameters: IN     filename - The name of the file.                        */
+/*                                                                            */
+/* Operation: Ask the system, which copes with files over 2GB.                */
+/******************************************************************************/
+Uint64 dt_get_file_size(char *filename)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  HANDLE file;
+  LARGE_INTEGER file_size;
+  Uint64 size = 0;
+
+  file = CreateFileA(filename,
+                     GENERIC_READ,
+                     FILE_SHARE_READ,
+                     NULL,
+                     OPEN_EXISTING,
+                     FILE_ATTRIBUTE_NORMAL,
+                     NULL);
+  if (INVALID_HANDLE_VALUE != file)
+  {
+    if (GetFileSizeEx(file, &file_size))
+    {
+      size = (Uint64) file_size.QuadPart;
+    }
+    CloseHandle(file);
+  }
+
+  return(size);
+}
@@ -7,6 +7,8 @@
 #define FILE_MODE_READ "r"
 #define FILE_MODE_WRITE "w"
 #define FILE_MODE_APPEND "a"
+#define FILE_MODE_READ_BINARY "rb"
+#define FILE_MODE_WRITE_BINARY "wb"
 
 /******************************************************************************/
 /* Error codes for the function dt_file_open.                                 */
@@ -0,0 +1,648 @@
+/******************************************************************************/
+/* File: dt_flow_field.c                                                      */
+/*                                                                            */
+/* Purpose: Flow fields. Rather than searching for a path for each unit sent  */
+/*          to the same place, the grid is searched once backwards from the   */
+/*          goal and every unit reads which way to step from where it is.     */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_get_grid_flow_field                                           */
+/*                                                                            */
+/* Purpose: Find the flow field of a grid towards a goal for a unit, building */
+/*          it if the grid does not have one yet or the grid has changed      */
+/*          since it was built.                                               */
+/*                                                                            */
+/* Returns: A pointer to the flow field, which is owned by the grid, or NULL  */
+/*          if the goal is off the grid or cannot be entered.                 */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*             IN     unit - The unit. Units of the same class and speed      */
+/*                           share a field.                                   */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Look through the fields the grid has, moving the one found to   */
+/*            the end of the list so that the list runs from the least        */
+/*            recently used. If none matches and the grid has                 */
+/*            DT_GRID_MAX_FLOW_FIELDS, drop the least recently used to make   */
+/*            room for a new one. Like dt_get_grid_cost_field this writes to  */
+/*            the grid and must not be called from several threads at once.   */
+/******************************************************************************/
+DT_FLOW_FIELD *dt_get_grid_flow_field(DT_GRID *grid,
+                                      DT_UNIT *unit,
+                                      int goal_x,
+                                      int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_FLOW_FIELD *flow = NULL;
+  DT_COST_FIELD *field;
+  int ii;
+
+  if ((goal_x < 0) || (goal_x >= grid->num_tiles_x) ||
+      (goal_y < 0) || (goal_y >= grid->num_tiles_y) ||
+      !dt_is_grid_traversable(grid, goal_x, goal_y))
+  {
+    goto EXIT_LABEL;
+  }
+  field = dt_get_grid_cost_field(grid, unit);
+
+  for (ii = 0; ii < grid->num_flow_fields; ii++)
+  {
+    flow = grid->flow_fields[ii];
+    if ((flow->unit_class == unit->unit_class) &&
+        (flow->speed == unit->speed) &&
+        (flow->goal_x == goal_x) &&
+        (flow->goal_y == goal_y))
+    {
+      memmove(&(grid->flow_fields[ii]),
+              &(grid->flow_fields[ii + 1]),
+              sizeof(DT_FLOW_FIELD *) *
+                                 (size_t) (grid->num_flow_fields - ii - 1));
+      grid->flow_fields[grid->num_flow_fields - 1] = flow;
+      if (flow->stale)
+      {
+        dt_build_flow_field(flow, field, grid);
+      }
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Make room for a new field and build it.                                  */
+  /****************************************************************************/
+  if (DT_GRID_MAX_FLOW_FIELDS == grid->num_flow_fields)
+  {
+    dt_destroy_flow_field(grid->flow_fields[0]);
+    (grid->num_flow_fields)--;
+    memmove(&(grid->flow_fields[0]),
+            &(grid->flow_fields[1]),
+            sizeof(DT_FLOW_FIELD *) * (size_t) grid->num_flow_fields);
+  }
+  flow = dt_create_flow_field(grid, unit, goal_x, goal_y);
+  dt_build_flow_field(flow, field, grid);
+  grid->flow_fields[grid->num_flow_fields] = flow;
+  (grid->num_flow_fields)++;
+
+EXIT_LABEL:
+
+  return(flow);
+}
+
+/******************************************************************************/
+/* Function: dt_create_flow_field                                             */
+/*                                                                            */
+/* Purpose: Create an empty flow field.                                       */
+/*                                                                            */
+/* Returns: A pointer to the new flow field. It is stale until built.         */
+/*                                                                            */
+/* Parameters: IN     grid - The grid the field is for.                       */
+/*             IN     unit - A unit of the class and speed the field is for.  */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Allocate the integration costs and directions with the same     */
+/*            border as a cost field.                                         */
+/******************************************************************************/
+DT_FLOW_FIELD *dt_create_flow_field(DT_GRID *grid,
+                                    DT_UNIT *unit,
+                                    int goal_x,
+                                    int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_FLOW_FIELD *flow;
+  size_t num_entries;
+
+  flow = (DT_FLOW_FIELD *) dt_malloc(sizeof(DT_FLOW_FIELD));
+  flow->unit_class = unit->unit_class;
+  flow->speed = unit->speed;
+  flow->goal_x = goal_x;
+  flow->goal_y = goal_y;
+  flow->width = grid->num_tiles_x + 2;
+  num_entries = (size_t) flow->width * (size_t) (grid->num_tiles_y + 2);
+  flow->integration = (Uint32 *) dt_malloc(sizeof(Uint32) * num_entries);
+  flow->directions = (unsigned char *) dt_malloc(num_entries);
+  flow->stale = true;
+  flow->rounds = 0;
+  flow->chunks_relaxed = 0;
+
+  return(flow);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_flow_field                                            */
+/*                                                                            */
+/* Purpose: Free a flow field.                                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     flow - The flow field to free.                          */
+/*                                                                            */
+/* Operation: Free the costs and directions and then the field.               */
+/******************************************************************************/
+void dt_destroy_flow_field(DT_FLOW_FIELD *flow)
+{
+  dt_free(flow->integration);
+  dt_free(flow->directions);
+  dt_free(flow);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_flow_field                                              */
+/*                                                                            */
+/* Purpose: Work out the cost to the goal and the way to step from every      */
+/*          point of a flow field.                                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT flow - The flow field.                                  */
+/*             IN     field - The cost field for the units of the flow field. */
+/*             IN     grid - The grid of the fields.                          */
+/*                                                                            */
+/* Operation: A wavefront spreads out from the goal a chunk at a time. Each   */
+/*            active chunk is searched from the costs just outside it, and    */
+/*            any chunk whose edge costs are lowered makes the chunks beside  */
+/*            that edge active. The chunks are split four ways by whether     */
+/*            their x and y are odd, and each quarter in turn is searched as  */
+/*            one batch of jobs on the master worker pool. No two chunks of a */
+/*            batch touch, so none reads costs another job is writing. When   */
+/*            no chunk is active the costs are the cheapest, and a last batch */
+/*            over every chunk picks the direction of each point.             */
+/******************************************************************************/
+void dt_build_flow_field(DT_FLOW_FIELD *flow,
+                         DT_COST_FIELD *field,
+                         DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_FLOW_FIELD_JOB *jobs;
+  unsigned char *active;
+  Uint32 chunk;
+  int num_chunks_x;
+  int num_chunks_y;
+  int num_chunks;
+  int num_active;
+  int num_jobs;
+  int parity;
+  int chunk_x;
+  int chunk_y;
+  int next_x;
+  int next_y;
+  int direction;
+  int ii;
+
+  num_chunks_x = (grid->num_tiles_x + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  num_chunks_y = (grid->num_tiles_y + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  num_chunks = num_chunks_x * num_chunks_y;
+  jobs = (DT_FLOW_FIELD_JOB *) dt_malloc(sizeof(DT_FLOW_FIELD_JOB) *
+                                         (size_t) num_chunks);
+  active = (unsigned char *) dt_calloc((size_t) num_chunks, 1);
+
+  /****************************************************************************/
+  /* Start with only the goal reached and its chunk active.                   */
+  /****************************************************************************/
+  memset(flow->integration,
+         0xFF,
+         sizeof(Uint32) * (size_t) flow->width *
+                                            (size_t) (grid->num_tiles_y + 2));
+  flow->integration[dt_get_cost_field_index(field,
+                                            flow->goal_x,
+                                            flow->goal_y)] = 0;
+  active[((flow->goal_y >> DT_PATH_CLUSTER_SHIFT) * num_chunks_x) +
+         (flow->goal_x >> DT_PATH_CLUSTER_SHIFT)] = 1;
+  num_active = 1;
+  flow->rounds = 0;
+  flow->chunks_relaxed = 0;
+
+  while (num_active > 0)
+  {
+    (flow->rounds)++;
+    for (parity = 0; parity < 4; parity++)
+    {
+      /************************************************************************/
+      /* Search the active chunks of this quarter.                            */
+      /************************************************************************/
+      num_jobs = 0;
+      for (chunk_y = parity >> 1; chunk_y < num_chunks_y; chunk_y += 2)
+      {
+        for (chunk_x = parity & 1; chunk_x < num_chunks_x; chunk_x += 2)
+        {
+          chunk = (Uint32) ((chunk_y * num_chunks_x) + chunk_x);
+          if (active[chunk])
+          {
+            active[chunk] = 0;
+            num_active--;
+            jobs[num_jobs].flow = flow;
+            jobs[num_jobs].field = field;
+            jobs[num_jobs].grid = grid;
+            jobs[num_jobs].chunk = chunk;
+            jobs[num_jobs].changed_edges = 0;
+            num_jobs++;
+          }
+        }
+      }
+      if (0 == num_jobs)
+      {
+        continue;
+      }
+      dt_run_worker_pool_jobs(dt_get_master_worker_pool(),
+                              dt_relax_flow_field_job,
+                              jobs,
+                              sizeof(DT_FLOW_FIELD_JOB),
+                              num_jobs);
+      flow->chunks_relaxed += num_jobs;
+
+      /************************************************************************/
+      /* Wake the chunks beside each edge which changed.                      */
+      /************************************************************************/
+      for (ii = 0; ii < num_jobs; ii++)
+      {
+        for (direction = NORTH; direction < NORTH_1; direction++)
+        {
+          if (0 == (jobs[ii].changed_edges & (1u << direction)))
+          {
+            continue;
+          }
+          next_x = ((int) jobs[ii].chunk % num_chunks_x) +
+                                       dt_get_orientation_step_x(direction);
+          next_y = ((int) jobs[ii].chunk / num_chunks_x) +
+                                       dt_get_orientation_step_y(direction);
+          if ((next_x < 0) || (next_x >= num_chunks_x) ||
+              (next_y < 0) || (next_y >= num_chunks_y))
+          {
+            continue;
+          }
+          chunk = (Uint32) ((next_y * num_chunks_x) + next_x);
+          if (!active[chunk])
+          {
+            active[chunk] = 1;
+            num_active++;
+          }
+        }
+      }
+    }
+  }
+
+  /****************************************************************************/
+  /* Pick the direction of every point.                                       */
+  /****************************************************************************/
+  memset(flow->directions,
+         DT_FLOW_NO_DIRECTION,
+         (size_t) flow->width * (size_t) (grid->num_tiles_y + 2));
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    jobs[ii].flow = flow;
+    jobs[ii].field = field;
+    jobs[ii].grid = grid;
+    jobs[ii].chunk = (Uint32) ii;
+    jobs[ii].changed_edges = 0;
+  }
+  dt_run_worker_pool_jobs(dt_get_master_worker_pool(),
+                          dt_point_flow_field_job,
+                          jobs,
+                          sizeof(DT_FLOW_FIELD_JOB),
+                          num_chunks);
+  flow->stale = false;
+
+  dt_free(active);
+  dt_free(jobs);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_relax_flow_field_job                                          */
+/*                                                                            */
+/* Purpose: Search one chunk of a flow field on a worker thread.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT data - The DT_FLOW_FIELD_JOB for the chunk. Its         */
+/*                           changed_edges are filled in.                     */
+/*                                                                            */
+/* Operation: Relax the chunk of the job.                                     */
+/******************************************************************************/
+void dt_relax_flow_field_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_FLOW_FIELD_JOB *job = (DT_FLOW_FIELD_JOB *) data;
+
+  job->changed_edges = dt_relax_flow_field_chunk(job->flow,
+                                                 job->field,
+                                                 job->grid,
+                                                 job->chunk);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_relax_flow_field_chunk                                        */
+/*                                                                            */
+/* Purpose: Lower the costs to the goal of the points of one chunk of a flow  */
+/*          field as far as the costs around the chunk allow.                 */
+/*                                                                            */
+/* Returns: The chunks around the chunk which must be searched again, as the  */
+/*          changed_edges of a DT_FLOW_FIELD_JOB.                             */
+/*                                                                            */
+/* Parameters: IN/OUT flow - The flow field. Only the chunk is written to.    */
+/*             IN     field - The cost field for the units of the flow field. */
+/*             IN     grid - The grid of the fields.                          */
+/*             IN     chunk - The index of the chunk.                         */
+/*                                                                            */
+/* Operation: Copy the costs of the chunk out and open each edge point which  */
+/*            is cheaper through a step out of the chunk than it was, and the */
+/*            goal if it is in the chunk. Search the chunk backwards from     */
+/*            them and copy back the costs which were lowered. The points     */
+/*            which were not opened were already as cheap as the rest of the  */
+/*            chunk could make them, so only the new costs need spreading. A  */
+/*            lowered cost on an edge is only seen by the chunks beside it,   */
+/*            and one in a corner by the three chunks around that corner.     */
+/******************************************************************************/
+unsigned int dt_relax_flow_field_chunk(DT_FLOW_FIELD *flow,
+                               DT_COST_FIELD *field,
+                               DT_GRID *grid,
+                               Uint32 chunk)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER_HEAP heap;
+  Uint32 costs[DT_PATH_CLUSTER_POINTS];
+  Uint32 step_cost;
+  Uint32 next_cost;
+  long index;
+  long next_index;
+  int num_chunks_x;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+  int point;
+  int direction;
+  unsigned int edges;
+  unsigned int changed_edges = 0;
+
+  num_chunks_x = (grid->num_tiles_x + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  first_x = (int) (chunk % (Uint32) num_chunks_x) << DT_PATH_CLUSTER_SHIFT;
+  first_y = (int) (chunk / (Uint32) num_chunks_x) << DT_PATH_CLUSTER_SHIFT;
+  last_x = MIN(first_x + DT_PATH_CLUSTER_SIZE, grid->num_tiles_x) - 1;
+  last_y = MIN(first_y + DT_PATH_CLUSTER_SIZE, grid->num_tiles_y) - 1;
+  dt_init_path_cluster_heap(&heap, costs);
+
+  for (grid_y = first_y; grid_y <= last_y; grid_y++)
+  {
+    for (grid_x = first_x; grid_x <= last_x; grid_x++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      point = ((grid_y - first_y) << DT_PATH_CLUSTER_SHIFT) +
+              (grid_x - first_x);
+      costs[point] = flow->integration[index];
+      if ((grid_x == flow->goal_x) && (grid_y == flow->goal_y))
+      {
+        dt_update_path_cluster_heap(&heap, point);
+      }
+      if ((grid_x != first_x) && (grid_x != last_x) &&
+          (grid_y != first_y) && (grid_y != last_y))
+      {
+        continue;
+      }
+
+      /************************************************************************/
+      /* An edge point may be cheaper by a step out of the chunk.             */
+      /************************************************************************/
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        next_x = grid_x + dt_get_orientation_step_x(direction);
+        next_y = grid_y + dt_get_orientation_step_y(direction);
+        if ((next_x >= first_x) && (next_x <= last_x) &&
+            (next_y >= first_y) && (next_y <= last_y))
+        {
+          continue;
+        }
+        next_index = index + field->offsets[direction];
+        next_cost = flow->integration[next_index];
+        step_cost = dt_get_cost_field_step_cost(field, index, direction);
+        if ((DT_FLOW_NO_COST != next_cost) &&
+            (0 != step_cost) &&
+            (next_cost + step_cost < costs[point]))
+        {
+          costs[point] = next_cost + step_cost;
+          dt_update_path_cluster_heap(&heap, point);
+        }
+      }
+    }
+  }
+  dt_relax_path_cluster(field, first_x, first_y, last_x, last_y, true, &heap);
+
+  for (grid_y = first_y; grid_y <= last_y; grid_y++)
+  {
+    for (grid_x = first_x; grid_x <= last_x; grid_x++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      point = ((grid_y - first_y) << DT_PATH_CLUSTER_SHIFT) +
+              (grid_x - first_x);
+      if (costs[point] == flow->integration[index])
+      {
+        continue;
+      }
+      flow->integration[index] = costs[point];
+      edges = 0;
+      if (grid_y == first_y)
+      {
+        edges |= (1u << NORTH);
+      }
+      if (grid_y == last_y)
+      {
+        edges |= (1u << SOUTH);
+      }
+      if (grid_x == first_x)
+      {
+        edges |= (1u << WEST);
+      }
+      if (grid_x == last_x)
+      {
+        edges |= (1u << EAST);
+      }
+      for (direction = NORTHEAST; direction < NORTH_1; direction += 2)
+      {
+        if ((edges & (1u << (direction - 1))) &&
+            (edges & (1u << ((direction + 1) % NORTH_1))))
+        {
+          edges |= (1u << direction);
+        }
+      }
+      changed_edges |= edges;
+    }
+  }
+
+  return(changed_edges);
+}
+
+/******************************************************************************/
+/* Function: dt_point_flow_field_job                                          */
+/*                                                                            */
+/* Purpose: Pick the directions of one chunk of a flow field on a worker      */
+/*          thread.                                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     data - The DT_FLOW_FIELD_JOB for the chunk.             */
+/*                                                                            */
+/* Operation: Pick the directions of the chunk of the job.                    */
+/******************************************************************************/
+void dt_point_flow_field_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_FLOW_FIELD_JOB *job = (DT_FLOW_FIELD_JOB *) data;
+
+  dt_point_flow_field_chunk(job->flow, job->field, job->grid, job->chunk);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_point_flow_field_chunk                                        */
+/*                                                                            */
+/* Purpose: Pick the direction of the first step towards the goal from each   */
+/*          point of one chunk of a flow field.                               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT flow - The flow field, whose costs must be complete.    */
+/*                           Only the directions of the chunk are written to. */
+/*             IN     field - The cost field for the units of the flow field. */
+/*             IN     grid - The grid of the fields.                          */
+/*             IN     chunk - The index of the chunk.                         */
+/*                                                                            */
+/* Operation: Take the step whose cost plus the cost to the goal from where   */
+/*            it lands is lowest, the first in DT_VIEW_ORIENTATIONS order if  */
+/*            several are. That sum is the cost of the point, so following    */
+/*            the directions from any point costs exactly its integration     */
+/*            cost and always ends at the goal.                               */
+/******************************************************************************/
+void dt_point_flow_field_chunk(DT_FLOW_FIELD *flow,
+                               DT_COST_FIELD *field,
+                               DT_GRID *grid,
+                               Uint32 chunk)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 best_cost;
+  Uint32 step_cost;
+  Uint32 next_cost;
+  long index;
+  int num_chunks_x;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int grid_x;
+  int grid_y;
+  int direction;
+  int best_direction;
+
+  num_chunks_x = (grid->num_tiles_x + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  first_x = (int) (chunk % (Uint32) num_chunks_x) << DT_PATH_CLUSTER_SHIFT;
+  first_y = (int) (chunk / (Uint32) num_chunks_x) << DT_PATH_CLUSTER_SHIFT;
+  last_x = MIN(first_x + DT_PATH_CLUSTER_SIZE, grid->num_tiles_x) - 1;
+  last_y = MIN(first_y + DT_PATH_CLUSTER_SIZE, grid->num_tiles_y) - 1;
+
+  for (grid_y = first_y; grid_y <= last_y; grid_y++)
+  {
+    for (grid_x = first_x; grid_x <= last_x; grid_x++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      if ((0 == flow->integration[index]) ||
+          (DT_FLOW_NO_COST == flow->integration[index]))
+      {
+        continue;
+      }
+      best_cost = DT_FLOW_NO_COST;
+      best_direction = DT_FLOW_NO_DIRECTION;
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        next_cost = flow->integration[index + field->offsets[direction]];
+        step_cost = dt_get_cost_field_step_cost(field, index, direction);
+        if ((DT_FLOW_NO_COST != next_cost) &&
+            (0 != step_cost) &&
+            (next_cost + step_cost < best_cost))
+        {
+          best_cost = next_cost + step_cost;
+          best_direction = direction;
+        }
+      }
+      flow->directions[index] = (unsigned char) best_direction;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_mark_grid_flow_fields_stale                                   */
+/*                                                                            */
+/* Purpose: Mark every flow field of a grid as needing to be built again.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*                                                                            */
+/* Operation: A change anywhere can open or close a cheaper way to the goal   */
+/*            from any point, so every field is rebuilt the next time it is   */
+/*            asked for. Fields which are not asked for again cost nothing.   */
+/******************************************************************************/
+void dt_mark_grid_flow_fields_stale(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < grid->num_flow_fields; ii++)
+  {
+    grid->flow_fields[ii]->stale = true;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_flow_field_memory_usage                                   */
+/*                                                                            */
+/* Purpose: Report how much memory a flow field is using.                     */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the field.                      */
+/*                                                                            */
+/* Parameters: IN     flow - The flow field.                                  */
+/*             IN     grid - The grid the field is for.                       */
+/*                                                                            */
+/* Operation: Add a cost and a direction for every point and the border to    */
+/*            the field itself.                                               */
+/******************************************************************************/
+size_t dt_get_flow_field_memory_usage(DT_FLOW_FIELD *flow, DT_GRID *grid)
+{
+  return(sizeof(DT_FLOW_FIELD) +
+         ((sizeof(Uint32) + 1) * (size_t) flow->width *
+                                            (size_t) (grid->num_tiles_y + 2)));
+}
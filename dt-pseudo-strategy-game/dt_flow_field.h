@@ -0,0 +1,120 @@
+/******************************************************************************/
+/* File: dt_flow_field.h                                                      */
+/*                                                                            */
+/* Purpose: Definitions for flow fields, which guide any number of units of   */
+/*          one class to the same goal from one search of the whole grid.     */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of flow fields.                                                 */
+/*                                                                            */
+/* DT_FLOW_NO_COST - The integration cost of a point from which the goal      */
+/*                   cannot be reached.                                       */
+/* DT_FLOW_NO_DIRECTION - The direction of a point with no step towards the   */
+/*                        goal, because it is the goal or cannot reach it.    */
+/******************************************************************************/
+#define DT_FLOW_NO_COST 0xFFFFFFFFu
+#define DT_FLOW_NO_DIRECTION 0xFF
+
+/******************************************************************************/
+/* DT_FLOW_FIELD:                                                             */
+/*                                                                            */
+/* The cost of reaching one goal from every point of a grid for one unit      */
+/* class and speed, and the direction of the first step on the cheapest path  */
+/* from each point. Both are laid out as the costs of a DT_COST_FIELD, with a */
+/* border around the grid that is never reached.                              */
+/*                                                                            */
+/* unit_class - The class of the units the field is for.                      */
+/* speed - The speed of the units the field is for.                           */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* width - The number of entries in each row of integration and directions.   */
+/* integration - The cost of the cheapest path from each point to the goal,   */
+/*               or DT_FLOW_NO_COST.                                          */
+/* directions - The DT_VIEW_ORIENTATIONS value of the first step from each    */
+/*              point, or DT_FLOW_NO_DIRECTION.                               */
+/* stale - Set when the grid has changed since the field was built.           */
+/* rounds - The number of passes over the active chunks the last build took.  */
+/* chunks_relaxed - The number of chunk searches the last build ran.          */
+/******************************************************************************/
+typedef struct dt_flow_field
+{
+  int unit_class;
+  int speed;
+  int goal_x;
+  int goal_y;
+  int width;
+  Uint32 *integration;
+  unsigned char *directions;
+  bool stale;
+  long rounds;
+  long chunks_relaxed;
+} DT_FLOW_FIELD;
+
+/******************************************************************************/
+/* DT_FLOW_FIELD_JOB:                                                         */
+/*                                                                            */
+/* One chunk of a flow field, relaxed or given its directions on the master   */
+/* worker pool.                                                               */
+/*                                                                            */
+/* flow - The flow field.                                                     */
+/* field - The cost field for the units of the flow field.                    */
+/* grid - The grid of the fields.                                             */
+/* chunk - The index of the chunk.                                            */
+/* changed_edges - Set by a relaxing job to the chunks around it which must   */
+/*                 be searched again, with bit (1 << direction) set for the   */
+/*                 chunk in each of the DT_VIEW_ORIENTATIONS. A chunk is      */
+/*                 woken when a cost on the edge facing it was lowered.       */
+/******************************************************************************/
+typedef struct dt_flow_field_job
+{
+  struct dt_flow_field *flow;
+  struct dt_cost_field *field;
+  struct dt_grid *grid;
+  Uint32 chunk;
+  unsigned int changed_edges;
+} DT_FLOW_FIELD_JOB;
+
+/******************************************************************************/
+/* Function: dt_get_flow_field_direction                                      */
+/*                                                                            */
+/* Purpose: Find which way a unit should step to follow a flow field.         */
+/*                                                                            */
+/* Returns: The DT_VIEW_ORIENTATIONS value of the step, or                    */
+/*          DT_FLOW_NO_DIRECTION if the unit is at the goal or cannot reach   */
+/*          it.                                                               */
+/*                                                                            */
+/* Parameters: IN     flow - The flow field.                                  */
+/*             IN     grid_x - The x coordinate of the unit.                  */
+/*             IN     grid_y - The y coordinate of the unit.                  */
+/*                                                                            */
+/* Operation: Read the direction stored for the point.                        */
+/******************************************************************************/
+static inline int dt_get_flow_field_direction(DT_FLOW_FIELD *flow,
+                                              int grid_x,
+                                              int grid_y)
+{
+  return(flow->directions[((long) (grid_y + 1) * (long) flow->width) +
+                          (long) (grid_x + 1)]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_flow_field_cost                                           */
+/*                                                                            */
+/* Purpose: Find the cost of reaching the goal of a flow field from a point.  */
+/*                                                                            */
+/* Returns: The cost, or DT_FLOW_NO_COST if the goal cannot be reached.       */
+/*                                                                            */
+/* Parameters: IN     flow - The flow field.                                  */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Read the integration cost stored for the point.                 */
+/******************************************************************************/
+static inline Uint32 dt_get_flow_field_cost(DT_FLOW_FIELD *flow,
+                                            int grid_x,
+                                            int grid_y)
+{
+  return(flow->integration[((long) (grid_y + 1) * (long) flow->width) +
+                           (long) (grid_x + 1)]);
+}
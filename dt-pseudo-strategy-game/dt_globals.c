@@ -14,3 +14,11 @@ struct dt_unsorted_list *master_unit_list;
 /* errors.                                                                    */
 /******************************************************************************/
 struct dt_unsorted_list *master_file_list;
+
+/******************************************************************************/
+/* GLOBAL - master_worker_pool:                                               */
+/*                                                                            */
+/* The pool of worker threads shared by the whole program. Created the first  */
+/* time it is needed by dt_get_master_worker_pool.                            */
+/******************************************************************************/
+struct dt_worker_pool *master_worker_pool;
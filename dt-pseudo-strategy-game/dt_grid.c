@@ -3,57 +3,345 @@
 /******************************************************************************/
 /* Function: dt_create_grid                                                   */
 /*                                                                            */
-/* Purpose: Create a new grid object.                                         */
+/* Purpose: Create a new row-major grid object.                               */
 /*                                                                            */
 /* Returns: A pointer to the new grid object.                                 */
 /*                                                                            */
-/* Parameters: None.                                                          */
+/* Parameters: IN     square_width - The width in pixels of a grid square.    */
+/*             IN     square_height - The height in pixels of a grid square.  */
+/*             IN     num_tiles_x - The number of tiles in the x direction.   */
+/*             IN     num_tiles_y - The number of tiles in the y direction.   */
 /*                                                                            */
-/* Operation: Allocate memory for the grid object.                            */
+/* Operation: Create the grid with DT_GRID_STORAGE_ROW_MAJOR storage.         */
 /******************************************************************************/
 DT_GRID *dt_create_grid(int square_width,
                         int square_height,
                         int num_tiles_x,
                         int num_tiles_y)
+{
+  return(dt_create_grid_with_storage(square_width,
+                                     square_height,
+                                     num_tiles_x,
+                                     num_tiles_y,
+                                     DT_GRID_STORAGE_ROW_MAJOR));
+}
+
+/******************************************************************************/
+/* Function: dt_create_grid_with_storage                                      */
+/*                                                                            */
+/* Purpose: Create a new grid object using a particular storage type.         */
+/*                                                                            */
+/* Returns: A pointer to the new grid object.                                 */
+/*                                                                            */
+/* Parameters: IN     square_width - The width in pixels of a grid square.    */
+/*             IN     square_height - The height in pixels of a grid square.  */
+/*             IN     num_tiles_x - The number of tiles in the x direction.   */
+/*             IN     num_tiles_y - The number of tiles in the y direction.   */
+/*             IN     storage - One of DT_GRID_STORAGE_TYPES.                 */
+/*                                                                            */
+/* Operation: Create the grid object and then allocate the storage for its    */
+/*            points, every point starting off as an empty, traversable       */
+/*            plain.                                                          */
+/******************************************************************************/
+DT_GRID *dt_create_grid_with_storage(int square_width,
+                                     int square_height,
+                                     int num_tiles_x,
+                                     int num_tiles_y,
+                                     int storage)
 {
   /****************************************************************************/
   /* Local Variables.                                                         */
   /****************************************************************************/
   DT_GRID *temp_grid;
-  int row;
-  int col;
 
   /****************************************************************************/
-  /* Allocate memory for the temporary grid object.                           */
+  /* Create the grid object.                                                  */
   /****************************************************************************/
-  temp_grid = dt_malloc(sizeof(DT_GRID));
+  temp_grid = dt_create_empty_grid(square_width,
+                                   square_height,
+                                   num_tiles_x,
+                                   num_tiles_y,
+                                   storage);
 
   /****************************************************************************/
-  /* Allocate the necessary memory for the grid itself.                       */
+  /* Allocate the storage for the points.                                     */
   /****************************************************************************/
-  temp_grid->map_grid = (DT_GRID_ELEMENT ***)
-                            dt_malloc(sizeof(DT_GRID_ELEMENT **) * num_tiles_y);
-  for (row = 0; row < num_tiles_y; row++)
+  if (DT_GRID_STORAGE_CHUNKED == storage)
   {
-    temp_grid->map_grid[row] = (DT_GRID_ELEMENT **)
-                             dt_malloc(sizeof(DT_GRID_ELEMENT *) * num_tiles_x);
-    for (col = 0; col < num_tiles_x; col++)
-    {
-      temp_grid->map_grid[row][col] = dt_create_grid_element();
-    }
+    dt_alloc_chunked_grid_storage(temp_grid);
+  }
+  else
+  {
+    dt_alloc_dense_grid_storage(temp_grid);
   }
 
+  return(temp_grid);
+}
+
+/******************************************************************************/
+/* Function: dt_create_empty_grid                                             */
+/*                                                                            */
+/* Purpose: Create a new grid object without any storage for its points.      */
+/*                                                                            */
+/* Returns: A pointer to the new grid object.                                 */
+/*                                                                            */
+/* Parameters: IN     square_width - The width in pixels of a grid square.    */
+/*             IN     square_height - The height in pixels of a grid square.  */
+/*             IN     num_tiles_x - The number of tiles in the x direction.   */
+/*             IN     num_tiles_y - The number of tiles in the y direction.   */
+/*             IN     storage - One of DT_GRID_STORAGE_TYPES.                 */
+/*                                                                            */
+/* Operation: Allocate memory for the grid object and set its parameters,     */
+/*            leaving every storage pointer NULL. For row-major and Morton    */
+/*            grids also work out how many points the layers must hold and    */
+/*            how long each traversable row is. For a Morton grid the layers  */
+/*            run up to the code of the bottom right point.                   */
+/*            The caller must then point the grid at storage for its points.  */
+/******************************************************************************/
+DT_GRID *dt_create_empty_grid(int square_width,
+                              int square_height,
+                              int num_tiles_x,
+                              int num_tiles_y,
+                              int storage)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *temp_grid;
+  int ii;
+
+  /****************************************************************************/
+  /* Allocate memory for the temporary grid object.                           */
+  /****************************************************************************/
+  temp_grid = dt_malloc(sizeof(DT_GRID));
+
   /****************************************************************************/
   /* Set the grid parameters.                                                 */
   /****************************************************************************/
+  temp_grid->storage = storage;
   temp_grid->square_width = square_width;
   temp_grid->square_height = square_height;
   temp_grid->num_tiles_x = num_tiles_x;
   temp_grid->num_tiles_y = num_tiles_y;
+  temp_grid->map_grid = NULL;
+  temp_grid->tile_type = NULL;
+  temp_grid->traversable = NULL;
+  temp_grid->terrain_type = NULL;
+  temp_grid->elevation = NULL;
+  temp_grid->water_depth = NULL;
+  temp_grid->movement_modifier = NULL;
+  temp_grid->num_points = 0;
+  temp_grid->traversable_words_per_row = 0;
+  temp_grid->chunks = NULL;
+  temp_grid->default_chunk = NULL;
+  temp_grid->num_chunks_x = 0;
+  temp_grid->num_chunks_y = 0;
+  temp_grid->num_allocated_chunks = 0;
+  temp_grid->mapped_file = NULL;
+  temp_grid->streamer = NULL;
+  temp_grid->chunk_store = NULL;
+  temp_grid->num_cost_fields = 0;
+  temp_grid->landmark_serial = 0;
+  temp_grid->num_flow_fields = 0;
+  temp_grid->path_cache = NULL;
+  temp_grid->replanners = NULL;
+  temp_grid->path_scheduler = NULL;
+
+  /****************************************************************************/
+  /* Work out the size of the layers of a row-major or Morton grid.           */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED != storage)
+  {
+    temp_grid->traversable_words_per_row =
+              (num_tiles_x + DT_GRID_BITS_PER_WORD - 1) >> DT_GRID_WORD_SHIFT;
+    if (DT_GRID_STORAGE_MORTON == storage)
+    {
+      temp_grid->num_points = (size_t) dt_morton_encode(num_tiles_x - 1,
+                                                        num_tiles_y - 1) + 1;
+    }
+    else
+    {
+      temp_grid->num_points = (size_t) num_tiles_x * (size_t) num_tiles_y;
+    }
+  }
+
+  /****************************************************************************/
+  /* Start with an empty tile type table. The first entry is reserved for     */
+  /* points which have no tile.                                               */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_MAX_TILE_TYPES; ii++)
+  {
+    temp_grid->tile_types[ii] = NULL;
+  }
+  temp_grid->num_tile_types = DT_TILE_TYPE_NONE + 1;
 
   return(temp_grid);
 }
 
+/******************************************************************************/
+/* Function: dt_alloc_dense_grid_block                                        */
+/*                                                                            */
+/* Purpose: Allocate the element block and layers of a row-major or Morton    */
+/*          grid without initialising them.                                   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid whose dimensions have been set.         */
+/*                                                                            */
+/* Operation: Allocate the grid elements and every terrain layer in a single  */
+/*            block and point each array at its part of that block. The       */
+/*            elements come first so that every array is suitably aligned.    */
+/*            The caller must write every element and layer, including the    */
+/*            clear padding bits at the end of each traversable row.          */
+/******************************************************************************/
+void dt_alloc_dense_grid_block(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_elements;
+  size_t num_words;
+  char *block;
+
+  /****************************************************************************/
+  /* Allocate the necessary memory for the grid itself. This is one block so  */
+  /* that a full scan of the map walks memory in order.                       */
+  /****************************************************************************/
+  num_elements = grid->num_points;
+  num_words = (size_t) grid->traversable_words_per_row *
+                                                    (size_t) grid->num_tiles_y;
+  block = (char *) dt_malloc((sizeof(DT_GRID_ELEMENT) * num_elements) +
+                             (sizeof(Uint32) * num_words) +
+                             (sizeof(Sint16) * num_elements) +
+                             (4 * num_elements));
+
+  grid->map_grid = (DT_GRID_ELEMENT *) block;
+  block += sizeof(DT_GRID_ELEMENT) * num_elements;
+  grid->traversable = (Uint32 *) block;
+  block += sizeof(Uint32) * num_words;
+  grid->elevation = (Sint16 *) block;
+  block += sizeof(Sint16) * num_elements;
+  grid->tile_type = (unsigned char *) block;
+  block += num_elements;
+  grid->terrain_type = (unsigned char *) block;
+  block += num_elements;
+  grid->water_depth = (unsigned char *) block;
+  block += num_elements;
+  grid->movement_modifier = (unsigned char *) block;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_alloc_dense_grid_storage                                      */
+/*                                                                            */
+/* Purpose: Allocate the element block and layers of a row-major or Morton    */
+/*          grid.                                                             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid whose dimensions have been set.         */
+/*                                                                            */
+/* Operation: Allocate the block and then initialise the elements and layers  */
+/*            to an empty, traversable plain.                                 */
+/******************************************************************************/
+void dt_alloc_dense_grid_storage(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_elements;
+  size_t num_words;
+  size_t ii;
+  Uint32 last_word_mask;
+  int row;
+
+  dt_alloc_dense_grid_block(grid);
+  num_elements = grid->num_points;
+  num_words = (size_t) grid->traversable_words_per_row *
+                                                    (size_t) grid->num_tiles_y;
+
+  /****************************************************************************/
+  /* Initialise the elements and the layers.                                  */
+  /****************************************************************************/
+  for (ii = 0; ii < num_elements; ii++)
+  {
+    dt_init_grid_element(&(grid->map_grid[ii]));
+    grid->elevation[ii] = 0;
+  }
+  memset(grid->tile_type, DT_TILE_TYPE_NONE, num_elements);
+  memset(grid->terrain_type, DT_GROUND_TYPE_PLAIN, num_elements);
+  memset(grid->water_depth, 0, num_elements);
+  memset(grid->movement_modifier, 0, num_elements);
+
+  /****************************************************************************/
+  /* Every point starts off traversable. The bits past the end of each row    */
+  /* are left clear so that word scans never run off the edge of the grid.    */
+  /****************************************************************************/
+  memset(grid->traversable, 0xFF, sizeof(Uint32) * num_words);
+  if (0 != (grid->num_tiles_x & DT_GRID_WORD_MASK))
+  {
+    last_word_mask = (1u << (grid->num_tiles_x & DT_GRID_WORD_MASK)) - 1;
+    for (row = 0; row < grid->num_tiles_y; row++)
+    {
+      grid->traversable[((size_t) (row + 1) *
+                         grid->traversable_words_per_row) - 1] = last_word_mask;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_alloc_chunked_grid_storage                                    */
+/*                                                                            */
+/* Purpose: Allocate the chunk table and default chunk of a chunked grid.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid whose dimensions have been set.         */
+/*                                                                            */
+/* Operation: Create the single default chunk and point every entry of the    */
+/*            chunk table at it. No other chunk is allocated until something  */
+/*            is written into it.                                             */
+/*            The default chunk covers whole chunks, so on chunks at the      */
+/*            right hand edge of the grid the traversable bits beyond the     */
+/*            last column are set. Callers must check coordinates lie on the  */
+/*            grid rather than relying on those bits.                         */
+/******************************************************************************/
+void dt_alloc_chunked_grid_storage(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_chunks;
+  size_t ii;
+
+  /****************************************************************************/
+  /* Work out how many chunks are needed to cover the grid.                   */
+  /****************************************************************************/
+  grid->num_chunks_x = (grid->num_tiles_x + DT_GRID_CHUNK_MASK) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  grid->num_chunks_y = (grid->num_tiles_y + DT_GRID_CHUNK_MASK) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  num_chunks = (size_t) grid->num_chunks_x * (size_t) grid->num_chunks_y;
+
+  /****************************************************************************/
+  /* Create the default chunk and point every chunk at it.                    */
+  /****************************************************************************/
+  grid->default_chunk = (DT_GRID_CHUNK *) dt_malloc(sizeof(DT_GRID_CHUNK));
+  dt_init_grid_chunk(grid->default_chunk);
+
+  grid->chunks = (DT_GRID_CHUNK **) dt_malloc(sizeof(DT_GRID_CHUNK *) *
+                                                                   num_chunks);
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    grid->chunks[ii] = grid->default_chunk;
+  }
+
+  return;
+}
+
 /******************************************************************************/
 /* Function: dt_destroy_grid                                                  */
 /*                                                                            */
@@ -63,24 +351,96 @@ DT_GRID *dt_create_grid(int square_width,
 /*                                                                            */
 /* Parameters: IN     grid - The grid to be freed.                            */
 /*                                                                            */
-/* Operation: Release the memory used in the underlying grid and then that    */
-/*            used in the placeholder object itself.                          */
+/* Operation: Release the storage used for the points of the grid, the tiles  */
+/*            in its tile type table and its cost fields, and then that used  */
+/*            in the placeholder object itself. If the layers point into a    */
+/*            mapped map file then the file is unmapped. If the grid is       */
+/*            streamed then the streaming is stopped first.                   */
 /******************************************************************************/
 void dt_destroy_grid(DT_GRID *grid)
 {
   /****************************************************************************/
   /* Local Variables.                                                         */
   /****************************************************************************/
-  int ii;
+  size_t num_chunks;
+  size_t ii;
+  int tile_type;
+  int field;
+
+  /****************************************************************************/
+  /* Stop streaming chunks into the grid.                                     */
+  /****************************************************************************/
+  if (NULL != grid->streamer)
+  {
+    dt_destroy_chunk_streamer(grid->streamer);
+  }
+
+  /****************************************************************************/
+  /* Free the cost fields built for searching the grid.                       */
+  /****************************************************************************/
+  for (field = 0; field < grid->num_cost_fields; field++)
+  {
+    dt_destroy_cost_field(grid->cost_fields[field]);
+  }
+  for (field = 0; field < grid->num_flow_fields; field++)
+  {
+    dt_destroy_flow_field(grid->flow_fields[field]);
+  }
+  if (NULL != grid->path_cache)
+  {
+    dt_destroy_path_cache(grid->path_cache);
+  }
+  if (NULL != grid->path_scheduler)
+  {
+    dt_destroy_path_scheduler(grid->path_scheduler);
+  }
+
+  /****************************************************************************/
+  /* Free the tiles in the tile type table.                                   */
+  /****************************************************************************/
+  for (tile_type = 0; tile_type < grid->num_tile_types; tile_type++)
+  {
+    if (NULL != grid->tile_types[tile_type])
+    {
+      dt_destroy_background_tile(grid->tile_types[tile_type]);
+    }
+  }
+
+  /****************************************************************************/
+  /* Free the block holding the elements and layers of a row-major grid. If   */
+  /* the layers are in a mapped file this only holds the elements.            */
+  /****************************************************************************/
+  if (NULL != grid->map_grid)
+  {
+    dt_free(grid->map_grid);
+  }
+  if (NULL != grid->mapped_file)
+  {
+    dt_unmap_file(grid->mapped_file);
+  }
 
   /****************************************************************************/
-  /* Free up each row and column of the map grid.                             */
+  /* Free every chunk which was allocated for a chunked grid followed by the  */
+  /* default chunk, the chunk table and any compressed copies of the chunks.  */
   /****************************************************************************/
-  for (ii = 0; ii < grid->num_tiles_x; ii++)
+  if (NULL != grid->chunks)
   {
-    dt_free(grid->map_grid[ii]);
+    num_chunks = (size_t) grid->num_chunks_x * (size_t) grid->num_chunks_y;
+    for (ii = 0; ii < num_chunks; ii++)
+    {
+      if ((grid->default_chunk != grid->chunks[ii]) &&
+          (NULL != grid->chunks[ii]))
+      {
+        dt_free(grid->chunks[ii]);
+      }
+    }
+    dt_free(grid->chunks);
+    dt_free(grid->default_chunk);
+    if (NULL != grid->chunk_store)
+    {
+      dt_destroy_chunk_store(grid->chunk_store, num_chunks);
+    }
   }
-  dt_free(grid->map_grid);
 
   /****************************************************************************/
   /* Free the grid object itself.                                             */
@@ -89,59 +449,484 @@ void dt_destroy_grid(DT_GRID *grid)
 }
 
 /******************************************************************************/
-/* Function: dt_create_grid_element                                           */
+/* Function: dt_init_grid_element                                             */
+/*                                                                            */
+/* Purpose: Set a grid element to its initial empty state.                    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT grid_element - The element to be initialised.           */
+/*                                                                            */
+/* Operation: Set the unit pointer to NULL.                                   */
+/******************************************************************************/
+void dt_init_grid_element(DT_GRID_ELEMENT *grid_element)
+{
+  /****************************************************************************/
+  /* Set the unit pointer to NULL so that it can be tested.                   */
+  /****************************************************************************/
+  grid_element->unit = NULL;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_init_grid_chunk                                               */
+/*                                                                            */
+/* Purpose: Set a chunk to the default state of an empty, traversable plain.  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT chunk - The chunk to be initialised.                    */
+/*                                                                            */
+/* Operation: Initialise every element and layer of the chunk.                */
+/******************************************************************************/
+void dt_init_grid_chunk(DT_GRID_CHUNK *chunk)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  /****************************************************************************/
+  /* Initialise the elements and the layers.                                  */
+  /****************************************************************************/
+  for (ii = 0; ii < DT_GRID_CHUNK_POINTS; ii++)
+  {
+    dt_init_grid_element(&(chunk->elements[ii]));
+    chunk->elevation[ii] = 0;
+  }
+  memset(chunk->tile_type, DT_TILE_TYPE_NONE, DT_GRID_CHUNK_POINTS);
+  memset(chunk->traversable, 0xFF, sizeof(chunk->traversable));
+  memset(chunk->terrain_type, DT_GROUND_TYPE_PLAIN, DT_GRID_CHUNK_POINTS);
+  memset(chunk->water_depth, 0, DT_GRID_CHUNK_POINTS);
+  memset(chunk->movement_modifier, 0, DT_GRID_CHUNK_POINTS);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_chunk_for_update                                     */
+/*                                                                            */
+/* Purpose: Find the chunk of a chunked grid that holds a grid position so    */
+/*          that it can be written to.                                        */
+/*                                                                            */
+/* Returns: A pointer to a chunk which is never the shared default chunk.     */
+/*                                                                            */
+/* Parameters: IN     grid - The chunked grid containing the point.           */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: If the chunk table entry is still the default chunk then        */
+/*            allocate a new chunk as a copy of the default and store it in   */
+/*            the table. A chunk held compressed is inflated first and marked */
+/*            as needing to be compressed again.                              */
+/******************************************************************************/
+DT_GRID_CHUNK *dt_get_grid_chunk_for_update(DT_GRID *grid,
+                                            int grid_x,
+                                            int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID_CHUNK **chunk_entry;
+  size_t index;
+
+  /****************************************************************************/
+  /* Find the entry in the chunk table and allocate a real chunk for it if it */
+  /* has not been written to before.                                          */
+  /****************************************************************************/
+  index = ((size_t) (grid_y >> DT_GRID_CHUNK_SHIFT) * grid->num_chunks_x) +
+                                             (grid_x >> DT_GRID_CHUNK_SHIFT);
+  chunk_entry = &(grid->chunks[index]);
+  if (NULL == (*chunk_entry))
+  {
+    dt_inflate_grid_chunk(grid, index);
+  }
+  else if (grid->default_chunk == (*chunk_entry))
+  {
+    (*chunk_entry) = (DT_GRID_CHUNK *) dt_malloc(sizeof(DT_GRID_CHUNK));
+    memcpy((*chunk_entry), grid->default_chunk, sizeof(DT_GRID_CHUNK));
+    (grid->num_allocated_chunks)++;
+    if (NULL != grid->chunk_store)
+    {
+      dt_add_inflated_grid_chunk(grid->chunk_store, index);
+    }
+  }
+  if (NULL != grid->chunk_store)
+  {
+    grid->chunk_store->chunks[index].dirty = true;
+  }
+
+  return(*chunk_entry);
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_element_for_update                                   */
+/*                                                                            */
+/* Purpose: Retrieve the grid element at a given grid position so that it can */
+/*          be changed.                                                       */
+/*                                                                            */
+/* Returns: A pointer to the element.                                         */
+/*                                                                            */
+/* Parameters: IN     grid - The grid containing the element.                 */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: For a chunked grid make sure the chunk holding the element has  */
+/*            been allocated. Otherwise this is the same as                   */
+/*            dt_get_grid_element.                                            */
+/******************************************************************************/
+DT_GRID_ELEMENT *dt_get_grid_element_for_update(DT_GRID *grid,
+                                                int grid_x,
+                                                int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(&(dt_get_grid_chunk_for_update(grid, grid_x, grid_y)->
+                        elements[dt_get_grid_chunk_index(grid_x, grid_y)]));
+  }
+
+  return(dt_get_grid_element(grid, grid_x, grid_y));
+}
+
+/******************************************************************************/
+/* Function: dt_add_tile_type_to_grid                                         */
+/*                                                                            */
+/* Purpose: Add a background tile to the tile type table of a grid.           */
+/*                                                                            */
+/* Returns: DT_TILE_TYPE_ADDED if the tile was added.                         */
+/*          DT_TILE_TYPE_TABLE_FULL if the table has no room for another type.*/
+/*                                                                            */
+/* Parameters: IN     grid - The grid whose table the tile is added to.       */
+/*             IN     tile - The tile holding the graphic, label, terrain     */
+/*                           type and base values for the new type. The grid  */
+/*                           takes ownership of it and destroys it with the   */
+/*                           grid.                                            */
+/*             OUT    tile_type - The index of the new type in the table.     */
+/*                                                                            */
+/* Operation: Store the tile in the next free entry of the table.             */
+/******************************************************************************/
+int dt_add_tile_type_to_grid(DT_GRID *grid,
+                             DT_BACKGROUND_TILE *tile,
+                             int *tile_type)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code = DT_TILE_TYPE_ADDED;
+
+  /****************************************************************************/
+  /* Check that there is room for another type.                               */
+  /****************************************************************************/
+  if (DT_MAX_TILE_TYPES <= grid->num_tile_types)
+  {
+    ret_code = DT_TILE_TYPE_TABLE_FULL;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Add the tile to the table.                                               */
+  /****************************************************************************/
+  (*tile_type) = grid->num_tile_types;
+  grid->tile_types[grid->num_tile_types] = tile;
+  (grid->num_tile_types)++;
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_assign_tile_type_to_grid                                      */
+/*                                                                            */
+/* Purpose: Place a tile type at a grid position.                             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid on which the tile is placed.            */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*             IN     tile_type - The index in the tile type table of the     */
+/*                                type to be placed. DT_TILE_TYPE_NONE clears */
+/*                                the point back to an empty plain.           */
+/*                                                                            */
+/* Operation: Store the tile type for the point and copy the terrain type and */
+/*            base values of the type into the grid layers, removing any      */
+/*            overrides the point had. Values that do not fit into a layer    */
+/*            are clamped to its range.                                       */
+/*            Clearing a point in an untouched chunk of a chunked grid does   */
+/*            not allocate the chunk.                                         */
+/******************************************************************************/
+void dt_assign_tile_type_to_grid(DT_GRID *grid,
+                                 int grid_x,
+                                 int grid_y,
+                                 int tile_type)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  DT_GRID_CHUNK *chunk;
+  size_t index;
+  unsigned char *tile_type_layer;
+  unsigned char *terrain_type_layer;
+
+  /****************************************************************************/
+  /* Find where the layer values for this point are stored.                   */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    if ((DT_TILE_TYPE_NONE == tile_type) &&
+        (grid->default_chunk == dt_get_grid_chunk(grid, grid_x, grid_y)))
+    {
+      goto EXIT_LABEL;
+    }
+    chunk = dt_get_grid_chunk_for_update(grid, grid_x, grid_y);
+    index = dt_get_grid_chunk_index(grid_x, grid_y);
+    tile_type_layer = chunk->tile_type;
+    terrain_type_layer = chunk->terrain_type;
+  }
+  else
+  {
+    index = dt_get_grid_index(grid, grid_x, grid_y);
+    tile_type_layer = grid->tile_type;
+    terrain_type_layer = grid->terrain_type;
+  }
+
+  /****************************************************************************/
+  /* Store the tile type and its terrain type.                                */
+  /****************************************************************************/
+  tile = grid->tile_types[tile_type];
+  tile_type_layer[index] = (unsigned char) tile_type;
+  terrain_type_layer[index] = (NULL != tile) ?
+                     (unsigned char) tile->terrain_type : DT_GROUND_TYPE_PLAIN;
+
+  /****************************************************************************/
+  /* Reset the values which may be overridden to those of the type.           */
+  /****************************************************************************/
+  if (NULL != tile)
+  {
+    dt_set_grid_terrain_overrides(grid,
+                                  grid_x,
+                                  grid_y,
+                                  tile->elevation,
+                                  tile->water_depth,
+                                  tile->movement_modifier);
+  }
+  else
+  {
+    dt_set_grid_terrain_overrides(grid, grid_x, grid_y, 0, 0, 0);
+  }
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_set_grid_terrain_overrides                                    */
 /*                                                                            */
-/* Purpose: Allocate memory for a grid element.                               */
+/* Purpose: Set the elevation, water depth and movement modifier of a single  */
+/*          grid position, overriding the base values of its tile type.       */
 /*                                                                            */
-/* Returns: A pointer to the allocated memory.                                */
+/* Returns: Nothing.                                                          */
 /*                                                                            */
-/* Parameters: None.                                                          */
+/* Parameters: IN     grid - The grid to update.                              */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*             IN     elevation - The elevation of the point.                 */
+/*             IN     water_depth - The water depth of the point.             */
+/*             IN     movement_modifier - The movement modifier of the point. */
 /*                                                                            */
-/* Operation: Allocate memory for the grid element.                           */
-/*            Set the tile and unit pointers to NULL.                         */
+/* Operation: Clamp each value to the range of its layer and store it, and    */
+/*            update the cost of the point in the cost fields of the grid.    */
+/*            Setting the default values on an untouched chunk of a chunked   */
+/*            grid does not allocate the chunk.                               */
 /******************************************************************************/
-DT_GRID_ELEMENT *dt_create_grid_element()
+void dt_set_grid_terrain_overrides(DT_GRID *grid,
+                                   int grid_x,
+                                   int grid_y,
+                                   int elevation,
+                                   int water_depth,
+                                   int movement_modifier)
 {
   /****************************************************************************/
   /* Local Variables.                                                         */
   /****************************************************************************/
-  DT_GRID_ELEMENT *temp_grid_element;
+  DT_GRID_CHUNK *chunk;
+  size_t index;
+  Sint16 *elevation_layer;
+  unsigned char *water_depth_layer;
+  unsigned char *movement_modifier_layer;
 
   /****************************************************************************/
-  /* Allocate memory for the grid element.                                    */
+  /* Find where the layer values for this point are stored.                   */
   /****************************************************************************/
-  temp_grid_element = (DT_GRID_ELEMENT *) dt_malloc(sizeof(DT_GRID_ELEMENT));
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    if ((0 == elevation) && (0 == water_depth) && (0 == movement_modifier) &&
+        (grid->default_chunk == dt_get_grid_chunk(grid, grid_x, grid_y)))
+    {
+      goto EXIT_LABEL;
+    }
+    chunk = dt_get_grid_chunk_for_update(grid, grid_x, grid_y);
+    index = dt_get_grid_chunk_index(grid_x, grid_y);
+    elevation_layer = chunk->elevation;
+    water_depth_layer = chunk->water_depth;
+    movement_modifier_layer = chunk->movement_modifier;
+  }
+  else
+  {
+    index = dt_get_grid_index(grid, grid_x, grid_y);
+    elevation_layer = grid->elevation;
+    water_depth_layer = grid->water_depth;
+    movement_modifier_layer = grid->movement_modifier;
+  }
 
   /****************************************************************************/
-  /* Set the unit and tile pointers to NULL so that they can be tested.       */
+  /* Store the clamped values.                                                */
   /****************************************************************************/
-  temp_grid_element->unit = NULL;
-  temp_grid_element->tile = NULL;
+  elevation_layer[index] = (Sint16) CLAMP(elevation, -32768, 32767);
+  water_depth_layer[index] = (unsigned char) CLAMP(water_depth, 0, 255);
+  movement_modifier_layer[index] =
+                               (unsigned char) CLAMP(movement_modifier, 0, 255);
+  dt_update_grid_cost_fields(grid, grid_x, grid_y, grid_x, grid_y);
 
-  return(temp_grid_element);
+EXIT_LABEL:
+
+  return;
 }
 
 /******************************************************************************/
-/* Function: dt_destroy_grid_element                                          */
+/* Function: dt_set_grid_traversable                                          */
 /*                                                                            */
-/* Purpose: Free the memory for a grid element.                               */
+/* Purpose: Mark whether units may enter a grid position.                     */
 /*                                                                            */
 /* Returns: Nothing.                                                          */
 /*                                                                            */
-/* Parameters: IN     grid_element -                                          */
+/* Parameters: IN     grid - The grid to update.                              */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*             IN     traversable - Whether the point may be entered.         */
 /*                                                                            */
-/* Operation: Free the grid element.                                          */
+/* Operation: Set or clear the bit for the point in the traversable bitmap    */
+/*            and update the cost fields of the grid to match.                */
+/*            Marking a point in an untouched chunk of a chunked grid as      */
+/*            traversable does not allocate the chunk.                        */
 /******************************************************************************/
-void dt_destroy_grid_element(DT_GRID_ELEMENT *grid_element)
+void dt_set_grid_traversable(DT_GRID *grid,
+                             int grid_x,
+                             int grid_y,
+                             bool traversable)
 {
   /****************************************************************************/
-  /* Free the memory allocate for the grid element.                           */
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *word;
+  Uint32 bit;
+
+  /****************************************************************************/
+  /* Find the word holding the bit for this point.                            */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    if (traversable &&
+        (grid->default_chunk == dt_get_grid_chunk(grid, grid_x, grid_y)))
+    {
+      goto EXIT_LABEL;
+    }
+    word = &(dt_get_grid_chunk_for_update(grid, grid_x, grid_y)->
+                                   traversable[grid_y & DT_GRID_CHUNK_MASK]);
+  }
+  else
+  {
+    word = &(grid->traversable[((size_t) grid_y *
+                                grid->traversable_words_per_row) +
+                               (grid_x >> DT_GRID_WORD_SHIFT)]);
+  }
+
+  /****************************************************************************/
+  /* Update the bit.                                                          */
   /****************************************************************************/
-  dt_free(grid_element);
+  bit = 1u << (grid_x & DT_GRID_WORD_MASK);
+  if (traversable)
+  {
+    (*word) |= bit;
+  }
+  else
+  {
+    (*word) &= ~bit;
+  }
+  dt_update_grid_cost_fields(grid, grid_x, grid_y, grid_x, grid_y);
+
+EXIT_LABEL:
 
   return;
 }
 
+/******************************************************************************/
+/* Function: dt_get_grid_memory_usage                                         */
+/*                                                                            */
+/* Purpose: Report how much memory the points of a grid are using.            */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the grid's storage.             */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to measure.                             */
+/*                                                                            */
+/* Operation: For a row-major or Morton grid this is the size of the element  */
+/*            block and layers. For a chunked grid it is the chunk table plus */
+/*            the default chunk and every chunk that has been allocated, and  */
+/*            the compressed copies of any chunks held compressed. The cost   */
+/*            fields built for searching the grid are added to either.        */
+/******************************************************************************/
+size_t dt_get_grid_memory_usage(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t bytes;
+  int field;
+
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    bytes = (sizeof(DT_GRID_CHUNK *) * (size_t) grid->num_chunks_x *
+                                                (size_t) grid->num_chunks_y) +
+            (sizeof(DT_GRID_CHUNK) * (size_t) (grid->num_allocated_chunks + 1));
+    if (NULL != grid->chunk_store)
+    {
+      bytes += (size_t) grid->chunk_store->compressed_bytes +
+               (sizeof(DT_COMPRESSED_CHUNK) * (size_t) grid->num_chunks_x *
+                                                 (size_t) grid->num_chunks_y);
+    }
+  }
+  else
+  {
+    bytes = ((sizeof(DT_GRID_ELEMENT) + sizeof(Sint16) + 4) *
+                                                            grid->num_points) +
+            (sizeof(Uint32) * (size_t) grid->traversable_words_per_row *
+                                                   (size_t) grid->num_tiles_y);
+  }
+
+  for (field = 0; field < grid->num_cost_fields; field++)
+  {
+    bytes += dt_get_cost_field_memory_usage(grid->cost_fields[field], grid);
+  }
+  for (field = 0; field < grid->num_flow_fields; field++)
+  {
+    bytes += dt_get_flow_field_memory_usage(grid->flow_fields[field], grid);
+  }
+  if (NULL != grid->path_cache)
+  {
+    bytes += dt_get_path_cache_memory_usage(grid->path_cache);
+  }
+  if (NULL != grid->path_scheduler)
+  {
+    bytes += dt_get_path_scheduler_memory_usage(grid->path_scheduler);
+  }
+
+  return(bytes);
+}
+
 /******************************************************************************/
 /* Function: dt_convert_grid_to_screen_pos                                    */
 /*                                                                            */
@@ -277,70 +1062,146 @@ DT_UNIT *dt_retrieve_unit_from_grid(DT_GRID *grid, int grid_x, int grid_y)
   /****************************************************************************/
   /* Retrieve the unit from the map coordinates.                              */
   /****************************************************************************/
-  temp_unit = grid->map_grid[grid_x][grid_y]->unit;
+  temp_unit = dt_get_grid_element(grid, grid_x, grid_y)->unit;
 
   return(temp_unit);
 }
 
 /******************************************************************************/
-/* Function:                                                                  */
+/* Function: dt_set_grid_unit                                                 */
 /*                                                                            */
-/* Purpose:                                                                   */
+/* Purpose: Put a unit on a grid position, or take the unit there off it.     */
 /*                                                                            */
-/* Returns:                                                                   */
+/* Returns: Nothing.                                                          */
 /*                                                                            */
-/* Parameters:                                                                */
+/* Parameters: IN     grid - The grid to update.                              */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*             IN     unit - The unit, or NULL to leave the position empty.   */
 /*                                                                            */
-/* Operation:                                                                 */
+/* Operation: Set the unit of the element and tell the replanners of the grid */
+/*            so that other units plan around it. The cost fields are not     */
+/*            changed, as a unit is not part of the terrain.                  */
 /******************************************************************************/
-int dt_load_grid_from_file(char *filename, DT_GRID *grid)
+void dt_set_grid_unit(DT_GRID *grid, int grid_x, int grid_y, DT_UNIT *unit)
+{
+  dt_get_grid_element_for_update(grid, grid_x, grid_y)->unit = unit;
+  dt_mark_grid_replanners_changed(grid, grid_x, grid_y, grid_x, grid_y);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_load_grid_from_file                                           */
+/*                                                                            */
+/* Purpose: Create a grid from a map file.                                    */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the grid was created.                       */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be opened.            */
+/*          Otherwise the DT_MAP_FILE_RETURN_CODES value describing what was  */
+/*          wrong with the file.                                              */
+/*                                                                            */
+/* Parameters: IN     filename - The map file to load.                        */
+/*             OUT    grid - The new grid. Only set if the map was loaded.    */
+/*                                                                            */
+/* Operation: Read the start of the file. Binary maps are mapped into memory  */
+/*            and any other file is parsed as a text map (see dt_map_file.h). */
+/*            The graphics of the tile types are not loaded. Call             */
+/*            dt_load_grid_tile_graphics once the window system is running to */
+/*            load them.                                                      */
+/******************************************************************************/
+int dt_load_grid_from_file(char *filename, DT_GRID **grid)
 {
   /****************************************************************************/
   /* Local Variables.                                                         */
   /****************************************************************************/
   FILE *map_file;
-  char line[DT_MAX_MAP_LINE_LEN];
-  char *read_line_ret_val;
+  Uint32 magic = 0;
   int ret_val = DT_FILE_OPEN_OK;
   int ret_code = DT_MAP_FILE_LOADED;
 
   /****************************************************************************/
-  /* Attempt to open the file pointed to by the input filename.               */
+  /* Attempt to open the file pointed to by the input filename and read the   */
+  /* value which identifies binary maps.                                      */
   /****************************************************************************/
-  ret_val = dt_open_file(filename, FILE_MODE_READ, &map_file);
+  ret_val = dt_open_file(filename, FILE_MODE_READ_BINARY, &map_file);
   if (DT_FILE_OPEN_OK != ret_val)
   {
     ret_code = DT_MAP_FILE_NOT_FOUND;
     goto EXIT_LABEL;
   }
+  if (1 != fread(&magic, sizeof(magic), 1, map_file))
+  {
+    magic = 0;
+  }
+  dt_close_file(map_file);
 
   /****************************************************************************/
-  /* Load the first line of the file and parse to make sure that information  */
-  /* is present that is required.                                             */
+  /* Load the map in whichever format it is in.                               */
   /****************************************************************************/
-  read_line_ret_val = fgets(line, DT_MAX_MAP_LINE_LEN, map_file);
-  if (NULL == read_line_ret_val)
+  if (DT_MAP_FILE_MAGIC == magic)
   {
-    ret_code = DT_MAP_FILE_NO_INFO_LINE;
-    goto EXIT_LABEL;
+    ret_code = dt_load_binary_map_file(filename, grid);
+  }
+  else
+  {
+    ret_code = dt_load_text_map_file(filename, DT_MAP_TEXT_AUTO_JOBS, grid);
   }
 
-  /****************************************************************************/
-  /* @@@DAT Sort this once there is a function to do this.                    */
-  /****************************************************************************/
-  //dt_parse_map_info_line();
+EXIT_LABEL:
 
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_load_grid_tile_graphics                                       */
+/*                                                                            */
+/* Purpose: Load the graphics of the tile types of a grid loaded from a map   */
+/*          file.                                                             */
+/*                                                                            */
+/* Returns: DT_LOAD_SPRITE_OK if every graphic was loaded, otherwise the      */
+/*          error from the first graphic which could not be loaded.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid whose tile types need graphics.         */
+/*                                                                            */
+/* Operation: Create a graphic for every tile type which names one and does   */
+/*            not yet have one.                                               */
+/******************************************************************************/
+int dt_load_grid_tile_graphics(DT_GRID *grid)
+{
   /****************************************************************************/
-  /* Once the first line has been parsed read each of the following lines     */
-  /* extracting the map information into the grid object.                     */
+  /* Local Variables.                                                         */
   /****************************************************************************/
-  while (NULL != fgets(line, DT_MAX_MAP_LINE_LEN, map_file))
-  {
+  DT_BACKGROUND_TILE *tile;
+  DT_ENTITY_GRAPHIC *graphic;
+  int ret_val;
+  int ret_code = DT_LOAD_SPRITE_OK;
+  int tile_type;
 
+  for (tile_type = 0; tile_type < grid->num_tile_types; tile_type++)
+  {
+    tile = grid->tile_types[tile_type];
+    if ((NULL != tile) && (NULL != tile->graphic_name) &&
+        (NULL == tile->graphic))
+    {
+      ret_val = dt_create_entity_graphic(tile->graphic_name, &graphic);
+      if (DT_LOAD_SPRITE_OK == ret_val)
+      {
+        dt_assign_entity_graphic_to_background_tile(graphic, tile);
+      }
+      else
+      {
+        /**********************************************************************/
+        /* The sprite was never set so only the graphic object is freed.      */
+        /**********************************************************************/
+        dt_free(graphic);
+        if (DT_LOAD_SPRITE_OK == ret_code)
+        {
+          ret_code = ret_val;
+        }
+      }
+    }
   }
 
-
-EXIT_LABEL:
-
   return(ret_code);
 }
@@ -4,11 +4,81 @@
 #define DT_COORD_ON_GRID 0
 #define DT_COORD_OFF_GRID 1
 
+/******************************************************************************/
+/* Group: DT_MAP_FILE_RETURN_CODES                                            */
+/*                                                                            */
+/* Return codes for loading and writing map files.                            */
+/*                                                                            */
+/* DT_MAP_FILE_LOADED - The map was loaded or written.                        */
+/* DT_MAP_FILE_NO_INFO_LINE - A text map has no info line.                    */
+/* DT_MAP_FILE_NOT_FOUND - The file could not be opened.                      */
+/* DT_MAP_FILE_BAD_INFO_LINE - The info line of a text map is not valid.      */
+/* DT_MAP_FILE_BAD_TILE_LINE - A tile line of a text map is not valid or      */
+/*                             there are too many of them.                    */
+/* DT_MAP_FILE_BAD_POINT - A point of a text map is not valid or refers to a  */
+/*                         tile type which does not exist.                    */
+/* DT_MAP_FILE_TOO_SHORT - A text map ends before every point is given.       */
+/* DT_MAP_FILE_BAD_HEADER - The header of a binary map is not valid or does   */
+/*                          not match the size of the file.                   */
+/* DT_MAP_FILE_MAP_FAILED - A binary map could not be mapped into memory.     */
+/* DT_MAP_FILE_WRITE_FAILED - A map file could not be written.                */
+/* DT_MAP_FILE_BAD_CHUNK - The chunk table entry of a chunked binary map is   */
+/*                         not valid.                                         */
+/* DT_MAP_FILE_NOT_CHUNKED - A map to be streamed is not a chunked binary     */
+/*                           map.                                             */
+/******************************************************************************/
 #define DT_MAP_FILE_LOADED 0
 #define DT_MAP_FILE_NO_INFO_LINE 1
 #define DT_MAP_FILE_NOT_FOUND 2
+#define DT_MAP_FILE_BAD_INFO_LINE 3
+#define DT_MAP_FILE_BAD_TILE_LINE 4
+#define DT_MAP_FILE_BAD_POINT 5
+#define DT_MAP_FILE_TOO_SHORT 6
+#define DT_MAP_FILE_BAD_HEADER 7
+#define DT_MAP_FILE_MAP_FAILED 8
+#define DT_MAP_FILE_WRITE_FAILED 9
+#define DT_MAP_FILE_BAD_CHUNK 10
+#define DT_MAP_FILE_NOT_CHUNKED 11
+
+/******************************************************************************/
+/* Group: DT_GRID_STORAGE_TYPES                                               */
+/*                                                                            */
+/* The ways in which the points of a grid can be stored. This is chosen when  */
+/* the grid is created.                                                       */
+/*                                                                            */
+/* DT_GRID_STORAGE_ROW_MAJOR - Every point is allocated up front in one block */
+/*                             with the points of each row adjacent.          */
+/* DT_GRID_STORAGE_CHUNKED - The grid is split into square chunks which are   */
+/*                           only allocated once something other than the     */
+/*                           default (an empty traversable plain) is written  */
+/*                           into them. Untouched chunks all share a single   */
+/*                           default chunk.                                   */
+/* DT_GRID_STORAGE_MORTON - As row-major but the points are ordered along a   */
+/*                          Z-order (Morton) curve so that points which are   */
+/*                          close on the grid are close in memory in both     */
+/*                          directions. Grids up to 65536 x 65536 are         */
+/*                          supported and the arrays cover the Morton code of */
+/*                          the bottom right point, so this suits square      */
+/*                          maps far better than long thin ones.              */
+/******************************************************************************/
+#define DT_GRID_STORAGE_ROW_MAJOR 0
+#define DT_GRID_STORAGE_CHUNKED 1
+#define DT_GRID_STORAGE_MORTON 2
+
+/******************************************************************************/
+/* Masks selecting the x (even) and y (odd) bits of a Morton code.            */
+/******************************************************************************/
+#define DT_MORTON_X_BITS 0x55555555u
+#define DT_MORTON_Y_BITS 0xAAAAAAAAu
 
-#define DT_MAX_MAP_LINE_LEN 5000
+/******************************************************************************/
+/* The width and height of a chunk in a chunked grid. The width matches the   */
+/* number of bits in a traversable word so each chunk row is a single word.   */
+/******************************************************************************/
+#define DT_GRID_CHUNK_SHIFT 5
+#define DT_GRID_CHUNK_SIZE (1 << DT_GRID_CHUNK_SHIFT)
+#define DT_GRID_CHUNK_MASK (DT_GRID_CHUNK_SIZE - 1)
+#define DT_GRID_CHUNK_POINTS (DT_GRID_CHUNK_SIZE * DT_GRID_CHUNK_SIZE)
 
 /******************************************************************************/
 /* DT_GRID_ELEMENT:                                                           */
@@ -17,24 +87,148 @@
 /* following fields.                                                          */
 /*                                                                            */
 /* unit - A single unit pointer referring to the unit at that grid position.  */
-/* tile - A background tile referring to the background at that position.     */
+/*                                                                            */
+/* The background at each point is not held on the element. It is the         */
+/* tile_type layer of the grid, an index into the grid's tile type table.     */
 /******************************************************************************/
 typedef struct dt_grid_element
 {
   struct dt_unit *unit;
-  struct dt_background_tile *tile;
-  bool traversable;
 } DT_GRID_ELEMENT;
 
+/******************************************************************************/
+/* The size of the tile type table on a grid. Tile types are stored in a      */
+/* single byte per point so there can be no more than 256 of them.            */
+/*                                                                            */
+/* DT_TILE_TYPE_NONE is the type of every point which has not had a tile      */
+/* placed on it. It has no tile, so nothing is drawn, and its terrain is an   */
+/* empty plain.                                                               */
+/******************************************************************************/
+#define DT_MAX_TILE_TYPES 256
+#define DT_TILE_TYPE_NONE 0
+
+/******************************************************************************/
+/* The number of cost fields a grid keeps for path searches. Each unit class  */
+/* and speed searched for needs its own. When there are more than this the    */
+/* oldest is dropped and built again if it is needed later.                   */
+/******************************************************************************/
+#define DT_GRID_MAX_COST_FIELDS 8
+
+/******************************************************************************/
+/* The number of flow fields a grid keeps. Each goal, unit class and speed    */
+/* needs its own. When there are more than this the least recently used is    */
+/* dropped and built again if it is needed later.                             */
+/******************************************************************************/
+#define DT_GRID_MAX_FLOW_FIELDS 8
+
+/******************************************************************************/
+/* Return codes for dt_add_tile_type_to_grid.                                 */
+/******************************************************************************/
+#define DT_TILE_TYPE_ADDED 0
+#define DT_TILE_TYPE_TABLE_FULL 1
+
+/******************************************************************************/
+/* The traversable layer is a bitmap packed into 32 bit words. Each row of    */
+/* the grid starts on a new word so that a row can be scanned a word at a     */
+/* time.                                                                      */
+/******************************************************************************/
+#define DT_GRID_BITS_PER_WORD 32
+#define DT_GRID_WORD_SHIFT 5
+#define DT_GRID_WORD_MASK 0x1F
+
+/******************************************************************************/
+/* DT_GRID_CHUNK:                                                             */
+/*                                                                            */
+/* A square section of a chunked grid. It holds the same information as the   */
+/* element block and layers of a row-major grid but only for the points in    */
+/* the chunk, which are stored row by row.                                    */
+/*                                                                            */
+/* elements - The grid element for each point in the chunk.                   */
+/* tile_type - The index into the tile type table of the tile at each point.  */
+/* traversable - One word per chunk row with a bit set for each traversable   */
+/*               point.                                                       */
+/* terrain_type - The DT_GROUND_TYPES value for each point.                   */
+/* elevation - The elevation of each point.                                   */
+/* water_depth - The water depth of each point.                               */
+/* movement_modifier - The movement modifier of each point.                   */
+/******************************************************************************/
+typedef struct dt_grid_chunk
+{
+  struct dt_grid_element elements[DT_GRID_CHUNK_POINTS];
+  Uint32 traversable[DT_GRID_CHUNK_SIZE];
+  Sint16 elevation[DT_GRID_CHUNK_POINTS];
+  unsigned char tile_type[DT_GRID_CHUNK_POINTS];
+  unsigned char terrain_type[DT_GRID_CHUNK_POINTS];
+  unsigned char water_depth[DT_GRID_CHUNK_POINTS];
+  unsigned char movement_modifier[DT_GRID_CHUNK_POINTS];
+} DT_GRID_CHUNK;
+
 /******************************************************************************/
 /* DT_GRID:                                                                   */
 /*                                                                            */
 /* A DT_GRID object refers to the underlying grid structure that tiles are    */
 /* placed on. This object contains information about the size of those tiles. */
 /*                                                                            */
-/* map_grid - A two dimensional array which contains an element for each      */
-/*            point on the grid. It is used to store information about what   */
-/*            is at each location.                                            */
+/* storage - How the points are stored. One of DT_GRID_STORAGE_TYPES.         */
+/* map_grid - A single contiguous block containing an element for each point  */
+/*            on the grid, stored row by row (row-major). It is used to store */
+/*            information about what is at each location and should be        */
+/*            accessed through dt_get_grid_element.                           */
+/* tile_type - One byte per grid point holding the index into tile_types of   */
+/*             the tile at that point.                                        */
+/* traversable - Bitmap with one bit per grid point which is set if units may */
+/*               enter that point. Each row is traversable_words_per_row      */
+/*               words long.                                                  */
+/* terrain_type - One byte per grid point holding the DT_GROUND_TYPES value   */
+/*                of the tile type at that point.                             */
+/* elevation - The elevation of each grid point.                              */
+/* water_depth - The water depth of each grid point.                          */
+/* movement_modifier - The movement modifier of each grid point.              */
+/*    The layers above are indexed in the same order as map_grid (see         */
+/*    dt_get_grid_index). Placing a tile type on a point copies its terrain   */
+/*    type and base values into the layers, after which the elevation, water  */
+/*    depth and movement modifier may be overridden for that point alone.     */
+/*    They let scans over the map read only the bytes they need. The          */
+/*    traversable bitmap is always stored row by row, even on a Morton grid,  */
+/*    so that rows can be scanned a word at a time.                           */
+/* num_points - The number of entries in map_grid and each byte layer.        */
+/* traversable_words_per_row - The number of words in a traversable row.      */
+/*    The element block and layers above are only used by row-major grids and */
+/*    are NULL for chunked grids.                                             */
+/* chunks - For chunked grids, a table of num_chunks_x * num_chunks_y chunk   */
+/*          pointers stored row by row. Chunks which have never been written  */
+/*          to point at default_chunk. Chunks held compressed in chunk_store  */
+/*          are NULL until they are next accessed.                            */
+/* default_chunk - The chunk shared by every untouched part of the grid. It   */
+/*                 must never be written to.                                  */
+/* num_chunks_x - The number of chunks across the grid.                       */
+/* num_chunks_y - The number of chunks down the grid.                         */
+/* num_allocated_chunks - The number of chunks which have been allocated.     */
+/* mapped_file - For grids loaded from a binary map, the mapped file that the */
+/*               layers point into. The element block is then allocated on    */
+/*               its own. NULL for all other grids.                           */
+/* streamer - For chunked grids streamed from a chunked binary map, the       */
+/*            streamer which loads and evicts their chunks. NULL for all      */
+/*            other grids.                                                    */
+/* chunk_store - For chunked grids which keep their chunks compressed in      */
+/*               memory, the compressed copies. NULL for all other grids.     */
+/* tile_types - The tile type table. Each distinct background is held here    */
+/*              once and owned by the grid. Entry DT_TILE_TYPE_NONE is NULL.  */
+/* num_tile_types - The number of entries used in tile_types.                 */
+/* cost_fields - The cost fields built for path searches over the grid, the   */
+/*               oldest first. See DT_COST_FIELD.                             */
+/* num_cost_fields - The number of entries used in cost_fields.               */
+/* landmark_serial - The serial number given to the landmarks built last for  */
+/*                   any of the cost fields. See DT_LANDMARKS.                */
+/* flow_fields - The flow fields built for moving groups of units over the    */
+/*               grid, the least recently used first. See DT_FLOW_FIELD.      */
+/* num_flow_fields - The number of entries used in flow_fields.               */
+/* path_cache - The paths found over the grid most recently, or NULL until    */
+/*              the first is asked for. See DT_PATH_CACHE.                    */
+/* replanners - The first of the replanners told of changes to the grid. See  */
+/*              DT_REPLANNER.                                                 */
+/* path_scheduler - The searches units of the grid are waiting for, or NULL   */
+/*                  until the first is asked for. See DT_PATH_SCHEDULER.      */
 /* square_width - The width of a single tile in the grid.                     */
 /* square_height - The height of a single tile in the grid.                   */
 /* num_tiles_x - The number of tiles in the x direction on the grid.          */
@@ -42,9 +236,542 @@ typedef struct dt_grid_element
 /******************************************************************************/
 typedef struct dt_grid
 {
-  struct dt_grid_element ***map_grid;
+  int storage;
+  struct dt_grid_element *map_grid;
+  unsigned char *tile_type;
+  Uint32 *traversable;
+  unsigned char *terrain_type;
+  Sint16 *elevation;
+  unsigned char *water_depth;
+  unsigned char *movement_modifier;
+  size_t num_points;
+  int traversable_words_per_row;
+  struct dt_grid_chunk **chunks;
+  struct dt_grid_chunk *default_chunk;
+  int num_chunks_x;
+  int num_chunks_y;
+  long num_allocated_chunks;
+  struct dt_mapped_file *mapped_file;
+  struct dt_chunk_streamer *streamer;
+  struct dt_chunk_store *chunk_store;
+  struct dt_background_tile *tile_types[DT_MAX_TILE_TYPES];
+  int num_tile_types;
+  struct dt_cost_field *cost_fields[DT_GRID_MAX_COST_FIELDS];
+  int num_cost_fields;
+  Uint32 landmark_serial;
+  struct dt_flow_field *flow_fields[DT_GRID_MAX_FLOW_FIELDS];
+  int num_flow_fields;
+  struct dt_path_cache *path_cache;
+  struct dt_replanner *replanners;
+  struct dt_path_scheduler *path_scheduler;
   int square_width;
   int square_height;
   int num_tiles_x;
   int num_tiles_y;
 } DT_GRID;
+
+/******************************************************************************/
+/* Function: dt_morton_encode                                                 */
+/*                                                                            */
+/* Purpose: Convert grid coordinates into a Morton (Z-order) code.            */
+/*                                                                            */
+/* Returns: The code, with the bits of x in the even bit positions and the    */
+/*          bits of y in the odd positions.                                   */
+/*                                                                            */
+/* Parameters: IN     grid_x - The x coordinate. Must be below 65536.         */
+/*             IN     grid_y - The y coordinate. Must be below 65536.         */
+/*                                                                            */
+/* Operation: Spread the bits of each coordinate apart with a fixed sequence  */
+/*            of shifts and masks and then interleave them.                   */
+/******************************************************************************/
+static inline Uint32 dt_morton_spread_bits(Uint32 value)
+{
+  value &= 0x0000FFFFu;
+  value = (value | (value << 8)) & 0x00FF00FFu;
+  value = (value | (value << 4)) & 0x0F0F0F0Fu;
+  value = (value | (value << 2)) & 0x33333333u;
+  value = (value | (value << 1)) & 0x55555555u;
+
+  return(value);
+}
+
+static inline Uint32 dt_morton_encode(int grid_x, int grid_y)
+{
+  return(dt_morton_spread_bits((Uint32) grid_x) |
+         (dt_morton_spread_bits((Uint32) grid_y) << 1));
+}
+
+/******************************************************************************/
+/* Function: dt_morton_decode                                                 */
+/*                                                                            */
+/* Purpose: Convert a Morton (Z-order) code back into grid coordinates.       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     code - The Morton code.                                 */
+/*             OUT    grid_x - The x coordinate.                              */
+/*             OUT    grid_y - The y coordinate.                              */
+/*                                                                            */
+/* Operation: The reverse of dt_morton_encode.                                */
+/******************************************************************************/
+static inline Uint32 dt_morton_compact_bits(Uint32 value)
+{
+  value &= 0x55555555u;
+  value = (value | (value >> 1)) & 0x33333333u;
+  value = (value | (value >> 2)) & 0x0F0F0F0Fu;
+  value = (value | (value >> 4)) & 0x00FF00FFu;
+  value = (value | (value >> 8)) & 0x0000FFFFu;
+
+  return(value);
+}
+
+static inline void dt_morton_decode(Uint32 code, int *grid_x, int *grid_y)
+{
+  (*grid_x) = (int) dt_morton_compact_bits(code);
+  (*grid_y) = (int) dt_morton_compact_bits(code >> 1);
+
+  return;
+}
+
+/******************************************************************************/
+/* Functions: dt_morton_increment_x, dt_morton_increment_y                    */
+/*                                                                            */
+/* Purpose: Step a Morton code one point right or one point down without      */
+/*          decoding it.                                                      */
+/*                                                                            */
+/* Returns: The code of the neighbouring point.                               */
+/*                                                                            */
+/* Parameters: IN     code - The Morton code of the current point.            */
+/*                                                                            */
+/* Operation: Fill the bits of the other coordinate with ones so that the     */
+/*            carry from the addition passes straight through them, then put  */
+/*            the bits of the other coordinate back.                          */
+/******************************************************************************/
+static inline Uint32 dt_morton_increment_x(Uint32 code)
+{
+  return((((code | DT_MORTON_Y_BITS) + 1) & DT_MORTON_X_BITS) |
+                                                     (code & DT_MORTON_Y_BITS));
+}
+
+static inline Uint32 dt_morton_increment_y(Uint32 code)
+{
+  return((((code | DT_MORTON_X_BITS) + 2) & DT_MORTON_Y_BITS) |
+                                                     (code & DT_MORTON_X_BITS));
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_index                                                */
+/*                                                                            */
+/* Purpose: Convert a grid position into an index into the per point arrays   */
+/*          of a row-major or Morton grid.                                    */
+/*                                                                            */
+/* Returns: The index of the grid point in map_grid and the byte layers.      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid containing the point.                   */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: On a row-major grid the point (x, y) lives at index             */
+/*            y * num_tiles_x + x and on a Morton grid it lives at the Morton */
+/*            code of (x, y). The caller is responsible for checking that the */
+/*            coordinates lie on the grid and that the grid is not chunked.   */
+/******************************************************************************/
+static inline size_t dt_get_grid_index(DT_GRID *grid, int grid_x, int grid_y)
+{
+  if (DT_GRID_STORAGE_MORTON == grid->storage)
+  {
+    return(dt_morton_encode(grid_x, grid_y));
+  }
+
+  return(((size_t) grid_y * grid->num_tiles_x) + grid_x);
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_chunk                                                */
+/*                                                                            */
+/* Purpose: Find the chunk of a chunked grid that holds a grid position.      */
+/*                                                                            */
+/* Returns: A pointer to the chunk. This is the shared default chunk if the   */
+/*          chunk has never been written to, so must only be read from.       */
+/*                                                                            */
+/* Parameters: IN     grid - The chunked grid containing the point.           */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Look the chunk up in the chunk table. A NULL entry is a chunk   */
+/*            held compressed, which is inflated first. The prototype is      */
+/*            needed here as dt_prototypes.h is included after this file.     */
+/******************************************************************************/
+DT_GRID_CHUNK *dt_inflate_grid_chunk(DT_GRID *, size_t);
+
+static inline DT_GRID_CHUNK *dt_get_grid_chunk(DT_GRID *grid,
+                                               int grid_x,
+                                               int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t index = ((size_t) (grid_y >> DT_GRID_CHUNK_SHIFT) *
+                                                          grid->num_chunks_x) +
+                 (grid_x >> DT_GRID_CHUNK_SHIFT);
+
+  if (NULL == grid->chunks[index])
+  {
+    return(dt_inflate_grid_chunk(grid, index));
+  }
+
+  return(grid->chunks[index]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_chunk_index                                          */
+/*                                                                            */
+/* Purpose: Convert a grid position into an index into the arrays of the      */
+/*          chunk that holds it.                                              */
+/*                                                                            */
+/* Returns: The index of the point within its chunk.                          */
+/*                                                                            */
+/* Parameters: IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Points within a chunk are stored row by row.                    */
+/******************************************************************************/
+static inline int dt_get_grid_chunk_index(int grid_x, int grid_y)
+{
+  return(((grid_y & DT_GRID_CHUNK_MASK) << DT_GRID_CHUNK_SHIFT) +
+                                                 (grid_x & DT_GRID_CHUNK_MASK));
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_element                                              */
+/*                                                                            */
+/* Purpose: Retrieve the grid element at a given grid position for reading.   */
+/*                                                                            */
+/* Returns: A pointer to the element. For a chunked grid this may be in the   */
+/*          shared default chunk, so use dt_get_grid_element_for_update if    */
+/*          the element is to be changed.                                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid containing the element.                 */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Look the element up by its grid index or in its chunk.          */
+/******************************************************************************/
+static inline DT_GRID_ELEMENT *dt_get_grid_element(DT_GRID *grid,
+                                                   int grid_x,
+                                                   int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(&(dt_get_grid_chunk(grid, grid_x, grid_y)->
+                        elements[dt_get_grid_chunk_index(grid_x, grid_y)]));
+  }
+
+  return(&(grid->map_grid[dt_get_grid_index(grid, grid_x, grid_y)]));
+}
+
+/******************************************************************************/
+/* Function: dt_is_grid_traversable                                           */
+/*                                                                            */
+/* Purpose: Test whether units may enter a grid position.                     */
+/*                                                                            */
+/* Returns: true if the traversable bit for the position is set.              */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to test.                                */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Find the word for the position in its row of the bitmap and     */
+/*            test the bit for the column.                                    */
+/******************************************************************************/
+static inline bool dt_is_grid_traversable(DT_GRID *grid,
+                                          int grid_x,
+                                          int grid_y)
+{
+  Uint32 word;
+
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    word = dt_get_grid_chunk(grid, grid_x, grid_y)->
+                                   traversable[grid_y & DT_GRID_CHUNK_MASK];
+  }
+  else
+  {
+    word = grid->traversable[((size_t) grid_y *
+                              grid->traversable_words_per_row) +
+                             (grid_x >> DT_GRID_WORD_SHIFT)];
+  }
+
+  return(0 != (word & (1u << (grid_x & DT_GRID_WORD_MASK))));
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_tile_type                                            */
+/*                                                                            */
+/* Purpose: Find the tile type at a grid position.                            */
+/*                                                                            */
+/* Returns: The index into the grid's tile type table.                        */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to read.                                */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Read the tile type layer of the grid or of the chunk holding    */
+/*            the point.                                                      */
+/******************************************************************************/
+static inline int dt_get_grid_tile_type(DT_GRID *grid, int grid_x, int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(dt_get_grid_chunk(grid, grid_x, grid_y)->
+                       tile_type[dt_get_grid_chunk_index(grid_x, grid_y)]);
+  }
+
+  return(grid->tile_type[dt_get_grid_index(grid, grid_x, grid_y)]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_tile                                                 */
+/*                                                                            */
+/* Purpose: Find the background tile at a grid position.                      */
+/*                                                                            */
+/* Returns: The entry in the tile type table for the point. This is NULL if   */
+/*          no tile has been placed there.                                    */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to read.                                */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Look the tile type of the point up in the tile type table.      */
+/******************************************************************************/
+static inline struct dt_background_tile *dt_get_grid_tile(DT_GRID *grid,
+                                                          int grid_x,
+                                                          int grid_y)
+{
+  return(grid->tile_types[dt_get_grid_tile_type(grid, grid_x, grid_y)]);
+}
+
+/******************************************************************************/
+/* Functions: dt_get_grid_terrain_type, dt_get_grid_elevation,                */
+/*            dt_get_grid_water_depth, dt_get_grid_movement_modifier          */
+/*                                                                            */
+/* Purpose: Read a single terrain layer at a grid position.                   */
+/*                                                                            */
+/* Returns: The value of the layer at that position.                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to read.                                */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Read the layer of the grid or of the chunk holding the point.   */
+/******************************************************************************/
+static inline int dt_get_grid_terrain_type(DT_GRID *grid,
+                                           int grid_x,
+                                           int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(dt_get_grid_chunk(grid, grid_x, grid_y)->
+                    terrain_type[dt_get_grid_chunk_index(grid_x, grid_y)]);
+  }
+
+  return(grid->terrain_type[dt_get_grid_index(grid, grid_x, grid_y)]);
+}
+
+static inline int dt_get_grid_elevation(DT_GRID *grid, int grid_x, int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(dt_get_grid_chunk(grid, grid_x, grid_y)->
+                       elevation[dt_get_grid_chunk_index(grid_x, grid_y)]);
+  }
+
+  return(grid->elevation[dt_get_grid_index(grid, grid_x, grid_y)]);
+}
+
+static inline int dt_get_grid_water_depth(DT_GRID *grid,
+                                          int grid_x,
+                                          int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(dt_get_grid_chunk(grid, grid_x, grid_y)->
+                     water_depth[dt_get_grid_chunk_index(grid_x, grid_y)]);
+  }
+
+  return(grid->water_depth[dt_get_grid_index(grid, grid_x, grid_y)]);
+}
+
+static inline int dt_get_grid_movement_modifier(DT_GRID *grid,
+                                                int grid_x,
+                                                int grid_y)
+{
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    return(dt_get_grid_chunk(grid, grid_x, grid_y)->
+               movement_modifier[dt_get_grid_chunk_index(grid_x, grid_y)]);
+  }
+
+  return(grid->movement_modifier[dt_get_grid_index(grid, grid_x, grid_y)]);
+}
+
+/******************************************************************************/
+/* DT_GRID_NEIGHBOUR_ITERATOR:                                                */
+/*                                                                            */
+/* Walks the points in the square of a given radius around a centre point,    */
+/* row by row, skipping the centre and any points off the grid. Use           */
+/* dt_init_grid_neighbour_iterator and then call dt_next_grid_neighbour until */
+/* it returns false.                                                          */
+/*                                                                            */
+/* grid - The grid being walked.                                              */
+/* centre_x - The x coordinate of the centre point.                           */
+/* centre_y - The y coordinate of the centre point.                           */
+/* min_x - The leftmost column of the square which lies on the grid.          */
+/* max_x - The rightmost column of the square which lies on the grid.         */
+/* max_y - The bottom row of the square which lies on the grid.               */
+/* next_x - The column of the next point to be visited.                       */
+/* next_y - The row of the next point to be visited.                          */
+/* next_index - The grid index of the next point to be visited.               */
+/* row_index - The grid index of the first point of the current row.          */
+/* x - The column of the current neighbour.                                   */
+/* y - The row of the current neighbour.                                      */
+/* index - The grid index of the current neighbour. This is only set for      */
+/*         row-major and Morton grids.                                        */
+/******************************************************************************/
+typedef struct dt_grid_neighbour_iterator
+{
+  DT_GRID *grid;
+  int centre_x;
+  int centre_y;
+  int min_x;
+  int max_x;
+  int max_y;
+  int next_x;
+  int next_y;
+  size_t next_index;
+  size_t row_index;
+  int x;
+  int y;
+  size_t index;
+} DT_GRID_NEIGHBOUR_ITERATOR;
+
+/******************************************************************************/
+/* Function: dt_step_grid_index                                               */
+/*                                                                            */
+/* Purpose: Move a grid index one point right or one point down.              */
+/*                                                                            */
+/* Returns: The index of the neighbouring point.                              */
+/*                                                                            */
+/* Parameters: IN     grid - The grid the index belongs to.                   */
+/*             IN     index - The index of the current point.                 */
+/*             IN     down - true to step down a row, false to step right.    */
+/*                                                                            */
+/* Operation: On a Morton grid add one to the x or y bits of the code. On a   */
+/*            row-major grid add one or a whole row. Chunked grids have no    */
+/*            grid index so zero is returned.                                 */
+/******************************************************************************/
+static inline size_t dt_step_grid_index(DT_GRID *grid, size_t index, bool down)
+{
+  if (DT_GRID_STORAGE_MORTON == grid->storage)
+  {
+    return(down ? dt_morton_increment_y((Uint32) index) :
+                  dt_morton_increment_x((Uint32) index));
+  }
+  else if (DT_GRID_STORAGE_ROW_MAJOR == grid->storage)
+  {
+    return(down ? (index + grid->num_tiles_x) : (index + 1));
+  }
+
+  return(0);
+}
+
+/******************************************************************************/
+/* Function: dt_init_grid_neighbour_iterator                                  */
+/*                                                                            */
+/* Purpose: Prepare an iterator to walk the neighbours of a point.            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: OUT    iterator - The iterator to be set up.                   */
+/*             IN     grid - The grid to walk.                                */
+/*             IN     grid_x - The x coordinate of the centre point.          */
+/*             IN     grid_y - The y coordinate of the centre point.          */
+/*             IN     radius - How far from the centre to go. A radius of 1   */
+/*                             gives the 8 surrounding points.                */
+/*                                                                            */
+/* Operation: Clip the square around the point to the grid and work out the   */
+/*            grid index of its top left point.                               */
+/******************************************************************************/
+static inline void dt_init_grid_neighbour_iterator(
+                                         DT_GRID_NEIGHBOUR_ITERATOR *iterator,
+                                         DT_GRID *grid,
+                                         int grid_x,
+                                         int grid_y,
+                                         int radius)
+{
+  iterator->grid = grid;
+  iterator->centre_x = grid_x;
+  iterator->centre_y = grid_y;
+  iterator->min_x = MAX(grid_x - radius, 0);
+  iterator->max_x = MIN(grid_x + radius, grid->num_tiles_x - 1);
+  iterator->max_y = MIN(grid_y + radius, grid->num_tiles_y - 1);
+  iterator->next_x = iterator->min_x;
+  iterator->next_y = MAX(grid_y - radius, 0);
+  iterator->row_index = 0;
+  if (DT_GRID_STORAGE_CHUNKED != grid->storage)
+  {
+    iterator->row_index = dt_get_grid_index(grid,
+                                            iterator->min_x,
+                                            iterator->next_y);
+  }
+  iterator->next_index = iterator->row_index;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_next_grid_neighbour                                           */
+/*                                                                            */
+/* Purpose: Move an iterator on to the next neighbour.                        */
+/*                                                                            */
+/* Returns: true if x, y and index now describe a neighbour, false if every   */
+/*          neighbour has been visited.                                       */
+/*                                                                            */
+/* Parameters: IN/OUT iterator - The iterator to advance.                     */
+/*                                                                            */
+/* Operation: Step along the current row, moving down to the start of the     */
+/*            next row at the end of each one. Indices are stepped rather     */
+/*            than recalculated so no Morton code is encoded in the loop.     */
+/******************************************************************************/
+static inline bool dt_next_grid_neighbour(DT_GRID_NEIGHBOUR_ITERATOR *iterator)
+{
+  while (iterator->next_y <= iterator->max_y)
+  {
+    if (iterator->next_x > iterator->max_x)
+    {
+      (iterator->next_y)++;
+      iterator->next_x = iterator->min_x;
+      iterator->row_index = dt_step_grid_index(iterator->grid,
+                                               iterator->row_index,
+                                               true);
+      iterator->next_index = iterator->row_index;
+      continue;
+    }
+
+    iterator->x = iterator->next_x;
+    iterator->y = iterator->next_y;
+    iterator->index = iterator->next_index;
+    (iterator->next_x)++;
+    iterator->next_index = dt_step_grid_index(iterator->grid,
+                                              iterator->next_index,
+                                              false);
+
+    if ((iterator->x != iterator->centre_x) ||
+        (iterator->y != iterator->centre_y))
+    {
+      return(true);
+    }
+  }
+
+  return(false);
+}
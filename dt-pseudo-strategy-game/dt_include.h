@@ -10,9 +10,14 @@
 /* System headers.                                                            */
 /******************************************************************************/
 #include <stdlib.h>
+#include <stddef.h>
 #include <windows.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <zlib.h>
 #include <sdl/SDL.h>
 #include <sdl/SDL_image.h>
 //#include <sdl/sdl_opengl.h>
@@ -20,16 +25,32 @@
 /******************************************************************************/
 /* User headers.                                                              */
 /******************************************************************************/
+#include "dt_macros.h"
 #include "dt_globals.h"
 #include "dt_unit.h"
 #include "dt_errors.h"
 #include "dt_unit_list.h"
 #include "dt_window_handler.h"
 #include "dt_grid.h"
+#include "dt_map_file.h"
+#include "dt_chunk_compression.h"
+#include "dt_map_generator.h"
 #include "dt_entity_graphic.h"
 #include "dt_background_tile.h"
-#include "dt_prototypes.h"
+#include "dt_worker_pool.h"
+#include "dt_chunk_streamer.h"
+#include "dt_landmarks.h"
 #include "dt_pathing.h"
-#include "dt_macros.h"
+#include "dt_path_hierarchy.h"
+#include "dt_region_map.h"
+#include "dt_flow_field.h"
+#include "dt_path_cache.h"
+#include "dt_replanner.h"
+#include "dt_path_service.h"
+#include "dt_path_scheduler.h"
+#include "dt_cooperative_path.h"
+#include "dt_movement_range.h"
+#include "dt_prototypes.h"
 #include "dt_basic_list.h"
 #include "dt_file_handler.h"
+#include "dt_benchmark.h"
@@ -16,6 +16,9 @@
 /* Operation: Convert the mouse coordinates on the screen into grid           */
 /*            coordinates.                                                    */
 /*            Retrieve any unit which is placed at the grid coordinates.      */
+/*            Selecting a unit highlights every point it can reach this turn, */
+/*            and clicking anywhere else clears the highlight. A right click  */
+/*            asks for a path for the unit selected to the point clicked.     */
 /******************************************************************************/
 int dt_handle_mouse_click(DT_GRID *grid, DT_SCREEN *screen, SDL_Event *event)
 {
@@ -23,6 +26,7 @@ int dt_handle_mouse_click(DT_GRID *grid, DT_SCREEN *screen, SDL_Event *event)
   /* Local Variables.                                                         */
   /****************************************************************************/
   DT_UNIT *unit;
+  DT_MOVEMENT_RANGE *range = screen->movement_range;
   int x_pos;
   int y_pos;
   int grid_x;
@@ -51,6 +55,53 @@ int dt_handle_mouse_click(DT_GRID *grid, DT_SCREEN *screen, SDL_Event *event)
     /**************************************************************************/
     unit = dt_retrieve_unit_from_grid(grid, grid_x, grid_y);
   }
+  else
+  {
+    unit = NULL;
+  }
+
+  /****************************************************************************/
+  /* A right click sends the unit selected, if any, to the point clicked. Its */
+  /* path is found over the coming frames.                                    */
+  /****************************************************************************/
+  if (SDL_BUTTON_RIGHT == event->button.button)
+  {
+    unit = NULL;
+    if ((DT_COORD_ON_GRID == ret_val) && (0 < range->num_points))
+    {
+      unit = dt_retrieve_unit_from_grid(grid, range->origin_x, range->origin_y);
+    }
+    if (NULL != unit)
+    {
+      dt_request_unit_path(dt_get_grid_path_scheduler(grid),
+                           unit,
+                           range->origin_x,
+                           range->origin_y,
+                           grid_x,
+                           grid_y);
+    }
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Find the movement range of the unit selected, if any, and redraw the     */
+  /* screen to show it.                                                       */
+  /****************************************************************************/
+  if (NULL != unit)
+  {
+    ret_val = dt_find_movement_range(grid,
+                                     unit,
+                                     grid_x,
+                                     grid_y,
+                                     screen->movement_range);
+  }
+  else
+  {
+    dt_clear_movement_range(screen->movement_range);
+  }
+  ret_val = dt_redraw_screen(grid, screen);
+
+EXIT_LABEL:
 
   return(0);
 }
@@ -127,6 +178,10 @@ int dt_handle_key_press(DT_GRID *grid, DT_SCREEN *screen, SDL_Event *event)
   /****************************************************************************/
   if (redraw_screen)
   {
+    if (NULL != grid->streamer)
+    {
+      dt_update_chunk_streamer(grid, screen);
+    }
     ret_val = dt_redraw_screen(grid, screen);
   }
 
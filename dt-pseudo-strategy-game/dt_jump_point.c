@@ -0,0 +1,606 @@
+/******************************************************************************/
+/* File: dt_jump_point.c                                                      */
+/*                                                                            */
+/* Purpose: Jump point search, which finds the same paths as dt_find_path but */
+/*          skips across open ground of uniform cost rather than expanding    */
+/*          every point of it.                                                */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_find_jump_point_path                                          */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a unit between two points with jump    */
+/*          point search where the terrain costs are uniform and A* where     */
+/*          they vary.                                                        */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. This must be a  */
+/*                             plain search.                                  */
+/*             IN     unit - The unit which is to move. Its class and speed   */
+/*                           set the cost of each step.                       */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: The steps allowed, their costs and the heuristic are those of   */
+/*            dt_find_path, so the cost of the path found is the same. A      */
+/*            point which is interior in the cost field of the unit is        */
+/*            expanded as in jump point search: only the directions which     */
+/*            could start a cheaper path than one through its parent are      */
+/*            tried, and each jumps straight on until it reaches a point      */
+/*            which needs expanding. Every other point, and the start, is     */
+/*            expanded to all 8 neighbours as A* would. Jumps stop at any     */
+/*            point which is not interior, so the search falls back to A* in  */
+/*            and around terrain whose costs vary. The points jumped over are */
+/*            filled in once the goal is reached, so the path has every       */
+/*            point as for dt_find_path. A goal in a region the start cannot  */
+/*            reach is turned down before anything is searched.               */
+/******************************************************************************/
+int dt_find_jump_point_path(DT_PATH_SEARCH *search,
+                            DT_UNIT *unit,
+                            int start_x,
+                            int start_y,
+                            int goal_x,
+                            int goal_y,
+                            DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = search->grid;
+  DT_COST_FIELD *field;
+  Uint64 start_time;
+  Uint32 min_cost;
+  Uint32 node;
+  Uint32 step_cost;
+  Uint32 steps;
+  long index;
+  int ret_code = DT_PATH_NOT_FOUND;
+  int directions;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  start_time = dt_get_time_us();
+  (*path) = NULL;
+  dt_begin_path_search(search);
+  field = dt_get_grid_cost_field(grid, unit);
+  if (!dt_check_path_points(grid, field, start_x, start_y, goal_x, goal_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    goto EXIT_LABEL;
+  }
+  if (!dt_is_goal_in_start_region(grid,
+                                  field,
+                                  start_x,
+                                  start_y,
+                                  goal_x,
+                                  goal_y))
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Open the start node.                                                     */
+  /****************************************************************************/
+  min_cost = (Uint32) dt_get_min_move_cost(unit);
+  dt_reach_path_state(search,
+                      ((Uint32) start_y * (Uint32) grid->num_tiles_x) +
+                                                            (Uint32) start_x,
+                      0,
+                      DT_PATH_NO_PARENT,
+                      min_cost * dt_get_octile_distance(goal_x - start_x,
+                                                        goal_y - start_y));
+
+  /****************************************************************************/
+  /* Expand the open node with the lowest estimate until the goal is reached. */
+  /****************************************************************************/
+  while (search->heap.num_entries > 0)
+  {
+    node = dt_pop_path_heap(search);
+    (search->nodes_expanded)++;
+    grid_x = (int) (node % (Uint32) grid->num_tiles_x);
+    grid_y = (int) (node / (Uint32) grid->num_tiles_x);
+    if ((grid_x == goal_x) && (grid_y == goal_y))
+    {
+      dt_fill_jump_point_path(search, field, node);
+      (*path) = dt_build_path(search, node, unit->orientation);
+      ret_code = DT_PATH_FOUND;
+      break;
+    }
+
+    /**************************************************************************/
+    /* Expand a point where the costs vary, or the start, to every neighbour. */
+    /**************************************************************************/
+    index = dt_get_cost_field_index(field, grid_x, grid_y);
+    direction = search->parent[node];
+    if ((DT_PATH_NO_PARENT == direction) ||
+        !dt_is_cost_field_bit_set(field, field->interior, grid_x, grid_y))
+    {
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        step_cost = dt_get_cost_field_step_cost(field, index, direction);
+        if (0 == step_cost)
+        {
+          continue;
+        }
+        next_x = grid_x + dt_get_orientation_step_x(direction);
+        next_y = grid_y + dt_get_orientation_step_y(direction);
+        dt_reach_path_state(search,
+                            (Uint32) ((long) node +
+                                            search->node_offsets[direction]),
+                            search->cost[node] + step_cost,
+                            direction,
+                            min_cost * dt_get_octile_distance(goal_x - next_x,
+                                                              goal_y - next_y));
+      }
+      continue;
+    }
+
+    /**************************************************************************/
+    /* Jump from an interior point in each direction not pruned.              */
+    /**************************************************************************/
+    directions = dt_get_jump_point_directions(field, index, direction);
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      if (0 == (directions & (1 << direction)))
+      {
+        continue;
+      }
+      steps = dt_jump_from_point(field,
+                                 grid_x,
+                                 grid_y,
+                                 direction,
+                                 goal_x,
+                                 goal_y);
+      if (0 == steps)
+      {
+        continue;
+      }
+      next_x = grid_x + ((int) steps * dt_get_orientation_step_x(direction));
+      next_y = grid_y + ((int) steps * dt_get_orientation_step_y(direction));
+      step_cost = (0 == (direction & 1)) ? DT_PATH_STRAIGHT_STEP :
+                                           DT_PATH_DIAGONAL_STEP;
+      dt_reach_path_state(search,
+                          (Uint32) ((long) node +
+                              ((long) steps * search->node_offsets[direction])),
+                          search->cost[node] +
+                                   (steps * step_cost * field->uniform_cost),
+                          direction,
+                          min_cost * dt_get_octile_distance(goal_x - next_x,
+                                                            goal_y - next_y));
+    }
+  }
+
+EXIT_LABEL:
+
+  (search->num_searches)++;
+  search->total_nodes_expanded += (Uint64) search->nodes_expanded;
+  search->total_search_time_us += dt_get_time_us() - start_time;
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_get_jump_point_directions                                     */
+/*                                                                            */
+/* Purpose: Find the directions to jump in from an interior point.            */
+/*                                                                            */
+/* Returns: A mask with bit n set if direction n should be tried.             */
+/*                                                                            */
+/* Parameters: IN     field - The cost field of the search.                   */
+/*             IN     index - The index in the field of the point.            */
+/*             IN     direction - The direction of the step or jump which     */
+/*                                reached the point.                          */
+/*                                                                            */
+/* Operation: Diagonal steps may not cut corners, so after a diagonal step    */
+/*            only the two straight directions either side of it and the      */
+/*            diagonal itself, if both those are open, can lead anywhere the  */
+/*            parent could not reach as cheaply. After a straight step the    */
+/*            direction itself, the two at right angles to it and the         */
+/*            diagonals between those and the direction are tried. As the     */
+/*            point is interior every neighbour which may be entered has the  */
+/*            uniform cost.                                                   */
+/******************************************************************************/
+int dt_get_jump_point_directions(DT_COST_FIELD *field,
+                                 long index,
+                                 int direction)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint16 *costs = field->costs;
+  int directions = 0;
+  int left;
+  int right;
+  bool left_open;
+  bool right_open;
+  bool ahead_open;
+
+  /****************************************************************************/
+  /* After a diagonal step try the straight directions either side of it.     */
+  /****************************************************************************/
+  if (0 != (direction & 1))
+  {
+    left = direction - 1;
+    right = (direction + 1) % NORTH_1;
+    left_open = (DT_COST_FIELD_BLOCKED != costs[index + field->offsets[left]]);
+    right_open = (DT_COST_FIELD_BLOCKED !=
+                                        costs[index + field->offsets[right]]);
+    if (left_open)
+    {
+      directions |= 1 << left;
+    }
+    if (right_open)
+    {
+      directions |= 1 << right;
+    }
+    if (left_open && right_open)
+    {
+      directions |= 1 << direction;
+    }
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* After a straight step try those at right angles to it as well.           */
+  /****************************************************************************/
+  left = (direction + NORTH_1 - 2) % NORTH_1;
+  right = (direction + 2) % NORTH_1;
+  ahead_open = (DT_COST_FIELD_BLOCKED !=
+                                  costs[index + field->offsets[direction]]);
+  if (ahead_open)
+  {
+    directions |= 1 << direction;
+  }
+  if (DT_COST_FIELD_BLOCKED != costs[index + field->offsets[left]])
+  {
+    directions |= 1 << left;
+    if (ahead_open)
+    {
+      directions |= 1 << ((direction + NORTH_1 - 1) % NORTH_1);
+    }
+  }
+  if (DT_COST_FIELD_BLOCKED != costs[index + field->offsets[right]])
+  {
+    directions |= 1 << right;
+    if (ahead_open)
+    {
+      directions |= 1 << (direction + 1);
+    }
+  }
+
+EXIT_LABEL:
+
+  return(directions);
+}
+
+/******************************************************************************/
+/* Function: dt_jump_from_point                                               */
+/*                                                                            */
+/* Purpose: Jump from an interior point in a direction to the next point      */
+/*          which needs expanding.                                            */
+/*                                                                            */
+/* Returns: The number of steps to that point, or 0 if the jump runs into a   */
+/*          point which may not be entered first, in which case nothing along */
+/*          it needs expanding.                                               */
+/*                                                                            */
+/* Parameters: IN     field - The cost field of the search.                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             IN     direction - The direction of the jump.                  */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Straight jumps are made by dt_jump_horizontally and             */
+/*            dt_jump_vertically. A diagonal jump steps one point at a time,  */
+/*            without cutting corners, and stops at the goal, at a point      */
+/*            which is not interior or at one from which a straight jump      */
+/*            along either of its sides finds somewhere to stop.              */
+/******************************************************************************/
+Uint32 dt_jump_from_point(DT_COST_FIELD *field,
+                          int grid_x,
+                          int grid_y,
+                          int direction,
+                          int goal_x,
+                          int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint16 *costs = field->costs;
+  Uint32 steps = 0;
+  long index;
+  int step_x = dt_get_orientation_step_x(direction);
+  int step_y = dt_get_orientation_step_y(direction);
+
+  if (0 == step_y)
+  {
+    steps = dt_jump_horizontally(field, grid_x, grid_y, step_x, goal_x, goal_y);
+    goto EXIT_LABEL;
+  }
+  if (0 == step_x)
+  {
+    steps = dt_jump_vertically(field, grid_x, grid_y, step_y, goal_x, goal_y);
+    goto EXIT_LABEL;
+  }
+
+  index = dt_get_cost_field_index(field, grid_x, grid_y);
+  while (true)
+  {
+    if ((DT_COST_FIELD_BLOCKED == costs[index + step_x]) ||
+        (DT_COST_FIELD_BLOCKED == costs[index + (step_y * field->width)]) ||
+        (DT_COST_FIELD_BLOCKED == costs[index + field->offsets[direction]]))
+    {
+      steps = 0;
+      break;
+    }
+    index += field->offsets[direction];
+    grid_x += step_x;
+    grid_y += step_y;
+    steps++;
+    if (((grid_x == goal_x) && (grid_y == goal_y)) ||
+        !dt_is_cost_field_bit_set(field, field->interior, grid_x, grid_y) ||
+        (0 != dt_jump_horizontally(field,
+                                   grid_x,
+                                   grid_y,
+                                   step_x,
+                                   goal_x,
+                                   goal_y)) ||
+        (0 != dt_jump_vertically(field,
+                                 grid_x,
+                                 grid_y,
+                                 step_y,
+                                 goal_x,
+                                 goal_y)))
+    {
+      break;
+    }
+  }
+
+EXIT_LABEL:
+
+  return(steps);
+}
+
+/******************************************************************************/
+/* Function: dt_jump_horizontally                                             */
+/*                                                                            */
+/* Purpose: Jump east or west from an interior point to the next point which  */
+/*          needs expanding.                                                  */
+/*                                                                            */
+/* Returns: The number of steps to that point, or 0 if the jump runs into a   */
+/*          point which may not be entered first.                             */
+/*                                                                            */
+/* Parameters: IN     field - The cost field of the search.                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             IN     step_x - 1 to jump east or -1 to jump west.             */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Scan the row of the point with the rows above and below it at   */
+/*            its sides, then check whether the point the scan stopped at may */
+/*            be entered.                                                     */
+/******************************************************************************/
+Uint32 dt_jump_horizontally(DT_COST_FIELD *field,
+                            int grid_x,
+                            int grid_y,
+                            int step_x,
+                            int goal_x,
+                            int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 steps;
+  int stop_x;
+
+  stop_x = dt_scan_jump_point_line(
+                  dt_get_cost_field_bit_row(field, field->interior, grid_y),
+                  dt_get_cost_field_bit_row(field, field->uniform, grid_y - 1),
+                  dt_get_cost_field_bit_row(field, field->uniform, grid_y + 1),
+                  grid_x,
+                  step_x,
+                  (goal_y == grid_y) ? goal_x : -1);
+  steps = (Uint32) abs(stop_x - grid_x);
+  if (DT_COST_FIELD_BLOCKED ==
+                      field->costs[dt_get_cost_field_index(field,
+                                                           stop_x,
+                                                           grid_y)])
+  {
+    steps = 0;
+  }
+
+  return(steps);
+}
+
+/******************************************************************************/
+/* Function: dt_jump_vertically                                               */
+/*                                                                            */
+/* Purpose: Jump north or south from an interior point to the next point      */
+/*          which needs expanding.                                            */
+/*                                                                            */
+/* Returns: The number of steps to that point, or 0 if the jump runs into a   */
+/*          point which may not be entered first.                             */
+/*                                                                            */
+/* Parameters: IN     field - The cost field of the search.                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             IN     step_y - 1 to jump south or -1 to jump north.           */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: As dt_jump_horizontally using the bitmaps by column.            */
+/******************************************************************************/
+Uint32 dt_jump_vertically(DT_COST_FIELD *field,
+                          int grid_x,
+                          int grid_y,
+                          int step_y,
+                          int goal_x,
+                          int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 steps;
+  int stop_y;
+
+  stop_y = dt_scan_jump_point_line(
+       dt_get_cost_field_bit_column(field, field->interior_columns, grid_x),
+       dt_get_cost_field_bit_column(field, field->uniform_columns, grid_x - 1),
+       dt_get_cost_field_bit_column(field, field->uniform_columns, grid_x + 1),
+       grid_y,
+       step_y,
+       (goal_x == grid_x) ? goal_y : -1);
+  steps = (Uint32) abs(stop_y - grid_y);
+  if (DT_COST_FIELD_BLOCKED ==
+                      field->costs[dt_get_cost_field_index(field,
+                                                           grid_x,
+                                                           stop_y)])
+  {
+    steps = 0;
+  }
+
+  return(steps);
+}
+
+/******************************************************************************/
+/* Function: dt_scan_jump_point_line                                          */
+/*                                                                            */
+/* Purpose: Find where a straight jump along a row or column of a cost field  */
+/*          stops.                                                            */
+/*                                                                            */
+/* Returns: The coordinate along the line of the point the jump stops at.     */
+/*                                                                            */
+/* Parameters: IN     interior - The interior bitmap of the line jumped       */
+/*                               along.                                       */
+/*             IN     side - The uniform bitmap of the line on one side.      */
+/*             IN     other_side - The uniform bitmap of the line on the      */
+/*                                 other side.                                */
+/*             IN     start - The coordinate along the line jumped from.      */
+/*             IN     step - 1 or -1 for the way along the line to jump.      */
+/*             IN     goal - The coordinate of the goal along the line, or -1 */
+/*                           if the goal is not on it.                        */
+/*                                                                            */
+/* Operation: The jump stops at the goal, at a point which is not interior,   */
+/*            which includes any point which may not be entered, or at a      */
+/*            point with a forced neighbour. That is one where the point      */
+/*            beside it on a side line is open but the point behind that is   */
+/*            not, so the neighbour can only be reached cheaply through this  */
+/*            point. Each of these is a bit pattern in the bitmaps, so 32     */
+/*            points are checked at once and the first is found from the      */
+/*            lowest or highest bit set. The border of the bitmaps is never   */
+/*            interior so the scan always ends within the line.               */
+/******************************************************************************/
+int dt_scan_jump_point_line(Uint32 *interior,
+                            Uint32 *side,
+                            Uint32 *other_side,
+                            int start,
+                            int step,
+                            int goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 stops;
+  int position = start + DT_COST_FIELD_BIT_BORDER + step;
+  int goal_position = goal + DT_COST_FIELD_BIT_BORDER;
+  int first;
+
+  /****************************************************************************/
+  /* Going forwards the bits read start at position and going back they end   */
+  /* at it.                                                                   */
+  /****************************************************************************/
+  while (true)
+  {
+    first = (step > 0) ? position : position - (DT_GRID_BITS_PER_WORD - 1);
+    stops = (~dt_get_cost_field_bits(interior, first)) |
+            (dt_get_cost_field_bits(side, first) &
+                                ~dt_get_cost_field_bits(side, first - step)) |
+            (dt_get_cost_field_bits(other_side, first) &
+                          ~dt_get_cost_field_bits(other_side, first - step));
+    if ((goal >= 0) &&
+        (goal_position >= first) &&
+        (goal_position < first + DT_GRID_BITS_PER_WORD))
+    {
+      stops |= 1u << (goal_position - first);
+    }
+    if (0 != stops)
+    {
+      break;
+    }
+    position += step * DT_GRID_BITS_PER_WORD;
+  }
+
+  return(first - DT_COST_FIELD_BIT_BORDER +
+         ((step > 0) ? dt_find_lowest_set_bit(stops) :
+                       dt_find_highest_set_bit(stops)));
+}
+
+/******************************************************************************/
+/* Function: dt_fill_jump_point_path                                          */
+/*                                                                            */
+/* Purpose: Fill in the points jumped over on the way to a state so that      */
+/*          dt_build_path can follow the path a step at a time.               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The jump point search which reached the state. */
+/*             IN     field - The cost field of the search.                   */
+/*             IN     goal - The last state of the path.                      */
+/*                                                                            */
+/* Operation: Follow the parents back from the goal a step at a time, working */
+/*            out what each point before must have cost. A point which has    */
+/*            been expanded at that cost is where the step or jump was made   */
+/*            from, or lies on a path to it which is just as cheap, and its   */
+/*            own parent is followed from there. Any other point was jumped   */
+/*            over, so it is given the direction of the jump as its parent    */
+/*            and that cost. A point jumped over may have been expanded at a  */
+/*            higher cost, as the search does not reach the points it jumps   */
+/*            over, which is why the cost is checked. The cost falls at every */
+/*            step so the start is always reached.                            */
+/******************************************************************************/
+void dt_fill_jump_point_path(DT_PATH_SEARCH *search,
+                             DT_COST_FIELD *field,
+                             Uint32 goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int num_tiles_x = search->grid->num_tiles_x;
+  Uint32 node = goal;
+  Uint32 previous;
+  Uint32 cost;
+  int direction;
+
+  while (DT_PATH_NO_PARENT != (direction = search->parent[node]))
+  {
+    previous = (Uint32) ((long) node - search->node_offsets[direction]);
+    cost = search->cost[node] -
+           dt_get_cost_field_step_cost(field,
+                                       dt_get_cost_field_index(field,
+                                            (int) (previous % num_tiles_x),
+                                            (int) (previous / num_tiles_x)),
+                                       direction);
+    if ((search->generation[previous] != search->current_generation) ||
+        (DT_PATH_CLOSED != search->heap_index[previous]) ||
+        (search->cost[previous] != cost))
+    {
+      search->generation[previous] = search->current_generation;
+      search->heap_index[previous] = DT_PATH_CLOSED;
+      search->cost[previous] = cost;
+      search->parent[previous] = (unsigned char) direction;
+    }
+    node = previous;
+  }
+
+  return;
+}
@@ -0,0 +1,516 @@
+/******************************************************************************/
+/* File: dt_landmarks.c                                                       */
+/*                                                                            */
+/* Purpose: Landmarks, which give long searches a heuristic that knows about  */
+/*          the costly ground between the start and goal by measuring the     */
+/*          map once from a few points round its edge.                        */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_get_grid_landmarks                                            */
+/*                                                                            */
+/* Purpose: Find the landmarks of a grid for a unit, building them if the     */
+/*          unit's cost field does not have them yet or they are stale.       */
+/*                                                                            */
+/* Returns: A pointer to the landmarks, which are owned by the cost field.    */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*             IN     unit - The unit. Units of the same class and speed      */
+/*                           share landmarks.                                 */
+/*             IN     num_landmarks - The number of landmarks wanted, from 1  */
+/*                                    to DT_LANDMARK_MAX. Each needs four     */
+/*                                    bytes per point of the grid.            */
+/*                                                                            */
+/* Operation: Searches only use landmarks once this has been called for the   */
+/*            field, so a field which is never asked for them costs nothing.  */
+/*            Landmarks of another number are thrown away and built again.    */
+/*            Like dt_get_grid_cost_field this writes to the grid and must    */
+/*            not be called while searches run on other threads.              */
+/******************************************************************************/
+DT_LANDMARKS *dt_get_grid_landmarks(DT_GRID *grid,
+                                    DT_UNIT *unit,
+                                    int num_landmarks)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COST_FIELD *field;
+
+  field = dt_get_grid_cost_field(grid, unit);
+  num_landmarks = CLAMP(num_landmarks, 1, DT_LANDMARK_MAX);
+  if ((NULL != field->landmarks) &&
+      (field->landmarks->num_landmarks != num_landmarks))
+  {
+    dt_destroy_landmarks(field->landmarks);
+    field->landmarks = NULL;
+  }
+  if (NULL == field->landmarks)
+  {
+    field->landmarks = dt_create_landmarks(grid, num_landmarks);
+  }
+  if (field->landmarks->stale)
+  {
+    dt_build_landmarks(field->landmarks, field, grid);
+  }
+
+  return(field->landmarks);
+}
+
+/******************************************************************************/
+/* Function: dt_create_landmarks                                              */
+/*                                                                            */
+/* Purpose: Create the landmarks of a cost field of a grid.                   */
+/*                                                                            */
+/* Returns: A pointer to the new landmarks. They are stale until built.       */
+/*                                                                            */
+/* Parameters: IN     grid - The grid of the cost field.                      */
+/*             IN     num_landmarks - The number of landmarks, from 1 to      */
+/*                                    DT_LANDMARK_MAX.                        */
+/*                                                                            */
+/* Operation: Allocate the tables for every point.                            */
+/******************************************************************************/
+DT_LANDMARKS *dt_create_landmarks(DT_GRID *grid, int num_landmarks)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_LANDMARKS *landmarks;
+
+  landmarks = (DT_LANDMARKS *) dt_malloc(sizeof(DT_LANDMARKS));
+  landmarks->num_landmarks = num_landmarks;
+  landmarks->num_tables = num_landmarks * 2;
+  landmarks->num_nodes = (size_t) grid->num_tiles_x *
+                                                  (size_t) grid->num_tiles_y;
+  landmarks->distances = (Uint16 *) dt_malloc(sizeof(Uint16) *
+                                              landmarks->num_nodes *
+                                          (size_t) landmarks->num_tables);
+  landmarks->stale = true;
+  landmarks->serial = 0;
+  landmarks->num_builds = 0;
+  landmarks->build_time_us = 0;
+
+  return(landmarks);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_landmarks                                             */
+/*                                                                            */
+/* Purpose: Free the landmarks of a cost field.                               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     landmarks - The landmarks to free.                      */
+/*                                                                            */
+/* Operation: Free the tables and then the landmarks.                         */
+/******************************************************************************/
+void dt_destroy_landmarks(DT_LANDMARKS *landmarks)
+{
+  dt_free(landmarks->distances);
+  dt_free(landmarks);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_landmarks                                               */
+/*                                                                            */
+/* Purpose: Place the landmarks of a cost field and measure their tables.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT landmarks - The landmarks.                              */
+/*             IN/OUT field - The cost field. Its region map is brought up to */
+/*                            date.                                           */
+/*             IN     grid - The grid of the field.                           */
+/*                                                                            */
+/* Operation: Place the landmarks, then measure every table as one batch of   */
+/*            jobs on the master worker pool. Each table is a search of its   */
+/*            own, so they run side by side. Last take the grid's next serial */
+/*            number.                                                         */
+/******************************************************************************/
+void dt_build_landmarks(DT_LANDMARKS *landmarks,
+                        DT_COST_FIELD *field,
+                        DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_LANDMARK_JOB jobs[DT_LANDMARK_MAX * 2];
+  Uint64 start_time;
+  int table;
+
+  start_time = dt_get_time_us();
+  dt_place_landmarks(landmarks, field, grid);
+  for (table = 0; table < landmarks->num_tables; table++)
+  {
+    jobs[table].landmarks = landmarks;
+    jobs[table].field = field;
+    jobs[table].grid = grid;
+    jobs[table].table = table;
+  }
+  dt_run_worker_pool_jobs(dt_get_master_worker_pool(),
+                          dt_measure_landmark_job,
+                          jobs,
+                          sizeof(DT_LANDMARK_JOB),
+                          landmarks->num_tables);
+  landmarks->stale = false;
+  (grid->landmark_serial)++;
+  landmarks->serial = grid->landmark_serial;
+  (landmarks->num_builds)++;
+  landmarks->build_time_us = dt_get_time_us() - start_time;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_place_landmarks                                               */
+/*                                                                            */
+/* Purpose: Choose the points of a cost field to use as landmarks.            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT landmarks - The landmarks.                              */
+/*             IN/OUT field - The cost field. Its region map is brought up to */
+/*                            date.                                           */
+/*             IN     grid - The grid of the field.                           */
+/*                                                                            */
+/* Operation: A landmark gives the best estimates for searches heading        */
+/*            towards it or away from it, so they are spread evenly round the */
+/*            edge of the map, starting from the top left corner. Each is the */
+/*            point nearest its place on the edge in the largest region of    */
+/*            the field, as a landmark tells nothing about a region it is not */
+/*            in.                                                             */
+/******************************************************************************/
+void dt_place_landmarks(DT_LANDMARKS *landmarks,
+                        DT_COST_FIELD *field,
+                        DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REGION_MAP *map;
+  Uint32 *sizes;
+  Uint32 largest = DT_REGION_NONE;
+  Uint32 largest_size = 0;
+  Uint32 root;
+  Uint64 nearest[DT_LANDMARK_MAX];
+  Uint64 distance;
+  int edge_x[DT_LANDMARK_MAX];
+  int edge_y[DT_LANDMARK_MAX];
+  int last_x = grid->num_tiles_x - 1;
+  int last_y = grid->num_tiles_y - 1;
+  int perimeter;
+  int position;
+  int grid_x;
+  int grid_y;
+  int ii;
+
+  /****************************************************************************/
+  /* Find the largest region.                                                 */
+  /****************************************************************************/
+  map = dt_get_region_map(grid, field);
+  sizes = (Uint32 *) dt_calloc(map->num_labels, sizeof(Uint32));
+  for (grid_y = 0; grid_y <= last_y; grid_y++)
+  {
+    for (grid_x = 0; grid_x <= last_x; grid_x++)
+    {
+      root = dt_find_region_root(map,
+                                 map->labels[((size_t) grid_y *
+                                              (size_t) map->width) +
+                                                           (size_t) grid_x]);
+      sizes[root]++;
+      if ((DT_REGION_NONE != root) && (sizes[root] > largest_size))
+      {
+        largest = root;
+        largest_size = sizes[root];
+      }
+    }
+  }
+  dt_free(sizes);
+
+  /****************************************************************************/
+  /* Space the landmarks round the edge, clockwise from the top left.         */
+  /****************************************************************************/
+  perimeter = MAX(2 * (last_x + last_y), 1);
+  for (ii = 0; ii < landmarks->num_landmarks; ii++)
+  {
+    position = (int) (((Uint64) ii * (Uint64) perimeter) /
+                                           (Uint64) landmarks->num_landmarks);
+    if (position < last_x)
+    {
+      edge_x[ii] = position;
+      edge_y[ii] = 0;
+    }
+    else if (position < last_x + last_y)
+    {
+      edge_x[ii] = last_x;
+      edge_y[ii] = position - last_x;
+    }
+    else if (position < (2 * last_x) + last_y)
+    {
+      edge_x[ii] = last_x - (position - last_x - last_y);
+      edge_y[ii] = last_y;
+    }
+    else
+    {
+      edge_x[ii] = 0;
+      edge_y[ii] = last_y - (position - (2 * last_x) - last_y);
+    }
+    nearest[ii] = DT_LANDMARK_NO_DISTANCE;
+    landmarks->landmark_x[ii] = edge_x[ii];
+    landmarks->landmark_y[ii] = edge_y[ii];
+  }
+
+  /****************************************************************************/
+  /* Move each landmark to the nearest point of the largest region.           */
+  /****************************************************************************/
+  for (grid_y = 0; grid_y <= last_y; grid_y++)
+  {
+    for (grid_x = 0; grid_x <= last_x; grid_x++)
+    {
+      root = dt_find_region_root(map,
+                                 map->labels[((size_t) grid_y *
+                                              (size_t) map->width) +
+                                                           (size_t) grid_x]);
+      if ((DT_REGION_NONE == root) || (root != largest))
+      {
+        continue;
+      }
+      for (ii = 0; ii < landmarks->num_landmarks; ii++)
+      {
+        distance = ((Uint64) abs(grid_x - edge_x[ii]) *
+                                      (Uint64) abs(grid_x - edge_x[ii])) +
+                   ((Uint64) abs(grid_y - edge_y[ii]) *
+                                      (Uint64) abs(grid_y - edge_y[ii]));
+        if (distance < nearest[ii])
+        {
+          nearest[ii] = distance;
+          landmarks->landmark_x[ii] = grid_x;
+          landmarks->landmark_y[ii] = grid_y;
+        }
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_measure_landmark_job                                          */
+/*                                                                            */
+/* Purpose: Measure one table of a set of landmarks on a worker thread.       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT data - The DT_LANDMARK_JOB for the table. Only the      */
+/*                           entries of its table are written.                */
+/*                                                                            */
+/* Operation: Run Dijkstra's algorithm over the whole field with a search of  */
+/*            the job's own, from the landmark for an even table and back to  */
+/*            it for an odd one. Going back, each point reached is stepped to */
+/*            from each point around it, at the cost of that step. Then shift */
+/*            the costs until the highest fits below DT_LANDMARK_UNREACHABLE  */
+/*            and write them into the table.                                  */
+/******************************************************************************/
+void dt_measure_landmark_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_LANDMARK_JOB *job = (DT_LANDMARK_JOB *) data;
+  DT_LANDMARKS *landmarks = job->landmarks;
+  DT_COST_FIELD *field = job->field;
+  DT_GRID *grid = job->grid;
+  DT_PATH_SEARCH *search;
+  Uint16 *entry;
+  Uint32 node;
+  Uint32 step_cost;
+  Uint32 max_cost = 0;
+  long step_index;
+  bool backwards = (0 != (job->table & 1));
+  int landmark = job->table >> 1;
+  int shift = 0;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  search = dt_create_path_search(grid);
+  dt_begin_path_search(search);
+  dt_reach_path_state(search,
+                      ((Uint32) landmarks->landmark_y[landmark] *
+                                             (Uint32) grid->num_tiles_x) +
+                                   (Uint32) landmarks->landmark_x[landmark],
+                      0,
+                      DT_PATH_NO_PARENT,
+                      0);
+
+  while (search->heap.num_entries > 0)
+  {
+    node = dt_pop_path_heap(search);
+    max_cost = MAX(max_cost, search->cost[node]);
+    grid_x = (int) (node % (Uint32) grid->num_tiles_x);
+    grid_y = (int) (node / (Uint32) grid->num_tiles_x);
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      if (!backwards)
+      {
+        step_index = dt_get_cost_field_index(field, grid_x, grid_y);
+        step_cost = dt_get_cost_field_step_cost(field, step_index, direction);
+        next_x = grid_x + dt_get_orientation_step_x(direction);
+        next_y = grid_y + dt_get_orientation_step_y(direction);
+      }
+      else
+      {
+        next_x = grid_x - dt_get_orientation_step_x(direction);
+        next_y = grid_y - dt_get_orientation_step_y(direction);
+        if ((next_x < 0) || (next_x >= grid->num_tiles_x) ||
+            (next_y < 0) || (next_y >= grid->num_tiles_y))
+        {
+          continue;
+        }
+        step_index = dt_get_cost_field_index(field, next_x, next_y);
+        step_cost = dt_get_cost_field_step_cost(field, step_index, direction);
+      }
+      if (0 == step_cost)
+      {
+        continue;
+      }
+      dt_reach_path_state(search,
+                          ((Uint32) next_y * (Uint32) grid->num_tiles_x) +
+                                                             (Uint32) next_x,
+                          search->cost[node] + step_cost,
+                          direction,
+                          0);
+    }
+  }
+
+  /****************************************************************************/
+  /* Write the shifted costs into the table.                                  */
+  /****************************************************************************/
+  while ((max_cost >> shift) >= DT_LANDMARK_UNREACHABLE)
+  {
+    shift++;
+  }
+  landmarks->shifts[job->table] = shift;
+  entry = &(landmarks->distances[job->table]);
+  for (node = 0; node < (Uint32) landmarks->num_nodes; node++)
+  {
+    (*entry) = (search->generation[node] == search->current_generation) ?
+                        (Uint16) (search->cost[node] >> shift) :
+                        (Uint16) DT_LANDMARK_UNREACHABLE;
+    entry += landmarks->num_tables;
+  }
+  dt_destroy_path_search(search);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_choose_search_landmarks                                       */
+/*                                                                            */
+/* Purpose: Choose the tables a search estimates its costs from.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search, which has just begun.              */
+/*             IN     field - The cost field of the search.                   */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: If the field has landmarks which are up to date, keep the       */
+/*            DT_LANDMARK_SEARCH_TABLES tables which give the highest         */
+/*            estimate from the start. Those are the landmarks behind the     */
+/*            start or beyond the goal, which go on giving the best estimates */
+/*            along most of the way. Otherwise the search uses none.          */
+/******************************************************************************/
+void dt_choose_search_landmarks(DT_PATH_SEARCH *search,
+                                DT_COST_FIELD *field,
+                                int start_x,
+                                int start_y,
+                                int goal_x,
+                                int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_LANDMARKS *landmarks = field->landmarks;
+  Uint32 estimates[DT_LANDMARK_SEARCH_TABLES];
+  Uint32 estimate;
+  Uint32 start_node;
+  Uint32 goal_node;
+  int table;
+  int ii;
+
+  search->landmarks = NULL;
+  search->num_landmark_tables = 0;
+  if ((NULL == landmarks) || landmarks->stale)
+  {
+    goto EXIT_LABEL;
+  }
+  search->landmarks = landmarks;
+  search->landmark_serial = landmarks->serial;
+  start_node = ((Uint32) start_y * (Uint32) search->grid->num_tiles_x) +
+                                                            (Uint32) start_x;
+  goal_node = ((Uint32) goal_y * (Uint32) search->grid->num_tiles_x) +
+                                                             (Uint32) goal_x;
+
+  /****************************************************************************/
+  /* Keep the tables in order of estimate, dropping the lowest when full.     */
+  /****************************************************************************/
+  for (table = 0; table < landmarks->num_tables; table++)
+  {
+    estimate = dt_get_landmark_estimate(landmarks,
+                                        &table,
+                                        1,
+                                        start_node,
+                                        goal_node);
+    ii = search->num_landmark_tables;
+    if (DT_LANDMARK_SEARCH_TABLES == ii)
+    {
+      if (estimate <= estimates[ii - 1])
+      {
+        continue;
+      }
+      ii--;
+    }
+    else
+    {
+      (search->num_landmark_tables)++;
+    }
+    for (; (ii > 0) && (estimates[ii - 1] < estimate); ii--)
+    {
+      estimates[ii] = estimates[ii - 1];
+      search->landmark_tables[ii] = search->landmark_tables[ii - 1];
+    }
+    estimates[ii] = estimate;
+    search->landmark_tables[ii] = table;
+  }
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_landmarks_memory_usage                                    */
+/*                                                                            */
+/* Purpose: Report how much memory the landmarks of a cost field are using.   */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the landmarks.                  */
+/*                                                                            */
+/* Parameters: IN     landmarks - The landmarks.                              */
+/*                                                                            */
+/* Operation: Add the tables to the landmarks themselves. Each landmark costs */
+/*            two 16 bit entries per point.                                   */
+/******************************************************************************/
+size_t dt_get_landmarks_memory_usage(DT_LANDMARKS *landmarks)
+{
+  return(sizeof(DT_LANDMARKS) +
+         (sizeof(Uint16) * landmarks->num_nodes *
+                                           (size_t) landmarks->num_tables));
+}
@@ -0,0 +1,147 @@
+/******************************************************************************/
+/* File: dt_landmarks.h                                                       */
+/*                                                                            */
+/* Purpose: Definitions for landmarks, whose distances to and from every      */
+/*          point give searches a far closer estimate of the cost still to    */
+/*          go than the octile distance where rivers and mountains are in the */
+/*          way.                                                              */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of landmarks.                                                   */
+/*                                                                            */
+/* DT_LANDMARK_MAX - The most landmarks a cost field may have.                */
+/* DT_LANDMARK_SEARCH_TABLES - The most tables a search estimates from. Those */
+/*                             giving the highest estimate at the start are   */
+/*                             chosen, as the rest add little but the time to */
+/*                             read them at every point.                      */
+/* DT_LANDMARK_UNREACHABLE - The distance held for a point which cannot be    */
+/*                           reached from the landmark, or cannot reach it.   */
+/* DT_LANDMARK_NO_DISTANCE - Further than any point while the point nearest   */
+/*                           each place on the edge is looked for.            */
+/******************************************************************************/
+#define DT_LANDMARK_MAX 16
+#define DT_LANDMARK_SEARCH_TABLES 4
+#define DT_LANDMARK_UNREACHABLE 0xFFFF
+#define DT_LANDMARK_NO_DISTANCE 0xFFFFFFFFFFFFFFFFull
+
+/******************************************************************************/
+/* DT_LANDMARKS:                                                              */
+/*                                                                            */
+/* A few points of a cost field, spread round the edge of the map, and the    */
+/* cheapest cost from each landmark to every point and from every point back  */
+/* to the landmark. Steps cost what the point stepped onto costs, so the two  */
+/* differ and both are kept. There are two tables for each landmark, that     */
+/* from it in the even table and that to it in the odd one after. Each point  */
+/* holds its entry of every table side by side, so the estimate for a point   */
+/* reads a few bytes together. Each table is held in 16 bits, shifted right   */
+/* as far as it needs to fit, so a table for a large map loses the bottom     */
+/* bits of its costs.                                                         */
+/*                                                                            */
+/* num_landmarks - The number of landmarks.                                   */
+/* num_tables - The number of tables, two per landmark.                       */
+/* landmark_x - The x coordinate of each landmark.                            */
+/* landmark_y - The y coordinate of each landmark.                            */
+/* shifts - How far the costs of each table were shifted right.               */
+/* num_nodes - The number of points of the grid.                              */
+/* distances - The entries of every table for each point, row by row, or      */
+/*             DT_LANDMARK_UNREACHABLE.                                       */
+/* stale - Set until the tables are built, and when a cost of the field has   */
+/*         been lowered since, as the tables may then overestimate. A cost    */
+/*         which has only been raised leaves them a lower bound.              */
+/* serial - The serial number the grid gave the tables when they were last    */
+/*          built, which no other build on the grid has. A search keeps it,   */
+/*          so landmarks rebuilt or freed and allocated again at the same     */
+/*          address are not mistaken for those whose tables it chose.         */
+/* num_builds - The number of times the tables have been built.               */
+/* build_time_us - The time the last build took, in microseconds.             */
+/******************************************************************************/
+typedef struct dt_landmarks
+{
+  int num_landmarks;
+  int num_tables;
+  int landmark_x[DT_LANDMARK_MAX];
+  int landmark_y[DT_LANDMARK_MAX];
+  int shifts[DT_LANDMARK_MAX * 2];
+  size_t num_nodes;
+  Uint16 *distances;
+  bool stale;
+  Uint32 serial;
+  long num_builds;
+  Uint64 build_time_us;
+} DT_LANDMARKS;
+
+/******************************************************************************/
+/* DT_LANDMARK_JOB:                                                           */
+/*                                                                            */
+/* One table of a set of landmarks, measured on the master worker pool.       */
+/*                                                                            */
+/* landmarks - The landmarks.                                                 */
+/* field - The cost field the landmarks are for.                              */
+/* grid - The grid of the field.                                              */
+/* table - The table to measure.                                              */
+/******************************************************************************/
+typedef struct dt_landmark_job
+{
+  struct dt_landmarks *landmarks;
+  struct dt_cost_field *field;
+  struct dt_grid *grid;
+  int table;
+} DT_LANDMARK_JOB;
+
+/******************************************************************************/
+/* Function: dt_get_landmark_estimate                                         */
+/*                                                                            */
+/* Purpose: Estimate the cost from a point to a goal from landmarks.          */
+/*                                                                            */
+/* Returns: A cost the cheapest path can be no less than, or 0.               */
+/*                                                                            */
+/* Parameters: IN     landmarks - The landmarks, which must not be stale.     */
+/*             IN     tables - The tables to estimate from.                   */
+/*             IN     num_tables - The number of entries in tables.           */
+/*             IN     node - The point, numbered row by row.                  */
+/*             IN     goal_node - The goal, numbered row by row.              */
+/*                                                                            */
+/* Operation: A path from the point to the goal can be no cheaper than the    */
+/*            cost from a landmark to the goal less that from the landmark to */
+/*            the point, nor than the cost from the point to the landmark     */
+/*            less that from the goal to it. Take the highest of these over   */
+/*            the tables given which reach both. A shifted entry stands for a */
+/*            cost up to one less than a shift unit above it, so that much is */
+/*            taken off each bound to keep it low.                            */
+/******************************************************************************/
+static inline Uint32 dt_get_landmark_estimate(DT_LANDMARKS *landmarks,
+                                              const int *tables,
+                                              int num_tables,
+                                              Uint32 node,
+                                              Uint32 goal_node)
+{
+  Uint16 *point = &(landmarks->distances[(size_t) node *
+                                         (size_t) landmarks->num_tables]);
+  Uint16 *goal = &(landmarks->distances[(size_t) goal_node *
+                                        (size_t) landmarks->num_tables]);
+  Uint32 estimate = 0;
+  Uint32 bound;
+  Uint32 further;
+  Uint32 nearer;
+  int table;
+  int ii;
+
+  for (ii = 0; ii < num_tables; ii++)
+  {
+    table = tables[ii];
+    further = (0 == (table & 1)) ? goal[table] : point[table];
+    nearer = (0 == (table & 1)) ? point[table] : goal[table];
+    if ((DT_LANDMARK_UNREACHABLE == further) ||
+        (DT_LANDMARK_UNREACHABLE == nearer) ||
+        (further <= nearer))
+    {
+      continue;
+    }
+    bound = ((further - nearer) << landmarks->shifts[table]) -
+                                       ((1u << landmarks->shifts[table]) - 1);
+    estimate = MAX(estimate, bound);
+  }
+
+  return(estimate);
+}
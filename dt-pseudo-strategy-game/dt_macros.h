@@ -1 +1,3 @@
 #define MIN(a, b) ((a)>(b)?(b):(a))
+#define MAX(a, b) ((a)<(b)?(b):(a))
+#define CLAMP(x, lo, hi) (MIN(MAX((x), (lo)), (hi)))
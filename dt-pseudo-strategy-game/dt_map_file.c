@@ -0,0 +1,2628 @@
+/******************************************************************************/
+/* File: dt_map_file.c                                                        */
+/*                                                                            */
+/* Purpose: Reading and writing the text and binary map file formats          */
+/*          described in dt_map_file.h.                                       */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_load_text_map_file                                            */
+/*                                                                            */
+/* Purpose: Create a grid from a text map.                                    */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the grid was created, otherwise one of      */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     filename - The map file to load.                        */
+/*             IN     max_jobs - The most jobs to share the points between,   */
+/*                               or DT_MAP_TEXT_AUTO_JOBS to choose from the  */
+/*                               size of the master worker pool.              */
+/*             OUT    grid - The new row-major grid. Only set if the map was  */
+/*                           loaded.                                          */
+/*                                                                            */
+/* Operation: Map the whole file into memory and read it through a            */
+/*            DT_MAP_TEXT_READER, which hands back each whitespace separated  */
+/*            token in place. Lines have no meaning beyond separating tokens, */
+/*            so there is no limit on their length. Parse the info line and   */
+/*            create the grid, add a tile type for each tile line and then    */
+/*            read the points, which is shared out between worker threads.    */
+/******************************************************************************/
+int dt_load_text_map_file(char *filename, int max_jobs, DT_GRID **grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAPPED_FILE *mapped_file = NULL;
+  DT_MAP_TEXT_READER reader;
+  DT_GRID *temp_grid = NULL;
+  char *token;
+  size_t length;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Attempt to map the file pointed to by the input filename. An empty file  */
+  /* cannot be mapped, but has no info line either.                           */
+  /****************************************************************************/
+  ret_code = dt_map_file(filename, &mapped_file);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    if ((DT_MAP_FILE_MAP_FAILED == ret_code) &&
+        (0 == dt_get_file_size(filename)))
+    {
+      ret_code = DT_MAP_FILE_NO_INFO_LINE;
+    }
+    goto EXIT_LABEL;
+  }
+  dt_init_map_text_reader(&reader,
+                          (char *) mapped_file->view,
+                          (size_t) mapped_file->size);
+
+  /****************************************************************************/
+  /* Parse the info line and create the grid from it.                         */
+  /****************************************************************************/
+  if (!dt_read_map_token(&reader, &token, &length))
+  {
+    ret_code = DT_MAP_FILE_NO_INFO_LINE;
+    goto EXIT_LABEL;
+  }
+  ret_code = dt_parse_map_info_line(&reader, token, length, &temp_grid);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Add a tile type for each tile line. The first token which does not       */
+  /* start a tile line is the first point.                                    */
+  /****************************************************************************/
+  while (true)
+  {
+    if (!dt_read_map_token(&reader, &token, &length))
+    {
+      ret_code = DT_MAP_FILE_TOO_SHORT;
+      goto EXIT_LABEL;
+    }
+    if ((strlen(DT_MAP_TEXT_TILE_KEYWORD) != length) ||
+        (0 != memcmp(token, DT_MAP_TEXT_TILE_KEYWORD, length)))
+    {
+      break;
+    }
+    ret_code = dt_parse_map_tile_line(&reader, temp_grid);
+    if (DT_MAP_FILE_LOADED != ret_code)
+    {
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Read the points, starting from the token already read.                   */
+  /****************************************************************************/
+  ret_code = dt_read_map_points(&reader, token, max_jobs, temp_grid);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+
+  (*grid) = temp_grid;
+  temp_grid = NULL;
+
+EXIT_LABEL:
+
+  if (NULL != mapped_file)
+  {
+    dt_unmap_file(mapped_file);
+  }
+  if (NULL != temp_grid)
+  {
+    dt_destroy_grid(temp_grid);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_init_map_text_reader                                          */
+/*                                                                            */
+/* Purpose: Set up a reader to read text held in memory a token at a time.    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: OUT    reader - The reader to set up.                          */
+/*             IN     text - The text to read. Need not be null terminated.   */
+/*             IN     length - The number of characters in the text.          */
+/*                                                                            */
+/* Operation: Start the reader at the beginning of the text.                  */
+/******************************************************************************/
+void dt_init_map_text_reader(DT_MAP_TEXT_READER *reader,
+                             char *text,
+                             size_t length)
+{
+  reader->text = text;
+  reader->position = 0;
+  reader->length = length;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_token                                                */
+/*                                                                            */
+/* Purpose: Read the next whitespace separated token from a text map.         */
+/*                                                                            */
+/* Returns: true if a token was read, false at the end of the text.           */
+/*                                                                            */
+/* Parameters: IN/OUT reader - The reader to read from.                       */
+/*             OUT    token - The start of the token in the reader's text. It */
+/*                            is not null terminated.                         */
+/*             OUT    length - The length of the token.                       */
+/*                                                                            */
+/* Operation: Skip whitespace and then scan to the end of the token.          */
+/******************************************************************************/
+bool dt_read_map_token(DT_MAP_TEXT_READER *reader,
+                       char **token,
+                       size_t *length)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  char *text = reader->text;
+  size_t position = reader->position;
+  size_t start;
+  bool found = false;
+
+  while ((position < reader->length) && DT_MAP_TEXT_IS_SPACE(text[position]))
+  {
+    position++;
+  }
+  if (position < reader->length)
+  {
+    start = position;
+    while ((position < reader->length) &&
+           !DT_MAP_TEXT_IS_SPACE(text[position]))
+    {
+      position++;
+    }
+    (*token) = text + start;
+    (*length) = position - start;
+    found = true;
+  }
+
+  reader->position = position;
+
+  return(found);
+}
+
+/******************************************************************************/
+/* Function: dt_parse_map_number                                              */
+/*                                                                            */
+/* Purpose: Parse a decimal number at the start of some text.                 */
+/*                                                                            */
+/* Returns: The number of characters used, or 0 if there is no number there.  */
+/*                                                                            */
+/* Parameters: IN     text - The text to parse. Need not be null terminated.  */
+/*             IN     length - The number of characters available.            */
+/*             IN     allow_negative - Whether a leading "-" is accepted.     */
+/*             OUT    value - The number.                                     */
+/*                                                                            */
+/* Operation: Read an optional sign and then digits up to the first           */
+/*            character which is not a digit. More digits than fit in an int  */
+/*            are rejected.                                                   */
+/******************************************************************************/
+size_t dt_parse_map_number(char *text,
+                           size_t length,
+                           bool allow_negative,
+                           int *value)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t used = 0;
+  size_t first_digit;
+  bool negative = false;
+  int number = 0;
+
+  if (allow_negative && (0 < length) && ('-' == text[0]))
+  {
+    negative = true;
+    used++;
+  }
+  first_digit = used;
+  while ((used < length) && (used - first_digit < DT_MAP_TEXT_MAX_DIGITS) &&
+         (text[used] >= '0') && (text[used] <= '9'))
+  {
+    number = (number * 10) + (text[used] - '0');
+    used++;
+  }
+  if ((used == first_digit) ||
+      ((used < length) && (text[used] >= '0') && (text[used] <= '9')))
+  {
+    used = 0;
+    goto EXIT_LABEL;
+  }
+  (*value) = negative ? -number : number;
+
+EXIT_LABEL:
+
+  return(used);
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_number                                               */
+/*                                                                            */
+/* Purpose: Read a token from a text map which must be a number.              */
+/*                                                                            */
+/* Returns: true if the next token was a number.                              */
+/*                                                                            */
+/* Parameters: IN/OUT reader - The reader to read from.                       */
+/*             OUT    value - The number.                                     */
+/*                                                                            */
+/* Operation: Read the token and check it is all number.                      */
+/******************************************************************************/
+bool dt_read_map_number(DT_MAP_TEXT_READER *reader, int *value)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  char *token;
+  size_t length;
+
+  return(dt_read_map_token(reader, &token, &length) &&
+         (length == dt_parse_map_number(token, length, true, value)));
+}
+
+/******************************************************************************/
+/* Function: dt_parse_map_info_line                                           */
+/*                                                                            */
+/* Purpose: Create a grid from the info line of a text map.                   */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the grid was created.                       */
+/*          DT_MAP_FILE_BAD_INFO_LINE if the line is not valid.               */
+/*                                                                            */
+/* Parameters: IN/OUT reader - The reader, positioned after the first token.  */
+/*             IN     token - The first token of the file.                    */
+/*             IN     length - The length of the first token.                 */
+/*             OUT    grid - The new row-major grid.                          */
+/*                                                                            */
+/* Operation: Check the keyword, read the four sizes and check they are in    */
+/*            range. The layers of the grid are left uninitialised as every   */
+/*            point is about to be read into them.                            */
+/******************************************************************************/
+int dt_parse_map_info_line(DT_MAP_TEXT_READER *reader,
+                           char *token,
+                           size_t length,
+                           DT_GRID **grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int num_tiles_x;
+  int num_tiles_y;
+  int square_width;
+  int square_height;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  if ((strlen(DT_MAP_TEXT_INFO_KEYWORD) != length) ||
+      (0 != memcmp(token, DT_MAP_TEXT_INFO_KEYWORD, length)) ||
+      !dt_read_map_number(reader, &num_tiles_x) ||
+      !dt_read_map_number(reader, &num_tiles_y) ||
+      !dt_read_map_number(reader, &square_width) ||
+      !dt_read_map_number(reader, &square_height) ||
+      (num_tiles_x < 1) || (num_tiles_x > DT_MAP_MAX_DIMENSION) ||
+      (num_tiles_y < 1) || (num_tiles_y > DT_MAP_MAX_DIMENSION) ||
+      (square_width < 1) || (square_height < 1))
+  {
+    ret_code = DT_MAP_FILE_BAD_INFO_LINE;
+    goto EXIT_LABEL;
+  }
+
+  (*grid) = dt_create_empty_grid(square_width,
+                                 square_height,
+                                 num_tiles_x,
+                                 num_tiles_y,
+                                 DT_GRID_STORAGE_ROW_MAJOR);
+  dt_alloc_dense_grid_block(*grid);
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_parse_map_tile_line                                           */
+/*                                                                            */
+/* Purpose: Add the tile type described by a tile line of a text map to a     */
+/*          grid.                                                             */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the tile type was added.                    */
+/*          DT_MAP_FILE_BAD_TILE_LINE if the line is not valid or the tile    */
+/*          type table is full.                                               */
+/*                                                                            */
+/* Parameters: IN/OUT reader - The reader, positioned after the keyword.      */
+/*             IN     grid - The grid to add the tile type to.                */
+/*                                                                            */
+/* Operation: Read the four values and the graphic name and create a tile     */
+/*            from them. The graphic itself is not loaded.                    */
+/******************************************************************************/
+int dt_parse_map_tile_line(DT_MAP_TEXT_READER *reader, DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  char *graphic_name;
+  size_t length;
+  int terrain_type;
+  int elevation;
+  int water_depth;
+  int movement_modifier;
+  int tile_type;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  if (!dt_read_map_number(reader, &terrain_type) ||
+      !dt_read_map_number(reader, &elevation) ||
+      !dt_read_map_number(reader, &water_depth) ||
+      !dt_read_map_number(reader, &movement_modifier) ||
+      !dt_read_map_token(reader, &graphic_name, &length) ||
+      (length >= DT_MAP_GRAPHIC_NAME_LEN) ||
+      (terrain_type < 0) || (terrain_type > 255) ||
+      (DT_MAX_TILE_TYPES <= grid->num_tile_types))
+  {
+    ret_code = DT_MAP_FILE_BAD_TILE_LINE;
+    goto EXIT_LABEL;
+  }
+
+  tile = dt_create_background_tile();
+  tile->terrain_type = terrain_type;
+  tile->elevation = elevation;
+  tile->water_depth = water_depth;
+  tile->movement_modifier = movement_modifier;
+  if ((strlen(DT_MAP_TEXT_NO_GRAPHIC) != length) ||
+      (0 != memcmp(graphic_name, DT_MAP_TEXT_NO_GRAPHIC, length)))
+  {
+    tile->graphic_name = (char *) dt_malloc(length + 1);
+    memcpy(tile->graphic_name, graphic_name, length);
+    tile->graphic_name[length] = '\0';
+  }
+  dt_add_tile_type_to_grid(grid, tile, &tile_type);
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_build_map_tile_type_layers                                    */
+/*                                                                            */
+/* Purpose: Look up the value each tile type of a grid puts in each layer.    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid whose tile types are looked up.         */
+/*             OUT    layers - The layer values of each tile type.            */
+/*                                                                            */
+/* Operation: Clamp the values of each tile to the range of its layer.        */
+/*            Entries with no tile give an empty plain.                       */
+/******************************************************************************/
+void dt_build_map_tile_type_layers(DT_GRID *grid,
+                                   DT_MAP_TILE_TYPE_LAYERS *layers)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  int tile_type;
+
+  for (tile_type = 0; tile_type < grid->num_tile_types; tile_type++)
+  {
+    tile = grid->tile_types[tile_type];
+    if (NULL != tile)
+    {
+      layers->terrain_type[tile_type] = (unsigned char) tile->terrain_type;
+      layers->elevation[tile_type] = (Sint16) CLAMP(tile->elevation,
+                                                    -32768,
+                                                    32767);
+      layers->water_depth[tile_type] =
+                             (unsigned char) CLAMP(tile->water_depth, 0, 255);
+      layers->movement_modifier[tile_type] =
+                       (unsigned char) CLAMP(tile->movement_modifier, 0, 255);
+    }
+    else
+    {
+      layers->terrain_type[tile_type] = DT_GROUND_TYPE_PLAIN;
+      layers->elevation[tile_type] = 0;
+      layers->water_depth[tile_type] = 0;
+      layers->movement_modifier[tile_type] = 0;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_points                                               */
+/*                                                                            */
+/* Purpose: Read every point of a text map into a grid.                       */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if every point was read.                       */
+/*          DT_MAP_FILE_BAD_POINT if a point is not valid or there are too    */
+/*          many of them.                                                     */
+/*          DT_MAP_FILE_TOO_SHORT if the file ends before every point is      */
+/*          given.                                                            */
+/*                                                                            */
+/* Parameters: IN     reader - The reader, positioned after the first point.  */
+/*             IN     first_point - The start of the first point.             */
+/*             IN     max_jobs - The most jobs to share the points between,   */
+/*                               or DT_MAP_TEXT_AUTO_JOBS.                    */
+/*             IN     grid - The new row-major grid to read the points into.  */
+/*                                                                            */
+/* Operation: Cut the rest of the text into one share for each job, each      */
+/*            starting at the start of a point. Count the points in every     */
+/*            share in parallel to find the index of the first point of each, */
+/*            then read the shares into the grid in parallel. The result is   */
+/*            the same however many jobs are used, as is the error reported   */
+/*            for a bad file: a bad point anywhere is reported ahead of the   */
+/*            file being too short, as it is when reading from the start.     */
+/******************************************************************************/
+int dt_read_map_points(DT_MAP_TEXT_READER *reader,
+                       char *first_point,
+                       int max_jobs,
+                       DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_WORKER_POOL *pool;
+  DT_MAP_TILE_TYPE_LAYERS layers;
+  DT_MAP_TEXT_LOAD_JOB *jobs;
+  char *text_end;
+  char *share_start;
+  char *share_end;
+  size_t text_length;
+  size_t first_index;
+  int num_jobs;
+  int ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  dt_build_map_tile_type_layers(grid, &layers);
+
+  /****************************************************************************/
+  /* Decide how many jobs to use. Left to itself this gives each thread a few */
+  /* jobs, but no job less than DT_MAP_TEXT_MIN_JOB_BYTES of text.            */
+  /****************************************************************************/
+  pool = dt_get_master_worker_pool();
+  text_end = reader->text + reader->length;
+  text_length = (size_t) (text_end - first_point);
+  if (DT_MAP_TEXT_AUTO_JOBS == max_jobs)
+  {
+    max_jobs = (pool->num_threads + 1) * DT_MAP_TEXT_JOBS_PER_THREAD;
+    num_jobs = (int) MIN((size_t) max_jobs,
+                         text_length / DT_MAP_TEXT_MIN_JOB_BYTES);
+  }
+  else
+  {
+    num_jobs = (int) MIN((size_t) max_jobs, text_length);
+  }
+  num_jobs = MAX(num_jobs, 1);
+
+  /****************************************************************************/
+  /* Cut the text into shares of about the same length. Each share after the  */
+  /* first is moved on to the start of the next point.                        */
+  /****************************************************************************/
+  jobs = (DT_MAP_TEXT_LOAD_JOB *) dt_malloc(sizeof(DT_MAP_TEXT_LOAD_JOB) *
+                                            (size_t) num_jobs);
+  share_start = first_point;
+  for (ii = 0; ii < num_jobs; ii++)
+  {
+    if ((num_jobs - 1) == ii)
+    {
+      share_end = text_end;
+    }
+    else
+    {
+      share_end = first_point + ((text_length / num_jobs) * (ii + 1));
+      share_end = MAX(share_end, share_start);
+      while ((share_end < text_end) && !DT_MAP_TEXT_IS_SPACE(*share_end))
+      {
+        share_end++;
+      }
+      while ((share_end < text_end) && DT_MAP_TEXT_IS_SPACE(*share_end))
+      {
+        share_end++;
+      }
+    }
+    jobs[ii].grid = grid;
+    jobs[ii].layers = &layers;
+    jobs[ii].text = share_start;
+    jobs[ii].share_length = (size_t) (share_end - share_start);
+    jobs[ii].text_length = (size_t) (text_end - share_start);
+    jobs[ii].num_tokens = 0;
+    jobs[ii].ret_code = DT_MAP_FILE_LOADED;
+    share_start = share_end;
+  }
+
+  /****************************************************************************/
+  /* Count the points in each share, unless there is only the one, and work   */
+  /* out which points each job reads.                                         */
+  /****************************************************************************/
+  if (1 < num_jobs)
+  {
+    dt_run_worker_pool_jobs(pool,
+                            dt_count_map_points_job,
+                            jobs,
+                            sizeof(DT_MAP_TEXT_LOAD_JOB),
+                            num_jobs);
+  }
+  first_index = 0;
+  for (ii = 0; ii < num_jobs; ii++)
+  {
+    jobs[ii].first_index = first_index;
+    jobs[ii].start_index = dt_align_map_point_index(grid, first_index);
+    if (0 != ii)
+    {
+      jobs[ii - 1].end_index = jobs[ii].start_index;
+    }
+    first_index += jobs[ii].num_tokens;
+  }
+  jobs[num_jobs - 1].end_index = grid->num_points;
+
+  /****************************************************************************/
+  /* Read the points.                                                         */
+  /****************************************************************************/
+  dt_run_worker_pool_jobs(pool,
+                          dt_read_map_points_job,
+                          jobs,
+                          sizeof(DT_MAP_TEXT_LOAD_JOB),
+                          num_jobs);
+  for (ii = 0; ii < num_jobs; ii++)
+  {
+    if ((DT_MAP_FILE_LOADED != jobs[ii].ret_code) &&
+        (DT_MAP_FILE_BAD_POINT != ret_code))
+    {
+      ret_code = jobs[ii].ret_code;
+    }
+  }
+
+  dt_free(jobs);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_align_map_point_index                                         */
+/*                                                                            */
+/* Purpose: Find the first point at or after a given one which starts a word  */
+/*          of the traversable bitmap.                                        */
+/*                                                                            */
+/* Returns: The index of that point, or the number of points in the grid if   */
+/*          there is none.                                                    */
+/*                                                                            */
+/* Parameters: IN     grid - The row-major grid.                              */
+/*             IN     index - The index of the point to start from.           */
+/*                                                                            */
+/* Operation: Round the column up to a multiple of DT_GRID_BITS_PER_WORD,     */
+/*            going on to the start of the next row if that is past the end   */
+/*            of this one.                                                    */
+/******************************************************************************/
+size_t dt_align_map_point_index(DT_GRID *grid, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t col;
+  size_t aligned_col;
+
+  if (index >= grid->num_points)
+  {
+    index = grid->num_points;
+    goto EXIT_LABEL;
+  }
+  col = index % (size_t) grid->num_tiles_x;
+  aligned_col = (col + DT_GRID_WORD_MASK) & ~((size_t) DT_GRID_WORD_MASK);
+  aligned_col = MIN(aligned_col, (size_t) grid->num_tiles_x);
+  index += aligned_col - col;
+
+EXIT_LABEL:
+
+  return(index);
+}
+
+/******************************************************************************/
+/* Function: dt_count_map_points_job                                          */
+/*                                                                            */
+/* Purpose: Count the points which start in one share of a text map.          */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT data - The DT_MAP_TEXT_LOAD_JOB. Sets num_tokens.       */
+/*                                                                            */
+/* Operation: Count the characters which are not whitespace but follow        */
+/*            whitespace or the start of the share. Each is the start of a    */
+/*            point, whether or not it is a valid one.                        */
+/******************************************************************************/
+void dt_count_map_points_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_TEXT_LOAD_JOB *job = (DT_MAP_TEXT_LOAD_JOB *) data;
+  char *text = job->text;
+  size_t num_tokens = 0;
+  size_t ii;
+  bool in_space = true;
+
+  for (ii = 0; ii < job->share_length; ii++)
+  {
+    if (DT_MAP_TEXT_IS_SPACE(text[ii]))
+    {
+      in_space = true;
+    }
+    else if (in_space)
+    {
+      num_tokens++;
+      in_space = false;
+    }
+  }
+  job->num_tokens = num_tokens;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_points_job                                           */
+/*                                                                            */
+/* Purpose: Read the points of one share of a text map into the grid.         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT data - The DT_MAP_TEXT_LOAD_JOB. Sets ret_code.         */
+/*                                                                            */
+/* Operation: Skip the points at the start of the share which finish the last */
+/*            traversable word of the job before, then read each point from   */
+/*            start_index up to end_index, carrying on into the next share if */
+/*            need be. Write each point straight into the layers and gather   */
+/*            its traversable bit into a word, which is stored whole once it  */
+/*            is complete so that no other job shares it. The padding bits at */
+/*            the end of each row are left clear. The job which reads the     */
+/*            last point checks that nothing follows it.                      */
+/******************************************************************************/
+void dt_read_map_points_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_TEXT_LOAD_JOB *job = (DT_MAP_TEXT_LOAD_JOB *) data;
+  DT_GRID *grid = job->grid;
+  DT_MAP_TILE_TYPE_LAYERS *layers = job->layers;
+  DT_MAP_TEXT_READER reader;
+  Uint32 *traversable_row;
+  Uint32 word = 0;
+  char *token;
+  size_t length;
+  size_t index;
+  size_t used;
+  size_t next;
+  int tile_type;
+  int elevation;
+  int water_depth;
+  int col;
+  bool traversable;
+
+  job->ret_code = DT_MAP_FILE_LOADED;
+  dt_init_map_text_reader(&reader, job->text, job->text_length);
+
+  /****************************************************************************/
+  /* A share which starts after the last point holds nothing but extra        */
+  /* points.                                                                  */
+  /****************************************************************************/
+  if (job->first_index >= grid->num_points)
+  {
+    if (0 != job->num_tokens)
+    {
+      job->ret_code = DT_MAP_FILE_BAD_POINT;
+    }
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Skip the points read by the job before.                                  */
+  /****************************************************************************/
+  for (index = job->first_index; index < job->start_index; index++)
+  {
+    if (!dt_read_map_token(&reader, &token, &length))
+    {
+      job->ret_code = DT_MAP_FILE_TOO_SHORT;
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Read each point in turn.                                                 */
+  /****************************************************************************/
+  col = (int) (index % (size_t) grid->num_tiles_x);
+  traversable_row = grid->traversable +
+            ((index / (size_t) grid->num_tiles_x) *
+                                      (size_t) grid->traversable_words_per_row);
+  for (; index < job->end_index; index++)
+  {
+    if (!dt_read_map_token(&reader, &token, &length))
+    {
+      job->ret_code = DT_MAP_FILE_TOO_SHORT;
+      goto EXIT_LABEL;
+    }
+
+    /**************************************************************************/
+    /* Read the blocked marker and the tile type.                             */
+    /**************************************************************************/
+    used = 0;
+    traversable = true;
+    if (DT_MAP_TEXT_BLOCKED_CHAR == token[0])
+    {
+      traversable = false;
+      used++;
+    }
+    next = dt_parse_map_number(token + used, length - used, false, &tile_type);
+    if ((0 == next) || (tile_type >= grid->num_tile_types))
+    {
+      job->ret_code = DT_MAP_FILE_BAD_POINT;
+      goto EXIT_LABEL;
+    }
+    used += next;
+    elevation = layers->elevation[tile_type];
+    water_depth = layers->water_depth[tile_type];
+
+    /**************************************************************************/
+    /* Read the overrides.                                                    */
+    /**************************************************************************/
+    if ((used < length) && (DT_MAP_TEXT_SEPARATOR_CHAR == token[used]))
+    {
+      used++;
+      next = dt_parse_map_number(token + used, length - used, true, &elevation);
+      if (0 == next)
+      {
+        job->ret_code = DT_MAP_FILE_BAD_POINT;
+        goto EXIT_LABEL;
+      }
+      used += next;
+      if ((used < length) && (DT_MAP_TEXT_SEPARATOR_CHAR == token[used]))
+      {
+        used++;
+        next = dt_parse_map_number(token + used,
+                                   length - used,
+                                   true,
+                                   &water_depth);
+        if (0 == next)
+        {
+          job->ret_code = DT_MAP_FILE_BAD_POINT;
+          goto EXIT_LABEL;
+        }
+        used += next;
+      }
+    }
+    if (used != length)
+    {
+      job->ret_code = DT_MAP_FILE_BAD_POINT;
+      goto EXIT_LABEL;
+    }
+
+    /**************************************************************************/
+    /* Store the point.                                                       */
+    /**************************************************************************/
+    dt_init_grid_element(&(grid->map_grid[index]));
+    grid->tile_type[index] = (unsigned char) tile_type;
+    grid->terrain_type[index] = layers->terrain_type[tile_type];
+    grid->elevation[index] = (Sint16) CLAMP(elevation, -32768, 32767);
+    grid->water_depth[index] = (unsigned char) CLAMP(water_depth, 0, 255);
+    grid->movement_modifier[index] = layers->movement_modifier[tile_type];
+
+    /**************************************************************************/
+    /* Store the traversable word once it is complete.                        */
+    /**************************************************************************/
+    if (traversable)
+    {
+      word |= 1u << (col & DT_GRID_WORD_MASK);
+    }
+    col++;
+    if ((0 == (col & DT_GRID_WORD_MASK)) || (grid->num_tiles_x == col))
+    {
+      traversable_row[(col - 1) >> DT_GRID_WORD_SHIFT] = word;
+      word = 0;
+      if (grid->num_tiles_x == col)
+      {
+        col = 0;
+        traversable_row += grid->traversable_words_per_row;
+      }
+    }
+  }
+
+  /****************************************************************************/
+  /* Check there is nothing after the last point.                             */
+  /****************************************************************************/
+  if ((grid->num_points == job->end_index) &&
+      dt_read_map_token(&reader, &token, &length))
+  {
+    job->ret_code = DT_MAP_FILE_BAD_POINT;
+  }
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_write_text_map_file                                           */
+/*                                                                            */
+/* Purpose: Write a grid out as a text map.                                   */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written.                        */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be created.           */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to write.                               */
+/*             IN     filename - The file to write it to.                     */
+/*                                                                            */
+/* Operation: Write the info line and the tile lines, then each row of points */
+/*            on its own line. A point only has overrides written if its      */
+/*            elevation or water depth differs from its tile type. Movement   */
+/*            modifier overrides cannot be held in a text map and are lost.   */
+/*            Each row is formatted into a buffer and written in one go.      */
+/******************************************************************************/
+int dt_write_text_map_file(DT_GRID *grid, char *filename)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  FILE *map_file = NULL;
+  DT_BACKGROUND_TILE *tile;
+  char *row_text;
+  char *cursor;
+  int tile_type;
+  int elevation;
+  int water_depth;
+  int base_elevation;
+  int base_water_depth;
+  int row;
+  int col;
+  int ret_val = DT_FILE_OPEN_OK;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  row_text = (char *) dt_malloc((size_t) grid->num_tiles_x *
+                                             DT_MAP_TEXT_MAX_POINT_LEN + 1);
+
+  /****************************************************************************/
+  /* Create the file and write the info line and tile lines.                  */
+  /****************************************************************************/
+  ret_val = dt_open_file(filename, FILE_MODE_WRITE_BINARY, &map_file);
+  if (DT_FILE_OPEN_OK != ret_val)
+  {
+    map_file = NULL;
+    ret_code = DT_MAP_FILE_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  fprintf(map_file,
+          "%s %d %d %d %d\n",
+          DT_MAP_TEXT_INFO_KEYWORD,
+          grid->num_tiles_x,
+          grid->num_tiles_y,
+          grid->square_width,
+          grid->square_height);
+  for (tile_type = DT_TILE_TYPE_NONE + 1;
+       tile_type < grid->num_tile_types;
+       tile_type++)
+  {
+    tile = grid->tile_types[tile_type];
+    fprintf(map_file,
+            "%s %d %d %d %d %s\n",
+            DT_MAP_TEXT_TILE_KEYWORD,
+            tile->terrain_type,
+            tile->elevation,
+            tile->water_depth,
+            tile->movement_modifier,
+            (NULL != tile->graphic_name) ?
+                                   tile->graphic_name : DT_MAP_TEXT_NO_GRAPHIC);
+  }
+
+  /****************************************************************************/
+  /* Write each row of points.                                                */
+  /****************************************************************************/
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    cursor = row_text;
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      tile_type = dt_get_grid_tile_type(grid, col, row);
+      tile = grid->tile_types[tile_type];
+      base_elevation = (NULL != tile) ? CLAMP(tile->elevation, -32768, 32767)
+                                      : 0;
+      base_water_depth = (NULL != tile) ? CLAMP(tile->water_depth, 0, 255) : 0;
+      elevation = dt_get_grid_elevation(grid, col, row);
+      water_depth = dt_get_grid_water_depth(grid, col, row);
+
+      if (0 != col)
+      {
+        *(cursor++) = ' ';
+      }
+      if (!dt_is_grid_traversable(grid, col, row))
+      {
+        *(cursor++) = DT_MAP_TEXT_BLOCKED_CHAR;
+      }
+      cursor += dt_format_map_number(cursor, tile_type);
+      if ((elevation != base_elevation) || (water_depth != base_water_depth))
+      {
+        *(cursor++) = DT_MAP_TEXT_SEPARATOR_CHAR;
+        cursor += dt_format_map_number(cursor, elevation);
+        if (water_depth != base_water_depth)
+        {
+          *(cursor++) = DT_MAP_TEXT_SEPARATOR_CHAR;
+          cursor += dt_format_map_number(cursor, water_depth);
+        }
+      }
+    }
+    *(cursor++) = '\n';
+    if ((size_t) (cursor - row_text) !=
+                    fwrite(row_text, 1, (size_t) (cursor - row_text), map_file))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      goto EXIT_LABEL;
+    }
+  }
+
+EXIT_LABEL:
+
+  if (NULL != map_file)
+  {
+    if ((0 != fclose(map_file)) && (DT_MAP_FILE_LOADED == ret_code))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+    }
+  }
+  dt_free(row_text);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_format_map_number                                             */
+/*                                                                            */
+/* Purpose: Write a number into a text map row in decimal.                    */
+/*                                                                            */
+/* Returns: The number of characters written.                                 */
+/*                                                                            */
+/* Parameters: OUT    text - Where to write the number. It is not null        */
+/*                           terminated.                                      */
+/*             IN     value - The number, between -32768 and 65535.           */
+/*                                                                            */
+/* Operation: Write the sign and then the digits from the most significant.   */
+/******************************************************************************/
+int dt_format_map_number(char *text, int value)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  char digits[8];
+  int num_digits = 0;
+  int used = 0;
+
+  if (value < 0)
+  {
+    text[used++] = '-';
+    value = -value;
+  }
+  do
+  {
+    digits[num_digits++] = (char) ('0' + (value % 10));
+    value /= 10;
+  } while (0 != value);
+  while (num_digits > 0)
+  {
+    text[used++] = digits[--num_digits];
+  }
+
+  return(used);
+}
+
+/******************************************************************************/
+/* Function: dt_load_binary_map_file                                          */
+/*                                                                            */
+/* Purpose: Create a grid from a binary map without copying its layers.       */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the grid was created, otherwise one of      */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     filename - The map file to load.                        */
+/*             OUT    grid - The new grid. Only set if the map was loaded.    */
+/*                                                                            */
+/* Operation: Map the file into memory and check the header describes a map   */
+/*            which fits in it. Create a grid with no storage, point its      */
+/*            layers straight into the mapping and create the tile types.     */
+/*            Only the element block is allocated. It is zeroed, which leaves */
+/*            every unit pointer NULL, and the system does not commit the     */
+/*            pages until they are used so even huge maps load in the time it */
+/*            takes to read the header.                                       */
+/*            A chunked map is instead copied into a chunked grid a chunk at  */
+/*            a time and the file is unmapped again.                          */
+/******************************************************************************/
+int dt_load_binary_map_file(char *filename, DT_GRID **grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAPPED_FILE *mapped_file = NULL;
+  DT_MAP_FILE_HEADER *header;
+  DT_GRID *temp_grid = NULL;
+  unsigned char *view;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Map the file and check the header.                                       */
+  /****************************************************************************/
+  ret_code = dt_map_file(filename, &mapped_file);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    mapped_file = NULL;
+    goto EXIT_LABEL;
+  }
+  ret_code = dt_check_map_file_header(mapped_file->view, mapped_file->size);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+  view = mapped_file->view;
+  header = (DT_MAP_FILE_HEADER *) view;
+
+  /****************************************************************************/
+  /* Copy the chunks of a chunked map into a chunked grid.                    */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED == header->storage)
+  {
+    temp_grid = dt_create_grid_with_storage((int) header->square_width,
+                                            (int) header->square_height,
+                                            (int) header->num_tiles_x,
+                                            (int) header->num_tiles_y,
+                                            DT_GRID_STORAGE_CHUNKED);
+    ret_code = dt_read_map_file_chunks(temp_grid,
+                                       view,
+                                       (DT_MAP_FILE_CHUNK_ENTRY *)
+                                         (view + header->chunk_table_offset),
+                                       header->file_size);
+    if (DT_MAP_FILE_LOADED != ret_code)
+    {
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Otherwise create the grid and point its layers into the mapping.         */
+  /****************************************************************************/
+  else
+  {
+    temp_grid = dt_create_empty_grid((int) header->square_width,
+                                     (int) header->square_height,
+                                     (int) header->num_tiles_x,
+                                     (int) header->num_tiles_y,
+                                     (int) header->storage);
+    temp_grid->mapped_file = mapped_file;
+    mapped_file = NULL;
+    temp_grid->map_grid =
+                  (DT_GRID_ELEMENT *) dt_calloc(temp_grid->num_points,
+                                                sizeof(DT_GRID_ELEMENT));
+    temp_grid->traversable = (Uint32 *) (view + header->traversable_offset);
+    temp_grid->elevation = (Sint16 *) (view + header->elevation_offset);
+    temp_grid->tile_type = view + header->tile_type_offset;
+    temp_grid->terrain_type = view + header->terrain_type_offset;
+    temp_grid->water_depth = view + header->water_depth_offset;
+    temp_grid->movement_modifier = view + header->movement_modifier_offset;
+  }
+
+  /****************************************************************************/
+  /* Create the tile types. The first record is DT_TILE_TYPE_NONE which has   */
+  /* no tile.                                                                 */
+  /****************************************************************************/
+  dt_add_map_file_tile_types(temp_grid,
+                             (DT_MAP_FILE_TILE_TYPE *)
+                                                 (view + header->header_size),
+                             header->num_tile_types);
+
+  (*grid) = temp_grid;
+  temp_grid = NULL;
+
+EXIT_LABEL:
+
+  if (NULL != temp_grid)
+  {
+    dt_destroy_grid(temp_grid);
+  }
+  if (NULL != mapped_file)
+  {
+    dt_unmap_file(mapped_file);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_add_map_file_tile_types                                       */
+/*                                                                            */
+/* Purpose: Create the tile types held in a binary map.                       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to add the tile types to.               */
+/*             IN     records - The tile type records of the map.             */
+/*             IN     num_tile_types - The number of records.                 */
+/*                                                                            */
+/* Operation: The first record is DT_TILE_TYPE_NONE which has no tile. Create */
+/*            a tile for each of the others.                                  */
+/******************************************************************************/
+void dt_add_map_file_tile_types(DT_GRID *grid,
+                                DT_MAP_FILE_TILE_TYPE *records,
+                                Uint32 num_tile_types)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_BACKGROUND_TILE *tile;
+  Uint32 ii;
+  int tile_type;
+
+  for (ii = DT_TILE_TYPE_NONE + 1; ii < num_tile_types; ii++)
+  {
+    tile = dt_create_background_tile();
+    tile->terrain_type = records[ii].terrain_type;
+    tile->elevation = records[ii].elevation;
+    tile->water_depth = records[ii].water_depth;
+    tile->movement_modifier = records[ii].movement_modifier;
+    if ('\0' != records[ii].graphic_name[0])
+    {
+      tile->graphic_name = (char *) dt_malloc(DT_MAP_GRAPHIC_NAME_LEN);
+      strncpy(tile->graphic_name,
+              records[ii].graphic_name,
+              DT_MAP_GRAPHIC_NAME_LEN);
+      tile->graphic_name[DT_MAP_GRAPHIC_NAME_LEN - 1] = '\0';
+    }
+    dt_add_tile_type_to_grid(grid, tile, &tile_type);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_read_map_file_chunks                                          */
+/*                                                                            */
+/* Purpose: Copy every chunk of a chunked binary map into a chunked grid.     */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if every chunk was copied.                     */
+/*          DT_MAP_FILE_BAD_CHUNK if a chunk table entry is not valid.        */
+/*                                                                            */
+/* Parameters: IN     grid - The new chunked grid.                            */
+/*             IN     view - The start of the file in memory.                 */
+/*             IN     chunk_table - The chunk table of the map.               */
+/*             IN     file_size - The size of the file.                       */
+/*                                                                            */
+/* Operation: Chunks with no record are left as the default chunk. Every      */
+/*            other chunk is allocated and filled from its record, which is   */
+/*            decoded first if it is compressed.                              */
+/******************************************************************************/
+int dt_read_map_file_chunks(DT_GRID *grid,
+                            unsigned char *view,
+                            DT_MAP_FILE_CHUNK_ENTRY *chunk_table,
+                            Uint64 file_size)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_FILE_CHUNK_ENTRY *entry;
+  DT_MAP_FILE_CHUNK *record;
+  DT_GRID_CHUNK *chunk;
+  size_t num_chunks;
+  size_t ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  record = (DT_MAP_FILE_CHUNK *) dt_malloc(sizeof(DT_MAP_FILE_CHUNK));
+  num_chunks = (size_t) grid->num_chunks_x * (size_t) grid->num_chunks_y;
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    entry = &(chunk_table[ii]);
+    if (!dt_check_map_file_chunk_entry(entry, file_size))
+    {
+      ret_code = DT_MAP_FILE_BAD_CHUNK;
+      goto EXIT_LABEL;
+    }
+    if (0 == entry->offset)
+    {
+      continue;
+    }
+    if (DT_CHUNK_ENCODING_RAW == entry->encoding)
+    {
+      memcpy(record, view + entry->offset, sizeof(DT_MAP_FILE_CHUNK));
+    }
+    else if (!dt_decode_map_file_chunk(view + entry->offset,
+                                       entry->size,
+                                       (int) entry->encoding,
+                                       record))
+    {
+      ret_code = DT_MAP_FILE_BAD_CHUNK;
+      goto EXIT_LABEL;
+    }
+    chunk = (DT_GRID_CHUNK *) dt_malloc(sizeof(DT_GRID_CHUNK));
+    dt_copy_map_file_chunk(record, chunk);
+    grid->chunks[ii] = chunk;
+    (grid->num_allocated_chunks)++;
+  }
+
+EXIT_LABEL:
+
+  dt_free(record);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_load_compressed_map_file                                      */
+/*                                                                            */
+/* Purpose: Create a grid from a chunked binary map which keeps its chunks    */
+/*          compressed in memory until they are used.                         */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the grid was created, otherwise one of      */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     filename - The map file to load.                        */
+/*             IN     max_inflated_chunks - The number of chunks to leave     */
+/*                                          inflated when the grid is         */
+/*                                          compacted.                        */
+/*             OUT    grid - The new grid. Only set if the map was loaded.    */
+/*                                                                            */
+/* Operation: Map the file and check it is chunked. Copy each record into the */
+/*            chunk store of a new chunked grid as it is in the file and      */
+/*            leave its chunk table entry NULL, so the chunk is only decoded  */
+/*            when it is first accessed. Chunks written to are compressed     */
+/*            again with zlib, the smallest encoding.                         */
+/******************************************************************************/
+int dt_load_compressed_map_file(char *filename,
+                                int max_inflated_chunks,
+                                DT_GRID **grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAPPED_FILE *mapped_file = NULL;
+  DT_MAP_FILE_HEADER *header;
+  DT_MAP_FILE_CHUNK_ENTRY *chunk_table;
+  DT_COMPRESSED_CHUNK *compressed;
+  DT_CHUNK_STORE *store;
+  DT_GRID *temp_grid = NULL;
+  unsigned char *view;
+  size_t num_chunks;
+  size_t ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Map the file and check the header.                                       */
+  /****************************************************************************/
+  ret_code = dt_map_file(filename, &mapped_file);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    mapped_file = NULL;
+    goto EXIT_LABEL;
+  }
+  ret_code = dt_check_map_file_header(mapped_file->view, mapped_file->size);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+  view = mapped_file->view;
+  header = (DT_MAP_FILE_HEADER *) view;
+  if (DT_GRID_STORAGE_CHUNKED != header->storage)
+  {
+    ret_code = DT_MAP_FILE_NOT_CHUNKED;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Create the grid and copy each record into its chunk store.               */
+  /****************************************************************************/
+  temp_grid = dt_create_grid_with_storage((int) header->square_width,
+                                          (int) header->square_height,
+                                          (int) header->num_tiles_x,
+                                          (int) header->num_tiles_y,
+                                          DT_GRID_STORAGE_CHUNKED);
+  num_chunks = (size_t) temp_grid->num_chunks_x *
+                                         (size_t) temp_grid->num_chunks_y;
+  store = dt_create_chunk_store(num_chunks,
+                                DT_CHUNK_ENCODING_ZLIB,
+                                max_inflated_chunks);
+  temp_grid->chunk_store = store;
+  chunk_table = (DT_MAP_FILE_CHUNK_ENTRY *) (view + header->chunk_table_offset);
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (!dt_check_map_file_chunk_entry(&(chunk_table[ii]), header->file_size))
+    {
+      ret_code = DT_MAP_FILE_BAD_CHUNK;
+      goto EXIT_LABEL;
+    }
+    if (0 == chunk_table[ii].offset)
+    {
+      continue;
+    }
+    compressed = &(store->chunks[ii]);
+    compressed->size = chunk_table[ii].size;
+    compressed->encoding = chunk_table[ii].encoding;
+    compressed->data = (unsigned char *) dt_malloc(compressed->size);
+    memcpy(compressed->data, view + chunk_table[ii].offset, compressed->size);
+    store->compressed_bytes += compressed->size;
+    temp_grid->chunks[ii] = NULL;
+  }
+  dt_add_map_file_tile_types(temp_grid,
+                             (DT_MAP_FILE_TILE_TYPE *)
+                                                 (view + header->header_size),
+                             header->num_tile_types);
+
+  (*grid) = temp_grid;
+  temp_grid = NULL;
+
+EXIT_LABEL:
+
+  if (NULL != temp_grid)
+  {
+    dt_destroy_grid(temp_grid);
+  }
+  if (NULL != mapped_file)
+  {
+    dt_unmap_file(mapped_file);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_check_map_file_chunk_entry                                    */
+/*                                                                            */
+/* Purpose: Check a chunk table entry of a chunked binary map.                */
+/*                                                                            */
+/* Returns: true if the chunk has no record or its record lies in the file.   */
+/*                                                                            */
+/* Parameters: IN     entry - The chunk table entry.                          */
+/*             IN     file_size - The size of the file.                       */
+/*                                                                            */
+/* Operation: Check the encoding is known and the record is a possible size   */
+/*            for it and lies within the file. Raw records must also be       */
+/*            aligned. The values in the record are not checked.              */
+/******************************************************************************/
+bool dt_check_map_file_chunk_entry(DT_MAP_FILE_CHUNK_ENTRY *entry,
+                                   Uint64 file_size)
+{
+  return((0 == entry->offset) ||
+         (dt_check_chunk_encoding((int) entry->encoding, entry->size) &&
+          ((DT_CHUNK_ENCODING_RAW != entry->encoding) ||
+           (0 == (entry->offset % DT_MAP_FILE_ALIGNMENT))) &&
+          (entry->offset < file_size) &&
+          (entry->size <= file_size - entry->offset)));
+}
+
+/******************************************************************************/
+/* Function: dt_copy_map_file_chunk                                           */
+/*                                                                            */
+/* Purpose: Fill a grid chunk from the record of a chunk in a binary map.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     record - The chunk record.                              */
+/*             OUT    chunk - The chunk to fill.                              */
+/*                                                                            */
+/* Operation: Copy each layer and set every element empty.                    */
+/******************************************************************************/
+void dt_copy_map_file_chunk(DT_MAP_FILE_CHUNK *record, DT_GRID_CHUNK *chunk)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < DT_GRID_CHUNK_POINTS; ii++)
+  {
+    dt_init_grid_element(&(chunk->elements[ii]));
+  }
+  memcpy(chunk->traversable, record->traversable, sizeof(chunk->traversable));
+  memcpy(chunk->elevation, record->elevation, sizeof(chunk->elevation));
+  memcpy(chunk->tile_type, record->tile_type, sizeof(chunk->tile_type));
+  memcpy(chunk->terrain_type,
+         record->terrain_type,
+         sizeof(chunk->terrain_type));
+  memcpy(chunk->water_depth, record->water_depth, sizeof(chunk->water_depth));
+  memcpy(chunk->movement_modifier,
+         record->movement_modifier,
+         sizeof(chunk->movement_modifier));
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_fill_map_file_chunk                                           */
+/*                                                                            */
+/* Purpose: Fill the record of a chunk in a binary map from a grid chunk.     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     chunk - The chunk.                                      */
+/*             OUT    record - The record to fill.                            */
+/*                                                                            */
+/* Operation: Copy each layer. The elements are not stored.                   */
+/******************************************************************************/
+void dt_fill_map_file_chunk(DT_GRID_CHUNK *chunk, DT_MAP_FILE_CHUNK *record)
+{
+  memcpy(record->traversable, chunk->traversable, sizeof(chunk->traversable));
+  memcpy(record->elevation, chunk->elevation, sizeof(chunk->elevation));
+  memcpy(record->tile_type, chunk->tile_type, sizeof(chunk->tile_type));
+  memcpy(record->terrain_type,
+         chunk->terrain_type,
+         sizeof(chunk->terrain_type));
+  memcpy(record->water_depth, chunk->water_depth, sizeof(chunk->water_depth));
+  memcpy(record->movement_modifier,
+         chunk->movement_modifier,
+         sizeof(chunk->movement_modifier));
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_check_map_file_header                                         */
+/*                                                                            */
+/* Purpose: Check that the header of a binary map describes a map which fits  */
+/*          in the file.                                                      */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the header is valid.                        */
+/*          DT_MAP_FILE_BAD_HEADER if it is not.                              */
+/*                                                                            */
+/* Parameters: IN     view - The start of the file in memory.                 */
+/*             IN     file_size - The size of the file.                       */
+/*                                                                            */
+/* Operation: Check the identifying values, then that the sizes agree with    */
+/*            the dimensions and that every layer is aligned and lies within  */
+/*            the file. Only the header is read so this takes the same time   */
+/*            however large the map is. The values in the layers are not      */
+/*            checked. Tile types beyond the end of the table have no tile,   */
+/*            so they are drawn as empty points rather than causing harm.     */
+/*            Chunked maps have no layers. Instead their chunk table must be  */
+/*            aligned and lie within the file. Each entry is only checked     */
+/*            when its chunk is read.                                         */
+/******************************************************************************/
+int dt_check_map_file_header(unsigned char *view, Uint64 file_size)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_FILE_HEADER *header = (DT_MAP_FILE_HEADER *) view;
+  Uint64 num_points;
+  Uint64 num_chunks;
+  Uint64 words_per_row;
+  Uint64 data_start;
+  Uint64 offsets[6];
+  Uint64 lengths[6];
+  int ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Check the identifying values. A version 1 header ends before             */
+  /* chunk_table_offset, so that field must not be read from it. Version 2    */
+  /* chunk table entries are laid out as version 3 entries which are never    */
+  /* compressed.                                                              */
+  /****************************************************************************/
+  if ((file_size < DT_MAP_FILE_VERSION_1_HEADER_SIZE) ||
+      (DT_MAP_FILE_MAGIC != header->magic) ||
+      ((((DT_MAP_FILE_VERSION != header->version) &&
+         (DT_MAP_FILE_VERSION_2 != header->version)) ||
+        (sizeof(DT_MAP_FILE_HEADER) != header->header_size)) &&
+       ((DT_MAP_FILE_VERSION_1 != header->version) ||
+        (DT_MAP_FILE_VERSION_1_HEADER_SIZE != header->header_size))) ||
+      (file_size < header->header_size) ||
+      (file_size != header->file_size))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Check the dimensions.                                                    */
+  /****************************************************************************/
+  if (((DT_GRID_STORAGE_ROW_MAJOR != header->storage) &&
+       (DT_GRID_STORAGE_MORTON != header->storage) &&
+       ((DT_GRID_STORAGE_CHUNKED != header->storage) ||
+        (DT_MAP_FILE_VERSION_1 == header->version))) ||
+      (header->num_tiles_x < 1) ||
+      (header->num_tiles_x > DT_MAP_MAX_DIMENSION) ||
+      (header->num_tiles_y < 1) ||
+      (header->num_tiles_y > DT_MAP_MAX_DIMENSION) ||
+      (header->square_width < 1) || (header->square_width > INT_MAX) ||
+      (header->square_height < 1) || (header->square_height > INT_MAX) ||
+      (header->num_tile_types < DT_TILE_TYPE_NONE + 1) ||
+      (header->num_tile_types > DT_MAX_TILE_TYPES))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Check the layer sizes agree with the dimensions.                         */
+  /****************************************************************************/
+  words_per_row = (header->num_tiles_x + DT_GRID_BITS_PER_WORD - 1) >>
+                                                            DT_GRID_WORD_SHIFT;
+  if (DT_GRID_STORAGE_CHUNKED == header->storage)
+  {
+    num_points = 0;
+  }
+  else if (DT_GRID_STORAGE_MORTON == header->storage)
+  {
+    num_points = (Uint64) dt_morton_encode(header->num_tiles_x - 1,
+                                           header->num_tiles_y - 1) + 1;
+  }
+  else
+  {
+    num_points = (Uint64) header->num_tiles_x * (Uint64) header->num_tiles_y;
+  }
+  if ((words_per_row != header->traversable_words_per_row) ||
+      (num_points != header->num_points))
+  {
+    ret_code = DT_MAP_FILE_BAD_HEADER;
+    goto EXIT_LABEL;
+  }
+  data_start = header->header_size +
+           ((Uint64) header->num_tile_types * sizeof(DT_MAP_FILE_TILE_TYPE));
+
+  /****************************************************************************/
+  /* Check the chunk table of a chunked map is aligned and lies after the     */
+  /* tile type records and within the file.                                   */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED == header->storage)
+  {
+    num_chunks = (Uint64)
+      ((header->num_tiles_x + DT_GRID_CHUNK_SIZE - 1) >> DT_GRID_CHUNK_SHIFT) *
+      ((header->num_tiles_y + DT_GRID_CHUNK_SIZE - 1) >> DT_GRID_CHUNK_SHIFT);
+    if ((0 != (header->chunk_table_offset % DT_MAP_FILE_ALIGNMENT)) ||
+        (header->chunk_table_offset < data_start) ||
+        (header->chunk_table_offset > file_size) ||
+        (num_chunks * sizeof(DT_MAP_FILE_CHUNK_ENTRY) >
+                                     file_size - header->chunk_table_offset))
+    {
+      ret_code = DT_MAP_FILE_BAD_HEADER;
+    }
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Otherwise check every layer is aligned and lies after the tile type      */
+  /* records and within the file.                                             */
+  /****************************************************************************/
+  offsets[0] = header->traversable_offset;
+  lengths[0] = words_per_row * header->num_tiles_y * sizeof(Uint32);
+  offsets[1] = header->elevation_offset;
+  lengths[1] = num_points * sizeof(Sint16);
+  offsets[2] = header->tile_type_offset;
+  offsets[3] = header->terrain_type_offset;
+  offsets[4] = header->water_depth_offset;
+  offsets[5] = header->movement_modifier_offset;
+  lengths[2] = num_points;
+  lengths[3] = num_points;
+  lengths[4] = num_points;
+  lengths[5] = num_points;
+  for (ii = 0; ii < 6; ii++)
+  {
+    if ((0 != (offsets[ii] % DT_MAP_FILE_ALIGNMENT)) ||
+        (offsets[ii] < data_start) ||
+        (offsets[ii] > file_size) ||
+        (lengths[ii] > file_size - offsets[ii]))
+    {
+      ret_code = DT_MAP_FILE_BAD_HEADER;
+      goto EXIT_LABEL;
+    }
+  }
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_write_binary_map_file                                         */
+/*                                                                            */
+/* Purpose: Write a grid out as a binary map.                                 */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written.                        */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be created.           */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to write.                               */
+/*             IN     filename - The file to write it to.                     */
+/*                                                                            */
+/* Operation: Lay out the header, the tile type records and the layers and    */
+/*            write each in turn. Row-major and Morton grids are written in   */
+/*            their own order straight from their layers. Chunked grids are   */
+/*            written as row-major maps a row at a time.                      */
+/******************************************************************************/
+int dt_write_binary_map_file(DT_GRID *grid, char *filename)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  FILE *map_file = NULL;
+  DT_MAP_FILE_HEADER header;
+  Uint64 offset;
+  int ret_val = DT_FILE_OPEN_OK;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Fill in the header, laying the layers out one after another.             */
+  /****************************************************************************/
+  dt_init_map_file_header(grid,
+                          (DT_GRID_STORAGE_MORTON == grid->storage) ?
+                            DT_GRID_STORAGE_MORTON : DT_GRID_STORAGE_ROW_MAJOR,
+                          &header);
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    header.num_points = (Uint64) grid->num_tiles_x *
+                                                   (Uint64) grid->num_tiles_y;
+  }
+  else
+  {
+    header.num_points = grid->num_points;
+  }
+
+  offset = header.header_size +
+            ((Uint64) header.num_tile_types * sizeof(DT_MAP_FILE_TILE_TYPE));
+  header.traversable_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.traversable_offset + (sizeof(Uint32) *
+                                  (Uint64) header.traversable_words_per_row *
+                                  header.num_tiles_y);
+  header.elevation_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.elevation_offset + (sizeof(Sint16) * header.num_points);
+  header.tile_type_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.tile_type_offset + header.num_points;
+  header.terrain_type_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.terrain_type_offset + header.num_points;
+  header.water_depth_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.water_depth_offset + header.num_points;
+  header.movement_modifier_offset = DT_MAP_FILE_ALIGN(offset);
+  header.file_size = header.movement_modifier_offset + header.num_points;
+
+  /****************************************************************************/
+  /* Create the file and write the header and the tile type records.          */
+  /****************************************************************************/
+  ret_val = dt_open_file(filename, FILE_MODE_WRITE_BINARY, &map_file);
+  if (DT_FILE_OPEN_OK != ret_val)
+  {
+    map_file = NULL;
+    ret_code = DT_MAP_FILE_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  if ((1 != fwrite(&header, sizeof(header), 1, map_file)) ||
+      (DT_MAP_FILE_LOADED != dt_write_map_tile_types(grid, map_file)))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Write the layers.                                                        */
+  /****************************************************************************/
+  if (DT_GRID_STORAGE_CHUNKED == grid->storage)
+  {
+    ret_code = dt_write_chunked_map_layers(grid, &header, map_file);
+  }
+  else
+  {
+    ret_code = dt_write_dense_map_layers(grid, &header, map_file);
+  }
+
+EXIT_LABEL:
+
+  if (NULL != map_file)
+  {
+    if ((0 != fclose(map_file)) && (DT_MAP_FILE_LOADED == ret_code))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+    }
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_write_chunked_binary_map_file                                 */
+/*                                                                            */
+/* Purpose: Write a grid out as a chunked binary map.                         */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written.                        */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be created.           */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to write, stored in any way.            */
+/*             IN     filename - The file to write it to.                     */
+/*             IN     encoding - How to encode the chunk records. One of      */
+/*                               DT_CHUNK_ENCODINGS.                          */
+/*                                                                            */
+/* Operation: Write the map with each record gathered from the grid.          */
+/******************************************************************************/
+int dt_write_chunked_binary_map_file(DT_GRID *grid,
+                                     char *filename,
+                                     int encoding)
+{
+  return(dt_write_chunk_source_map_file(grid,
+                                        filename,
+                                        encoding,
+                                        dt_gather_grid_chunk_record,
+                                        grid));
+}
+
+/******************************************************************************/
+/* Function: dt_gather_grid_chunk_record                                      */
+/*                                                                            */
+/* Purpose: The DT_MAP_FILE_CHUNK_SOURCE used to write a grid out as a        */
+/*          chunked binary map.                                               */
+/*                                                                            */
+/* Returns: false if the chunk has no record, otherwise true.                 */
+/*                                                                            */
+/* Parameters: IN     context - The grid being written, stored in any way.    */
+/*             IN     chunk_x - The x position of the chunk, in chunks.       */
+/*             IN     chunk_y - The y position of the chunk, in chunks.       */
+/*             OUT    record - The record to fill.                            */
+/*                                                                            */
+/* Operation: Chunks of a chunked grid which still share the default chunk    */
+/*            have no record. Every chunk of any other grid has one, gathered */
+/*            from the grid.                                                  */
+/******************************************************************************/
+bool dt_gather_grid_chunk_record(void *context,
+                                 int chunk_x,
+                                 int chunk_y,
+                                 DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = (DT_GRID *) context;
+  bool has_record = true;
+
+  if ((DT_GRID_STORAGE_CHUNKED == grid->storage) &&
+      (grid->default_chunk == grid->chunks[((size_t) chunk_y *
+                                            (size_t) grid->num_chunks_x) +
+                                           (size_t) chunk_x]))
+  {
+    has_record = false;
+    goto EXIT_LABEL;
+  }
+  dt_gather_map_file_chunk(grid, chunk_x, chunk_y, record);
+
+EXIT_LABEL:
+
+  return(has_record);
+}
+
+/******************************************************************************/
+/* Function: dt_write_chunk_source_map_file                                   */
+/*                                                                            */
+/* Purpose: Write a chunked binary map whose chunk records are filled in by a */
+/*          DT_MAP_FILE_CHUNK_SOURCE.                                         */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written.                        */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be created.           */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid giving the size and tile types of the   */
+/*                           map. Its points are not read.                    */
+/*             IN     filename - The file to write it to.                     */
+/*             IN     encoding - How to encode the chunk records. One of      */
+/*                               DT_CHUNK_ENCODINGS.                          */
+/*             IN     source - Fills in the record of each chunk.             */
+/*             IN     context - Passed to the source.                         */
+/*                                                                            */
+/* Operation: Write the header, the tile type records and a chunk table to    */
+/*            be filled in later, followed by a record for each chunk which   */
+/*            has one. Each record is filled in, encoded and written in turn, */
+/*            so only one is held at a time. Raw records are aligned and      */
+/*            compressed ones packed together. Any record which does not get  */
+/*            smaller is written raw. Finally go back and write the chunk     */
+/*            table and the header again now the records have been placed.    */
+/******************************************************************************/
+int dt_write_chunk_source_map_file(DT_GRID *grid,
+                                   char *filename,
+                                   int encoding,
+                                   DT_MAP_FILE_CHUNK_SOURCE source,
+                                   void *context)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  FILE *map_file = NULL;
+  DT_MAP_FILE_HEADER header;
+  DT_MAP_FILE_CHUNK_ENTRY *chunk_table = NULL;
+  DT_MAP_FILE_CHUNK *record = NULL;
+  unsigned char *buffer = NULL;
+  Uint64 offset;
+  Uint32 size;
+  size_t num_chunks;
+  size_t ii;
+  int chunk_x;
+  int chunk_y;
+  int ret_val = DT_FILE_OPEN_OK;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  /****************************************************************************/
+  /* Fill in the header and an empty chunk table.                             */
+  /****************************************************************************/
+  dt_init_map_file_header(grid, DT_GRID_STORAGE_CHUNKED, &header);
+  chunk_x = (grid->num_tiles_x + DT_GRID_CHUNK_SIZE - 1) >> DT_GRID_CHUNK_SHIFT;
+  chunk_y = (grid->num_tiles_y + DT_GRID_CHUNK_SIZE - 1) >> DT_GRID_CHUNK_SHIFT;
+  num_chunks = (size_t) chunk_x * (size_t) chunk_y;
+  chunk_table = (DT_MAP_FILE_CHUNK_ENTRY *)
+                  dt_calloc(num_chunks, sizeof(DT_MAP_FILE_CHUNK_ENTRY));
+  offset = header.header_size +
+            ((Uint64) header.num_tile_types * sizeof(DT_MAP_FILE_TILE_TYPE));
+  header.chunk_table_offset = DT_MAP_FILE_ALIGN(offset);
+  offset = header.chunk_table_offset +
+                             (sizeof(DT_MAP_FILE_CHUNK_ENTRY) * num_chunks);
+
+  /****************************************************************************/
+  /* Create the file and write the header, the tile type records and the      */
+  /* chunk table as it is so far.                                             */
+  /****************************************************************************/
+  ret_val = dt_open_file(filename, FILE_MODE_WRITE_BINARY, &map_file);
+  if (DT_FILE_OPEN_OK != ret_val)
+  {
+    map_file = NULL;
+    ret_code = DT_MAP_FILE_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  if ((1 != fwrite(&header, sizeof(header), 1, map_file)) ||
+      (DT_MAP_FILE_LOADED != dt_write_map_tile_types(grid, map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+                 dt_write_map_padding(map_file, header.chunk_table_offset)) ||
+      (num_chunks != fwrite(chunk_table,
+                            sizeof(DT_MAP_FILE_CHUNK_ENTRY),
+                            num_chunks,
+                            map_file)))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Fill in, encode and write the record of each chunk which has one.        */
+  /****************************************************************************/
+  record = (DT_MAP_FILE_CHUNK *) dt_malloc(sizeof(DT_MAP_FILE_CHUNK));
+  buffer = (unsigned char *) dt_malloc(DT_CHUNK_MAX_ENCODED_SIZE);
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (!source(context,
+                (int) (ii % (size_t) chunk_x),
+                (int) (ii / (size_t) chunk_x),
+                record))
+    {
+      continue;
+    }
+    chunk_table[ii].encoding = (Uint32) dt_encode_map_file_chunk(record,
+                                                                 encoding,
+                                                                 buffer,
+                                                                 &size);
+    chunk_table[ii].size = size;
+    if (DT_CHUNK_ENCODING_RAW == chunk_table[ii].encoding)
+    {
+      offset = DT_MAP_FILE_ALIGN(offset);
+    }
+    chunk_table[ii].offset = offset;
+    if ((DT_MAP_FILE_LOADED != dt_write_map_padding(map_file, offset)) ||
+        (1 != fwrite(buffer, size, 1, map_file)))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      goto EXIT_LABEL;
+    }
+    offset += size;
+  }
+  header.file_size = DT_MAP_FILE_ALIGN(offset);
+  if (DT_MAP_FILE_LOADED != dt_write_map_padding(map_file, header.file_size))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Write the header and the chunk table again now they are complete.        */
+  /****************************************************************************/
+  if ((0 != fseek(map_file, 0, SEEK_SET)) ||
+      (1 != fwrite(&header, sizeof(header), 1, map_file)) ||
+      (0 != fseek(map_file, (long) header.chunk_table_offset, SEEK_SET)) ||
+      (num_chunks != fwrite(chunk_table,
+                            sizeof(DT_MAP_FILE_CHUNK_ENTRY),
+                            num_chunks,
+                            map_file)))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+
+EXIT_LABEL:
+
+  if (NULL != map_file)
+  {
+    if ((0 != fclose(map_file)) && (DT_MAP_FILE_LOADED == ret_code))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+    }
+  }
+  if (NULL != buffer)
+  {
+    dt_free(buffer);
+  }
+  if (NULL != record)
+  {
+    dt_free(record);
+  }
+  dt_free(chunk_table);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_init_map_file_header                                          */
+/*                                                                            */
+/* Purpose: Fill in the parts of a binary map header which describe the grid. */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid being written.                          */
+/*             IN     storage - The storage type of the map being written.    */
+/*             OUT    header - The header to fill in.                         */
+/*                                                                            */
+/* Operation: Zero the header and set the identifying values, the dimensions  */
+/*            and the tile type count. The caller lays out the rest.          */
+/******************************************************************************/
+void dt_init_map_file_header(DT_GRID *grid,
+                             int storage,
+                             DT_MAP_FILE_HEADER *header)
+{
+  memset(header, 0, sizeof(DT_MAP_FILE_HEADER));
+  header->magic = DT_MAP_FILE_MAGIC;
+  header->version = DT_MAP_FILE_VERSION;
+  header->header_size = sizeof(DT_MAP_FILE_HEADER);
+  header->storage = (Uint32) storage;
+  header->num_tiles_x = (Uint32) grid->num_tiles_x;
+  header->num_tiles_y = (Uint32) grid->num_tiles_y;
+  header->square_width = (Uint32) grid->square_width;
+  header->square_height = (Uint32) grid->square_height;
+  header->num_tile_types = (Uint32) grid->num_tile_types;
+  header->traversable_words_per_row =
+         (grid->num_tiles_x + DT_GRID_BITS_PER_WORD - 1) >> DT_GRID_WORD_SHIFT;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_write_map_tile_types                                          */
+/*                                                                            */
+/* Purpose: Write the tile type records of a binary map.                      */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the records were written.                   */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid being written.                          */
+/*             IN     map_file - The file, positioned after the header.       */
+/*                                                                            */
+/* Operation: Write a record for every entry in the tile type table. The      */
+/*            record of DT_TILE_TYPE_NONE is left zeroed.                     */
+/******************************************************************************/
+int dt_write_map_tile_types(DT_GRID *grid, FILE *map_file)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_FILE_TILE_TYPE record;
+  DT_BACKGROUND_TILE *tile;
+  int tile_type;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  for (tile_type = 0; tile_type < grid->num_tile_types; tile_type++)
+  {
+    memset(&record, 0, sizeof(record));
+    tile = grid->tile_types[tile_type];
+    if (NULL != tile)
+    {
+      record.terrain_type = tile->terrain_type;
+      record.elevation = tile->elevation;
+      record.water_depth = tile->water_depth;
+      record.movement_modifier = tile->movement_modifier;
+      if (NULL != tile->graphic_name)
+      {
+        strncpy(record.graphic_name,
+                tile->graphic_name,
+                DT_MAP_GRAPHIC_NAME_LEN - 1);
+      }
+    }
+    if (1 != fwrite(&record, sizeof(record), 1, map_file))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      break;
+    }
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_gather_map_file_chunk                                         */
+/*                                                                            */
+/* Purpose: Fill the record of one chunk of a chunked binary map from a grid. */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid being written, stored in any way.       */
+/*             IN     chunk_x - The x position of the chunk, in chunks.       */
+/*             IN     chunk_y - The y position of the chunk, in chunks.       */
+/*             OUT    record - The record to fill.                            */
+/*                                                                            */
+/* Operation: Read each point of the chunk through the grid accessors. Points */
+/*            which lie off the grid are given the values of an empty plain   */
+/*            and are not traversable.                                        */
+/******************************************************************************/
+void dt_gather_map_file_chunk(DT_GRID *grid,
+                              int chunk_x,
+                              int chunk_y,
+                              DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int grid_x;
+  int grid_y;
+  int row;
+  int col;
+  int ii;
+
+  memset(record, 0, sizeof(DT_MAP_FILE_CHUNK));
+  memset(record->terrain_type, DT_GROUND_TYPE_PLAIN, DT_GRID_CHUNK_POINTS);
+  for (row = 0; row < DT_GRID_CHUNK_SIZE; row++)
+  {
+    grid_y = (chunk_y << DT_GRID_CHUNK_SHIFT) + row;
+    if (grid_y >= grid->num_tiles_y)
+    {
+      break;
+    }
+    for (col = 0; col < DT_GRID_CHUNK_SIZE; col++)
+    {
+      grid_x = (chunk_x << DT_GRID_CHUNK_SHIFT) + col;
+      if (grid_x >= grid->num_tiles_x)
+      {
+        break;
+      }
+      ii = (row << DT_GRID_CHUNK_SHIFT) + col;
+      if (dt_is_grid_traversable(grid, grid_x, grid_y))
+      {
+        record->traversable[row] |= 1u << col;
+      }
+      record->elevation[ii] = dt_get_grid_elevation(grid, grid_x, grid_y);
+      record->tile_type[ii] = dt_get_grid_tile_type(grid, grid_x, grid_y);
+      record->terrain_type[ii] =
+                            dt_get_grid_terrain_type(grid, grid_x, grid_y);
+      record->water_depth[ii] = dt_get_grid_water_depth(grid, grid_x, grid_y);
+      record->movement_modifier[ii] =
+                       dt_get_grid_movement_modifier(grid, grid_x, grid_y);
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_write_map_padding                                             */
+/*                                                                            */
+/* Purpose: Pad a binary map being written up to the start of the next layer. */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the padding was written.                    */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     map_file - The file being written.                      */
+/*             IN     offset - The offset the next layer starts at.           */
+/*                                                                            */
+/* Operation: Write zero bytes until the file reaches the offset.             */
+/******************************************************************************/
+int dt_write_map_padding(FILE *map_file, Uint64 offset)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const unsigned char padding[DT_MAP_FILE_ALIGNMENT];
+  long position;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  position = ftell(map_file);
+  if ((position < 0) || ((Uint64) position > offset) ||
+      (offset - (Uint64) position > DT_MAP_FILE_ALIGNMENT) ||
+      (offset - (Uint64) position !=
+         fwrite(padding, 1, (size_t) (offset - (Uint64) position), map_file)))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_write_dense_map_layers                                        */
+/*                                                                            */
+/* Purpose: Write the layers of a row-major or Morton grid to a binary map.   */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the layers were written.                    */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid being written.                          */
+/*             IN     header - The header of the file.                        */
+/*             IN     map_file - The file, positioned after the tile types.   */
+/*                                                                            */
+/* Operation: Write each layer as it is in memory at its offset.              */
+/******************************************************************************/
+int dt_write_dense_map_layers(DT_GRID *grid,
+                              DT_MAP_FILE_HEADER *header,
+                              FILE *map_file)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_points = (size_t) header->num_points;
+  size_t num_words = (size_t) header->traversable_words_per_row *
+                                                (size_t) header->num_tiles_y;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  if ((DT_MAP_FILE_LOADED !=
+                  dt_write_map_padding(map_file, header->traversable_offset)) ||
+      (num_words != fwrite(grid->traversable,
+                           sizeof(Uint32),
+                           num_words,
+                           map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+                    dt_write_map_padding(map_file, header->elevation_offset)) ||
+      (num_points != fwrite(grid->elevation,
+                            sizeof(Sint16),
+                            num_points,
+                            map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+                    dt_write_map_padding(map_file, header->tile_type_offset)) ||
+      (num_points != fwrite(grid->tile_type, 1, num_points, map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+                 dt_write_map_padding(map_file, header->terrain_type_offset)) ||
+      (num_points != fwrite(grid->terrain_type, 1, num_points, map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+                  dt_write_map_padding(map_file, header->water_depth_offset)) ||
+      (num_points != fwrite(grid->water_depth, 1, num_points, map_file)) ||
+      (DT_MAP_FILE_LOADED !=
+            dt_write_map_padding(map_file, header->movement_modifier_offset)) ||
+      (num_points != fwrite(grid->movement_modifier, 1, num_points, map_file)))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_write_chunked_map_layers                                      */
+/*                                                                            */
+/* Purpose: Write the layers of a chunked grid to a binary map.               */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the layers were written.                    */
+/*          DT_MAP_FILE_WRITE_FAILED if writing to the file failed.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid being written.                          */
+/*             IN     header - The header of the file.                        */
+/*             IN     map_file - The file, positioned after the tile types.   */
+/*                                                                            */
+/* Operation: For each layer in turn gather each row into a buffer through    */
+/*            the grid accessors and write it out. The traversable bits past  */
+/*            the end of each row are written clear.                          */
+/******************************************************************************/
+int dt_write_chunked_map_layers(DT_GRID *grid,
+                                DT_MAP_FILE_HEADER *header,
+                                FILE *map_file)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *words;
+  Sint16 *elevations;
+  unsigned char *bytes;
+  size_t words_per_row = (size_t) header->traversable_words_per_row;
+  size_t row_length = (size_t) grid->num_tiles_x;
+  Uint64 offsets[4];
+  int layer;
+  int row;
+  int col;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  words = (Uint32 *) dt_malloc(sizeof(Uint32) * words_per_row);
+  elevations = (Sint16 *) dt_malloc(sizeof(Sint16) * row_length);
+  bytes = (unsigned char *) dt_malloc(row_length);
+
+  /****************************************************************************/
+  /* Write the traversable bitmap.                                            */
+  /****************************************************************************/
+  if (DT_MAP_FILE_LOADED !=
+                   dt_write_map_padding(map_file, header->traversable_offset))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    memset(words, 0, sizeof(Uint32) * words_per_row);
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      if (dt_is_grid_traversable(grid, col, row))
+      {
+        words[col >> DT_GRID_WORD_SHIFT] |= 1u << (col & DT_GRID_WORD_MASK);
+      }
+    }
+    if (words_per_row != fwrite(words, sizeof(Uint32), words_per_row, map_file))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Write the elevation layer.                                               */
+  /****************************************************************************/
+  if (DT_MAP_FILE_LOADED !=
+                     dt_write_map_padding(map_file, header->elevation_offset))
+  {
+    ret_code = DT_MAP_FILE_WRITE_FAILED;
+    goto EXIT_LABEL;
+  }
+  for (row = 0; row < grid->num_tiles_y; row++)
+  {
+    for (col = 0; col < grid->num_tiles_x; col++)
+    {
+      elevations[col] = dt_get_grid_elevation(grid, col, row);
+    }
+    if (row_length != fwrite(elevations, sizeof(Sint16), row_length, map_file))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      goto EXIT_LABEL;
+    }
+  }
+
+  /****************************************************************************/
+  /* Write the byte layers.                                                   */
+  /****************************************************************************/
+  offsets[0] = header->tile_type_offset;
+  offsets[1] = header->terrain_type_offset;
+  offsets[2] = header->water_depth_offset;
+  offsets[3] = header->movement_modifier_offset;
+  for (layer = 0; layer < 4; layer++)
+  {
+    if (DT_MAP_FILE_LOADED != dt_write_map_padding(map_file, offsets[layer]))
+    {
+      ret_code = DT_MAP_FILE_WRITE_FAILED;
+      goto EXIT_LABEL;
+    }
+    for (row = 0; row < grid->num_tiles_y; row++)
+    {
+      for (col = 0; col < grid->num_tiles_x; col++)
+      {
+        switch (layer)
+        {
+          case 0:
+            bytes[col] = dt_get_grid_tile_type(grid, col, row);
+            break;
+          case 1:
+            bytes[col] = dt_get_grid_terrain_type(grid, col, row);
+            break;
+          case 2:
+            bytes[col] = dt_get_grid_water_depth(grid, col, row);
+            break;
+          default:
+            bytes[col] = dt_get_grid_movement_modifier(grid, col, row);
+            break;
+        }
+      }
+      if (row_length != fwrite(bytes, 1, row_length, map_file))
+      {
+        ret_code = DT_MAP_FILE_WRITE_FAILED;
+        goto EXIT_LABEL;
+      }
+    }
+  }
+
+EXIT_LABEL:
+
+  dt_free(bytes);
+  dt_free(elevations);
+  dt_free(words);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_convert_map_file                                              */
+/*                                                                            */
+/* Purpose: Convert a map file into a binary map.                             */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was converted, otherwise one of     */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     in_filename - The map to convert, in either format.     */
+/*             IN     out_filename - The binary map to write.                 */
+/*             IN     chunked - Whether to write a chunked binary map, which  */
+/*                              can be streamed, rather than a flat one.      */
+/*             IN     encoding - How to encode the chunks of a chunked map.   */
+/*                               One of DT_CHUNK_ENCODINGS.                   */
+/*                                                                            */
+/* Operation: Load the map and write it out. Then load the binary map back    */
+/*            and report how long each step took, and how fast the input was  */
+/*            read in megabytes and tiles a second. For a chunked map also    */
+/*            report how well its chunks compressed.                          */
+/******************************************************************************/
+int dt_convert_map_file(char *in_filename,
+                        char *out_filename,
+                        bool chunked,
+                        int encoding)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  Uint64 start_time;
+  Uint64 load_time;
+  Uint64 write_time;
+  Uint64 open_time;
+  double in_megabytes;
+  double num_tiles;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  start_time = dt_get_time_us();
+  ret_code = dt_load_grid_from_file(in_filename, &grid);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to load map %s (error %d).\n",
+            in_filename,
+            ret_code);
+    goto EXIT_LABEL;
+  }
+  load_time = MAX(dt_get_time_us() - start_time, 1);
+  in_megabytes = (double) dt_get_file_size(in_filename) / (1024.0 * 1024.0);
+  num_tiles = (double) grid->num_tiles_x * (double) grid->num_tiles_y;
+
+  start_time = dt_get_time_us();
+  if (chunked)
+  {
+    ret_code = dt_write_chunked_binary_map_file(grid, out_filename, encoding);
+  }
+  else
+  {
+    ret_code = dt_write_binary_map_file(grid, out_filename);
+  }
+  write_time = dt_get_time_us() - start_time;
+  printf("%s: %d x %d, %d tile types, %.1f MB loaded in %.1f ms "
+         "(%.1f MB/s, %.2f million tiles/s)\n",
+         in_filename,
+         grid->num_tiles_x,
+         grid->num_tiles_y,
+         grid->num_tile_types - 1,
+         in_megabytes,
+         load_time / 1000.0,
+         in_megabytes * 1000000.0 / load_time,
+         num_tiles / load_time);
+  dt_destroy_grid(grid);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to write map %s (error %d).\n",
+            out_filename,
+            ret_code);
+    goto EXIT_LABEL;
+  }
+
+  start_time = dt_get_time_us();
+  ret_code = dt_load_grid_from_file(out_filename, &grid);
+  open_time = dt_get_time_us() - start_time;
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to reopen map %s (error %d).\n",
+            out_filename,
+            ret_code);
+    goto EXIT_LABEL;
+  }
+  dt_destroy_grid(grid);
+  printf("%s: written in %.1f ms, opened in %.3f ms\n",
+         out_filename,
+         write_time / 1000.0,
+         open_time / 1000.0);
+  if (chunked)
+  {
+    ret_code = dt_report_map_file_compression(out_filename);
+  }
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_report_map_file_compression                                   */
+/*                                                                            */
+/* Purpose: Report how well the chunks of a chunked binary map compressed and */
+/*          how long they take to decompress.                                 */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was loaded, otherwise one of        */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     filename - The chunked binary map.                      */
+/*                                                                            */
+/* Operation: Load the map with its chunks left compressed, then access every */
+/*            chunk once so that each is inflated and timed.                  */
+/******************************************************************************/
+int dt_report_map_file_compression(char *filename)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  DT_CHUNK_STORE *store;
+  Uint64 raw_bytes = 0;
+  size_t num_chunks;
+  size_t num_records = 0;
+  size_t ii;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  ret_code = dt_load_compressed_map_file(filename, 0, &grid);
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to reopen map %s (error %d).\n",
+            filename,
+            ret_code);
+    goto EXIT_LABEL;
+  }
+  store = grid->chunk_store;
+  num_chunks = (size_t) grid->num_chunks_x * (size_t) grid->num_chunks_y;
+  for (ii = 0; ii < num_chunks; ii++)
+  {
+    if (NULL != store->chunks[ii].data)
+    {
+      num_records++;
+      raw_bytes += sizeof(DT_MAP_FILE_CHUNK);
+      dt_get_grid_chunk(grid,
+                        (int) (ii % (size_t) grid->num_chunks_x) <<
+                                                        DT_GRID_CHUNK_SHIFT,
+                        (int) (ii / (size_t) grid->num_chunks_x) <<
+                                                        DT_GRID_CHUNK_SHIFT);
+    }
+  }
+  printf("%s: %lu chunk records, %.1f KB raw, %.1f KB compressed "
+         "(ratio %.2f), %.1f us to inflate each chunk\n",
+         filename,
+         (unsigned long) num_records,
+         raw_bytes / 1024.0,
+         store->compressed_bytes / 1024.0,
+         (double) raw_bytes / (double) MAX(store->compressed_bytes, 1),
+         (double) store->inflate_time_us / (double) MAX(num_records, 1));
+  dt_destroy_grid(grid);
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_map_file                                                      */
+/*                                                                            */
+/* Purpose: Map a whole file into memory.                                     */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the file was mapped.                        */
+/*          DT_MAP_FILE_NOT_FOUND if the file could not be opened.            */
+/*          DT_MAP_FILE_MAP_FAILED if it could not be mapped.                 */
+/*                                                                            */
+/* Parameters: IN     filename - The file to map.                             */
+/*             OUT    mapped_file - The new mapped file object.               */
+/*                                                                            */
+/* Operation: Open the file and map a copy on write view of all of it. Pages  */
+/*            are read from the file as they are first touched and only       */
+/*            copied if they are written to.                                  */
+/******************************************************************************/
+int dt_map_file(char *filename, DT_MAPPED_FILE **mapped_file)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAPPED_FILE *temp_file;
+  LARGE_INTEGER file_size;
+  int ret_code = DT_MAP_FILE_LOADED;
+
+  temp_file = (DT_MAPPED_FILE *) dt_malloc(sizeof(DT_MAPPED_FILE));
+  temp_file->mapping = NULL;
+  temp_file->view = NULL;
+
+  /****************************************************************************/
+  /* Open the file and find its size.                                         */
+  /****************************************************************************/
+  temp_file->file = CreateFileA(filename,
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                NULL);
+  if (INVALID_HANDLE_VALUE == temp_file->file)
+  {
+    ret_code = DT_MAP_FILE_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  if ((!GetFileSizeEx(temp_file->file, &file_size)) ||
+      (0 == file_size.QuadPart))
+  {
+    ret_code = DT_MAP_FILE_MAP_FAILED;
+    goto EXIT_LABEL;
+  }
+  temp_file->size = (Uint64) file_size.QuadPart;
+
+  /****************************************************************************/
+  /* Map a copy on write view of the whole file.                              */
+  /****************************************************************************/
+  temp_file->mapping = CreateFileMappingA(temp_file->file,
+                                          NULL,
+                                          PAGE_WRITECOPY,
+                                          0,
+                                          0,
+                                          NULL);
+  if (NULL == temp_file->mapping)
+  {
+    ret_code = DT_MAP_FILE_MAP_FAILED;
+    goto EXIT_LABEL;
+  }
+  temp_file->view = (unsigned char *) MapViewOfFile(temp_file->mapping,
+                                                    FILE_MAP_COPY,
+                                                    0,
+                                                    0,
+                                                    0);
+  if (NULL == temp_file->view)
+  {
+    ret_code = DT_MAP_FILE_MAP_FAILED;
+    goto EXIT_LABEL;
+  }
+
+EXIT_LABEL:
+
+  if (DT_MAP_FILE_LOADED == ret_code)
+  {
+    (*mapped_file) = temp_file;
+  }
+  else
+  {
+    dt_unmap_file(temp_file);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_unmap_file                                                    */
+/*                                                                            */
+/* Purpose: Release a file mapped with dt_map_file.                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     mapped_file - The mapped file to release.               */
+/*                                                                            */
+/* Operation: Unmap the view, close the handles and free the object. Any      */
+/*            changes made through the view are discarded.                    */
+/******************************************************************************/
+void dt_unmap_file(DT_MAPPED_FILE *mapped_file)
+{
+  if (NULL != mapped_file->view)
+  {
+    UnmapViewOfFile(mapped_file->view);
+  }
+  if (NULL != mapped_file->mapping)
+  {
+    CloseHandle(mapped_file->mapping);
+  }
+  if (INVALID_HANDLE_VALUE != mapped_file->file)
+  {
+    CloseHandle(mapped_file->file);
+  }
+  dt_free(mapped_file);
+
+  return;
+}
@@ -0,0 +1,340 @@
+/******************************************************************************/
+/* File: dt_map_file.h                                                        */
+/*                                                                            */
+/* Purpose: Definitions for reading and writing map files.                    */
+/*                                                                            */
+/* Text maps start with an info line:                                         */
+/*                                                                            */
+/*   DTMAP <num_tiles_x> <num_tiles_y> <square_width> <square_height>         */
+/*                                                                            */
+/* followed by one line for each tile type, numbered from 1 in the order they */
+/* appear:                                                                    */
+/*                                                                            */
+/*   TILE <terrain_type> <elevation> <water_depth> <movement_modifier> <name> */
+/*                                                                            */
+/* where name is the file holding the graphic of the tile, or "-" for none.   */
+/* The rest of the file is num_tiles_y rows of num_tiles_x whitespace         */
+/* separated points, each of the form:                                        */
+/*                                                                            */
+/*   [!]<tile_type>[:<elevation>[:<water_depth>]]                             */
+/*                                                                            */
+/* A leading "!" marks the point as not traversable. Any elevation or water   */
+/* depth given overrides that of the tile type at that point alone. Line      */
+/* breaks are treated as any other whitespace, so lines may be of any length  */
+/* and rows may be split across lines.                                        */
+/*                                                                            */
+/* Binary maps hold the same information with the terrain layers laid out     */
+/* exactly as they are in memory, so that a grid can be loaded by mapping the */
+/* file and pointing its layers into the mapping. A binary map is a           */
+/* DT_MAP_FILE_HEADER, then a DT_MAP_FILE_TILE_TYPE for every tile type       */
+/* (including DT_TILE_TYPE_NONE), then the layers at the offsets given in the */
+/* header. All values are stored in the native (little endian) byte order.    */
+/*                                                                            */
+/* Chunked binary maps instead hold a table with a DT_MAP_FILE_CHUNK_ENTRY    */
+/* for every chunk, row by row, followed by a DT_MAP_FILE_CHUNK record for    */
+/* each chunk which is not empty. Each chunk can be read on its own, which    */
+/* lets maps too large for memory be streamed in a chunk at a time. Records   */
+/* may be compressed (see DT_CHUNK_ENCODINGS), in which case they are packed  */
+/* one after another with no alignment.                                       */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Identification of binary map files.                                        */
+/*                                                                            */
+/* DT_MAP_FILE_MAGIC - The first four bytes of every binary map, "DTMB".      */
+/* DT_MAP_FILE_VERSION - The version of the binary format written. Version 2  */
+/*                       added chunked maps and version 3 compressed chunks.  */
+/*                       Version 1 files, which have no chunk_table_offset in */
+/*                       their header, and version 2 files, whose chunks are  */
+/*                       never compressed, can still be read.                 */
+/* DT_MAP_FILE_ALIGNMENT - Every layer starts on a multiple of this many      */
+/*                         bytes from the start of the file.                  */
+/******************************************************************************/
+#define DT_MAP_FILE_MAGIC 0x424D5444u
+#define DT_MAP_FILE_VERSION 3
+#define DT_MAP_FILE_VERSION_2 2
+#define DT_MAP_FILE_VERSION_1 1
+#define DT_MAP_FILE_ALIGNMENT 64
+
+/******************************************************************************/
+/* Round an offset in a binary map up to the next multiple of                 */
+/* DT_MAP_FILE_ALIGNMENT.                                                     */
+/******************************************************************************/
+#define DT_MAP_FILE_ALIGN(offset)                                             \
+  (((offset) + DT_MAP_FILE_ALIGNMENT - 1) &                                   \
+                                       ~((Uint64) DT_MAP_FILE_ALIGNMENT - 1))
+
+/******************************************************************************/
+/* The largest number of tiles a map may have in each direction. This is the  */
+/* limit of DT_GRID_STORAGE_MORTON grids.                                     */
+/******************************************************************************/
+#define DT_MAP_MAX_DIMENSION 65536
+
+/******************************************************************************/
+/* The longest graphic file name that can be stored for a tile type,          */
+/* including the terminating null.                                            */
+/******************************************************************************/
+#define DT_MAP_GRAPHIC_NAME_LEN 56
+
+/******************************************************************************/
+/* The keywords which start the info line and tile lines of text maps, and    */
+/* the characters with special meanings in the rows of points.                */
+/******************************************************************************/
+#define DT_MAP_TEXT_INFO_KEYWORD "DTMAP"
+#define DT_MAP_TEXT_TILE_KEYWORD "TILE"
+#define DT_MAP_TEXT_NO_GRAPHIC "-"
+#define DT_MAP_TEXT_BLOCKED_CHAR '!'
+#define DT_MAP_TEXT_SEPARATOR_CHAR ':'
+#define DT_MAP_TEXT_IS_SPACE(c) \
+  ((' ' == (c)) || ('\n' == (c)) || ('\r' == (c)) || ('\t' == (c)))
+
+/******************************************************************************/
+/* Limits used when reading and writing text maps.                            */
+/*                                                                            */
+/* DT_MAP_TEXT_MAX_DIGITS - The most digits a number in a text map may have.  */
+/* DT_MAP_TEXT_MAX_POINT_LEN - The longest a point written to a text map can  */
+/*                             be, including the space before it.             */
+/******************************************************************************/
+#define DT_MAP_TEXT_MAX_DIGITS 9
+#define DT_MAP_TEXT_MAX_POINT_LEN 16
+
+/******************************************************************************/
+/* How the points of a text map are shared out between the load jobs run on   */
+/* the master worker pool.                                                    */
+/*                                                                            */
+/* DT_MAP_TEXT_AUTO_JOBS - Passed as the most jobs to use to choose the       */
+/*                         number from the size of the pool.                  */
+/* DT_MAP_TEXT_JOBS_PER_THREAD - The number of jobs for each thread which can */
+/*                               work on them, so that threads which finish   */
+/*                               early can pick up more of the work.          */
+/* DT_MAP_TEXT_MIN_JOB_BYTES - The least text worth giving a job of its own.  */
+/******************************************************************************/
+#define DT_MAP_TEXT_AUTO_JOBS 0
+#define DT_MAP_TEXT_JOBS_PER_THREAD 4
+#define DT_MAP_TEXT_MIN_JOB_BYTES (1 << 20)
+
+/******************************************************************************/
+/* DT_MAP_FILE_HEADER:                                                        */
+/*                                                                            */
+/* The header at the start of a binary map.                                   */
+/*                                                                            */
+/* magic - DT_MAP_FILE_MAGIC.                                                 */
+/* version - DT_MAP_FILE_VERSION.                                             */
+/* header_size - The size of this header in bytes.                            */
+/* storage - The order of the layers. DT_GRID_STORAGE_ROW_MAJOR,              */
+/*           DT_GRID_STORAGE_MORTON or DT_GRID_STORAGE_CHUNKED.               */
+/* num_tiles_x - The number of tiles in the x direction.                      */
+/* num_tiles_y - The number of tiles in the y direction.                      */
+/* square_width - The width in pixels of a grid square.                       */
+/* square_height - The height in pixels of a grid square.                     */
+/* num_tile_types - The number of tile type records after the header.         */
+/* traversable_words_per_row - The number of words in a traversable row.      */
+/* num_points - The number of entries in each of the other layers. 0 for a    */
+/*              chunked map.                                                  */
+/* traversable_offset - The offset of the traversable bitmap.                 */
+/* elevation_offset - The offset of the elevation layer.                      */
+/* tile_type_offset - The offset of the tile type layer.                      */
+/* terrain_type_offset - The offset of the terrain type layer.                */
+/* water_depth_offset - The offset of the water depth layer.                  */
+/* movement_modifier_offset - The offset of the movement modifier layer.      */
+/*    The layer offsets are 0 in a chunked map.                               */
+/* file_size - The size of the whole file in bytes.                           */
+/* chunk_table_offset - The offset of the chunk table of a chunked map, and 0 */
+/*                      for any other map. Not present in version 1 headers.  */
+/******************************************************************************/
+typedef struct dt_map_file_header
+{
+  Uint32 magic;
+  Uint32 version;
+  Uint32 header_size;
+  Uint32 storage;
+  Uint32 num_tiles_x;
+  Uint32 num_tiles_y;
+  Uint32 square_width;
+  Uint32 square_height;
+  Uint32 num_tile_types;
+  Uint32 traversable_words_per_row;
+  Uint64 num_points;
+  Uint64 traversable_offset;
+  Uint64 elevation_offset;
+  Uint64 tile_type_offset;
+  Uint64 terrain_type_offset;
+  Uint64 water_depth_offset;
+  Uint64 movement_modifier_offset;
+  Uint64 file_size;
+  Uint64 chunk_table_offset;
+} DT_MAP_FILE_HEADER;
+
+/******************************************************************************/
+/* The size of a version 1 header, which ends before chunk_table_offset.      */
+/******************************************************************************/
+#define DT_MAP_FILE_VERSION_1_HEADER_SIZE                                     \
+                              offsetof(DT_MAP_FILE_HEADER, chunk_table_offset)
+
+/******************************************************************************/
+/* DT_MAP_FILE_TILE_TYPE:                                                     */
+/*                                                                            */
+/* The record of one tile type in a binary map.                               */
+/*                                                                            */
+/* terrain_type - The DT_GROUND_TYPES value of the tile type.                 */
+/* elevation - The base elevation of the tile type.                           */
+/* water_depth - The base water depth of the tile type.                       */
+/* movement_modifier - The base movement modifier of the tile type.           */
+/* graphic_name - The null terminated name of the file holding the graphic    */
+/*                of the tile type. Empty if there is none.                   */
+/******************************************************************************/
+typedef struct dt_map_file_tile_type
+{
+  Sint32 terrain_type;
+  Sint32 elevation;
+  Sint32 water_depth;
+  Sint32 movement_modifier;
+  char graphic_name[DT_MAP_GRAPHIC_NAME_LEN];
+} DT_MAP_FILE_TILE_TYPE;
+
+/******************************************************************************/
+/* DT_MAP_FILE_CHUNK_ENTRY:                                                   */
+/*                                                                            */
+/* The entry for one chunk in the chunk table of a chunked binary map.        */
+/*                                                                            */
+/* offset - The offset of the chunk's record, or 0 if the chunk is empty and  */
+/*          has no record.                                                    */
+/* size - The size of the record in bytes as it is stored.                    */
+/* encoding - How the record is stored. One of DT_CHUNK_ENCODINGS. Always     */
+/*            DT_CHUNK_ENCODING_RAW in version 2 maps, where size and         */
+/*            encoding were a single 64 bit size.                             */
+/******************************************************************************/
+typedef struct dt_map_file_chunk_entry
+{
+  Uint64 offset;
+  Uint32 size;
+  Uint32 encoding;
+} DT_MAP_FILE_CHUNK_ENTRY;
+
+/******************************************************************************/
+/* DT_MAP_FILE_CHUNK:                                                         */
+/*                                                                            */
+/* The record of one chunk in a chunked binary map. The layers are those of a */
+/* DT_GRID_CHUNK. Points of chunks on the right and bottom edges which lie    */
+/* off the grid are empty and not traversable.                                */
+/*                                                                            */
+/* traversable - One word per chunk row with a bit set for each traversable   */
+/*               point.                                                       */
+/* elevation - The elevation of each point.                                   */
+/* tile_type - The tile type of each point.                                   */
+/* terrain_type - The terrain type of each point.                             */
+/* water_depth - The water depth of each point.                               */
+/* movement_modifier - The movement modifier of each point.                   */
+/******************************************************************************/
+typedef struct dt_map_file_chunk
+{
+  Uint32 traversable[DT_GRID_CHUNK_SIZE];
+  Sint16 elevation[DT_GRID_CHUNK_POINTS];
+  unsigned char tile_type[DT_GRID_CHUNK_POINTS];
+  unsigned char terrain_type[DT_GRID_CHUNK_POINTS];
+  unsigned char water_depth[DT_GRID_CHUNK_POINTS];
+  unsigned char movement_modifier[DT_GRID_CHUNK_POINTS];
+} DT_MAP_FILE_CHUNK;
+
+/******************************************************************************/
+/* The function which fills in the record of each chunk as a chunked binary   */
+/* map is written. It is passed its context, the x and y position of the      */
+/* chunk in chunks and the record to fill, and returns false if the chunk is  */
+/* empty and is to have no record. It is called for each chunk in turn, row   */
+/* by row.                                                                    */
+/******************************************************************************/
+typedef bool (*DT_MAP_FILE_CHUNK_SOURCE)(void *,
+                                         int,
+                                         int,
+                                         struct dt_map_file_chunk *);
+
+/******************************************************************************/
+/* DT_MAPPED_FILE:                                                            */
+/*                                                                            */
+/* A file mapped into memory. The view is copy on write, so the grid layers   */
+/* pointing into it may be changed without the file being modified.           */
+/*                                                                            */
+/* file - The handle of the open file.                                        */
+/* mapping - The handle of the file mapping object.                           */
+/* view - The start of the mapped view of the file.                           */
+/* size - The size of the file in bytes.                                      */
+/******************************************************************************/
+typedef struct dt_mapped_file
+{
+  HANDLE file;
+  HANDLE mapping;
+  unsigned char *view;
+  Uint64 size;
+} DT_MAPPED_FILE;
+
+/******************************************************************************/
+/* DT_MAP_TEXT_READER:                                                        */
+/*                                                                            */
+/* Reads a text map held in memory a token at a time.                         */
+/*                                                                            */
+/* text - The text being read. Tokens are handed out in place in it.          */
+/* position - The offset in the text of the next character to read.           */
+/* length - The number of characters in the text.                             */
+/******************************************************************************/
+typedef struct dt_map_text_reader
+{
+  char *text;
+  size_t position;
+  size_t length;
+} DT_MAP_TEXT_READER;
+
+/******************************************************************************/
+/* DT_MAP_TILE_TYPE_LAYERS:                                                   */
+/*                                                                            */
+/* The value each tile type of a grid puts in each terrain layer, looked up   */
+/* once before the points of a text map are read.                             */
+/*                                                                            */
+/* elevation - The elevation of each tile type.                               */
+/* terrain_type - The terrain type of each tile type.                         */
+/* water_depth - The water depth of each tile type.                           */
+/* movement_modifier - The movement modifier of each tile type.               */
+/******************************************************************************/
+typedef struct dt_map_tile_type_layers
+{
+  Sint16 elevation[DT_MAX_TILE_TYPES];
+  unsigned char terrain_type[DT_MAX_TILE_TYPES];
+  unsigned char water_depth[DT_MAX_TILE_TYPES];
+  unsigned char movement_modifier[DT_MAX_TILE_TYPES];
+} DT_MAP_TILE_TYPE_LAYERS;
+
+/******************************************************************************/
+/* DT_MAP_TEXT_LOAD_JOB:                                                      */
+/*                                                                            */
+/* One share of the points of a text map, counted and then read on the master */
+/* worker pool. The jobs' shares of the text follow on from each other, and   */
+/* each starts at the start of a point.                                       */
+/*                                                                            */
+/* grid - The grid the points are read into.                                  */
+/* layers - The layer values of the grid's tile types.                        */
+/* text - The start of the job's share of the text.                           */
+/* share_length - The length of the job's share of the text.                  */
+/* text_length - The length of the text from the start of the share to the    */
+/*               end of the file. A job may read past the end of its share.   */
+/* num_tokens - The number of tokens which start in the share.                */
+/* first_index - The index of the first point in the share.                   */
+/* start_index - The index of the first point the job reads.                  */
+/* end_index - The index after the last point the job reads.                  */
+/* ret_code - DT_MAP_FILE_LOADED, or what was wrong with the job's points.    */
+/*                                                                            */
+/* The points a job reads are from the first to start a traversable word at   */
+/* or after first_index up to the first to do so in the next share, so that   */
+/* every traversable word is written by exactly one job.                      */
+/******************************************************************************/
+typedef struct dt_map_text_load_job
+{
+  struct dt_grid *grid;
+  struct dt_map_tile_type_layers *layers;
+  char *text;
+  size_t share_length;
+  size_t text_length;
+  size_t num_tokens;
+  size_t first_index;
+  size_t start_index;
+  size_t end_index;
+  int ret_code;
+} DT_MAP_TEXT_LOAD_JOB;
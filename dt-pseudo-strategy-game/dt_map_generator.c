@@ -0,0 +1,845 @@
+/******************************************************************************/
+/* File: dt_map_generator.c                                                   */
+/*                                                                            */
+/* Purpose: Generation of maps of any size from a seed, either straight into  */
+/*          a grid or out to a chunked binary map a row of chunks at a time.  */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_map_generator                                          */
+/*                                                                            */
+/* Purpose: Create a generator for a map and place its units.                 */
+/*                                                                            */
+/* Returns: A pointer to the new generator.                                   */
+/*                                                                            */
+/* Parameters: IN     num_tiles_x - The width of the map in tiles.            */
+/*             IN     num_tiles_y - The height of the map in tiles.           */
+/*             IN     seed - The seed to generate the map from.               */
+/*             IN     num_units - The number of units to place.               */
+/*                                                                            */
+/* Operation: Make a seed for each noise field from the seed of the map, then */
+/*            place the units. No terrain is generated until it is asked for. */
+/******************************************************************************/
+DT_MAP_GENERATOR *dt_create_map_generator(int num_tiles_x,
+                                          int num_tiles_y,
+                                          Uint32 seed,
+                                          int num_units)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  int ii;
+
+  generator = (DT_MAP_GENERATOR *) dt_malloc(sizeof(DT_MAP_GENERATOR));
+  generator->seed = seed;
+  for (ii = 0; ii < DT_MAPGEN_NUM_FIELDS; ii++)
+  {
+    generator->field_seeds[ii] = dt_map_generator_hash(seed, ii, -1);
+  }
+  generator->num_tiles_x = num_tiles_x;
+  generator->num_tiles_y = num_tiles_y;
+  generator->num_chunks_x = (num_tiles_x + DT_GRID_CHUNK_SIZE - 1) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  generator->num_chunks_y = (num_tiles_y + DT_GRID_CHUNK_SIZE - 1) >>
+                                                          DT_GRID_CHUNK_SHIFT;
+  generator->row_records = NULL;
+  generator->row_chunk_y = -1;
+  dt_place_generated_units(generator, num_units);
+
+  return(generator);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_map_generator                                         */
+/*                                                                            */
+/* Purpose: Free a map generator.                                             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     generator - The generator to free.                      */
+/*                                                                            */
+/* Operation: Free the unit placements, any row of records and the generator. */
+/******************************************************************************/
+void dt_destroy_map_generator(DT_MAP_GENERATOR *generator)
+{
+  if (NULL != generator->units)
+  {
+    dt_free(generator->units);
+  }
+  if (NULL != generator->row_records)
+  {
+    dt_free(generator->row_records);
+  }
+  dt_free(generator);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_map_generator_hash                                            */
+/*                                                                            */
+/* Purpose: Hash a seed and a pair of coordinates.                            */
+/*                                                                            */
+/* Returns: A well mixed 32 bit value.                                        */
+/*                                                                            */
+/* Parameters: IN     seed - The seed.                                        */
+/*             IN     x - The first coordinate.                               */
+/*             IN     y - The second coordinate.                              */
+/*                                                                            */
+/* Operation: Combine the values with large odd multipliers and then mix the  */
+/*            bits with the finaliser of MurmurHash3. Only 32 bit unsigned    */
+/*            arithmetic is used, so every platform gives the same value.     */
+/******************************************************************************/
+Uint32 dt_map_generator_hash(Uint32 seed, int x, int y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 hash;
+
+  hash = seed ^ ((Uint32) x * 0x27D4EB2Du) ^ ((Uint32) y * 0x165667B1u);
+  hash ^= hash >> 15;
+  hash *= 0x85EBCA6Bu;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35u;
+  hash ^= hash >> 16;
+
+  return(hash);
+}
+
+/******************************************************************************/
+/* Function: dt_map_generator_noise                                           */
+/*                                                                            */
+/* Purpose: Sample smooth value noise.                                        */
+/*                                                                            */
+/* Returns: A value from 0 to 1.                                              */
+/*                                                                            */
+/* Parameters: IN     seed - The seed of the noise field.                     */
+/*             IN     x - The x position, which must not be negative.         */
+/*             IN     y - The y position, which must not be negative.         */
+/*                                                                            */
+/* Operation: Give each whole position a random value from its hash and blend */
+/*            the four around the position with a smooth step so the field    */
+/*            has no creases.                                                 */
+/******************************************************************************/
+double dt_map_generator_noise(Uint32 seed, double x, double y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int cell_x = (int) x;
+  int cell_y = (int) y;
+  double fraction_x = x - cell_x;
+  double fraction_y = y - cell_y;
+  double corners[4];
+  double top;
+  double bottom;
+
+  corners[0] = dt_map_generator_hash(seed, cell_x, cell_y);
+  corners[1] = dt_map_generator_hash(seed, cell_x + 1, cell_y);
+  corners[2] = dt_map_generator_hash(seed, cell_x, cell_y + 1);
+  corners[3] = dt_map_generator_hash(seed, cell_x + 1, cell_y + 1);
+  fraction_x = fraction_x * fraction_x * (3.0 - (2.0 * fraction_x));
+  fraction_y = fraction_y * fraction_y * (3.0 - (2.0 * fraction_y));
+  top = corners[0] + (fraction_x * (corners[1] - corners[0]));
+  bottom = corners[2] + (fraction_x * (corners[3] - corners[2]));
+
+  return((top + (fraction_y * (bottom - top))) / 4294967296.0);
+}
+
+/******************************************************************************/
+/* Function: dt_map_generator_fractal                                         */
+/*                                                                            */
+/* Purpose: Sample fractal noise, which has detail at several scales.         */
+/*                                                                            */
+/* Returns: A value from 0 to 1, most often near 0.5.                         */
+/*                                                                            */
+/* Parameters: IN     seed - The seed of the noise field.                     */
+/*             IN     x - The x position in tiles.                            */
+/*             IN     y - The y position in tiles.                            */
+/*             IN     scale - The size in tiles of the largest features.      */
+/*             IN     octaves - The number of scales to add together.         */
+/*                                                                            */
+/* Operation: Add value noise at the scale given and then at each half scale  */
+/*            below it with half the weight, and divide by the total weight.  */
+/******************************************************************************/
+double dt_map_generator_fractal(Uint32 seed,
+                                int x,
+                                int y,
+                                double scale,
+                                int octaves)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  double frequency = 1.0 / scale;
+  double weight = 1.0;
+  double total = 0.0;
+  double total_weight = 0.0;
+  int octave;
+
+  for (octave = 0; octave < octaves; octave++)
+  {
+    total += weight * dt_map_generator_noise(seed + (Uint32) octave,
+                                             x * frequency,
+                                             y * frequency);
+    total_weight += weight;
+    frequency *= 2.0;
+    weight *= 0.5;
+  }
+
+  return(total / total_weight);
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_point                                            */
+/*                                                                            */
+/* Purpose: Generate the terrain of one point of a map.                       */
+/*                                                                            */
+/* Returns: The terrain type of the point. One of DT_GROUND_TYPES.            */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             OUT    elevation - The elevation of the point.                 */
+/*             OUT    traversable - Whether units may enter the point.        */
+/*                                                                            */
+/* Operation: The height is the elevation field raised along the ridges of    */
+/*            the ranges field where the ground is already high. High ground  */
+/*            is mountain. Below that, points near the middle of the rivers   */
+/*            field are river, and low points with high moisture are swamp.   */
+/*            The remaining fields are only sampled where they are needed.    */
+/******************************************************************************/
+int dt_generate_map_point(DT_MAP_GENERATOR *generator,
+                          int grid_x,
+                          int grid_y,
+                          int *elevation,
+                          bool *traversable)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  double height;
+  double ridge;
+  double uplift;
+  double river;
+  int terrain_type = DT_GROUND_TYPE_PLAIN;
+
+  /****************************************************************************/
+  /* Work out the height, raising mountain ranges along the ridges.           */
+  /****************************************************************************/
+  height = dt_map_generator_fractal(
+                           generator->field_seeds[DT_MAPGEN_FIELD_ELEVATION],
+                           grid_x,
+                           grid_y,
+                           DT_MAPGEN_ELEVATION_SCALE,
+                           DT_MAPGEN_ELEVATION_OCTAVES);
+  uplift = CLAMP((height - DT_MAPGEN_RANGE_LEVEL) * 5.0, 0.0, 1.0);
+  if (uplift > 0.0)
+  {
+    ridge = dt_map_generator_fractal(
+                              generator->field_seeds[DT_MAPGEN_FIELD_RANGES],
+                              grid_x,
+                              grid_y,
+                              DT_MAPGEN_RANGE_SCALE,
+                              DT_MAPGEN_RANGE_OCTAVES);
+    ridge = CLAMP(1.0 - (DT_MAPGEN_RANGE_SHARPNESS *
+                         ((ridge > 0.5) ? (ridge - 0.5) : (0.5 - ridge))),
+                  0.0,
+                  1.0);
+    height += uplift * DT_MAPGEN_RANGE_HEIGHT * ridge * ridge;
+  }
+  (*elevation) = (int) ((height - DT_MAPGEN_SEA_LEVEL) *
+                                                   DT_MAPGEN_ELEVATION_RANGE);
+  (*traversable) = (height < DT_MAPGEN_PEAK_LEVEL);
+
+  /****************************************************************************/
+  /* Decide the terrain.                                                      */
+  /****************************************************************************/
+  if (height >= DT_MAPGEN_MOUNTAIN_LEVEL)
+  {
+    terrain_type = DT_GROUND_TYPE_MOUNTAIN;
+    goto EXIT_LABEL;
+  }
+  river = dt_map_generator_fractal(
+                              generator->field_seeds[DT_MAPGEN_FIELD_RIVERS],
+                              grid_x,
+                              grid_y,
+                              DT_MAPGEN_RIVER_SCALE,
+                              DT_MAPGEN_RIVER_OCTAVES);
+  if ((river > 0.5 - DT_MAPGEN_RIVER_WIDTH) &&
+      (river < 0.5 + DT_MAPGEN_RIVER_WIDTH))
+  {
+    terrain_type = DT_GROUND_TYPE_RIVER;
+    (*elevation) -= DT_MAPGEN_RIVER_BED_DEPTH;
+    goto EXIT_LABEL;
+  }
+  if ((height < DT_MAPGEN_SWAMP_LEVEL) &&
+      (dt_map_generator_fractal(
+                            generator->field_seeds[DT_MAPGEN_FIELD_MOISTURE],
+                            grid_x,
+                            grid_y,
+                            DT_MAPGEN_MOISTURE_SCALE,
+                            DT_MAPGEN_MOISTURE_OCTAVES) >
+                                                   DT_MAPGEN_SWAMP_MOISTURE))
+  {
+    terrain_type = DT_GROUND_TYPE_SWAMP;
+  }
+
+EXIT_LABEL:
+
+  return(terrain_type);
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_chunk                                            */
+/*                                                                            */
+/* Purpose: Generate one chunk of a map as a chunked binary map record.       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     chunk_x - The x position of the chunk, in chunks.       */
+/*             IN     chunk_y - The y position of the chunk, in chunks.       */
+/*             OUT    record - The record to fill.                            */
+/*                                                                            */
+/* Operation: Generate each point of the chunk which lies on the map and give */
+/*            it the tile type of its terrain, whose water depth and movement */
+/*            modifier it keeps. Points off the map are empty plains and are  */
+/*            not traversable, as dt_gather_map_file_chunk leaves them.       */
+/******************************************************************************/
+void dt_generate_map_chunk(DT_MAP_GENERATOR *generator,
+                           int chunk_x,
+                           int chunk_y,
+                           DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const unsigned char water_depths[DT_MAPGEN_NUM_TILE_TYPES] =
+                                      {DT_MAPGEN_PLAIN_WATER_DEPTH,
+                                       DT_MAPGEN_SWAMP_WATER_DEPTH,
+                                       DT_MAPGEN_MOUNTAIN_WATER_DEPTH,
+                                       DT_MAPGEN_RIVER_WATER_DEPTH};
+  static const unsigned char movement_modifiers[DT_MAPGEN_NUM_TILE_TYPES] =
+                                      {DT_MAPGEN_PLAIN_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_SWAMP_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_MOUNTAIN_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_RIVER_MOVEMENT_MODIFIER};
+  int terrain_type;
+  int elevation;
+  bool traversable;
+  int grid_x;
+  int grid_y;
+  int row;
+  int col;
+  int ii;
+
+  memset(record, 0, sizeof(DT_MAP_FILE_CHUNK));
+  for (row = 0; row < DT_GRID_CHUNK_SIZE; row++)
+  {
+    grid_y = (chunk_y << DT_GRID_CHUNK_SHIFT) + row;
+    if (grid_y >= generator->num_tiles_y)
+    {
+      break;
+    }
+    for (col = 0; col < DT_GRID_CHUNK_SIZE; col++)
+    {
+      grid_x = (chunk_x << DT_GRID_CHUNK_SHIFT) + col;
+      if (grid_x >= generator->num_tiles_x)
+      {
+        break;
+      }
+      ii = (row << DT_GRID_CHUNK_SHIFT) + col;
+      terrain_type = dt_generate_map_point(generator,
+                                           grid_x,
+                                           grid_y,
+                                           &elevation,
+                                           &traversable);
+      if (traversable)
+      {
+        record->traversable[row] |= 1u << col;
+      }
+      record->elevation[ii] = (Sint16) CLAMP(elevation, -32768, 32767);
+      record->tile_type[ii] = (unsigned char) (terrain_type + 1);
+      record->terrain_type[ii] = (unsigned char) terrain_type;
+      record->water_depth[ii] = water_depths[terrain_type];
+      record->movement_modifier[ii] = movement_modifiers[terrain_type];
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_chunk_job                                        */
+/*                                                                            */
+/* Purpose: Generate a chunk on the master worker pool.                       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     data - The DT_MAP_GENERATOR_JOB for the chunk.          */
+/*                                                                            */
+/* Operation: Generate the chunk into the job's record.                       */
+/******************************************************************************/
+void dt_generate_map_chunk_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR_JOB *job = (DT_MAP_GENERATOR_JOB *) data;
+
+  dt_generate_map_chunk(job->generator,
+                        job->chunk_x,
+                        job->chunk_y,
+                        job->record);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_chunk_row                                        */
+/*                                                                            */
+/* Purpose: Generate a row of chunks of a map.                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     chunk_y - The y position of the row, in chunks.         */
+/*             OUT    records - A record for each chunk across the map.       */
+/*                                                                            */
+/* Operation: Generate each chunk as its own job on the master worker pool.   */
+/*            As every point depends only on its position the result is the   */
+/*            same however the jobs are shared out.                           */
+/******************************************************************************/
+void dt_generate_map_chunk_row(DT_MAP_GENERATOR *generator,
+                               int chunk_y,
+                               DT_MAP_FILE_CHUNK *records)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR_JOB *jobs;
+  int chunk_x;
+
+  jobs = (DT_MAP_GENERATOR_JOB *) dt_malloc(sizeof(DT_MAP_GENERATOR_JOB) *
+                                          (size_t) generator->num_chunks_x);
+  for (chunk_x = 0; chunk_x < generator->num_chunks_x; chunk_x++)
+  {
+    jobs[chunk_x].generator = generator;
+    jobs[chunk_x].chunk_x = chunk_x;
+    jobs[chunk_x].chunk_y = chunk_y;
+    jobs[chunk_x].record = &(records[chunk_x]);
+  }
+  dt_run_worker_pool_jobs(dt_get_master_worker_pool(),
+                          dt_generate_map_chunk_job,
+                          jobs,
+                          sizeof(DT_MAP_GENERATOR_JOB),
+                          generator->num_chunks_x);
+  dt_free(jobs);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_add_generated_tile_types                                      */
+/*                                                                            */
+/* Purpose: Add the tile types of a generated map to a grid.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid, which must have no tile types yet.     */
+/*                                                                            */
+/* Operation: Add a tile type for each of the DT_GROUND_TYPES in order, so    */
+/*            the tile type of each is its ground type plus one.              */
+/******************************************************************************/
+void dt_add_generated_tile_types(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  static const int water_depths[DT_MAPGEN_NUM_TILE_TYPES] =
+                                      {DT_MAPGEN_PLAIN_WATER_DEPTH,
+                                       DT_MAPGEN_SWAMP_WATER_DEPTH,
+                                       DT_MAPGEN_MOUNTAIN_WATER_DEPTH,
+                                       DT_MAPGEN_RIVER_WATER_DEPTH};
+  static const int movement_modifiers[DT_MAPGEN_NUM_TILE_TYPES] =
+                                      {DT_MAPGEN_PLAIN_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_SWAMP_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_MOUNTAIN_MOVEMENT_MODIFIER,
+                                       DT_MAPGEN_RIVER_MOVEMENT_MODIFIER};
+  DT_BACKGROUND_TILE *tile;
+  int tile_type;
+  int ii;
+
+  for (ii = 0; ii < DT_MAPGEN_NUM_TILE_TYPES; ii++)
+  {
+    tile = dt_create_background_tile();
+    tile->terrain_type = ii;
+    tile->water_depth = water_depths[ii];
+    tile->movement_modifier = movement_modifiers[ii];
+    dt_add_tile_type_to_grid(grid, tile, &tile_type);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map                                                  */
+/*                                                                            */
+/* Purpose: Generate a whole map into a new grid.                             */
+/*                                                                            */
+/* Returns: A pointer to the new grid.                                        */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     storage - How the grid is to be stored. One of          */
+/*                              DT_GRID_STORAGE_TYPES.                        */
+/*                                                                            */
+/* Operation: Generate the map a row of chunks at a time on the master worker */
+/*            pool and copy each chunk into the grid. Chunks of a chunked     */
+/*            grid are copied whole. Otherwise each point is set through the  */
+/*            grid functions. No units are put on the grid.                   */
+/******************************************************************************/
+DT_GRID *dt_generate_map(DT_MAP_GENERATOR *generator, int storage)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  DT_MAP_FILE_CHUNK *records;
+  DT_MAP_FILE_CHUNK *record;
+  int chunk_x;
+  int chunk_y;
+  int grid_x;
+  int grid_y;
+  int ii;
+
+  grid = dt_create_grid_with_storage(DT_MAPGEN_SQUARE_SIZE,
+                                     DT_MAPGEN_SQUARE_SIZE,
+                                     generator->num_tiles_x,
+                                     generator->num_tiles_y,
+                                     storage);
+  dt_add_generated_tile_types(grid);
+  records = (DT_MAP_FILE_CHUNK *) dt_malloc(sizeof(DT_MAP_FILE_CHUNK) *
+                                          (size_t) generator->num_chunks_x);
+
+  for (chunk_y = 0; chunk_y < generator->num_chunks_y; chunk_y++)
+  {
+    dt_generate_map_chunk_row(generator, chunk_y, records);
+    for (chunk_x = 0; chunk_x < generator->num_chunks_x; chunk_x++)
+    {
+      record = &(records[chunk_x]);
+      if (DT_GRID_STORAGE_CHUNKED == storage)
+      {
+        dt_copy_map_file_chunk(record,
+                               dt_get_grid_chunk_for_update(
+                                           grid,
+                                           chunk_x << DT_GRID_CHUNK_SHIFT,
+                                           chunk_y << DT_GRID_CHUNK_SHIFT));
+        continue;
+      }
+      for (grid_y = chunk_y << DT_GRID_CHUNK_SHIFT;
+           grid_y < MIN((chunk_y + 1) << DT_GRID_CHUNK_SHIFT,
+                        grid->num_tiles_y);
+           grid_y++)
+      {
+        for (grid_x = chunk_x << DT_GRID_CHUNK_SHIFT;
+             grid_x < MIN((chunk_x + 1) << DT_GRID_CHUNK_SHIFT,
+                          grid->num_tiles_x);
+             grid_x++)
+        {
+          ii = dt_get_grid_chunk_index(grid_x, grid_y);
+          dt_assign_tile_type_to_grid(grid,
+                                      grid_x,
+                                      grid_y,
+                                      record->tile_type[ii]);
+          dt_set_grid_terrain_overrides(grid,
+                                        grid_x,
+                                        grid_y,
+                                        record->elevation[ii],
+                                        record->water_depth[ii],
+                                        record->movement_modifier[ii]);
+          if (0 == (record->traversable[grid_y & DT_GRID_CHUNK_MASK] &
+                                    (1u << (grid_x & DT_GRID_CHUNK_MASK))))
+          {
+            dt_set_grid_traversable(grid, grid_x, grid_y, false);
+          }
+        }
+      }
+    }
+  }
+  dt_free(records);
+
+  return(grid);
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_file_chunk                                       */
+/*                                                                            */
+/* Purpose: The DT_MAP_FILE_CHUNK_SOURCE used to write a generated map out as */
+/*          a chunked binary map.                                             */
+/*                                                                            */
+/* Returns: true, as every chunk of a generated map has a record.             */
+/*                                                                            */
+/* Parameters: IN     context - The generator of the map.                     */
+/*             IN     chunk_x - The x position of the chunk, in chunks.       */
+/*             IN     chunk_y - The y position of the chunk, in chunks.       */
+/*             OUT    record - The record to fill.                            */
+/*                                                                            */
+/* Operation: Chunks are asked for row by row. The first time a chunk of a    */
+/*            row is asked for generate the whole row together, then hand out */
+/*            the records of that row.                                        */
+/******************************************************************************/
+bool dt_generate_map_file_chunk(void *context,
+                                int chunk_x,
+                                int chunk_y,
+                                DT_MAP_FILE_CHUNK *record)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator = (DT_MAP_GENERATOR *) context;
+
+  if (NULL == generator->row_records)
+  {
+    generator->row_records = (DT_MAP_FILE_CHUNK *)
+                          dt_malloc(sizeof(DT_MAP_FILE_CHUNK) *
+                                    (size_t) generator->num_chunks_x);
+  }
+  if (chunk_y != generator->row_chunk_y)
+  {
+    dt_generate_map_chunk_row(generator, chunk_y, generator->row_records);
+    generator->row_chunk_y = chunk_y;
+  }
+  memcpy(record, &(generator->row_records[chunk_x]), sizeof(DT_MAP_FILE_CHUNK));
+
+  return(true);
+}
+
+/******************************************************************************/
+/* Function: dt_write_generated_map_file                                      */
+/*                                                                            */
+/* Purpose: Generate a map straight out to a chunked binary map.              */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written, otherwise one of       */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     filename - The file to write.                           */
+/*             IN     encoding - How to encode the chunks. One of             */
+/*                               DT_CHUNK_ENCODINGS.                          */
+/*                                                                            */
+/* Operation: Create a chunked grid of the size of the map with only the tile */
+/*            types in it, whose chunks all stay the default chunk, to give   */
+/*            the header. Then write the map generating the records a row of  */
+/*            chunks at a time, so maps far larger than memory can be written.*/
+/******************************************************************************/
+int dt_write_generated_map_file(DT_MAP_GENERATOR *generator,
+                                char *filename,
+                                int encoding)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid;
+  int ret_code;
+
+  grid = dt_create_grid_with_storage(DT_MAPGEN_SQUARE_SIZE,
+                                     DT_MAPGEN_SQUARE_SIZE,
+                                     generator->num_tiles_x,
+                                     generator->num_tiles_y,
+                                     DT_GRID_STORAGE_CHUNKED);
+  dt_add_generated_tile_types(grid);
+  generator->row_chunk_y = -1;
+  ret_code = dt_write_chunk_source_map_file(grid,
+                                            filename,
+                                            encoding,
+                                            dt_generate_map_file_chunk,
+                                            generator);
+  dt_destroy_grid(grid);
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_place_generated_units                                         */
+/*                                                                            */
+/* Purpose: Choose where the units of a generated map start.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     generator - The generator of the map.                   */
+/*             IN     num_units - The number of units to place.               */
+/*                                                                            */
+/* Operation: Try random points from the units field for each unit in turn,   */
+/*            keeping the first which can be crossed, is not river and has no */
+/*            unit on it already. A set of the points used, hashed on their   */
+/*            position, finds clashes. A unit which has no place after        */
+/*            DT_MAPGEN_UNIT_ATTEMPTS tries is left out.                      */
+/******************************************************************************/
+void dt_place_generated_units(DT_MAP_GENERATOR *generator, int num_units)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_UNIT_PLACEMENT *unit;
+  Uint32 *used_points;
+  Uint32 used_mask;
+  Uint32 point;
+  Uint32 random;
+  Uint32 slot;
+  int elevation;
+  bool traversable;
+  bool placed;
+  int attempt;
+  int grid_x;
+  int grid_y;
+  int ii;
+
+  generator->units = NULL;
+  generator->num_units = 0;
+  if (num_units <= 0)
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* The set of used points has at least twice as many slots as units. Each   */
+  /* slot holds a point's index plus one, so zero is empty.                   */
+  /****************************************************************************/
+  used_mask = 1;
+  while (used_mask < (Uint32) num_units * 2)
+  {
+    used_mask <<= 1;
+  }
+  used_points = (Uint32 *) dt_calloc(used_mask, sizeof(Uint32));
+  used_mask--;
+  generator->units = (DT_MAP_UNIT_PLACEMENT *)
+                  dt_malloc(sizeof(DT_MAP_UNIT_PLACEMENT) * (size_t) num_units);
+
+  for (ii = 0; ii < num_units; ii++)
+  {
+    placed = false;
+    for (attempt = 0; (attempt < DT_MAPGEN_UNIT_ATTEMPTS) && !placed; attempt++)
+    {
+      random = dt_map_generator_hash(
+                                generator->field_seeds[DT_MAPGEN_FIELD_UNITS],
+                                ii,
+                                attempt);
+      grid_x = (int) (random % (Uint32) generator->num_tiles_x);
+      grid_y = (int) (dt_map_generator_hash(random, ii, attempt) %
+                                               (Uint32) generator->num_tiles_y);
+      if ((DT_GROUND_TYPE_RIVER == dt_generate_map_point(generator,
+                                                          grid_x,
+                                                          grid_y,
+                                                          &elevation,
+                                                          &traversable)) ||
+          !traversable)
+      {
+        continue;
+      }
+      point = ((Uint32) grid_y * (Uint32) generator->num_tiles_x) +
+                                                         (Uint32) grid_x + 1;
+      slot = dt_map_generator_hash(point, 0, 0) & used_mask;
+      while ((0 != used_points[slot]) && (point != used_points[slot]))
+      {
+        slot = (slot + 1) & used_mask;
+      }
+      if (0 != used_points[slot])
+      {
+        continue;
+      }
+      used_points[slot] = point;
+      unit = &(generator->units[generator->num_units]);
+      unit->grid_x = grid_x;
+      unit->grid_y = grid_y;
+      unit->orientation = (int) ((random >> 8) % NORTH_1);
+      (generator->num_units)++;
+      placed = true;
+    }
+  }
+  dt_free(used_points);
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_generate_map_file                                             */
+/*                                                                            */
+/* Purpose: Generate a map from the command line and write it out.            */
+/*                                                                            */
+/* Returns: DT_MAP_FILE_LOADED if the map was written, otherwise one of       */
+/*          DT_MAP_FILE_RETURN_CODES.                                         */
+/*                                                                            */
+/* Parameters: IN     num_tiles_x - The width of the map in tiles.            */
+/*             IN     num_tiles_y - The height of the map in tiles.           */
+/*             IN     seed - The seed to generate the map from.               */
+/*             IN     filename - The file to write.                           */
+/*             IN     text - Whether to write a text map rather than a        */
+/*                           chunked binary map with zlib compressed chunks.  */
+/*                                                                            */
+/* Operation: A chunked binary map is written a row of chunks at a time. A    */
+/*            text map is generated whole into a row-major grid first. Units  */
+/*            are not stored in either format, so only their number is        */
+/*            reported; the same seed places them again.                      */
+/******************************************************************************/
+int dt_generate_map_file(int num_tiles_x,
+                         int num_tiles_y,
+                         Uint32 seed,
+                         char *filename,
+                         bool text)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MAP_GENERATOR *generator;
+  DT_GRID *grid;
+  Uint64 start_time;
+  int ret_code;
+
+  start_time = dt_get_time_us();
+  generator = dt_create_map_generator(
+                         num_tiles_x,
+                         num_tiles_y,
+                         seed,
+                         (int) MAX(((double) num_tiles_x * num_tiles_y) /
+                                              DT_MAPGEN_TILES_PER_UNIT, 1));
+  if (text)
+  {
+    grid = dt_generate_map(generator, DT_GRID_STORAGE_ROW_MAJOR);
+    ret_code = dt_write_text_map_file(grid, filename);
+    dt_destroy_grid(grid);
+  }
+  else
+  {
+    ret_code = dt_write_generated_map_file(generator,
+                                           filename,
+                                           DT_CHUNK_ENCODING_ZLIB);
+  }
+
+  if (DT_MAP_FILE_LOADED != ret_code)
+  {
+    fprintf(stderr, "Failed to write map %s (error %d).\n",
+            filename,
+            ret_code);
+  }
+  else
+  {
+    printf("%s: %d x %d from seed %u, %d units placed, %.1f MB written in "
+           "%.1f ms\n",
+           filename,
+           num_tiles_x,
+           num_tiles_y,
+           (unsigned int) seed,
+           generator->num_units,
+           (double) dt_get_file_size(filename) / (1024.0 * 1024.0),
+           (dt_get_time_us() - start_time) / 1000.0);
+  }
+  dt_destroy_map_generator(generator);
+
+  return(ret_code);
+}
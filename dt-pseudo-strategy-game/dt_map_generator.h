@@ -0,0 +1,179 @@
+/******************************************************************************/
+/* File: dt_map_generator.h                                                   */
+/*                                                                            */
+/* Purpose: Definitions for generating maps of any size from a seed, so that  */
+/*          benchmarks and stress tests always run on the same terrain.       */
+/*                                                                            */
+/* The terrain of every point is worked out from the seed and its position    */
+/* alone, using smooth noise fields measured in tiles:                        */
+/*                                                                            */
+/*   elevation - The general lie of the land.                                 */
+/*   ranges - Ridged noise. Where its ridges cross high ground they raise     */
+/*            lines of mountains, whose peaks cannot be crossed.              */
+/*   moisture - Low, wet ground is swamp.                                     */
+/*   rivers - Rivers run along the lines where this field crosses its middle  */
+/*            value, everywhere below the mountains.                          */
+/*                                                                            */
+/* So any part of a map can be generated on its own, in any order, and the    */
+/* same seed always gives the same map whatever its storage.                  */
+/******************************************************************************/
+
+/******************************************************************************/
+/* The shape of the generated terrain.                                        */
+/*                                                                            */
+/* DT_MAPGEN_ELEVATION_SCALE - The size in tiles of the largest hills.        */
+/* DT_MAPGEN_ELEVATION_OCTAVES - The number of layers of finer detail added   */
+/*                               to the elevation.                            */
+/* DT_MAPGEN_RANGE_SCALE - The size in tiles of the pattern of ranges.        */
+/* DT_MAPGEN_RANGE_OCTAVES - The detail of the ranges.                        */
+/* DT_MAPGEN_RANGE_SHARPNESS - How narrow the ridges of the ranges are.       */
+/* DT_MAPGEN_RANGE_HEIGHT - How far the ridges raise the ground.              */
+/* DT_MAPGEN_RANGE_LEVEL - The height above which ridges start to raise the   */
+/*                         ground. They are at full height 0.2 above it.      */
+/* DT_MAPGEN_MOISTURE_SCALE - The size in tiles of wet and dry areas.         */
+/* DT_MAPGEN_MOISTURE_OCTAVES - The detail of the moisture.                   */
+/* DT_MAPGEN_RIVER_SCALE - The size in tiles of the bends in rivers.          */
+/* DT_MAPGEN_RIVER_OCTAVES - The detail of the rivers.                        */
+/* DT_MAPGEN_RIVER_WIDTH - How close to its middle value the river field must */
+/*                         be for a point to be river.                        */
+/* DT_MAPGEN_MOUNTAIN_LEVEL - The height, from 0 to 1, above which the ground */
+/*                            is mountain.                                    */
+/* DT_MAPGEN_PEAK_LEVEL - The height above which mountains cannot be crossed. */
+/* DT_MAPGEN_SWAMP_LEVEL - The height below which wet ground is swamp.        */
+/* DT_MAPGEN_SWAMP_MOISTURE - The moisture, from 0 to 1, above which low      */
+/*                            ground is swamp.                                */
+/* DT_MAPGEN_SEA_LEVEL - The height given an elevation of 0.                  */
+/* DT_MAPGEN_ELEVATION_RANGE - The elevation given to a height of 1 above the */
+/*                             sea level.                                     */
+/* DT_MAPGEN_RIVER_BED_DEPTH - How far below the land around it a river runs. */
+/******************************************************************************/
+#define DT_MAPGEN_ELEVATION_SCALE 256.0
+#define DT_MAPGEN_ELEVATION_OCTAVES 5
+#define DT_MAPGEN_RANGE_SCALE 384.0
+#define DT_MAPGEN_RANGE_OCTAVES 3
+#define DT_MAPGEN_RANGE_SHARPNESS 8.0
+#define DT_MAPGEN_RANGE_HEIGHT 0.35
+#define DT_MAPGEN_RANGE_LEVEL 0.45
+#define DT_MAPGEN_MOISTURE_SCALE 128.0
+#define DT_MAPGEN_MOISTURE_OCTAVES 3
+#define DT_MAPGEN_RIVER_SCALE 320.0
+#define DT_MAPGEN_RIVER_OCTAVES 3
+#define DT_MAPGEN_RIVER_WIDTH 0.012
+#define DT_MAPGEN_MOUNTAIN_LEVEL 0.68
+#define DT_MAPGEN_PEAK_LEVEL 0.84
+#define DT_MAPGEN_SWAMP_LEVEL 0.45
+#define DT_MAPGEN_SWAMP_MOISTURE 0.58
+#define DT_MAPGEN_SEA_LEVEL 0.25
+#define DT_MAPGEN_ELEVATION_RANGE 4000.0
+#define DT_MAPGEN_RIVER_BED_DEPTH 5
+
+/******************************************************************************/
+/* The values of the tile type generated for each of the DT_GROUND_TYPES.     */
+/* They are added to a grid in the order of the ground types, so the tile     */
+/* type of each is its ground type plus one.                                  */
+/*                                                                            */
+/* DT_MAPGEN_*_WATER_DEPTH - The water depth of the tile type.                */
+/* DT_MAPGEN_*_MOVEMENT_MODIFIER - The movement modifier of the tile type.    */
+/******************************************************************************/
+#define DT_MAPGEN_PLAIN_WATER_DEPTH 0
+#define DT_MAPGEN_PLAIN_MOVEMENT_MODIFIER 0
+#define DT_MAPGEN_SWAMP_WATER_DEPTH 1
+#define DT_MAPGEN_SWAMP_MOVEMENT_MODIFIER 4
+#define DT_MAPGEN_MOUNTAIN_WATER_DEPTH 0
+#define DT_MAPGEN_MOUNTAIN_MOVEMENT_MODIFIER 6
+#define DT_MAPGEN_RIVER_WATER_DEPTH 3
+#define DT_MAPGEN_RIVER_MOVEMENT_MODIFIER 8
+#define DT_MAPGEN_NUM_TILE_TYPES 4
+
+/******************************************************************************/
+/* Other parameters of generated maps.                                        */
+/*                                                                            */
+/* DT_MAPGEN_SQUARE_SIZE - The width and height in pixels of each tile.       */
+/* DT_MAPGEN_UNIT_ATTEMPTS - The number of random places tried for each unit  */
+/*                           before it is left out.                           */
+/* DT_MAPGEN_TILES_PER_UNIT - The number of tiles of map for each unit placed */
+/*                            on a map generated from the command line.       */
+/******************************************************************************/
+#define DT_MAPGEN_SQUARE_SIZE 10
+#define DT_MAPGEN_UNIT_ATTEMPTS 64
+#define DT_MAPGEN_TILES_PER_UNIT 1024
+
+/******************************************************************************/
+/* Group: DT_MAPGEN_FIELDS                                                    */
+/*                                                                            */
+/* The noise fields of the generator. Each has its own seed made from the     */
+/* seed of the map.                                                           */
+/******************************************************************************/
+#define DT_MAPGEN_FIELD_ELEVATION 0
+#define DT_MAPGEN_FIELD_RANGES 1
+#define DT_MAPGEN_FIELD_MOISTURE 2
+#define DT_MAPGEN_FIELD_RIVERS 3
+#define DT_MAPGEN_FIELD_UNITS 4
+#define DT_MAPGEN_NUM_FIELDS 5
+
+/******************************************************************************/
+/* DT_MAP_UNIT_PLACEMENT:                                                     */
+/*                                                                            */
+/* Where a unit starts on a generated map. Units are only placed on points    */
+/* which can be crossed and are not river, and never two on one point.        */
+/*                                                                            */
+/* grid_x - The x coordinate on the grid.                                     */
+/* grid_y - The y coordinate on the grid.                                     */
+/* orientation - The way the unit faces. One of DT_VIEW_ORIENTATIONS.         */
+/******************************************************************************/
+typedef struct dt_map_unit_placement
+{
+  int grid_x;
+  int grid_y;
+  int orientation;
+} DT_MAP_UNIT_PLACEMENT;
+
+/******************************************************************************/
+/* DT_MAP_GENERATOR:                                                          */
+/*                                                                            */
+/* Generates one map.                                                         */
+/*                                                                            */
+/* seed - The seed the map is generated from.                                 */
+/* field_seeds - The seed of each of the DT_MAPGEN_FIELDS.                    */
+/* num_tiles_x - The width of the map in tiles.                               */
+/* num_tiles_y - The height of the map in tiles.                              */
+/* num_chunks_x - The number of chunks across the map.                        */
+/* num_chunks_y - The number of chunks down the map.                          */
+/* units - Where each unit starts.                                            */
+/* num_units - The number of entries in units. This may be fewer than were    */
+/*             asked for if there was not room for them all.                  */
+/* row_records - The records of the chunks of one row of chunks, generated    */
+/*               together when the map is written.                            */
+/* row_chunk_y - The y position in chunks of the row in row_records, or -1.   */
+/******************************************************************************/
+typedef struct dt_map_generator
+{
+  Uint32 seed;
+  Uint32 field_seeds[DT_MAPGEN_NUM_FIELDS];
+  int num_tiles_x;
+  int num_tiles_y;
+  int num_chunks_x;
+  int num_chunks_y;
+  DT_MAP_UNIT_PLACEMENT *units;
+  int num_units;
+  struct dt_map_file_chunk *row_records;
+  int row_chunk_y;
+} DT_MAP_GENERATOR;
+
+/******************************************************************************/
+/* DT_MAP_GENERATOR_JOB:                                                      */
+/*                                                                            */
+/* One chunk of a generated map, generated on the master worker pool.         */
+/*                                                                            */
+/* generator - The generator of the map.                                      */
+/* chunk_x - The x position of the chunk, in chunks.                          */
+/* chunk_y - The y position of the chunk, in chunks.                          */
+/* record - The record to fill with the chunk.                                */
+/******************************************************************************/
+typedef struct dt_map_generator_job
+{
+  struct dt_map_generator *generator;
+  int chunk_x;
+  int chunk_y;
+  struct dt_map_file_chunk *record;
+} DT_MAP_GENERATOR_JOB;
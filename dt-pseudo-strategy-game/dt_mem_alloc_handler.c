@@ -37,6 +37,38 @@ void *dt_malloc(size_t size)
   return(temp_object);
 }
 
+/******************************************************************************/
+/* Function: dt_calloc                                                        */
+/*                                                                            */
+/* Purpose: Allocate zeroed memory and exit gracefully if not enough memory   */
+/*          found.                                                            */
+/*                                                                            */
+/* Returns: A void pointer to the allocated memory.                           */
+/*                                                                            */
+/* Parameters: count - The number of objects to be allocated.                 */
+/*             size - The size in bytes of each object.                       */
+/*                                                                            */
+/* Operation: As dt_malloc. Large zeroed blocks come straight from the system */
+/*            which does not commit the pages until they are first touched.   */
+/******************************************************************************/
+void *dt_calloc(size_t count, size_t size)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  void *temp_object;
+  char err_log_message[DT_MAX_ERR_LOG_SIZE];
+
+  temp_object = calloc(count, size);
+  if (temp_object == NULL)
+  {
+    strncpy(err_log_message, DT_OUT_OF_MEM_ERR, DT_MAX_ERR_LOG_SIZE);
+    dt_graceful_exit(err_log_message);
+  }
+
+  return(temp_object);
+}
+
 void dt_free(void *object)
 {
   free(object);
@@ -0,0 +1,363 @@
+/******************************************************************************/
+/* File: dt_movement_range.c                                                  */
+/*                                                                            */
+/* Purpose: Movement ranges. When a unit is selected every point it can reach */
+/*          this turn is found by one search outwards from it, which stops    */
+/*          as soon as the paths left cost more than the unit can spend.      */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_movement_range                                         */
+/*                                                                            */
+/* Purpose: Create an empty movement range.                                   */
+/*                                                                            */
+/* Returns: A pointer to the movement range.                                  */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Allocate the range. Its arrays are allocated by the first       */
+/*            search which needs them.                                        */
+/******************************************************************************/
+DT_MOVEMENT_RANGE *dt_create_movement_range()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_MOVEMENT_RANGE *range;
+
+  range = (DT_MOVEMENT_RANGE *) dt_malloc(sizeof(DT_MOVEMENT_RANGE));
+  range->reachable = NULL;
+  range->costs = NULL;
+  range->next = NULL;
+  range->previous = NULL;
+  range->buckets = NULL;
+  range->point_capacity = 0;
+  range->word_capacity = 0;
+  range->bucket_capacity = 0;
+  dt_clear_movement_range(range);
+
+  return(range);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_movement_range                                        */
+/*                                                                            */
+/* Purpose: Free the memory of a movement range.                              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     range - The movement range to free.                     */
+/*                                                                            */
+/* Operation: Free the arrays and then the range.                             */
+/******************************************************************************/
+void dt_destroy_movement_range(DT_MOVEMENT_RANGE *range)
+{
+  dt_free(range->reachable);
+  dt_free(range->costs);
+  dt_free(range->next);
+  dt_free(range->previous);
+  dt_free(range->buckets);
+  dt_free(range);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_clear_movement_range                                          */
+/*                                                                            */
+/* Purpose: Empty a movement range, as when no unit is selected.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT range - The movement range.                             */
+/*                                                                            */
+/* Operation: An empty window holds no points. The arrays are kept for the    */
+/*            next search.                                                    */
+/******************************************************************************/
+void dt_clear_movement_range(DT_MOVEMENT_RANGE *range)
+{
+  range->origin_x = 0;
+  range->origin_y = 0;
+  range->budget = 0;
+  range->first_x = 0;
+  range->first_y = 0;
+  range->width = 0;
+  range->height = 0;
+  range->words_per_row = 0;
+  range->num_points = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_reserve_movement_range                                        */
+/*                                                                            */
+/* Purpose: Make sure the arrays of a movement range are big enough for a     */
+/*          search.                                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT range - The movement range.                             */
+/*             IN     num_points - The number of points in the window.        */
+/*             IN     num_words - The number of words in the bitmap.          */
+/*             IN     num_buckets - The number of costs the search can find.  */
+/*                                                                            */
+/* Operation: Each search sets every entry it uses, so an array which is too  */
+/*            small is replaced rather than copied.                           */
+/******************************************************************************/
+void dt_reserve_movement_range(DT_MOVEMENT_RANGE *range,
+                               size_t num_points,
+                               size_t num_words,
+                               size_t num_buckets)
+{
+  if (num_points > range->point_capacity)
+  {
+    dt_free(range->costs);
+    dt_free(range->next);
+    dt_free(range->previous);
+    range->costs = (Uint32 *) dt_malloc(sizeof(Uint32) * num_points);
+    range->next = (Uint32 *) dt_malloc(sizeof(Uint32) * num_points);
+    range->previous = (Uint32 *) dt_malloc(sizeof(Uint32) * num_points);
+    range->point_capacity = num_points;
+  }
+
+  if (num_words > range->word_capacity)
+  {
+    dt_free(range->reachable);
+    range->reachable = (Uint32 *) dt_malloc(sizeof(Uint32) * num_words);
+    range->word_capacity = num_words;
+  }
+
+  if (num_buckets > range->bucket_capacity)
+  {
+    dt_free(range->buckets);
+    range->buckets = (Uint32 *) dt_malloc(sizeof(Uint32) * num_buckets);
+    range->bucket_capacity = num_buckets;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_find_movement_range                                           */
+/*                                                                            */
+/* Purpose: Find every point a unit can reach this turn.                      */
+/*                                                                            */
+/* Returns: DT_PATH_FOUND if the range was found.                             */
+/*          DT_PATH_BAD_POINT if the unit is off the grid. The range is left  */
+/*          empty.                                                            */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid, whose cost field for the unit is built */
+/*                           if it does not have one.                         */
+/*             IN     unit - The unit. Its max_movement_distance is what it   */
+/*                           can spend, counted as for one straight step onto */
+/*                           a point costing 1 to enter.                      */
+/*             IN     grid_x - The x coordinate the unit is at.               */
+/*             IN     grid_y - The y coordinate the unit is at.               */
+/*             IN/OUT range - Set to the range found.                         */
+/*                                                                            */
+/* Operation: The budget is max_movement_distance straight steps of cost 1,   */
+/*            the distance being cut down to DT_MOVEMENT_MAX_DISTANCE.        */
+/*            Every step costs at least the unit's minimum move cost, so no   */
+/*            point further than the budget over that cost in any direction   */
+/*            can be reached and only that window of the grid is searched.    */
+/*            The search is Dijkstra's with a bucket for each cost up to the  */
+/*            budget. Buckets are taken in order of cost and each is a list   */
+/*            linked both ways, so a point whose cost is lowered moves to its */
+/*            new bucket in constant time. Paths costing more than the budget */
+/*            are never queued, so the search ends with the last bucket.      */
+/*            The point the unit stands on is always in range, even if it     */
+/*            could not be entered.                                           */
+/******************************************************************************/
+int dt_find_movement_range(DT_GRID *grid,
+                           DT_UNIT *unit,
+                           int grid_x,
+                           int grid_y,
+                           DT_MOVEMENT_RANGE *range)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code = DT_PATH_FOUND;
+  DT_COST_FIELD *field;
+  int distance;
+  int radius;
+  int last_x;
+  int last_y;
+  size_t num_points;
+  size_t num_words;
+  size_t point;
+  Uint32 bucket;
+  Uint32 current;
+  Uint32 neighbour;
+  Uint32 cost;
+  Uint32 step_cost;
+  Uint32 next;
+  int x;
+  int y;
+  int next_x;
+  int next_y;
+  int direction;
+  long field_index;
+
+  dt_clear_movement_range(range);
+
+  if ((grid_x < 0) || (grid_y < 0) ||
+      (grid_x >= grid->num_tiles_x) || (grid_y >= grid->num_tiles_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    goto EXIT_LABEL;
+  }
+
+  field = dt_get_grid_cost_field(grid, unit);
+
+  /****************************************************************************/
+  /* Size the window to the furthest the unit could get on the cheapest       */
+  /* terrain, clipped to the grid.                                            */
+  /****************************************************************************/
+  distance = CLAMP(unit->max_movement_distance, 0, DT_MOVEMENT_MAX_DISTANCE);
+  radius = distance / dt_get_min_move_cost(unit);
+  range->origin_x = grid_x;
+  range->origin_y = grid_y;
+  range->budget = (Uint32) distance * DT_PATH_STRAIGHT_STEP;
+  range->first_x = MAX(grid_x - radius, 0);
+  range->first_y = MAX(grid_y - radius, 0);
+  last_x = MIN(grid_x + radius, grid->num_tiles_x - 1);
+  last_y = MIN(grid_y + radius, grid->num_tiles_y - 1);
+  range->width = last_x - range->first_x + 1;
+  range->height = last_y - range->first_y + 1;
+  range->words_per_row = (range->width + DT_MOVEMENT_WORD_BITS - 1) /
+                                                         DT_MOVEMENT_WORD_BITS;
+
+  num_points = (size_t) range->width * (size_t) range->height;
+  num_words = (size_t) range->words_per_row * (size_t) range->height;
+  dt_reserve_movement_range(range,
+                            num_points,
+                            num_words,
+                            (size_t) range->budget + 1);
+
+  for (point = 0; point < num_points; point++)
+  {
+    range->costs[point] = DT_MOVEMENT_NO_COST;
+  }
+  memset(range->reachable, 0, sizeof(Uint32) * num_words);
+  for (bucket = 0; bucket <= range->budget; bucket++)
+  {
+    range->buckets[bucket] = DT_MOVEMENT_NO_POINT;
+  }
+
+  /****************************************************************************/
+  /* Queue the point the unit is on with no cost.                             */
+  /****************************************************************************/
+  current = (Uint32) (((grid_y - range->first_y) * range->width) +
+                      (grid_x - range->first_x));
+  range->costs[current] = 0;
+  range->next[current] = DT_MOVEMENT_NO_POINT;
+  range->previous[current] = DT_MOVEMENT_NO_POINT;
+  range->buckets[0] = current;
+
+  /****************************************************************************/
+  /* Take the points from the buckets cheapest first. When a point is taken   */
+  /* its cost is final, so it is in range.                                    */
+  /****************************************************************************/
+  for (bucket = 0; bucket <= range->budget; bucket++)
+  {
+    while (DT_MOVEMENT_NO_POINT != range->buckets[bucket])
+    {
+      current = range->buckets[bucket];
+      range->buckets[bucket] = range->next[current];
+      if (DT_MOVEMENT_NO_POINT != range->next[current])
+      {
+        range->previous[range->next[current]] = DT_MOVEMENT_NO_POINT;
+      }
+
+      x = (int) (current % (Uint32) range->width);
+      y = (int) (current / (Uint32) range->width);
+      range->reachable[(y * range->words_per_row) +
+                       (x / DT_MOVEMENT_WORD_BITS)] |=
+                                   (Uint32) 1 << (x % DT_MOVEMENT_WORD_BITS);
+      range->num_points++;
+
+      field_index = dt_get_cost_field_index(field,
+                                            range->first_x + x,
+                                            range->first_y + y);
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        next_x = x + dt_get_orientation_step_x(direction);
+        next_y = y + dt_get_orientation_step_y(direction);
+        if ((next_x < 0) || (next_y < 0) ||
+            (next_x >= range->width) || (next_y >= range->height))
+        {
+          continue;
+        }
+
+        step_cost = dt_get_cost_field_step_cost(field, field_index, direction);
+        if (0 == step_cost)
+        {
+          continue;
+        }
+
+        cost = bucket + step_cost;
+        neighbour = (Uint32) ((next_y * range->width) + next_x);
+        if ((cost > range->budget) || (cost >= range->costs[neighbour]))
+        {
+          continue;
+        }
+
+        /**********************************************************************/
+        /* Take the point out of the bucket it is waiting in, if any, and     */
+        /* put it at the front of the bucket for its new cost.                */
+        /**********************************************************************/
+        if (DT_MOVEMENT_NO_COST != range->costs[neighbour])
+        {
+          next = range->next[neighbour];
+          if (DT_MOVEMENT_NO_POINT != range->previous[neighbour])
+          {
+            range->next[range->previous[neighbour]] = next;
+          }
+          else
+          {
+            range->buckets[range->costs[neighbour]] = next;
+          }
+          if (DT_MOVEMENT_NO_POINT != next)
+          {
+            range->previous[next] = range->previous[neighbour];
+          }
+        }
+
+        range->costs[neighbour] = cost;
+        range->previous[neighbour] = DT_MOVEMENT_NO_POINT;
+        range->next[neighbour] = range->buckets[cost];
+        if (DT_MOVEMENT_NO_POINT != range->buckets[cost])
+        {
+          range->previous[range->buckets[cost]] = neighbour;
+        }
+        range->buckets[cost] = neighbour;
+      }
+    }
+  }
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_get_movement_range_memory_usage                               */
+/*                                                                            */
+/* Purpose: Find how much memory a movement range is using.                   */
+/*                                                                            */
+/* Returns: The number of bytes.                                              */
+/*                                                                            */
+/* Parameters: IN     range - The movement range.                             */
+/*                                                                            */
+/* Operation: Add the range to the capacity of its arrays.                    */
+/******************************************************************************/
+size_t dt_get_movement_range_memory_usage(DT_MOVEMENT_RANGE *range)
+{
+  return(sizeof(DT_MOVEMENT_RANGE) +
+         (sizeof(Uint32) * range->point_capacity * 3) +
+         (sizeof(Uint32) * range->word_capacity) +
+         (sizeof(Uint32) * range->bucket_capacity));
+}
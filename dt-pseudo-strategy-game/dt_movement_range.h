@@ -0,0 +1,148 @@
+/******************************************************************************/
+/* File: dt_movement_range.h                                                  */
+/*                                                                            */
+/* Purpose: Definitions for movement ranges, the points a unit can reach this */
+/*          turn without spending more than its max_movement_distance.        */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of movement ranges.                                             */
+/*                                                                            */
+/* DT_MOVEMENT_NO_COST - The cost of a point of the window which is not in    */
+/*                       the range.                                           */
+/* DT_MOVEMENT_NO_POINT - Ends a bucket of the queue, or the list of points   */
+/*                        in it.                                              */
+/* DT_MOVEMENT_WORD_BITS - The number of points held by each word of the      */
+/*                         reachable bitmap.                                  */
+/* DT_MOVEMENT_MAX_DISTANCE - The most max_movement_distance a range is found */
+/*                            for. Greater distances are cut down to it, so   */
+/*                            the budget cannot overflow and the buckets stay */
+/*                            a sensible size.                                */
+/******************************************************************************/
+#define DT_MOVEMENT_NO_COST 0xFFFFFFFFu
+#define DT_MOVEMENT_NO_POINT 0xFFFFFFFFu
+#define DT_MOVEMENT_WORD_BITS 32
+#define DT_MOVEMENT_MAX_DISTANCE 1024
+
+/******************************************************************************/
+/* DT_MOVEMENT_RANGE:                                                         */
+/*                                                                            */
+/* The points a unit can reach from where it stands, found by a search of its */
+/* cost field which stops at its budget. Only a window of the grid around the */
+/* unit can be reached within the budget, so only that window is stored and   */
+/* searched. The range is kept between searches so that its memory is reused. */
+/*                                                                            */
+/* origin_x - The x coordinate the range was found from.                      */
+/* origin_y - The y coordinate the range was found from.                      */
+/* budget - The most a path may cost to be in the range, in the units of      */
+/*          DT_PATH_STRAIGHT_STEP.                                            */
+/* first_x - The x coordinate of the left column of the window.               */
+/* first_y - The y coordinate of the top row of the window.                   */
+/* width - The number of columns in the window, 0 when the range is empty.    */
+/* height - The number of rows in the window, 0 when the range is empty.      */
+/* words_per_row - The number of words of reachable for each row.             */
+/* reachable - A bit for every point of the window, set if it is in range.    */
+/* costs - The cost of the cheapest path to each point of the window, row by  */
+/*         row, or DT_MOVEMENT_NO_COST if it is out of range.                 */
+/* next - The next point in the same bucket as each point of the window.      */
+/* previous - The previous point in the same bucket as each point, or         */
+/*            DT_MOVEMENT_NO_POINT if it is the first.                        */
+/* buckets - The first point of the window waiting with each cost from 0 to   */
+/*           budget. The costs are small integers, so each cost has its own   */
+/*           bucket rather than a place in a heap.                            */
+/* num_points - The number of points in the range.                            */
+/* point_capacity - The number of points the window arrays have room for.     */
+/* word_capacity - The number of words reachable has room for.                */
+/* bucket_capacity - The number of entries buckets has room for.              */
+/******************************************************************************/
+typedef struct dt_movement_range
+{
+  int origin_x;
+  int origin_y;
+  Uint32 budget;
+  int first_x;
+  int first_y;
+  int width;
+  int height;
+  int words_per_row;
+  Uint32 *reachable;
+  Uint32 *costs;
+  Uint32 *next;
+  Uint32 *previous;
+  Uint32 *buckets;
+  long num_points;
+  size_t point_capacity;
+  size_t word_capacity;
+  size_t bucket_capacity;
+} DT_MOVEMENT_RANGE;
+
+/******************************************************************************/
+/* Function: dt_is_in_movement_range                                          */
+/*                                                                            */
+/* Purpose: Find whether a point of the grid is in a movement range.          */
+/*                                                                            */
+/* Returns: TRUE if the unit can reach the point this turn, FALSE otherwise.  */
+/*                                                                            */
+/* Parameters: IN     range - The movement range.                             */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Points outside the window are out of range. Otherwise read the  */
+/*            bit for the point.                                              */
+/******************************************************************************/
+static inline bool dt_is_in_movement_range(DT_MOVEMENT_RANGE *range,
+                                           int grid_x,
+                                           int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int x;
+  int y;
+
+  x = grid_x - range->first_x;
+  y = grid_y - range->first_y;
+  if ((x < 0) || (y < 0) || (x >= range->width) || (y >= range->height))
+  {
+    return(false);
+  }
+
+  return(0 != (range->reachable[((long) y * (long) range->words_per_row) +
+                                (long) (x / DT_MOVEMENT_WORD_BITS)] &
+               ((Uint32) 1 << (x % DT_MOVEMENT_WORD_BITS))));
+}
+
+/******************************************************************************/
+/* Function: dt_get_movement_range_cost                                       */
+/*                                                                            */
+/* Purpose: Find what it costs a unit to reach a point of its movement range. */
+/*                                                                            */
+/* Returns: The cost, in the units of DT_PATH_STRAIGHT_STEP, or               */
+/*          DT_MOVEMENT_NO_COST if the point is out of range.                 */
+/*                                                                            */
+/* Parameters: IN     range - The movement range.                             */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Points outside the window are out of range. Otherwise read the  */
+/*            cost stored for the point.                                      */
+/******************************************************************************/
+static inline Uint32 dt_get_movement_range_cost(DT_MOVEMENT_RANGE *range,
+                                                int grid_x,
+                                                int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int x;
+  int y;
+
+  x = grid_x - range->first_x;
+  y = grid_y - range->first_y;
+  if ((x < 0) || (y < 0) || (x >= range->width) || (y >= range->height))
+  {
+    return(DT_MOVEMENT_NO_COST);
+  }
+
+  return(range->costs[((long) y * (long) range->width) + (long) x]);
+}
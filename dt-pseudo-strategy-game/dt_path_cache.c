@@ -0,0 +1,710 @@
+/******************************************************************************/
+/* File: dt_path_cache.c                                                      */
+/*                                                                            */
+/* Purpose: The path cache. AI players ask for the same routes turn after     */
+/*          turn, so the paths found are kept, looked up by what they were    */
+/*          found for, and dropped only when the grid they cross changes.     */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_path_cache                                             */
+/*                                                                            */
+/* Purpose: Create an empty path cache for a grid.                            */
+/*                                                                            */
+/* Returns: A pointer to the path cache.                                      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid the paths will be found over.           */
+/*                                                                            */
+/* Operation: Put every entry on the free list and empty the hash chains.     */
+/******************************************************************************/
+DT_PATH_CACHE *dt_create_path_cache(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CACHE *cache;
+  int ii;
+
+  cache = (DT_PATH_CACHE *) dt_malloc(sizeof(DT_PATH_CACHE));
+  cache->num_regions_x = (grid->num_tiles_x +
+                          (1 << DT_PATH_CACHE_REGION_SHIFT) - 1) >>
+                                                    DT_PATH_CACHE_REGION_SHIFT;
+  for (ii = 0; ii < DT_PATH_CACHE_MAX_ENTRIES; ii++)
+  {
+    cache->entries[ii].path = NULL;
+    cache->entries[ii].regions = NULL;
+    cache->entries[ii].next_in_bucket = ii + 1;
+  }
+  cache->entries[DT_PATH_CACHE_MAX_ENTRIES - 1].next_in_bucket =
+                                                        DT_PATH_CACHE_NO_ENTRY;
+  for (ii = 0; ii < DT_PATH_CACHE_NUM_BUCKETS; ii++)
+  {
+    cache->buckets[ii] = DT_PATH_CACHE_NO_ENTRY;
+  }
+  cache->newest = DT_PATH_CACHE_NO_ENTRY;
+  cache->oldest = DT_PATH_CACHE_NO_ENTRY;
+  cache->free_entries = 0;
+  cache->num_entries = 0;
+  cache->hits = 0;
+  cache->misses = 0;
+  cache->invalidations = 0;
+  cache->evictions = 0;
+
+  return(cache);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path_cache                                            */
+/*                                                                            */
+/* Purpose: Free a path cache and every path it holds.                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     cache - The path cache to free.                         */
+/*                                                                            */
+/* Operation: Free the paths and regions of the used entries, then the cache. */
+/******************************************************************************/
+void dt_destroy_path_cache(DT_PATH_CACHE *cache)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < DT_PATH_CACHE_MAX_ENTRIES; ii++)
+  {
+    if (NULL != cache->entries[ii].path)
+    {
+      dt_destroy_path(cache->entries[ii].path);
+      dt_free(cache->entries[ii].regions);
+    }
+  }
+  dt_free(cache);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_path_cache                                           */
+/*                                                                            */
+/* Purpose: Find the path cache of a grid, creating it the first time.        */
+/*                                                                            */
+/* Returns: A pointer to the path cache, which is owned by the grid.          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*                                                                            */
+/* Operation: Grids which never use the cache never allocate it. Like         */
+/*            dt_get_grid_cost_field this writes to the grid and must not be  */
+/*            called from several threads at once.                            */
+/******************************************************************************/
+DT_PATH_CACHE *dt_get_grid_path_cache(DT_GRID *grid)
+{
+  if (NULL == grid->path_cache)
+  {
+    grid->path_cache = dt_create_path_cache(grid);
+  }
+
+  return(grid->path_cache);
+}
+
+/******************************************************************************/
+/* Function: dt_find_cached_path                                              */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a unit between two points, using the   */
+/*          path found before if the same path has been asked for.            */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid, used if the     */
+/*                             path is not in the cache.                      */
+/*             IN     unit - The unit which is to move.                       */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: As dt_find_path, through the path cache of the grid.            */
+/******************************************************************************/
+int dt_find_cached_path(DT_PATH_SEARCH *search,
+                        DT_UNIT *unit,
+                        int start_x,
+                        int start_y,
+                        int goal_x,
+                        int goal_y,
+                        DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CACHE_KEY key;
+
+  key.start_x = start_x;
+  key.start_y = start_y;
+  key.goal_x = goal_x;
+  key.goal_y = goal_y;
+  key.unit_class = unit->unit_class;
+  key.speed = unit->speed;
+  key.orientation = DT_PATH_CACHE_ANY_ORIENTATION;
+  key.turn_cost = 0;
+
+  return(dt_find_path_through_cache(search, unit, &key, path));
+}
+
+/******************************************************************************/
+/* Function: dt_find_cached_oriented_path                                     */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a unit between two points, counting    */
+/*          the cost of turning, using the path found before if the same path */
+/*          has been asked for.                                               */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT search - The oriented search state for the grid, used   */
+/*                             if the path is not in the cache.               */
+/*             IN     unit - The unit which is to move. It starts facing its  */
+/*                           orientation.                                     */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             IN     turn_cost - The cost of each eighth of a turn.          */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: As dt_find_oriented_path, through the path cache of the grid.   */
+/*            The orientation and turn cost are part of the key.              */
+/******************************************************************************/
+int dt_find_cached_oriented_path(DT_PATH_SEARCH *search,
+                                 DT_UNIT *unit,
+                                 int start_x,
+                                 int start_y,
+                                 int goal_x,
+                                 int goal_y,
+                                 int turn_cost,
+                                 DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CACHE_KEY key;
+
+  key.start_x = start_x;
+  key.start_y = start_y;
+  key.goal_x = goal_x;
+  key.goal_y = goal_y;
+  key.unit_class = unit->unit_class;
+  key.speed = unit->speed;
+  key.orientation = unit->orientation;
+  key.turn_cost = turn_cost;
+
+  return(dt_find_path_through_cache(search, unit, &key, path));
+}
+
+/******************************************************************************/
+/* Function: dt_find_path_through_cache                                       */
+/*                                                                            */
+/* Purpose: Answer a request for a path from the path cache, or search for    */
+/*          the path and keep it.                                             */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid.                 */
+/*             IN     unit - The unit which is to move.                       */
+/*             IN     key - What the path is for. Its orientation is          */
+/*                          DT_PATH_CACHE_ANY_ORIENTATION for a search which  */
+/*                          does not count turns.                             */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: On a hit the entry becomes the most recently used and the       */
+/*            caller is given a copy of its path, so the caller owns the path */
+/*            whether or not it came from the cache. A path which does not    */
+/*            count turns may have been kept for a unit facing another way,   */
+/*            so its start is given the caller's orientation, as a search     */
+/*            would give it. On a miss search and, if a path was found, keep  */
+/*            a copy of it.                                                   */
+/******************************************************************************/
+int dt_find_path_through_cache(DT_PATH_SEARCH *search,
+                               DT_UNIT *unit,
+                               DT_PATH_CACHE_KEY *key,
+                               DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code;
+  DT_PATH_CACHE *cache;
+  int entry;
+
+  cache = dt_get_grid_path_cache(search->grid);
+  entry = dt_find_path_cache_entry(cache, key);
+  if (DT_PATH_CACHE_NO_ENTRY != entry)
+  {
+    (cache->hits)++;
+    dt_unlink_path_cache_entry(cache, entry);
+    dt_link_path_cache_entry(cache, entry);
+    *path = dt_copy_path(cache->entries[entry].path);
+    if ((DT_PATH_CACHE_ANY_ORIENTATION == key->orientation) &&
+        (0 < (*path)->num_points))
+    {
+      (*path)->points[0].orientation = unit->orientation;
+    }
+    ret_code = DT_PATH_FOUND;
+    goto EXIT_LABEL;
+  }
+
+  (cache->misses)++;
+  if (DT_PATH_CACHE_ANY_ORIENTATION == key->orientation)
+  {
+    ret_code = dt_find_path(search,
+                            unit,
+                            key->start_x,
+                            key->start_y,
+                            key->goal_x,
+                            key->goal_y,
+                            path);
+  }
+  else
+  {
+    ret_code = dt_find_oriented_path(search,
+                                     unit,
+                                     key->start_x,
+                                     key->start_y,
+                                     key->goal_x,
+                                     key->goal_y,
+                                     key->turn_cost,
+                                     path);
+  }
+  if (DT_PATH_FOUND == ret_code)
+  {
+    dt_add_path_to_cache(cache, key, *path);
+  }
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_hash_path_cache_key                                           */
+/*                                                                            */
+/* Purpose: Find the hash chain a key belongs in.                             */
+/*                                                                            */
+/* Returns: The index of the chain.                                           */
+/*                                                                            */
+/* Parameters: IN     key - The key.                                          */
+/*                                                                            */
+/* Operation: Mix each field in with a multiply by the golden ratio and take  */
+/*            the top bits, which depend on every field.                      */
+/******************************************************************************/
+int dt_hash_path_cache_key(DT_PATH_CACHE_KEY *key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 hash = 0;
+
+  hash = (hash ^ (Uint32) key->start_x) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->start_y) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->goal_x) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->goal_y) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->unit_class) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->speed) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->orientation) * 0x9E3779B1u;
+  hash = (hash ^ (Uint32) key->turn_cost) * 0x9E3779B1u;
+
+  return((int) ((hash >> 16) & (DT_PATH_CACHE_NUM_BUCKETS - 1)));
+}
+
+/******************************************************************************/
+/* Function: dt_path_cache_keys_match                                         */
+/*                                                                            */
+/* Purpose: Find whether two keys are for the same path.                      */
+/*                                                                            */
+/* Returns: TRUE if every field matches, FALSE otherwise.                     */
+/*                                                                            */
+/* Parameters: IN     key - One key.                                          */
+/*             IN     other_key - The other key.                              */
+/*                                                                            */
+/* Operation: Compare the fields in turn.                                     */
+/******************************************************************************/
+bool dt_path_cache_keys_match(DT_PATH_CACHE_KEY *key,
+                              DT_PATH_CACHE_KEY *other_key)
+{
+  return((key->start_x == other_key->start_x) &&
+         (key->start_y == other_key->start_y) &&
+         (key->goal_x == other_key->goal_x) &&
+         (key->goal_y == other_key->goal_y) &&
+         (key->unit_class == other_key->unit_class) &&
+         (key->speed == other_key->speed) &&
+         (key->orientation == other_key->orientation) &&
+         (key->turn_cost == other_key->turn_cost));
+}
+
+/******************************************************************************/
+/* Function: dt_find_path_cache_entry                                         */
+/*                                                                            */
+/* Purpose: Find the entry of a path cache holding the path for a key.        */
+/*                                                                            */
+/* Returns: The index of the entry, or DT_PATH_CACHE_NO_ENTRY if the cache    */
+/*          does not hold the path.                                           */
+/*                                                                            */
+/* Parameters: IN     cache - The path cache.                                 */
+/*             IN     key - The key.                                          */
+/*                                                                            */
+/* Operation: Walk the hash chain of the key.                                 */
+/******************************************************************************/
+int dt_find_path_cache_entry(DT_PATH_CACHE *cache, DT_PATH_CACHE_KEY *key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int entry;
+
+  entry = cache->buckets[dt_hash_path_cache_key(key)];
+  while ((DT_PATH_CACHE_NO_ENTRY != entry) &&
+         !dt_path_cache_keys_match(&(cache->entries[entry].key), key))
+  {
+    entry = cache->entries[entry].next_in_bucket;
+  }
+
+  return(entry);
+}
+
+/******************************************************************************/
+/* Function: dt_link_path_cache_entry                                         */
+/*                                                                            */
+/* Purpose: Make an entry the most recently used.                             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT cache - The path cache.                                 */
+/*             IN     entry - The index of an entry not in the list of uses.  */
+/*                                                                            */
+/* Operation: Add the entry to the newest end of the list.                    */
+/******************************************************************************/
+void dt_link_path_cache_entry(DT_PATH_CACHE *cache, int entry)
+{
+  cache->entries[entry].newer = DT_PATH_CACHE_NO_ENTRY;
+  cache->entries[entry].older = cache->newest;
+  if (DT_PATH_CACHE_NO_ENTRY != cache->newest)
+  {
+    cache->entries[cache->newest].newer = entry;
+  }
+  else
+  {
+    cache->oldest = entry;
+  }
+  cache->newest = entry;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_unlink_path_cache_entry                                       */
+/*                                                                            */
+/* Purpose: Take an entry out of the list of uses.                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT cache - The path cache.                                 */
+/*             IN     entry - The index of an entry in the list of uses.      */
+/*                                                                            */
+/* Operation: Join the entries either side of it.                             */
+/******************************************************************************/
+void dt_unlink_path_cache_entry(DT_PATH_CACHE *cache, int entry)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int newer;
+  int older;
+
+  newer = cache->entries[entry].newer;
+  older = cache->entries[entry].older;
+  if (DT_PATH_CACHE_NO_ENTRY != newer)
+  {
+    cache->entries[newer].older = older;
+  }
+  else
+  {
+    cache->newest = older;
+  }
+  if (DT_PATH_CACHE_NO_ENTRY != older)
+  {
+    cache->entries[older].newer = newer;
+  }
+  else
+  {
+    cache->oldest = newer;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_add_path_to_cache                                             */
+/*                                                                            */
+/* Purpose: Keep a copy of a path in a path cache.                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT cache - The path cache. It must not hold a path for the */
+/*                            key already.                                    */
+/*             IN     key - What the path was found for.                      */
+/*             IN     path - The path, which is copied.                       */
+/*                                                                            */
+/* Operation: If the cache is full drop the least recently used path. Record  */
+/*            the regions the path crosses, counting them first so the list   */
+/*            is allocated at its size. A region is listed each time the path */
+/*            enters it.                                                      */
+/******************************************************************************/
+void dt_add_path_to_cache(DT_PATH_CACHE *cache,
+                          DT_PATH_CACHE_KEY *key,
+                          DT_PATH *path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CACHE_ENTRY *entry;
+  int index;
+  int bucket;
+  Uint32 region;
+  Uint32 last_region;
+  int ii;
+
+  if (DT_PATH_CACHE_NO_ENTRY == cache->free_entries)
+  {
+    dt_remove_path_cache_entry(cache, cache->oldest);
+    (cache->evictions)++;
+  }
+  index = cache->free_entries;
+  entry = &(cache->entries[index]);
+  cache->free_entries = entry->next_in_bucket;
+
+  entry->key = *key;
+  entry->path = dt_copy_path(path);
+
+  /****************************************************************************/
+  /* Record the regions the path crosses.                                     */
+  /****************************************************************************/
+  entry->num_regions = 0;
+  last_region = (Uint32) DT_PATH_CACHE_NO_ENTRY;
+  for (ii = 0; ii < path->num_points; ii++)
+  {
+    region = dt_get_path_cache_region(cache,
+                                      path->points[ii].grid_x,
+                                      path->points[ii].grid_y);
+    if (region != last_region)
+    {
+      (entry->num_regions)++;
+      last_region = region;
+    }
+  }
+  entry->regions = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                        (size_t) entry->num_regions);
+  entry->num_regions = 0;
+  last_region = (Uint32) DT_PATH_CACHE_NO_ENTRY;
+  for (ii = 0; ii < path->num_points; ii++)
+  {
+    region = dt_get_path_cache_region(cache,
+                                      path->points[ii].grid_x,
+                                      path->points[ii].grid_y);
+    if (region != last_region)
+    {
+      entry->regions[entry->num_regions] = region;
+      (entry->num_regions)++;
+      last_region = region;
+    }
+  }
+
+  bucket = dt_hash_path_cache_key(key);
+  entry->next_in_bucket = cache->buckets[bucket];
+  cache->buckets[bucket] = index;
+  dt_link_path_cache_entry(cache, index);
+  (cache->num_entries)++;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_cache_region                                         */
+/*                                                                            */
+/* Purpose: Find the region of a path cache holding a point.                  */
+/*                                                                            */
+/* Returns: The index of the region, numbered row by row.                     */
+/*                                                                            */
+/* Parameters: IN     cache - The path cache.                                 */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Shift the coordinates down to those of the region.              */
+/******************************************************************************/
+Uint32 dt_get_path_cache_region(DT_PATH_CACHE *cache, int grid_x, int grid_y)
+{
+  return(((Uint32) (grid_y >> DT_PATH_CACHE_REGION_SHIFT) *
+                                           (Uint32) cache->num_regions_x) +
+         (Uint32) (grid_x >> DT_PATH_CACHE_REGION_SHIFT));
+}
+
+/******************************************************************************/
+/* Function: dt_remove_path_cache_entry                                       */
+/*                                                                            */
+/* Purpose: Drop a path from a path cache.                                    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT cache - The path cache.                                 */
+/*             IN     index - The index of the entry holding the path.        */
+/*                                                                            */
+/* Operation: Take the entry out of its hash chain and the list of uses, free */
+/*            its path and put it on the free list.                           */
+/******************************************************************************/
+void dt_remove_path_cache_entry(DT_PATH_CACHE *cache, int index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CACHE_ENTRY *entry;
+  int *link;
+
+  entry = &(cache->entries[index]);
+  link = &(cache->buckets[dt_hash_path_cache_key(&(entry->key))]);
+  while (*link != index)
+  {
+    link = &(cache->entries[*link].next_in_bucket);
+  }
+  *link = entry->next_in_bucket;
+  dt_unlink_path_cache_entry(cache, index);
+
+  dt_destroy_path(entry->path);
+  dt_free(entry->regions);
+  entry->path = NULL;
+  entry->regions = NULL;
+  entry->next_in_bucket = cache->free_entries;
+  cache->free_entries = index;
+  (cache->num_entries)--;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_invalidate_path_cache                                         */
+/*                                                                            */
+/* Purpose: Drop every path of a path cache which crosses an area of the grid */
+/*          that has changed.                                                 */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT cache - The path cache.                                 */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Find the regions the area covers and check the regions of each  */
+/*            path against them. The caller widens the area by a point on     */
+/*            each side, as a diagonal step depends on the points beside it.  */
+/******************************************************************************/
+void dt_invalidate_path_cache(DT_PATH_CACHE *cache,
+                              int first_x,
+                              int first_y,
+                              int last_x,
+                              int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int first_region_x;
+  int first_region_y;
+  int last_region_x;
+  int last_region_y;
+  int region_x;
+  int region_y;
+  int entry;
+  int older;
+  int ii;
+
+  first_region_x = MAX(first_x, 0) >> DT_PATH_CACHE_REGION_SHIFT;
+  first_region_y = MAX(first_y, 0) >> DT_PATH_CACHE_REGION_SHIFT;
+  last_region_x = MAX(last_x, 0) >> DT_PATH_CACHE_REGION_SHIFT;
+  last_region_y = MAX(last_y, 0) >> DT_PATH_CACHE_REGION_SHIFT;
+
+  entry = cache->newest;
+  while (DT_PATH_CACHE_NO_ENTRY != entry)
+  {
+    older = cache->entries[entry].older;
+    for (ii = 0; ii < cache->entries[entry].num_regions; ii++)
+    {
+      region_x = (int) (cache->entries[entry].regions[ii] %
+                                              (Uint32) cache->num_regions_x);
+      region_y = (int) (cache->entries[entry].regions[ii] /
+                                              (Uint32) cache->num_regions_x);
+      if ((region_x >= first_region_x) && (region_x <= last_region_x) &&
+          (region_y >= first_region_y) && (region_y <= last_region_y))
+      {
+        dt_remove_path_cache_entry(cache, entry);
+        (cache->invalidations)++;
+        break;
+      }
+    }
+    entry = older;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_cache_hit_rate                                       */
+/*                                                                            */
+/* Purpose: Report how often requests have been answered by a path cache.     */
+/*                                                                            */
+/* Returns: The fraction of requests which were hits, 0 if there have been    */
+/*          none.                                                             */
+/*                                                                            */
+/* Parameters: IN     cache - The path cache.                                 */
+/*                                                                            */
+/* Operation: Divide the hits by the hits and misses.                         */
+/******************************************************************************/
+double dt_get_path_cache_hit_rate(DT_PATH_CACHE *cache)
+{
+  return((0 == cache->hits + cache->misses) ?
+             0.0 :
+             (double) cache->hits / (double) (cache->hits + cache->misses));
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_cache_memory_usage                                   */
+/*                                                                            */
+/* Purpose: Report how much memory a path cache is using.                     */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the cache.                      */
+/*                                                                            */
+/* Parameters: IN     cache - The path cache.                                 */
+/*                                                                            */
+/* Operation: Add the points and regions of every path held to the cache.     */
+/******************************************************************************/
+size_t dt_get_path_cache_memory_usage(DT_PATH_CACHE *cache)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t bytes = sizeof(DT_PATH_CACHE);
+  int ii;
+
+  for (ii = 0; ii < DT_PATH_CACHE_MAX_ENTRIES; ii++)
+  {
+    if (NULL != cache->entries[ii].path)
+    {
+      bytes += sizeof(DT_PATH) +
+               (sizeof(DT_PATH_POINT) *
+                                 (size_t) cache->entries[ii].path->num_points) +
+               (sizeof(Uint32) * (size_t) cache->entries[ii].num_regions);
+    }
+  }
+
+  return(bytes);
+}
@@ -0,0 +1,119 @@
+/******************************************************************************/
+/* File: dt_path_cache.h                                                      */
+/*                                                                            */
+/* Purpose: Definitions for the path cache, which keeps the paths found most  */
+/*          recently so that a unit asking for the same route again is given  */
+/*          it without a search.                                              */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of the path cache.                                              */
+/*                                                                            */
+/* DT_PATH_CACHE_MAX_ENTRIES - The most paths the cache holds. When it is     */
+/*                             full the least recently used path is dropped.  */
+/* DT_PATH_CACHE_NUM_BUCKETS - The number of chains in the hash table of      */
+/*                             keys. A power of two.                          */
+/* DT_PATH_CACHE_NO_ENTRY - Ends a chain or list of entries.                  */
+/* DT_PATH_CACHE_ANY_ORIENTATION - The orientation of the key of a path found */
+/*                                 by a search which does not count turns.    */
+/* DT_PATH_CACHE_REGION_SHIFT - The log2 of the width and height of the       */
+/*                              regions whose crossing paths are recorded.    */
+/*                              These are the chunks of the grid whatever its */
+/*                              storage.                                      */
+/******************************************************************************/
+#define DT_PATH_CACHE_MAX_ENTRIES 256
+#define DT_PATH_CACHE_NUM_BUCKETS 512
+#define DT_PATH_CACHE_NO_ENTRY -1
+#define DT_PATH_CACHE_ANY_ORIENTATION -1
+#define DT_PATH_CACHE_REGION_SHIFT DT_GRID_CHUNK_SHIFT
+
+/******************************************************************************/
+/* DT_PATH_CACHE_KEY:                                                         */
+/*                                                                            */
+/* What a path was found for. Two requests with the same key get the same     */
+/* path.                                                                      */
+/*                                                                            */
+/* start_x - The x coordinate of the start.                                   */
+/* start_y - The y coordinate of the start.                                   */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* unit_class - The class of the unit.                                        */
+/* speed - The speed of the unit.                                             */
+/* orientation - The orientation the unit starts in, or                       */
+/*               DT_PATH_CACHE_ANY_ORIENTATION if turns were not counted.     */
+/* turn_cost - The cost of each eighth of a turn, 0 if turns were not         */
+/*             counted.                                                       */
+/******************************************************************************/
+typedef struct dt_path_cache_key
+{
+  int start_x;
+  int start_y;
+  int goal_x;
+  int goal_y;
+  int unit_class;
+  int speed;
+  int orientation;
+  int turn_cost;
+} DT_PATH_CACHE_KEY;
+
+/******************************************************************************/
+/* DT_PATH_CACHE_ENTRY:                                                       */
+/*                                                                            */
+/* One path held by the cache.                                                */
+/*                                                                            */
+/* key - What the path was found for.                                         */
+/* path - The path.                                                           */
+/* regions - The index of each region the path crosses, numbered row by row.  */
+/*           A path which leaves a region and comes back lists it again.      */
+/* num_regions - The number of entries in regions.                            */
+/* next_in_bucket - The next entry in the same hash chain, or in the list of  */
+/*                  free entries.                                             */
+/* newer - The entry used next after this one.                                */
+/* older - The entry used last before this one.                               */
+/******************************************************************************/
+typedef struct dt_path_cache_entry
+{
+  DT_PATH_CACHE_KEY key;
+  struct dt_path *path;
+  Uint32 *regions;
+  int num_regions;
+  int next_in_bucket;
+  int newer;
+  int older;
+} DT_PATH_CACHE_ENTRY;
+
+/******************************************************************************/
+/* DT_PATH_CACHE:                                                             */
+/*                                                                            */
+/* The paths found most recently over a grid. Each records the regions it     */
+/* crosses, so a change to the grid drops only the paths through it. A change */
+/* elsewhere may open a cheaper route than a path kept, but never makes a     */
+/* path kept impassable. Searches which find no path are not kept, as         */
+/* opening any point next to what they reached could change their answer.     */
+/*                                                                            */
+/* num_regions_x - The number of regions across the grid.                     */
+/* entries - Every entry, used or free.                                       */
+/* buckets - The first entry of each hash chain.                              */
+/* newest - The entry used most recently.                                     */
+/* oldest - The entry used least recently, the next to be dropped.            */
+/* free_entries - The first free entry.                                       */
+/* num_entries - The number of entries holding a path.                        */
+/* hits - The number of requests answered from the cache.                     */
+/* misses - The number of requests which needed a search.                     */
+/* invalidations - The number of paths dropped because the grid changed.      */
+/* evictions - The number of paths dropped to make room for another.          */
+/******************************************************************************/
+typedef struct dt_path_cache
+{
+  int num_regions_x;
+  DT_PATH_CACHE_ENTRY entries[DT_PATH_CACHE_MAX_ENTRIES];
+  int buckets[DT_PATH_CACHE_NUM_BUCKETS];
+  int newest;
+  int oldest;
+  int free_entries;
+  int num_entries;
+  long hits;
+  long misses;
+  long invalidations;
+  long evictions;
+} DT_PATH_CACHE;
@@ -0,0 +1,1594 @@
+/******************************************************************************/
+/* File: dt_path_hierarchy.c                                                  */
+/*                                                                            */
+/* Purpose: Hierarchical path search. The grid is split into clusters and a   */
+/*          path is first found across the graph of the entrances between     */
+/*          them. The grid itself is then only searched from one entrance to  */
+/*          the next, as each part of the path is needed.                     */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_path_hierarchy                                         */
+/*                                                                            */
+/* Purpose: Create the hierarchy of a cost field.                             */
+/*                                                                            */
+/* Returns: A pointer to the new hierarchy.                                   */
+/*                                                                            */
+/* Parameters: IN     grid - The grid of the cost field.                      */
+/*                                                                            */
+/* Operation: Allocate an empty cluster for every cluster of the grid and     */
+/*            mark them all dirty, so the whole hierarchy is built before the */
+/*            first search which uses it.                                     */
+/******************************************************************************/
+DT_PATH_HIERARCHY *dt_create_path_hierarchy(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HIERARCHY *hierarchy;
+  size_t num_clusters;
+
+  hierarchy = (DT_PATH_HIERARCHY *) dt_malloc(sizeof(DT_PATH_HIERARCHY));
+  hierarchy->num_tiles_x = grid->num_tiles_x;
+  hierarchy->num_tiles_y = grid->num_tiles_y;
+  hierarchy->num_clusters_x = (grid->num_tiles_x + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  hierarchy->num_clusters_y = (grid->num_tiles_y + DT_PATH_CLUSTER_SIZE - 1) >>
+                                                         DT_PATH_CLUSTER_SHIFT;
+  num_clusters = (size_t) hierarchy->num_clusters_x *
+                                           (size_t) hierarchy->num_clusters_y;
+  hierarchy->clusters = (DT_PATH_CLUSTER *) dt_calloc(num_clusters,
+                                                      sizeof(DT_PATH_CLUSTER));
+  hierarchy->dirty_clusters = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                                   num_clusters);
+  hierarchy->num_dirty_clusters = 0;
+  hierarchy->clusters_built = 0;
+  dt_mark_path_hierarchy_dirty(hierarchy,
+                               0,
+                               0,
+                               grid->num_tiles_x - 1,
+                               grid->num_tiles_y - 1);
+
+  return(hierarchy);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path_hierarchy                                        */
+/*                                                                            */
+/* Purpose: Free a hierarchy.                                                 */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy to free.                      */
+/*                                                                            */
+/* Operation: Free the entrances and costs of each cluster, then the arrays   */
+/*            and the hierarchy.                                              */
+/******************************************************************************/
+void dt_destroy_path_hierarchy(DT_PATH_HIERARCHY *hierarchy)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_clusters = (size_t) hierarchy->num_clusters_x *
+                                           (size_t) hierarchy->num_clusters_y;
+  size_t ii;
+
+  for (ii = 0; ii < num_clusters; ii++)
+  {
+    dt_free(hierarchy->clusters[ii].nodes);
+    dt_free(hierarchy->clusters[ii].costs);
+  }
+  dt_free(hierarchy->clusters);
+  dt_free(hierarchy->dirty_clusters);
+  dt_free(hierarchy);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_hierarchy                                            */
+/*                                                                            */
+/* Purpose: Find the hierarchy of a cost field, ready to be searched.         */
+/*                                                                            */
+/* Returns: A pointer to the hierarchy, which is owned by the cost field.     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid of the cost field.                      */
+/*             IN/OUT field - The cost field.                                 */
+/*                                                                            */
+/* Operation: Create the hierarchy the first time it is asked for and then    */
+/*            rebuild any clusters which are dirty. Like building the cost    */
+/*            field this writes to the hierarchy, so searches run on several  */
+/*            threads at once must bring it up to date before they start.     */
+/******************************************************************************/
+DT_PATH_HIERARCHY *dt_get_path_hierarchy(DT_GRID *grid, DT_COST_FIELD *field)
+{
+  if (NULL == field->hierarchy)
+  {
+    field->hierarchy = dt_create_path_hierarchy(grid);
+  }
+  dt_update_path_hierarchy(field->hierarchy, field);
+
+  return(field->hierarchy);
+}
+
+/******************************************************************************/
+/* Function: dt_mark_path_hierarchy_dirty                                     */
+/*                                                                            */
+/* Purpose: Mark the clusters covering an area of the grid as needing to be   */
+/*          rebuilt.                                                          */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT hierarchy - The hierarchy.                              */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Clip the area to the grid and add each cluster it touches which */
+/*            is not already dirty to the dirty list. Nothing is rebuilt      */
+/*            until the hierarchy is next searched, so many changes to one    */
+/*            cluster cost a single rebuild.                                  */
+/******************************************************************************/
+void dt_mark_path_hierarchy_dirty(DT_PATH_HIERARCHY *hierarchy,
+                                  int first_x,
+                                  int first_y,
+                                  int last_x,
+                                  int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER *cluster;
+  Uint32 cluster_index;
+  int cluster_x;
+  int cluster_y;
+
+  first_x = MAX(first_x, 0);
+  first_y = MAX(first_y, 0);
+  last_x = MIN(last_x, hierarchy->num_tiles_x - 1);
+  last_y = MIN(last_y, hierarchy->num_tiles_y - 1);
+  for (cluster_y = first_y >> DT_PATH_CLUSTER_SHIFT;
+       cluster_y <= (last_y >> DT_PATH_CLUSTER_SHIFT);
+       cluster_y++)
+  {
+    for (cluster_x = first_x >> DT_PATH_CLUSTER_SHIFT;
+         cluster_x <= (last_x >> DT_PATH_CLUSTER_SHIFT);
+         cluster_x++)
+    {
+      cluster_index = ((Uint32) cluster_y *
+                                  (Uint32) hierarchy->num_clusters_x) +
+                      (Uint32) cluster_x;
+      cluster = &(hierarchy->clusters[cluster_index]);
+      if (!cluster->dirty)
+      {
+        cluster->dirty = true;
+        hierarchy->dirty_clusters[hierarchy->num_dirty_clusters] =
+                                                                 cluster_index;
+        (hierarchy->num_dirty_clusters)++;
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_update_path_hierarchy                                         */
+/*                                                                            */
+/* Purpose: Rebuild the dirty clusters of a hierarchy.                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT hierarchy - The hierarchy.                              */
+/*             IN     field - The cost field of the hierarchy.                */
+/*                                                                            */
+/* Operation: Rebuild each dirty cluster as its own job on the master worker  */
+/*            pool. A cluster is built from its own costs and those of the    */
+/*            points just outside it, and writes only to itself, so the jobs  */
+/*            can run in any order.                                           */
+/******************************************************************************/
+void dt_update_path_hierarchy(DT_PATH_HIERARCHY *hierarchy,
+                              DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER_JOB *jobs;
+  int ii;
+
+  if (0 == hierarchy->num_dirty_clusters)
+  {
+    goto EXIT_LABEL;
+  }
+
+  jobs = (DT_PATH_CLUSTER_JOB *) dt_malloc(sizeof(DT_PATH_CLUSTER_JOB) *
+                                 (size_t) hierarchy->num_dirty_clusters);
+  for (ii = 0; ii < hierarchy->num_dirty_clusters; ii++)
+  {
+    jobs[ii].hierarchy = hierarchy;
+    jobs[ii].field = field;
+    jobs[ii].cluster = hierarchy->dirty_clusters[ii];
+  }
+  dt_run_worker_pool_jobs(dt_get_master_worker_pool(),
+                          dt_build_path_cluster_job,
+                          jobs,
+                          sizeof(DT_PATH_CLUSTER_JOB),
+                          hierarchy->num_dirty_clusters);
+  dt_free(jobs);
+  hierarchy->clusters_built += hierarchy->num_dirty_clusters;
+  hierarchy->num_dirty_clusters = 0;
+
+EXIT_LABEL:
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_path_cluster_job                                        */
+/*                                                                            */
+/* Purpose: Build one cluster of a hierarchy on a worker thread.              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     data - The DT_PATH_CLUSTER_JOB for the cluster.         */
+/*                                                                            */
+/* Operation: Build the cluster of the job.                                   */
+/******************************************************************************/
+void dt_build_path_cluster_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER_JOB *job = (DT_PATH_CLUSTER_JOB *) data;
+
+  dt_build_path_cluster(job->hierarchy, job->field, job->cluster);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_path_cluster                                            */
+/*                                                                            */
+/* Purpose: Find the entrances of a cluster and the costs between them.       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT hierarchy - The hierarchy. Only the cluster built is    */
+/*                                changed.                                    */
+/*             IN     field - The cost field of the hierarchy.                */
+/*             IN     cluster_index - The index of the cluster.               */
+/*                                                                            */
+/* Operation: Gather the entrances of each side of the cluster, then search   */
+/*            the cluster from each entrance to find the cost to every other. */
+/******************************************************************************/
+void dt_build_path_cluster(DT_PATH_HIERARCHY *hierarchy,
+                           DT_COST_FIELD *field,
+                           Uint32 cluster_index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER *cluster = &(hierarchy->clusters[cluster_index]);
+  DT_PATH_CLUSTER_NODE nodes[DT_PATH_MAX_CLUSTER_NODES];
+  Uint32 costs[DT_PATH_CLUSTER_POINTS];
+  int num_nodes = 0;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int direction;
+  int ii;
+  int jj;
+
+  dt_get_path_cluster_area(hierarchy,
+                           cluster_index,
+                           &first_x,
+                           &first_y,
+                           &last_x,
+                           &last_y);
+  for (direction = NORTH; direction < NORTH_1; direction += 2)
+  {
+    dt_add_path_cluster_entrances(hierarchy,
+                                  field,
+                                  first_x,
+                                  first_y,
+                                  last_x,
+                                  last_y,
+                                  direction,
+                                  nodes,
+                                  &num_nodes);
+  }
+
+  /****************************************************************************/
+  /* Replace the entrances and costs the cluster had before.                  */
+  /****************************************************************************/
+  dt_free(cluster->nodes);
+  dt_free(cluster->costs);
+  cluster->nodes = NULL;
+  cluster->costs = NULL;
+  cluster->num_nodes = num_nodes;
+  if (num_nodes > 0)
+  {
+    cluster->nodes = (DT_PATH_CLUSTER_NODE *) dt_malloc(
+                             sizeof(DT_PATH_CLUSTER_NODE) * (size_t) num_nodes);
+    memcpy(cluster->nodes,
+           nodes,
+           sizeof(DT_PATH_CLUSTER_NODE) * (size_t) num_nodes);
+    cluster->costs = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                          (size_t) (num_nodes * num_nodes));
+  }
+  for (ii = 0; ii < num_nodes; ii++)
+  {
+    dt_search_path_cluster(field,
+                           first_x,
+                           first_y,
+                           last_x,
+                           last_y,
+                           (int) (nodes[ii].point %
+                                             (Uint32) hierarchy->num_tiles_x),
+                           (int) (nodes[ii].point /
+                                             (Uint32) hierarchy->num_tiles_x),
+                           false,
+                           costs);
+    for (jj = 0; jj < num_nodes; jj++)
+    {
+      cluster->costs[(ii * num_nodes) + jj] =
+                      costs[dt_get_path_cluster_point(hierarchy,
+                                                      nodes[jj].point,
+                                                      first_x,
+                                                      first_y)];
+    }
+  }
+  cluster->dirty = false;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_add_path_cluster_entrances                                    */
+/*                                                                            */
+/* Purpose: Find the entrances on one side of a cluster.                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*             IN     field - The cost field of the hierarchy.                */
+/*             IN     first_x - The x coordinate of the left of the cluster.  */
+/*             IN     first_y - The y coordinate of the top of the cluster.   */
+/*             IN     last_x - The x coordinate of the right of the cluster.  */
+/*             IN     last_y - The y coordinate of the bottom of the cluster. */
+/*             IN     direction - The side, as the direction from the cluster */
+/*                                to its neighbour. One of NORTH, EAST, SOUTH */
+/*                                and WEST.                                   */
+/*             IN/OUT nodes - The entrances found so far.                     */
+/*             IN/OUT num_nodes - The number of entrances found so far.       */
+/*                                                                            */
+/* Operation: Walk along the side looking for stretches where both the point  */
+/*            on the edge and the point beside it in the neighbour are open.  */
+/*            A narrow stretch has an entrance in the middle and a wide one   */
+/*            has one at each end and others evenly between, so that paths    */
+/*            across open ground are not drawn towards the corners of the     */
+/*            clusters. The neighbour walks the same side the same            */
+/*            way, so it finds the matching entrances. There is no entrance   */
+/*            off the edge of the grid, as the border of the field is blocked.*/
+/******************************************************************************/
+void dt_add_path_cluster_entrances(DT_PATH_HIERARCHY *hierarchy,
+                                   DT_COST_FIELD *field,
+                                   int first_x,
+                                   int first_y,
+                                   int last_x,
+                                   int last_y,
+                                   int direction,
+                                   DT_PATH_CLUSTER_NODE *nodes,
+                                   int *num_nodes)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  long index;
+  int step_x = dt_get_orientation_step_x(direction);
+  int step_y = dt_get_orientation_step_y(direction);
+  int edge_x = (step_x > 0) ? last_x : first_x;
+  int edge_y = (step_y > 0) ? last_y : first_y;
+  int along_x = (0 == step_x) ? 1 : 0;
+  int along_y = 1 - along_x;
+  int side_length = (0 == step_x) ? (last_x - first_x + 1) :
+                                    (last_y - first_y + 1);
+  int length;
+  int run_start = -1;
+  int num_entrances;
+  int position;
+  int ii;
+  int jj;
+  bool open;
+
+  /****************************************************************************/
+  /* Go one past the end of the side so that a stretch running to the end is  */
+  /* closed off.                                                              */
+  /****************************************************************************/
+  for (ii = 0; ii <= side_length; ii++)
+  {
+    open = false;
+    if (ii < side_length)
+    {
+      index = dt_get_cost_field_index(field,
+                                      edge_x + (ii * along_x),
+                                      edge_y + (ii * along_y));
+      open = (DT_COST_FIELD_BLOCKED != field->costs[index]) &&
+             (DT_COST_FIELD_BLOCKED !=
+                             field->costs[index + field->offsets[direction]]);
+    }
+    if (open && (run_start < 0))
+    {
+      run_start = ii;
+    }
+    else if (!open && (run_start >= 0))
+    {
+      length = ii - run_start;
+      num_entrances = ((length - 1) / DT_PATH_ENTRANCE_SPACING) + 1;
+      for (jj = 0; jj < num_entrances; jj++)
+      {
+        position = (1 == num_entrances) ?
+                     run_start + ((length - 1) / 2) :
+                     run_start + ((jj * (length - 1)) / (num_entrances - 1));
+        dt_add_path_cluster_node(hierarchy,
+                                 edge_x + (position * along_x),
+                                 edge_y + (position * along_y),
+                                 direction,
+                                 nodes,
+                                 num_nodes);
+      }
+      run_start = -1;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_add_path_cluster_node                                         */
+/*                                                                            */
+/* Purpose: Add an entrance to the entrances found for a cluster.             */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*             IN     grid_x - The x coordinate of the entrance.              */
+/*             IN     grid_y - The y coordinate of the entrance.              */
+/*             IN     direction - The direction of the step to the entrance   */
+/*                                of the neighbouring cluster.                */
+/*             IN/OUT nodes - The entrances found so far.                     */
+/*             IN/OUT num_nodes - The number of entrances found so far.       */
+/*                                                                            */
+/* Operation: A corner point can be an entrance on two sides, in which case   */
+/*            the second side adds a link to the entrance already found.      */
+/******************************************************************************/
+void dt_add_path_cluster_node(DT_PATH_HIERARCHY *hierarchy,
+                              int grid_x,
+                              int grid_y,
+                              int direction,
+                              DT_PATH_CLUSTER_NODE *nodes,
+                              int *num_nodes)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER_NODE *node;
+  Uint32 point;
+  int ii;
+
+  point = ((Uint32) grid_y * (Uint32) hierarchy->num_tiles_x) + (Uint32) grid_x;
+  for (ii = 0; ii < *num_nodes; ii++)
+  {
+    if (nodes[ii].point == point)
+    {
+      break;
+    }
+  }
+  node = &(nodes[ii]);
+  if (ii == *num_nodes)
+  {
+    node->point = point;
+    node->num_links = 0;
+    (*num_nodes)++;
+  }
+  node->link_directions[node->num_links] = (unsigned char) direction;
+  (node->num_links)++;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_search_path_cluster                                           */
+/*                                                                            */
+/* Purpose: Find the cheapest cost between one point of a cluster and every   */
+/*          other without leaving it.                                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     field - The cost field searched.                        */
+/*             IN     first_x - The x coordinate of the left of the cluster.  */
+/*             IN     first_y - The y coordinate of the top of the cluster.   */
+/*             IN     last_x - The x coordinate of the right of the cluster.  */
+/*             IN     last_y - The y coordinate of the bottom of the cluster. */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             IN     reverse - false for the cost from the point to every    */
+/*                              other, true for the cost from every other     */
+/*                              point to it. Steps cost what the point moved  */
+/*                              onto costs, so the two are not the same.      */
+/*             OUT    costs - The cost for each point of the cluster,         */
+/*                            numbered row by row within it, or               */
+/*                            DT_PATH_NO_CLUSTER_COST if it cannot be reached.*/
+/*                                                                            */
+/* Operation: Start with only the point open and relax the cluster from it.   */
+/******************************************************************************/
+void dt_search_path_cluster(DT_COST_FIELD *field,
+                            int first_x,
+                            int first_y,
+                            int last_x,
+                            int last_y,
+                            int grid_x,
+                            int grid_y,
+                            bool reverse,
+                            Uint32 *costs)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER_HEAP heap;
+  int point;
+  int ii;
+
+  for (ii = 0; ii < DT_PATH_CLUSTER_POINTS; ii++)
+  {
+    costs[ii] = DT_PATH_NO_CLUSTER_COST;
+  }
+  dt_init_path_cluster_heap(&heap, costs);
+  point = ((grid_y - first_y) << DT_PATH_CLUSTER_SHIFT) + (grid_x - first_x);
+  costs[point] = 0;
+  dt_update_path_cluster_heap(&heap, point);
+  dt_relax_path_cluster(field,
+                        first_x,
+                        first_y,
+                        last_x,
+                        last_y,
+                        reverse,
+                        &heap);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_relax_path_cluster                                            */
+/*                                                                            */
+/* Purpose: Lower the costs of the points of a cluster along every path from  */
+/*          the points open in a heap, without leaving the cluster.           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     field - The cost field searched.                        */
+/*             IN     first_x - The x coordinate of the left of the cluster.  */
+/*             IN     first_y - The y coordinate of the top of the cluster.   */
+/*             IN     last_x - The x coordinate of the right of the cluster.  */
+/*             IN     last_y - The y coordinate of the bottom of the cluster. */
+/*             IN     reverse - false if the costs are from the open points,  */
+/*                              true if they are to them.                     */
+/*             IN/OUT heap - The open points, whose costs array holds the     */
+/*                           cost so far of every point of the cluster. It is */
+/*                           empty on return.                                 */
+/*                                                                            */
+/* Operation: Dijkstra's algorithm over the points of the cluster. Going in   */
+/*            reverse, each point is reached by the steps into the point      */
+/*            expanded rather than out of it.                                 */
+/******************************************************************************/
+void dt_relax_path_cluster(DT_COST_FIELD *field,
+                           int first_x,
+                           int first_y,
+                           int last_x,
+                           int last_y,
+                           bool reverse,
+                           DT_PATH_CLUSTER_HEAP *heap)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *costs = heap->costs;
+  Uint32 step_cost;
+  long index;
+  int point;
+  int next_point;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  while (heap->num_entries > 0)
+  {
+    point = dt_pop_path_cluster_heap(heap);
+    grid_x = first_x + (point & (DT_PATH_CLUSTER_SIZE - 1));
+    grid_y = first_y + (point >> DT_PATH_CLUSTER_SHIFT);
+    index = dt_get_cost_field_index(field, grid_x, grid_y);
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      if (reverse)
+      {
+        next_x = grid_x - dt_get_orientation_step_x(direction);
+        next_y = grid_y - dt_get_orientation_step_y(direction);
+      }
+      else
+      {
+        next_x = grid_x + dt_get_orientation_step_x(direction);
+        next_y = grid_y + dt_get_orientation_step_y(direction);
+      }
+      if ((next_x < first_x) || (next_x > last_x) ||
+          (next_y < first_y) || (next_y > last_y))
+      {
+        continue;
+      }
+      step_cost = dt_get_cost_field_step_cost(field,
+                                              reverse ?
+                                          index - field->offsets[direction] :
+                                          index,
+                                              direction);
+      next_point = ((next_y - first_y) << DT_PATH_CLUSTER_SHIFT) +
+                   (next_x - first_x);
+      if ((0 != step_cost) && (costs[point] + step_cost < costs[next_point]))
+      {
+        costs[next_point] = costs[point] + step_cost;
+        dt_update_path_cluster_heap(heap, next_point);
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_init_path_cluster_heap                                        */
+/*                                                                            */
+/* Purpose: Empty the open list of a search of a cluster.                     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: OUT    heap - The open list.                                   */
+/*             IN     costs - The cost so far of each point of the cluster,   */
+/*                            which orders the list.                          */
+/*                                                                            */
+/* Operation: Mark every point as not in the heap.                            */
+/******************************************************************************/
+void dt_init_path_cluster_heap(DT_PATH_CLUSTER_HEAP *heap, Uint32 *costs)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < DT_PATH_CLUSTER_POINTS; ii++)
+  {
+    heap->positions[ii] = DT_PATH_CLUSTER_POINTS;
+  }
+  heap->costs = costs;
+  heap->num_entries = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_update_path_cluster_heap                                      */
+/*                                                                            */
+/* Purpose: Add a point to the open list of a search of a cluster, or move it */
+/*          up the list once its cost has been lowered.                       */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT heap - The open list.                                   */
+/*             IN     point - The point, numbered row by row in the cluster.  */
+/*                                                                            */
+/* Operation: Start from the end of the heap for a new point, or from where   */
+/*            the point is, and move parents down until the point's place is  */
+/*            found.                                                          */
+/******************************************************************************/
+void dt_update_path_cluster_heap(DT_PATH_CLUSTER_HEAP *heap, int point)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 cost = heap->costs[point];
+  int position = heap->positions[point];
+  int parent;
+
+  if (DT_PATH_CLUSTER_POINTS == position)
+  {
+    position = heap->num_entries;
+    (heap->num_entries)++;
+  }
+  while (position > 0)
+  {
+    parent = (position - 1) / 2;
+    if (heap->costs[heap->points[parent]] <= cost)
+    {
+      break;
+    }
+    heap->points[position] = heap->points[parent];
+    heap->positions[heap->points[position]] = (Uint16) position;
+    position = parent;
+  }
+  heap->points[position] = (Uint16) point;
+  heap->positions[point] = (Uint16) position;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_pop_path_cluster_heap                                         */
+/*                                                                            */
+/* Purpose: Take the cheapest point off the open list of a search of a        */
+/*          cluster.                                                          */
+/*                                                                            */
+/* Returns: The point, numbered row by row in the cluster.                    */
+/*                                                                            */
+/* Parameters: IN/OUT heap - The open list, which must not be empty.          */
+/*                                                                            */
+/* Operation: Move the last point into the gap at the top and move children   */
+/*            up until its place is found.                                    */
+/******************************************************************************/
+int dt_pop_path_cluster_heap(DT_PATH_CLUSTER_HEAP *heap)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 cost;
+  int point = heap->points[0];
+  int last;
+  int position = 0;
+  int child;
+
+  heap->positions[point] = DT_PATH_CLUSTER_POINTS;
+  (heap->num_entries)--;
+  if (heap->num_entries > 0)
+  {
+    last = heap->points[heap->num_entries];
+    cost = heap->costs[last];
+    while (true)
+    {
+      child = (position * 2) + 1;
+      if (child >= heap->num_entries)
+      {
+        break;
+      }
+      if ((child + 1 < heap->num_entries) &&
+          (heap->costs[heap->points[child + 1]] <
+                                          heap->costs[heap->points[child]]))
+      {
+        child++;
+      }
+      if (heap->costs[heap->points[child]] >= cost)
+      {
+        break;
+      }
+      heap->points[position] = heap->points[child];
+      heap->positions[heap->points[position]] = (Uint16) position;
+      position = child;
+    }
+    heap->points[position] = (Uint16) last;
+    heap->positions[last] = (Uint16) position;
+  }
+
+  return(point);
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_cluster_area                                         */
+/*                                                                            */
+/* Purpose: Find the points of the grid a cluster covers.                     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*             IN     cluster_index - The index of the cluster.               */
+/*             OUT    first_x - The x coordinate of the left of the cluster.  */
+/*             OUT    first_y - The y coordinate of the top of the cluster.   */
+/*             OUT    last_x - The x coordinate of the right of the cluster.  */
+/*             OUT    last_y - The y coordinate of the bottom of the cluster. */
+/*                                                                            */
+/* Operation: Clusters on the right and bottom of the grid may be cut short   */
+/*            by its edge.                                                    */
+/******************************************************************************/
+void dt_get_path_cluster_area(DT_PATH_HIERARCHY *hierarchy,
+                              Uint32 cluster_index,
+                              int *first_x,
+                              int *first_y,
+                              int *last_x,
+                              int *last_y)
+{
+  (*first_x) = (int) (cluster_index % (Uint32) hierarchy->num_clusters_x) <<
+                                                         DT_PATH_CLUSTER_SHIFT;
+  (*first_y) = (int) (cluster_index / (Uint32) hierarchy->num_clusters_x) <<
+                                                         DT_PATH_CLUSTER_SHIFT;
+  (*last_x) = MIN(*first_x + DT_PATH_CLUSTER_SIZE, hierarchy->num_tiles_x) - 1;
+  (*last_y) = MIN(*first_y + DT_PATH_CLUSTER_SIZE, hierarchy->num_tiles_y) - 1;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_cluster_point                                        */
+/*                                                                            */
+/* Purpose: Find where a point of the grid is within its cluster.             */
+/*                                                                            */
+/* Returns: The point, numbered row by row in the cluster.                    */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*             IN     point - The index of the point on the grid.             */
+/*             IN     first_x - The x coordinate of the left of the cluster.  */
+/*             IN     first_y - The y coordinate of the top of the cluster.   */
+/*                                                                            */
+/* Operation: Take the offset of each coordinate from the corner.             */
+/******************************************************************************/
+int dt_get_path_cluster_point(DT_PATH_HIERARCHY *hierarchy,
+                              Uint32 point,
+                              int first_x,
+                              int first_y)
+{
+  return(((((int) (point / (Uint32) hierarchy->num_tiles_x)) - first_y) <<
+                                                      DT_PATH_CLUSTER_SHIFT) +
+         (((int) (point % (Uint32) hierarchy->num_tiles_x)) - first_x));
+}
+
+/******************************************************************************/
+/* Function: dt_find_path_cluster_node                                        */
+/*                                                                            */
+/* Purpose: Find the entrance of a cluster at a point.                        */
+/*                                                                            */
+/* Returns: The index of the entrance in the cluster, or -1 if the point is   */
+/*          not an entrance.                                                  */
+/*                                                                            */
+/* Parameters: IN     cluster - The cluster holding the point.                */
+/*             IN     point - The index of the point on the grid.             */
+/*                                                                            */
+/* Operation: Look through the entrances. There are never many.               */
+/******************************************************************************/
+int dt_find_path_cluster_node(DT_PATH_CLUSTER *cluster, Uint32 point)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < cluster->num_nodes; ii++)
+  {
+    if (cluster->nodes[ii].point == point)
+    {
+      goto EXIT_LABEL;
+    }
+  }
+  ii = -1;
+
+EXIT_LABEL:
+
+  return(ii);
+}
+
+/******************************************************************************/
+/* Function: dt_find_abstract_path                                            */
+/*                                                                            */
+/* Purpose: Find the cheapest path across the abstract graph of a grid for a  */
+/*          unit, without searching the grid between the entrances it passes. */
+/*                                                                            */
+/* Returns: DT_PATH_FOUND if a path was found.                                */
+/*          DT_PATH_NOT_FOUND if the goal cannot be reached.                  */
+/*          DT_PATH_BAD_POINT if the start or goal is off the grid or the     */
+/*          goal cannot be entered.                                           */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. It must not be  */
+/*                             oriented.                                      */
+/*             IN     unit - The unit which is to move.                       */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             OUT    abstract_path - The path found, or NULL if none was.    */
+/*                                    Free it with dt_destroy_abstract_path.  */
+/*                                                                            */
+/* Operation: A* over the entrances, using the nodes of the search for the    */
+/*            points they are at and DT_PATH_ABSTRACT_PARENTS for their       */
+/*            parents. The start and goal are joined to the graph by          */
+/*            searching their own clusters, and the start straight to the     */
+/*            goal when they share one. Paths which cross from one cluster    */
+/*            to another diagonally at a corner are not considered, so the    */
+/*            path found may cost a little more than the cheapest one. A goal */
+/*            in a region the start cannot reach is turned down before        */
+/*            anything is searched.                                           */
+/******************************************************************************/
+int dt_find_abstract_path(DT_PATH_SEARCH *search,
+                          DT_UNIT *unit,
+                          int start_x,
+                          int start_y,
+                          int goal_x,
+                          int goal_y,
+                          DT_ABSTRACT_PATH **abstract_path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = search->grid;
+  DT_COST_FIELD *field;
+  DT_PATH_HIERARCHY *hierarchy;
+  DT_PATH_CLUSTER *cluster;
+  DT_PATH_CLUSTER_NODE *cluster_node;
+  Uint32 goal_costs[DT_PATH_CLUSTER_POINTS];
+  Uint64 start_time;
+  Uint32 min_cost;
+  Uint32 start;
+  Uint32 goal;
+  Uint32 node;
+  Uint32 cluster_index;
+  Uint32 goal_cluster_index;
+  Uint32 cost;
+  Uint32 step_cost;
+  long index;
+  int ret_code = DT_PATH_NOT_FOUND;
+  int node_index;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int direction;
+  int ii;
+
+  start_time = dt_get_time_us();
+  (*abstract_path) = NULL;
+  dt_begin_path_search(search);
+  field = dt_get_grid_cost_field(grid, unit);
+  if (!dt_check_path_points(grid, field, start_x, start_y, goal_x, goal_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    goto EXIT_LABEL;
+  }
+  if (!dt_is_goal_in_start_region(grid,
+                                  field,
+                                  start_x,
+                                  start_y,
+                                  goal_x,
+                                  goal_y))
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Find the cost from every point of the goal's cluster to the goal, and    */
+  /* open the start.                                                          */
+  /****************************************************************************/
+  hierarchy = dt_get_path_hierarchy(grid, field);
+  min_cost = (Uint32) dt_get_min_move_cost(unit);
+  start = ((Uint32) start_y * (Uint32) grid->num_tiles_x) + (Uint32) start_x;
+  goal = ((Uint32) goal_y * (Uint32) grid->num_tiles_x) + (Uint32) goal_x;
+  goal_cluster_index = dt_get_path_cluster_index(hierarchy, goal_x, goal_y);
+  dt_get_path_cluster_area(hierarchy,
+                           goal_cluster_index,
+                           &first_x,
+                           &first_y,
+                           &last_x,
+                           &last_y);
+  dt_search_path_cluster(field,
+                         first_x,
+                         first_y,
+                         last_x,
+                         last_y,
+                         goal_x,
+                         goal_y,
+                         true,
+                         goal_costs);
+  dt_reach_abstract_point(search, start, 0, DT_PATH_NO_PARENT, min_cost, goal);
+
+  /****************************************************************************/
+  /* Expand the open point with the lowest estimate until the goal is         */
+  /* reached.                                                                 */
+  /****************************************************************************/
+  while (search->heap.num_entries > 0)
+  {
+    node = dt_pop_path_heap(search);
+    (search->nodes_expanded)++;
+    if (node == goal)
+    {
+      (*abstract_path) = dt_build_abstract_path(search, hierarchy, start, goal);
+      ret_code = DT_PATH_FOUND;
+      break;
+    }
+
+    cluster_index = dt_get_path_cluster_index(
+                                 hierarchy,
+                                 (int) (node % (Uint32) grid->num_tiles_x),
+                                 (int) (node / (Uint32) grid->num_tiles_x));
+    cluster = &(hierarchy->clusters[cluster_index]);
+    dt_get_path_cluster_area(hierarchy,
+                             cluster_index,
+                             &first_x,
+                             &first_y,
+                             &last_x,
+                             &last_y);
+    node_index = dt_find_path_cluster_node(cluster, node);
+
+    /**************************************************************************/
+    /* A start which is not an entrance leads to the entrances of its cluster */
+    /* and to the goal if it is in the same one. A unit may stand on a point  */
+    /* it could not enter, in which case its first step may take it into the  */
+    /* next cluster, so it leads on from each point it can step to instead.   */
+    /**************************************************************************/
+    if (node_index < 0)
+    {
+      index = dt_get_cost_field_index(field, start_x, start_y);
+      if (DT_COST_FIELD_BLOCKED != field->costs[index])
+      {
+        dt_leave_abstract_start(search,
+                                field,
+                                hierarchy,
+                                start_x,
+                                start_y,
+                                0,
+                                min_cost,
+                                goal);
+        continue;
+      }
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        step_cost = dt_get_cost_field_step_cost(field, index, direction);
+        if (0 != step_cost)
+        {
+          dt_leave_abstract_start(
+                             search,
+                             field,
+                             hierarchy,
+                             start_x + dt_get_orientation_step_x(direction),
+                             start_y + dt_get_orientation_step_y(direction),
+                             step_cost,
+                             min_cost,
+                             goal);
+        }
+      }
+      continue;
+    }
+
+    /**************************************************************************/
+    /* An entrance leads to the other entrances of its cluster, to the        */
+    /* entrances beside it in the neighbouring clusters and to the goal if it */
+    /* is in the same cluster.                                                */
+    /**************************************************************************/
+    cluster_node = &(cluster->nodes[node_index]);
+    for (ii = 0; ii < cluster->num_nodes; ii++)
+    {
+      cost = cluster->costs[(node_index * cluster->num_nodes) + ii];
+      if ((ii != node_index) && (DT_PATH_NO_CLUSTER_COST != cost))
+      {
+        dt_reach_abstract_point(search,
+                                cluster->nodes[ii].point,
+                                search->cost[node] + cost,
+                                node_index,
+                                min_cost,
+                                goal);
+      }
+    }
+    for (ii = 0; ii < cluster_node->num_links; ii++)
+    {
+      direction = cluster_node->link_directions[ii];
+      dt_reach_abstract_point(
+              search,
+              (Uint32) ((long) node + search->node_offsets[direction]),
+              search->cost[node] +
+                  dt_get_cost_field_step_cost(
+                      field,
+                      dt_get_cost_field_index(
+                                  field,
+                                  (int) (node % (Uint32) grid->num_tiles_x),
+                                  (int) (node / (Uint32) grid->num_tiles_x)),
+                      direction),
+              DT_PATH_LINK_PARENT + direction,
+              min_cost,
+              goal);
+    }
+    if (cluster_index == goal_cluster_index)
+    {
+      cost = goal_costs[dt_get_path_cluster_point(hierarchy,
+                                                  node,
+                                                  first_x,
+                                                  first_y)];
+      if (DT_PATH_NO_CLUSTER_COST != cost)
+      {
+        dt_reach_abstract_point(search,
+                                goal,
+                                search->cost[node] + cost,
+                                node_index,
+                                min_cost,
+                                goal);
+      }
+    }
+  }
+
+EXIT_LABEL:
+
+  (search->num_searches)++;
+  search->total_nodes_expanded += (Uint64) search->nodes_expanded;
+  search->total_search_time_us += dt_get_time_us() - start_time;
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_leave_abstract_start                                          */
+/*                                                                            */
+/* Purpose: Join the start of a search of the abstract graph to the           */
+/*          entrances of a cluster.                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     field - The cost field searched.                        */
+/*             IN     hierarchy - The hierarchy of the field.                 */
+/*             IN     grid_x - The x coordinate of the start, or of the point */
+/*                             the first step from the start moves onto.      */
+/*             IN     grid_y - The y coordinate of the same point.            */
+/*             IN     cost - The cost of reaching that point.                 */
+/*             IN     min_cost - The least the unit can pay to move onto any  */
+/*                               point.                                       */
+/*             IN     goal - The index of the goal.                           */
+/*                                                                            */
+/* Operation: Search the cluster holding the point from it and reach each     */
+/*            entrance, and the goal if it is in the same cluster, as a step  */
+/*            straight from the start.                                        */
+/******************************************************************************/
+void dt_leave_abstract_start(DT_PATH_SEARCH *search,
+                             DT_COST_FIELD *field,
+                             DT_PATH_HIERARCHY *hierarchy,
+                             int grid_x,
+                             int grid_y,
+                             Uint32 cost,
+                             Uint32 min_cost,
+                             Uint32 goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_CLUSTER *cluster;
+  Uint32 costs[DT_PATH_CLUSTER_POINTS];
+  Uint32 cluster_index;
+  Uint32 local_cost;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int ii;
+
+  cluster_index = dt_get_path_cluster_index(hierarchy, grid_x, grid_y);
+  cluster = &(hierarchy->clusters[cluster_index]);
+  dt_get_path_cluster_area(hierarchy,
+                           cluster_index,
+                           &first_x,
+                           &first_y,
+                           &last_x,
+                           &last_y);
+  dt_search_path_cluster(field,
+                         first_x,
+                         first_y,
+                         last_x,
+                         last_y,
+                         grid_x,
+                         grid_y,
+                         false,
+                         costs);
+  for (ii = 0; ii < cluster->num_nodes; ii++)
+  {
+    local_cost = costs[dt_get_path_cluster_point(hierarchy,
+                                                 cluster->nodes[ii].point,
+                                                 first_x,
+                                                 first_y)];
+    if (DT_PATH_NO_CLUSTER_COST != local_cost)
+    {
+      dt_reach_abstract_point(search,
+                              cluster->nodes[ii].point,
+                              cost + local_cost,
+                              DT_PATH_START_PARENT,
+                              min_cost,
+                              goal);
+    }
+  }
+  if (cluster_index == dt_get_path_cluster_index(
+                           hierarchy,
+                           (int) (goal % (Uint32) hierarchy->num_tiles_x),
+                           (int) (goal / (Uint32) hierarchy->num_tiles_x)))
+  {
+    local_cost = costs[dt_get_path_cluster_point(hierarchy,
+                                                 goal,
+                                                 first_x,
+                                                 first_y)];
+    if (DT_PATH_NO_CLUSTER_COST != local_cost)
+    {
+      dt_reach_abstract_point(search,
+                              goal,
+                              cost + local_cost,
+                              DT_PATH_START_PARENT,
+                              min_cost,
+                              goal);
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_reach_abstract_point                                          */
+/*                                                                            */
+/* Purpose: Record that a search of the abstract graph has reached a point.   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     point - The index of the point reached.                 */
+/*             IN     cost - The cost of reaching it this way.                */
+/*             IN     parent - How it was reached. One of                     */
+/*                             DT_PATH_ABSTRACT_PARENTS.                      */
+/*             IN     min_cost - The least the unit can pay to move onto any  */
+/*                               point.                                       */
+/*             IN     goal - The index of the goal.                           */
+/*                                                                            */
+/* Operation: Estimate the cost to the goal as a search of the grid does and  */
+/*            reach the node of the point. Every cost in the graph is that of */
+/*            a real path, so the estimate is consistent here too.            */
+/******************************************************************************/
+void dt_reach_abstract_point(DT_PATH_SEARCH *search,
+                             Uint32 point,
+                             Uint32 cost,
+                             int parent,
+                             Uint32 min_cost,
+                             Uint32 goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 num_tiles_x = (Uint32) search->grid->num_tiles_x;
+
+  dt_reach_path_state(search,
+                      point,
+                      cost,
+                      parent,
+                      min_cost * dt_get_octile_distance(
+                             (int) (goal % num_tiles_x) -
+                                                (int) (point % num_tiles_x),
+                             (int) (goal / num_tiles_x) -
+                                                (int) (point / num_tiles_x)));
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_abstract_path                                           */
+/*                                                                            */
+/* Purpose: Build the path to the goal found by a search of the abstract      */
+/*          graph.                                                            */
+/*                                                                            */
+/* Returns: A pointer to the new abstract path.                               */
+/*                                                                            */
+/* Parameters: IN     search - The search which reached the goal.             */
+/*             IN     hierarchy - The hierarchy searched.                     */
+/*             IN     start - The index of the start.                         */
+/*             IN     goal - The index of the goal.                           */
+/*                                                                            */
+/* Operation: Follow the parents back to the start once to count the          */
+/*            waypoints and again to fill them in from the end. The entrance  */
+/*            a path leaves a cluster by is left out, so that each part runs  */
+/*            from where the path enters one cluster to where it enters the   */
+/*            next and the search of the grid is free to cross between them   */
+/*            wherever is cheapest.                                           */
+/******************************************************************************/
+DT_ABSTRACT_PATH *dt_build_abstract_path(DT_PATH_SEARCH *search,
+                                         DT_PATH_HIERARCHY *hierarchy,
+                                         Uint32 start,
+                                         Uint32 goal)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_ABSTRACT_PATH *abstract_path;
+  Uint32 point;
+  bool leaving;
+  int pass;
+  int ii = 0;
+
+  abstract_path = (DT_ABSTRACT_PATH *) dt_malloc(sizeof(DT_ABSTRACT_PATH));
+  abstract_path->cost = search->cost[goal];
+  abstract_path->waypoints = NULL;
+  for (pass = 0; pass < 2; pass++)
+  {
+    if (1 == pass)
+    {
+      abstract_path->num_waypoints = ii;
+      abstract_path->waypoints = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                                      (size_t) ii);
+    }
+    leaving = false;
+    for (point = goal;
+         DT_PATH_NO_STATE != point;
+         point = dt_get_previous_abstract_point(search,
+                                                hierarchy,
+                                                start,
+                                                point))
+    {
+      if (!leaving || (start == point))
+      {
+        ii += (0 == pass) ? 1 : -1;
+        if (1 == pass)
+        {
+          abstract_path->waypoints[ii] = point;
+        }
+      }
+      leaving = (search->parent[point] >= DT_PATH_LINK_PARENT) &&
+                (search->parent[point] < DT_PATH_LINK_PARENT + NORTH_1);
+    }
+  }
+
+  return(abstract_path);
+}
+
+/******************************************************************************/
+/* Function: dt_get_previous_abstract_point                                   */
+/*                                                                            */
+/* Purpose: Find the point before a point on the cheapest path across the     */
+/*          abstract graph.                                                   */
+/*                                                                            */
+/* Returns: The index of the previous point, or DT_PATH_NO_STATE for the      */
+/*          start.                                                            */
+/*                                                                            */
+/* Parameters: IN     search - The search which reached the point.            */
+/*             IN     hierarchy - The hierarchy searched.                     */
+/*             IN     start - The index of the start.                         */
+/*             IN     point - The index of the point.                         */
+/*                                                                            */
+/* Operation: See DT_PATH_ABSTRACT_PARENTS.                                   */
+/******************************************************************************/
+Uint32 dt_get_previous_abstract_point(DT_PATH_SEARCH *search,
+                                      DT_PATH_HIERARCHY *hierarchy,
+                                      Uint32 start,
+                                      Uint32 point)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 previous;
+  int parent = search->parent[point];
+
+  if (DT_PATH_NO_PARENT == parent)
+  {
+    previous = DT_PATH_NO_STATE;
+  }
+  else if (DT_PATH_START_PARENT == parent)
+  {
+    previous = start;
+  }
+  else if (parent >= DT_PATH_LINK_PARENT)
+  {
+    previous = (Uint32) ((long) point -
+                         search->node_offsets[parent - DT_PATH_LINK_PARENT]);
+  }
+  else
+  {
+    previous = hierarchy->clusters[dt_get_path_cluster_index(
+                           hierarchy,
+                           (int) (point % (Uint32) hierarchy->num_tiles_x),
+                           (int) (point / (Uint32) hierarchy->num_tiles_x))].
+                                                         nodes[parent].point;
+  }
+
+  return(previous);
+}
+
+/******************************************************************************/
+/* Function: dt_refine_abstract_path                                          */
+/*                                                                            */
+/* Purpose: Search the grid for the steps of one part of an abstract path.    */
+/*                                                                            */
+/* Returns: As dt_find_path.                                                  */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid.                 */
+/*             IN     unit - The unit which is to move.                       */
+/*             IN     abstract_path - The abstract path.                      */
+/*             IN     segment - The part of the path, from 0 for the part     */
+/*                              from the first waypoint to the second.        */
+/*             OUT    path - The path found for the part, or NULL.            */
+/*                                                                            */
+/* Operation: The second waypoint is just across the border of the cluster    */
+/*            holding the first, so the search of the grid between them is    */
+/*            short. Parts can be refined as the unit reaches them, so an     */
+/*            order which is changed part way is never searched in full.      */
+/******************************************************************************/
+int dt_refine_abstract_path(DT_PATH_SEARCH *search,
+                            DT_UNIT *unit,
+                            DT_ABSTRACT_PATH *abstract_path,
+                            int segment,
+                            DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 num_tiles_x = (Uint32) search->grid->num_tiles_x;
+  Uint32 from = abstract_path->waypoints[segment];
+  Uint32 to = abstract_path->waypoints[segment + 1];
+
+  return(dt_find_path(search,
+                      unit,
+                      (int) (from % num_tiles_x),
+                      (int) (from / num_tiles_x),
+                      (int) (to % num_tiles_x),
+                      (int) (to / num_tiles_x),
+                      path));
+}
+
+/******************************************************************************/
+/* Function: dt_find_hierarchical_path                                        */
+/*                                                                            */
+/* Purpose: Find a path between two points of a grid for a unit using the     */
+/*          hierarchy of the grid.                                            */
+/*                                                                            */
+/* Returns: As dt_find_path.                                                  */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. It must not be  */
+/*                             oriented.                                      */
+/*             IN     unit - The unit which is to move.                       */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             OUT    path - The path found, or NULL if none was. Free it     */
+/*                           with dt_destroy_path.                            */
+/*                                                                            */
+/* Operation: Find the abstract path, refine every part of it and join the    */
+/*            parts. Each part after the first starts with the unit facing    */
+/*            the way it ended the part before.                               */
+/******************************************************************************/
+int dt_find_hierarchical_path(DT_PATH_SEARCH *search,
+                              DT_UNIT *unit,
+                              int start_x,
+                              int start_y,
+                              int goal_x,
+                              int goal_y,
+                              DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_ABSTRACT_PATH *abstract_path;
+  DT_PATH **parts = NULL;
+  DT_UNIT part_unit;
+  int ret_code;
+  int num_parts = 0;
+  int num_points = 1;
+  int ii;
+
+  (*path) = NULL;
+  ret_code = dt_find_abstract_path(search,
+                                   unit,
+                                   start_x,
+                                   start_y,
+                                   goal_x,
+                                   goal_y,
+                                   &abstract_path);
+  if (DT_PATH_FOUND != ret_code)
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Refine each part.                                                        */
+  /****************************************************************************/
+  parts = (DT_PATH **) dt_malloc(sizeof(DT_PATH *) *
+                                 (size_t) abstract_path->num_waypoints);
+  part_unit = (*unit);
+  for (num_parts = 0;
+       num_parts < abstract_path->num_waypoints - 1;
+       num_parts++)
+  {
+    ret_code = dt_refine_abstract_path(search,
+                                       &part_unit,
+                                       abstract_path,
+                                       num_parts,
+                                       &(parts[num_parts]));
+    if (DT_PATH_FOUND != ret_code)
+    {
+      goto EXIT_LABEL;
+    }
+    num_points += parts[num_parts]->num_points - 1;
+    part_unit.orientation =
+     parts[num_parts]->points[parts[num_parts]->num_points - 1].orientation;
+  }
+
+  /****************************************************************************/
+  /* Join the parts, leaving out the first point of each as it is the last of */
+  /* the one before.                                                          */
+  /****************************************************************************/
+  (*path) = (DT_PATH *) dt_malloc(sizeof(DT_PATH));
+  (*path)->points = (DT_PATH_POINT *) dt_malloc(sizeof(DT_PATH_POINT) *
+                                                (size_t) num_points);
+  (*path)->points[0].grid_x = start_x;
+  (*path)->points[0].grid_y = start_y;
+  (*path)->points[0].orientation = unit->orientation;
+  (*path)->num_points = 1;
+  (*path)->cost = 0;
+  for (ii = 0; ii < num_parts; ii++)
+  {
+    memcpy(&((*path)->points[(*path)->num_points]),
+           &(parts[ii]->points[1]),
+           sizeof(DT_PATH_POINT) * (size_t) (parts[ii]->num_points - 1));
+    (*path)->num_points += parts[ii]->num_points - 1;
+    (*path)->cost += parts[ii]->cost;
+  }
+
+EXIT_LABEL:
+
+  for (ii = 0; ii < num_parts; ii++)
+  {
+    dt_destroy_path(parts[ii]);
+  }
+  dt_free(parts);
+  if (NULL != abstract_path)
+  {
+    dt_destroy_abstract_path(abstract_path);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_abstract_path                                         */
+/*                                                                            */
+/* Purpose: Free an abstract path.                                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     abstract_path - The abstract path to free.              */
+/*                                                                            */
+/* Operation: Free the waypoints and then the path.                           */
+/******************************************************************************/
+void dt_destroy_abstract_path(DT_ABSTRACT_PATH *abstract_path)
+{
+  dt_free(abstract_path->waypoints);
+  dt_free(abstract_path);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_hierarchy_memory_usage                               */
+/*                                                                            */
+/* Purpose: Report how much memory a hierarchy is using.                      */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the hierarchy.                  */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*                                                                            */
+/* Operation: Add the entrances and costs of every cluster to the cluster     */
+/*            table, the dirty list and the hierarchy itself.                 */
+/******************************************************************************/
+size_t dt_get_path_hierarchy_memory_usage(DT_PATH_HIERARCHY *hierarchy)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_clusters = (size_t) hierarchy->num_clusters_x *
+                                           (size_t) hierarchy->num_clusters_y;
+  size_t bytes;
+  size_t num_nodes;
+  size_t ii;
+
+  bytes = sizeof(DT_PATH_HIERARCHY) +
+          ((sizeof(DT_PATH_CLUSTER) + sizeof(Uint32)) * num_clusters);
+  for (ii = 0; ii < num_clusters; ii++)
+  {
+    num_nodes = (size_t) hierarchy->clusters[ii].num_nodes;
+    bytes += (sizeof(DT_PATH_CLUSTER_NODE) * num_nodes) +
+             (sizeof(Uint32) * num_nodes * num_nodes);
+  }
+
+  return(bytes);
+}
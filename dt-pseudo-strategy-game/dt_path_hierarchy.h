@@ -0,0 +1,203 @@
+/******************************************************************************/
+/* File: dt_path_hierarchy.h                                                  */
+/*                                                                            */
+/* Purpose: Definitions for hierarchical path search, which finds long paths  */
+/*          across a graph of the entrances between clusters of the grid and  */
+/*          only searches the grid itself for the parts of the path needed.   */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of the hierarchy.                                               */
+/*                                                                            */
+/* DT_PATH_CLUSTER_SHIFT - The log2 of the width and height of a cluster.     */
+/*                         Clusters are the chunks of the grid, so a chunk    */
+/*                         streamed in or out changes only its own cluster    */
+/*                         and the entrances of those around it.              */
+/* DT_PATH_CLUSTER_SIZE - The width and height of a cluster.                  */
+/* DT_PATH_CLUSTER_POINTS - The number of points in a cluster.                */
+/* DT_PATH_MAX_CLUSTER_NODES - The most entrances a cluster can have. Each    */
+/*                             side has at most one for every other point.    */
+/* DT_PATH_MAX_NODE_LINKS - The most neighbouring clusters an entrance can    */
+/*                          lead to. Only a corner point leads to two.        */
+/* DT_PATH_ENTRANCE_SPACING - The most points between the entrances along an  */
+/*                            open stretch of the border between two          */
+/*                            clusters. A stretch no wider than this has one  */
+/*                            entrance in the middle, and a wider one has one */
+/*                            at each end and others evenly between.          */
+/* DT_PATH_NO_CLUSTER_COST - The cost between two points of a cluster which   */
+/*                           cannot be reached from each other within it.     */
+/******************************************************************************/
+#define DT_PATH_CLUSTER_SHIFT DT_GRID_CHUNK_SHIFT
+#define DT_PATH_CLUSTER_SIZE DT_GRID_CHUNK_SIZE
+#define DT_PATH_CLUSTER_POINTS DT_GRID_CHUNK_POINTS
+#define DT_PATH_MAX_CLUSTER_NODES (DT_PATH_CLUSTER_SIZE * 2)
+#define DT_PATH_MAX_NODE_LINKS 2
+#define DT_PATH_ENTRANCE_SPACING 8
+#define DT_PATH_NO_CLUSTER_COST 0xFFFFFFFFu
+
+/******************************************************************************/
+/* Group: DT_PATH_ABSTRACT_PARENTS                                            */
+/*                                                                            */
+/* The parent of a point reached by a search of the abstract graph. Values    */
+/* below DT_PATH_MAX_CLUSTER_NODES are the entrance of the same cluster the   */
+/* point was reached from.                                                    */
+/*                                                                            */
+/* DT_PATH_LINK_PARENT - Added to the direction of the step into the point    */
+/*                       from the entrance of the neighbouring cluster.       */
+/* DT_PATH_START_PARENT - The point was reached straight from the start.      */
+/******************************************************************************/
+#define DT_PATH_LINK_PARENT DT_PATH_MAX_CLUSTER_NODES
+#define DT_PATH_START_PARENT 0xFE
+
+/******************************************************************************/
+/* DT_PATH_CLUSTER_NODE:                                                      */
+/*                                                                            */
+/* An entrance of a cluster, a point on its edge with an open point of the    */
+/* neighbouring cluster beside it.                                            */
+/*                                                                            */
+/* point - The index of the point, numbered row by row as the nodes of a      */
+/*         DT_PATH_SEARCH are.                                                */
+/* num_links - The number of entries used in link_directions.                 */
+/* link_directions - The direction of the step to the entrance of each        */
+/*                   neighbouring cluster the point leads to. One of NORTH,   */
+/*                   EAST, SOUTH and WEST.                                    */
+/******************************************************************************/
+typedef struct dt_path_cluster_node
+{
+  Uint32 point;
+  int num_links;
+  unsigned char link_directions[DT_PATH_MAX_NODE_LINKS];
+} DT_PATH_CLUSTER_NODE;
+
+/******************************************************************************/
+/* DT_PATH_CLUSTER:                                                           */
+/*                                                                            */
+/* The entrances of one cluster and the cost of moving between them without   */
+/* leaving it.                                                                */
+/*                                                                            */
+/* nodes - The entrances.                                                     */
+/* num_nodes - The number of entrances.                                       */
+/* costs - num_nodes by num_nodes costs. costs[(from * num_nodes) + to] is    */
+/*         the cost of the cheapest path between the two inside the cluster,  */
+/*         or DT_PATH_NO_CLUSTER_COST if there is none.                       */
+/* dirty - Set when the costs of the grid in or beside the cluster have       */
+/*         changed since it was built.                                        */
+/******************************************************************************/
+typedef struct dt_path_cluster
+{
+  DT_PATH_CLUSTER_NODE *nodes;
+  int num_nodes;
+  Uint32 *costs;
+  bool dirty;
+} DT_PATH_CLUSTER;
+
+/******************************************************************************/
+/* DT_PATH_HIERARCHY:                                                         */
+/*                                                                            */
+/* The abstract graph of a cost field. Its nodes are the entrances of every   */
+/* cluster, joined by a step to the entrance beside them in the neighbouring  */
+/* cluster and by the precomputed costs to the other entrances of their own   */
+/* cluster. Clusters are rebuilt only when dirty, just before the next search */
+/* which uses the hierarchy.                                                  */
+/*                                                                            */
+/* num_tiles_x - The width of the grid.                                       */
+/* num_tiles_y - The height of the grid.                                      */
+/* num_clusters_x - The number of clusters across the grid.                   */
+/* num_clusters_y - The number of clusters down the grid.                     */
+/* clusters - Every cluster, row by row.                                      */
+/* dirty_clusters - The index of each dirty cluster.                          */
+/* num_dirty_clusters - The number of entries in dirty_clusters.              */
+/* clusters_built - The number of times a cluster has been built, including   */
+/*                  the first time.                                           */
+/******************************************************************************/
+typedef struct dt_path_hierarchy
+{
+  int num_tiles_x;
+  int num_tiles_y;
+  int num_clusters_x;
+  int num_clusters_y;
+  DT_PATH_CLUSTER *clusters;
+  Uint32 *dirty_clusters;
+  int num_dirty_clusters;
+  long clusters_built;
+} DT_PATH_HIERARCHY;
+
+/******************************************************************************/
+/* DT_PATH_CLUSTER_JOB:                                                       */
+/*                                                                            */
+/* One dirty cluster, rebuilt on the master worker pool.                      */
+/*                                                                            */
+/* hierarchy - The hierarchy the cluster belongs to.                          */
+/* field - The cost field of the hierarchy.                                   */
+/* cluster - The index of the cluster.                                        */
+/******************************************************************************/
+typedef struct dt_path_cluster_job
+{
+  struct dt_path_hierarchy *hierarchy;
+  struct dt_cost_field *field;
+  Uint32 cluster;
+} DT_PATH_CLUSTER_JOB;
+
+/******************************************************************************/
+/* DT_PATH_CLUSTER_HEAP:                                                      */
+/*                                                                            */
+/* The open list of a search inside one cluster, a binary heap of the points  */
+/* of the cluster ordered by their cost so far.                               */
+/*                                                                            */
+/* points - The point of the cluster, numbered row by row within it, in each  */
+/*          position of the heap.                                             */
+/* positions - The position of each point in the heap, or                     */
+/*             DT_PATH_CLUSTER_POINTS if it is not in it.                     */
+/* costs - The cost so far of each point.                                     */
+/* num_entries - The number of points in the heap.                            */
+/******************************************************************************/
+typedef struct dt_path_cluster_heap
+{
+  Uint16 points[DT_PATH_CLUSTER_POINTS];
+  Uint16 positions[DT_PATH_CLUSTER_POINTS];
+  Uint32 *costs;
+  int num_entries;
+} DT_PATH_CLUSTER_HEAP;
+
+/******************************************************************************/
+/* DT_ABSTRACT_PATH:                                                          */
+/*                                                                            */
+/* A path found across the abstract graph, before the grid is searched for    */
+/* the steps between its waypoints.                                           */
+/*                                                                            */
+/* waypoints - The start, the entrance by which the path enters each cluster  */
+/*             it crosses and the goal, as the index of the point, numbered   */
+/*             row by row. Each waypoint is in the same cluster as the one    */
+/*             before or just across its border.                              */
+/* num_waypoints - The number of entries in waypoints.                        */
+/* cost - The total cost of the path across the abstract graph. Searching     */
+/*        the grid between the waypoints may find a path a little cheaper.    */
+/******************************************************************************/
+typedef struct dt_abstract_path
+{
+  Uint32 *waypoints;
+  int num_waypoints;
+  Uint32 cost;
+} DT_ABSTRACT_PATH;
+
+/******************************************************************************/
+/* Function: dt_get_path_cluster_index                                        */
+/*                                                                            */
+/* Purpose: Find the cluster holding a point of the grid.                     */
+/*                                                                            */
+/* Returns: The index of the cluster.                                         */
+/*                                                                            */
+/* Parameters: IN     hierarchy - The hierarchy.                              */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Clusters are numbered row by row.                               */
+/******************************************************************************/
+static inline Uint32 dt_get_path_cluster_index(DT_PATH_HIERARCHY *hierarchy,
+                                               int grid_x,
+                                               int grid_y)
+{
+  return(((Uint32) (grid_y >> DT_PATH_CLUSTER_SHIFT) *
+                                        (Uint32) hierarchy->num_clusters_x) +
+         (Uint32) (grid_x >> DT_PATH_CLUSTER_SHIFT));
+}
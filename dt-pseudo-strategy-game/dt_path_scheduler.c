@@ -0,0 +1,360 @@
+/******************************************************************************/
+/* File: dt_path_scheduler.c                                                  */
+/*                                                                            */
+/* Purpose: The path scheduler. Units ask it for paths and are left waiting   */
+/*          while the event loop gives it a little time each frame, so a long */
+/*          search never holds up scrolling or input.                         */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_path_scheduler                                         */
+/*                                                                            */
+/* Purpose: Create a path scheduler for a grid.                               */
+/*                                                                            */
+/* Returns: A pointer to the new scheduler, with no jobs.                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to search.                              */
+/*                                                                            */
+/* Operation: Create the search the jobs will share.                          */
+/******************************************************************************/
+DT_PATH_SCHEDULER *dt_create_path_scheduler(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SCHEDULER *scheduler;
+
+  scheduler = (DT_PATH_SCHEDULER *) dt_malloc(sizeof(DT_PATH_SCHEDULER));
+  scheduler->grid = grid;
+  scheduler->search = dt_create_path_search(grid);
+  scheduler->first_job = NULL;
+  scheduler->last_job = NULL;
+  scheduler->num_jobs = 0;
+  scheduler->searching = false;
+  scheduler->grid_changed = false;
+  scheduler->jobs_finished = 0;
+  scheduler->restarts = 0;
+  scheduler->num_frames = 0;
+  scheduler->total_frame_time_us = 0;
+  scheduler->longest_frame_us = 0;
+
+  return(scheduler);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path_scheduler                                        */
+/*                                                                            */
+/* Purpose: Free a path scheduler and any jobs it still has.                  */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     scheduler - The scheduler to free.                      */
+/*                                                                            */
+/* Operation: Cancel each job, which leaves its unit with no path, then free  */
+/*            the search and the scheduler.                                   */
+/******************************************************************************/
+void dt_destroy_path_scheduler(DT_PATH_SCHEDULER *scheduler)
+{
+  while (NULL != scheduler->first_job)
+  {
+    dt_cancel_unit_path(scheduler->first_job->unit);
+  }
+  dt_destroy_path_search(scheduler->search);
+  dt_free(scheduler);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_path_scheduler                                       */
+/*                                                                            */
+/* Purpose: Find the path scheduler of a grid, creating it the first time.    */
+/*                                                                            */
+/* Returns: A pointer to the path scheduler, which is owned by the grid.      */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*                                                                            */
+/* Operation: Grids no unit asks for a path on never allocate it.             */
+/******************************************************************************/
+DT_PATH_SCHEDULER *dt_get_grid_path_scheduler(DT_GRID *grid)
+{
+  if (NULL == grid->path_scheduler)
+  {
+    grid->path_scheduler = dt_create_path_scheduler(grid);
+  }
+
+  return(grid->path_scheduler);
+}
+
+/******************************************************************************/
+/* Function: dt_request_unit_path                                             */
+/*                                                                            */
+/* Purpose: Ask for the cheapest path for a unit between two points, to be    */
+/*          found over the coming frames.                                     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT scheduler - The path scheduler of the grid.             */
+/*             IN/OUT unit - The unit which is to move. Its path_state is set */
+/*                           to DT_UNIT_PATH_PENDING.                         */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Any path the unit has, or is waiting for, is dropped. The job   */
+/*            goes on the end of the queue. The path is found as dt_find_path */
+/*            would find it, and handed to the unit when it is done.          */
+/******************************************************************************/
+void dt_request_unit_path(DT_PATH_SCHEDULER *scheduler,
+                          DT_UNIT *unit,
+                          int start_x,
+                          int start_y,
+                          int goal_x,
+                          int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_JOB *job;
+
+  dt_cancel_unit_path(unit);
+
+  job = (DT_PATH_JOB *) dt_malloc(sizeof(DT_PATH_JOB));
+  job->scheduler = scheduler;
+  job->unit = unit;
+  job->start_x = start_x;
+  job->start_y = start_y;
+  job->goal_x = goal_x;
+  job->goal_y = goal_y;
+  job->next_job = NULL;
+  if (NULL == scheduler->last_job)
+  {
+    scheduler->first_job = job;
+  }
+  else
+  {
+    scheduler->last_job->next_job = job;
+  }
+  scheduler->last_job = job;
+  (scheduler->num_jobs)++;
+
+  unit->path_job = job;
+  unit->path_state = DT_UNIT_PATH_PENDING;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_cancel_unit_path                                              */
+/*                                                                            */
+/* Purpose: Drop the path of a unit, or the search it is waiting for.         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT unit - The unit. Its path_state is set to               */
+/*                           DT_UNIT_PATH_NONE.                               */
+/*                                                                            */
+/* Operation: A waiting job is unlinked from its queue and freed. If it was   */
+/*            being searched the next job starts its search afresh.           */
+/******************************************************************************/
+void dt_cancel_unit_path(DT_UNIT *unit)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SCHEDULER *scheduler;
+  DT_PATH_JOB *job = unit->path_job;
+  DT_PATH_JOB **link;
+  DT_PATH_JOB *previous = NULL;
+
+  if (NULL != job)
+  {
+    scheduler = job->scheduler;
+    link = &(scheduler->first_job);
+    while (*link != job)
+    {
+      previous = *link;
+      link = &((*link)->next_job);
+    }
+    *link = job->next_job;
+    if (scheduler->last_job == job)
+    {
+      scheduler->last_job = previous;
+    }
+    if (NULL == previous)
+    {
+      scheduler->searching = false;
+    }
+    (scheduler->num_jobs)--;
+    dt_free(job);
+    unit->path_job = NULL;
+  }
+
+  if (NULL != unit->path)
+  {
+    dt_destroy_path(unit->path);
+    unit->path = NULL;
+  }
+  unit->path_state = DT_UNIT_PATH_NONE;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_run_path_scheduler                                            */
+/*                                                                            */
+/* Purpose: Work on the waiting searches for one frame.                       */
+/*                                                                            */
+/* Returns: The number of jobs finished.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT scheduler - The path scheduler.                         */
+/*             IN     max_time_us - The time to spend, in microseconds, or    */
+/*                                  DT_PATH_SCHEDULER_NO_LIMIT.               */
+/*             IN     max_nodes - The most nodes to expand, or                */
+/*                                DT_PATH_SCHEDULER_NO_LIMIT.                 */
+/*                                                                            */
+/* Operation: If the grid has changed the part searched job starts again.     */
+/*            Then search the first job DT_PATH_SCHEDULER_SLICE_NODES nodes   */
+/*            at a time until the budget runs out or no jobs are left. As     */
+/*            each job finishes its unit is given the path, or told there is  */
+/*            none, and the next is started.                                  */
+/******************************************************************************/
+int dt_run_path_scheduler(DT_PATH_SCHEDULER *scheduler,
+                          Uint64 max_time_us,
+                          long max_nodes)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_JOB *job;
+  DT_UNIT *unit;
+  DT_PATH *path = NULL;
+  Uint64 start_time;
+  Uint64 frame_time_us;
+  long nodes_left = max_nodes;
+  long slice_nodes;
+  int jobs_finished = 0;
+  int ret_code;
+
+  start_time = dt_get_time_us();
+  if (scheduler->grid_changed && scheduler->searching)
+  {
+    scheduler->searching = false;
+    (scheduler->restarts)++;
+  }
+  scheduler->grid_changed = false;
+
+  while (NULL != scheduler->first_job)
+  {
+    /**************************************************************************/
+    /* Stop when the budget is spent.                                         */
+    /**************************************************************************/
+    if (((DT_PATH_SCHEDULER_NO_LIMIT != max_nodes) && (0 == nodes_left)) ||
+        ((DT_PATH_SCHEDULER_NO_LIMIT != max_time_us) &&
+         (dt_get_time_us() - start_time >= max_time_us)))
+    {
+      break;
+    }
+
+    job = scheduler->first_job;
+    if (!scheduler->searching)
+    {
+      ret_code = dt_start_path_search(scheduler->search,
+                                      job->unit,
+                                      job->start_x,
+                                      job->start_y,
+                                      job->goal_x,
+                                      job->goal_y);
+      scheduler->searching = true;
+      path = NULL;
+    }
+    else
+    {
+      slice_nodes = DT_PATH_SCHEDULER_SLICE_NODES;
+      if (DT_PATH_SCHEDULER_NO_LIMIT != max_nodes)
+      {
+        slice_nodes = MIN(slice_nodes, nodes_left);
+      }
+      ret_code = dt_continue_path_search(scheduler->search,
+                                         slice_nodes,
+                                         &path);
+      nodes_left -= slice_nodes;
+    }
+    if (DT_PATH_PENDING == ret_code)
+    {
+      continue;
+    }
+
+    /**************************************************************************/
+    /* The job has finished. Hand the unit its path.                          */
+    /**************************************************************************/
+    unit = job->unit;
+    unit->path_job = NULL;
+    unit->path = path;
+    unit->path_state = (DT_PATH_FOUND == ret_code) ? DT_UNIT_PATH_READY :
+                                                     DT_UNIT_PATH_FAILED;
+    scheduler->first_job = job->next_job;
+    if (NULL == scheduler->first_job)
+    {
+      scheduler->last_job = NULL;
+    }
+    (scheduler->num_jobs)--;
+    scheduler->searching = false;
+    dt_free(job);
+    jobs_finished++;
+  }
+
+  frame_time_us = dt_get_time_us() - start_time;
+  (scheduler->num_frames)++;
+  scheduler->jobs_finished += jobs_finished;
+  scheduler->total_frame_time_us += frame_time_us;
+  scheduler->longest_frame_us = MAX(scheduler->longest_frame_us,
+                                    frame_time_us);
+
+  return(jobs_finished);
+}
+
+/******************************************************************************/
+/* Function: dt_has_pending_paths                                             */
+/*                                                                            */
+/* Purpose: Test whether any unit of a grid is waiting for a path.            */
+/*                                                                            */
+/* Returns: true if the grid's path scheduler has a job.                      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*                                                                            */
+/* Operation: A grid with no scheduler has no jobs.                           */
+/******************************************************************************/
+bool dt_has_pending_paths(DT_GRID *grid)
+{
+  return((NULL != grid->path_scheduler) &&
+         (NULL != grid->path_scheduler->first_job));
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_scheduler_memory_usage                               */
+/*                                                                            */
+/* Purpose: Report how much memory a path scheduler is using.                 */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the scheduler.                  */
+/*                                                                            */
+/* Parameters: IN     scheduler - The scheduler.                              */
+/*                                                                            */
+/* Operation: Add the search's arrays and heap and the jobs to the scheduler  */
+/*            itself.                                                         */
+/******************************************************************************/
+size_t dt_get_path_scheduler_memory_usage(DT_PATH_SCHEDULER *scheduler)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SEARCH *search = scheduler->search;
+
+  return(sizeof(DT_PATH_SCHEDULER) +
+         sizeof(DT_PATH_SEARCH) +
+         (((sizeof(Uint32) * 3) + 1) * search->num_states) +
+         ((sizeof(Uint32) + sizeof(Uint64)) * search->heap.size) +
+         (sizeof(DT_PATH_JOB) * (size_t) scheduler->num_jobs));
+}
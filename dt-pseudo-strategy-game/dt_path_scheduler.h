@@ -0,0 +1,85 @@
+/******************************************************************************/
+/* File: dt_path_scheduler.h                                                  */
+/*                                                                            */
+/* Purpose: Definitions for the path scheduler, which runs the path searches  */
+/*          units ask for a slice at a time so that no frame waits for a long */
+/*          one.                                                              */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of the path scheduler.                                          */
+/*                                                                            */
+/* DT_PATH_SCHEDULER_SLICE_NODES - The most nodes expanded between checks of  */
+/*                                 the time. A frame may overrun its time by  */
+/*                                 as long as this many take.                 */
+/* DT_PATH_SCHEDULER_FRAME_TIME_US - The time the event loop gives the        */
+/*                                   scheduler each time round while searches */
+/*                                   are waiting, in microseconds.            */
+/* DT_PATH_SCHEDULER_NO_LIMIT - Passed as a time or node budget to leave that */
+/*                              budget unlimited.                             */
+/******************************************************************************/
+#define DT_PATH_SCHEDULER_SLICE_NODES 256
+#define DT_PATH_SCHEDULER_FRAME_TIME_US 4000
+#define DT_PATH_SCHEDULER_NO_LIMIT 0
+
+/******************************************************************************/
+/* DT_PATH_JOB:                                                               */
+/*                                                                            */
+/* A search waiting to be run, or being run, for a unit.                      */
+/*                                                                            */
+/* scheduler - The scheduler the job is queued on.                            */
+/* unit - The unit which asked for the path.                                  */
+/* start_x - The x coordinate of the start.                                   */
+/* start_y - The y coordinate of the start.                                   */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* next_job - The job queued after this one, or NULL.                         */
+/******************************************************************************/
+typedef struct dt_path_job
+{
+  struct dt_path_scheduler *scheduler;
+  struct dt_unit *unit;
+  int start_x;
+  int start_y;
+  int goal_x;
+  int goal_y;
+  struct dt_path_job *next_job;
+} DT_PATH_JOB;
+
+/******************************************************************************/
+/* DT_PATH_SCHEDULER:                                                         */
+/*                                                                            */
+/* The searches units of a grid are waiting for, run one at a time in the     */
+/* order they were asked for. Only the first job is searched, with the one    */
+/* search the scheduler has, and it keeps its open list from one frame to the */
+/* next until it finishes. A change to the grid while a job is part searched  */
+/* starts it again, as the costs it has found may no longer hold.             */
+/*                                                                            */
+/* grid - The grid searched.                                                  */
+/* search - The search of the first job.                                      */
+/* first_job - The job being searched, or NULL if none is waiting.            */
+/* last_job - The job queued last, or NULL.                                   */
+/* num_jobs - The number of jobs queued.                                      */
+/* searching - Set once the search of the first job has been started.         */
+/* grid_changed - Set when the grid changes, so the first job starts again.   */
+/* jobs_finished - The number of jobs which have finished.                    */
+/* restarts - The number of searches started again after the grid changed.    */
+/* num_frames - The number of times the scheduler has been run.               */
+/* total_frame_time_us - The time taken by every run, in microseconds.        */
+/* longest_frame_us - The time taken by the longest run, in microseconds.     */
+/******************************************************************************/
+typedef struct dt_path_scheduler
+{
+  struct dt_grid *grid;
+  struct dt_path_search *search;
+  DT_PATH_JOB *first_job;
+  DT_PATH_JOB *last_job;
+  int num_jobs;
+  bool searching;
+  bool grid_changed;
+  long jobs_finished;
+  long restarts;
+  long num_frames;
+  Uint64 total_frame_time_us;
+  Uint64 longest_frame_us;
+} DT_PATH_SCHEDULER;
@@ -0,0 +1,318 @@
+/******************************************************************************/
+/* File: dt_path_service.c                                                    */
+/*                                                                            */
+/* Purpose: The path service, which shares out batches of path requests, such */
+/*          as those the AI makes at the start of a turn, between the threads */
+/*          of a worker pool.                                                 */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_path_service                                           */
+/*                                                                            */
+/* Purpose: Create a path service for a grid.                                 */
+/*                                                                            */
+/* Returns: A pointer to the new service.                                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to search.                              */
+/*             IN     pool - The worker pool to run batches on, normally the  */
+/*                           master worker pool.                              */
+/*                                                                            */
+/* Operation: Create a search for each thread which can work on a batch, so   */
+/*            no two jobs ever share one.                                     */
+/******************************************************************************/
+DT_PATH_SERVICE *dt_create_path_service(DT_GRID *grid, DT_WORKER_POOL *pool)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SERVICE *service;
+  int ii;
+
+  service = (DT_PATH_SERVICE *) dt_malloc(sizeof(DT_PATH_SERVICE));
+  service->grid = grid;
+  service->pool = pool;
+  service->num_searches = pool->num_threads + 1;
+  for (ii = 0; ii < service->num_searches; ii++)
+  {
+    service->searches[ii] = dt_create_path_search(grid);
+  }
+  service->lock = SDL_CreateMutex();
+  service->requests = NULL;
+  service->next_request = 0;
+  service->end_request = 0;
+  service->num_batches = 0;
+  service->total_requests = 0;
+  service->total_batch_time_us = 0;
+
+  return(service);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path_service                                          */
+/*                                                                            */
+/* Purpose: Free a path service.                                              */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     service - The service to free. Neither its grid nor its */
+/*                              pool is freed.                                */
+/*                                                                            */
+/* Operation: Free each search, the lock and then the service.                */
+/******************************************************************************/
+void dt_destroy_path_service(DT_PATH_SERVICE *service)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  for (ii = 0; ii < service->num_searches; ii++)
+  {
+    dt_destroy_path_search(service->searches[ii]);
+  }
+  SDL_DestroyMutex(service->lock);
+  dt_free(service);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_solve_path_requests                                           */
+/*                                                                            */
+/* Purpose: Find the path for each of a batch of requests.                    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT service - The path service.                             */
+/*             IN/OUT requests - The requests. The ret_code and path of each  */
+/*                               are filled in.                               */
+/*             IN     num_requests - The number of requests.                  */
+/*                                                                            */
+/* Operation: Searches build the cost field they need if the grid does not    */
+/*            have it, which would write to the grid from several threads, so */
+/*            the fields are built here first. A grid keeps only so many      */
+/*            fields, so the requests are taken in shares which need no more  */
+/*            than that between them. Each share is run as one batch on the   */
+/*            pool with a job for each search. Nothing may change the grid    */
+/*            while a batch runs, and dt_compact_grid_chunks must not be      */
+/*            called from another thread until this returns.                  */
+/******************************************************************************/
+void dt_solve_path_requests(DT_PATH_SERVICE *service,
+                            DT_PATH_REQUEST *requests,
+                            int num_requests)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SERVICE_JOB jobs[DT_PATH_SERVICE_MAX_SEARCHES];
+  Uint64 start_time;
+  int first_request;
+  int ii;
+
+  start_time = dt_get_time_us();
+  for (ii = 0; ii < service->num_searches; ii++)
+  {
+    jobs[ii].service = service;
+    jobs[ii].search = service->searches[ii];
+  }
+
+  service->requests = requests;
+  service->end_request = 0;
+  while (service->end_request < num_requests)
+  {
+    first_request = service->end_request;
+    service->end_request = dt_prepare_path_request_fields(service->grid,
+                                                          requests,
+                                                          first_request,
+                                                          num_requests);
+    service->next_request = first_request;
+    dt_run_worker_pool_jobs(service->pool,
+                            dt_solve_path_requests_job,
+                            jobs,
+                            sizeof(DT_PATH_SERVICE_JOB),
+                            service->num_searches);
+  }
+  service->requests = NULL;
+
+  (service->num_batches)++;
+  service->total_requests += (Uint64) num_requests;
+  service->total_batch_time_us += dt_get_time_us() - start_time;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_prepare_path_request_fields                                   */
+/*                                                                            */
+/* Purpose: Make sure a grid has the cost fields for a share of a batch of    */
+/*          path requests.                                                    */
+/*                                                                            */
+/* Returns: The index after the last request of the share.                    */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid searched.                               */
+/*             IN     requests - The requests.                                */
+/*             IN     first_request - The index of the first request of the   */
+/*                                    share.                                  */
+/*             IN     num_requests - The number of requests.                  */
+/*                                                                            */
+/* Operation: Take requests into the share until one needs a field beyond the */
+/*            most a grid keeps. Then build each field the share needs which  */
+/*            the grid lacks. Building one may drop another the share needs   */
+/*            if the grid was full, so go round again until every field is    */
+/*            there. The fields built each time round are the newest the grid */
+/*            has, so each round drops fewer. Last bring the region map of    */
+/*            each field up to date, as searches ask it first.                */
+/******************************************************************************/
+int dt_prepare_path_request_fields(DT_GRID *grid,
+                                   DT_PATH_REQUEST *requests,
+                                   int first_request,
+                                   int num_requests)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_UNIT *units[DT_GRID_MAX_COST_FIELDS];
+  DT_UNIT *unit;
+  bool missing;
+  int num_units = 0;
+  int end_request;
+  int ii;
+
+  for (end_request = first_request;
+       end_request < num_requests;
+       end_request++)
+  {
+    unit = requests[end_request].unit;
+    for (ii = 0; ii < num_units; ii++)
+    {
+      if ((units[ii]->unit_class == unit->unit_class) &&
+          (units[ii]->speed == unit->speed))
+      {
+        break;
+      }
+    }
+    if (ii == num_units)
+    {
+      if (DT_GRID_MAX_COST_FIELDS == num_units)
+      {
+        break;
+      }
+      units[num_units] = unit;
+      num_units++;
+    }
+  }
+
+  do
+  {
+    missing = false;
+    for (ii = 0; ii < num_units; ii++)
+    {
+      if (NULL == dt_find_grid_cost_field(grid,
+                                          units[ii]->unit_class,
+                                          units[ii]->speed))
+      {
+        missing = true;
+        dt_get_grid_cost_field(grid, units[ii]);
+      }
+    }
+  } while (missing);
+  for (ii = 0; ii < num_units; ii++)
+  {
+    dt_get_region_map(grid,
+                      dt_find_grid_cost_field(grid,
+                                              units[ii]->unit_class,
+                                              units[ii]->speed));
+  }
+
+  return(end_request);
+}
+
+/******************************************************************************/
+/* Function: dt_solve_path_requests_job                                       */
+/*                                                                            */
+/* Purpose: Solve path requests with one search on a worker thread.           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     data - The DT_PATH_SERVICE_JOB.                         */
+/*                                                                            */
+/* Operation: Claim DT_PATH_SERVICE_CLAIM_SIZE requests at a time until none  */
+/*            are left, so a job which draws long searches solves fewer.      */
+/*            Only the claim is locked. Every cost field needed is already    */
+/*            built, and searches look only at the fields and their region    */
+/*            maps, never at the chunks of the grid, so they only read the    */
+/*            grid.                                                           */
+/******************************************************************************/
+void dt_solve_path_requests_job(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SERVICE_JOB *job = (DT_PATH_SERVICE_JOB *) data;
+  DT_PATH_SERVICE *service = job->service;
+  DT_PATH_REQUEST *request;
+  int first_request;
+  int end_request;
+  int ii;
+
+  while (true)
+  {
+    SDL_mutexP(service->lock);
+    first_request = service->next_request;
+    end_request = MIN(first_request + DT_PATH_SERVICE_CLAIM_SIZE,
+                      service->end_request);
+    service->next_request = end_request;
+    SDL_mutexV(service->lock);
+    if (first_request >= end_request)
+    {
+      break;
+    }
+
+    for (ii = first_request; ii < end_request; ii++)
+    {
+      request = &(service->requests[ii]);
+      request->ret_code = dt_find_path(job->search,
+                                       request->unit,
+                                       request->start_x,
+                                       request->start_y,
+                                       request->goal_x,
+                                       request->goal_y,
+                                       &(request->path));
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_service_memory_usage                                 */
+/*                                                                            */
+/* Purpose: Report how much memory a path service is using.                   */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the service, not counting the   */
+/*          paths it has handed back.                                         */
+/*                                                                            */
+/* Parameters: IN     service - The service.                                  */
+/*                                                                            */
+/* Operation: Add the arrays and heap of each search to the service itself.   */
+/******************************************************************************/
+size_t dt_get_path_service_memory_usage(DT_PATH_SERVICE *service)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SEARCH *search;
+  size_t bytes = sizeof(DT_PATH_SERVICE);
+  int ii;
+
+  for (ii = 0; ii < service->num_searches; ii++)
+  {
+    search = service->searches[ii];
+    bytes += sizeof(DT_PATH_SEARCH) +
+             (((sizeof(Uint32) * 3) + 1) * search->num_states) +
+             ((sizeof(Uint32) + sizeof(Uint64)) * search->heap.size);
+  }
+
+  return(bytes);
+}
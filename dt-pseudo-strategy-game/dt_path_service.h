@@ -0,0 +1,101 @@
+/******************************************************************************/
+/* File: dt_path_service.h                                                    */
+/*                                                                            */
+/* Purpose: Definitions for the path service, which solves batches of path    */
+/*          requests on a worker pool.                                        */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of the path service.                                            */
+/*                                                                            */
+/* DT_PATH_SERVICE_MAX_SEARCHES - The most searches a service keeps, one for  */
+/*                                each worker thread of its pool and one for  */
+/*                                the thread which submits a batch.           */
+/* DT_PATH_SERVICE_CLAIM_SIZE - The number of requests a search takes at a    */
+/*                              time. Enough that the lock is rarely waited   */
+/*                              for, few enough that searches finish close    */
+/*                              together.                                     */
+/******************************************************************************/
+#define DT_PATH_SERVICE_MAX_SEARCHES (DT_WORKER_POOL_MAX_THREADS + 1)
+#define DT_PATH_SERVICE_CLAIM_SIZE 8
+
+/******************************************************************************/
+/* DT_PATH_REQUEST:                                                           */
+/*                                                                            */
+/* One path wanted from a batch, and what was found for it.                   */
+/*                                                                            */
+/* unit - The unit which is to move. Its class and speed set the cost of each */
+/*        step and the path starts facing its orientation.                    */
+/* start_x - The x coordinate of the start.                                   */
+/* start_y - The y coordinate of the start.                                   */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* ret_code - Set by the batch to one of DT_PATH_RETURN_CODES.                */
+/* path - Set by the batch to the path found, to be freed with                */
+/*        dt_destroy_path, or NULL if none was found.                         */
+/******************************************************************************/
+typedef struct dt_path_request
+{
+  struct dt_unit *unit;
+  int start_x;
+  int start_y;
+  int goal_x;
+  int goal_y;
+  int ret_code;
+  struct dt_path *path;
+} DT_PATH_REQUEST;
+
+/******************************************************************************/
+/* DT_PATH_SERVICE:                                                           */
+/*                                                                            */
+/* Solves batches of path requests over a grid on a worker pool. Each job of  */
+/* a batch has a search of its own, kept from one batch to the next, and      */
+/* claims requests from the batch a few at a time until none are left. A      */
+/* request's answer is written back into it, so the answers come back in the  */
+/* order they were asked for whichever thread found them, and each is the     */
+/* path dt_find_path would have found. The grid must not change while a batch */
+/* runs.                                                                      */
+/*                                                                            */
+/* grid - The grid searched.                                                  */
+/* pool - The worker pool the batches run on.                                 */
+/* searches - The search of each job.                                         */
+/* num_searches - The number of searches, one more than the threads of the    */
+/*                pool.                                                       */
+/* lock - Protects next_request while a batch runs.                           */
+/* requests - The requests of the current batch.                              */
+/* next_request - The index of the next request to be claimed.                */
+/* end_request - The index after the last request the jobs may claim. A batch */
+/*               needing more cost fields than a grid keeps is run a share at */
+/*               a time, each with its fields built first.                    */
+/* num_batches - The number of batches solved.                                */
+/* total_requests - The number of requests in every batch.                    */
+/* total_batch_time_us - The time taken by every batch, in microseconds.      */
+/******************************************************************************/
+typedef struct dt_path_service
+{
+  struct dt_grid *grid;
+  struct dt_worker_pool *pool;
+  struct dt_path_search *searches[DT_PATH_SERVICE_MAX_SEARCHES];
+  int num_searches;
+  SDL_mutex *lock;
+  DT_PATH_REQUEST *requests;
+  int next_request;
+  int end_request;
+  long num_batches;
+  Uint64 total_requests;
+  Uint64 total_batch_time_us;
+} DT_PATH_SERVICE;
+
+/******************************************************************************/
+/* DT_PATH_SERVICE_JOB:                                                       */
+/*                                                                            */
+/* One job of a batch, which solves requests with its own search.             */
+/*                                                                            */
+/* service - The service running the batch.                                   */
+/* search - The search the job uses.                                          */
+/******************************************************************************/
+typedef struct dt_path_service_job
+{
+  struct dt_path_service *service;
+  struct dt_path_search *search;
+} DT_PATH_SERVICE_JOB;
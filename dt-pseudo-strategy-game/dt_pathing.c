@@ -36,6 +36,49 @@ int dt_cost_move_unit(DT_UNIT *unit, DT_BACKGROUND_TILE *tile)
   return(final_cost);
 }
 
+/******************************************************************************/
+/* Function: dt_cost_move_unit_to_grid_pos                                    */
+/*                                                                            */
+/* Purpose: Calculate the cost of moving a unit onto a grid position.         */
+/*                                                                            */
+/* Returns: The cost as an integer.                                           */
+/*                                                                            */
+/* Parameters: IN     unit - The unit which is to be moved.                   */
+/*             IN     grid - The grid containing the destination.             */
+/*             IN     grid_x - The x coordinate of the destination.           */
+/*             IN     grid_y - The y coordinate of the destination.           */
+/*                                                                            */
+/* Operation: As dt_cost_move_unit but the terrain type and movement modifier */
+/*            are read from the grid layers rather than from the tile, so     */
+/*            the background tile itself is never touched.                    */
+/******************************************************************************/
+int dt_cost_move_unit_to_grid_pos(DT_UNIT *unit,
+                                  DT_GRID *grid,
+                                  int grid_x,
+                                  int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int cost_unit_class_tile_type;
+  int final_cost;
+
+  /****************************************************************************/
+  /* Read the terrain values for the destination from the layers.             */
+  /****************************************************************************/
+  cost_unit_class_tile_type = dt_cost_unit_class_tile_type(unit->unit_class,
+                                dt_get_grid_terrain_type(grid, grid_x, grid_y));
+
+  /****************************************************************************/
+  /* Combine the costs in the same way as dt_cost_move_unit.                  */
+  /****************************************************************************/
+  final_cost = (cost_unit_class_tile_type +
+                dt_get_grid_movement_modifier(grid, grid_x, grid_y))
+                                                                  / unit->speed;
+
+  return(final_cost);
+}
+
 /******************************************************************************/
 /* Function: dt_cost_turn_unit                                                */
 /*                                                                            */
@@ -74,15 +117,20 @@ int dt_cost_turn_unit(DT_UNIT *unit, DT_ORIENTATION direction)
 }
 
 /******************************************************************************/
-/* Function:                                                                  */
+/* Function: dt_cost_unit_class_tile_type                                     */
 /*                                                                            */
-/* Purpose:                                                                   */
+/* Purpose: Find the cost for a unit of a class to move onto a terrain type.  */
 /*                                                                            */
-/* Returns:                                                                   */
+/* Returns: The cost as an integer.                                           */
 /*                                                                            */
-/* Parameters:                                                                */
+/* Parameters: IN     unit_class - The class of the unit. One of              */
+/*                                 DT_UNIT_CLASSES.                           */
+/*             IN     terrain_type - The terrain type of the destination. One */
+/*                                   of DT_GROUND_TYPES.                      */
 /*                                                                            */
-/* Operation:                                                                 */
+/* Operation: Look the cost up in a constant table of DT_TERRAIN_COSTS with a */
+/*            row for each class. An unknown class costs the same as a normal */
+/*            unit and an unknown terrain type the same as a plain.           */
 /******************************************************************************/
 int dt_cost_unit_class_tile_type(int unit_class,
                                  int terrain_type)
@@ -90,11 +138,1755 @@ int dt_cost_unit_class_tile_type(int unit_class,
   /****************************************************************************/
   /* Local Variables.                                                         */
   /****************************************************************************/
-  int answer;
+  static const int costs[DT_NUM_UNIT_CLASSES][DT_NUM_GROUND_TYPES] =
+  {
+    {DT_TERRAIN_COST_PLAIN,
+     DT_TERRAIN_COST_SWAMP,
+     DT_TERRAIN_COST_MOUNTAIN,
+     DT_TERRAIN_COST_RIVER},
+    {DT_VEHICLE_TERRAIN_COST_PLAIN,
+     DT_VEHICLE_TERRAIN_COST_SWAMP,
+     DT_VEHICLE_TERRAIN_COST_MOUNTAIN,
+     DT_VEHICLE_TERRAIN_COST_RIVER}
+  };
+  int class_index = DT_UNIT_CLASS_INDEX(unit_class);
 
+  if (class_index >= DT_NUM_UNIT_CLASSES)
+  {
+    class_index = DT_UNIT_CLASS_INDEX(DT_UNIT_CLASS_NORMAL);
+  }
+  if ((terrain_type < 0) || (terrain_type >= DT_NUM_GROUND_TYPES))
+  {
+    terrain_type = DT_GROUND_TYPE_PLAIN;
+  }
+
+  return(costs[class_index][terrain_type]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_min_move_cost                                             */
+/*                                                                            */
+/* Purpose: Find the least a unit can pay to move onto any point.             */
+/*                                                                            */
+/* Returns: The cost as an integer, at least 1.                               */
+/*                                                                            */
+/* Parameters: IN     unit - The unit which is to be moved.                   */
+/*                                                                            */
+/* Operation: Take the cheapest terrain type for the class of the unit with   */
+/*            no movement modifier. As modifiers are never negative no point  */
+/*            can cost less, so this times the octile distance never          */
+/*            overestimates the cost of a path.                               */
+/******************************************************************************/
+int dt_get_min_move_cost(DT_UNIT *unit)
+{
   /****************************************************************************/
+  /* Local Variables.                                                         */
   /****************************************************************************/
+  int min_cost = INT_MAX;
+  int terrain_type;
 
+  for (terrain_type = 0; terrain_type < DT_NUM_GROUND_TYPES; terrain_type++)
+  {
+    min_cost = MIN(min_cost,
+                   dt_cost_unit_class_tile_type(unit->unit_class,
+                                                terrain_type) / unit->speed);
+  }
 
-  return(answer);
+  return(MAX(min_cost, 1));
+}
+
+/******************************************************************************/
+/* Function: dt_get_octile_distance                                           */
+/*                                                                            */
+/* Purpose: Find the number of step units between two points when moving in   */
+/*          the 8 DT_VIEW_ORIENTATIONS.                                       */
+/*                                                                            */
+/* Returns: The distance in the units of DT_PATH_STRAIGHT_STEP.               */
+/*                                                                            */
+/* Parameters: IN     delta_x - The difference between the x coordinates.     */
+/*             IN     delta_y - The difference between the y coordinates.     */
+/*                                                                            */
+/* Operation: Take diagonal steps until one coordinate matches and straight   */
+/*            steps for the rest.                                             */
+/******************************************************************************/
+Uint32 dt_get_octile_distance(int delta_x, int delta_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 distance_x = (Uint32) abs(delta_x);
+  Uint32 distance_y = (Uint32) abs(delta_y);
+
+  return((DT_PATH_STRAIGHT_STEP * MAX(distance_x, distance_y)) +
+         ((DT_PATH_DIAGONAL_STEP - DT_PATH_STRAIGHT_STEP) *
+                                               MIN(distance_x, distance_y)));
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_estimate                                             */
+/*                                                                            */
+/* Purpose: Estimate the cost of the cheapest path from a point to a goal.    */
+/*                                                                            */
+/* Returns: The estimate, which is never more than the cost.                  */
+/*                                                                            */
+/* Parameters: IN     search - The search.                                    */
+/*             IN     field - The cost field of the search.                   */
+/*             IN     min_cost - The least a step onto a point can cost, per  */
+/*                               straight step.                               */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: The octile distance times the least cost, raised to the         */
+/*            estimate from the landmarks the search chose, as long as they   */
+/*            are still the field's and up to date. A search run in slices    */
+/*            may outlive the landmarks it chose, or even its field, so the   */
+/*            field's landmarks must have the serial number the search kept   */
+/*            as well as its address. The search's own pointer is not read.   */
+/******************************************************************************/
+Uint32 dt_get_path_estimate(DT_PATH_SEARCH *search,
+                            DT_COST_FIELD *field,
+                            Uint32 min_cost,
+                            int grid_x,
+                            int grid_y,
+                            int goal_x,
+                            int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 estimate;
+  Uint32 landmark_estimate;
+  Uint32 width = (Uint32) search->grid->num_tiles_x;
+
+  estimate = min_cost * dt_get_octile_distance(goal_x - grid_x,
+                                               goal_y - grid_y);
+  if ((NULL != search->landmarks) &&
+      (search->landmarks == field->landmarks) &&
+      (search->landmark_serial == field->landmarks->serial) &&
+      !field->landmarks->stale)
+  {
+    landmark_estimate = dt_get_landmark_estimate(
+                      field->landmarks,
+                      search->landmark_tables,
+                      search->num_landmark_tables,
+                      ((Uint32) grid_y * width) + (Uint32) grid_x,
+                      ((Uint32) goal_y * width) + (Uint32) goal_x);
+    estimate = MAX(estimate, landmark_estimate);
+  }
+
+  return(estimate);
+}
+
+/******************************************************************************/
+/* Function: dt_get_grid_cost_field                                           */
+/*                                                                            */
+/* Purpose: Find the cost field of a grid for a unit, building it if the grid */
+/*          does not have one yet.                                            */
+/*                                                                            */
+/* Returns: A pointer to the cost field, which is owned by the grid.          */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid.                                        */
+/*             IN     unit - The unit. Units of the same class and speed      */
+/*                           share a field.                                   */
+/*                                                                            */
+/* Operation: Look through the fields the grid has. If none matches and the   */
+/*            grid has DT_GRID_MAX_COST_FIELDS, drop the oldest to make room  */
+/*            for a new one. Building a field writes to the grid, so searches */
+/*            run on several threads at once must have their fields built     */
+/*            before they start.                                              */
+/******************************************************************************/
+DT_COST_FIELD *dt_get_grid_cost_field(DT_GRID *grid, DT_UNIT *unit)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COST_FIELD *field;
+
+  field = dt_find_grid_cost_field(grid, unit->unit_class, unit->speed);
+  if (NULL != field)
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Make room for a new field and build it.                                  */
+  /****************************************************************************/
+  if (DT_GRID_MAX_COST_FIELDS == grid->num_cost_fields)
+  {
+    dt_destroy_cost_field(grid->cost_fields[0]);
+    (grid->num_cost_fields)--;
+    memmove(&(grid->cost_fields[0]),
+            &(grid->cost_fields[1]),
+            sizeof(DT_COST_FIELD *) * (size_t) grid->num_cost_fields);
+  }
+  field = dt_create_cost_field(grid, unit->unit_class, unit->speed);
+  grid->cost_fields[grid->num_cost_fields] = field;
+  (grid->num_cost_fields)++;
+
+EXIT_LABEL:
+
+  return(field);
+}
+
+/******************************************************************************/
+/* Function: dt_find_grid_cost_field                                          */
+/*                                                                            */
+/* Purpose: Find the cost field a grid already has for units of a class and   */
+/*          speed.                                                            */
+/*                                                                            */
+/* Returns: A pointer to the cost field, or NULL if the grid has none.        */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN     unit_class - The class of the units. One of             */
+/*                                 DT_UNIT_CLASSES.                           */
+/*             IN     speed - The speed of the units.                         */
+/*                                                                            */
+/* Operation: Look through the fields the grid has. Nothing is built, so this */
+/*            only reads the grid.                                            */
+/******************************************************************************/
+DT_COST_FIELD *dt_find_grid_cost_field(DT_GRID *grid, int unit_class, int speed)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COST_FIELD *field = NULL;
+  int ii;
+
+  for (ii = 0; ii < grid->num_cost_fields; ii++)
+  {
+    if ((grid->cost_fields[ii]->unit_class == unit_class) &&
+        (grid->cost_fields[ii]->speed == speed))
+    {
+      field = grid->cost_fields[ii];
+      break;
+    }
+  }
+
+  return(field);
+}
+
+/******************************************************************************/
+/* Function: dt_create_cost_field                                             */
+/*                                                                            */
+/* Purpose: Build the cost field of a grid for units of a class and speed.    */
+/*                                                                            */
+/* Returns: A pointer to the new cost field.                                  */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN     unit_class - The class of the units. One of             */
+/*                                 DT_UNIT_CLASSES.                           */
+/*             IN     speed - The speed of the units.                         */
+/*                                                                            */
+/* Operation: Allocate the costs and bitmaps with the border already blocked, */
+/*            work out the offset of each direction and fill in every point.  */
+/******************************************************************************/
+DT_COST_FIELD *dt_create_cost_field(DT_GRID *grid, int unit_class, int speed)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_COST_FIELD *field;
+  size_t num_words;
+  int direction;
+
+  field = (DT_COST_FIELD *) dt_malloc(sizeof(DT_COST_FIELD));
+  field->unit_class = unit_class;
+  field->speed = speed;
+  field->width = grid->num_tiles_x + 2;
+  for (direction = NORTH; direction < NORTH_1; direction++)
+  {
+    field->offsets[direction] =
+                  ((long) dt_get_orientation_step_y(direction) *
+                                                        (long) field->width) +
+                  (long) dt_get_orientation_step_x(direction);
+  }
+  field->costs = (Uint16 *) dt_calloc((size_t) field->width *
+                                              (size_t) (grid->num_tiles_y + 2),
+                                      sizeof(Uint16));
+  field->uniform_cost = (Uint16) MAX(dt_cost_unit_class_tile_type(unit_class,
+                                                  DT_GROUND_TYPE_PLAIN) / speed,
+                                     1);
+  field->words_per_row = ((grid->num_tiles_x + DT_COST_FIELD_BIT_BORDER) >>
+                                                      DT_GRID_WORD_SHIFT) + 2;
+  num_words = (size_t) field->words_per_row * (size_t) (grid->num_tiles_y + 2);
+  field->uniform = (Uint32 *) dt_calloc(num_words, sizeof(Uint32));
+  field->interior = (Uint32 *) dt_calloc(num_words, sizeof(Uint32));
+  field->words_per_column = ((grid->num_tiles_y + DT_COST_FIELD_BIT_BORDER) >>
+                                                      DT_GRID_WORD_SHIFT) + 2;
+  num_words = (size_t) field->words_per_column *
+                                             (size_t) (grid->num_tiles_x + 2);
+  field->uniform_columns = (Uint32 *) dt_calloc(num_words, sizeof(Uint32));
+  field->interior_columns = (Uint32 *) dt_calloc(num_words, sizeof(Uint32));
+  field->hierarchy = NULL;
+  field->regions = NULL;
+  field->landmarks = NULL;
+  dt_fill_cost_field(field,
+                     grid,
+                     0,
+                     0,
+                     grid->num_tiles_x - 1,
+                     grid->num_tiles_y - 1);
+
+  return(field);
+}
+
+/******************************************************************************/
+/* Function: dt_fill_cost_field                                               */
+/*                                                                            */
+/* Purpose: Work out the costs of an area of a cost field from the grid.      */
+/*                                                                            */
+/* Returns: true if any point of the area was opened or made cheaper.         */
+/*                                                                            */
+/* Parameters: IN/OUT field - The cost field.                                 */
+/*             IN     grid - The grid the field is for.                       */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Each point which may be entered costs as                        */
+/*            dt_cost_move_unit_to_grid_pos, but at least 1 so that it can    */
+/*            never be mistaken for a blocked point and no step is free. Then */
+/*            set the bitmap bits for the area and the points around it, as   */
+/*            whether a point is interior depends on its neighbours.          */
+/******************************************************************************/
+bool dt_fill_cost_field(DT_COST_FIELD *field,
+                        DT_GRID *grid,
+                        int first_x,
+                        int first_y,
+                        int last_x,
+                        int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint16 *costs;
+  Uint32 *uniform_row;
+  Uint32 *interior_row;
+  Uint32 *uniform_column;
+  Uint32 *interior_column;
+  Uint32 bit;
+  Uint32 column_bit;
+  long index;
+  int cost;
+  int grid_x;
+  int grid_y;
+  int position;
+  int column_position;
+  int direction;
+  bool interior;
+  bool lowered = false;
+
+  for (grid_y = first_y; grid_y <= last_y; grid_y++)
+  {
+    costs = &(field->costs[dt_get_cost_field_index(field, 0, grid_y)]);
+    for (grid_x = first_x; grid_x <= last_x; grid_x++)
+    {
+      if (!dt_is_grid_traversable(grid, grid_x, grid_y))
+      {
+        costs[grid_x] = DT_COST_FIELD_BLOCKED;
+        continue;
+      }
+      cost = (dt_cost_unit_class_tile_type(field->unit_class,
+                                           dt_get_grid_terrain_type(grid,
+                                                                    grid_x,
+                                                                    grid_y)) +
+              dt_get_grid_movement_modifier(grid, grid_x, grid_y)) /
+                                                                   field->speed;
+      cost = CLAMP(cost, 1, 0xFFFF);
+      if ((DT_COST_FIELD_BLOCKED == costs[grid_x]) || (cost < costs[grid_x]))
+      {
+        lowered = true;
+      }
+      costs[grid_x] = (Uint16) cost;
+    }
+  }
+
+  /****************************************************************************/
+  /* Set the uniform and interior bits by row and column from the costs.      */
+  /****************************************************************************/
+  for (grid_y = MAX(first_y - 1, 0);
+       grid_y <= MIN(last_y + 1, grid->num_tiles_y - 1);
+       grid_y++)
+  {
+    uniform_row = dt_get_cost_field_bit_row(field, field->uniform, grid_y);
+    interior_row = dt_get_cost_field_bit_row(field, field->interior, grid_y);
+    for (grid_x = MAX(first_x - 1, 0);
+         grid_x <= MIN(last_x + 1, grid->num_tiles_x - 1);
+         grid_x++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      interior = (field->uniform_cost == field->costs[index]);
+      for (direction = NORTH; interior && (direction < NORTH_1); direction++)
+      {
+        cost = field->costs[index + field->offsets[direction]];
+        interior = (DT_COST_FIELD_BLOCKED == cost) ||
+                   (field->uniform_cost == cost);
+      }
+      uniform_column = dt_get_cost_field_bit_column(field,
+                                                    field->uniform_columns,
+                                                    grid_x);
+      interior_column = dt_get_cost_field_bit_column(field,
+                                                     field->interior_columns,
+                                                     grid_x);
+      position = grid_x + DT_COST_FIELD_BIT_BORDER;
+      bit = 1u << (position & DT_GRID_WORD_MASK);
+      position >>= DT_GRID_WORD_SHIFT;
+      column_position = grid_y + DT_COST_FIELD_BIT_BORDER;
+      column_bit = 1u << (column_position & DT_GRID_WORD_MASK);
+      column_position >>= DT_GRID_WORD_SHIFT;
+      uniform_row[position] &= ~bit;
+      interior_row[position] &= ~bit;
+      uniform_column[column_position] &= ~column_bit;
+      interior_column[column_position] &= ~column_bit;
+      if (field->uniform_cost == field->costs[index])
+      {
+        uniform_row[position] |= bit;
+        uniform_column[column_position] |= column_bit;
+      }
+      if (interior)
+      {
+        interior_row[position] |= bit;
+        interior_column[column_position] |= column_bit;
+      }
+    }
+  }
+
+  return(lowered);
+}
+
+/******************************************************************************/
+/* Function: dt_update_grid_cost_fields                                       */
+/*                                                                            */
+/* Purpose: Bring the cost fields of a grid up to date after an area of it    */
+/*          has changed.                                                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Clip the area to the grid and fill it in again in every field.  */
+/*            This costs nothing for a grid which has never been searched.    */
+/*            The clusters of a field's hierarchy which touch the area or the */
+/*            points around it are marked to be rebuilt, as the entrances of  */
+/*            a cluster depend on the points just outside it, and a field's   */
+/*            region map follows any points which have opened or closed. A    */
+/*            field's landmarks are marked stale if any point was opened or   */
+/*            made cheaper, but not for costs which were only raised, as they */
+/*            still never overestimate. The flow fields of the grid are       */
+/*            marked stale. Path caches, replanners and the path scheduler    */
+/*            are told of the change.                                         */
+/******************************************************************************/
+void dt_update_grid_cost_fields(DT_GRID *grid,
+                                int first_x,
+                                int first_y,
+                                int last_x,
+                                int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  first_x = MAX(first_x, 0);
+  first_y = MAX(first_y, 0);
+  last_x = MIN(last_x, grid->num_tiles_x - 1);
+  last_y = MIN(last_y, grid->num_tiles_y - 1);
+  for (ii = 0; ii < grid->num_cost_fields; ii++)
+  {
+    if (dt_fill_cost_field(grid->cost_fields[ii],
+                           grid,
+                           first_x,
+                           first_y,
+                           last_x,
+                           last_y) &&
+        (NULL != grid->cost_fields[ii]->landmarks))
+    {
+      grid->cost_fields[ii]->landmarks->stale = true;
+    }
+    if (NULL != grid->cost_fields[ii]->hierarchy)
+    {
+      dt_mark_path_hierarchy_dirty(grid->cost_fields[ii]->hierarchy,
+                                   first_x - 1,
+                                   first_y - 1,
+                                   last_x + 1,
+                                   last_y + 1);
+    }
+    if (NULL != grid->cost_fields[ii]->regions)
+    {
+      dt_update_region_map(grid->cost_fields[ii]->regions,
+                           grid->cost_fields[ii],
+                           first_x,
+                           first_y,
+                           last_x,
+                           last_y);
+    }
+  }
+  dt_mark_grid_flow_fields_stale(grid);
+  if (NULL != grid->path_cache)
+  {
+    dt_invalidate_path_cache(grid->path_cache,
+                             first_x - 1,
+                             first_y - 1,
+                             last_x + 1,
+                             last_y + 1);
+  }
+  dt_mark_grid_replanners_changed(grid, first_x, first_y, last_x, last_y);
+  if (NULL != grid->path_scheduler)
+  {
+    grid->path_scheduler->grid_changed = true;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_update_grid_cost_fields_for_chunk                             */
+/*                                                                            */
+/* Purpose: Bring the cost fields of a chunked grid up to date after one of   */
+/*          its chunks has been replaced.                                     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The chunked grid.                                */
+/*             IN     index - The index of the chunk in the chunk table.      */
+/*                                                                            */
+/* Operation: Update the area of the grid covered by the chunk.               */
+/******************************************************************************/
+void dt_update_grid_cost_fields_for_chunk(DT_GRID *grid, size_t index)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int first_x;
+  int first_y;
+
+  first_x = (int) (index % (size_t) grid->num_chunks_x) << DT_GRID_CHUNK_SHIFT;
+  first_y = (int) (index / (size_t) grid->num_chunks_x) << DT_GRID_CHUNK_SHIFT;
+  dt_update_grid_cost_fields(grid,
+                             first_x,
+                             first_y,
+                             first_x + DT_GRID_CHUNK_SIZE - 1,
+                             first_y + DT_GRID_CHUNK_SIZE - 1);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_cost_field                                            */
+/*                                                                            */
+/* Purpose: Free a cost field.                                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     field - The cost field to free.                         */
+/*                                                                            */
+/* Operation: Free the costs, bitmaps, hierarchy, region map and landmarks    */
+/*            and then the field.                                             */
+/******************************************************************************/
+void dt_destroy_cost_field(DT_COST_FIELD *field)
+{
+  if (NULL != field->hierarchy)
+  {
+    dt_destroy_path_hierarchy(field->hierarchy);
+  }
+  if (NULL != field->regions)
+  {
+    dt_destroy_region_map(field->regions);
+  }
+  if (NULL != field->landmarks)
+  {
+    dt_destroy_landmarks(field->landmarks);
+  }
+  dt_free(field->costs);
+  dt_free(field->uniform);
+  dt_free(field->interior);
+  dt_free(field->uniform_columns);
+  dt_free(field->interior_columns);
+  dt_free(field);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_memory_usage                                   */
+/*                                                                            */
+/* Purpose: Report how much memory a cost field is using.                     */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the field.                      */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     grid - The grid the field is for.                       */
+/*                                                                            */
+/* Operation: Add the costs and the bitmaps by row, each of which has a       */
+/*            border row above and below the grid, and the bitmaps by column, */
+/*            which have a border column either side, and the hierarchy,      */
+/*            region map and landmarks if there are any, to the field itself. */
+/******************************************************************************/
+size_t dt_get_cost_field_memory_usage(DT_COST_FIELD *field, DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t bytes;
+
+  bytes = sizeof(DT_COST_FIELD) +
+          (((sizeof(Uint16) * (size_t) field->width) +
+            (sizeof(Uint32) * 2 * (size_t) field->words_per_row)) *
+                                            (size_t) (grid->num_tiles_y + 2)) +
+          (sizeof(Uint32) * 2 * (size_t) field->words_per_column *
+                                            (size_t) (grid->num_tiles_x + 2));
+  if (NULL != field->hierarchy)
+  {
+    bytes += dt_get_path_hierarchy_memory_usage(field->hierarchy);
+  }
+  if (NULL != field->regions)
+  {
+    bytes += dt_get_region_map_memory_usage(field->regions);
+  }
+  if (NULL != field->landmarks)
+  {
+    bytes += dt_get_landmarks_memory_usage(field->landmarks);
+  }
+
+  return(bytes);
+}
+
+/******************************************************************************/
+/* Function: dt_create_path_search                                            */
+/*                                                                            */
+/* Purpose: Create the state used to search a grid for paths which ignore     */
+/*          the way units face.                                               */
+/*                                                                            */
+/* Returns: A pointer to the new search.                                      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to be searched.                         */
+/*                                                                            */
+/* Operation: Create a search with one state per node.                        */
+/******************************************************************************/
+DT_PATH_SEARCH *dt_create_path_search(DT_GRID *grid)
+{
+  return(dt_create_path_search_with_orientation(grid, false));
+}
+
+/******************************************************************************/
+/* Function: dt_create_path_search_with_orientation                           */
+/*                                                                            */
+/* Purpose: Create the state used to search a grid for paths.                 */
+/*                                                                            */
+/* Returns: A pointer to the new search.                                      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to be searched.                         */
+/*             IN     oriented - Whether the search is to find oriented       */
+/*                               paths rather than plain ones. It needs       */
+/*                               eight times the memory.                      */
+/*                                                                            */
+/* Operation: Create a search with a state for each node, or for each node    */
+/*            and orientation.                                                */
+/******************************************************************************/
+DT_PATH_SEARCH *dt_create_path_search_with_orientation(DT_GRID *grid,
+                                                       bool oriented)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int states_per_node = oriented ? NORTH_1 : 1;
+
+  return(dt_create_path_search_with_states(grid,
+                                           states_per_node,
+                                           (size_t) grid->num_tiles_x *
+                                           (size_t) grid->num_tiles_y *
+                                           (size_t) states_per_node));
+}
+
+/******************************************************************************/
+/* Function: dt_create_path_search_with_states                                */
+/*                                                                            */
+/* Purpose: Create the state used to search a grid, with a given number of    */
+/*          states.                                                           */
+/*                                                                            */
+/* Returns: A pointer to the new search.                                      */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to be searched.                         */
+/*             IN     states_per_node - 1 for a plain search or NORTH_1 for   */
+/*                                      an oriented one.                      */
+/*             IN     num_states - The number of states. Searches whose       */
+/*                                 states are not the nodes of the grid, such */
+/*                                 as those through time, give their own.     */
+/*                                                                            */
+/* Operation: Allocate the per state arrays once. The generations start at    */
+/*            zero and the first search is generation one, so no state starts */
+/*            as reached. Work out the node offset of each direction.         */
+/******************************************************************************/
+DT_PATH_SEARCH *dt_create_path_search_with_states(DT_GRID *grid,
+                                                  int states_per_node,
+                                                  size_t num_states)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_SEARCH *search;
+  int direction;
+
+  search = (DT_PATH_SEARCH *) dt_malloc(sizeof(DT_PATH_SEARCH));
+  search->grid = grid;
+  search->num_nodes = (size_t) grid->num_tiles_x * (size_t) grid->num_tiles_y;
+  search->states_per_node = states_per_node;
+  search->num_states = num_states;
+  for (direction = NORTH; direction < NORTH_1; direction++)
+  {
+    search->node_offsets[direction] =
+                  ((long) dt_get_orientation_step_y(direction) *
+                                                     (long) grid->num_tiles_x) +
+                  (long) dt_get_orientation_step_x(direction);
+  }
+  search->generation = (Uint32 *) dt_calloc(search->num_states,
+                                            sizeof(Uint32));
+  search->current_generation = 0;
+  search->cost = (Uint32 *) dt_malloc(sizeof(Uint32) * search->num_states);
+  search->parent = (unsigned char *) dt_malloc(search->num_states);
+  search->heap_index = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                            search->num_states);
+  search->heap.size = DT_PATH_HEAP_INITIAL_SIZE;
+  search->heap.nodes = (Uint32 *) dt_malloc(sizeof(Uint32) * search->heap.size);
+  search->heap.keys = (Uint64 *) dt_malloc(sizeof(Uint64) * search->heap.size);
+  search->heap.num_entries = 0;
+  search->landmarks = NULL;
+  search->landmark_serial = 0;
+  search->num_landmark_tables = 0;
+  search->nodes_expanded = 0;
+  search->num_searches = 0;
+  search->total_nodes_expanded = 0;
+  search->total_search_time_us = 0;
+
+  return(search);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path_search                                           */
+/*                                                                            */
+/* Purpose: Free the state used to search a grid for paths.                   */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     search - The search to free. The grid is not freed.     */
+/*                                                                            */
+/* Operation: Free each array and then the search.                            */
+/******************************************************************************/
+void dt_destroy_path_search(DT_PATH_SEARCH *search)
+{
+  dt_free(search->generation);
+  dt_free(search->cost);
+  dt_free(search->parent);
+  dt_free(search->heap_index);
+  dt_free(search->heap.nodes);
+  dt_free(search->heap.keys);
+  dt_free(search);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_begin_path_search                                             */
+/*                                                                            */
+/* Purpose: Forget the previous search so a new one can start.                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*                                                                            */
+/* Operation: Move to the next generation, which leaves every node unreached, */
+/*            and empty the open list. Only when the generation wraps round   */
+/*            to zero are the generations cleared. No landmarks are used      */
+/*            until the new search chooses them.                              */
+/******************************************************************************/
+void dt_begin_path_search(DT_PATH_SEARCH *search)
+{
+  (search->current_generation)++;
+  if (0 == search->current_generation)
+  {
+    memset(search->generation, 0, sizeof(Uint32) * search->num_states);
+    search->current_generation = 1;
+  }
+  search->heap.num_entries = 0;
+  search->landmarks = NULL;
+  search->landmark_serial = 0;
+  search->num_landmark_tables = 0;
+  search->nodes_expanded = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_push_path_heap                                                */
+/*                                                                            */
+/* Purpose: Add a node to the open list.                                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     node - The node to add. It must not be in the list.     */
+/*             IN     key - The key of the node.                              */
+/*                                                                            */
+/* Operation: Double the heap if it is full, put the node at the end and sift */
+/*            it up.                                                          */
+/******************************************************************************/
+void dt_push_path_heap(DT_PATH_SEARCH *search, Uint32 node, Uint64 key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(search->heap);
+  Uint32 *nodes;
+  Uint64 *keys;
+
+  if (heap->num_entries == heap->size)
+  {
+    nodes = (Uint32 *) dt_malloc(sizeof(Uint32) * heap->size * 2);
+    keys = (Uint64 *) dt_malloc(sizeof(Uint64) * heap->size * 2);
+    memcpy(nodes, heap->nodes, sizeof(Uint32) * heap->num_entries);
+    memcpy(keys, heap->keys, sizeof(Uint64) * heap->num_entries);
+    dt_free(heap->nodes);
+    dt_free(heap->keys);
+    heap->nodes = nodes;
+    heap->keys = keys;
+    heap->size *= 2;
+  }
+
+  heap->nodes[heap->num_entries] = node;
+  heap->keys[heap->num_entries] = key;
+  search->heap_index[node] = (Uint32) heap->num_entries;
+  (heap->num_entries)++;
+  dt_sift_path_heap_up(search, heap->num_entries - 1);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_pop_path_heap                                                 */
+/*                                                                            */
+/* Purpose: Take the node with the lowest key off the open list.              */
+/*                                                                            */
+/* Returns: The node. The list must not be empty.                             */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*                                                                            */
+/* Operation: Take the node from the top, mark it closed, move the last node  */
+/*            to the top and sift it down.                                    */
+/******************************************************************************/
+Uint32 dt_pop_path_heap(DT_PATH_SEARCH *search)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(search->heap);
+  Uint32 node = heap->nodes[0];
+
+  search->heap_index[node] = DT_PATH_CLOSED;
+  (heap->num_entries)--;
+  if (heap->num_entries > 0)
+  {
+    heap->nodes[0] = heap->nodes[heap->num_entries];
+    heap->keys[0] = heap->keys[heap->num_entries];
+    search->heap_index[heap->nodes[0]] = 0;
+    dt_sift_path_heap_down(search, 0);
+  }
+
+  return(node);
+}
+
+/******************************************************************************/
+/* Function: dt_decrease_path_heap_key                                        */
+/*                                                                            */
+/* Purpose: Lower the key of a node on the open list.                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     node - The node, which must be in the list.             */
+/*             IN     key - The new key, which must not be higher.            */
+/*                                                                            */
+/* Operation: Find the node from its heap index, change its key and sift it   */
+/*            up.                                                             */
+/******************************************************************************/
+void dt_decrease_path_heap_key(DT_PATH_SEARCH *search, Uint32 node, Uint64 key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t position = search->heap_index[node];
+
+  search->heap.keys[position] = key;
+  dt_sift_path_heap_up(search, position);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_sift_path_heap_up                                             */
+/*                                                                            */
+/* Purpose: Move an entry of the open list up until its parent's key is no    */
+/*          higher.                                                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     position - The position of the entry.                   */
+/*                                                                            */
+/* Operation: Move each parent with a higher key down into the hole and put   */
+/*            the entry where the hole ends up, keeping heap_index in step.   */
+/******************************************************************************/
+void dt_sift_path_heap_up(DT_PATH_SEARCH *search, size_t position)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(search->heap);
+  Uint32 node = heap->nodes[position];
+  Uint64 key = heap->keys[position];
+  size_t parent;
+
+  while (position > 0)
+  {
+    parent = (position - 1) >> 1;
+    if (heap->keys[parent] <= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[parent];
+    heap->keys[position] = heap->keys[parent];
+    search->heap_index[heap->nodes[position]] = (Uint32) position;
+    position = parent;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+  search->heap_index[node] = (Uint32) position;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_sift_path_heap_down                                           */
+/*                                                                            */
+/* Purpose: Move an entry of the open list down until neither child has a     */
+/*          lower key.                                                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     position - The position of the entry.                   */
+/*                                                                            */
+/* Operation: Move the child with the lower key up into the hole while it is  */
+/*            lower than the entry, then put the entry in the hole.           */
+/******************************************************************************/
+void dt_sift_path_heap_down(DT_PATH_SEARCH *search, size_t position)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(search->heap);
+  Uint32 node = heap->nodes[position];
+  Uint64 key = heap->keys[position];
+  size_t child;
+
+  while ((child = (position << 1) + 1) < heap->num_entries)
+  {
+    if ((child + 1 < heap->num_entries) &&
+        (heap->keys[child + 1] < heap->keys[child]))
+    {
+      child++;
+    }
+    if (heap->keys[child] >= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[child];
+    heap->keys[position] = heap->keys[child];
+    search->heap_index[heap->nodes[position]] = (Uint32) position;
+    position = child;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+  search->heap_index[node] = (Uint32) position;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_find_path                                                     */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a unit between two points with A*.     */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES, never DT_PATH_PENDING.               */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. This must be a  */
+/*                             plain search.                                  */
+/*             IN     unit - The unit which is to move. Its class and speed   */
+/*                           set the cost of each step.                       */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: Start the search and run it to the end in one go.               */
+/******************************************************************************/
+int dt_find_path(DT_PATH_SEARCH *search,
+                 DT_UNIT *unit,
+                 int start_x,
+                 int start_y,
+                 int goal_x,
+                 int goal_y,
+                 DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code;
+
+  (*path) = NULL;
+  ret_code = dt_start_path_search(search,
+                                  unit,
+                                  start_x,
+                                  start_y,
+                                  goal_x,
+                                  goal_y);
+  if (DT_PATH_PENDING == ret_code)
+  {
+    ret_code = dt_continue_path_search(search, DT_PATH_NO_NODE_LIMIT, path);
+  }
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_start_path_search                                             */
+/*                                                                            */
+/* Purpose: Start an A* search for the cheapest path for a unit between two   */
+/*          points, to be run by dt_continue_path_search.                     */
+/*                                                                            */
+/* Returns: DT_PATH_PENDING if the search has started, DT_PATH_NOT_FOUND if   */
+/*          the goal is in a region the start cannot reach, or                */
+/*          DT_PATH_BAD_POINT.                                                */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. This must be a  */
+/*                             plain search. Any search it was running is     */
+/*                             abandoned.                                     */
+/*             IN     unit - The unit which is to move. Its class and speed   */
+/*                           set the cost of each step. It must last until    */
+/*                           the search ends.                                 */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: A goal the start's region map says cannot be reached is turned  */
+/*            down at once. Otherwise note the unit and goal in the search    */
+/*            and open the start node, choosing the landmarks the search      */
+/*            estimates from if the field has any. See dt_get_path_estimate.  */
+/******************************************************************************/
+int dt_start_path_search(DT_PATH_SEARCH *search,
+                         DT_UNIT *unit,
+                         int start_x,
+                         int start_y,
+                         int goal_x,
+                         int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = search->grid;
+  DT_COST_FIELD *field;
+  Uint64 start_time;
+  int ret_code = DT_PATH_PENDING;
+
+  start_time = dt_get_time_us();
+  dt_begin_path_search(search);
+  field = dt_get_grid_cost_field(grid, unit);
+  if (!dt_check_path_points(grid, field, start_x, start_y, goal_x, goal_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    (search->num_searches)++;
+    goto EXIT_LABEL;
+  }
+  if (!dt_is_goal_in_start_region(grid,
+                                  field,
+                                  start_x,
+                                  start_y,
+                                  goal_x,
+                                  goal_y))
+  {
+    ret_code = DT_PATH_NOT_FOUND;
+    (search->num_searches)++;
+    goto EXIT_LABEL;
+  }
+
+  search->unit = unit;
+  search->goal_x = goal_x;
+  search->goal_y = goal_y;
+  search->min_cost = (Uint32) dt_get_min_move_cost(unit);
+  dt_choose_search_landmarks(search,
+                             field,
+                             start_x,
+                             start_y,
+                             goal_x,
+                             goal_y);
+  dt_reach_path_state(search,
+                      ((Uint32) start_y * (Uint32) grid->num_tiles_x) +
+                                                            (Uint32) start_x,
+                      0,
+                      DT_PATH_NO_PARENT,
+                      dt_get_path_estimate(search,
+                                           field,
+                                           search->min_cost,
+                                           start_x,
+                                           start_y,
+                                           goal_x,
+                                           goal_y));
+
+EXIT_LABEL:
+
+  search->total_search_time_us += dt_get_time_us() - start_time;
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_continue_path_search                                          */
+/*                                                                            */
+/* Purpose: Run a search started by dt_start_path_search for up to a number   */
+/*          of nodes.                                                         */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES. DT_PATH_PENDING if the search has    */
+/*          not finished, when it may be continued again.                     */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search. The grid must not have changed     */
+/*                             since it started.                              */
+/*             IN     max_nodes - The most nodes to expand, or                */
+/*                                DT_PATH_NO_NODE_LIMIT.                      */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: A step may be taken in any of the 8 DT_VIEW_ORIENTATIONS onto a */
+/*            traversable point, but not diagonally past the corner of one    */
+/*            which is not. Each step costs the value of the point in the     */
+/*            cost field for the unit times DT_PATH_STRAIGHT_STEP or          */
+/*            DT_PATH_DIAGONAL_STEP. The heuristic is the octile distance     */
+/*            times dt_get_min_move_cost, which never overestimates and never */
+/*            drops by more than a step costs, so no node need be expanded    */
+/*            twice. Landmarks, if the field has them, raise it where rivers  */
+/*            and mountains are in the way, though their rounding may let it  */
+/*            drop by a little more than a step, when a node may be expanded  */
+/*            again. A neighbour already reached as cheaply is passed over    */
+/*            before its estimate is worked out. Everything between slices is */
+/*            in the search, except the cost field, which is looked up again  */
+/*            each slice as the grid may have dropped it. The time taken is   */
+/*            added to the totals of the search, and when it finishes so are  */
+/*            the nodes expanded.                                             */
+/******************************************************************************/
+int dt_continue_path_search(DT_PATH_SEARCH *search,
+                            long max_nodes,
+                            DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = search->grid;
+  DT_COST_FIELD *field;
+  Uint64 start_time;
+  Uint32 node;
+  Uint32 next_node;
+  Uint32 step_cost;
+  long index;
+  long num_expanded = 0;
+  int ret_code = DT_PATH_NOT_FOUND;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  start_time = dt_get_time_us();
+  (*path) = NULL;
+  field = dt_get_grid_cost_field(grid, search->unit);
+
+  /****************************************************************************/
+  /* Expand the open node with the lowest estimate until the goal is reached. */
+  /****************************************************************************/
+  while (search->heap.num_entries > 0)
+  {
+    if (num_expanded == max_nodes)
+    {
+      ret_code = DT_PATH_PENDING;
+      goto EXIT_LABEL;
+    }
+    node = dt_pop_path_heap(search);
+    (search->nodes_expanded)++;
+    num_expanded++;
+    grid_x = (int) (node % (Uint32) grid->num_tiles_x);
+    grid_y = (int) (node / (Uint32) grid->num_tiles_x);
+    if ((grid_x == search->goal_x) && (grid_y == search->goal_y))
+    {
+      (*path) = dt_build_path(search, node, search->unit->orientation);
+      ret_code = DT_PATH_FOUND;
+      break;
+    }
+
+    index = dt_get_cost_field_index(field, grid_x, grid_y);
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      step_cost = dt_get_cost_field_step_cost(field, index, direction);
+      if (0 == step_cost)
+      {
+        continue;
+      }
+      next_node = (Uint32) ((long) node + search->node_offsets[direction]);
+      if ((search->generation[next_node] == search->current_generation) &&
+          (search->cost[node] + step_cost >= search->cost[next_node]))
+      {
+        continue;
+      }
+      next_x = grid_x + dt_get_orientation_step_x(direction);
+      next_y = grid_y + dt_get_orientation_step_y(direction);
+      dt_reach_path_state(search,
+                          next_node,
+                          search->cost[node] + step_cost,
+                          direction,
+                          dt_get_path_estimate(search,
+                                               field,
+                                               search->min_cost,
+                                               next_x,
+                                               next_y,
+                                               search->goal_x,
+                                               search->goal_y));
+    }
+  }
+  (search->num_searches)++;
+  search->total_nodes_expanded += (Uint64) search->nodes_expanded;
+
+EXIT_LABEL:
+
+  search->total_search_time_us += dt_get_time_us() - start_time;
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_find_oriented_path                                            */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a unit between two points, counting    */
+/*          the cost of turning to face each step.                            */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search state for the grid. This must be an */
+/*                             oriented search.                               */
+/*             IN     unit - The unit which is to move. It starts facing its  */
+/*                           orientation.                                     */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*             IN     turn_cost - The cost of each eighth of a turn. Slow     */
+/*                                turning units such as vehicles have a       */
+/*                                higher cost.                                */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: As dt_find_path, but over states of a point and an orientation. */
+/*            A unit must face the way it steps, so a step from a state costs */
+/*            the turn from its orientation to the step's direction as well,  */
+/*            and leads to the state facing that direction. The turn costs    */
+/*            are worked out into a table for the search so each step looks   */
+/*            its turn up. The goal may be reached facing any way. The        */
+/*            heuristic is that of dt_get_path_estimate and ignores turns,    */
+/*            which keeps it a lower bound. A state is                        */
+/*            not opened if another state on the same point can turn to it    */
+/*            for no more than it costs, so most points are only expanded in  */
+/*            one or two orientations rather than eight.                      */
+/******************************************************************************/
+int dt_find_oriented_path(DT_PATH_SEARCH *search,
+                          DT_UNIT *unit,
+                          int start_x,
+                          int start_y,
+                          int goal_x,
+                          int goal_y,
+                          int turn_cost,
+                          DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = search->grid;
+  DT_COST_FIELD *field;
+  Uint64 start_time;
+  Uint32 min_cost;
+  Uint32 state;
+  Uint32 node;
+  Uint32 next_state;
+  Uint32 new_cost;
+  Uint32 step_cost;
+  long index;
+  int ret_code = DT_PATH_NOT_FOUND;
+  int orientation;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+
+  start_time = dt_get_time_us();
+  (*path) = NULL;
+  dt_begin_path_search(search);
+  field = dt_get_grid_cost_field(grid, unit);
+  if (!dt_check_path_points(grid, field, start_x, start_y, goal_x, goal_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    goto EXIT_LABEL;
+  }
+  if (!dt_is_goal_in_start_region(grid,
+                                  field,
+                                  start_x,
+                                  start_y,
+                                  goal_x,
+                                  goal_y))
+  {
+    goto EXIT_LABEL;
+  }
+
+  /****************************************************************************/
+  /* Work out the transition table of turn costs.                             */
+  /****************************************************************************/
+  for (orientation = NORTH; orientation < NORTH_1; orientation++)
+  {
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      search->turn_costs[orientation][direction] = (Uint32) turn_cost *
+                      (Uint32) MIN(abs(direction - orientation),
+                                   NORTH_1 - abs(direction - orientation));
+    }
+  }
+
+  /****************************************************************************/
+  /* Open the start state.                                                    */
+  /****************************************************************************/
+  min_cost = (Uint32) dt_get_min_move_cost(unit);
+  dt_choose_search_landmarks(search,
+                             field,
+                             start_x,
+                             start_y,
+                             goal_x,
+                             goal_y);
+  node = ((Uint32) start_y * (Uint32) grid->num_tiles_x) + (Uint32) start_x;
+  dt_reach_path_state(search,
+                      (node * NORTH_1) + (Uint32) unit->orientation,
+                      0,
+                      DT_PATH_NO_PARENT,
+                      dt_get_path_estimate(search,
+                                           field,
+                                           min_cost,
+                                           start_x,
+                                           start_y,
+                                           goal_x,
+                                           goal_y));
+
+  /****************************************************************************/
+  /* Expand the open state with the lowest estimate until the goal is         */
+  /* reached.                                                                 */
+  /****************************************************************************/
+  while (search->heap.num_entries > 0)
+  {
+    state = dt_pop_path_heap(search);
+    (search->nodes_expanded)++;
+    node = state / NORTH_1;
+    orientation = (int) (state % NORTH_1);
+    grid_x = (int) (node % (Uint32) grid->num_tiles_x);
+    grid_y = (int) (node / (Uint32) grid->num_tiles_x);
+    if ((grid_x == goal_x) && (grid_y == goal_y))
+    {
+      (*path) = dt_build_path(search, state, unit->orientation);
+      ret_code = DT_PATH_FOUND;
+      break;
+    }
+
+    index = dt_get_cost_field_index(field, grid_x, grid_y);
+    for (direction = NORTH; direction < NORTH_1; direction++)
+    {
+      step_cost = dt_get_cost_field_step_cost(field, index, direction);
+      if (0 == step_cost)
+      {
+        continue;
+      }
+      next_x = grid_x + dt_get_orientation_step_x(direction);
+      next_y = grid_y + dt_get_orientation_step_y(direction);
+      next_state = ((Uint32) ((long) node + search->node_offsets[direction]) *
+                                                 NORTH_1) + (Uint32) direction;
+      new_cost = search->cost[state] +
+                 search->turn_costs[orientation][direction] + step_cost;
+      if (dt_is_path_state_dominated(search, next_state, new_cost))
+      {
+        continue;
+      }
+      dt_reach_path_state(search,
+                          next_state,
+                          new_cost,
+                          orientation,
+                          dt_get_path_estimate(search,
+                                               field,
+                                               min_cost,
+                                               next_x,
+                                               next_y,
+                                               goal_x,
+                                               goal_y));
+    }
+  }
+
+EXIT_LABEL:
+
+  (search->num_searches)++;
+  search->total_nodes_expanded += (Uint64) search->nodes_expanded;
+  search->total_search_time_us += dt_get_time_us() - start_time;
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_is_path_state_dominated                                       */
+/*                                                                            */
+/* Purpose: Check whether an oriented state reached at a cost is no better    */
+/*          than another state already reached on the same point.             */
+/*                                                                            */
+/* Returns: true if some state of the point, facing any way, costs no more    */
+/*          than this cost once the turn to this state's orientation is added.*/
+/*                                                                            */
+/* Parameters: IN     search - The oriented search.                           */
+/*             IN     state - The state reached.                              */
+/*             IN     cost - The cost of reaching it.                         */
+/*                                                                            */
+/* Operation: As turning all the way round is never cheaper than turning in   */
+/*            one go, whatever a dominated state can go on to do, the state   */
+/*            which dominates it can do for no more. So a dominated state     */
+/*            need never be opened. A state dominates itself at its own cost. */
+/******************************************************************************/
+bool dt_is_path_state_dominated(DT_PATH_SEARCH *search,
+                                Uint32 state,
+                                Uint32 cost)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 first_state = state - (state % NORTH_1);
+  int direction = (int) (state % NORTH_1);
+  int orientation;
+
+  for (orientation = NORTH; orientation < NORTH_1; orientation++)
+  {
+    if ((search->generation[first_state + (Uint32) orientation] ==
+                                              search->current_generation) &&
+        (search->cost[first_state + (Uint32) orientation] +
+                     search->turn_costs[orientation][direction] <= cost))
+    {
+      return(true);
+    }
+  }
+
+  return(false);
+}
+
+/******************************************************************************/
+/* Function: dt_check_path_points                                             */
+/*                                                                            */
+/* Purpose: Check the start and goal of a search.                             */
+/*                                                                            */
+/* Returns: true if both are on the grid and the goal can be entered.         */
+/*                                                                            */
+/* Parameters: IN     grid - The grid to be searched.                         */
+/*             IN     field - The cost field of the unit which is to move.    */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: The start itself need not be traversable, so a unit can always  */
+/*            move off the point it is on. The goal is looked up in the cost  */
+/*            field, which is blocked just where the grid may not be          */
+/*            entered, rather than in the grid. Reading the grid may inflate  */
+/*            a chunk of a compressed grid, which writes to it.               */
+/******************************************************************************/
+bool dt_check_path_points(DT_GRID *grid,
+                          DT_COST_FIELD *field,
+                          int start_x,
+                          int start_y,
+                          int goal_x,
+                          int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  bool valid = false;
+
+  if ((start_x >= 0) && (start_x < grid->num_tiles_x) &&
+      (start_y >= 0) && (start_y < grid->num_tiles_y) &&
+      (goal_x >= 0) && (goal_x < grid->num_tiles_x) &&
+      (goal_y >= 0) && (goal_y < grid->num_tiles_y))
+  {
+    valid = (DT_COST_FIELD_BLOCKED !=
+                field->costs[dt_get_cost_field_index(field, goal_x, goal_y)]);
+  }
+
+  return(valid);
+}
+
+/******************************************************************************/
+/* Function: dt_reach_path_state                                              */
+/*                                                                            */
+/* Purpose: Record that a search has reached a state at a cost.               */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT search - The search.                                    */
+/*             IN     state - The state reached.                              */
+/*             IN     cost - The cost of reaching it this way.                */
+/*             IN     parent - What to record as the parent of the state. See */
+/*                             DT_PATH_SEARCH.                                */
+/*             IN     estimate - The estimated cost from the state to the     */
+/*                               goal.                                        */
+/*                                                                            */
+/* Operation: A state not reached before in this search is opened. One on the */
+/*            open list is updated if this way is cheaper. One which has been */
+/*            expanded is opened again if this way is cheaper, which can only */
+/*            happen when the heuristic is not consistent, as the rounded     */
+/*            landmark estimate may not be.                                   */
+/******************************************************************************/
+void dt_reach_path_state(DT_PATH_SEARCH *search,
+                         Uint32 state,
+                         Uint32 cost,
+                         int parent,
+                         Uint32 estimate)
+{
+  if (search->generation[state] != search->current_generation)
+  {
+    search->generation[state] = search->current_generation;
+    search->cost[state] = cost;
+    search->parent[state] = (unsigned char) parent;
+    dt_push_path_heap(search,
+                      state,
+                      dt_make_path_heap_key(cost + estimate, cost));
+  }
+  else if (cost < search->cost[state])
+  {
+    search->cost[state] = cost;
+    search->parent[state] = (unsigned char) parent;
+    if (DT_PATH_CLOSED == search->heap_index[state])
+    {
+      dt_push_path_heap(search,
+                        state,
+                        dt_make_path_heap_key(cost + estimate, cost));
+    }
+    else
+    {
+      dt_decrease_path_heap_key(search,
+                                state,
+                                dt_make_path_heap_key(cost + estimate, cost));
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_make_path_heap_key                                            */
+/*                                                                            */
+/* Purpose: Make the key of a node on the open list.                          */
+/*                                                                            */
+/* Returns: The key.                                                          */
+/*                                                                            */
+/* Parameters: IN     estimate - The estimated total cost of a path through   */
+/*                               the node.                                    */
+/*             IN     cost - The cost so far to reach the node.               */
+/*                                                                            */
+/* Operation: See DT_PATH_HEAP. Ordering on the one value sorts by estimate   */
+/*            and breaks ties towards the node furthest along.                */
+/******************************************************************************/
+Uint64 dt_make_path_heap_key(Uint32 estimate, Uint32 cost)
+{
+  return((((Uint64) estimate) << 32) | (Uint64) (0xFFFFFFFFu - cost));
+}
+
+/******************************************************************************/
+/* Function: dt_build_path                                                    */
+/*                                                                            */
+/* Purpose: Build the path to a state reached by a search.                    */
+/*                                                                            */
+/* Returns: A pointer to the new path.                                        */
+/*                                                                            */
+/* Parameters: IN     search - The search which reached the state.            */
+/*             IN     goal - The last state of the path.                      */
+/*             IN     start_orientation - The way the unit faced at the       */
+/*                                        start.                              */
+/*                                                                            */
+/* Operation: Follow the parents back to the start once to count the points   */
+/*            and again to fill them in from the end.                         */
+/******************************************************************************/
+DT_PATH *dt_build_path(DT_PATH_SEARCH *search,
+                       Uint32 goal,
+                       int start_orientation)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH *path;
+  DT_PATH_POINT *point;
+  int num_tiles_x = search->grid->num_tiles_x;
+  Uint32 state;
+  Uint32 node;
+  int direction;
+  int ii;
+
+  path = (DT_PATH *) dt_malloc(sizeof(DT_PATH));
+  path->cost = search->cost[goal];
+  path->num_points = 0;
+  for (state = goal;
+       DT_PATH_NO_STATE != state;
+       state = dt_get_previous_path_state(search, state, &direction))
+  {
+    (path->num_points)++;
+  }
+
+  path->points = (DT_PATH_POINT *) dt_malloc(sizeof(DT_PATH_POINT) *
+                                             (size_t) path->num_points);
+  ii = path->num_points - 1;
+  for (state = goal; DT_PATH_NO_STATE != state; ii--)
+  {
+    point = &(path->points[ii]);
+    node = state / (Uint32) search->states_per_node;
+    point->grid_x = (int) (node % (Uint32) num_tiles_x);
+    point->grid_y = (int) (node / (Uint32) num_tiles_x);
+    state = dt_get_previous_path_state(search, state, &direction);
+    point->orientation = (DT_PATH_NO_PARENT != direction) ? direction :
+                                                           start_orientation;
+  }
+
+  return(path);
+}
+
+/******************************************************************************/
+/* Function: dt_get_previous_path_state                                       */
+/*                                                                            */
+/* Purpose: Find the state before a state on its cheapest path.               */
+/*                                                                            */
+/* Returns: The previous state, or DT_PATH_NO_STATE for the start.            */
+/*                                                                            */
+/* Parameters: IN     search - The search which reached the state.            */
+/*             IN     state - The state.                                      */
+/*             OUT    direction - The direction of the step into the state,   */
+/*                                or DT_PATH_NO_PARENT for the start. For the */
+/*                                start of an oriented search it is the       */
+/*                                orientation of the state.                   */
+/*                                                                            */
+/* Operation: See DT_PATH_SEARCH for what the parent of a state holds.        */
+/******************************************************************************/
+Uint32 dt_get_previous_path_state(DT_PATH_SEARCH *search,
+                                  Uint32 state,
+                                  int *direction)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 previous = DT_PATH_NO_STATE;
+  Uint32 node;
+
+  if (1 == search->states_per_node)
+  {
+    (*direction) = search->parent[state];
+    if (DT_PATH_NO_PARENT != *direction)
+    {
+      previous = (Uint32) ((long) state - search->node_offsets[*direction]);
+    }
+  }
+  else
+  {
+    (*direction) = (int) (state % NORTH_1);
+    if (DT_PATH_NO_PARENT != search->parent[state])
+    {
+      node = (Uint32) ((long) (state / NORTH_1) -
+                                        search->node_offsets[*direction]);
+      previous = (node * NORTH_1) + search->parent[state];
+    }
+  }
+
+  return(previous);
+}
+
+/******************************************************************************/
+/* Function: dt_copy_path                                                     */
+/*                                                                            */
+/* Purpose: Copy a path.                                                      */
+/*                                                                            */
+/* Returns: A pointer to the copy, to be freed with dt_destroy_path.          */
+/*                                                                            */
+/* Parameters: IN     path - The path to copy.                                */
+/*                                                                            */
+/* Operation: Allocate the copy and its points and copy the points over.      */
+/******************************************************************************/
+DT_PATH *dt_copy_path(DT_PATH *path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH *copy;
+
+  copy = (DT_PATH *) dt_malloc(sizeof(DT_PATH));
+  copy->points = (DT_PATH_POINT *) dt_malloc(sizeof(DT_PATH_POINT) *
+                                             (size_t) path->num_points);
+  memcpy(copy->points,
+         path->points,
+         sizeof(DT_PATH_POINT) * (size_t) path->num_points);
+  copy->num_points = path->num_points;
+  copy->cost = path->cost;
+
+  return(copy);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_path                                                  */
+/*                                                                            */
+/* Purpose: Free a path.                                                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     path - The path to free.                                */
+/*                                                                            */
+/* Operation: Free the points and then the path.                              */
+/******************************************************************************/
+void dt_destroy_path(DT_PATH *path)
+{
+  dt_free(path->points);
+  dt_free(path);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_path_search_rate                                          */
+/*                                                                            */
+/* Purpose: Report how fast a search state has expanded nodes.                */
+/*                                                                            */
+/* Returns: The number of nodes expanded per second over every search run.    */
+/*                                                                            */
+/* Parameters: IN     search - The search.                                    */
+/*                                                                            */
+/* Operation: Divide the total nodes expanded by the total time.              */
+/******************************************************************************/
+double dt_get_path_search_rate(DT_PATH_SEARCH *search)
+{
+  return(((double) search->total_nodes_expanded * 1000000.0) /
+                         (double) MAX(search->total_search_time_us, 1));
 }
@@ -1 +1,510 @@
+/******************************************************************************/
+/* File: dt_pathing.h                                                         */
+/*                                                                            */
+/* Purpose: Definitions for the cost of moving units and for searching the    */
+/*          grid for paths.                                                   */
+/******************************************************************************/
 
+/******************************************************************************/
+/* Group: DT_TERRAIN_COSTS                                                    */
+/*                                                                            */
+/* The cost for a unit to move onto a point of each of the DT_GROUND_TYPES,   */
+/* before the movement modifier of the point is added and the total divided   */
+/* by the speed of the unit. DT_TERRAIN_COST values are for normal units and  */
+/* DT_VEHICLE_TERRAIN_COST values for vehicles, which are quicker over open   */
+/* ground and much slower over anything else.                                 */
+/******************************************************************************/
+#define DT_TERRAIN_COST_PLAIN 4
+#define DT_TERRAIN_COST_SWAMP 8
+#define DT_TERRAIN_COST_MOUNTAIN 12
+#define DT_TERRAIN_COST_RIVER 16
+
+#define DT_VEHICLE_TERRAIN_COST_PLAIN 3
+#define DT_VEHICLE_TERRAIN_COST_SWAMP 16
+#define DT_VEHICLE_TERRAIN_COST_MOUNTAIN 24
+#define DT_VEHICLE_TERRAIN_COST_RIVER 32
+
+/******************************************************************************/
+/* The cost of a step in a path is the cost of moving onto the point times    */
+/* one of these. Their ratio is close to the square root of two, so that      */
+/* diagonal steps cost more than straight ones.                               */
+/*                                                                            */
+/* DT_PATH_STRAIGHT_STEP - A step north, east, south or west.                 */
+/* DT_PATH_DIAGONAL_STEP - A step in one of the other four directions.        */
+/******************************************************************************/
+#define DT_PATH_STRAIGHT_STEP 5
+#define DT_PATH_DIAGONAL_STEP 7
+
+/******************************************************************************/
+/* Group: DT_PATH_RETURN_CODES                                                */
+/*                                                                            */
+/* Return codes for path searches.                                            */
+/*                                                                            */
+/* DT_PATH_FOUND - A path was found.                                          */
+/* DT_PATH_NOT_FOUND - The goal cannot be reached from the start.             */
+/* DT_PATH_BAD_POINT - The start or goal is off the grid or the goal cannot   */
+/*                     be entered.                                            */
+/* DT_PATH_PENDING - The search has not finished and may be continued.        */
+/******************************************************************************/
+#define DT_PATH_FOUND 0
+#define DT_PATH_NOT_FOUND 1
+#define DT_PATH_BAD_POINT 2
+#define DT_PATH_PENDING 3
+
+/******************************************************************************/
+/* Parameters of path searches.                                               */
+/*                                                                            */
+/* DT_PATH_HEAP_INITIAL_SIZE - The number of entries the open list of a       */
+/*                             search has room for to start with. It doubles  */
+/*                             whenever it fills.                             */
+/* DT_PATH_CLOSED - The heap position of a node which has been expanded.      */
+/* DT_PATH_NO_PARENT - The parent of the start node.                          */
+/* DT_PATH_NO_STATE - Returned in place of the state before the start.        */
+/* DT_PATH_DEFAULT_TURN_COST - The cost of each eighth of a turn for units    */
+/*                             which turn no more slowly than they move.      */
+/* DT_PATH_NO_NODE_LIMIT - Passed as the most nodes to expand to run a search */
+/*                         to the end.                                        */
+/******************************************************************************/
+#define DT_PATH_HEAP_INITIAL_SIZE 1024
+#define DT_PATH_CLOSED 0xFFFFFFFFu
+#define DT_PATH_NO_PARENT 0xFF
+#define DT_PATH_NO_STATE 0xFFFFFFFFu
+#define DT_PATH_DEFAULT_TURN_COST 2
+#define DT_PATH_NO_NODE_LIMIT -1L
+
+/******************************************************************************/
+/* DT_COST_FIELD_BLOCKED - The value in a cost field of a point which may not */
+/*                         be entered.                                        */
+/* DT_COST_FIELD_BIT_BORDER - The number of bits before the first point of    */
+/*                            each row of the bitmaps of a cost field. It is  */
+/*                            a whole word so that 32 bits ending at any      */
+/*                            point can be read.                              */
+/******************************************************************************/
+#define DT_COST_FIELD_BLOCKED 0
+#define DT_COST_FIELD_BIT_BORDER 32
+
+/******************************************************************************/
+/* DT_PATH_POINT:                                                             */
+/*                                                                            */
+/* One point of a path.                                                       */
+/*                                                                            */
+/* grid_x - The x coordinate on the grid.                                     */
+/* grid_y - The y coordinate on the grid.                                     */
+/* orientation - The way the unit faces on reaching the point, which is the   */
+/*               direction of the step onto it. At the start it is the way    */
+/*               the unit faced before moving. One of DT_VIEW_ORIENTATIONS.   */
+/******************************************************************************/
+typedef struct dt_path_point
+{
+  int grid_x;
+  int grid_y;
+  int orientation;
+} DT_PATH_POINT;
+
+/******************************************************************************/
+/* DT_PATH:                                                                   */
+/*                                                                            */
+/* A path found by a search.                                                  */
+/*                                                                            */
+/* points - Every point of the path in order, from the start to the goal.     */
+/* num_points - The number of entries in points.                              */
+/* cost - The total cost of the steps of the path, and of the turns between   */
+/*        them if it was found by an oriented search.                         */
+/******************************************************************************/
+typedef struct dt_path
+{
+  DT_PATH_POINT *points;
+  int num_points;
+  Uint32 cost;
+} DT_PATH;
+
+/******************************************************************************/
+/* DT_PATH_HEAP:                                                              */
+/*                                                                            */
+/* The open list of a search, a binary heap of nodes ordered by key. The      */
+/* position of each node in the heap is kept in the heap_index array of the   */
+/* search, so the key of a node can be lowered without looking for it.        */
+/*                                                                            */
+/* nodes - The node in each position of the heap.                             */
+/* keys - The key of each position of the heap. The estimated total cost is   */
+/*        in the top 32 bits, and the cost so far subtracted from the largest */
+/*        value in the bottom 32, so of nodes with the same estimate the one  */
+/*        furthest along comes first.                                         */
+/* num_entries - The number of nodes in the heap.                             */
+/* size - The number of entries nodes and keys have room for.                 */
+/******************************************************************************/
+typedef struct dt_path_heap
+{
+  Uint32 *nodes;
+  Uint64 *keys;
+  size_t num_entries;
+  size_t size;
+} DT_PATH_HEAP;
+
+/******************************************************************************/
+/* DT_COST_FIELD:                                                             */
+/*                                                                            */
+/* The cost for units of one class and speed to move onto each point of a     */
+/* grid, worked out once so that searches need not combine the terrain,       */
+/* movement modifier and speed at every step. The field has a border one      */
+/* point wide all the way round the grid, so the neighbours of any point on   */
+/* the grid can be read without checking the edges.                           */
+/*                                                                            */
+/* unit_class - The class of unit. One of DT_UNIT_CLASSES.                    */
+/* speed - The speed of the units.                                            */
+/* width - The number of entries in each row of costs, two more than the      */
+/*         width of the grid.                                                 */
+/* offsets - What to add to an index into costs to step to the next point in  */
+/*           each of the DT_VIEW_ORIENTATIONS.                                */
+/* costs - The cost of moving onto each point, stored row by row. It is the   */
+/*         cost dt_cost_move_unit_to_grid_pos gives, but at least 1. Points   */
+/*         which may not be entered and the border hold                       */
+/*         DT_COST_FIELD_BLOCKED.                                             */
+/* uniform_cost - The cost of an open plain with no movement modifier.        */
+/*                Jump point searches skip across areas of this cost.         */
+/* words_per_row - The number of words in each row of the bitmaps by row.     */
+/*                 There is a border row above and below the grid as costs    */
+/*                 has, and the bit for x is DT_COST_FIELD_BIT_BORDER + x.    */
+/* uniform - Bitmap by row with the bit set for each point which costs        */
+/*           uniform_cost.                                                    */
+/* interior - Bitmap by row with the bit set for each point which costs       */
+/*            uniform_cost and whose 8 neighbours all cost uniform_cost or    */
+/*            may not be entered.                                             */
+/* words_per_column - The number of words in each column of the bitmaps by    */
+/*                    column. They are laid out as those by row with x and y  */
+/*                    swapped.                                                */
+/* uniform_columns - The uniform bitmap by column.                            */
+/* interior_columns - The interior bitmap by column.                          */
+/* hierarchy - The hierarchy used for long searches with the field, or NULL   */
+/*             until the first one.                                           */
+/* regions - The connected regions of the field, or NULL until a search first */
+/*           asks whether its goal can be reached. See DT_REGION_MAP.         */
+/* landmarks - The landmarks searches with the field estimate costs from, or  */
+/*             NULL until they are asked for. See DT_LANDMARKS.               */
+/******************************************************************************/
+typedef struct dt_cost_field
+{
+  int unit_class;
+  int speed;
+  int width;
+  long offsets[NORTH_1];
+  Uint16 *costs;
+  Uint16 uniform_cost;
+  int words_per_row;
+  Uint32 *uniform;
+  Uint32 *interior;
+  int words_per_column;
+  Uint32 *uniform_columns;
+  Uint32 *interior_columns;
+  struct dt_path_hierarchy *hierarchy;
+  struct dt_region_map *regions;
+  struct dt_landmarks *landmarks;
+} DT_COST_FIELD;
+
+/******************************************************************************/
+/* DT_PATH_SEARCH:                                                            */
+/*                                                                            */
+/* Everything needed to search a grid for paths, reused from one search to    */
+/* the next. Each point of the grid is a node, numbered row by row whatever   */
+/* the storage of the grid. A plain search has one state per node. An         */
+/* oriented search has one for each way a unit on the node can face, so state */
+/* (node * NORTH_1) + orientation is the unit on the node facing that way.    */
+/* Rather than clearing the arrays before each search, every search takes a   */
+/* new generation number and a state's entries are only valid if its          */
+/* generation matches. Nothing is allocated per state during a search.        */
+/*                                                                            */
+/* grid - The grid searched.                                                  */
+/* num_nodes - The number of points of the grid.                              */
+/* states_per_node - 1 for a plain search or NORTH_1 for an oriented one.     */
+/* num_states - The number of states, num_nodes times states_per_node unless  */
+/*              the search was created with its own number.                   */
+/* node_offsets - What to add to a node to step to the next node in each of   */
+/*                the DT_VIEW_ORIENTATIONS.                                   */
+/* turn_costs - The cost of turning from each orientation to each other, for  */
+/*              the current oriented search.                                  */
+/* generation - The generation in which each state was last reached.          */
+/* current_generation - The generation of the current search.                 */
+/* cost - The cheapest cost found so far from the start to each state.        */
+/* parent - For a plain search, the direction of the step into each node      */
+/*          along its cheapest path. For an oriented search, that direction   */
+/*          is the orientation of the state, and this is the orientation of   */
+/*          the state before. DT_PATH_NO_PARENT for the start.                */
+/* heap_index - The position of each state in the open list, or               */
+/*              DT_PATH_CLOSED once it has been expanded.                     */
+/* heap - The open list.                                                      */
+/* unit - The unit the current search is for, while it is run in slices.      */
+/* goal_x - The x coordinate of the goal of the current search.               */
+/* goal_y - The y coordinate of the goal of the current search.               */
+/* min_cost - The least a step onto a point can cost the unit of the current  */
+/*            search, per straight step, used for the heuristic.              */
+/* landmarks - The landmarks the current search estimates from, or NULL.      */
+/* landmark_serial - The serial number of those landmarks when they were      */
+/*                   chosen.                                                  */
+/* landmark_tables - The tables of the landmarks it estimates from.           */
+/* num_landmark_tables - The number of entries in landmark_tables.            */
+/* nodes_expanded - The number of states expanded by the last search.         */
+/* num_searches - The number of searches run.                                 */
+/* total_nodes_expanded - The number of nodes expanded by every search.       */
+/* total_search_time_us - The time spent in every search.                     */
+/******************************************************************************/
+typedef struct dt_path_search
+{
+  DT_GRID *grid;
+  size_t num_nodes;
+  int states_per_node;
+  size_t num_states;
+  long node_offsets[NORTH_1];
+  Uint32 turn_costs[NORTH_1][NORTH_1];
+  Uint32 *generation;
+  Uint32 current_generation;
+  Uint32 *cost;
+  unsigned char *parent;
+  Uint32 *heap_index;
+  DT_PATH_HEAP heap;
+  struct dt_unit *unit;
+  int goal_x;
+  int goal_y;
+  Uint32 min_cost;
+  struct dt_landmarks *landmarks;
+  Uint32 landmark_serial;
+  int landmark_tables[DT_LANDMARK_SEARCH_TABLES];
+  int num_landmark_tables;
+  long nodes_expanded;
+  long num_searches;
+  Uint64 total_nodes_expanded;
+  Uint64 total_search_time_us;
+} DT_PATH_SEARCH;
+
+/******************************************************************************/
+/* Function: dt_get_orientation_step_x                                        */
+/*                                                                            */
+/* Purpose: Find how far a step in a direction moves along the x axis.        */
+/*                                                                            */
+/* Returns: -1, 0 or 1.                                                       */
+/*                                                                            */
+/* Parameters: IN     orientation - The direction of the step. One of         */
+/*                                  DT_VIEW_ORIENTATIONS other than NORTH_1.  */
+/*                                                                            */
+/* Operation: Look the step up in a table. North is up the screen, which is   */
+/*            towards smaller y.                                              */
+/******************************************************************************/
+static inline int dt_get_orientation_step_x(int orientation)
+{
+  static const int step_x[NORTH_1] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+  return(step_x[orientation]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_orientation_step_y                                        */
+/*                                                                            */
+/* Purpose: Find how far a step in a direction moves along the y axis.        */
+/*                                                                            */
+/* Returns: -1, 0 or 1.                                                       */
+/*                                                                            */
+/* Parameters: IN     orientation - The direction of the step. One of         */
+/*                                  DT_VIEW_ORIENTATIONS other than NORTH_1.  */
+/*                                                                            */
+/* Operation: Look the step up in a table.                                    */
+/******************************************************************************/
+static inline int dt_get_orientation_step_y(int orientation)
+{
+  static const int step_y[NORTH_1] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+  return(step_y[orientation]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_index                                          */
+/*                                                                            */
+/* Purpose: Find where the cost of a grid point is held in a cost field.      */
+/*                                                                            */
+/* Returns: The index into costs.                                             */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Skip the border row and the border point of the row.            */
+/******************************************************************************/
+static inline long dt_get_cost_field_index(DT_COST_FIELD *field,
+                                           int grid_x,
+                                           int grid_y)
+{
+  return(((long) (grid_y + 1) * (long) field->width) + (long) (grid_x + 1));
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_bit_row                                        */
+/*                                                                            */
+/* Purpose: Find the row of a bitmap of a cost field for a row of the grid.   */
+/*                                                                            */
+/* Returns: A pointer to the first word of the row.                           */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     bitmap - The uniform or interior bitmap by row.         */
+/*             IN     grid_y - The y coordinate on the grid, from -1 for the  */
+/*                             border row above the grid.                     */
+/*                                                                            */
+/* Operation: Skip the border row and the rows before this one.               */
+/******************************************************************************/
+static inline Uint32 *dt_get_cost_field_bit_row(DT_COST_FIELD *field,
+                                                Uint32 *bitmap,
+                                                int grid_y)
+{
+  return(&(bitmap[(size_t) (grid_y + 1) * (size_t) field->words_per_row]));
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_bit_column                                     */
+/*                                                                            */
+/* Purpose: Find the column of a bitmap by column of a cost field for a       */
+/*          column of the grid.                                               */
+/*                                                                            */
+/* Returns: A pointer to the first word of the column.                        */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     bitmap - The uniform or interior bitmap by column.      */
+/*             IN     grid_x - The x coordinate on the grid, from -1 for the  */
+/*                             border column left of the grid.                */
+/*                                                                            */
+/* Operation: Skip the border column and the columns before this one.         */
+/******************************************************************************/
+static inline Uint32 *dt_get_cost_field_bit_column(DT_COST_FIELD *field,
+                                                   Uint32 *bitmap,
+                                                   int grid_x)
+{
+  return(&(bitmap[(size_t) (grid_x + 1) * (size_t) field->words_per_column]));
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_bits                                           */
+/*                                                                            */
+/* Purpose: Read 32 bits of a row of a cost field bitmap.                     */
+/*                                                                            */
+/* Returns: The bits, with that at position in the lowest bit.                */
+/*                                                                            */
+/* Parameters: IN     row - The row of the bitmap.                            */
+/*             IN     position - The position of the first bit to read.       */
+/*                                                                            */
+/* Operation: Join the top of the word holding the first bit to the bottom of */
+/*            the word after it.                                              */
+/******************************************************************************/
+static inline Uint32 dt_get_cost_field_bits(Uint32 *row, int position)
+{
+  int shift = position & DT_GRID_WORD_MASK;
+  Uint32 bits = row[position >> DT_GRID_WORD_SHIFT] >> shift;
+
+  if (0 != shift)
+  {
+    bits |= row[(position >> DT_GRID_WORD_SHIFT) + 1] <<
+                                               (DT_GRID_BITS_PER_WORD - shift);
+  }
+
+  return(bits);
+}
+
+/******************************************************************************/
+/* Function: dt_is_cost_field_bit_set                                         */
+/*                                                                            */
+/* Purpose: Check the bit of a cost field bitmap for a point.                 */
+/*                                                                            */
+/* Returns: true if the bit is set.                                           */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     bitmap - The uniform or interior bitmap of the field.   */
+/*             IN     grid_x - The x coordinate on the grid.                  */
+/*             IN     grid_y - The y coordinate on the grid.                  */
+/*                                                                            */
+/* Operation: Test the bit in its word of the row.                            */
+/******************************************************************************/
+static inline bool dt_is_cost_field_bit_set(DT_COST_FIELD *field,
+                                            Uint32 *bitmap,
+                                            int grid_x,
+                                            int grid_y)
+{
+  int position = grid_x + DT_COST_FIELD_BIT_BORDER;
+
+  return(0 != ((dt_get_cost_field_bit_row(field, bitmap, grid_y)
+                                        [position >> DT_GRID_WORD_SHIFT] >>
+                                        (position & DT_GRID_WORD_MASK)) & 1));
+}
+
+/******************************************************************************/
+/* Functions: dt_find_lowest_set_bit, dt_find_highest_set_bit                 */
+/*                                                                            */
+/* Purpose: Find the lowest or highest bit set in a word.                     */
+/*                                                                            */
+/* Returns: The position of the bit, from 0 for the lowest bit.               */
+/*                                                                            */
+/* Parameters: IN     word - The word, which must not be zero.                */
+/*                                                                            */
+/* Operation: Reduce the word to a single bit, or to every bit up to the      */
+/*            highest, and multiply by a de Bruijn sequence so that the top   */
+/*            five bits are different for each position and can be looked     */
+/*            up in a table.                                                  */
+/******************************************************************************/
+static inline int dt_find_lowest_set_bit(Uint32 word)
+{
+  static const int positions[32] = {0, 1, 28, 2, 29, 14, 24, 3,
+                                    30, 22, 20, 15, 25, 17, 4, 8,
+                                    31, 27, 13, 23, 21, 19, 16, 7,
+                                    26, 12, 18, 6, 11, 5, 10, 9};
+
+  return(positions[((word & (0u - word)) * 0x077CB531u) >> 27]);
+}
+
+static inline int dt_find_highest_set_bit(Uint32 word)
+{
+  static const int positions[32] = {0, 9, 1, 10, 13, 21, 2, 29,
+                                    11, 14, 16, 18, 22, 25, 3, 30,
+                                    8, 12, 20, 28, 15, 17, 24, 7,
+                                    19, 27, 23, 6, 26, 5, 4, 31};
+
+  word |= word >> 1;
+  word |= word >> 2;
+  word |= word >> 4;
+  word |= word >> 8;
+  word |= word >> 16;
+
+  return(positions[(word * 0x07C4ACDDu) >> 27]);
+}
+
+/******************************************************************************/
+/* Function: dt_get_cost_field_step_cost                                      */
+/*                                                                            */
+/* Purpose: Find the cost of a step from a point of a cost field.             */
+/*                                                                            */
+/* Returns: 0 if the step may not be taken, otherwise the cost of moving onto */
+/*          the point stepped to times DT_PATH_STRAIGHT_STEP or               */
+/*          DT_PATH_DIAGONAL_STEP.                                            */
+/*                                                                            */
+/* Parameters: IN     field - The cost field.                                 */
+/*             IN     index - The index of the point stepped from.            */
+/*             IN     direction - The direction of the step. One of           */
+/*                                DT_VIEW_ORIENTATIONS other than NORTH_1.    */
+/*                                                                            */
+/* Operation: Odd directions are diagonal and may not cut the corner of a     */
+/*            point which may not be entered, so the two points beside the    */
+/*            step are read as well.                                          */
+/******************************************************************************/
+static inline Uint32 dt_get_cost_field_step_cost(DT_COST_FIELD *field,
+                                                 long index,
+                                                 int direction)
+{
+  Uint32 cost = field->costs[index + field->offsets[direction]];
+
+  if (0 == (direction & 1))
+  {
+    return(DT_PATH_STRAIGHT_STEP * cost);
+  }
+  if ((DT_COST_FIELD_BLOCKED ==
+                        field->costs[index + field->offsets[direction - 1]]) ||
+      (DT_COST_FIELD_BLOCKED ==
+          field->costs[index + field->offsets[(direction + 1) % NORTH_1]]))
+  {
+    return(0);
+  }
+
+  return(DT_PATH_DIAGONAL_STEP * cost);
+}
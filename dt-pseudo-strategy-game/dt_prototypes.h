@@ -11,6 +11,7 @@ struct dt_unit_list_ns *dt_retrieve_master_unit_list();
 /* prototypes for functions in dt_mem_alloc_handler.c.                        */
 /******************************************************************************/
 void *dt_malloc(size_t);
+void *dt_calloc(size_t, size_t);
 void dt_free(void *);
 
 /******************************************************************************/
@@ -61,9 +62,25 @@ void dt_assign_entity_graphic_to_background_tile(struct dt_entity_graphic *,
 /* prototypes for functions in dt_grid.c                                      */
 /******************************************************************************/
 struct dt_grid *dt_create_grid(int , int, int, int);
+struct dt_grid *dt_create_grid_with_storage(int, int, int, int, int);
+struct dt_grid *dt_create_empty_grid(int, int, int, int, int);
+void dt_alloc_dense_grid_block(struct dt_grid *);
+void dt_alloc_dense_grid_storage(struct dt_grid *);
+void dt_alloc_chunked_grid_storage(struct dt_grid *);
 void dt_destroy_grid(struct dt_grid *);
-struct dt_grid_element *dt_create_grid_element();
-void dt_destroy_grid_element(struct dt_grid_element *);
+void dt_init_grid_element(struct dt_grid_element *);
+void dt_init_grid_chunk(struct dt_grid_chunk *);
+struct dt_grid_chunk *dt_get_grid_chunk_for_update(struct dt_grid *, int, int);
+struct dt_grid_element *dt_get_grid_element_for_update(struct dt_grid *,
+                                                       int,
+                                                       int);
+int dt_add_tile_type_to_grid(struct dt_grid *,
+                             struct dt_background_tile *,
+                             int *);
+void dt_assign_tile_type_to_grid(struct dt_grid *, int, int, int);
+void dt_set_grid_terrain_overrides(struct dt_grid *, int, int, int, int, int);
+void dt_set_grid_traversable(struct dt_grid *, int, int, bool);
+size_t dt_get_grid_memory_usage(struct dt_grid *);
 int dt_convert_grid_to_screen_pos(struct dt_grid *,
                                   struct dt_screen *,
                                   int,
@@ -77,6 +94,536 @@ int dt_convert_screen_to_grid_pos(struct dt_grid *,
                                   int *,
                                   int *);
 struct dt_unit *dt_retrieve_unit_from_grid(struct dt_grid *, int, int);
+void dt_set_grid_unit(struct dt_grid *, int, int, struct dt_unit *);
+int dt_load_grid_from_file(char *, struct dt_grid **);
+int dt_load_grid_tile_graphics(struct dt_grid *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_map_file.c                                  */
+/******************************************************************************/
+int dt_load_text_map_file(char *, int, struct dt_grid **);
+void dt_init_map_text_reader(struct dt_map_text_reader *, char *, size_t);
+bool dt_read_map_token(struct dt_map_text_reader *, char **, size_t *);
+size_t dt_parse_map_number(char *, size_t, bool, int *);
+bool dt_read_map_number(struct dt_map_text_reader *, int *);
+int dt_parse_map_info_line(struct dt_map_text_reader *,
+                           char *,
+                           size_t,
+                           struct dt_grid **);
+int dt_parse_map_tile_line(struct dt_map_text_reader *, struct dt_grid *);
+void dt_build_map_tile_type_layers(struct dt_grid *,
+                                   struct dt_map_tile_type_layers *);
+int dt_read_map_points(struct dt_map_text_reader *,
+                       char *,
+                       int,
+                       struct dt_grid *);
+size_t dt_align_map_point_index(struct dt_grid *, size_t);
+void dt_count_map_points_job(void *);
+void dt_read_map_points_job(void *);
+int dt_write_text_map_file(struct dt_grid *, char *);
+int dt_format_map_number(char *, int);
+int dt_load_binary_map_file(char *, struct dt_grid **);
+void dt_add_map_file_tile_types(struct dt_grid *,
+                                struct dt_map_file_tile_type *,
+                                Uint32);
+int dt_read_map_file_chunks(struct dt_grid *,
+                            unsigned char *,
+                            struct dt_map_file_chunk_entry *,
+                            Uint64);
+int dt_load_compressed_map_file(char *, int, struct dt_grid **);
+bool dt_check_map_file_chunk_entry(struct dt_map_file_chunk_entry *, Uint64);
+void dt_copy_map_file_chunk(struct dt_map_file_chunk *,
+                            struct dt_grid_chunk *);
+void dt_fill_map_file_chunk(struct dt_grid_chunk *,
+                            struct dt_map_file_chunk *);
+int dt_check_map_file_header(unsigned char *, Uint64);
+int dt_write_binary_map_file(struct dt_grid *, char *);
+int dt_write_chunked_binary_map_file(struct dt_grid *, char *, int);
+bool dt_gather_grid_chunk_record(void *, int, int, struct dt_map_file_chunk *);
+int dt_write_chunk_source_map_file(struct dt_grid *,
+                                   char *,
+                                   int,
+                                   DT_MAP_FILE_CHUNK_SOURCE,
+                                   void *);
+void dt_init_map_file_header(struct dt_grid *,
+                             int,
+                             struct dt_map_file_header *);
+int dt_write_map_tile_types(struct dt_grid *, FILE *);
+void dt_gather_map_file_chunk(struct dt_grid *,
+                              int,
+                              int,
+                              struct dt_map_file_chunk *);
+int dt_write_map_padding(FILE *, Uint64);
+int dt_write_dense_map_layers(struct dt_grid *,
+                              struct dt_map_file_header *,
+                              FILE *);
+int dt_write_chunked_map_layers(struct dt_grid *,
+                                struct dt_map_file_header *,
+                                FILE *);
+int dt_convert_map_file(char *, char *, bool, int);
+int dt_report_map_file_compression(char *);
+int dt_map_file(char *, struct dt_mapped_file **);
+void dt_unmap_file(struct dt_mapped_file *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_pathing.c                                   */
+/******************************************************************************/
+int dt_cost_move_unit(struct dt_unit *, struct dt_background_tile *);
+int dt_cost_move_unit_to_grid_pos(struct dt_unit *, struct dt_grid *, int, int);
+int dt_cost_turn_unit(struct dt_unit *, DT_ORIENTATION);
+int dt_cost_unit_class_tile_type(int, int);
+int dt_get_min_move_cost(struct dt_unit *);
+Uint32 dt_get_octile_distance(int, int);
+Uint32 dt_get_path_estimate(struct dt_path_search *,
+                            struct dt_cost_field *,
+                            Uint32,
+                            int,
+                            int,
+                            int,
+                            int);
+struct dt_cost_field *dt_get_grid_cost_field(struct dt_grid *,
+                                             struct dt_unit *);
+struct dt_cost_field *dt_find_grid_cost_field(struct dt_grid *, int, int);
+struct dt_cost_field *dt_create_cost_field(struct dt_grid *, int, int);
+bool dt_fill_cost_field(struct dt_cost_field *,
+                        struct dt_grid *,
+                        int,
+                        int,
+                        int,
+                        int);
+void dt_update_grid_cost_fields(struct dt_grid *, int, int, int, int);
+void dt_update_grid_cost_fields_for_chunk(struct dt_grid *, size_t);
+void dt_destroy_cost_field(struct dt_cost_field *);
+size_t dt_get_cost_field_memory_usage(struct dt_cost_field *,
+                                      struct dt_grid *);
+struct dt_path_search *dt_create_path_search(struct dt_grid *);
+struct dt_path_search *dt_create_path_search_with_orientation(struct dt_grid *,
+                                                              bool);
+struct dt_path_search *dt_create_path_search_with_states(struct dt_grid *,
+                                                         int,
+                                                         size_t);
+void dt_destroy_path_search(struct dt_path_search *);
+void dt_begin_path_search(struct dt_path_search *);
+void dt_push_path_heap(struct dt_path_search *, Uint32, Uint64);
+Uint32 dt_pop_path_heap(struct dt_path_search *);
+void dt_decrease_path_heap_key(struct dt_path_search *, Uint32, Uint64);
+void dt_sift_path_heap_up(struct dt_path_search *, size_t);
+void dt_sift_path_heap_down(struct dt_path_search *, size_t);
+int dt_find_path(struct dt_path_search *,
+                 struct dt_unit *,
+                 int,
+                 int,
+                 int,
+                 int,
+                 struct dt_path **);
+int dt_start_path_search(struct dt_path_search *,
+                         struct dt_unit *,
+                         int,
+                         int,
+                         int,
+                         int);
+int dt_continue_path_search(struct dt_path_search *, long, struct dt_path **);
+int dt_find_oriented_path(struct dt_path_search *,
+                          struct dt_unit *,
+                          int,
+                          int,
+                          int,
+                          int,
+                          int,
+                          struct dt_path **);
+bool dt_is_path_state_dominated(struct dt_path_search *, Uint32, Uint32);
+bool dt_check_path_points(struct dt_grid *,
+                          struct dt_cost_field *,
+                          int,
+                          int,
+                          int,
+                          int);
+void dt_reach_path_state(struct dt_path_search *, Uint32, Uint32, int, Uint32);
+Uint64 dt_make_path_heap_key(Uint32, Uint32);
+struct dt_path *dt_build_path(struct dt_path_search *, Uint32, int);
+Uint32 dt_get_previous_path_state(struct dt_path_search *, Uint32, int *);
+struct dt_path *dt_copy_path(struct dt_path *);
+void dt_destroy_path(struct dt_path *);
+double dt_get_path_search_rate(struct dt_path_search *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_jump_point.c                                */
+/******************************************************************************/
+int dt_find_jump_point_path(struct dt_path_search *,
+                            struct dt_unit *,
+                            int,
+                            int,
+                            int,
+                            int,
+                            struct dt_path **);
+int dt_get_jump_point_directions(struct dt_cost_field *, long, int);
+Uint32 dt_jump_from_point(struct dt_cost_field *, int, int, int, int, int);
+Uint32 dt_jump_horizontally(struct dt_cost_field *, int, int, int, int, int);
+Uint32 dt_jump_vertically(struct dt_cost_field *, int, int, int, int, int);
+int dt_scan_jump_point_line(Uint32 *, Uint32 *, Uint32 *, int, int, int);
+void dt_fill_jump_point_path(struct dt_path_search *,
+                             struct dt_cost_field *,
+                             Uint32);
+
+/******************************************************************************/
+/* prototypes for functions in dt_path_hierarchy.c                            */
+/******************************************************************************/
+struct dt_path_hierarchy *dt_create_path_hierarchy(struct dt_grid *);
+void dt_destroy_path_hierarchy(struct dt_path_hierarchy *);
+struct dt_path_hierarchy *dt_get_path_hierarchy(struct dt_grid *,
+                                                struct dt_cost_field *);
+void dt_mark_path_hierarchy_dirty(struct dt_path_hierarchy *,
+                                  int,
+                                  int,
+                                  int,
+                                  int);
+void dt_update_path_hierarchy(struct dt_path_hierarchy *,
+                              struct dt_cost_field *);
+void dt_build_path_cluster_job(void *);
+void dt_build_path_cluster(struct dt_path_hierarchy *,
+                           struct dt_cost_field *,
+                           Uint32);
+void dt_add_path_cluster_entrances(struct dt_path_hierarchy *,
+                                   struct dt_cost_field *,
+                                   int,
+                                   int,
+                                   int,
+                                   int,
+                                   int,
+                                   struct dt_path_cluster_node *,
+                                   int *);
+void dt_add_path_cluster_node(struct dt_path_hierarchy *,
+                              int,
+                              int,
+                              int,
+                              struct dt_path_cluster_node *,
+                              int *);
+void dt_search_path_cluster(struct dt_cost_field *,
+                            int,
+                            int,
+                            int,
+                            int,
+                            int,
+                            int,
+                            bool,
+                            Uint32 *);
+void dt_relax_path_cluster(struct dt_cost_field *,
+                           int,
+                           int,
+                           int,
+                           int,
+                           bool,
+                           struct dt_path_cluster_heap *);
+void dt_init_path_cluster_heap(struct dt_path_cluster_heap *, Uint32 *);
+void dt_update_path_cluster_heap(struct dt_path_cluster_heap *, int);
+int dt_pop_path_cluster_heap(struct dt_path_cluster_heap *);
+void dt_get_path_cluster_area(struct dt_path_hierarchy *,
+                              Uint32,
+                              int *,
+                              int *,
+                              int *,
+                              int *);
+int dt_get_path_cluster_point(struct dt_path_hierarchy *, Uint32, int, int);
+int dt_find_path_cluster_node(struct dt_path_cluster *, Uint32);
+int dt_find_abstract_path(struct dt_path_search *,
+                          struct dt_unit *,
+                          int,
+                          int,
+                          int,
+                          int,
+                          struct dt_abstract_path **);
+void dt_leave_abstract_start(struct dt_path_search *,
+                             struct dt_cost_field *,
+                             struct dt_path_hierarchy *,
+                             int,
+                             int,
+                             Uint32,
+                             Uint32,
+                             Uint32);
+void dt_reach_abstract_point(struct dt_path_search *,
+                             Uint32,
+                             Uint32,
+                             int,
+                             Uint32,
+                             Uint32);
+struct dt_abstract_path *dt_build_abstract_path(struct dt_path_search *,
+                                                struct dt_path_hierarchy *,
+                                                Uint32,
+                                                Uint32);
+Uint32 dt_get_previous_abstract_point(struct dt_path_search *,
+                                      struct dt_path_hierarchy *,
+                                      Uint32,
+                                      Uint32);
+int dt_refine_abstract_path(struct dt_path_search *,
+                            struct dt_unit *,
+                            struct dt_abstract_path *,
+                            int,
+                            struct dt_path **);
+int dt_find_hierarchical_path(struct dt_path_search *,
+                              struct dt_unit *,
+                              int,
+                              int,
+                              int,
+                              int,
+                              struct dt_path **);
+void dt_destroy_abstract_path(struct dt_abstract_path *);
+size_t dt_get_path_hierarchy_memory_usage(struct dt_path_hierarchy *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_region_map.c                                */
+/******************************************************************************/
+struct dt_region_map *dt_create_region_map(struct dt_grid *);
+void dt_destroy_region_map(struct dt_region_map *);
+struct dt_region_map *dt_get_region_map(struct dt_grid *,
+                                        struct dt_cost_field *);
+void dt_build_region_map(struct dt_region_map *, struct dt_cost_field *);
+Uint32 dt_new_region_label(struct dt_region_map *);
+Uint32 dt_join_regions(struct dt_region_map *, Uint32, Uint32);
+void dt_update_region_map(struct dt_region_map *,
+                          struct dt_cost_field *,
+                          int,
+                          int,
+                          int,
+                          int);
+void dt_open_region_point(struct dt_region_map *, int, int);
+void dt_close_region_point(struct dt_region_map *, int, int);
+int dt_flood_region_side(struct dt_region_map *,
+                         Uint32 *,
+                         int *,
+                         int,
+                         int,
+                         int);
+bool dt_is_goal_in_start_region(struct dt_grid *,
+                                struct dt_cost_field *,
+                                int,
+                                int,
+                                int,
+                                int);
+size_t dt_get_region_map_memory_usage(struct dt_region_map *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_landmarks.c                                 */
+/******************************************************************************/
+struct dt_landmarks *dt_get_grid_landmarks(struct dt_grid *,
+                                           struct dt_unit *,
+                                           int);
+struct dt_landmarks *dt_create_landmarks(struct dt_grid *, int);
+void dt_destroy_landmarks(struct dt_landmarks *);
+void dt_build_landmarks(struct dt_landmarks *,
+                        struct dt_cost_field *,
+                        struct dt_grid *);
+void dt_place_landmarks(struct dt_landmarks *,
+                        struct dt_cost_field *,
+                        struct dt_grid *);
+void dt_measure_landmark_job(void *);
+void dt_choose_search_landmarks(struct dt_path_search *,
+                                struct dt_cost_field *,
+                                int,
+                                int,
+                                int,
+                                int);
+size_t dt_get_landmarks_memory_usage(struct dt_landmarks *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_flow_field.c                                */
+/******************************************************************************/
+struct dt_flow_field *dt_get_grid_flow_field(struct dt_grid *,
+                                             struct dt_unit *,
+                                             int,
+                                             int);
+struct dt_flow_field *dt_create_flow_field(struct dt_grid *,
+                                           struct dt_unit *,
+                                           int,
+                                           int);
+void dt_destroy_flow_field(struct dt_flow_field *);
+void dt_build_flow_field(struct dt_flow_field *,
+                         struct dt_cost_field *,
+                         struct dt_grid *);
+void dt_relax_flow_field_job(void *);
+unsigned int dt_relax_flow_field_chunk(struct dt_flow_field *,
+                               struct dt_cost_field *,
+                               struct dt_grid *,
+                               Uint32);
+void dt_point_flow_field_job(void *);
+void dt_point_flow_field_chunk(struct dt_flow_field *,
+                               struct dt_cost_field *,
+                               struct dt_grid *,
+                               Uint32);
+void dt_mark_grid_flow_fields_stale(struct dt_grid *);
+size_t dt_get_flow_field_memory_usage(struct dt_flow_field *,
+                                      struct dt_grid *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_path_cache.c                                */
+/******************************************************************************/
+struct dt_path_cache *dt_create_path_cache(struct dt_grid *);
+void dt_destroy_path_cache(struct dt_path_cache *);
+struct dt_path_cache *dt_get_grid_path_cache(struct dt_grid *);
+int dt_find_cached_path(struct dt_path_search *,
+                        struct dt_unit *,
+                        int,
+                        int,
+                        int,
+                        int,
+                        struct dt_path **);
+int dt_find_cached_oriented_path(struct dt_path_search *,
+                                 struct dt_unit *,
+                                 int,
+                                 int,
+                                 int,
+                                 int,
+                                 int,
+                                 struct dt_path **);
+int dt_find_path_through_cache(struct dt_path_search *,
+                               struct dt_unit *,
+                               struct dt_path_cache_key *,
+                               struct dt_path **);
+int dt_hash_path_cache_key(struct dt_path_cache_key *);
+bool dt_path_cache_keys_match(struct dt_path_cache_key *,
+                              struct dt_path_cache_key *);
+int dt_find_path_cache_entry(struct dt_path_cache *,
+                             struct dt_path_cache_key *);
+void dt_link_path_cache_entry(struct dt_path_cache *, int);
+void dt_unlink_path_cache_entry(struct dt_path_cache *, int);
+void dt_add_path_to_cache(struct dt_path_cache *,
+                          struct dt_path_cache_key *,
+                          struct dt_path *);
+Uint32 dt_get_path_cache_region(struct dt_path_cache *, int, int);
+void dt_remove_path_cache_entry(struct dt_path_cache *, int);
+void dt_invalidate_path_cache(struct dt_path_cache *, int, int, int, int);
+double dt_get_path_cache_hit_rate(struct dt_path_cache *);
+size_t dt_get_path_cache_memory_usage(struct dt_path_cache *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_replanner.c                                 */
+/******************************************************************************/
+struct dt_replanner *dt_create_replanner(struct dt_grid *,
+                                         struct dt_unit *,
+                                         int,
+                                         int,
+                                         int,
+                                         int);
+void dt_destroy_replanner(struct dt_replanner *);
+Uint32 dt_get_replanner_node(struct dt_replanner *, int, int);
+int dt_replan_path(struct dt_replanner *, int, int, struct dt_path **);
+void dt_mark_grid_replanners_changed(struct dt_grid *, int, int, int, int);
+void dt_apply_replanner_changes(struct dt_replanner *,
+                                struct dt_cost_field *);
+void dt_compute_replanner_path(struct dt_replanner *,
+                               struct dt_cost_field *);
+Uint32 dt_get_replanner_lookahead(struct dt_replanner *,
+                                  struct dt_cost_field *,
+                                  Uint32);
+Uint64 dt_get_replanner_key(struct dt_replanner *, Uint32);
+void dt_update_replanner_node(struct dt_replanner *, Uint32);
+void dt_push_replanner_heap(struct dt_replanner *, Uint32, Uint64);
+void dt_remove_replanner_heap(struct dt_replanner *, Uint32);
+void dt_sift_replanner_heap_up(struct dt_replanner *, size_t);
+void dt_sift_replanner_heap_down(struct dt_replanner *, size_t);
+struct dt_path *dt_build_replanned_path(struct dt_replanner *,
+                                        struct dt_cost_field *);
+int dt_get_replanner_next_step(struct dt_replanner *,
+                               struct dt_cost_field *,
+                               Uint32);
+size_t dt_get_replanner_memory_usage(struct dt_replanner *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_path_service.c                              */
+/******************************************************************************/
+struct dt_path_service *dt_create_path_service(struct dt_grid *,
+                                               struct dt_worker_pool *);
+void dt_destroy_path_service(struct dt_path_service *);
+void dt_solve_path_requests(struct dt_path_service *,
+                            struct dt_path_request *,
+                            int);
+int dt_prepare_path_request_fields(struct dt_grid *,
+                                   struct dt_path_request *,
+                                   int,
+                                   int);
+void dt_solve_path_requests_job(void *);
+size_t dt_get_path_service_memory_usage(struct dt_path_service *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_path_scheduler.c                            */
+/******************************************************************************/
+struct dt_path_scheduler *dt_create_path_scheduler(struct dt_grid *);
+void dt_destroy_path_scheduler(struct dt_path_scheduler *);
+struct dt_path_scheduler *dt_get_grid_path_scheduler(struct dt_grid *);
+void dt_request_unit_path(struct dt_path_scheduler *,
+                          struct dt_unit *,
+                          int,
+                          int,
+                          int,
+                          int);
+void dt_cancel_unit_path(struct dt_unit *);
+int dt_run_path_scheduler(struct dt_path_scheduler *, Uint64, long);
+bool dt_has_pending_paths(struct dt_grid *);
+size_t dt_get_path_scheduler_memory_usage(struct dt_path_scheduler *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_cooperative_path.c                          */
+/******************************************************************************/
+struct dt_reservation_table *dt_create_reservation_table();
+void dt_destroy_reservation_table(struct dt_reservation_table *);
+void dt_clear_reservation_table(struct dt_reservation_table *);
+bool dt_reserve_point(struct dt_reservation_table *,
+                      Uint32,
+                      Uint32,
+                      struct dt_unit *);
+struct dt_unit *dt_find_reservation(struct dt_reservation_table *,
+                                    Uint32,
+                                    Uint32);
+void dt_grow_reservation_table(struct dt_reservation_table *);
+void dt_init_coop_goal(struct dt_coop_goal *);
+struct dt_coop_goal *dt_get_coop_goal(struct dt_coop_planner *,
+                                      struct dt_path_request *,
+                                      struct dt_cost_field *);
+Uint32 dt_get_coop_goal_cost(struct dt_coop_planner *,
+                             struct dt_coop_goal *,
+                             struct dt_cost_field *,
+                             int,
+                             int);
+struct dt_coop_cost *dt_find_coop_cost(struct dt_coop_goal *, Uint32);
+struct dt_coop_cost *dt_add_coop_cost(struct dt_coop_goal *, Uint32);
+void dt_grow_coop_costs(struct dt_coop_goal *);
+void dt_push_coop_goal_heap(struct dt_coop_goal *, Uint32, Uint64);
+Uint32 dt_pop_coop_goal_heap(struct dt_coop_goal *);
+struct dt_coop_planner *dt_create_coop_planner(struct dt_grid *);
+void dt_destroy_coop_planner(struct dt_coop_planner *);
+void dt_plan_coop_paths(struct dt_coop_planner *,
+                        struct dt_path_request *,
+                        int);
+bool dt_search_coop_path(struct dt_coop_planner *,
+                         struct dt_path_request *,
+                         struct dt_coop_goal *);
+bool dt_is_coop_step_free(struct dt_coop_planner *,
+                          struct dt_unit *,
+                          Uint32,
+                          Uint32,
+                          Uint32,
+                          int,
+                          int);
+struct dt_path *dt_build_coop_path(struct dt_coop_planner *,
+                                   struct dt_path_request *,
+                                   Uint32);
+size_t dt_get_coop_planner_memory_usage(struct dt_coop_planner *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_movement_range.c                            */
+/******************************************************************************/
+struct dt_movement_range *dt_create_movement_range();
+void dt_destroy_movement_range(struct dt_movement_range *);
+void dt_clear_movement_range(struct dt_movement_range *);
+void dt_reserve_movement_range(struct dt_movement_range *,
+                               size_t,
+                               size_t,
+                               size_t);
+int dt_find_movement_range(struct dt_grid *,
+                           struct dt_unit *,
+                           int,
+                           int,
+                           struct dt_movement_range *);
+size_t dt_get_movement_range_memory_usage(struct dt_movement_range *);
 
 /******************************************************************************/
 /* prototypes for functions in dt_input_handler.c                             */
@@ -99,3 +646,131 @@ void dt_add_object_to_unsorted_list(struct dt_unsorted_list *, void *);
 void dt_destroy_list_element(struct dt_unit_list_element *);
 
 int dt_open_file(char *, char *, FILE **);
+void dt_close_file(FILE *);
+Uint64 dt_get_file_size(char *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_timer.c                                     */
+/******************************************************************************/
+Uint64 dt_get_time_us();
+
+/******************************************************************************/
+/* prototypes for functions in dt_benchmark.c                                 */
+/******************************************************************************/
+int dt_run_benchmark(char *);
+Uint32 dt_benchmark_random(Uint32 *);
+void dt_benchmark_fill_grid(struct dt_grid *, int, Uint32);
+Uint32 dt_benchmark_astar_pattern(struct dt_grid *, Uint32 *, Uint32);
+long dt_benchmark_flood_fill(struct dt_grid *, unsigned char *, Uint32 *);
+void dt_benchmark_grid_layouts();
+void dt_benchmark_map_loading();
+void dt_benchmark_chunk_compression();
+void dt_benchmark_fill_regions(struct dt_grid *, Uint32);
+bool dt_benchmark_grids_match(struct dt_grid *, struct dt_grid *);
+void dt_benchmark_map_generator();
+void dt_benchmark_count_terrain(struct dt_grid *, long *, long *);
+void dt_benchmark_path_search();
+void dt_benchmark_path_queries(struct dt_map_generator *,
+                               struct dt_path_search *,
+                               int,
+                               bool,
+                               const char *);
+void dt_benchmark_jump_point_search();
+void dt_benchmark_path_hierarchy();
+void dt_benchmark_flow_field();
+void dt_benchmark_movement_range();
+void dt_benchmark_path_cache();
+void dt_benchmark_replanner();
+void dt_benchmark_path_service();
+void dt_benchmark_path_scheduler();
+void dt_benchmark_cooperative_paths();
+void dt_benchmark_cooperative_map(int);
+void dt_benchmark_move_units(struct dt_grid *,
+                             struct dt_unit *,
+                             int *,
+                             int *,
+                             int *,
+                             int *,
+                             bool *);
+void dt_benchmark_region_map();
+void dt_benchmark_landmarks();
+void dt_benchmark_landmark_map(int, int);
+
+/******************************************************************************/
+/* prototypes for functions in dt_worker_pool.c                               */
+/******************************************************************************/
+struct dt_worker_pool *dt_create_worker_pool(int);
+void dt_destroy_worker_pool(struct dt_worker_pool *);
+void dt_run_worker_pool_jobs(struct dt_worker_pool *,
+                             DT_WORKER_JOB_FUNCTION,
+                             void *,
+                             size_t,
+                             int);
+void dt_work_on_worker_pool_batch(struct dt_worker_pool *);
+int dt_worker_pool_thread(void *);
+struct dt_worker_pool *dt_get_master_worker_pool();
+void dt_destroy_master_worker_pool();
+
+/******************************************************************************/
+/* prototypes for functions in dt_chunk_streamer.c                            */
+/******************************************************************************/
+int dt_open_streamed_map_file(char *, int, struct dt_grid **);
+bool dt_read_map_file_range(HANDLE, Uint64, void *, size_t);
+void dt_destroy_chunk_streamer(struct dt_chunk_streamer *);
+void dt_update_chunk_streamer(struct dt_grid *, struct dt_screen *);
+void dt_install_streamed_chunks(struct dt_grid *);
+void dt_add_loaded_streamed_chunk(struct dt_chunk_streamer *, size_t);
+void dt_request_streamed_chunks(struct dt_grid *, int *, int *);
+void dt_evict_streamed_chunks(struct dt_grid *, int *);
+bool dt_grid_chunk_has_units(struct dt_grid_chunk *);
+bool dt_is_grid_chunk_loaded(struct dt_grid *, int, int);
+int dt_chunk_streamer_thread(void *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_chunk_compression.c                         */
+/******************************************************************************/
+int dt_encode_map_file_chunk(struct dt_map_file_chunk *,
+                             int,
+                             unsigned char *,
+                             Uint32 *);
+bool dt_decode_map_file_chunk(unsigned char *,
+                              Uint32,
+                              int,
+                              struct dt_map_file_chunk *);
+bool dt_check_chunk_encoding(int, Uint32);
+void dt_shuffle_map_file_chunk(struct dt_map_file_chunk *, unsigned char *);
+void dt_unshuffle_map_file_chunk(unsigned char *, struct dt_map_file_chunk *);
+size_t dt_rle_encode(unsigned char *, size_t, unsigned char *);
+size_t dt_rle_repeat_length(unsigned char *, size_t, size_t);
+bool dt_rle_decode(unsigned char *, size_t, unsigned char *, size_t);
+struct dt_chunk_store *dt_create_chunk_store(size_t, int, int);
+void dt_destroy_chunk_store(struct dt_chunk_store *, size_t);
+void dt_compress_grid_chunks(struct dt_grid *, int, int);
+void dt_store_grid_chunk(struct dt_grid *, size_t);
+struct dt_grid_chunk *dt_inflate_grid_chunk(struct dt_grid *, size_t);
+void dt_add_inflated_grid_chunk(struct dt_chunk_store *, size_t);
+void dt_compact_grid_chunks(struct dt_grid *);
+
+/******************************************************************************/
+/* prototypes for functions in dt_map_generator.c                             */
+/******************************************************************************/
+struct dt_map_generator *dt_create_map_generator(int, int, Uint32, int);
+void dt_destroy_map_generator(struct dt_map_generator *);
+Uint32 dt_map_generator_hash(Uint32, int, int);
+double dt_map_generator_noise(Uint32, double, double);
+double dt_map_generator_fractal(Uint32, int, int, double, int);
+int dt_generate_map_point(struct dt_map_generator *, int, int, int *, bool *);
+void dt_generate_map_chunk(struct dt_map_generator *,
+                           int,
+                           int,
+                           struct dt_map_file_chunk *);
+void dt_generate_map_chunk_job(void *);
+void dt_generate_map_chunk_row(struct dt_map_generator *,
+                               int,
+                               struct dt_map_file_chunk *);
+void dt_add_generated_tile_types(struct dt_grid *);
+struct dt_grid *dt_generate_map(struct dt_map_generator *, int);
+bool dt_generate_map_file_chunk(void *, int, int, struct dt_map_file_chunk *);
+int dt_write_generated_map_file(struct dt_map_generator *, char *, int);
+void dt_place_generated_units(struct dt_map_generator *, int);
+int dt_generate_map_file(int, int, Uint32, char *, bool);
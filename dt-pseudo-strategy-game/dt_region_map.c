@@ -0,0 +1,710 @@
+/******************************************************************************/
+/* File: dt_region_map.c                                                      */
+/*                                                                            */
+/* Purpose: Region maps, which let a search tell at once that its goal is on  */
+/*          an island or behind walls it cannot cross, rather than finding    */
+/*          out by searching everywhere it can reach.                         */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_region_map                                             */
+/*                                                                            */
+/* Purpose: Create a region map for a cost field of a grid.                   */
+/*                                                                            */
+/* Returns: A pointer to the new map.                                         */
+/*                                                                            */
+/* Parameters: IN     grid - The grid of the cost field.                      */
+/*                                                                            */
+/* Operation: Allocate the labels, parents and queue. The map starts stale,   */
+/*            so it is labelled when it is first asked about.                 */
+/******************************************************************************/
+DT_REGION_MAP *dt_create_region_map(DT_GRID *grid)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REGION_MAP *map;
+
+  map = (DT_REGION_MAP *) dt_malloc(sizeof(DT_REGION_MAP));
+  map->width = grid->num_tiles_x;
+  map->height = grid->num_tiles_y;
+  map->labels = (Uint32 *) dt_calloc((size_t) grid->num_tiles_x *
+                                                 (size_t) grid->num_tiles_y,
+                                     sizeof(Uint32));
+  map->labels_size = DT_REGION_INITIAL_LABELS;
+  map->parents = (Uint32 *) dt_malloc(sizeof(Uint32) * map->labels_size);
+  map->parents[DT_REGION_NONE] = DT_REGION_NONE;
+  map->num_labels = 1;
+  map->queue = (Uint32 *) dt_malloc(sizeof(Uint32) * DT_REGION_SPLIT_POINTS);
+  map->stale = true;
+  map->num_builds = 0;
+  map->num_splits = 0;
+  map->num_rejected = 0;
+
+  return(map);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_region_map                                            */
+/*                                                                            */
+/* Purpose: Free a region map.                                                */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     map - The map to free.                                  */
+/*                                                                            */
+/* Operation: Free the arrays and then the map.                               */
+/******************************************************************************/
+void dt_destroy_region_map(DT_REGION_MAP *map)
+{
+  dt_free(map->labels);
+  dt_free(map->parents);
+  dt_free(map->queue);
+  dt_free(map);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_region_map                                                */
+/*                                                                            */
+/* Purpose: Find the region map of a cost field, ready to be asked about.     */
+/*                                                                            */
+/* Returns: A pointer to the map, which is owned by the cost field.           */
+/*                                                                            */
+/* Parameters: IN     grid - The grid of the cost field.                      */
+/*             IN/OUT field - The cost field.                                 */
+/*                                                                            */
+/* Operation: Create the map the first time it is asked for and label it in   */
+/*            full whenever it is stale. Like building the cost field this    */
+/*            writes to the map, so searches run on several threads at once   */
+/*            must bring it up to date before they start.                     */
+/******************************************************************************/
+DT_REGION_MAP *dt_get_region_map(DT_GRID *grid, DT_COST_FIELD *field)
+{
+  if (NULL == field->regions)
+  {
+    field->regions = dt_create_region_map(grid);
+  }
+  if (field->regions->stale)
+  {
+    dt_build_region_map(field->regions, field);
+  }
+
+  return(field->regions);
+}
+
+/******************************************************************************/
+/* Function: dt_build_region_map                                              */
+/*                                                                            */
+/* Purpose: Label every point of a region map from its cost field.            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     field - The cost field.                                 */
+/*                                                                            */
+/* Operation: Two passes over the points row by row. The first gives each     */
+/*            point which may be entered the label of the point west or north */
+/*            of it, or a new label if neither may be entered, and joins the  */
+/*            labels of the two when both may. The second points every label  */
+/*            straight at its root and gives every point its root, so that    */
+/*            until the map next changes each root is found in one look.      */
+/******************************************************************************/
+void dt_build_region_map(DT_REGION_MAP *map, DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *labels = map->labels;
+  Uint32 west;
+  Uint32 north;
+  Uint32 label;
+  size_t point = 0;
+  long index;
+  int grid_x;
+  int grid_y;
+
+  map->num_labels = 1;
+  for (grid_y = 0; grid_y < map->height; grid_y++)
+  {
+    for (grid_x = 0; grid_x < map->width; grid_x++, point++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      if (DT_COST_FIELD_BLOCKED == field->costs[index])
+      {
+        labels[point] = DT_REGION_NONE;
+        continue;
+      }
+      west = (grid_x > 0) ? labels[point - 1] : DT_REGION_NONE;
+      north = (grid_y > 0) ?
+                      labels[point - (size_t) map->width] : DT_REGION_NONE;
+      if (DT_REGION_NONE == west)
+      {
+        west = north;
+        north = DT_REGION_NONE;
+      }
+      if (DT_REGION_NONE == west)
+      {
+        labels[point] = dt_new_region_label(map);
+      }
+      else if ((DT_REGION_NONE == north) || (north == west))
+      {
+        labels[point] = west;
+      }
+      else
+      {
+        labels[point] = dt_join_regions(map, west, north);
+      }
+    }
+  }
+
+  /****************************************************************************/
+  /* Flatten the sets. A label is only ever joined under a lower one, so the  */
+  /* parent of each label is already flat when it is reached.                 */
+  /****************************************************************************/
+  for (label = 1; label < map->num_labels; label++)
+  {
+    map->parents[label] = map->parents[map->parents[label]];
+  }
+  for (point = 0; point < (size_t) map->width * (size_t) map->height; point++)
+  {
+    labels[point] = map->parents[labels[point]];
+  }
+  map->stale = false;
+  (map->num_builds)++;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_new_region_label                                              */
+/*                                                                            */
+/* Purpose: Give out a new label in a set of its own.                         */
+/*                                                                            */
+/* Returns: The label.                                                        */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*                                                                            */
+/* Operation: Double the parents if they are full.                            */
+/******************************************************************************/
+Uint32 dt_new_region_label(DT_REGION_MAP *map)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *parents;
+
+  if (map->num_labels == map->labels_size)
+  {
+    parents = (Uint32 *) dt_malloc(sizeof(Uint32) * map->labels_size * 2);
+    memcpy(parents, map->parents, sizeof(Uint32) * map->num_labels);
+    dt_free(map->parents);
+    map->parents = parents;
+    map->labels_size *= 2;
+  }
+  map->parents[map->num_labels] = map->num_labels;
+
+  return((map->num_labels)++);
+}
+
+/******************************************************************************/
+/* Function: dt_join_regions                                                  */
+/*                                                                            */
+/* Purpose: Join the sets two labels are in.                                  */
+/*                                                                            */
+/* Returns: The root of the joined set.                                       */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     first_label - A label of one set.                       */
+/*             IN     second_label - A label of the other set.                */
+/*                                                                            */
+/* Operation: The higher root is put under the lower, and both labels are     */
+/*            pointed straight at the root so the chains stay short.          */
+/******************************************************************************/
+Uint32 dt_join_regions(DT_REGION_MAP *map,
+                       Uint32 first_label,
+                       Uint32 second_label)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 first_root;
+  Uint32 second_root;
+  Uint32 root;
+
+  first_root = dt_find_region_root(map, first_label);
+  second_root = dt_find_region_root(map, second_label);
+  root = MIN(first_root, second_root);
+  map->parents[first_root] = root;
+  map->parents[second_root] = root;
+  map->parents[first_label] = root;
+  map->parents[second_label] = root;
+
+  return(root);
+}
+
+/******************************************************************************/
+/* Function: dt_update_region_map                                             */
+/*                                                                            */
+/* Purpose: Bring a region map up to date after an area of its cost field has */
+/*          changed.                                                          */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     field - The cost field, already up to date.             */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Open or close each point of the area which can now be entered   */
+/*            and could not before, or the other way round. A change of cost  */
+/*            alone leaves the regions as they were. Nothing is done to a     */
+/*            stale map, and a map which has given out more labels than it    */
+/*            has points is marked stale so that labelling it again in full   */
+/*            reclaims them.                                                  */
+/******************************************************************************/
+void dt_update_region_map(DT_REGION_MAP *map,
+                          DT_COST_FIELD *field,
+                          int first_x,
+                          int first_y,
+                          int last_x,
+                          int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  long index;
+  bool open;
+  bool was_open;
+  int grid_x;
+  int grid_y;
+
+  for (grid_y = first_y; (grid_y <= last_y) && !map->stale; grid_y++)
+  {
+    for (grid_x = first_x; (grid_x <= last_x) && !map->stale; grid_x++)
+    {
+      index = dt_get_cost_field_index(field, grid_x, grid_y);
+      open = (DT_COST_FIELD_BLOCKED != field->costs[index]);
+      was_open = (DT_REGION_NONE !=
+                   map->labels[((size_t) grid_y * (size_t) map->width) +
+                                                          (size_t) grid_x]);
+      if (open && !was_open)
+      {
+        dt_open_region_point(map, grid_x, grid_y);
+      }
+      else if (!open && was_open)
+      {
+        dt_close_region_point(map, grid_x, grid_y);
+      }
+    }
+  }
+  if ((size_t) map->num_labels > (size_t) map->width * (size_t) map->height)
+  {
+    map->stale = true;
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_open_region_point                                             */
+/*                                                                            */
+/* Purpose: Label a point of a region map which can now be entered.           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: The point joins the regions of the points north, east, south    */
+/*            and west of it into one, or starts a region of its own if none  */
+/*            of them can be entered.                                         */
+/******************************************************************************/
+void dt_open_region_point(DT_REGION_MAP *map, int grid_x, int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 label = DT_REGION_NONE;
+  Uint32 next_label;
+  size_t point;
+  int direction;
+  int next_x;
+  int next_y;
+
+  for (direction = NORTH; direction < NORTH_1; direction += 2)
+  {
+    next_x = grid_x + dt_get_orientation_step_x(direction);
+    next_y = grid_y + dt_get_orientation_step_y(direction);
+    if ((next_x < 0) || (next_x >= map->width) ||
+        (next_y < 0) || (next_y >= map->height))
+    {
+      continue;
+    }
+    next_label = map->labels[((size_t) next_y * (size_t) map->width) +
+                                                          (size_t) next_x];
+    if (DT_REGION_NONE == next_label)
+    {
+      continue;
+    }
+    label = (DT_REGION_NONE == label) ?
+                            dt_find_region_root(map, next_label) :
+                            dt_join_regions(map, label, next_label);
+  }
+
+  point = ((size_t) grid_y * (size_t) map->width) + (size_t) grid_x;
+  map->labels[point] = (DT_REGION_NONE == label) ?
+                                             dt_new_region_label(map) : label;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_close_region_point                                            */
+/*                                                                            */
+/* Purpose: Remove a point of a region map which can no longer be entered,    */
+/*          splitting its region if it was the only way between two parts.    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: The points north, east, south and west of the point which can   */
+/*            be entered are its sides, and start out in groups of their own. */
+/*            While more than one group is left, flood from a side of each    */
+/*            group in turn until one meets another group, when the two are   */
+/*            joined, or has nowhere left to go, when it is cut off and given */
+/*            a new label. The last group keeps the old label. The floods are */
+/*            limited to DT_REGION_FIRST_FLOOD points and the limit raised    */
+/*            each time none of them settles anything, so a small part cut    */
+/*            off from a large one is found after flooding the small part,    */
+/*            whichever side comes first. Around a point in the open the      */
+/*            first floods meet within a few points. If the limit passes      */
+/*            DT_REGION_SPLIT_POINTS the map is marked stale instead.         */
+/******************************************************************************/
+void dt_close_region_point(DT_REGION_MAP *map, int grid_x, int grid_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 sides[4];
+  int groups[4];
+  int num_sides = 0;
+  int num_groups;
+  int max_points = DT_REGION_FIRST_FLOOD;
+  int result = DT_REGION_FLOOD_LIMIT;
+  int direction;
+  int next_x;
+  int next_y;
+  int side;
+  int group;
+
+  map->labels[((size_t) grid_y * (size_t) map->width) + (size_t) grid_x] =
+                                                               DT_REGION_NONE;
+  for (direction = NORTH; direction < NORTH_1; direction += 2)
+  {
+    next_x = grid_x + dt_get_orientation_step_x(direction);
+    next_y = grid_y + dt_get_orientation_step_y(direction);
+    if ((next_x >= 0) && (next_x < map->width) &&
+        (next_y >= 0) && (next_y < map->height) &&
+        (DT_REGION_NONE != map->labels[((size_t) next_y *
+                                                     (size_t) map->width) +
+                                                          (size_t) next_x]))
+    {
+      sides[num_sides] = ((Uint32) next_y * (Uint32) map->width) +
+                                                           (Uint32) next_x;
+      groups[num_sides] = num_sides;
+      num_sides++;
+    }
+  }
+
+  num_groups = num_sides;
+  while (num_groups > 1)
+  {
+    /**************************************************************************/
+    /* Flood from a side of each group left until one settles something.      */
+    /**************************************************************************/
+    for (group = 0; group < num_sides; group++)
+    {
+      for (side = 0; (side < num_sides) && (groups[side] != group); side++)
+      {
+      }
+      if (side == num_sides)
+      {
+        continue;
+      }
+      result = dt_flood_region_side(map,
+                                    sides,
+                                    groups,
+                                    num_sides,
+                                    side,
+                                    max_points);
+      if (DT_REGION_FLOOD_LIMIT != result)
+      {
+        break;
+      }
+    }
+
+    if (DT_REGION_FLOOD_LIMIT != result)
+    {
+      num_groups--;
+      max_points = DT_REGION_FIRST_FLOOD;
+    }
+    else if (max_points < DT_REGION_SPLIT_POINTS)
+    {
+      max_points = MIN(max_points * 4, DT_REGION_SPLIT_POINTS);
+    }
+    else
+    {
+      map->stale = true;
+      break;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_flood_region_side                                             */
+/*                                                                            */
+/* Purpose: Flood from one side of a closed point of a region map to find out */
+/*          whether the side's group is still joined to another.              */
+/*                                                                            */
+/* Returns: One of DT_REGION_FLOOD_RESULTS.                                   */
+/*                                                                            */
+/* Parameters: IN/OUT map - The region map.                                   */
+/*             IN     sides - The point of each side.                         */
+/*             IN/OUT groups - The group of each side, or -1 for a side which */
+/*                             has been cut off.                              */
+/*             IN     num_sides - The number of sides.                        */
+/*             IN     side - The side to flood from.                          */
+/*             IN     max_points - The most points to flood.                  */
+/*                                                                            */
+/* Operation: Breadth first from the side, marking each point flooded. A side */
+/*            of another group which is reached joins this side's group. If   */
+/*            the flood runs out of points first, every point of the group's  */
+/*            part has been flooded and is given a new label, and the group's */
+/*            sides are left out from then on. Otherwise the marks are taken  */
+/*            off again.                                                      */
+/******************************************************************************/
+int dt_flood_region_side(DT_REGION_MAP *map,
+                         Uint32 *sides,
+                         int *groups,
+                         int num_sides,
+                         int side,
+                         int max_points)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 *labels = map->labels;
+  Uint32 point;
+  Uint32 next_point;
+  Uint32 label;
+  int result = DT_REGION_FLOOD_CUT_OFF;
+  int group = groups[side];
+  int other_group;
+  int num_queued = 1;
+  int head;
+  int direction;
+  int grid_x;
+  int grid_y;
+  int next_x;
+  int next_y;
+  int ii;
+  int jj;
+
+  labels[sides[side]] |= DT_REGION_MARK;
+  map->queue[0] = sides[side];
+  for (head = 0;
+       (head < num_queued) && (DT_REGION_FLOOD_CUT_OFF == result);
+       head++)
+  {
+    point = map->queue[head];
+    grid_x = (int) (point % (Uint32) map->width);
+    grid_y = (int) (point / (Uint32) map->width);
+    for (direction = NORTH; direction < NORTH_1; direction += 2)
+    {
+      next_x = grid_x + dt_get_orientation_step_x(direction);
+      next_y = grid_y + dt_get_orientation_step_y(direction);
+      next_point = ((Uint32) next_y * (Uint32) map->width) + (Uint32) next_x;
+      if ((next_x < 0) || (next_x >= map->width) ||
+          (next_y < 0) || (next_y >= map->height) ||
+          (DT_REGION_NONE == labels[next_point]) ||
+          (0 != (labels[next_point] & DT_REGION_MARK)))
+      {
+        continue;
+      }
+      if (max_points == num_queued)
+      {
+        result = DT_REGION_FLOOD_LIMIT;
+        break;
+      }
+      labels[next_point] |= DT_REGION_MARK;
+      map->queue[num_queued] = next_point;
+      num_queued++;
+
+      /************************************************************************/
+      /* Join the group of any other side reached.                            */
+      /************************************************************************/
+      for (ii = 0; ii < num_sides; ii++)
+      {
+        if ((sides[ii] == next_point) && (groups[ii] >= 0) &&
+            (groups[ii] != group))
+        {
+          result = DT_REGION_FLOOD_MET;
+          other_group = groups[ii];
+          for (jj = 0; jj < num_sides; jj++)
+          {
+            if (other_group == groups[jj])
+            {
+              groups[jj] = group;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /****************************************************************************/
+  /* Give a part which was cut off a label of its own, or take the marks off. */
+  /****************************************************************************/
+  if (DT_REGION_FLOOD_CUT_OFF == result)
+  {
+    label = dt_new_region_label(map);
+    for (ii = 0; ii < num_queued; ii++)
+    {
+      labels[map->queue[ii]] = label;
+    }
+    for (ii = 0; ii < num_sides; ii++)
+    {
+      if (group == groups[ii])
+      {
+        groups[ii] = -1;
+      }
+    }
+    (map->num_splits)++;
+  }
+  else
+  {
+    for (ii = 0; ii < num_queued; ii++)
+    {
+      labels[map->queue[ii]] &= ~DT_REGION_MARK;
+    }
+  }
+
+  return(result);
+}
+
+/******************************************************************************/
+/* Function: dt_is_goal_in_start_region                                       */
+/*                                                                            */
+/* Purpose: Check whether a goal is in a region a unit can reach from its     */
+/*          start.                                                            */
+/*                                                                            */
+/* Returns: true if the goal may be reachable, false if no search could find  */
+/*          a path to it.                                                     */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN/OUT field - The cost field of the unit.                     */
+/*             IN     start_x - The x coordinate of the start.                */
+/*             IN     start_y - The y coordinate of the start.                */
+/*             IN     goal_x - The x coordinate of the goal, which must be on */
+/*                             the grid and may be entered.                   */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Compare the roots of the labels of the start and goal. A unit   */
+/*            may stand on a point which cannot be entered, and then it can   */
+/*            reach the regions of the points beside it instead. Only         */
+/*            straight steps are checked, as a diagonal step off the start    */
+/*            needs both the points beside the step open, and they are in the */
+/*            same region as the point stepped to. Each goal turned down is   */
+/*            counted in the map.                                             */
+/******************************************************************************/
+bool dt_is_goal_in_start_region(DT_GRID *grid,
+                                DT_COST_FIELD *field,
+                                int start_x,
+                                int start_y,
+                                int goal_x,
+                                int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REGION_MAP *map;
+  Uint32 goal_root;
+  Uint32 label;
+  bool reachable = true;
+  int direction;
+  int next_x;
+  int next_y;
+
+  if ((start_x == goal_x) && (start_y == goal_y))
+  {
+    goto EXIT_LABEL;
+  }
+  map = dt_get_region_map(grid, field);
+  goal_root = dt_find_region_root(map,
+                                  map->labels[((size_t) goal_y *
+                                                     (size_t) map->width) +
+                                                            (size_t) goal_x]);
+  label = map->labels[((size_t) start_y * (size_t) map->width) +
+                                                          (size_t) start_x];
+  if (DT_REGION_NONE != label)
+  {
+    reachable = (dt_find_region_root(map, label) == goal_root);
+  }
+  else
+  {
+    reachable = false;
+    for (direction = NORTH;
+         (direction < NORTH_1) && !reachable;
+         direction += 2)
+    {
+      next_x = start_x + dt_get_orientation_step_x(direction);
+      next_y = start_y + dt_get_orientation_step_y(direction);
+      if ((next_x >= 0) && (next_x < map->width) &&
+          (next_y >= 0) && (next_y < map->height))
+      {
+        label = map->labels[((size_t) next_y * (size_t) map->width) +
+                                                          (size_t) next_x];
+        reachable = (DT_REGION_NONE != label) &&
+                    (dt_find_region_root(map, label) == goal_root);
+      }
+    }
+  }
+  if (!reachable)
+  {
+    (map->num_rejected)++;
+  }
+
+EXIT_LABEL:
+
+  return(reachable);
+}
+
+/******************************************************************************/
+/* Function: dt_get_region_map_memory_usage                                   */
+/*                                                                            */
+/* Purpose: Report how much memory a region map is using.                     */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the map.                        */
+/*                                                                            */
+/* Parameters: IN     map - The region map.                                   */
+/*                                                                            */
+/* Operation: Add the labels, parents and queue to the map itself.            */
+/******************************************************************************/
+size_t dt_get_region_map_memory_usage(DT_REGION_MAP *map)
+{
+  return(sizeof(DT_REGION_MAP) +
+         (sizeof(Uint32) * (size_t) map->width * (size_t) map->height) +
+         (sizeof(Uint32) * map->labels_size) +
+         (sizeof(Uint32) * DT_REGION_SPLIT_POINTS));
+}
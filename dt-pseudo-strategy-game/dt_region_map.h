@@ -0,0 +1,113 @@
+/******************************************************************************/
+/* File: dt_region_map.h                                                      */
+/*                                                                            */
+/* Purpose: Definitions for region maps, which label the points of a cost     */
+/*          field by the connected region they are in so that a search to a   */
+/*          goal which cannot be reached is turned down without being run.    */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of region maps.                                                 */
+/*                                                                            */
+/* DT_REGION_NONE - The label of a point which may not be entered.            */
+/* DT_REGION_MARK - Set in the label of a point while a split is looked for,  */
+/*                  to show it has been visited.                              */
+/* DT_REGION_FIRST_FLOOD - The most points visited from each side of a point  */
+/*                         which has been closed when first looking for a way */
+/*                         round it. The limit is raised four times over each */
+/*                         time no side settles anything.                     */
+/* DT_REGION_SPLIT_POINTS - The highest the limit is raised to. If that does  */
+/*                          not settle whether the region is split the whole  */
+/*                          map is labelled again.                            */
+/* DT_REGION_INITIAL_LABELS - The number of labels a map has room for to      */
+/*                            start with. It doubles whenever it fills.       */
+/******************************************************************************/
+#define DT_REGION_NONE 0
+#define DT_REGION_MARK 0x80000000u
+#define DT_REGION_FIRST_FLOOD 64
+#define DT_REGION_SPLIT_POINTS 16384
+#define DT_REGION_INITIAL_LABELS 256
+
+/******************************************************************************/
+/* Group: DT_REGION_FLOOD_RESULTS                                             */
+/*                                                                            */
+/* How a flood from one side of a closed point ended.                         */
+/*                                                                            */
+/* DT_REGION_FLOOD_MET - It reached a side of another group.                  */
+/* DT_REGION_FLOOD_CUT_OFF - It ran out of points to flood.                   */
+/* DT_REGION_FLOOD_LIMIT - It flooded as many points as it was allowed.       */
+/******************************************************************************/
+#define DT_REGION_FLOOD_MET 0
+#define DT_REGION_FLOOD_CUT_OFF 1
+#define DT_REGION_FLOOD_LIMIT 2
+
+/******************************************************************************/
+/* DT_REGION_MAP:                                                             */
+/*                                                                            */
+/* The connected regions of a cost field. As a diagonal step may not cut the  */
+/* corner of a blocked point, two points are connected exactly when a path of */
+/* straight steps joins them, so the regions are those of the points which    */
+/* may be entered taken four ways. Each such point has a label, and labels    */
+/* are joined into sets, one set to a region. Two points are in the same      */
+/* region when their labels have the same root. Labels are kept by cost       */
+/* field, so each class of unit has its own regions and they always agree     */
+/* with the points its searches may enter.                                    */
+/*                                                                            */
+/* The map follows changes to its field a point at a time. A point which is   */
+/* opened joins the sets of the points beside it. A point which is closed may */
+/* cut its region in two, so bounded floods from the sides of it look for     */
+/* each other, and a side which is cut off is given a label of its own. If    */
+/* the floods reach their limit before that is settled the map is marked to   */
+/* be labelled again in full, which happens when it is next asked about.      */
+/*                                                                            */
+/* width - The width of the grid.                                             */
+/* height - The height of the grid.                                           */
+/* labels - The label of each point, stored row by row, or DT_REGION_NONE.    */
+/* parents - The label each label is joined to, which is itself for a root.   */
+/* num_labels - The number of labels given out, including DT_REGION_NONE.     */
+/* labels_size - The number of entries parents has room for.                  */
+/* queue - The points visited by the flood looking for a split.               */
+/* stale - Set when the labels must be worked out again in full.              */
+/* num_builds - The number of times the map has been labelled in full.        */
+/* num_splits - The number of regions cut off by closing a point.             */
+/* num_rejected - The number of searches turned down as their goal is in      */
+/*                another region.                                             */
+/******************************************************************************/
+typedef struct dt_region_map
+{
+  int width;
+  int height;
+  Uint32 *labels;
+  Uint32 *parents;
+  Uint32 num_labels;
+  Uint32 labels_size;
+  Uint32 *queue;
+  bool stale;
+  long num_builds;
+  long num_splits;
+  long num_rejected;
+} DT_REGION_MAP;
+
+/******************************************************************************/
+/* Function: dt_find_region_root                                              */
+/*                                                                            */
+/* Purpose: Find the label at the root of the set a label is in.              */
+/*                                                                            */
+/* Returns: The root label.                                                   */
+/*                                                                            */
+/* Parameters: IN     map - The region map.                                   */
+/*             IN     label - The label.                                      */
+/*                                                                            */
+/* Operation: Follow the parents to the root. Nothing is written, so searches */
+/*            on several threads may ask at once. The map shortens the chains */
+/*            itself as it changes.                                           */
+/******************************************************************************/
+static inline Uint32 dt_find_region_root(DT_REGION_MAP *map, Uint32 label)
+{
+  while (map->parents[label] != label)
+  {
+    label = map->parents[label];
+  }
+
+  return(label);
+}
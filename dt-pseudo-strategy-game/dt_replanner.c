@@ -0,0 +1,1037 @@
+/******************************************************************************/
+/* File: dt_replanner.c                                                       */
+/*                                                                            */
+/* Purpose: Replanners. A unit following a path keeps the search that found   */
+/*          it, and when points of the grid are blocked, freed or taken by    */
+/*          other units only the part of the search they affect is redone.    */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_replanner                                              */
+/*                                                                            */
+/* Purpose: Create a replanner for a unit moving to a goal and register it    */
+/*          with the grid.                                                    */
+/*                                                                            */
+/* Returns: A pointer to the replanner.                                       */
+/*                                                                            */
+/* Parameters: IN/OUT grid - The grid the unit moves over.                    */
+/*             IN     unit - The unit. Its class and speed set the cost of    */
+/*                           each step.                                       */
+/*             IN     start_x - The x coordinate the unit starts at.          */
+/*             IN     start_y - The y coordinate the unit starts at.          */
+/*             IN     goal_x - The x coordinate of the goal.                  */
+/*             IN     goal_y - The y coordinate of the goal.                  */
+/*                                                                            */
+/* Operation: Every point starts with no cost to the goal. The goal has a     */
+/*            lookahead of 0 and is queued, so the first plan searches out    */
+/*            from it. Note the points held by other units. No searching is   */
+/*            done until the first plan.                                      */
+/******************************************************************************/
+DT_REPLANNER *dt_create_replanner(DT_GRID *grid,
+                                  DT_UNIT *unit,
+                                  int start_x,
+                                  int start_y,
+                                  int goal_x,
+                                  int goal_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REPLANNER *replanner;
+  DT_UNIT *other_unit;
+  size_t num_words;
+  size_t node;
+  Uint32 goal;
+  int grid_x;
+  int grid_y;
+
+  replanner = (DT_REPLANNER *) dt_malloc(sizeof(DT_REPLANNER));
+  replanner->grid = grid;
+  replanner->unit = unit;
+  replanner->goal_x = goal_x;
+  replanner->goal_y = goal_y;
+  replanner->start_x = start_x;
+  replanner->start_y = start_y;
+  replanner->width = grid->num_tiles_x + 2;
+  replanner->num_nodes = (size_t) replanner->width *
+                                              (size_t) (grid->num_tiles_y + 2);
+  replanner->min_cost = (Uint32) dt_get_min_move_cost(unit);
+  replanner->key_modifier = 0;
+
+  replanner->cost = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                         replanner->num_nodes);
+  replanner->lookahead = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                              replanner->num_nodes);
+  replanner->heap_index = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                               replanner->num_nodes);
+  for (node = 0; node < replanner->num_nodes; node++)
+  {
+    replanner->cost[node] = DT_REPLAN_NO_COST;
+    replanner->lookahead[node] = DT_REPLAN_NO_COST;
+    replanner->heap_index[node] = DT_REPLAN_NOT_QUEUED;
+  }
+  replanner->heap.size = DT_PATH_HEAP_INITIAL_SIZE;
+  replanner->heap.num_entries = 0;
+  replanner->heap.nodes = (Uint32 *) dt_malloc(sizeof(Uint32) *
+                                               replanner->heap.size);
+  replanner->heap.keys = (Uint64 *) dt_malloc(sizeof(Uint64) *
+                                              replanner->heap.size);
+
+  /****************************************************************************/
+  /* Note every point held by a unit other than this one.                     */
+  /****************************************************************************/
+  num_words = (replanner->num_nodes + DT_GRID_WORD_MASK) >> DT_GRID_WORD_SHIFT;
+  replanner->occupied = (Uint32 *) dt_malloc(sizeof(Uint32) * num_words);
+  memset(replanner->occupied, 0, sizeof(Uint32) * num_words);
+  for (grid_y = 0; grid_y < grid->num_tiles_y; grid_y++)
+  {
+    for (grid_x = 0; grid_x < grid->num_tiles_x; grid_x++)
+    {
+      other_unit = dt_get_grid_element(grid, grid_x, grid_y)->unit;
+      if ((NULL != other_unit) && (unit != other_unit))
+      {
+        node = (size_t) dt_get_replanner_node(replanner, grid_x, grid_y);
+        replanner->occupied[node >> DT_GRID_WORD_SHIFT] |=
+                                   (Uint32) 1 << (node & DT_GRID_WORD_MASK);
+      }
+    }
+  }
+
+  replanner->num_changes = 0;
+  replanner->nodes_expanded = 0;
+  replanner->num_plans = 0;
+  replanner->total_nodes_expanded = 0;
+  replanner->total_plan_time_us = 0;
+
+  /****************************************************************************/
+  /* Queue the goal, if it is on the grid. It is queued even if it cannot be  */
+  /* entered yet, in case it is opened later.                                 */
+  /****************************************************************************/
+  if ((goal_x >= 0) && (goal_x < grid->num_tiles_x) &&
+      (goal_y >= 0) && (goal_y < grid->num_tiles_y))
+  {
+    goal = dt_get_replanner_node(replanner, goal_x, goal_y);
+    replanner->lookahead[goal] = 0;
+    dt_update_replanner_node(replanner, goal);
+  }
+
+  replanner->next_replanner = grid->replanners;
+  grid->replanners = replanner;
+
+  return(replanner);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_replanner                                             */
+/*                                                                            */
+/* Purpose: Free a replanner, removing it from its grid.                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner to free.                      */
+/*                                                                            */
+/* Operation: Find the link to the replanner in the grid's list and point it  */
+/*            past the replanner, then free the replanner's memory.           */
+/******************************************************************************/
+void dt_destroy_replanner(DT_REPLANNER *replanner)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REPLANNER **link;
+
+  link = &(replanner->grid->replanners);
+  while (*link != replanner)
+  {
+    link = &((*link)->next_replanner);
+  }
+  *link = replanner->next_replanner;
+
+  dt_free(replanner->cost);
+  dt_free(replanner->lookahead);
+  dt_free(replanner->heap_index);
+  dt_free(replanner->heap.nodes);
+  dt_free(replanner->heap.keys);
+  dt_free(replanner->occupied);
+  dt_free(replanner);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_replanner_node                                            */
+/*                                                                            */
+/* Purpose: Find the number of a point of the grid in a replanner.            */
+/*                                                                            */
+/* Returns: The number of the point.                                          */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*             IN     grid_x - The x coordinate of the point.                 */
+/*             IN     grid_y - The y coordinate of the point.                 */
+/*                                                                            */
+/* Operation: Points are numbered row by row with a border around the grid.   */
+/******************************************************************************/
+Uint32 dt_get_replanner_node(DT_REPLANNER *replanner, int grid_x, int grid_y)
+{
+  return((Uint32) (((grid_y + 1) * replanner->width) + grid_x + 1));
+}
+
+/******************************************************************************/
+/* Function: dt_replan_path                                                   */
+/*                                                                            */
+/* Purpose: Find the cheapest path for a replanner's unit from where it is to */
+/*          its goal, repairing the last plan for any changes to the grid.    */
+/*                                                                            */
+/* Returns: One of DT_PATH_RETURN_CODES.                                      */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     start_x - The x coordinate the unit is at now.          */
+/*             IN     start_y - The y coordinate the unit is at now.          */
+/*             OUT    path - The path found, to be freed with                 */
+/*                           dt_destroy_path, or NULL if none was found.      */
+/*                                                                            */
+/* Operation: The heuristic is measured from the unit, so when the unit has   */
+/*            moved every key queued before is too high by up to the distance */
+/*            moved. Rather than rekey the heap that distance is added to the */
+/*            keys of everything queued from now on. Then recompute the       */
+/*            lookahead of every point beside a change, and search until the  */
+/*            unit's point is settled. A goal in a region the unit cannot     */
+/*            reach is turned down first, and the plan is left as it was to   */
+/*            be repaired next time.                                          */
+/******************************************************************************/
+int dt_replan_path(DT_REPLANNER *replanner,
+                   int start_x,
+                   int start_y,
+                   DT_PATH **path)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ret_code = DT_PATH_FOUND;
+  DT_COST_FIELD *field;
+  Uint64 start_time;
+  Uint32 start;
+
+  start_time = dt_get_time_us();
+  *path = NULL;
+  field = dt_get_grid_cost_field(replanner->grid, replanner->unit);
+  if (!dt_check_path_points(replanner->grid,
+                            field,
+                            start_x,
+                            start_y,
+                            replanner->goal_x,
+                            replanner->goal_y))
+  {
+    ret_code = DT_PATH_BAD_POINT;
+    goto EXIT_LABEL;
+  }
+  if (!dt_is_goal_in_start_region(replanner->grid,
+                                  field,
+                                  start_x,
+                                  start_y,
+                                  replanner->goal_x,
+                                  replanner->goal_y))
+  {
+    ret_code = DT_PATH_NOT_FOUND;
+    goto EXIT_LABEL;
+  }
+  replanner->nodes_expanded = 0;
+
+  replanner->key_modifier += replanner->min_cost *
+                 dt_get_octile_distance(start_x - replanner->start_x,
+                                        start_y - replanner->start_y);
+  replanner->start_x = start_x;
+  replanner->start_y = start_y;
+  start = dt_get_replanner_node(replanner, start_x, start_y);
+
+  /****************************************************************************/
+  /* Points which cannot be entered are left out of the search, but the unit  */
+  /* may be standing on one.                                                  */
+  /****************************************************************************/
+  dt_apply_replanner_changes(replanner, field);
+  if ((DT_COST_FIELD_BLOCKED == field->costs[start]) &&
+      (dt_get_replanner_node(replanner,
+                             replanner->goal_x,
+                             replanner->goal_y) != start))
+  {
+    replanner->lookahead[start] = dt_get_replanner_lookahead(replanner,
+                                                             field,
+                                                             start);
+    dt_update_replanner_node(replanner, start);
+  }
+
+  dt_compute_replanner_path(replanner, field);
+  if (DT_REPLAN_NO_COST == replanner->cost[start])
+  {
+    ret_code = DT_PATH_NOT_FOUND;
+  }
+  else
+  {
+    *path = dt_build_replanned_path(replanner, field);
+  }
+
+  (replanner->num_plans)++;
+  replanner->total_nodes_expanded += (Uint64) replanner->nodes_expanded;
+  replanner->total_plan_time_us += dt_get_time_us() - start_time;
+
+EXIT_LABEL:
+
+  return(ret_code);
+}
+
+/******************************************************************************/
+/* Function: dt_mark_grid_replanners_changed                                  */
+/*                                                                            */
+/* Purpose: Tell every replanner of a grid that an area of it has changed.    */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     grid - The grid.                                        */
+/*             IN     first_x - The x coordinate of the left of the area.     */
+/*             IN     first_y - The y coordinate of the top of the area.      */
+/*             IN     last_x - The x coordinate of the right of the area.     */
+/*             IN     last_y - The y coordinate of the bottom of the area.    */
+/*                                                                            */
+/* Operation: Add the area to the changes of each replanner, which are worked */
+/*            through at its next plan. A replanner which never plans again   */
+/*            does no work for the change. An area already covered by one of  */
+/*            the changes is not added again. Once a replanner has            */
+/*            DT_REPLAN_MAX_CHANGES, the area is merged into the change whose */
+/*            bounding box grows least by taking it in. Working through a     */
+/*            larger area than changed gives the same plan, so this only      */
+/*            costs time at the next plan.                                    */
+/******************************************************************************/
+void dt_mark_grid_replanners_changed(DT_GRID *grid,
+                                     int first_x,
+                                     int first_y,
+                                     int last_x,
+                                     int last_y)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_REPLANNER *replanner;
+  DT_REPLAN_CHANGE *change;
+  DT_REPLAN_CHANGE *best_change;
+  long growth;
+  long best_growth;
+  int ii;
+
+  for (replanner = grid->replanners;
+       NULL != replanner;
+       replanner = replanner->next_replanner)
+  {
+    /**************************************************************************/
+    /* Find the change which grows least by taking in the area.               */
+    /**************************************************************************/
+    best_change = NULL;
+    best_growth = 0;
+    for (ii = 0; ii < replanner->num_changes; ii++)
+    {
+      change = &(replanner->changes[ii]);
+      growth = ((long) (MAX(change->last_x, last_x) -
+                        MIN(change->first_x, first_x) + 1) *
+                (long) (MAX(change->last_y, last_y) -
+                        MIN(change->first_y, first_y) + 1)) -
+               ((long) (change->last_x - change->first_x + 1) *
+                (long) (change->last_y - change->first_y + 1));
+      if ((NULL == best_change) || (growth < best_growth))
+      {
+        best_change = change;
+        best_growth = growth;
+      }
+    }
+
+    /**************************************************************************/
+    /* Add the area if there is room and it is not already covered, and       */
+    /* otherwise merge it into that change.                                   */
+    /**************************************************************************/
+    if ((NULL != best_change) &&
+        ((0 == best_growth) ||
+         (DT_REPLAN_MAX_CHANGES == replanner->num_changes)))
+    {
+      best_change->first_x = MIN(best_change->first_x, first_x);
+      best_change->first_y = MIN(best_change->first_y, first_y);
+      best_change->last_x = MAX(best_change->last_x, last_x);
+      best_change->last_y = MAX(best_change->last_y, last_y);
+    }
+    else
+    {
+      change = &(replanner->changes[replanner->num_changes]);
+      change->first_x = first_x;
+      change->first_y = first_y;
+      change->last_x = last_x;
+      change->last_y = last_y;
+      (replanner->num_changes)++;
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_apply_replanner_changes                                       */
+/*                                                                            */
+/* Purpose: Bring a replanner up to date with the changes to its grid.        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     field - The cost field of the replanner's unit, which   */
+/*                            is already up to date.                          */
+/*                                                                            */
+/* Operation: First read which points of each area are held by other units.   */
+/*            A step depends on the point stepped to and, if diagonal, the    */
+/*            two beside it, so every step which may have changed starts in   */
+/*            the area or the points around it. Recompute the lookahead of    */
+/*            each of those points and queue it if it now differs from its    */
+/*            cost. Points which cannot be entered are left alone.            */
+/******************************************************************************/
+void dt_apply_replanner_changes(DT_REPLANNER *replanner, DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_GRID *grid = replanner->grid;
+  DT_REPLAN_CHANGE *change;
+  DT_UNIT *other_unit;
+  Uint32 goal;
+  Uint32 node;
+  Uint32 bit;
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+  int grid_x;
+  int grid_y;
+  int ii;
+
+  for (ii = 0; ii < replanner->num_changes; ii++)
+  {
+    change = &(replanner->changes[ii]);
+    first_x = MAX(change->first_x, 0);
+    first_y = MAX(change->first_y, 0);
+    last_x = MIN(change->last_x, grid->num_tiles_x - 1);
+    last_y = MIN(change->last_y, grid->num_tiles_y - 1);
+    for (grid_y = first_y; grid_y <= last_y; grid_y++)
+    {
+      for (grid_x = first_x; grid_x <= last_x; grid_x++)
+      {
+        other_unit = dt_get_grid_element(grid, grid_x, grid_y)->unit;
+        node = dt_get_replanner_node(replanner, grid_x, grid_y);
+        bit = (Uint32) 1 << (node & DT_GRID_WORD_MASK);
+        if ((NULL != other_unit) && (replanner->unit != other_unit))
+        {
+          replanner->occupied[node >> DT_GRID_WORD_SHIFT] |= bit;
+        }
+        else
+        {
+          replanner->occupied[node >> DT_GRID_WORD_SHIFT] &= ~bit;
+        }
+      }
+    }
+  }
+
+  goal = dt_get_replanner_node(replanner, replanner->goal_x, replanner->goal_y);
+  for (ii = 0; ii < replanner->num_changes; ii++)
+  {
+    change = &(replanner->changes[ii]);
+    first_x = MAX(change->first_x - 1, 0);
+    first_y = MAX(change->first_y - 1, 0);
+    last_x = MIN(change->last_x + 1, grid->num_tiles_x - 1);
+    last_y = MIN(change->last_y + 1, grid->num_tiles_y - 1);
+    for (grid_y = first_y; grid_y <= last_y; grid_y++)
+    {
+      for (grid_x = first_x; grid_x <= last_x; grid_x++)
+      {
+        node = dt_get_replanner_node(replanner, grid_x, grid_y);
+        if ((goal != node) && (DT_COST_FIELD_BLOCKED != field->costs[node]))
+        {
+          replanner->lookahead[node] = dt_get_replanner_lookahead(replanner,
+                                                                  field,
+                                                                  node);
+          dt_update_replanner_node(replanner, node);
+        }
+      }
+    }
+  }
+  replanner->num_changes = 0;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_compute_replanner_path                                        */
+/*                                                                            */
+/* Purpose: Search until the cost to the goal from a replanner's unit is      */
+/*          known.                                                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     field - The cost field of the replanner's unit.         */
+/*                                                                            */
+/* Operation: Take the queued point with the lowest key until none is lower   */
+/*            than the unit's and the unit's point is settled. A point whose  */
+/*            key has gone up since it was queued is queued again. One whose  */
+/*            lookahead is lower than its cost takes the lookahead as its     */
+/*            cost, and every point which can step to it may now do better.   */
+/*            One whose lookahead is higher, because a way through it has     */
+/*            closed, has its cost forgotten, and every point whose lookahead */
+/*            came through it works its lookahead out again. Points which     */
+/*            cannot be entered are never stepped from, except by the unit.   */
+/******************************************************************************/
+void dt_compute_replanner_path(DT_REPLANNER *replanner, DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(replanner->heap);
+  Uint32 start;
+  Uint32 goal;
+  Uint32 node;
+  Uint32 previous;
+  Uint32 old_cost;
+  Uint32 step_cost;
+  Uint64 key;
+  int direction;
+
+  start = dt_get_replanner_node(replanner,
+                                replanner->start_x,
+                                replanner->start_y);
+  goal = dt_get_replanner_node(replanner, replanner->goal_x, replanner->goal_y);
+
+  while ((heap->num_entries > 0) &&
+         ((heap->keys[0] < dt_get_replanner_key(replanner, start)) ||
+          (replanner->lookahead[start] != replanner->cost[start])))
+  {
+    node = heap->nodes[0];
+    key = dt_get_replanner_key(replanner, node);
+    (replanner->nodes_expanded)++;
+
+    if (heap->keys[0] < key)
+    {
+      heap->keys[0] = key;
+      dt_sift_replanner_heap_down(replanner, 0);
+    }
+    else if (replanner->cost[node] > replanner->lookahead[node])
+    {
+      /************************************************************************/
+      /* The point is cheaper than it was. Settle it and offer it to every    */
+      /* point which can step to it.                                          */
+      /************************************************************************/
+      replanner->cost[node] = replanner->lookahead[node];
+      dt_remove_replanner_heap(replanner, node);
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        previous = (Uint32) ((long) node + field->offsets[direction]);
+        if ((goal == previous) ||
+            ((DT_COST_FIELD_BLOCKED == field->costs[previous]) &&
+             (start != previous)))
+        {
+          continue;
+        }
+        step_cost = dt_get_replanner_step_cost(replanner,
+                                               field,
+                                               previous,
+                                               (direction + 4) % NORTH_1);
+        if ((0 != step_cost) &&
+            (step_cost + replanner->cost[node] <
+                                            replanner->lookahead[previous]))
+        {
+          replanner->lookahead[previous] = step_cost + replanner->cost[node];
+          dt_update_replanner_node(replanner, previous);
+        }
+      }
+    }
+    else
+    {
+      /************************************************************************/
+      /* The point costs more than it did. Forget its cost and work out again */
+      /* the lookahead of every point which relied on it.                     */
+      /************************************************************************/
+      old_cost = replanner->cost[node];
+      replanner->cost[node] = DT_REPLAN_NO_COST;
+      if (goal != node)
+      {
+        replanner->lookahead[node] = dt_get_replanner_lookahead(replanner,
+                                                                field,
+                                                                node);
+      }
+      dt_update_replanner_node(replanner, node);
+      for (direction = NORTH; direction < NORTH_1; direction++)
+      {
+        previous = (Uint32) ((long) node + field->offsets[direction]);
+        if ((goal == previous) ||
+            ((DT_COST_FIELD_BLOCKED == field->costs[previous]) &&
+             (start != previous)))
+        {
+          continue;
+        }
+        step_cost = dt_get_replanner_step_cost(replanner,
+                                               field,
+                                               previous,
+                                               (direction + 4) % NORTH_1);
+        if ((0 != step_cost) &&
+            (DT_REPLAN_NO_COST != old_cost) &&
+            (step_cost + old_cost == replanner->lookahead[previous]))
+        {
+          replanner->lookahead[previous] =
+                     dt_get_replanner_lookahead(replanner, field, previous);
+          dt_update_replanner_node(replanner, previous);
+        }
+      }
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_get_replanner_lookahead                                       */
+/*                                                                            */
+/* Purpose: Work out the lookahead of a point of a replanner.                 */
+/*                                                                            */
+/* Returns: The cheapest step from the point plus the cost to the goal from   */
+/*          where it leads, or DT_REPLAN_NO_COST if no step leads to a point  */
+/*          with a cost.                                                      */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*             IN     field - The cost field of the replanner's unit.         */
+/*             IN     node - The point, which must not be on the border.      */
+/*                                                                            */
+/* Operation: Try each of the eight steps.                                    */
+/******************************************************************************/
+Uint32 dt_get_replanner_lookahead(DT_REPLANNER *replanner,
+                                  DT_COST_FIELD *field,
+                                  Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 lookahead = DT_REPLAN_NO_COST;
+  Uint32 step_cost;
+  Uint32 next_cost;
+  int direction;
+
+  for (direction = NORTH; direction < NORTH_1; direction++)
+  {
+    step_cost = dt_get_replanner_step_cost(replanner, field, node, direction);
+    next_cost = replanner->cost[(long) node + field->offsets[direction]];
+    if ((0 != step_cost) && (DT_REPLAN_NO_COST != next_cost))
+    {
+      lookahead = MIN(lookahead, step_cost + next_cost);
+    }
+  }
+
+  return(lookahead);
+}
+
+/******************************************************************************/
+/* Function: dt_get_replanner_key                                             */
+/*                                                                            */
+/* Purpose: Work out the key a point of a replanner is queued with.           */
+/*                                                                            */
+/* Returns: The key, which sorts first by the estimate of the cost of a path  */
+/*          from the unit through the point and then by the point's cost.     */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*             IN     node - The point.                                       */
+/*                                                                            */
+/* Operation: The lower of the point's cost and lookahead, plus the octile    */
+/*            distance from the unit at the least cost per step, plus the     */
+/*            key modifier, in the high word; the lower of the two alone in   */
+/*            the low word.                                                   */
+/******************************************************************************/
+Uint64 dt_get_replanner_key(DT_REPLANNER *replanner, Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 cost;
+  Uint32 estimate;
+  int grid_x;
+  int grid_y;
+
+  cost = MIN(replanner->cost[node], replanner->lookahead[node]);
+  if (DT_REPLAN_NO_COST == cost)
+  {
+    return(((Uint64) DT_REPLAN_NO_COST << 32) | (Uint64) DT_REPLAN_NO_COST);
+  }
+  grid_x = (int) (node % (Uint32) replanner->width) - 1;
+  grid_y = (int) (node / (Uint32) replanner->width) - 1;
+  estimate = cost +
+             (replanner->min_cost *
+              dt_get_octile_distance(grid_x - replanner->start_x,
+                                     grid_y - replanner->start_y)) +
+             replanner->key_modifier;
+
+  return(((Uint64) estimate << 32) | (Uint64) cost);
+}
+
+/******************************************************************************/
+/* Function: dt_update_replanner_node                                         */
+/*                                                                            */
+/* Purpose: Queue a point of a replanner if its cost and lookahead differ,    */
+/*          and take it off the queue if they do not.                         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     node - The point.                                       */
+/*                                                                            */
+/* Operation: A point already queued is moved to its new key.                 */
+/******************************************************************************/
+void dt_update_replanner_node(DT_REPLANNER *replanner, Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 position = replanner->heap_index[node];
+  Uint64 key;
+
+  if (replanner->cost[node] != replanner->lookahead[node])
+  {
+    key = dt_get_replanner_key(replanner, node);
+    if (DT_REPLAN_NOT_QUEUED == position)
+    {
+      dt_push_replanner_heap(replanner, node, key);
+    }
+    else if (key < replanner->heap.keys[position])
+    {
+      replanner->heap.keys[position] = key;
+      dt_sift_replanner_heap_up(replanner, position);
+    }
+    else
+    {
+      replanner->heap.keys[position] = key;
+      dt_sift_replanner_heap_down(replanner, position);
+    }
+  }
+  else if (DT_REPLAN_NOT_QUEUED != position)
+  {
+    dt_remove_replanner_heap(replanner, node);
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_push_replanner_heap                                           */
+/*                                                                            */
+/* Purpose: Queue a point of a replanner.                                     */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     node - The point, which must not be queued.             */
+/*             IN     key - The key to queue it with.                         */
+/*                                                                            */
+/* Operation: As dt_push_path_heap, doubling the heap when it is full.        */
+/******************************************************************************/
+void dt_push_replanner_heap(DT_REPLANNER *replanner, Uint32 node, Uint64 key)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(replanner->heap);
+  Uint32 *nodes;
+  Uint64 *keys;
+
+  if (heap->num_entries == heap->size)
+  {
+    nodes = (Uint32 *) dt_malloc(sizeof(Uint32) * heap->size * 2);
+    keys = (Uint64 *) dt_malloc(sizeof(Uint64) * heap->size * 2);
+    memcpy(nodes, heap->nodes, sizeof(Uint32) * heap->num_entries);
+    memcpy(keys, heap->keys, sizeof(Uint64) * heap->num_entries);
+    dt_free(heap->nodes);
+    dt_free(heap->keys);
+    heap->nodes = nodes;
+    heap->keys = keys;
+    heap->size *= 2;
+  }
+
+  heap->nodes[heap->num_entries] = node;
+  heap->keys[heap->num_entries] = key;
+  (heap->num_entries)++;
+  dt_sift_replanner_heap_up(replanner, heap->num_entries - 1);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_remove_replanner_heap                                         */
+/*                                                                            */
+/* Purpose: Take a point of a replanner off the queue.                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     node - The point, which must be queued.                 */
+/*                                                                            */
+/* Operation: Move the last entry into the hole and sift it whichever way its */
+/*            key needs.                                                      */
+/******************************************************************************/
+void dt_remove_replanner_heap(DT_REPLANNER *replanner, Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(replanner->heap);
+  size_t position = replanner->heap_index[node];
+
+  replanner->heap_index[node] = DT_REPLAN_NOT_QUEUED;
+  (heap->num_entries)--;
+  if (position < heap->num_entries)
+  {
+    heap->nodes[position] = heap->nodes[heap->num_entries];
+    heap->keys[position] = heap->keys[heap->num_entries];
+    replanner->heap_index[heap->nodes[position]] = (Uint32) position;
+    if ((position > 0) &&
+        (heap->keys[position] < heap->keys[(position - 1) >> 1]))
+    {
+      dt_sift_replanner_heap_up(replanner, position);
+    }
+    else
+    {
+      dt_sift_replanner_heap_down(replanner, position);
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_sift_replanner_heap_up                                        */
+/*                                                                            */
+/* Purpose: Move an entry of a replanner's queue up until its parent's key is */
+/*          no higher.                                                        */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     position - The position of the entry.                   */
+/*                                                                            */
+/* Operation: As dt_sift_path_heap_up.                                        */
+/******************************************************************************/
+void dt_sift_replanner_heap_up(DT_REPLANNER *replanner, size_t position)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(replanner->heap);
+  Uint32 node = heap->nodes[position];
+  Uint64 key = heap->keys[position];
+  size_t parent;
+
+  while (position > 0)
+  {
+    parent = (position - 1) >> 1;
+    if (heap->keys[parent] <= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[parent];
+    heap->keys[position] = heap->keys[parent];
+    replanner->heap_index[heap->nodes[position]] = (Uint32) position;
+    position = parent;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+  replanner->heap_index[node] = (Uint32) position;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_sift_replanner_heap_down                                      */
+/*                                                                            */
+/* Purpose: Move an entry of a replanner's queue down until neither child has */
+/*          a lower key.                                                      */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT replanner - The replanner.                              */
+/*             IN     position - The position of the entry.                   */
+/*                                                                            */
+/* Operation: As dt_sift_path_heap_down.                                      */
+/******************************************************************************/
+void dt_sift_replanner_heap_down(DT_REPLANNER *replanner, size_t position)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH_HEAP *heap = &(replanner->heap);
+  Uint32 node = heap->nodes[position];
+  Uint64 key = heap->keys[position];
+  size_t child;
+
+  while ((child = (position << 1) + 1) < heap->num_entries)
+  {
+    if ((child + 1 < heap->num_entries) &&
+        (heap->keys[child + 1] < heap->keys[child]))
+    {
+      child++;
+    }
+    if (heap->keys[child] >= key)
+    {
+      break;
+    }
+    heap->nodes[position] = heap->nodes[child];
+    heap->keys[position] = heap->keys[child];
+    replanner->heap_index[heap->nodes[position]] = (Uint32) position;
+    position = child;
+  }
+  heap->nodes[position] = node;
+  heap->keys[position] = key;
+  replanner->heap_index[node] = (Uint32) position;
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_build_replanned_path                                          */
+/*                                                                            */
+/* Purpose: Read the path from a replanner's unit to its goal.                */
+/*                                                                            */
+/* Returns: A pointer to the path, to be freed with dt_destroy_path.          */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner, whose unit's point has a     */
+/*                                cost to the goal.                           */
+/*             IN     field - The cost field of the replanner's unit.         */
+/*                                                                            */
+/* Operation: From the unit's point, keep taking the step which costs least   */
+/*            with the cost to the goal from where it leads, until the goal.  */
+/*            Walk the path once to count its points and again to fill them.  */
+/*            The first point faces the unit's orientation and each after     */
+/*            faces the step into it.                                         */
+/******************************************************************************/
+DT_PATH *dt_build_replanned_path(DT_REPLANNER *replanner,
+                                 DT_COST_FIELD *field)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_PATH *path;
+  DT_PATH_POINT *point;
+  Uint32 goal;
+  Uint32 node;
+  Uint32 step_cost;
+  int direction;
+  int pass;
+
+  path = (DT_PATH *) dt_malloc(sizeof(DT_PATH));
+  path->points = NULL;
+  goal = dt_get_replanner_node(replanner, replanner->goal_x, replanner->goal_y);
+  for (pass = 0; pass < 2; pass++)
+  {
+    if (1 == pass)
+    {
+      path->points = (DT_PATH_POINT *) dt_malloc(sizeof(DT_PATH_POINT) *
+                                                 (size_t) path->num_points);
+    }
+    path->num_points = 0;
+    path->cost = 0;
+    node = dt_get_replanner_node(replanner,
+                                 replanner->start_x,
+                                 replanner->start_y);
+    direction = replanner->unit->orientation;
+    while (true)
+    {
+      if (NULL != path->points)
+      {
+        point = &(path->points[path->num_points]);
+        point->grid_x = (int) (node % (Uint32) replanner->width) - 1;
+        point->grid_y = (int) (node / (Uint32) replanner->width) - 1;
+        point->orientation = direction;
+      }
+      (path->num_points)++;
+      if (goal == node)
+      {
+        break;
+      }
+
+      direction = dt_get_replanner_next_step(replanner, field, node);
+      step_cost = dt_get_replanner_step_cost(replanner,
+                                             field,
+                                             node,
+                                             direction);
+      path->cost += step_cost;
+      node = (Uint32) ((long) node + field->offsets[direction]);
+    }
+  }
+
+  return(path);
+}
+
+/******************************************************************************/
+/* Function: dt_get_replanner_next_step                                       */
+/*                                                                            */
+/* Purpose: Find the step a replanner's unit should take from a point.        */
+/*                                                                            */
+/* Returns: The DT_VIEW_ORIENTATIONS value of the step.                       */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*             IN     field - The cost field of the replanner's unit.         */
+/*             IN     node - The point, which must have a cost to the goal.   */
+/*                                                                            */
+/* Operation: Take the step which costs least with the cost to the goal from  */
+/*            where it leads, the first in DT_VIEW_ORIENTATIONS order on a    */
+/*            tie.                                                            */
+/******************************************************************************/
+int dt_get_replanner_next_step(DT_REPLANNER *replanner,
+                               DT_COST_FIELD *field,
+                               Uint32 node)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 best_cost = DT_REPLAN_NO_COST;
+  Uint32 step_cost;
+  Uint32 next_cost;
+  int best_direction = NORTH;
+  int direction;
+
+  for (direction = NORTH; direction < NORTH_1; direction++)
+  {
+    step_cost = dt_get_replanner_step_cost(replanner, field, node, direction);
+    next_cost = replanner->cost[(long) node + field->offsets[direction]];
+    if ((0 != step_cost) &&
+        (DT_REPLAN_NO_COST != next_cost) &&
+        (step_cost + next_cost < best_cost))
+    {
+      best_cost = step_cost + next_cost;
+      best_direction = direction;
+    }
+  }
+
+  return(best_direction);
+}
+
+/******************************************************************************/
+/* Function: dt_get_replanner_memory_usage                                    */
+/*                                                                            */
+/* Purpose: Report how much memory a replanner is using.                      */
+/*                                                                            */
+/* Returns: The number of bytes allocated for the replanner.                  */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*                                                                            */
+/* Operation: Add the arrays for every point and the heap to the replanner    */
+/*            itself, which holds the changes.                                */
+/******************************************************************************/
+size_t dt_get_replanner_memory_usage(DT_REPLANNER *replanner)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  size_t num_words;
+
+  num_words = (replanner->num_nodes + DT_GRID_WORD_MASK) >> DT_GRID_WORD_SHIFT;
+
+  return(sizeof(DT_REPLANNER) +
+         (sizeof(Uint32) * 3 * replanner->num_nodes) +
+         (sizeof(Uint32) * num_words) +
+         ((sizeof(Uint32) + sizeof(Uint64)) * replanner->heap.size));
+}
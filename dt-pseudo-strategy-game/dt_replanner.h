@@ -0,0 +1,145 @@
+/******************************************************************************/
+/* File: dt_replanner.h                                                       */
+/*                                                                            */
+/* Purpose: Definitions for replanners, which keep the search of one unit     */
+/*          towards its goal and repair it when the grid changes rather than  */
+/*          searching again from nothing.                                     */
+/******************************************************************************/
+
+/******************************************************************************/
+/* Parameters of replanners.                                                  */
+/*                                                                            */
+/* DT_REPLAN_NO_COST - The cost to the goal of a point which has not been     */
+/*                     found to reach it.                                     */
+/* DT_REPLAN_NOT_QUEUED - The heap position of a point which is not queued.   */
+/* DT_REPLAN_MAX_CHANGES - The most changed areas a replanner keeps. Once it  */
+/*                         has this many, each new area is merged into one of */
+/*                         them, so a replanner which does not plan for a     */
+/*                         long time still holds no more.                     */
+/******************************************************************************/
+#define DT_REPLAN_NO_COST 0xFFFFFFFFu
+#define DT_REPLAN_NOT_QUEUED 0xFFFFFFFFu
+#define DT_REPLAN_MAX_CHANGES 16
+
+/******************************************************************************/
+/* DT_REPLAN_CHANGE:                                                          */
+/*                                                                            */
+/* An area of the grid which has changed since a replanner last planned.      */
+/*                                                                            */
+/* first_x - The x coordinate of the left of the area.                        */
+/* first_y - The y coordinate of the top of the area.                         */
+/* last_x - The x coordinate of the right of the area.                        */
+/* last_y - The y coordinate of the bottom of the area.                       */
+/******************************************************************************/
+typedef struct dt_replan_change
+{
+  int first_x;
+  int first_y;
+  int last_x;
+  int last_y;
+} DT_REPLAN_CHANGE;
+
+/******************************************************************************/
+/* DT_REPLANNER:                                                              */
+/*                                                                            */
+/* The search state of one unit moving to one goal, kept between plans. This  */
+/* is D* Lite: the search runs backwards from the goal, so the cost to the    */
+/* goal found for each point stays right however the unit moves, and a change */
+/* to the grid only reopens the points whose cost it changes. Each point has  */
+/* its cost to the goal and a one step lookahead of it, and is queued while   */
+/* the two differ. Points are numbered as in the unit's DT_COST_FIELD, with   */
+/* the border never entered. Points held by other units are not entered       */
+/* either. The replanner is registered with its grid, which tells it of each  */
+/* change, and must be destroyed before the grid is.                          */
+/*                                                                            */
+/* grid - The grid the replanner plans over.                                  */
+/* unit - The unit the replanner plans for.                                   */
+/* goal_x - The x coordinate of the goal.                                     */
+/* goal_y - The y coordinate of the goal.                                     */
+/* start_x - The x coordinate the unit was at when it last planned.           */
+/* start_y - The y coordinate the unit was at when it last planned.           */
+/* width - The number of points in each row, including the border.            */
+/* num_nodes - The number of points, including the border.                    */
+/* min_cost - The least a step onto a point can cost the unit, per straight   */
+/*            step, used for the heuristic.                                   */
+/* key_modifier - The total heuristic distance the unit has moved since the   */
+/*                search began. Added to the keys of points queued since,     */
+/*                so that keys queued earlier stay lower bounds.              */
+/* cost - The cost to the goal of each point, or DT_REPLAN_NO_COST.           */
+/* lookahead - The cheapest step from each point plus the cost to the goal    */
+/*             from where it leads, or DT_REPLAN_NO_COST.                     */
+/* heap_index - The position of each point in the heap, or                    */
+/*              DT_REPLAN_NOT_QUEUED.                                         */
+/* heap - The points whose cost and lookahead differ, keyed by the estimate   */
+/*        of the cost of a path through them and then their lower cost.       */
+/* occupied - A bit for each point held by another unit.                      */
+/* changes - The areas of the grid changed since the last plan. An area may   */
+/*           cover points which have not changed, as areas are merged when    */
+/*           there is no room for more.                                       */
+/* num_changes - The number of entries used in changes.                       */
+/* next_replanner - The next replanner registered with the grid.              */
+/* nodes_expanded - The number of points expanded by the last plan.           */
+/* num_plans - The number of plans made.                                      */
+/* total_nodes_expanded - The number of points expanded by every plan.        */
+/* total_plan_time_us - The time taken by every plan, in microseconds.        */
+/******************************************************************************/
+typedef struct dt_replanner
+{
+  struct dt_grid *grid;
+  struct dt_unit *unit;
+  int goal_x;
+  int goal_y;
+  int start_x;
+  int start_y;
+  int width;
+  size_t num_nodes;
+  Uint32 min_cost;
+  Uint32 key_modifier;
+  Uint32 *cost;
+  Uint32 *lookahead;
+  Uint32 *heap_index;
+  DT_PATH_HEAP heap;
+  Uint32 *occupied;
+  DT_REPLAN_CHANGE changes[DT_REPLAN_MAX_CHANGES];
+  int num_changes;
+  struct dt_replanner *next_replanner;
+  long nodes_expanded;
+  long num_plans;
+  Uint64 total_nodes_expanded;
+  Uint64 total_plan_time_us;
+} DT_REPLANNER;
+
+/******************************************************************************/
+/* Function: dt_get_replanner_step_cost                                       */
+/*                                                                            */
+/* Purpose: Find what a step from a point costs a replanner's unit.           */
+/*                                                                            */
+/* Returns: The cost of the step, or 0 if it cannot be taken.                 */
+/*                                                                            */
+/* Parameters: IN     replanner - The replanner.                              */
+/*             IN     field - The cost field of the replanner's unit.         */
+/*             IN     node - The point the step is from.                      */
+/*             IN     direction - The DT_VIEW_ORIENTATIONS value of the step. */
+/*                                                                            */
+/* Operation: As dt_get_cost_field_step_cost, but a point held by another     */
+/*            unit cannot be entered.                                         */
+/******************************************************************************/
+static inline Uint32 dt_get_replanner_step_cost(DT_REPLANNER *replanner,
+                                                DT_COST_FIELD *field,
+                                                Uint32 node,
+                                                int direction)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  Uint32 next;
+
+  next = (Uint32) ((long) node + field->offsets[direction]);
+  if (0 != (replanner->occupied[next >> DT_GRID_WORD_SHIFT] &
+             ((Uint32) 1 << (next & DT_GRID_WORD_MASK))))
+  {
+    return(0);
+  }
+
+  return(dt_get_cost_field_step_cost(field, (long) node, direction));
+}
@@ -0,0 +1,44 @@
+/******************************************************************************/
+/* File: dt_timer.c                                                           */
+/*                                                                            */
+/* Purpose: Provides a high resolution clock for measuring how long pieces of */
+/*          work take.                                                        */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_get_time_us                                                   */
+/*                                                                            */
+/* Purpose: Read a clock with microsecond resolution.                         */
+/*                                                                            */
+/* Returns: The number of microseconds since some fixed point in the past.    */
+/*          Only the difference between two readings is meaningful.           */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Read the performance counter and convert it to microseconds     */
+/*            using its frequency. The whole and fractional seconds are       */
+/*            converted separately so that the multiplication cannot          */
+/*            overflow.                                                       */
+/******************************************************************************/
+Uint64 dt_get_time_us()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  Uint64 seconds;
+  Uint64 remainder;
+
+  /****************************************************************************/
+  /* Read the counter and convert to microseconds.                            */
+  /****************************************************************************/
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  seconds = (Uint64) (counter.QuadPart / frequency.QuadPart);
+  remainder = (Uint64) (counter.QuadPart % frequency.QuadPart);
+
+  return((seconds * 1000000) +
+                         ((remainder * 1000000) / (Uint64) frequency.QuadPart));
+}
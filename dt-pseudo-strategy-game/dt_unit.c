@@ -17,6 +17,8 @@
 /*                                                                            */
 /* Operation: Allocate memory and set up the unit id. Then add the unit to    */
 /*            master unit list so that it can be cleaned up when necessary.   */
+/*            Its class, speed and movement distance are set to the           */
+/*            defaults.                                                       */
 /******************************************************************************/
 DT_UNIT *dt_create_unit(long *next_unit_id)
 {
@@ -54,6 +56,21 @@ DT_UNIT *dt_create_unit(long *next_unit_id)
   /****************************************************************************/
   temp_unit->graphic = (DT_UNIT_GRAPHIC *) dt_create_unit_graphic();
 
+  /****************************************************************************/
+  /* Give the unit what searches and movement ranges read, so that a unit     */
+  /* which is never set up can still be selected.                             */
+  /****************************************************************************/
+  temp_unit->unit_class = DT_UNIT_DEFAULT_CLASS;
+  temp_unit->speed = DT_UNIT_DEFAULT_SPEED;
+  temp_unit->max_movement_distance = DT_UNIT_DEFAULT_MOVEMENT_DISTANCE;
+
+  /****************************************************************************/
+  /* The unit has not asked for a path yet.                                   */
+  /****************************************************************************/
+  temp_unit->path_state = DT_UNIT_PATH_NONE;
+  temp_unit->path = NULL;
+  temp_unit->path_job = NULL;
+
   return(temp_unit);
 }
 
@@ -66,10 +83,16 @@ DT_UNIT *dt_create_unit(long *next_unit_id)
 /*                                                                            */
 /* Parameters: IN     unit - The unit to be freed.                            */
 /*                                                                            */
-/* Operation: Free the object. Do not free the master list element.           */
+/* Operation: Free the object. Do not free the master list element. Any path  */
+/*            the unit has, or is waiting for, is dropped.                    */
 /******************************************************************************/
 void dt_destroy_unit(DT_UNIT *unit)
 {
+  /****************************************************************************/
+  /* Drop the unit's path.                                                    */
+  /****************************************************************************/
+  dt_cancel_unit_path(unit);
+
   /****************************************************************************/
   /* Free the unit graphic oject.                                             */
   /****************************************************************************/
@@ -26,7 +26,16 @@
 /* things such as how fast they travel on particular terrain types.           */
 /* For the algorithms used the unit class MUST be of the form 0xa1bc.         */
 /******************************************************************************/
-#define DT_UNIT_CLASS_NORMAL = 0x0100
+#define DT_UNIT_CLASS_NORMAL 0x0100
+#define DT_UNIT_CLASS_VEHICLE 0x1100
+
+/******************************************************************************/
+/* The a digit of a unit class numbers the classes from zero, so tables with  */
+/* an entry for each class are indexed by DT_UNIT_CLASS_INDEX.                */
+/* DT_NUM_UNIT_CLASSES is the number of DT_UNIT_CLASSES.                      */
+/******************************************************************************/
+#define DT_NUM_UNIT_CLASSES 2
+#define DT_UNIT_CLASS_INDEX(unit_class) (((unit_class) >> 12) & 0xF)
 
 /******************************************************************************/
 /* Group: DT_VIEW_ORIENTATIONS                                                */
@@ -49,6 +58,34 @@ typedef enum dt_orientation
   NORTH_1
 } DT_ORIENTATION;
 
+/******************************************************************************/
+/* Group: DT_UNIT_PATH_STATES                                                 */
+/*                                                                            */
+/* Where a unit is with the path it last asked the path scheduler for.        */
+/*                                                                            */
+/* DT_UNIT_PATH_NONE - The unit has not asked for a path, or it was dropped.  */
+/* DT_UNIT_PATH_PENDING - The unit is waiting for its search to finish.       */
+/* DT_UNIT_PATH_READY - The search has finished and the unit has its path.    */
+/* DT_UNIT_PATH_FAILED - The search has finished and found no path.           */
+/******************************************************************************/
+#define DT_UNIT_PATH_NONE 0
+#define DT_UNIT_PATH_PENDING 1
+#define DT_UNIT_PATH_READY 2
+#define DT_UNIT_PATH_FAILED 3
+
+/******************************************************************************/
+/* What a unit is given when it is created, until it is set up.               */
+/*                                                                            */
+/* DT_UNIT_DEFAULT_CLASS - The class of a new unit. One of DT_UNIT_CLASSES.   */
+/* DT_UNIT_DEFAULT_SPEED - The speed of a new unit. Costs are divided by the  */
+/*                         speed, so it must be at least 1.                   */
+/* DT_UNIT_DEFAULT_MOVEMENT_DISTANCE - The max_movement_distance of a new     */
+/*                                     unit.                                  */
+/******************************************************************************/
+#define DT_UNIT_DEFAULT_CLASS DT_UNIT_CLASS_NORMAL
+#define DT_UNIT_DEFAULT_SPEED 1
+#define DT_UNIT_DEFAULT_MOVEMENT_DISTANCE 16
+
 /******************************************************************************/
 /* DT_UNIT_GRAPHIC:                                                           */
 /*                                                                            */
@@ -92,6 +129,11 @@ typedef struct dt_unit_graphic
 /*                 how far from the orientation the unit can see.             */
 /* sight_distance - The distance away from the unit (along the orientation)   */
 /*                  that the unit can see.                                    */
+/* path_state - One of DT_UNIT_PATH_STATES.                                   */
+/* path - The path found for the unit when path_state is DT_UNIT_PATH_READY,  */
+/*        otherwise NULL. Owned by the unit.                                  */
+/* path_job - The job the unit is waiting for when path_state is              */
+/*            DT_UNIT_PATH_PENDING, otherwise NULL.                           */
 /******************************************************************************/
 typedef struct dt_unit
 {
@@ -110,4 +152,7 @@ typedef struct dt_unit
   int orientation;
   int field_of_view;
   int sight_distance;
+  int path_state;
+  struct dt_path *path;
+  struct dt_path_job *path_job;
 } DT_UNIT;
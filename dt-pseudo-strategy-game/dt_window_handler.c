@@ -35,6 +35,7 @@ DT_SCREEN *dt_create_screen()
   temp_screen->pixel_start_y = 0;
   temp_screen->start_x = 0;
   temp_screen->start_y = 0;
+  temp_screen->movement_range = dt_create_movement_range();
 
   return(temp_screen);
 }
@@ -60,6 +61,7 @@ void dt_destroy_screen(DT_SCREEN *screen)
     SDL_FreeSurface(screen->viewport);
   }
 
+  dt_destroy_movement_range(screen->movement_range);
   dt_free(screen);
 
   return;
@@ -155,7 +157,7 @@ int dt_update_units_on_screen(DT_SCREEN *screen,
   SDL_Rect copy_location;
   bool ret_val;
   int ret_code = DT_UPDATE_SCREEN_OK;
-  DT_GRID_ELEMENT *element;
+  DT_BACKGROUND_TILE *tile;
 
   /****************************************************************************/
   /* Set the loop variable to the first unit in the active unit list.         */
@@ -181,11 +183,14 @@ int dt_update_units_on_screen(DT_SCREEN *screen,
     /**************************************************************************/
     /* Erase the old unit position with the map tile that was there before.   */
     /**************************************************************************/
-    element = grid->map_grid[curr_unit->curr_pos_x][curr_unit->curr_pos_y];
-    SDL_BlitSurface(element->tile->graphic->sprite,
-                    NULL,
-                    screen->viewport,
-                    &copy_location);
+    tile = dt_get_grid_tile(grid, curr_unit->curr_pos_x, curr_unit->curr_pos_y);
+    if (NULL != tile)
+    {
+      SDL_BlitSurface(tile->graphic->sprite,
+                      NULL,
+                      screen->viewport,
+                      &copy_location);
+    }
 
     /**************************************************************************/
     /* Convert the new grid position into screen coordinates and place into a */
@@ -241,6 +246,8 @@ EXIT_LABEL:
 /*                                                                            */
 /* Operation: ***ONLY USE IF ALL SCREEN NEEDS REDRAWING***                    */
 /*            Redraw each tile that can be seen by the current viewport.      */
+/*            Points of a streamed map which are not loaded yet are filled    */
+/*            with a placeholder colour.                                      */
 /*            Flip the screen so that the new image can be seen.              */
 /******************************************************************************/
 int dt_redraw_screen(DT_GRID *grid, DT_SCREEN *screen)
@@ -255,6 +262,20 @@ int dt_redraw_screen(DT_GRID *grid, DT_SCREEN *screen)
   SDL_Rect curr_loc;
   int start_x, end_x;
   int start_y, end_y;
+  DT_GRID_ELEMENT *element;
+  DT_BACKGROUND_TILE *tile;
+  Uint32 unloaded_colour;
+  Uint32 range_colour;
+  SDL_Rect marker_loc;
+
+  unloaded_colour = SDL_MapRGB(screen->viewport->format,
+                               DT_UNLOADED_CHUNK_RED,
+                               DT_UNLOADED_CHUNK_GREEN,
+                               DT_UNLOADED_CHUNK_BLUE);
+  range_colour = SDL_MapRGB(screen->viewport->format,
+                            DT_MOVEMENT_RANGE_RED,
+                            DT_MOVEMENT_RANGE_GREEN,
+                            DT_MOVEMENT_RANGE_BLUE);
 
   /****************************************************************************/
   /* Set the starting and finishing points of the grid loop to be such that   */
@@ -268,12 +289,14 @@ int dt_redraw_screen(DT_GRID *grid, DT_SCREEN *screen)
 
   /****************************************************************************/
   /* Loop through all visible portions of the grid applying tiles in turn.    */
-  /* Non-optimised.                                                           */
   /****************************************************************************/
   for (row = start_y; row < end_y; row++)
   {
-    for (col = start_x; col < end_y; col++)
+    for (col = start_x; col < end_x; col++)
     {
+      element = dt_get_grid_element(grid, col, row);
+      tile = dt_get_grid_tile(grid, col, row);
+
       /************************************************************************/
       /* Convert the current grid coordinates to screen coordinates. This     */
       /* could be done as part of the loop variable stuff to optimise...      */
@@ -288,27 +311,49 @@ int dt_redraw_screen(DT_GRID *grid, DT_SCREEN *screen)
       /************************************************************************/
       /* Apply the background to the screen first.                            */
       /************************************************************************/
-      if (NULL != grid->map_grid[col][row]->tile)
+      if (NULL != tile)
       {
-        SDL_BlitSurface(grid->map_grid[col][row]->tile->graphic->sprite,
+        SDL_BlitSurface(tile->graphic->sprite,
                         NULL,
                         screen->viewport,
                         &curr_loc);
       }
+      else if (!dt_is_grid_chunk_loaded(grid, col, row))
+      {
+        curr_loc.w = (Uint16) grid->square_width;
+        curr_loc.h = (Uint16) grid->square_height;
+        SDL_FillRect(screen->viewport, &curr_loc, unloaded_colour);
+      }
+
+      /************************************************************************/
+      /* Mark the points the selected unit can reach with a small square in   */
+      /* the middle, so the background can still be seen. SDL_FillRect clips  */
+      /* the rectangle it is given, so the marker has its own.                */
+      /************************************************************************/
+      if (dt_is_in_movement_range(screen->movement_range, col, row))
+      {
+        marker_loc.w = (Uint16) (grid->square_width /
+                                             DT_MOVEMENT_RANGE_MARKER_DIVISOR);
+        marker_loc.h = (Uint16) (grid->square_height /
+                                             DT_MOVEMENT_RANGE_MARKER_DIVISOR);
+        marker_loc.x = (Sint16) (curr_loc.x +
+                                 ((grid->square_width - marker_loc.w) / 2));
+        marker_loc.y = (Sint16) (curr_loc.y +
+                                 ((grid->square_height - marker_loc.h) / 2));
+        SDL_FillRect(screen->viewport, &marker_loc, range_colour);
+      }
 
       /************************************************************************/
       /* If there is a unit at the current map square then apply that on top  */
       /* of the backgruond tile.                                              */
       /************************************************************************/
-      if (NULL != grid->map_grid[col][row]->unit)
+      if (NULL != element->unit)
       {
-        SDL_BlitSurface(grid->map_grid[col][row]->unit->graphic->
-                                                         entity_graphic->sprite,
+        SDL_BlitSurface(element->unit->graphic->entity_graphic->sprite,
                         NULL,
                         screen->viewport,
                         &curr_loc);
       }
-
     }
   }
 
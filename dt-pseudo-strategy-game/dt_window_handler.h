@@ -10,6 +10,23 @@
 #define DT_BPP 32
 #define DT_SDL_SCREEN_FLAGS SDL_HWSURFACE|SDL_DOUBLEBUF
 
+/******************************************************************************/
+/* The colour drawn over points of a streamed map which have not been loaded  */
+/* yet.                                                                       */
+/******************************************************************************/
+#define DT_UNLOADED_CHUNK_RED 32
+#define DT_UNLOADED_CHUNK_GREEN 32
+#define DT_UNLOADED_CHUNK_BLUE 40
+
+/******************************************************************************/
+/* The colour of the marker drawn on each point the selected unit can reach   */
+/* this turn, and the fraction of the width and height of a point it covers.  */
+/******************************************************************************/
+#define DT_MOVEMENT_RANGE_RED 64
+#define DT_MOVEMENT_RANGE_GREEN 160
+#define DT_MOVEMENT_RANGE_BLUE 255
+#define DT_MOVEMENT_RANGE_MARKER_DIVISOR 3
+
 /******************************************************************************/
 /* DT_SCREEN:                                                                 */
 /*                                                                            */
@@ -27,6 +44,8 @@
 /* x_tiles_per_screen - The number of tiles per screen in the x direction.    */
 /* y_tiles_per_screen - The number of tiles per screen in the y direction.    */
 /*    The previous two variables are calculated using a grid object.          */
+/* movement_range - The points the selected unit can reach this turn, which   */
+/*                  are highlighted. Empty when no unit is selected.          */
 /******************************************************************************/
 typedef struct dt_screen
 {
@@ -40,4 +59,5 @@ typedef struct dt_screen
   int pixel_start_y;
   int x_tiles_per_screen;
   int y_tiles_per_screen;
+  struct dt_movement_range *movement_range;
 } DT_SCREEN;
@@ -0,0 +1,281 @@
+/******************************************************************************/
+/* File: dt_worker_pool.c                                                     */
+/*                                                                            */
+/* Purpose: A pool of worker threads which runs batches of independent jobs   */
+/*          in parallel, and the master pool shared by the whole program.     */
+/******************************************************************************/
+#include "dt_include.h"
+
+/******************************************************************************/
+/* Function: dt_create_worker_pool                                            */
+/*                                                                            */
+/* Purpose: Create a pool of worker threads.                                  */
+/*                                                                            */
+/* Returns: A pointer to the new pool.                                        */
+/*                                                                            */
+/* Parameters: IN     num_threads - The number of worker threads to start.    */
+/*                                  This is in addition to the thread which   */
+/*                                  submits each batch, so may be 0.          */
+/*                                                                            */
+/* Operation: Create the locks and conditions and start the threads, which    */
+/*            wait for the first batch. If a thread cannot be started the     */
+/*            pool just has fewer of them.                                    */
+/******************************************************************************/
+DT_WORKER_POOL *dt_create_worker_pool(int num_threads)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_WORKER_POOL *pool;
+  int ii;
+
+  pool = (DT_WORKER_POOL *) dt_malloc(sizeof(DT_WORKER_POOL));
+  pool->num_threads = 0;
+  pool->batch_lock = SDL_CreateMutex();
+  pool->lock = SDL_CreateMutex();
+  pool->work_ready = SDL_CreateCond();
+  pool->work_done = SDL_CreateCond();
+  pool->job_function = NULL;
+  pool->jobs = NULL;
+  pool->job_size = 0;
+  pool->num_jobs = 0;
+  pool->next_job = 0;
+  pool->jobs_unfinished = 0;
+  pool->shutting_down = false;
+
+  num_threads = CLAMP(num_threads, 0, DT_WORKER_POOL_MAX_THREADS);
+  for (ii = 0; ii < num_threads; ii++)
+  {
+    pool->threads[pool->num_threads] = SDL_CreateThread(dt_worker_pool_thread,
+                                                        pool);
+    if (NULL == pool->threads[pool->num_threads])
+    {
+      break;
+    }
+    pool->num_threads++;
+  }
+
+  return(pool);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_worker_pool                                           */
+/*                                                                            */
+/* Purpose: Stop the threads of a pool and free it.                           */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     pool - The pool to destroy. No batch may be running.    */
+/*                                                                            */
+/* Operation: Tell the threads to stop, wait for each of them to exit and     */
+/*            then free everything.                                           */
+/******************************************************************************/
+void dt_destroy_worker_pool(DT_WORKER_POOL *pool)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  int ii;
+
+  SDL_mutexP(pool->lock);
+  pool->shutting_down = true;
+  SDL_CondBroadcast(pool->work_ready);
+  SDL_mutexV(pool->lock);
+
+  for (ii = 0; ii < pool->num_threads; ii++)
+  {
+    SDL_WaitThread(pool->threads[ii], NULL);
+  }
+
+  SDL_DestroyCond(pool->work_done);
+  SDL_DestroyCond(pool->work_ready);
+  SDL_DestroyMutex(pool->lock);
+  SDL_DestroyMutex(pool->batch_lock);
+  dt_free(pool);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_run_worker_pool_jobs                                          */
+/*                                                                            */
+/* Purpose: Run a batch of jobs on a pool and wait for all of them to finish. */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN     pool - The pool to run the jobs on.                     */
+/*             IN     job_function - The function to run for each job.        */
+/*             IN/OUT jobs - An array of num_jobs jobs, each job_size bytes.  */
+/*                           Each job is passed to job_function in turn.      */
+/*             IN     job_size - The size in bytes of each job.               */
+/*             IN     num_jobs - The number of jobs in the array.             */
+/*                                                                            */
+/* Operation: Publish the batch and wake the threads, then take jobs from it  */
+/*            in this thread as well until none are left to start. Wait until */
+/*            the last job started elsewhere has finished. Jobs are started   */
+/*            in order but may finish in any order. Batches submitted from    */
+/*            several threads at once are run one after another.              */
+/******************************************************************************/
+void dt_run_worker_pool_jobs(DT_WORKER_POOL *pool,
+                             DT_WORKER_JOB_FUNCTION job_function,
+                             void *jobs,
+                             size_t job_size,
+                             int num_jobs)
+{
+  SDL_mutexP(pool->batch_lock);
+  SDL_mutexP(pool->lock);
+
+  pool->job_function = job_function;
+  pool->jobs = (char *) jobs;
+  pool->job_size = job_size;
+  pool->num_jobs = num_jobs;
+  pool->next_job = 0;
+  pool->jobs_unfinished = num_jobs;
+  SDL_CondBroadcast(pool->work_ready);
+
+  dt_work_on_worker_pool_batch(pool);
+  while (0 != pool->jobs_unfinished)
+  {
+    SDL_CondWait(pool->work_done, pool->lock);
+  }
+
+  pool->job_function = NULL;
+  pool->jobs = NULL;
+  pool->num_jobs = 0;
+  pool->next_job = 0;
+
+  SDL_mutexV(pool->lock);
+  SDL_mutexV(pool->batch_lock);
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_work_on_worker_pool_batch                                     */
+/*                                                                            */
+/* Purpose: Run jobs from the current batch of a pool until none are left to  */
+/*          start.                                                            */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: IN/OUT pool - The pool. Its lock must be held, and is held     */
+/*                           again on return.                                 */
+/*                                                                            */
+/* Operation: Claim the next job, then drop the lock while running it. Signal */
+/*            work_done when the last job of the batch finishes.              */
+/******************************************************************************/
+void dt_work_on_worker_pool_batch(DT_WORKER_POOL *pool)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_WORKER_JOB_FUNCTION job_function;
+  void *job;
+
+  while (pool->next_job < pool->num_jobs)
+  {
+    job_function = pool->job_function;
+    job = pool->jobs + ((size_t) pool->next_job * pool->job_size);
+    pool->next_job++;
+
+    SDL_mutexV(pool->lock);
+    job_function(job);
+    SDL_mutexP(pool->lock);
+
+    pool->jobs_unfinished--;
+    if (0 == pool->jobs_unfinished)
+    {
+      SDL_CondSignal(pool->work_done);
+    }
+  }
+
+  return;
+}
+
+/******************************************************************************/
+/* Function: dt_worker_pool_thread                                            */
+/*                                                                            */
+/* Purpose: The main function of each worker thread.                          */
+/*                                                                            */
+/* Returns: 0 when the pool shuts down.                                       */
+/*                                                                            */
+/* Parameters: IN     data - The DT_WORKER_POOL the thread belongs to.        */
+/*                                                                            */
+/* Operation: Sleep until there is a job to start, then help with the batch.  */
+/*            Exit once the pool is shutting down.                            */
+/******************************************************************************/
+int dt_worker_pool_thread(void *data)
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  DT_WORKER_POOL *pool = (DT_WORKER_POOL *) data;
+
+  SDL_mutexP(pool->lock);
+  while (!pool->shutting_down)
+  {
+    if (pool->next_job < pool->num_jobs)
+    {
+      dt_work_on_worker_pool_batch(pool);
+    }
+    else
+    {
+      SDL_CondWait(pool->work_ready, pool->lock);
+    }
+  }
+  SDL_mutexV(pool->lock);
+
+  return(0);
+}
+
+/******************************************************************************/
+/* Function: dt_get_master_worker_pool                                        */
+/*                                                                            */
+/* Purpose: Get the pool shared by the whole program.                         */
+/*                                                                            */
+/* Returns: A pointer to master_worker_pool.                                  */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: The pool is created the first time it is needed, with one       */
+/*            thread fewer than there are processors as the thread which      */
+/*            submits a batch does its share of the work.                     */
+/******************************************************************************/
+DT_WORKER_POOL *dt_get_master_worker_pool()
+{
+  /****************************************************************************/
+  /* Local Variables.                                                         */
+  /****************************************************************************/
+  SYSTEM_INFO system_info;
+
+  if (NULL == master_worker_pool)
+  {
+    GetSystemInfo(&system_info);
+    master_worker_pool =
+           dt_create_worker_pool((int) system_info.dwNumberOfProcessors - 1);
+  }
+
+  return(master_worker_pool);
+}
+
+/******************************************************************************/
+/* Function: dt_destroy_master_worker_pool                                    */
+/*                                                                            */
+/* Purpose: Stop the threads of the pool shared by the whole program.         */
+/*                                                                            */
+/* Returns: Nothing.                                                          */
+/*                                                                            */
+/* Parameters: None.                                                          */
+/*                                                                            */
+/* Operation: Destroy master_worker_pool if it was ever created.              */
+/******************************************************************************/
+void dt_destroy_master_worker_pool()
+{
+  if (NULL != master_worker_pool)
+  {
+    dt_destroy_worker_pool(master_worker_pool);
+    master_worker_pool = NULL;
+  }
+
+  return;
+}
@@ -0,0 +1,58 @@
+/******************************************************************************/
+/* File: dt_worker_pool.h                                                     */
+/*                                                                            */
+/* Purpose: Definitions for the pool of worker threads which runs batches of  */
+/*          independent jobs in parallel.                                     */
+/******************************************************************************/
+
+/******************************************************************************/
+/* The most worker threads a pool will create, whatever the number of         */
+/* processors.                                                                */
+/******************************************************************************/
+#define DT_WORKER_POOL_MAX_THREADS 64
+
+/******************************************************************************/
+/* The function run for each job of a batch. It is passed a pointer to its    */
+/* own job and must not touch the data of any other job.                      */
+/******************************************************************************/
+typedef void (*DT_WORKER_JOB_FUNCTION)(void *);
+
+/******************************************************************************/
+/* DT_WORKER_POOL:                                                            */
+/*                                                                            */
+/* A set of threads which wait for batches of jobs. The thread which submits  */
+/* a batch works through the jobs alongside them, so a pool with no threads   */
+/* simply runs every job in the calling thread.                               */
+/*                                                                            */
+/* threads - The worker threads.                                              */
+/* num_threads - The number of worker threads.                                */
+/* batch_lock - Held for the whole of a batch, so that only one batch runs at */
+/*              a time.                                                       */
+/* lock - Protects the rest of the fields.                                    */
+/* work_ready - Signalled when a batch is submitted or the pool is shutting   */
+/*              down.                                                         */
+/* work_done - Signalled when the last job of a batch has finished.           */
+/* job_function - The function to run for each job of the current batch.      */
+/* jobs - The array of jobs in the current batch.                             */
+/* job_size - The size in bytes of each job in the array.                     */
+/* num_jobs - The number of jobs in the current batch.                        */
+/* next_job - The index of the next job to be started.                        */
+/* jobs_unfinished - The number of jobs of the batch not yet finished.        */
+/* shutting_down - Set when the pool is being destroyed.                      */
+/******************************************************************************/
+typedef struct dt_worker_pool
+{
+  SDL_Thread *threads[DT_WORKER_POOL_MAX_THREADS];
+  int num_threads;
+  SDL_mutex *batch_lock;
+  SDL_mutex *lock;
+  SDL_cond *work_ready;
+  SDL_cond *work_done;
+  DT_WORKER_JOB_FUNCTION job_function;
+  char *jobs;
+  size_t job_size;
+  int num_jobs;
+  int next_job;
+  int jobs_unfinished;
+  bool shutting_down;
+} DT_WORKER_POOL;
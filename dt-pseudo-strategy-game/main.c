@@ -15,7 +15,89 @@ int main(int argc, char *argv[])
 
   DT_ENTITY_GRAPHIC *bg_graphic1;
   DT_ENTITY_GRAPHIC *bg_graphic2;
+  DT_BACKGROUND_TILE *tile;
+  int bg_tile_type1;
+  int bg_tile_type2;
   int ii,jj;
+  bool streamed_map;
+  int encoding;
+  bool valid_arguments;
+  int width;
+  int height;
+
+  /****************************************************************************/
+  /* If a benchmark has been requested then run it instead of the game.       */
+  /****************************************************************************/
+  if ((3 == argc) && (0 == strcmp(argv[1], "-benchmark")))
+  {
+    result = dt_run_benchmark(argv[2]);
+    dt_destroy_master_worker_pool();
+    return((DT_BENCHMARK_OK == result) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  /****************************************************************************/
+  /* If a map conversion has been requested then do that instead. The chunks  */
+  /* of a chunked map may be compressed with rle or zlib. Any other arguments */
+  /* are turned down rather than converting some other way or starting the    */
+  /* game.                                                                    */
+  /****************************************************************************/
+  if ((2 <= argc) && (0 == strcmp(argv[1], "-convert")))
+  {
+    encoding = DT_CHUNK_ENCODING_RAW;
+    valid_arguments = ((4 == argc) ||
+                       (((5 == argc) || (6 == argc)) &&
+                        (0 == strcmp(argv[4], "-chunked"))));
+    if (valid_arguments && (6 == argc))
+    {
+      if (0 == strcmp(argv[5], "rle"))
+      {
+        encoding = DT_CHUNK_ENCODING_RLE;
+      }
+      else if (0 == strcmp(argv[5], "zlib"))
+      {
+        encoding = DT_CHUNK_ENCODING_ZLIB;
+      }
+      else
+      {
+        valid_arguments = FALSE;
+      }
+    }
+    if (!valid_arguments)
+    {
+      fprintf(stderr,
+              "Usage: %s -convert <in> <out> [-chunked [rle | zlib]]\n",
+              argv[0]);
+      return(EXIT_FAILURE);
+    }
+    result = dt_convert_map_file(argv[2], argv[3], (4 < argc), encoding);
+    dt_destroy_master_worker_pool();
+    return((DT_MAP_FILE_LOADED == result) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  /****************************************************************************/
+  /* If a generated map has been requested then write it instead. It is a     */
+  /* chunked binary map with zlib compressed chunks unless -text is given.    */
+  /****************************************************************************/
+  if (((6 == argc) || ((7 == argc) && (0 == strcmp(argv[6], "-text")))) &&
+      (0 == strcmp(argv[1], "-generate")))
+  {
+    width = atoi(argv[2]);
+    height = atoi(argv[3]);
+    if ((width <= 0) || (width > DT_MAP_MAX_DIMENSION) ||
+        (height <= 0) || (height > DT_MAP_MAX_DIMENSION))
+    {
+      fprintf(stderr, "Map size must be from 1 to %d.\n",
+              DT_MAP_MAX_DIMENSION);
+      return(EXIT_FAILURE);
+    }
+    result = dt_generate_map_file(width,
+                                  height,
+                                  (Uint32) strtoul(argv[4], NULL, 0),
+                                  argv[5],
+                                  (7 == argc));
+    dt_destroy_master_worker_pool();
+    return((DT_MAP_FILE_LOADED == result) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
 
   /****************************************************************************/
   /* Create the screen object.                                                */
@@ -23,9 +105,26 @@ int main(int argc, char *argv[])
   screen = dt_create_screen();
 
   /****************************************************************************/
-  /* Create the map grid.                                                     */
+  /* Create the map grid. A chunked binary map may be given to stream it in   */
+  /* as the screen scrolls.                                                   */
   /****************************************************************************/
-  map_grid = dt_create_grid(10,10,10,10);
+  streamed_map = ((3 == argc) && (0 == strcmp(argv[1], "-stream")));
+  if (streamed_map)
+  {
+    result = dt_open_streamed_map_file(argv[2],
+                                       DT_STREAM_DEFAULT_MAX_CHUNKS,
+                                       &map_grid);
+    if (DT_MAP_FILE_LOADED != result)
+    {
+      fprintf(stderr, "Failed to open map %s (error %d).\n", argv[2], result);
+      dt_destroy_screen(screen);
+      return(EXIT_FAILURE);
+    }
+  }
+  else
+  {
+    map_grid = dt_create_grid(10,10,10,10);
+  }
 
   /****************************************************************************/
   /* Set up the master unit list.                                             */
@@ -48,21 +147,38 @@ int main(int argc, char *argv[])
   screen->x_tiles_per_screen = (int) (screen->width / map_grid->square_width);
   screen->y_tiles_per_screen = (int) (screen->height / map_grid->square_height);
 
-  //Dummy set up of background.
-  result = dt_create_entity_graphic("bg_sprite1.png", &bg_graphic1);
-  result = dt_create_entity_graphic("bg_sprite2.png", &bg_graphic2);
-  for (ii=0;ii<10;ii++)
+  /****************************************************************************/
+  /* A streamed map has its own tiles. Load their graphics and ask for the    */
+  /* chunks around the screen.                                                */
+  /****************************************************************************/
+  if (streamed_map)
+  {
+    dt_load_grid_tile_graphics(map_grid);
+    dt_update_chunk_streamer(map_grid, screen);
+  }
+  else
   {
-    for (jj=0;jj<10;jj++)
+    //Dummy set up of background.
+    result = dt_create_entity_graphic("bg_sprite1.png", &bg_graphic1);
+    result = dt_create_entity_graphic("bg_sprite2.png", &bg_graphic2);
+    tile = dt_create_background_tile();
+    dt_assign_entity_graphic_to_background_tile(bg_graphic1, tile);
+    result = dt_add_tile_type_to_grid(map_grid, tile, &bg_tile_type1);
+    tile = dt_create_background_tile();
+    dt_assign_entity_graphic_to_background_tile(bg_graphic2, tile);
+    result = dt_add_tile_type_to_grid(map_grid, tile, &bg_tile_type2);
+    for (ii=0;ii<10;ii++)
     {
-      map_grid->map_grid[ii][jj]->tile = dt_create_background_tile();
-      if ((ii % 2 == 0 && jj % 2 == 0 ) || (ii % 2 == 1 && jj % 2 == 1))
+      for (jj=0;jj<10;jj++)
       {
-        map_grid->map_grid[ii][jj]->tile->graphic = bg_graphic1;
-      }
-      else
-      {
-        map_grid->map_grid[ii][jj]->tile->graphic = bg_graphic2;
+        if ((ii % 2 == 0 && jj % 2 == 0 ) || (ii % 2 == 1 && jj % 2 == 1))
+        {
+          dt_assign_tile_type_to_grid(map_grid, jj, ii, bg_tile_type1);
+        }
+        else
+        {
+          dt_assign_tile_type_to_grid(map_grid, jj, ii, bg_tile_type2);
+        }
       }
     }
   }
@@ -73,11 +189,26 @@ int main(int argc, char *argv[])
   result = dt_redraw_screen(map_grid, screen);
 
   /****************************************************************************/
-  /* Loop scanning the event queue until the user requests exit.              */
+  /* Loop scanning the event queue until the user requests exit. While units  */
+  /* are waiting for paths the searches are run a frame's budget at a time    */
+  /* whenever the queue is empty, rather than waiting for the next event.     */
   /****************************************************************************/
   while(!exit_requested)
   {
-    SDL_WaitEvent(&event);
+    if (dt_has_pending_paths(map_grid))
+    {
+      if (!SDL_PollEvent(&event))
+      {
+        dt_run_path_scheduler(map_grid->path_scheduler,
+                              DT_PATH_SCHEDULER_FRAME_TIME_US,
+                              DT_PATH_SCHEDULER_NO_LIMIT);
+        continue;
+      }
+    }
+    else
+    {
+      SDL_WaitEvent(&event);
+    }
 
     switch (event.type)
     {
@@ -102,6 +233,18 @@ int main(int argc, char *argv[])
         dt_handle_mouse_click(map_grid, screen, &event);
         break;
 
+      /**********************************************************************/
+      /* Show any chunks of a streamed map which have been read.            */
+      /**********************************************************************/
+      case SDL_USEREVENT:
+        if ((DT_EVENT_CHUNKS_ARRIVED == event.user.code) &&
+            (NULL != map_grid->streamer))
+        {
+          dt_update_chunk_streamer(map_grid, screen);
+          dt_redraw_screen(map_grid, screen);
+        }
+        break;
+
       default:
         break;
     }
@@ -109,10 +252,15 @@ int main(int argc, char *argv[])
 
 EXIT_LABEL:
 
+  /****************************************************************************/
+  /* The grid is destroyed before SDL is shut down as a streamed grid has a   */
+  /* thread which pushes SDL events.                                          */
+  /****************************************************************************/
+  dt_destroy_grid(map_grid);
   SDL_Quit();
   dt_destroy_unsorted_list(active_unit_list, false);
   dt_destroy_unsorted_list(master_unit_list, true);
-  dt_destroy_grid(map_grid);
+  dt_destroy_master_worker_pool();
 
   return(EXIT_SUCCESS);
 }